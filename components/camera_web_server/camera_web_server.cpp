@@ -624,6 +624,9 @@ void RTSPServer::handle_play_(RTSPSession &session, const std::string &request)
     }
   }
 
+  // Start the new client on an IDR frame instead of waiting for the next GOP
+  esp_h264_enc_force_idr(this->h264_encoder_);
+
   session.state = RTSPState::PLAYING;
   this->streaming_active_ = true;
 
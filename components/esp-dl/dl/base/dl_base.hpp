@@ -5,6 +5,7 @@
 #include <assert.h>
 #include <functional>
 #include <stdint.h>
+#include <string.h>
 #include <vector>
 
 namespace dl {
@@ -91,6 +92,8 @@ struct ArgsType {
     int input_height;  /*!< 61 */
     void *debug_value; /*!< 62 It will malloc 16 bytes memory if malloc_debug_memory = true */
     bool auto_split;
+    void *buffer; /*!< Accumulators of the C kernels, at least output_channel of them, set by ModuleArgs. nullptr: they
+                     are allocated on every call */
 };
 
 typedef void (*c_impl_func_s16_t)(DL_S16_BUFFER_TYPE *, int16_t *, const ArgsType<int16_t> &);
@@ -238,6 +241,7 @@ std::vector<ArgsType<feature_t>> get_conv_operation_args(TensorBase *output,
     args.input_y_offset = args.input_width * args.input_channel;
     args.input_channel_with_padding = args.input_channel;
     args.auto_split = true;
+    args.buffer = nullptr;
     // printf("input: %d, %d, %d, output: %d, %d, %d\n", input->shape[1], args.input_width, args.input_channel,
     // output->shape[1], args.output_width, args.output_channel);
 
@@ -336,6 +340,30 @@ std::vector<ArgsType<feature_t>> get_conv_operation_args(TensorBase *output,
     return m_args;
 }
 
+/**
+ * @brief Get the zeroed accumulators of the C kernels: the buffer of the args, or a new one without it.
+ */
+template <typename buffer_t, typename feature_t>
+buffer_t *c_impl_buffer_get(const ArgsType<feature_t> &args)
+{
+    if (args.buffer) {
+        memset(args.buffer, 0, args.output_channel * sizeof(buffer_t));
+        return (buffer_t *)args.buffer;
+    }
+    return (buffer_t *)heap_caps_calloc(args.output_channel, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+}
+
+/**
+ * @brief Release the accumulators of c_impl_buffer_get.
+ */
+template <typename buffer_t, typename feature_t>
+void c_impl_buffer_put(const ArgsType<feature_t> &args, buffer_t *buffer)
+{
+    if (buffer != args.buffer) {
+        heap_caps_free(buffer);
+    }
+}
+
 template <typename feature_t, typename buffer_t>
 void conv_operation_shell(ArgsType<feature_t> &args,
                           ImplFunc_t<feature_t, feature_t> i_impl_func,
@@ -886,7 +914,7 @@ void conv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer = (buffer_t *)heap_caps_calloc(args.output_channel, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+            buffer_t *buffer = c_impl_buffer_get<buffer_t>(args);
             feature_t *input_y_real;
             feature_t *input_x_real;
             feature_t *filter_ptr_y;
@@ -1082,7 +1110,7 @@ void conv_operation_shell(ArgsType<feature_t> &args,
                 }
                 input_y_real += args.input_stride_y_offset;
             }
-            heap_caps_free(buffer);
+            c_impl_buffer_put(args, buffer);
         }
     } else { // padding valid
         if (i_impl_func_sp) {
@@ -1117,7 +1145,7 @@ void conv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer = (buffer_t *)heap_caps_calloc(args.output_channel, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+            buffer_t *buffer = c_impl_buffer_get<buffer_t>(args);
             for (size_t output_y = 0; output_y < args.output_height; output_y++) {
                 feature_t *input_syx = input_ptr;
                 feature_t *output_yx = output_ptr;
@@ -1132,7 +1160,7 @@ void conv_operation_shell(ArgsType<feature_t> &args,
                 input_ptr += args.input_stride_y_offset;
                 output_ptr += args.output_y_offset;
             }
-            heap_caps_free(buffer);
+            c_impl_buffer_put(args, buffer);
         }
     }
 
@@ -1794,7 +1822,7 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
             }
         } else // run c_impl_func
         {
-            buffer_t *buffer = (buffer_t *)heap_caps_calloc(args.output_channel, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+            buffer_t *buffer = c_impl_buffer_get<buffer_t>(args);
             feature_t *input_y_real;
             feature_t *input_x_real;
             feature_t *filter_ptr_y;
@@ -1987,7 +2015,7 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
                 }
                 input_y_real += args.input_stride_y_offset;
             }
-            heap_caps_free(buffer);
+            c_impl_buffer_put(args, buffer);
         }
     } else { // padding valid
         if (i_impl_func_sp) {
@@ -2024,7 +2052,7 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
         } else // run c_impl_func
         {
             args.filter_y_offset = 0;
-            buffer_t *buffer = (buffer_t *)heap_caps_calloc(args.output_channel, sizeof(buffer_t), MALLOC_CAP_DEFAULT);
+            buffer_t *buffer = c_impl_buffer_get<buffer_t>(args);
             for (size_t output_y = 0; output_y < args.output_height; output_y++) {
                 feature_t *input_syx = input_ptr;
                 feature_t *output_yx = output_ptr;
@@ -2039,7 +2067,7 @@ void dwconv_operation_shell(ArgsType<feature_t> &args,
                 input_ptr += args.input_stride_y_offset;
                 output_ptr += args.output_y_offset;
             }
-            heap_caps_free(buffer);
+            c_impl_buffer_put(args, buffer);
         }
     }
 
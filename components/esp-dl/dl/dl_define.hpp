@@ -12,6 +12,8 @@
                                /*!< - 0: mute */
 #define DL_LOG_CACHE_COUNT 0   /*!< - 1: print the cache hit/miss count only for esp32p4 */
                                /*!< - 0: mute */
+#define DL_LOG_HEAP_ALLOC 0    /*!< - 1: count the heap allocations of the model forwards, needs CONFIG_HEAP_USE_HOOKS */
+                               /*!< - 0: mute */
 
 #if CONFIG_SPIRAM_SUPPORT || CONFIG_ESP32_SPIRAM_SUPPORT || CONFIG_ESP32S2_SPIRAM_SUPPORT || \
     CONFIG_ESP32S3_SPIRAM_SUPPORT || CONFIG_SPIRAM
@@ -178,5 +180,6 @@ typedef struct mem_info_s {
 typedef struct {
     std::string type; /*!< module type */
     uint32_t latency; /*!< module latency */
+    bool multi_core;  /*!< the module runs on both cores with RUNTIME_MODE_MULTI_CORE */
 } module_info;        /*!< module info */
 } // namespace dl
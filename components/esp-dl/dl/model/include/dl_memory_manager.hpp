@@ -7,6 +7,20 @@
 #include <list>
 
 namespace dl {
+class TensorInfo;
+
+/**
+ * @brief Result of a memory plan
+ */
+typedef struct {
+    size_t internal_size;         /*!< Internal RAM reserved for the tensors, in bytes */
+    size_t psram_size;            /*!< PSRAM reserved for the tensors, in bytes */
+    size_t internal_access_bytes; /*!< Bytes the modules read and write in internal RAM for one run */
+    size_t psram_access_bytes;    /*!< Bytes the modules read and write in PSRAM for one run */
+    int tensor_num;               /*!< Number of tensors which own their memory, the inplace tensors excluded */
+    int internal_tensor_num;      /*!< Number of those tensors placed in internal RAM */
+} memory_plan_t;
+
 /**
  * @brief Memory manager base class, each model has its own memory manager
  * TODO: share memory manager with different models
@@ -20,13 +34,21 @@ public:
      *
      * @param alignment Memory address alignment
      */
-    MemoryManagerBase(int alignment = 16) : alignment(alignment) {}
+    MemoryManagerBase(int alignment = 16) : alignment(alignment), plan_info()
+    {
+#if CONFIG_SPIRAM
+        this->psram = true;
+#else
+        this->psram = false;
+#endif
+    }
 
     /**
      * @brief Destroy the MemoryManager object. Return resource.
      */
     virtual ~MemoryManagerBase() {}
 
+#if !DL_NO_FBS_MODEL
     /**
      * @brief Allocate memory for each tensor, include all input and output tensors
      *
@@ -38,6 +60,63 @@ public:
     virtual bool alloc(fbs::FbsModel *fbs_model,
                        std::vector<dl::module::Module *> &execution_plan,
                        ModelContext *context) = 0;
+
+    /**
+     * @brief Plan the memory of each tensor without allocating it, see get_plan_info
+     *
+     * @param fbs_model       FlatBuffer's Model
+     * @param execution_plan  Topological sorted module list
+     * @param context         Model context
+     * @param psram           Plan for a chip with PSRAM, whatever CONFIG_SPIRAM is
+     */
+    virtual void plan(fbs::FbsModel *fbs_model,
+                      std::vector<dl::module::Module *> &execution_plan,
+                      ModelContext *context,
+                      bool psram) = 0;
+#endif
+
+    /**
+     * @brief Plan the memory of tensors given by their lifetime, without a model, see get_plan_info
+     *
+     * @param tensor_info  Tensors, a tensor lives from its time_begin node until its time_end node, -1 for the end
+     * @param node_num     Number of nodes
+     * @param psram        Plan for a chip with PSRAM, whatever CONFIG_SPIRAM is
+     */
+    virtual void plan(std::vector<TensorInfo *> &tensor_info, int node_num, bool psram) = 0;
+
+    /**
+     * @brief Get the result of the last alloc or plan
+     *
+     * @return memory_plan_t
+     */
+    memory_plan_t get_plan_info() { return this->plan_info; }
+
+protected:
+    bool psram;              /*!< Whether the tensors which do not fit in internal RAM go to PSRAM */
+    memory_plan_t plan_info; /*!< Result of the last alloc or plan */
+
+#if !DL_NO_FBS_MODEL
+    /**
+     * @brief Extracts tensor metadata (shape, data type, size, lifetime, access bytes) from FlatBuffer model
+     * and execution plan for memory planning
+     * @param fbs_model FlatBuffer representation of the neural network model
+     * @param execution_plan Topologically sorted list of computation modules
+     * @param context Runtime context containing device-specific configurations
+     * @param tensor_info Output vector to store TensorInfo objects for all tensors
+     */
+    void get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
+                                  std::vector<dl::module::Module *> &execution_plan,
+                                  ModelContext *context,
+                                  std::vector<TensorInfo *> &tensor_info);
+#endif
+
+    /**
+     * @brief Fill plan_info from the placement of the tensors
+     * @param tensor_info Tensors, placed by the memory manager
+     * @param internal_size Internal RAM reserved for the tensors, in bytes
+     * @param psram_size PSRAM reserved for the tensors, in bytes
+     */
+    void update_plan_info(std::vector<TensorInfo *> &tensor_info, size_t internal_size, size_t psram_size);
 };
 
 /**
@@ -54,6 +133,7 @@ private:
     int exponent;
     size_t size; // Size, in bytes
     uint32_t call_times;
+    size_t access_bytes;      // Bytes read and written by the modules, the inplace followers included
     uint32_t offset;          // PSRAM offset
     uint32_t internal_offset; // Internal ram offset, used to allocate tensor on both PSRAM and internal ram
     bool is_internal;
@@ -108,6 +188,45 @@ public:
      */
     TensorInfo *get_inplace_follower_tensor() { return m_follower_dirty_tensor; }
 
+    /**
+     * @brief Get the tensor which owns the memory of an inplace chain
+     *
+     * @return TensorInfo* The last leader, this tensor if it is not inplaced
+     */
+    TensorInfo *get_inplace_root_tensor()
+    {
+        if (m_leader_tensor) {
+            return m_leader_tensor->get_inplace_root_tensor();
+        }
+        return this;
+    }
+
+    /**
+     * @brief Count an access of a module to the tensor
+     *
+     * @param bytes Bytes read or written
+     */
+    void add_access_bytes(size_t bytes)
+    {
+        if (m_leader_tensor) {
+            m_leader_tensor->add_access_bytes(bytes);
+        }
+        this->access_bytes += bytes;
+    }
+
+    /**
+     * @brief Get the bytes the modules read and write in the memory of the tensor
+     *
+     * @return size_t
+     */
+    size_t get_access_bytes()
+    {
+        if (m_leader_tensor) {
+            return m_leader_tensor->get_access_bytes();
+        }
+        return this->access_bytes;
+    }
+
     /**
      * @brief Update Tensor lifetime
      *
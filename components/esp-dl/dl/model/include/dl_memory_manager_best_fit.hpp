@@ -0,0 +1,96 @@
+#pragma once
+
+#include "dl_memory_manager.hpp"
+
+namespace dl {
+
+/**
+ * @brief Memory manager that packs the tensors by lifetime with best fit, and pins the tensors the modules access the
+ * most to internal RAM.
+ *
+ * Two tensors share memory when their lifetimes do not overlap. A tensor is placed in the smallest gap left by the
+ * placed tensors which live at the same time, or above them when no gap fits. With a PSRAM, the tensors are first
+ * offered to internal RAM in decreasing order of access bytes per byte, as long as they fit in max_internal_size; the
+ * others are packed in PSRAM from the largest to the smallest. Only the peak of each memory is reserved.
+ */
+class MemoryManagerBestFit : public MemoryManagerBase {
+private:
+    /**
+     * @brief A tensor which owns its memory, and its place
+     */
+    typedef struct {
+        TensorInfo *tensor; /*!< The tensor */
+        size_t size;        /*!< Aligned size, in bytes */
+        int begin;          /*!< First node the tensor lives in */
+        int end;            /*!< The tensor is dead from this node */
+        size_t offset;      /*!< Offset in its memory, valid once placed */
+    } placement_t;
+
+    size_t max_internal_size; /*!< Maximum allowed internal RAM usage in bytes.
+                                 Effective only when PSRAM is available */
+
+    /**
+     * @brief Find the best fit offset of a tensor among the placed tensors of one memory
+     * @param placed Tensors placed in the memory
+     * @param item Tensor to place
+     * @param limit Size of the memory, SIZE_MAX if it grows
+     * @return size_t The offset, SIZE_MAX if the tensor does not fit
+     */
+    size_t find_offset(std::vector<placement_t *> &placed, placement_t *item, size_t limit);
+
+    /**
+     * @brief Place all tensors and fill plan_info
+     * @param tensor_info Vector containing tensor metadata
+     * @param node_num Total computation nodes in the network
+     * @param max_internal_size Internal RAM the tensors may use when there is a PSRAM, in bytes
+     */
+    void simulate(std::vector<TensorInfo *> &tensor_info, int node_num, size_t max_internal_size);
+
+public:
+    /**
+     * @brief Constructs a best fit memory manager
+     * @param max_internal_size Maximum allowed internal RAM usage in bytes
+     * @param alignment Memory address alignment requirement (default: 16 bytes)
+     */
+    MemoryManagerBestFit(int max_internal_size, int alignment = 16) :
+        MemoryManagerBase(alignment), max_internal_size(max_internal_size > 0 ? max_internal_size : 0)
+    {
+    }
+
+    /**
+     * @brief Destructor
+     */
+    ~MemoryManagerBestFit() {}
+
+#if !DL_NO_FBS_MODEL
+    /**
+     * @brief Allocates memory for all network tensors following the best fit strategy
+     * @param fbs_model FlatBuffer model containing network architecture
+     * @param execution_plan Execution graph ordered by computation dependencies
+     * @param context Device-specific runtime configuration
+     * @return bool True if successful allocation, false if memory insufficient
+     */
+    bool alloc(fbs::FbsModel *fbs_model, std::vector<dl::module::Module *> &execution_plan, ModelContext *context);
+
+    /**
+     * @brief Places the tensors without allocating memory, see get_plan_info
+     * @param fbs_model FlatBuffer model containing network architecture
+     * @param execution_plan Execution graph ordered by computation dependencies
+     * @param context Device-specific runtime configuration
+     * @param psram Plan for a chip with PSRAM
+     */
+    void plan(fbs::FbsModel *fbs_model,
+              std::vector<dl::module::Module *> &execution_plan,
+              ModelContext *context,
+              bool psram);
+#endif
+
+    /**
+     * @brief Places the tensors without allocating memory, see get_plan_info
+     * @param tensor_info Tensors, with their lifetime in nodes
+     * @param node_num Total computation nodes in the network
+     * @param psram Plan for a chip with PSRAM
+     */
+    void plan(std::vector<TensorInfo *> &tensor_info, int node_num, bool psram);
+};
+} // namespace dl
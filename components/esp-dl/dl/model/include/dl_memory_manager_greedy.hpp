@@ -17,19 +17,6 @@ private:
     std::list<MemoryChunk *> internal_memory_list; /*!< List of allocated internal RAM memory blocks */
     std::list<MemoryChunk *> internal_free_list;   /*!< List of free internal RAM memory blocks */
 
-    /**
-     * @brief Extracts tensor metadata (shape, data type, size) from FlatBuffer model
-     * and execution plan for memory planning
-     * @param fbs_model FlatBuffer representation of the neural network model
-     * @param execution_plan Topologically sorted list of computation modules
-     * @param context Runtime context containing device-specific configurations
-     * @param tensor_info Output vector to store TensorInfo objects for all tensors
-     */
-    void get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
-                                  std::vector<dl::module::Module *> execution_plan,
-                                  ModelContext *context,
-                                  std::vector<TensorInfo *> &tensor_info);
-
     /**
      * @brief Simulates memory allocation process for given tensor information
      * @param tensor_info Vector containing metadata for all tensors in the network
@@ -71,6 +58,13 @@ private:
      */
     MemoryChunk *alloc_internal_tensor(TensorInfo *tensor, int mode = 0);
 
+    /**
+     * @brief Simulates the allocation of all tensors and fills plan_info
+     * @param tensor_info Vector containing tensor metadata
+     * @param node_num Total computation nodes in the network
+     */
+    void simulate_plan(std::vector<TensorInfo *> &tensor_info, int node_num);
+
     /**
      * @brief Releases all allocated memory blocks in both PSRAM and internal memory pools
      */
@@ -99,6 +93,7 @@ public:
      */
     ~MemoryManagerGreedy() { this->free_memory_list(); }
 
+#if !DL_NO_FBS_MODEL
     /**
      * @brief Allocates memory for all network tensors following greedy strategy
      * @param fbs_model FlatBuffer model containing network architecture
@@ -108,6 +103,27 @@ public:
      */
     bool alloc(fbs::FbsModel *fbs_model, std::vector<dl::module::Module *> &execution_plan, ModelContext *context);
 
+    /**
+     * @brief Simulates the greedy strategy without allocating memory, see get_plan_info
+     * @param fbs_model FlatBuffer model containing network architecture
+     * @param execution_plan Execution graph ordered by computation dependencies
+     * @param context Device-specific runtime configuration
+     * @param psram Plan for a chip with PSRAM
+     */
+    void plan(fbs::FbsModel *fbs_model,
+              std::vector<dl::module::Module *> &execution_plan,
+              ModelContext *context,
+              bool psram);
+#endif
+
+    /**
+     * @brief Simulates the greedy strategy without allocating memory, see get_plan_info
+     * @param tensor_info Tensors, with their lifetime in nodes
+     * @param node_num Total computation nodes in the network
+     * @param psram Plan for a chip with PSRAM
+     */
+    void plan(std::vector<TensorInfo *> &tensor_info, int node_num, bool psram);
+
     /**
      * @brief Releases all allocated memory including tensor buffers and memory pools
      */
@@ -2,7 +2,9 @@
 
 #include "dl_memory_manager.hpp"
 #include "dl_model_context.hpp"
+#include "dl_model_profiler.hpp"
 #include "dl_module_base.hpp"
+#include "dl_weight_prefetcher.hpp"
 #include "esp_log.h"
 #include "fbs_loader.hpp"
 #include "fbs_model.hpp"
@@ -37,8 +39,13 @@
 
 namespace dl {
 
-// currently only support MEMORY_MANAGER_GREEDY
-typedef enum { MEMORY_MANAGER_GREEDY = 0, LINEAR_MEMORY_MANAGER = 1 } memory_manager_t;
+// LINEAR_MEMORY_MANAGER is not supported yet, it falls back to MEMORY_MANAGER_GREEDY
+typedef enum {
+    MEMORY_MANAGER_GREEDY = 0,   /*!< Allocates in execution order, internal RAM first, see MemoryManagerGreedy */
+    LINEAR_MEMORY_MANAGER = 1,   /*!< Not supported yet */
+    MEMORY_MANAGER_BEST_FIT = 2, /*!< Packs by lifetime, the most accessed tensors in internal RAM, see
+                                    MemoryManagerBestFit */
+} memory_manager_t;
 
 /**
  * @brief Neural Network Model.
@@ -57,6 +64,20 @@ private:
     std::string m_doc_string;                      /*!< doc string of model */
     size_t m_internal_size;                        /*!< Internal RAM usage */
     size_t m_psram_size;                           /*!< PSRAM usage */
+    ModelProfiler *m_profiler = nullptr;           /*!< Records the runs, created by enable_profiler */
+    memory_plan_t m_memory_plan = {};              /*!< Memory plan of the tensors, filled by build */
+    WeightPrefetcher *m_prefetcher = nullptr;      /*!< Prefetches the weights, created by enable_weight_prefetch */
+    bool m_module_worker = false;                  /*!< build started the dual core workers, see ModuleWorker */
+
+    /**
+     * @brief Create a memory manager, MemoryManagerGreedy for the types not supported yet.
+     */
+    static MemoryManagerBase *create_memory_manager(size_t max_internal_size, memory_manager_t mm_type);
+
+    /**
+     * @brief Forward a module of the execution plan, with the profiler and the weight prefetcher.
+     */
+    void forward_module(int index, runtime_mode_t mode, bool profile);
 
 public:
     Model() {}
@@ -301,7 +322,7 @@ public:
     /**
      * @brief Get module info
      *
-     * @return return Type and latency of each module.
+     * @return return Type, latency and dual core support of each module.
      */
     std::map<std::string, module_info> get_module_info();
 
@@ -320,7 +341,8 @@ public:
     void profile_memory();
 
     /**
-     * @brief Print module info summary. (Name, Type, Latency)
+     * @brief Print module info summary. (Name, Type, Latency, Multi core) and the share of the modules and of the
+     * latency that runs on both cores with RUNTIME_MODE_MULTI_CORE.
      *
      * @param sort_module_by_latency True The module is printed in latency decreasing sort.
      *                               False The module is printed in ONNX topological sort.
@@ -335,6 +357,91 @@ public:
      */
     void profile(bool sort_module_by_latency = false);
 
+    /**
+     * @brief Get the memory plan of the tensors made by build: the internal RAM and PSRAM reserved for them, and the
+     * bytes the modules access in each for one run.
+     *
+     * @return memory_plan_t
+     */
+    memory_plan_t get_memory_plan() { return m_memory_plan; }
+
+    /**
+     * @brief Plan the memory of the tensors again without allocating it, to compare the memory managers. The model
+     * keeps the memory allocated by build.
+     *
+     * @param max_internal_size  In bytes. Limit the max internal size usage, only take effect with psram.
+     * @param mm_type            Type of memory manager
+     * @param psram              Plan for a chip with PSRAM, whatever the chip running the plan is
+     * @return memory_plan_t
+     */
+    memory_plan_t plan_memory(size_t max_internal_size, memory_manager_t mm_type, bool psram);
+
+    /**
+     * @brief Get the number of operation args computed by the modules since build, each computation allocates the
+     * args on the heap. The args are computed by build, so it stays 0 while the runs reuse them.
+     *
+     * @return The number of computations
+     */
+    size_t get_args_compute_count() { return m_model_context ? m_model_context->get_args_compute_count() : 0; }
+
+    /**
+     * @brief Get the number of heap allocations made by the module forwards of the runs since build. The allocations
+     * are only counted with DL_LOG_HEAP_ALLOC, see dl_define.hpp, otherwise it is always 0.
+     *
+     * @return The number of allocations
+     */
+    size_t get_heap_alloc_count() { return m_model_context ? m_model_context->get_heap_alloc_count() : 0; }
+
+    /**
+     * @brief Record the latency, the runtime mode, the core and the cache counters of every module forward of the
+     * following runs, with the placement of the tensors of each module. It costs two timer reads per module. The
+     * profiler is created by the first call and lives with the model, see ModelProfiler for the exports.
+     *
+     * @param capacity  Number of module forwards kept, the oldest are overwritten. Only used by the first call.
+     * @return The profiler, nullptr if the model is not built
+     */
+    ModelProfiler *enable_profiler(size_t capacity = 1024);
+
+    /**
+     * @brief Stop recording the runs, the records are kept for the exports.
+     */
+    void disable_profiler();
+
+    /**
+     * @brief Get the profiler.
+     *
+     * @return The profiler, nullptr before enable_profiler
+     */
+    ModelProfiler *get_profiler() { return m_profiler; }
+
+    /**
+     * @brief Copy the weights of the modules from PSRAM or flash into an internal RAM double buffer during the
+     * following runs, the weights of the next module are copied while the current module computes. The modules whose
+     * weights are smaller than DL_WEIGHT_PREFETCH_MIN_SIZE or larger than max_buffer_size keep reading them in place.
+     * The weights must not be modified while the prefetch is enabled.
+     *
+     * @param max_buffer_size  In bytes. Largest weights of a module to prefetch, each buffer is at most this size
+     * @param backend          Copies the weights, nullptr for the DMA when the chip has one, memcpy otherwise. It is
+     *                         deleted with the prefetcher. The memcpy copies do not overlap the inference, see
+     *                         WeightPrefetchMemcpy.
+     * @return The prefetcher, nullptr if the model is not built, no module is prefetched or the buffers can't be
+     *         allocated
+     */
+    WeightPrefetcher *enable_weight_prefetch(size_t max_buffer_size = 64 * 1024,
+                                             WeightPrefetchBackend *backend = nullptr);
+
+    /**
+     * @brief Stop prefetching the weights and free the double buffer.
+     */
+    void disable_weight_prefetch();
+
+    /**
+     * @brief Get the weight prefetcher.
+     *
+     * @return The prefetcher, nullptr if the weights are not prefetched
+     */
+    WeightPrefetcher *get_weight_prefetcher() { return m_prefetcher; }
+
     /**
      * @brief Get inputs of model
      *
@@ -2,6 +2,7 @@
 
 #include "dl_tensor_base.hpp"
 #include "esp_log.h"
+#include <atomic>
 #include <map>
 namespace dl {
 
@@ -20,9 +21,17 @@ private:
     void *m_internal_root;                   /*!< Internal root pointer */
     int m_psram_size;                        /*!< In bytes. PSRAM size usage. Only take effect when there's a PSRAM */
     int m_internal_size;                     /*!< In bytes. Internal size usage. */
+    size_t m_args_compute_count;             /*!< Computations of operation args by the modules */
+    size_t m_heap_alloc_count;               /*!< Heap allocations made during the forwards */
+    size_t m_heap_alloc_begin;               /*!< Value of s_heap_alloc_total when the forward began */
+    void *m_kernel_buffer[2];                /*!< Accumulators of the C kernels, one per task, see ModuleArgs */
+    size_t m_kernel_buffer_size;             /*!< In bytes. Size of each kernel buffer */
     std::map<std::string, int> m_name2index; /*!< Tensor name to index map
                                                >=0: variable tensor
                                                <0: parameter tensor */
+
+    static std::atomic<int> s_forward_num;         /*!< Forwards in progress, in every context */
+    static std::atomic<size_t> s_heap_alloc_total; /*!< Heap allocations made while a forward was in progress */
     /**
      * @brief Gets the parameter tensor index by global tensor index.
      *
@@ -50,6 +59,12 @@ public:
         m_internal_root = nullptr;
         m_psram_size = 0;
         m_internal_size = 0;
+        m_args_compute_count = 0;
+        m_heap_alloc_count = 0;
+        m_heap_alloc_begin = 0;
+        m_kernel_buffer[0] = nullptr;
+        m_kernel_buffer[1] = nullptr;
+        m_kernel_buffer_size = 0;
     }
 
     /**
@@ -174,6 +189,93 @@ public:
      */
     size_t get_variable_memory_size(mem_info_t &mem_info);
 
+    /**
+     * @brief Counts the computations of operation args by a module.
+     *
+     * @param count The number of computations.
+     */
+    void add_args_compute_count(size_t count = 1) { m_args_compute_count += count; }
+
+    /**
+     * @brief Gets the number of operation args computed by the modules since the last reset.
+     *
+     * @return size_t Returns the number of computations, 0 when the forwards reuse the precomputed args.
+     */
+    size_t get_args_compute_count() { return m_args_compute_count; }
+
+    /**
+     * @brief Resets the args computation counter.
+     */
+    void reset_args_compute_count() { m_args_compute_count = 0; }
+
+    /**
+     * @brief Counts one heap allocation, if a forward is in progress. It is called by the heap allocation hook of
+     * ESP-IDF when DL_LOG_HEAP_ALLOC is enabled, see dl_define.hpp, or by the allocation wrappers of a host build. The
+     * allocations of the other tasks during a forward are counted too, so the count is an upper bound.
+     */
+    static void count_heap_alloc()
+    {
+        if (s_forward_num.load(std::memory_order_relaxed) > 0) {
+            s_heap_alloc_total.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Begins counting the heap allocations of a forward, see end_forward.
+     */
+    void begin_forward()
+    {
+        s_forward_num.fetch_add(1, std::memory_order_relaxed);
+        m_heap_alloc_begin = s_heap_alloc_total.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Ends counting the heap allocations of a forward, they are added to the heap allocation count.
+     */
+    void end_forward()
+    {
+        m_heap_alloc_count += s_heap_alloc_total.load(std::memory_order_relaxed) - m_heap_alloc_begin;
+        s_forward_num.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Gets the number of heap allocations made during the forwards since the last reset.
+     *
+     * @return size_t Returns the number of allocations, always 0 when nothing calls count_heap_alloc.
+     */
+    size_t get_heap_alloc_count() { return m_heap_alloc_count; }
+
+    /**
+     * @brief Resets the heap allocation counter.
+     */
+    void reset_heap_alloc_count() { m_heap_alloc_count = 0; }
+
+    /**
+     * @brief Makes the kernel buffers of both tasks at least size bytes. The modules reserve them when they compute
+     * their args, then all the modules of the model share them in the forwards.
+     *
+     * @param size In bytes.
+     * @return bool Returns false if there is no memory for the buffers.
+     */
+    bool reserve_kernel_buffer(size_t size);
+
+    /**
+     * @brief Gets the kernel buffer of a task.
+     *
+     * @param task The index of the task, 0 or 1.
+     * @param size In bytes. The size needed.
+     * @return void* Returns the buffer, nullptr if it is smaller than size.
+     */
+    void *get_kernel_buffer(int task, size_t size)
+    {
+        return size <= m_kernel_buffer_size ? m_kernel_buffer[task] : nullptr;
+    }
+
+    /**
+     * @brief Frees the kernel buffers.
+     */
+    void kernel_buffer_free();
+
     /**
      * @brief Frees the memory allocated for PSRAM and internal roots.
      * This function ensures proper cleanup of allocated memory.
@@ -221,6 +323,7 @@ public:
         m_variables.clear();
         m_parameters.clear();
         m_name2index.clear();
+        kernel_buffer_free();
     }
 };
 
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "dl_model_context.hpp"
+#include "dl_module_base.hpp"
+#include "esp_http_server.h"
+#include <functional>
+#include <string>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+namespace dl {
+
+/**
+ * @brief One forward of one module, recorded by ModelProfiler.
+ */
+typedef struct {
+    uint32_t run;                 ///< Index of the Model::run call
+    uint16_t module;              ///< Index of the module in the execution plan
+    uint8_t mode;                 ///< Runtime mode passed to Model::run
+    uint8_t core;                 ///< Core the module was called on
+    int64_t start;                ///< Start time, in us since boot
+    uint32_t latency;             ///< Latency, in us
+    uint32_t l1d_hit;             ///< L1 data cache hits, ESP32-P4 only
+    uint32_t l1d_miss;            ///< L1 data cache misses, ESP32-P4 only
+    uint32_t l2d_hit;             ///< L2 data cache hits, ESP32-P4 only
+    uint32_t l2d_miss;            ///< L2 data cache misses, ESP32-P4 only
+    module::module_split_t split; ///< Cores which computed the forward, and the part of the other core
+} module_profile_t;
+
+/**
+ * @brief Static description of a profiled module: where the memory manager placed its tensors.
+ */
+typedef struct {
+    std::string name;      ///< Name of the module, the node name
+    std::string type;      ///< Operation type
+    std::string inputs;    ///< Placement of each input: 'I' internal RAM, 'P' PSRAM, 'F' flash, '-' none
+    std::string outputs;   ///< Placement of each output, see inputs
+    size_t internal_bytes; ///< In bytes. Inputs and outputs in internal RAM
+    size_t external_bytes; ///< In bytes. Inputs and outputs in PSRAM or flash, behind the cache
+    bool multi_core;       ///< The module can run on both cores, see module_profile_t::split for the forwards which did
+} module_profile_desc_t;
+
+/**
+ * @brief Write a chunk of an export, return false to stop the export.
+ */
+typedef std::function<bool(const char *data, size_t len)> profile_writer_t;
+
+/**
+ * @brief Continuous per-module profiler of Model::run, see Model::enable_profiler.
+ *
+ * Every forward of every module is recorded in a ring of fixed capacity, the oldest records are overwritten. A run
+ * holds the lock of the ring while it records, the exports copy the ring under the lock and format it without it, so
+ * a slow HTTP client never delays the inference by more than one copy.
+ */
+class ModelProfiler {
+private:
+    std::vector<module_profile_desc_t> m_modules; /*!< Description of each module of the execution plan */
+    std::string m_model_name;                     /*!< Name of the model, reported by the exports */
+    module_profile_t *m_records;                  /*!< The ring */
+    size_t m_capacity;                            /*!< Number of records the ring holds */
+    size_t m_next;                                /*!< Index of the next record in the ring */
+    size_t m_count;                               /*!< Number of valid records */
+    uint32_t m_run;                               /*!< Index of the current run */
+    runtime_mode_t m_mode;                        /*!< Runtime mode of the current run */
+    bool m_enabled;                               /*!< Record the runs */
+    SemaphoreHandle_t m_lock;                     /*!< Protects the ring */
+
+    std::vector<module_profile_t> snapshot();
+
+public:
+    /**
+     * @brief Construct a new ModelProfiler object.
+     *
+     * @param model_name  Name of the model
+     * @param capacity    Number of module forwards the ring holds
+     */
+    ModelProfiler(const std::string &model_name, size_t capacity);
+
+    /**
+     * @brief Destroy the ModelProfiler object.
+     */
+    ~ModelProfiler();
+
+    /**
+     * @brief Describe the next module of the execution plan, after the memory manager placed its tensors.
+     *
+     * @param module   The module
+     * @param name     Node name of the module
+     * @param type     Operation type of the module
+     * @param context  Model context
+     */
+    void add_module(module::Module *module, const std::string &name, const std::string &type, ModelContext *context);
+
+    /**
+     * @brief Start or stop recording the runs. The records are kept.
+     *
+     * @param enabled  true to record
+     */
+    void set_enabled(bool enabled) { m_enabled = enabled; }
+
+    /**
+     * @brief Whether the runs are recorded.
+     *
+     * @return true if the runs are recorded
+     */
+    bool is_enabled() { return m_enabled; }
+
+    /**
+     * @brief Drop all the records.
+     */
+    void clear();
+
+    /**
+     * @brief Called by Model::run before the first module.
+     *
+     * @param mode  Runtime mode of the run
+     * @return true if the run is recorded, then end_run must be called
+     */
+    bool begin_run(runtime_mode_t mode);
+
+    /**
+     * @brief Called by Model::run after the last module.
+     */
+    void end_run();
+
+    /**
+     * @brief Called by Model::run around the forward of a module.
+     *
+     * @param index  Index of the module in the execution plan
+     * @return the record to pass to end_module
+     */
+    module_profile_t *begin_module(int index);
+
+    /**
+     * @brief Complete a record started by begin_module.
+     *
+     * @param record  The record
+     */
+    void end_module(module_profile_t *record);
+
+    /**
+     * @brief Get the descriptions of the modules.
+     *
+     * @return The descriptions, in execution order
+     */
+    const std::vector<module_profile_desc_t> &get_modules() { return m_modules; }
+
+    /**
+     * @brief Export the placement of each module and its latency and cache statistics over the records as JSON.
+     *
+     * @param write  Writes the chunks of the export
+     */
+    void write_json(const profile_writer_t &write);
+
+    /**
+     * @brief Export the records as a Chrome trace, to open with chrome://tracing or https://ui.perfetto.dev.
+     * Each core is a thread of the trace.
+     *
+     * @param write  Writes the chunks of the export
+     */
+    void write_chrome_trace(const profile_writer_t &write);
+
+    /**
+     * @brief Serve the exports with an HTTP server: GET json_uri returns write_json and GET trace_uri returns
+     * write_chrome_trace. The profiler must outlive the registration.
+     *
+     * @param server     A running HTTP server, it needs two free URI handlers
+     * @param json_uri   URI of the JSON export
+     * @param trace_uri  URI of the Chrome trace export
+     * @return ESP_OK on success, the error of httpd_register_uri_handler otherwise
+     */
+    esp_err_t register_http(httpd_handle_t server,
+                            const char *json_uri = "/dl/profile",
+                            const char *trace_uri = "/dl/trace");
+};
+
+} // namespace dl
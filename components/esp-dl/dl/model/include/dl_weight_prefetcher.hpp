@@ -0,0 +1,236 @@
+#pragma once
+
+#include "dl_tensor_base.hpp"
+#include <stdint.h>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#if CONFIG_IDF_TARGET_ESP32S3 || CONFIG_IDF_TARGET_ESP32P4
+#define DL_WEIGHT_PREFETCH_DMA 1 /*!< The GDMA async memcpy can copy the weights */
+#include "esp_async_memcpy.h"
+#else
+#define DL_WEIGHT_PREFETCH_DMA 0
+#endif
+
+#define DL_WEIGHT_PREFETCH_ALIGN 64      /*!< Alignment of the weights in the buffers, a cache line */
+#define DL_WEIGHT_PREFETCH_MIN_SIZE 1024 /*!< Smaller weights are not worth a copy */
+
+namespace dl {
+
+/**
+ * @brief Statistics of a WeightPrefetcher.
+ */
+typedef struct {
+    uint32_t runs;     ///< Runs which used the prefetched weights
+    uint32_t copies;   ///< Weight tensors copied into the buffers
+    uint64_t bytes;    ///< In bytes. Weights copied into the buffers
+    uint32_t stalls;   ///< Forwards which waited for their weights
+    uint64_t stall_us; ///< In us. Time the inference waited for the weights, synchronous copies included
+} weight_prefetch_stats_t;
+
+/**
+ * @brief Copies the weights for WeightPrefetcher. A backend may have several copies in flight, they are all waited
+ * for together.
+ */
+class WeightPrefetchBackend {
+public:
+    virtual ~WeightPrefetchBackend() {}
+
+    /**
+     * @brief Called once for each weight tensor the prefetcher will copy, before the first copy.
+     *
+     * @param src   Weights
+     * @param size  In bytes
+     */
+    virtual void prepare_source(const void *src, size_t size) {}
+
+    /**
+     * @brief Start a copy. It may complete before returning.
+     *
+     * @param dst   Destination, in internal RAM, aligned to DL_WEIGHT_PREFETCH_ALIGN
+     * @param src   Weights
+     * @param size  In bytes
+     * @return true if the copy is started, false if nothing is copied
+     */
+    virtual bool start(void *dst, const void *src, size_t size) = 0;
+
+    /**
+     * @brief Whether all the started copies are complete.
+     *
+     * @return true if they are complete
+     */
+    virtual bool done() = 0;
+
+    /**
+     * @brief Block until all the started copies are complete.
+     */
+    virtual void wait() = 0;
+};
+
+/**
+ * @brief Copies with memcpy before start returns. It is a correctness fallback, not an optimization: the copies do not
+ * overlap the inference, each forward first waits for the copy of the weights of the next module. Used on the host, to
+ * test the prefetch, and on the chips without async memcpy.
+ */
+class WeightPrefetchMemcpy : public WeightPrefetchBackend {
+public:
+    bool start(void *dst, const void *src, size_t size);
+    bool done() { return true; }
+    void wait() {}
+};
+
+#if DL_WEIGHT_PREFETCH_DMA
+/**
+ * @brief Copies with the GDMA async memcpy while the CPU computes. The weights the DMA can not read, in flash or not
+ * aligned for it, are copied with memcpy before start returns.
+ */
+class WeightPrefetchDma : public WeightPrefetchBackend {
+private:
+    async_memcpy_handle_t m_handle;                   /*!< Async memcpy driver, nullptr if it failed to install */
+    SemaphoreHandle_t m_done;                         /*!< Given by the DMA for each completed copy */
+    int m_pending;                                    /*!< Copies started and not waited for */
+    std::vector<std::pair<void *, size_t>> m_regions; /*!< Destinations of the pending copies */
+
+    static bool copy_done(async_memcpy_handle_t handle, async_memcpy_event_t *event, void *args);
+
+public:
+    /**
+     * @brief Construct a new WeightPrefetchDma object.
+     *
+     * @param backlog  Number of copies the driver can queue
+     */
+    WeightPrefetchDma(int backlog = 8);
+    ~WeightPrefetchDma();
+    void prepare_source(const void *src, size_t size);
+    bool start(void *dst, const void *src, size_t size);
+    bool done();
+    void wait();
+};
+#endif
+
+/**
+ * @brief Copies the weights of the next module into an internal RAM double buffer while the current module computes.
+ *
+ * The prefetched modules are numbered in execution order, module k uses buffer k % 2. While module k computes, the
+ * weights of module k + 1 are copied into the other buffer; the copy for module 0 of the next run starts with the
+ * last module, or after it when both use the same buffer. A module always gets the same buffer, so the operation args
+ * computed for the buffer stay valid from run to run. The weight tensors point to the buffer only during the forward of
+ * their module.
+ */
+class WeightPrefetcher {
+private:
+    typedef struct {
+        TensorBase *tensor; /*!< Weight tensor */
+        void *data;         /*!< Original data of the tensor */
+        size_t offset;      /*!< Offset of the tensor in the buffer */
+        size_t size;        /*!< In bytes */
+    } weight_t;
+
+    typedef struct {
+        int module;                    /*!< Index of the module in the execution plan */
+        std::vector<weight_t> weights; /*!< Weight tensors of the module */
+    } entry_t;
+
+    std::vector<entry_t> m_entries;   /*!< The prefetched modules, in execution order */
+    std::vector<int> m_module_entry;  /*!< Entry of each module of the execution plan, -1 if none */
+    WeightPrefetchBackend *m_backend; /*!< Copies the weights */
+    bool m_own_backend;               /*!< The backend is deleted with the prefetcher */
+    uint8_t *m_buffers[2];            /*!< The double buffer */
+    size_t m_buffer_size;             /*!< In bytes. Size of each buffer */
+    int m_loaded[2];                  /*!< Entry whose weights are in each buffer, -1 if none */
+    int m_pending;                    /*!< Entry whose copy is in flight, -1 if none */
+    int m_deferred;                   /*!< Entry to copy once the current module completes, -1 if none */
+    weight_prefetch_stats_t m_stats;  /*!< Statistics */
+
+    int get_slot(int entry) { return entry % 2; }
+    void start_copy(int entry);
+    void finish_copy();
+
+public:
+    /**
+     * @brief Construct a new WeightPrefetcher object.
+     *
+     * @param backend      Copies the weights, nullptr for the DMA when the chip has one, WeightPrefetchMemcpy
+     *                     otherwise
+     * @param own_backend  Delete the backend with the prefetcher
+     */
+    WeightPrefetcher(WeightPrefetchBackend *backend = nullptr, bool own_backend = true);
+
+    /**
+     * @brief Destroy the WeightPrefetcher object. The weight tensors must point to their original data.
+     */
+    ~WeightPrefetcher();
+
+    /**
+     * @brief Prefetch the weights of a module, modules are added in execution order.
+     *
+     * @param module   Index of the module in the execution plan
+     * @param weights  Weight tensors of the module
+     * @return true if the module is prefetched
+     */
+    bool add_module(int module, const std::vector<TensorBase *> &weights);
+
+    /**
+     * @brief Allocate the double buffer in internal RAM, after the modules are added.
+     *
+     * @return true on success, the prefetcher does nothing otherwise
+     */
+    bool allocate();
+
+    /**
+     * @brief Get the size of each buffer of the double buffer.
+     *
+     * @return In bytes
+     */
+    size_t get_buffer_size() { return m_buffer_size; }
+
+    /**
+     * @brief Get the number of prefetched modules.
+     *
+     * @return The number of modules
+     */
+    int get_module_num() { return m_entries.size(); }
+
+    /**
+     * @brief Called by Model::run before the forward of a module: wait for its weights, point its weight tensors to
+     * them and start copying the weights of the next prefetched module.
+     *
+     * @param module  Index of the module in the execution plan
+     */
+    void before_module(int module);
+
+    /**
+     * @brief Called by Model::run after the forward of a module: point its weight tensors back to their original
+     * data.
+     *
+     * @param module  Index of the module in the execution plan
+     */
+    void after_module(int module);
+
+    /**
+     * @brief Wait for the copy in flight. Needed before the weights are modified or the buffers freed.
+     */
+    void sync();
+
+    /**
+     * @brief Get the statistics.
+     *
+     * @return The statistics since the creation or the last reset_stats
+     */
+    weight_prefetch_stats_t get_stats() { return m_stats; }
+
+    /**
+     * @brief Reset the statistics.
+     */
+    void reset_stats() { m_stats = {}; }
+
+    /**
+     * @brief Print the statistics.
+     *
+     * @param prefix  Printed before the statistics
+     */
+    void print_stats(const char *prefix);
+};
+
+} // namespace dl
@@ -1,6 +1,182 @@
 #include "dl_memory_manager.hpp"
+#include "esp_log.h"
+#include <algorithm>
 
 namespace dl {
+/*oooooooooooooooooo00000000000000000000 MemoryManagerBase 00000000000000000000ooooooooooooooooo*/
+
+#if !DL_NO_FBS_MODEL
+void MemoryManagerBase::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
+                                                 std::vector<dl::module::Module *> &execution_plan,
+                                                 ModelContext *context,
+                                                 std::vector<TensorInfo *> &tensor_info)
+{
+    tensor_info.resize(context->get_variable_count());
+    // 1. add graph inputs
+    std::vector<std::string> graph_inputs = fbs_model->get_graph_inputs();
+    int index = -1;
+    std::string name;
+
+    for (int i = 0; i < graph_inputs.size(); i++) {
+        name = graph_inputs[i];
+        index = context->get_variable_index(name);
+
+        if (index >= 0) {
+            TensorInfo *info = new TensorInfo(name,
+                                              0,
+                                              -1,
+                                              fbs_model->get_value_info_shape(name),
+                                              fbs_model->get_value_info_dtype(name),
+                                              fbs_model->get_value_info_exponent(name));
+            tensor_info[index] = info;
+        }
+    }
+
+    // 2. add tensor outputs and update time line of tensors
+    std::vector<std::string> graph_outputs = fbs_model->get_graph_outputs();
+    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
+    std::vector<std::string> op_inputs;
+    std::vector<std::string> op_outputs;
+    for (int i = 0; i < execution_plan.size(); i++) {
+        dl::module::Module *module = execution_plan[i];
+        if (!module) {
+            ESP_LOGE(__FUNCTION__, "module %d is nullptr\n", i);
+            break;
+        }
+
+        // update the time of tensor by node's inputs
+        std::vector<std::vector<int>> input_shapes;
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+
+        for (int j = 0; j < op_inputs.size(); j++) {
+            name = op_inputs[j];
+            index = context->get_variable_index(name);
+            if (index >= 0) {
+                // The previously existing tensor will dirty the input. Must disconnect the inplace link.
+                TensorInfo *follower_tensor = tensor_info[index]->get_inplace_follower_tensor();
+                if (follower_tensor) {
+                    tensor_info[index]->set_inplace_follower_tensor(nullptr);
+                    follower_tensor->set_inplace_leader_tensor(nullptr);
+                }
+
+                auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
+                if (out_iter == graph_outputs.end())
+                    tensor_info[index]->update_time(i + 1); // free this tensor next step
+                input_shapes.push_back(tensor_info[index]->get_shape());
+            } else {
+                TensorBase *tensor = context->get_tensor(name);
+                if (tensor) {
+                    input_shapes.push_back(tensor->get_shape());
+                } else {
+                    input_shapes.push_back({});
+                }
+            }
+        }
+
+        // add output tensors
+        std::vector<std::vector<int>> output_shapes = module->get_output_shape(input_shapes);
+        if ((module->inplace == MODULE_INPLACE_UNCHANGED_BUFFER || module->inplace == MODULE_INPLACE_CHANGED_BUFFER) &&
+            op_outputs.size() == 1) {
+            name = op_outputs[0];
+            TensorInfo *inplace_tensor = nullptr;
+            TensorInfo *info = new TensorInfo(name,
+                                              i,
+                                              -1,
+                                              output_shapes[0],
+                                              fbs_model->get_value_info_dtype(name),
+                                              fbs_model->get_value_info_exponent(name));
+            index = context->get_variable_index(name);
+            tensor_info[index] = info;
+
+            // inplace, loop all inputs and find a suitable inplace tensor
+            for (int j = 0; j < op_inputs.size(); j++) {
+                name = op_inputs[j];
+                index = context->get_variable_index(name);
+                if (index >= 0) {
+                    inplace_tensor = tensor_info[index];
+                    if (inplace_tensor->get_size() >= info->get_size()) {
+                        auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
+                        if (out_iter == graph_outputs.end()) {
+                            break;
+                        } else {
+                            // If op_input is graph output. It can't be set inplace.
+                            inplace_tensor = nullptr;
+                        }
+                    } else {
+                        // If op_input size is less than output. It can't be set inplace.
+                        inplace_tensor = nullptr;
+                    }
+                }
+            }
+            if (inplace_tensor) {
+                TensorInfo *pre_follower_tensor = inplace_tensor->get_inplace_follower_tensor();
+                // The previously existing tensor will dirty the input. Must disconnect the inplace link.
+                if (pre_follower_tensor) {
+                    inplace_tensor->set_inplace_follower_tensor(nullptr);
+                    pre_follower_tensor->set_inplace_leader_tensor(nullptr);
+                }
+
+                // Relink the inplace.
+                info->set_inplace_leader_tensor(inplace_tensor);
+                if (module->inplace == MODULE_INPLACE_CHANGED_BUFFER) {
+                    inplace_tensor->set_inplace_follower_tensor(info);
+                }
+            }
+        } else {
+            for (int j = 0; j < op_outputs.size(); j++) {
+                name = op_outputs[j];
+                TensorInfo *info = new TensorInfo(name,
+                                                  i,
+                                                  -1,
+                                                  output_shapes[j],
+                                                  fbs_model->get_value_info_dtype(name),
+                                                  fbs_model->get_value_info_exponent(name));
+                index = context->get_variable_index(name);
+                tensor_info[index] = info;
+            }
+        }
+    }
+
+    // 3. count the bytes each module reads and writes, once the inplace links are final
+    for (int i = 0; i < execution_plan.size() && i < sorted_nodes.size(); i++) {
+        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
+        for (int j = 0; j < op_inputs.size(); j++) {
+            index = context->get_variable_index(op_inputs[j]);
+            if (index >= 0 && tensor_info[index]) {
+                tensor_info[index]->add_access_bytes(tensor_info[index]->get_size());
+            }
+        }
+        for (int j = 0; j < op_outputs.size(); j++) {
+            index = context->get_variable_index(op_outputs[j]);
+            if (index >= 0 && tensor_info[index]) {
+                tensor_info[index]->add_access_bytes(tensor_info[index]->get_size());
+            }
+        }
+    }
+}
+
+#endif
+
+void MemoryManagerBase::update_plan_info(std::vector<TensorInfo *> &tensor_info, size_t internal_size, size_t psram_size)
+{
+    this->plan_info = {};
+    this->plan_info.internal_size = internal_size;
+    this->plan_info.psram_size = psram_size;
+    for (int i = 0; i < tensor_info.size(); i++) {
+        if (!tensor_info[i] || tensor_info[i]->is_inplaced()) {
+            continue;
+        }
+        this->plan_info.tensor_num++;
+        // Without PSRAM the tensors are placed in internal RAM by their offset
+        if (!this->psram || tensor_info[i]->get_internal_state()) {
+            this->plan_info.internal_tensor_num++;
+            this->plan_info.internal_access_bytes += tensor_info[i]->get_access_bytes();
+        } else {
+            this->plan_info.psram_access_bytes += tensor_info[i]->get_access_bytes();
+        }
+    }
+}
+
 /*oooooooooooooooooo00000000000000000000 TensorInfo 00000000000000000000ooooooooooooooooo*/
 
 TensorInfo::TensorInfo(std::string &name,
@@ -39,6 +215,7 @@ TensorInfo::TensorInfo(std::string &name,
     }
 
     this->call_times = 0;
+    this->access_bytes = 0;
     this->offset = 0;
     this->internal_offset = 0;
 }
@@ -77,7 +254,7 @@ TensorBase *TensorInfo::create_tensor(void *internal_root, void *psram_root)
     uint8_t *element = nullptr;
 
 #if CONFIG_SPIRAM
-    if (this->is_internal) {
+    if (this->get_internal_state()) {
         element = (uint8_t *)internal_root + this->get_internal_offset();
     } else {
         element = (uint8_t *)psram_root + this->get_offset();
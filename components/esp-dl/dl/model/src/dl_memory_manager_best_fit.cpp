@@ -0,0 +1,203 @@
+#include <stdint.h>
+
+#include "dl_memory_manager_best_fit.hpp"
+#include "esp_log.h"
+#include <algorithm>
+
+namespace dl {
+
+#if !DL_NO_FBS_MODEL
+static const char *TAG = "MemoryManagerBestFit";
+
+bool MemoryManagerBestFit::alloc(fbs::FbsModel *fbs_model,
+                                 std::vector<dl::module::Module *> &execution_plan,
+                                 ModelContext *context)
+{
+    std::vector<TensorInfo *> tensor_info;
+    // get all tensor info from flatbuffers
+    get_tensor_info_from_fbs(fbs_model, execution_plan, context, tensor_info);
+
+    // place the tensors
+    size_t max_internal_size = this->max_internal_size;
+#if CONFIG_SPIRAM
+    this->psram = true;
+    size_t largest_internal_size = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+    if (max_internal_size > largest_internal_size) {
+        max_internal_size = largest_internal_size;
+    }
+#else
+    this->psram = false;
+#endif
+    simulate(tensor_info, execution_plan.size(), max_internal_size);
+    ESP_LOGD(TAG,
+             "internal RAM: %d bytes, PSRAM: %d bytes, %d/%d tensors in internal RAM",
+             (int)this->plan_info.internal_size,
+             (int)this->plan_info.psram_size,
+             this->plan_info.internal_tensor_num,
+             this->plan_info.tensor_num);
+
+    void *psram_root = nullptr;
+    void *internal_root = nullptr;
+
+    // alloc memory for tensors
+    if (context->root_alloc(this->plan_info.internal_size, this->plan_info.psram_size, this->alignment)) {
+        psram_root = context->get_psram_root();
+        internal_root = context->get_internal_root();
+
+        // start to allocate tensors
+        for (int i = 0; i < tensor_info.size(); i++) {
+            context->update_tensor(i, tensor_info[i]->create_tensor(internal_root, psram_root));
+        }
+    } else {
+        ESP_LOGE(TAG, "root_alloc failed");
+    }
+
+    // free TensorInfo vector
+    for (int i = 0; i < tensor_info.size(); i++) {
+        delete tensor_info[i];
+    }
+
+    if (psram_root || internal_root) {
+        return true;
+    }
+
+    return false;
+}
+
+void MemoryManagerBestFit::plan(fbs::FbsModel *fbs_model,
+                                std::vector<dl::module::Module *> &execution_plan,
+                                ModelContext *context,
+                                bool psram)
+{
+    std::vector<TensorInfo *> tensor_info;
+    get_tensor_info_from_fbs(fbs_model, execution_plan, context, tensor_info);
+
+    this->plan(tensor_info, execution_plan.size(), psram);
+
+    for (int i = 0; i < tensor_info.size(); i++) {
+        delete tensor_info[i];
+    }
+}
+#endif
+
+void MemoryManagerBestFit::plan(std::vector<TensorInfo *> &tensor_info, int node_num, bool psram)
+{
+    this->psram = psram;
+    simulate(tensor_info, node_num, this->max_internal_size);
+}
+
+size_t MemoryManagerBestFit::find_offset(std::vector<placement_t *> &placed, placement_t *item, size_t limit)
+{
+    // only the tensors alive at the same time as the item constrain it
+    std::vector<placement_t *> alive;
+    for (int i = 0; i < placed.size(); i++) {
+        if (placed[i]->begin < item->end && item->begin < placed[i]->end) {
+            alive.push_back(placed[i]);
+        }
+    }
+    std::sort(alive.begin(), alive.end(), [](placement_t *a, placement_t *b) { return a->offset < b->offset; });
+
+    size_t best_offset = SIZE_MAX;
+    size_t best_gap = SIZE_MAX;
+    size_t top = 0;
+    for (int i = 0; i < alive.size(); i++) {
+        if (alive[i]->offset >= top + item->size && alive[i]->offset - top < best_gap) {
+            best_offset = top;
+            best_gap = alive[i]->offset - top;
+        }
+        top = std::max(top, alive[i]->offset + alive[i]->size);
+    }
+
+    if (limit == SIZE_MAX) {
+        // a growing memory only grows when no gap fits
+        if (best_offset == SIZE_MAX) {
+            best_offset = top;
+        }
+    } else if (top + item->size <= limit && limit - top < best_gap) {
+        best_offset = top;
+    }
+    return best_offset;
+}
+
+void MemoryManagerBestFit::simulate(std::vector<TensorInfo *> &tensor_info, int node_num, size_t max_internal_size)
+{
+    std::vector<placement_t> items;
+    for (int i = 0; i < tensor_info.size(); i++) {
+        // If this tensor is inplaced by other tensor, skip it
+        if (!tensor_info[i] || tensor_info[i]->is_inplaced()) {
+            continue;
+        }
+
+        placement_t item;
+        item.tensor = tensor_info[i];
+        item.size = (tensor_info[i]->get_size() + this->alignment - 1) / this->alignment * this->alignment;
+        item.begin = tensor_info[i]->get_time_begin();
+        item.end = tensor_info[i]->get_time_end();
+        if (item.end < 0 || item.end > node_num) {
+            item.end = node_num; // never freed
+        }
+        if (item.end <= item.begin) {
+            item.end = item.begin + 1;
+        }
+        item.offset = 0;
+        items.push_back(item);
+    }
+
+    std::vector<placement_t *> candidates;
+    for (int i = 0; i < items.size(); i++) {
+        candidates.push_back(&items[i]);
+    }
+
+    // pin the tensors with the most accesses per byte to internal RAM
+    std::vector<placement_t *> internal_placed;
+    std::vector<placement_t *> others;
+    size_t internal_size = 0;
+    if (this->psram && max_internal_size > this->alignment) {
+        std::sort(candidates.begin(), candidates.end(), [](placement_t *a, placement_t *b) {
+            uint64_t a_density = (uint64_t)a->tensor->get_access_bytes() * b->size;
+            uint64_t b_density = (uint64_t)b->tensor->get_access_bytes() * a->size;
+            if (a_density != b_density) {
+                return a_density > b_density;
+            }
+            return a->tensor->get_access_bytes() > b->tensor->get_access_bytes();
+        });
+        for (int i = 0; i < candidates.size(); i++) {
+            size_t offset = find_offset(internal_placed, candidates[i], max_internal_size);
+            if (offset == SIZE_MAX) {
+                others.push_back(candidates[i]);
+                continue;
+            }
+            candidates[i]->offset = offset;
+            candidates[i]->tensor->set_internal_offset(offset);
+            internal_placed.push_back(candidates[i]);
+            internal_size = std::max(internal_size, offset + candidates[i]->size);
+        }
+    } else {
+        others = candidates;
+    }
+
+    // pack the others from the largest to the smallest, in PSRAM or, without PSRAM, in internal RAM
+    std::stable_sort(others.begin(), others.end(), [](placement_t *a, placement_t *b) {
+        if (a->size != b->size) {
+            return a->size > b->size;
+        }
+        return a->begin < b->begin;
+    });
+    std::vector<placement_t *> placed;
+    size_t size = 0;
+    for (int i = 0; i < others.size(); i++) {
+        size_t offset = find_offset(placed, others[i], SIZE_MAX);
+        others[i]->offset = offset;
+        others[i]->tensor->set_offset(offset);
+        placed.push_back(others[i]);
+        size = std::max(size, offset + others[i]->size);
+    }
+
+    if (this->psram) {
+        update_plan_info(tensor_info, internal_size, size);
+    } else {
+        update_plan_info(tensor_info, size, 0);
+    }
+}
+
+} // namespace dl
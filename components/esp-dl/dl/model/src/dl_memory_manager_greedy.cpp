@@ -4,10 +4,11 @@
 #include "esp_log.h"
 #include <algorithm>
 
-static const char *TAG = "MemoryManagerGreedy";
-
 namespace dl {
 
+#if !DL_NO_FBS_MODEL
+static const char *TAG = "MemoryManagerGreedy";
+
 bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
                                 std::vector<dl::module::Module *> &execution_plan,
                                 ModelContext *context)
@@ -18,27 +19,16 @@ bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
 
     // simulate the memory allocation
 #if CONFIG_SPIRAM
-    if (this->max_internal_size > this->alignment) {
-        simulate_with_internal_memory(tensor_info, execution_plan.size());
-    } else {
-        simulate(tensor_info, execution_plan.size());
-    }
+    this->psram = true;
 #else
-    simulate(tensor_info, execution_plan.size());
+    this->psram = false;
 #endif
+    simulate_plan(tensor_info, execution_plan.size());
 
     void *psram_root = nullptr;
     void *internal_root = nullptr;
-    int psram_size = 0;
-    int internal_size = 0;
-
-    if (!this->psram_memory_list.empty()) {
-        psram_size = psram_memory_list.back()->offset + psram_memory_list.back()->size;
-    }
-
-    if (!this->internal_memory_list.empty()) {
-        internal_size = internal_memory_list.back()->offset + internal_memory_list.back()->size;
-    }
+    int psram_size = this->plan_info.psram_size;
+    int internal_size = this->plan_info.internal_size;
 
     // alloc memory for tensors
     if (context->root_alloc(internal_size, psram_size, this->alignment)) {
@@ -68,141 +58,51 @@ bool MemoryManagerGreedy::alloc(fbs::FbsModel *fbs_model,
     return false;
 }
 
+void MemoryManagerGreedy::plan(fbs::FbsModel *fbs_model,
+                               std::vector<dl::module::Module *> &execution_plan,
+                               ModelContext *context,
+                               bool psram)
+{
+    std::vector<TensorInfo *> tensor_info;
+    get_tensor_info_from_fbs(fbs_model, execution_plan, context, tensor_info);
+
+    this->plan(tensor_info, execution_plan.size(), psram);
+
+    for (int i = 0; i < tensor_info.size(); i++) {
+        delete tensor_info[i];
+    }
+}
+#endif
+
+void MemoryManagerGreedy::plan(std::vector<TensorInfo *> &tensor_info, int node_num, bool psram)
+{
+    this->psram = psram;
+    simulate_plan(tensor_info, node_num);
+    this->free_memory_list();
+}
+
 void MemoryManagerGreedy::free()
 {
     this->free_memory_list();
 }
 
-void MemoryManagerGreedy::get_tensor_info_from_fbs(fbs::FbsModel *fbs_model,
-                                                   std::vector<dl::module::Module *> execution_plan,
-                                                   ModelContext *context,
-                                                   std::vector<TensorInfo *> &tensor_info)
+void MemoryManagerGreedy::simulate_plan(std::vector<TensorInfo *> &tensor_info, int node_num)
 {
-    tensor_info.resize(context->get_variable_count());
-    // 1. add graph inputs
-    std::vector<std::string> graph_inputs = fbs_model->get_graph_inputs();
-    int index = -1;
-    std::string name;
-
-    for (int i = 0; i < graph_inputs.size(); i++) {
-        name = graph_inputs[i];
-        index = context->get_variable_index(name);
-
-        if (index >= 0) {
-            TensorInfo *info = new TensorInfo(name,
-                                              0,
-                                              -1,
-                                              fbs_model->get_value_info_shape(name),
-                                              fbs_model->get_value_info_dtype(name),
-                                              fbs_model->get_value_info_exponent(name));
-            tensor_info[index] = info;
-        }
+    if (this->psram && this->max_internal_size > this->alignment) {
+        simulate_with_internal_memory(tensor_info, node_num);
+    } else {
+        simulate(tensor_info, node_num);
     }
 
-    // 2. add tensor outputs and update time line of tensors
-    std::vector<std::string> graph_outputs = fbs_model->get_graph_outputs();
-    std::vector<std::string> sorted_nodes = fbs_model->topological_sort();
-    std::vector<std::string> op_inputs;
-    std::vector<std::string> op_outputs;
-    for (int i = 0; i < execution_plan.size(); i++) {
-        dl::module::Module *module = execution_plan[i];
-        if (!module) {
-            ESP_LOGE(__FUNCTION__, "module %d is nullptr\n", i);
-            break;
-        }
-
-        // update the time of tensor by node's inputs
-        std::vector<std::vector<int>> input_shapes;
-        fbs_model->get_operation_inputs_and_outputs(sorted_nodes[i], op_inputs, op_outputs);
-
-        for (int j = 0; j < op_inputs.size(); j++) {
-            name = op_inputs[j];
-            index = context->get_variable_index(name);
-            if (index >= 0) {
-                // The previously existing tensor will dirty the input. Must disconnect the inplace link.
-                TensorInfo *follower_tensor = tensor_info[index]->get_inplace_follower_tensor();
-                if (follower_tensor) {
-                    tensor_info[index]->set_inplace_follower_tensor(nullptr);
-                    follower_tensor->set_inplace_leader_tensor(nullptr);
-                }
-
-                auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
-                if (out_iter == graph_outputs.end())
-                    tensor_info[index]->update_time(i + 1); // free this tensor next step
-                input_shapes.push_back(tensor_info[index]->get_shape());
-            } else {
-                TensorBase *tensor = context->get_tensor(name);
-                if (tensor) {
-                    input_shapes.push_back(tensor->get_shape());
-                } else {
-                    input_shapes.push_back({});
-                }
-            }
-        }
-
-        // add output tensors
-        std::vector<std::vector<int>> output_shapes = module->get_output_shape(input_shapes);
-        if ((module->inplace == MODULE_INPLACE_UNCHANGED_BUFFER || module->inplace == MODULE_INPLACE_CHANGED_BUFFER) &&
-            op_outputs.size() == 1) {
-            name = op_outputs[0];
-            TensorInfo *inplace_tensor = nullptr;
-            TensorInfo *info = new TensorInfo(name,
-                                              i,
-                                              -1,
-                                              output_shapes[0],
-                                              fbs_model->get_value_info_dtype(name),
-                                              fbs_model->get_value_info_exponent(name));
-            index = context->get_variable_index(name);
-            tensor_info[index] = info;
-
-            // inplace, loop all inputs and find a suitable inplace tensor
-            for (int j = 0; j < op_inputs.size(); j++) {
-                name = op_inputs[j];
-                index = context->get_variable_index(name);
-                if (index >= 0) {
-                    inplace_tensor = tensor_info[index];
-                    if (inplace_tensor->get_size() >= info->get_size()) {
-                        auto out_iter = std::find(graph_outputs.begin(), graph_outputs.end(), name);
-                        if (out_iter == graph_outputs.end()) {
-                            break;
-                        } else {
-                            // If op_input is graph output. It can't be set inplace.
-                            inplace_tensor = nullptr;
-                        }
-                    } else {
-                        // If op_input size is less than output. It can't be set inplace.
-                        inplace_tensor = nullptr;
-                    }
-                }
-            }
-            if (inplace_tensor) {
-                TensorInfo *pre_follower_tensor = inplace_tensor->get_inplace_follower_tensor();
-                // The previously existing tensor will dirty the input. Must disconnect the inplace link.
-                if (pre_follower_tensor) {
-                    inplace_tensor->set_inplace_follower_tensor(nullptr);
-                    pre_follower_tensor->set_inplace_leader_tensor(nullptr);
-                }
-
-                // Relink the inplace.
-                info->set_inplace_leader_tensor(inplace_tensor);
-                if (module->inplace == MODULE_INPLACE_CHANGED_BUFFER) {
-                    inplace_tensor->set_inplace_follower_tensor(info);
-                }
-            }
-        } else {
-            for (int j = 0; j < op_outputs.size(); j++) {
-                name = op_outputs[j];
-                TensorInfo *info = new TensorInfo(name,
-                                                  i,
-                                                  -1,
-                                                  output_shapes[j],
-                                                  fbs_model->get_value_info_dtype(name),
-                                                  fbs_model->get_value_info_exponent(name));
-                index = context->get_variable_index(name);
-                tensor_info[index] = info;
-            }
-        }
+    size_t psram_size = 0;
+    size_t internal_size = 0;
+    if (!this->psram_memory_list.empty()) {
+        psram_size = psram_memory_list.back()->offset + psram_memory_list.back()->size;
+    }
+    if (!this->internal_memory_list.empty()) {
+        internal_size = internal_memory_list.back()->offset + internal_memory_list.back()->size;
     }
+    update_plan_info(tensor_info, internal_size, psram_size);
 }
 
 void MemoryManagerGreedy::simulate(std::vector<TensorInfo *> &tensor_info, int node_num)
@@ -235,11 +135,11 @@ void MemoryManagerGreedy::simulate(std::vector<TensorInfo *> &tensor_info, int n
 
     for (int i = 0; i < node_num; i++) {
         for (auto it = node_free_tensors[i].begin(); it != node_free_tensors[i].end(); it++) {
-#if CONFIG_SPIRAM
-            free_tensor(*it, this->psram_memory_list, this->psram_free_list);
-#else
-            free_tensor(*it, this->internal_memory_list, this->internal_free_list);
-#endif
+            if (this->psram) {
+                free_tensor(*it, this->psram_memory_list, this->psram_free_list);
+            } else {
+                free_tensor(*it, this->internal_memory_list, this->internal_free_list);
+            }
         }
 
         for (auto it = node_alloc_tensors[i].begin(); it != node_alloc_tensors[i].end(); it++) {
@@ -351,13 +251,8 @@ MemoryChunk *MemoryManagerGreedy::free_tensor(TensorInfo *tensor,
 
 MemoryChunk *MemoryManagerGreedy::alloc_tensor(TensorInfo *tensor, int mode)
 {
-#if CONFIG_SPIRAM
-    std::list<MemoryChunk *> &memory_list = this->psram_memory_list;
-    std::list<MemoryChunk *> &free_list = this->psram_free_list;
-#else
-    std::list<MemoryChunk *> &memory_list = this->internal_memory_list;
-    std::list<MemoryChunk *> &free_list = this->internal_free_list;
-#endif
+    std::list<MemoryChunk *> &memory_list = this->psram ? this->psram_memory_list : this->internal_memory_list;
+    std::list<MemoryChunk *> &free_list = this->psram ? this->psram_free_list : this->internal_free_list;
     // printf("alloc tensor:%s\n", tensor->name.c_str());
     MemoryChunk *chunk = nullptr;
     for (auto it = free_list.begin(); it != free_list.end(); ++it) {
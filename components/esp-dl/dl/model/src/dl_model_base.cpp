@@ -1,5 +1,6 @@
 #include <stdint.h>
 
+#include "dl_memory_manager_best_fit.hpp"
 #include "dl_memory_manager_greedy.hpp"
 #include "dl_model_base.hpp"
 #include "dl_module_creator.hpp"
@@ -98,6 +99,15 @@ Model::~Model()
             delete m_execution_plan[i];
         }
     }
+    if (m_profiler) {
+        delete m_profiler;
+    }
+    if (m_prefetcher) {
+        delete m_prefetcher;
+    }
+    if (m_module_worker) {
+        dl::module::ModuleWorker::stop();
+    }
 }
 
 esp_err_t Model::load(const char *name, fbs::model_location_type_t location, const uint8_t *key, bool param_copy)
@@ -183,19 +193,24 @@ esp_err_t Model::load(fbs::FbsModel *fbs_model)
     return ret;
 }
 
+MemoryManagerBase *Model::create_memory_manager(size_t max_internal_size, memory_manager_t mm_type)
+{
+    if (mm_type == MEMORY_MANAGER_GREEDY) {
+        return new MemoryManagerGreedy(max_internal_size);
+    } else if (mm_type == MEMORY_MANAGER_BEST_FIT) {
+        return new MemoryManagerBestFit(max_internal_size);
+    }
+    ESP_LOGW(TAG, "Memory manager(%d) is not supported yet. Use MemoryManagerGreedy instead.", mm_type);
+    return new MemoryManagerGreedy(max_internal_size);
+}
+
 void Model::build(size_t max_internal_size, memory_manager_t mm_type, bool preload)
 {
     // If memory manager has been created, delete it and reset all modules
     m_fbs_model->load_map();
-    MemoryManagerBase *memory_manager = nullptr;
-
-    if (mm_type == MEMORY_MANAGER_GREEDY) {
-        memory_manager = new MemoryManagerGreedy(max_internal_size);
-    } else {
-        ESP_LOGW(TAG, "Memory manager(%d) is not supported yet. Use MemoryManagerGreedy instead.", mm_type);
-        memory_manager = new MemoryManagerGreedy(max_internal_size);
-    }
+    MemoryManagerBase *memory_manager = create_memory_manager(max_internal_size, mm_type);
     memory_manager->alloc(m_fbs_model, m_execution_plan, m_model_context);
+    m_memory_plan = memory_manager->get_plan_info();
 
     // get the TensorBase* of inputs and outputs
     std::vector<std::string> inputs_tmp = m_fbs_model->get_graph_inputs();
@@ -211,21 +226,79 @@ void Model::build(size_t max_internal_size, memory_manager_t mm_type, bool prelo
         m_outputs.emplace(outputs_tmp[i], output_tensor);
     }
 
+    // compute the operation args once, the forwards reuse them
+    int multi_core_num = 0;
+    for (int i = 0; i < m_execution_plan.size(); i++) {
+        if (m_execution_plan[i]) {
+            m_execution_plan[i]->prepare(m_model_context, RUNTIME_MODE_SINGLE_CORE);
+            if (m_execution_plan[i]->support_multi_core()) {
+                multi_core_num++;
+            } else {
+                // Module::name is only kept with DL_LOG_MODULE_NAME
+                ESP_LOGD(TAG,
+                         "Module %d(%s) runs on one core.",
+                         i,
+                         m_execution_plan[i]->name ? m_execution_plan[i]->name : "unnamed");
+            }
+        }
+    }
+    ESP_LOGD(TAG, "%d/%d modules run on both cores.", multi_core_num, (int)m_execution_plan.size());
+    if (multi_core_num && !m_module_worker) {
+        // the tasks of the dual core runs are created once, not on every forward
+        m_module_worker = dl::module::ModuleWorker::start();
+    }
+    m_model_context->reset_args_compute_count();
+    m_model_context->reset_heap_alloc_count();
+
     m_fbs_model->clear_map();
     delete memory_manager;
 }
 
+memory_plan_t Model::plan_memory(size_t max_internal_size, memory_manager_t mm_type, bool psram)
+{
+    m_fbs_model->load_map();
+    MemoryManagerBase *memory_manager = create_memory_manager(max_internal_size, mm_type);
+    memory_manager->plan(m_fbs_model, m_execution_plan, m_model_context, psram);
+    memory_plan_t plan = memory_manager->get_plan_info();
+    delete memory_manager;
+    m_fbs_model->clear_map();
+    return plan;
+}
+
+void Model::forward_module(int index, runtime_mode_t mode, bool profile)
+{
+    if (m_prefetcher) {
+        m_prefetcher->before_module(index);
+    }
+    if (profile) {
+        module_profile_t *record = m_profiler->begin_module(index);
+        m_execution_plan[index]->forward(m_model_context, mode);
+        m_profiler->end_module(record);
+    } else {
+        m_execution_plan[index]->forward(m_model_context, mode);
+    }
+    if (m_prefetcher) {
+        m_prefetcher->after_module(index);
+    }
+}
+
 void Model::run(runtime_mode_t mode)
 {
+    bool profile = m_profiler && m_profiler->begin_run(mode);
     // execute each module.
+    m_model_context->begin_forward();
     for (int i = 0; i < m_execution_plan.size(); i++) {
         dl::module::Module *module = m_execution_plan[i];
         if (module) {
-            module->forward(m_model_context, mode);
+            this->forward_module(i, mode, profile);
         } else {
             break;
         }
     }
+    m_model_context->end_forward();
+    if (profile) {
+        m_profiler->end_run();
+    }
 }
 
 void Model::run(TensorBase *input, runtime_mode_t mode)
@@ -272,10 +345,11 @@ void Model::run(std::map<std::string, TensorBase *> &user_inputs,
     }
 
     // execute each module.
+    bool profile = m_profiler && m_profiler->begin_run(mode);
     for (int i = 0; i < m_execution_plan.size(); i++) {
         dl::module::Module *module = m_execution_plan[i];
         if (module) {
-            module->forward(m_model_context, mode);
+            this->forward_module(i, mode, profile);
             // get the intermediate tensor for debug.
             if (!user_outputs.empty()) {
                 for (auto user_outputs_iter = user_outputs.begin(); user_outputs_iter != user_outputs.end();
@@ -297,6 +371,9 @@ void Model::run(std::map<std::string, TensorBase *> &user_inputs,
             break;
         }
     }
+    if (profile) {
+        m_profiler->end_run();
+    }
     return;
 }
 
@@ -365,6 +442,97 @@ std::string Model::get_metadata_prop(const std::string &key)
     return m_fbs_model->get_model_metadata_prop(key);
 }
 
+ModelProfiler *Model::enable_profiler(size_t capacity)
+{
+    if (!m_profiler) {
+        if (!m_fbs_model || !m_model_context) {
+            ESP_LOGE(TAG, "Build the model before enabling the profiler.");
+            return nullptr;
+        }
+        m_profiler = new ModelProfiler(m_name, capacity);
+        m_fbs_model->load_map();
+        std::vector<std::string> sorted_nodes = m_fbs_model->topological_sort();
+        assert(sorted_nodes.size() == m_execution_plan.size());
+        for (int i = 0; i < m_execution_plan.size(); i++) {
+            m_profiler->add_module(m_execution_plan[i],
+                                   sorted_nodes[i],
+                                   m_fbs_model->get_operation_type(sorted_nodes[i]),
+                                   m_model_context);
+        }
+        m_fbs_model->clear_map();
+    }
+    m_profiler->set_enabled(true);
+    return m_profiler;
+}
+
+void Model::disable_profiler()
+{
+    if (m_profiler) {
+        m_profiler->set_enabled(false);
+    }
+}
+
+WeightPrefetcher *Model::enable_weight_prefetch(size_t max_buffer_size, WeightPrefetchBackend *backend)
+{
+    this->disable_weight_prefetch();
+    if (!m_model_context || m_execution_plan.empty()) {
+        ESP_LOGE(TAG, "Build the model before enabling the weight prefetch.");
+        if (backend) {
+            delete backend;
+        }
+        return nullptr;
+    }
+
+    m_prefetcher = new WeightPrefetcher(backend);
+    for (int i = 0; i < m_execution_plan.size(); i++) {
+        dl::module::Module *module = m_execution_plan[i];
+        if (!module) {
+            break;
+        }
+        // the weights in PSRAM or flash, those already in internal RAM gain nothing
+        std::vector<TensorBase *> weights;
+        size_t size = 0;
+        for (int j = 0; j < module->m_inputs_index.size(); j++) {
+            if (module->m_inputs_index[j] < CONTEXT_PARAMETER_OFFSET) {
+                continue;
+            }
+            TensorBase *weight = m_model_context->get_tensor(module->m_inputs_index[j]);
+            if (!weight || !weight->data) {
+                continue;
+            }
+            int type = tool::memory_addr_type(weight->data);
+            if (type != MEMORY_ADDR_PSRAM && type != MEMORY_ADDR_FLASH) {
+                continue;
+            }
+            weights.push_back(weight);
+            size += (weight->get_bytes() + DL_WEIGHT_PREFETCH_ALIGN - 1) & ~(DL_WEIGHT_PREFETCH_ALIGN - 1);
+        }
+        if (size >= DL_WEIGHT_PREFETCH_MIN_SIZE && size <= max_buffer_size) {
+            m_prefetcher->add_module(i, weights);
+        }
+    }
+
+    if (m_prefetcher->get_module_num() == 0 || !m_prefetcher->allocate()) {
+        ESP_LOGW(TAG, "No weights to prefetch.");
+        delete m_prefetcher;
+        m_prefetcher = nullptr;
+        return nullptr;
+    }
+    ESP_LOGI(TAG,
+             "Prefetch the weights of %d modules into 2 x %d bytes of internal RAM.",
+             m_prefetcher->get_module_num(),
+             (int)m_prefetcher->get_buffer_size());
+    return m_prefetcher;
+}
+
+void Model::disable_weight_prefetch()
+{
+    if (m_prefetcher) {
+        delete m_prefetcher;
+        m_prefetcher = nullptr;
+    }
+}
+
 void Model::print()
 {
     if (!m_execution_plan.empty()) {
@@ -522,10 +690,10 @@ std::map<std::string, module_info> Model::get_module_info()
         DL_LOG_LATENCY_END();
         uint32_t module_latency = DL_LOG_LATENCY_GET();
         total_latency += module_latency;
-        module_info[module_name] = {module_type, module_latency};
+        module_info[module_name] = {module_type, module_latency, m_execution_plan[i]->support_multi_core()};
     }
     m_fbs_model->clear_map();
-    module_info["total"] = {"", total_latency};
+    module_info["total"] = {"", total_latency, false};
     return module_info;
 }
 
@@ -623,10 +791,23 @@ static void print_memory_info(const std::map<std::string, mem_info_t> &info)
     }
 }
 
+static void print_memory_plan(const memory_plan_t &plan)
+{
+    size_t access_bytes = plan.internal_access_bytes + plan.psram_access_bytes;
+    ESP_LOGI(TAG,
+             "variable plan: %.2fKB internal RAM, %.2fKB PSRAM, %d/%d tensors and %.1f%% of the accesses in internal "
+             "RAM",
+             plan.internal_size / 1024.f,
+             plan.psram_size / 1024.f,
+             plan.internal_tensor_num,
+             plan.tensor_num,
+             access_bytes ? plan.internal_access_bytes * 100.f / access_bytes : 0.f);
+}
+
 void Model::print_module_info(const std::map<std::string, module_info> &info, bool sort_module_by_latency)
 {
     std::string table_name = "module summary";
-    std::vector<std::string> col_headers = {"name", "type", "latency"};
+    std::vector<std::string> col_headers = {"name", "type", "latency", "multi core"};
     size_t col0_width = col_headers[0].size();
     size_t col1_width = col_headers[1].size();
     for (const auto &module_info : info) {
@@ -640,19 +821,22 @@ void Model::print_module_info(const std::map<std::string, module_info> &info, bo
     snprintf(latency_str, sizeof(latency_str), "%ldus", info.at("total").latency);
 #endif
     size_t col2_width = std::max(col_headers[2].size(), strlen(latency_str));
-    std::string sep = gen_sep_str({col0_width, col1_width, col2_width});
+    size_t col3_width = col_headers[3].size();
+    std::string sep = gen_sep_str({col0_width, col1_width, col2_width, col3_width});
 
     // table name
     print_table_name(table_name, sep);
     // col_headers
     ESP_LOGI(TAG,
-             "| %-*s | %-*s | %-*s |",
+             "| %-*s | %-*s | %-*s | %-*s |",
              col0_width,
              col_headers[0].c_str(),
              col1_width,
              col_headers[1].c_str(),
              col2_width,
-             col_headers[2].c_str());
+             col_headers[2].c_str(),
+             col3_width,
+             col_headers[3].c_str());
     ESP_LOGI(TAG, "%s", sep.c_str());
     // body
     if (sort_module_by_latency) {
@@ -666,19 +850,22 @@ void Model::print_module_info(const std::map<std::string, module_info> &info, bo
             std::string name = std::get<0>(info_pair);
             std::string type = std::get<1>(info_pair).type;
             uint32_t latency = std::get<1>(info_pair).latency;
+            bool multi_core = std::get<1>(info_pair).multi_core;
 #if DL_LOG_LATENCY_UNIT
             snprintf(latency_str, sizeof(latency_str), "%ldcycle", latency);
 #else
             snprintf(latency_str, sizeof(latency_str), "%ldus", latency);
 #endif
             ESP_LOGI(TAG,
-                     "| %-*s | %-*s | %-*s |",
+                     "| %-*s | %-*s | %-*s | %-*s |",
                      col0_width,
                      name.c_str(),
                      col1_width,
                      type.c_str(),
                      col2_width,
-                     latency_str);
+                     latency_str,
+                     col3_width,
+                     multi_core ? "yes" : "");
             ESP_LOGI(TAG, "%s", sep.c_str());
         }
     } else {
@@ -691,16 +878,38 @@ void Model::print_module_info(const std::map<std::string, module_info> &info, bo
             snprintf(latency_str, sizeof(latency_str), "%ldus", info.at(key).latency);
 #endif
             ESP_LOGI(TAG,
-                     "| %-*s | %-*s | %-*s |",
+                     "| %-*s | %-*s | %-*s | %-*s |",
                      col0_width,
                      key.c_str(),
                      col1_width,
                      info.at(key).type.c_str(),
                      col2_width,
-                     latency_str);
+                     latency_str,
+                     col3_width,
+                     info.at(key).multi_core ? "yes" : "");
             ESP_LOGI(TAG, "%s", sep.c_str());
         }
     }
+
+    // coverage of the dual core runtime, weighted by the single core latency
+    int module_num = 0;
+    int multi_core_num = 0;
+    uint64_t multi_core_latency = 0;
+    for (const auto &module_info : info) {
+        if (module_info.first == "total") {
+            continue;
+        }
+        module_num++;
+        if (module_info.second.multi_core) {
+            multi_core_num++;
+            multi_core_latency += module_info.second.latency;
+        }
+    }
+    ESP_LOGI(TAG,
+             "multi core: %d/%d modules, %.1f%% of the latency.",
+             multi_core_num,
+             module_num,
+             info.at("total").latency ? multi_core_latency * 100.f / info.at("total").latency : 0.f);
 }
 
 void Model::profile_memory()
@@ -717,6 +926,7 @@ void Model::profile_memory()
         ESP_LOGI(TAG, "%s", m_fbs_loader->get_model_location_string());
     }
     print_memory_info(info);
+    print_memory_plan(m_memory_plan);
     printf("\n");
 }
 
@@ -746,6 +956,7 @@ void Model::profile(bool sort_module_by_latency)
     }
     auto mem_info = get_memory_info();
     print_memory_info(mem_info);
+    print_memory_plan(m_memory_plan);
     printf("\n");
     auto module_info = get_module_info();
     print_module_info(module_info, sort_module_by_latency);
@@ -4,8 +4,51 @@
 #include "dl_tool.hpp"
 static const char *TAG = "dl::ModelContext";
 
+#if DL_LOG_HEAP_ALLOC
+#if !CONFIG_HEAP_USE_HOOKS
+#error "DL_LOG_HEAP_ALLOC needs CONFIG_HEAP_USE_HOOKS"
+#endif
+#include "esp_heap_caps.h"
+
+extern "C" HEAP_IRAM_ATTR void esp_heap_trace_alloc_hook(void *ptr, size_t size, uint32_t caps)
+{
+    dl::ModelContext::count_heap_alloc();
+}
+#endif
+
 namespace dl {
 
+std::atomic<int> ModelContext::s_forward_num(0);
+std::atomic<size_t> ModelContext::s_heap_alloc_total(0);
+
+bool ModelContext::reserve_kernel_buffer(size_t size)
+{
+    if (size <= m_kernel_buffer_size) {
+        return true;
+    }
+    kernel_buffer_free();
+    m_kernel_buffer[0] = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+    m_kernel_buffer[1] = heap_caps_malloc(size, MALLOC_CAP_DEFAULT);
+    if (!m_kernel_buffer[0] || !m_kernel_buffer[1]) {
+        ESP_LOGW(TAG, "No memory for the kernel buffers of %d bytes, the kernels allocate them", (int)size);
+        kernel_buffer_free();
+        return false;
+    }
+    m_kernel_buffer_size = size;
+    return true;
+}
+
+void ModelContext::kernel_buffer_free()
+{
+    for (int i = 0; i < 2; i++) {
+        if (m_kernel_buffer[i]) {
+            heap_caps_free(m_kernel_buffer[i]);
+            m_kernel_buffer[i] = nullptr;
+        }
+    }
+    m_kernel_buffer_size = 0;
+}
+
 int ModelContext::add_tensor(const std::string name, bool is_paramter, TensorBase *tensor)
 {
     auto iter = m_name2index.find(name);
@@ -0,0 +1,390 @@
+#include "dl_model_profiler.hpp"
+#include "dl_tool.hpp"
+#include <inttypes.h>
+
+static const char *TAG = "dl::ModelProfiler";
+
+#if CONFIG_ESP32P4_BOOST
+#define DL_PROFILER_CACHE_COUNTERS "true"
+#else
+#define DL_PROFILER_CACHE_COUNTERS "false"
+#endif
+
+namespace dl {
+
+static char get_placement(TensorBase *tensor)
+{
+    if (!tensor || !tensor->get_element_ptr()) {
+        return '-';
+    }
+    void *ptr = tensor->get_element_ptr();
+    if (esp_ptr_external_ram(ptr)) {
+        return 'P';
+    } else if (esp_ptr_in_drom(ptr)) {
+        return 'F';
+    }
+    return 'I';
+}
+
+static const char *get_mode_string(uint8_t mode)
+{
+    switch (mode) {
+    case RUNTIME_MODE_SINGLE_CORE:
+        return "single_core";
+    case RUNTIME_MODE_MULTI_CORE:
+        return "multi_core";
+    default:
+        return "auto";
+    }
+}
+
+// Names come from the model, escape what would break the JSON string.
+static std::string escape_json(const std::string &str)
+{
+    std::string escaped;
+    for (char c : str) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char)c >= 0x20) {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+ModelProfiler::ModelProfiler(const std::string &model_name, size_t capacity) :
+    m_model_name(model_name),
+    m_records(nullptr),
+    m_capacity(capacity),
+    m_next(0),
+    m_count(0),
+    m_run(0),
+    m_mode(RUNTIME_MODE_AUTO),
+    m_enabled(true)
+{
+    m_lock = xSemaphoreCreateMutex();
+    if (m_capacity) {
+        m_records = (module_profile_t *)heap_caps_calloc(m_capacity, sizeof(module_profile_t), MALLOC_CAP_8BIT);
+    }
+    if (!m_lock || !m_records) {
+        ESP_LOGE(TAG, "Failed to allocate a ring of %d records", (int)m_capacity);
+        m_capacity = 0;
+    }
+#if CONFIG_ESP32P4_BOOST
+    REG_WRITE(CACHE_L1_CACHE_ACS_CNT_CTRL_REG, ~0);
+    REG_WRITE(CACHE_L2_CACHE_ACS_CNT_CTRL_REG, ~0);
+#endif
+}
+
+ModelProfiler::~ModelProfiler()
+{
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+    }
+    if (m_records) {
+        heap_caps_free(m_records);
+    }
+}
+
+void ModelProfiler::add_module(module::Module *module,
+                               const std::string &name,
+                               const std::string &type,
+                               ModelContext *context)
+{
+    module_profile_desc_t desc = {};
+    desc.name = name;
+    desc.type = type;
+    desc.multi_core = module->support_multi_core();
+    for (int pass = 0; pass < 2; pass++) {
+        std::vector<int> &indexes = pass ? module->m_outputs_index : module->m_inputs_index;
+        std::string &placements = pass ? desc.outputs : desc.inputs;
+        for (int i = 0; i < indexes.size(); i++) {
+            TensorBase *tensor = context->get_tensor(indexes[i]);
+            char placement = get_placement(tensor);
+            placements += placement;
+            if (placement == 'I') {
+                desc.internal_bytes += tensor->get_bytes();
+            } else if (placement != '-') {
+                desc.external_bytes += tensor->get_bytes();
+            }
+        }
+    }
+    m_modules.push_back(desc);
+}
+
+void ModelProfiler::clear()
+{
+    if (!m_lock) {
+        return;
+    }
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_next = 0;
+    m_count = 0;
+    xSemaphoreGive(m_lock);
+}
+
+bool ModelProfiler::begin_run(runtime_mode_t mode)
+{
+    if (!m_enabled || !m_capacity) {
+        return false;
+    }
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    m_mode = mode;
+    return true;
+}
+
+void ModelProfiler::end_run()
+{
+    m_run++;
+    xSemaphoreGive(m_lock);
+}
+
+module_profile_t *ModelProfiler::begin_module(int index)
+{
+    module_profile_t *record = &m_records[m_next];
+    record->run = m_run;
+    record->module = index;
+    record->mode = m_mode;
+    record->core = xPortGetCoreID();
+#if CONFIG_ESP32P4_BOOST
+    record->l1d_hit = REG_READ(L1_DCACHE_ACS_HIT_CNT_REG_n(record->core));
+    record->l1d_miss = REG_READ(L1_DCACHE_ACS_MISS_CNT_REG_n(record->core));
+    record->l2d_hit = REG_READ(L2_DCACHE_ACS_HIT_CNT_REG_n(record->core));
+    record->l2d_miss = REG_READ(L2_DCACHE_ACS_MISS_CNT_REG_n(record->core));
+#endif
+    module::ModuleSplitRecorder::begin(&record->split);
+    record->start = esp_timer_get_time();
+    return record;
+}
+
+void ModelProfiler::end_module(module_profile_t *record)
+{
+    record->latency = esp_timer_get_time() - record->start;
+    module::ModuleSplitRecorder::end();
+#if CONFIG_ESP32P4_BOOST
+    record->l1d_hit = REG_READ(L1_DCACHE_ACS_HIT_CNT_REG_n(record->core)) - record->l1d_hit;
+    record->l1d_miss = REG_READ(L1_DCACHE_ACS_MISS_CNT_REG_n(record->core)) - record->l1d_miss;
+    record->l2d_hit = REG_READ(L2_DCACHE_ACS_HIT_CNT_REG_n(record->core)) - record->l2d_hit;
+    record->l2d_miss = REG_READ(L2_DCACHE_ACS_MISS_CNT_REG_n(record->core)) - record->l2d_miss;
+#endif
+    m_next = (m_next + 1) % m_capacity;
+    if (m_count < m_capacity) {
+        m_count++;
+    }
+}
+
+std::vector<module_profile_t> ModelProfiler::snapshot()
+{
+    std::vector<module_profile_t> records;
+    if (!m_capacity) {
+        return records;
+    }
+    xSemaphoreTake(m_lock, portMAX_DELAY);
+    records.reserve(m_count);
+    size_t first = (m_next + m_capacity - m_count) % m_capacity;
+    for (size_t i = 0; i < m_count; i++) {
+        records.push_back(m_records[(first + i) % m_capacity]);
+    }
+    xSemaphoreGive(m_lock);
+    return records;
+}
+
+void ModelProfiler::write_json(const profile_writer_t &write)
+{
+    typedef struct {
+        uint32_t count;
+        uint32_t max;
+        uint32_t last;
+        uint64_t sum;
+        uint64_t l1d_hit;
+        uint64_t l1d_miss;
+        uint64_t l2d_hit;
+        uint64_t l2d_miss;
+        uint32_t split_count;
+        uint64_t other_sum;
+    } module_stats_t;
+
+    std::vector<module_profile_t> records = this->snapshot();
+    std::vector<module_stats_t> stats(m_modules.size(), module_stats_t{});
+    for (const module_profile_t &record : records) {
+        if (record.module >= stats.size()) {
+            continue;
+        }
+        module_stats_t &s = stats[record.module];
+        s.count++;
+        s.max = DL_MAX(s.max, record.latency);
+        s.last = record.latency;
+        s.sum += record.latency;
+        s.l1d_hit += record.l1d_hit;
+        s.l1d_miss += record.l1d_miss;
+        s.l2d_hit += record.l2d_hit;
+        s.l2d_miss += record.l2d_miss;
+        if (record.split.split_num) {
+            s.split_count++;
+            s.other_sum += record.split.other_latency;
+        }
+    }
+
+    char buffer[512];
+    int len = snprintf(buffer,
+                       sizeof(buffer),
+                       "{\"model\":\"%s\",\"records\":%d,\"cache_counters\":%s,\"modules\":[",
+                       escape_json(m_model_name).c_str(),
+                       (int)records.size(),
+                       DL_PROFILER_CACHE_COUNTERS);
+    if (!write(buffer, DL_MIN(len, (int)sizeof(buffer) - 1))) {
+        return;
+    }
+    for (int i = 0; i < m_modules.size(); i++) {
+        const module_profile_desc_t &desc = m_modules[i];
+        const module_stats_t &s = stats[i];
+        len = snprintf(buffer,
+                       sizeof(buffer),
+                       "%s{\"index\":%d,\"name\":\"%s\",\"type\":\"%s\",\"multi_core\":%s,\"inputs\":\"%s\","
+                       "\"outputs\":\"%s\",\"internal_bytes\":%u,\"external_bytes\":%u,\"count\":%" PRIu32
+                       ",\"avg_us\":%" PRIu32 ",\"max_us\":%" PRIu32 ",\"last_us\":%" PRIu32 ",\"l1d_hit\":%" PRIu64
+                       ",\"l1d_miss\":%" PRIu64 ",\"l2d_hit\":%" PRIu64 ",\"l2d_miss\":%" PRIu64
+                       ",\"dual_core_count\":%" PRIu32 ",\"other_core_avg_us\":%" PRIu32 "}",
+                       i ? "," : "",
+                       i,
+                       escape_json(desc.name).c_str(),
+                       escape_json(desc.type).c_str(),
+                       desc.multi_core ? "true" : "false",
+                       desc.inputs.c_str(),
+                       desc.outputs.c_str(),
+                       (unsigned)desc.internal_bytes,
+                       (unsigned)desc.external_bytes,
+                       s.count,
+                       s.count ? (uint32_t)(s.sum / s.count) : 0,
+                       s.max,
+                       s.last,
+                       s.l1d_hit,
+                       s.l1d_miss,
+                       s.l2d_hit,
+                       s.l2d_miss,
+                       s.split_count,
+                       s.split_count ? (uint32_t)(s.other_sum / s.split_count) : 0);
+        if (!write(buffer, DL_MIN(len, (int)sizeof(buffer) - 1))) {
+            return;
+        }
+    }
+    write("]}", 2);
+}
+
+void ModelProfiler::write_chrome_trace(const profile_writer_t &write)
+{
+    std::vector<module_profile_t> records = this->snapshot();
+    char buffer[512];
+    int len = snprintf(buffer,
+                       sizeof(buffer),
+                       "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,"
+                       "\"args\":{\"name\":\"%s\"}}",
+                       escape_json(m_model_name).c_str());
+    if (!write(buffer, DL_MIN(len, (int)sizeof(buffer) - 1))) {
+        return;
+    }
+    for (const module_profile_t &record : records) {
+        if (record.module >= m_modules.size()) {
+            continue;
+        }
+        const module_profile_desc_t &desc = m_modules[record.module];
+        len = snprintf(buffer,
+                       sizeof(buffer),
+                       ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRIu32
+                       ",\"pid\":0,\"tid\":%d,\"args\":{\"run\":%" PRIu32 ",\"mode\":\"%s\",\"cores\":%d,"
+                       "\"inputs\":\"%s\",\"outputs\":\"%s\",\"l1d_miss\":%" PRIu32 ",\"l2d_miss\":%" PRIu32 "}}",
+                       escape_json(desc.name).c_str(),
+                       escape_json(desc.type).c_str(),
+                       record.start,
+                       record.latency,
+                       record.core,
+                       record.run,
+                       get_mode_string(record.mode),
+                       record.split.cores,
+                       desc.inputs.c_str(),
+                       desc.outputs.c_str(),
+                       record.l1d_miss,
+                       record.l2d_miss);
+        if (!write(buffer, DL_MIN(len, (int)sizeof(buffer) - 1))) {
+            return;
+        }
+        if (record.split.split_num) {
+            // the part of the other core, from the start of its first part and for the sum of the parts
+            len = snprintf(buffer,
+                           sizeof(buffer),
+                           ",{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%" PRId64 ",\"dur\":%" PRIu32
+                           ",\"pid\":0,\"tid\":%d,\"args\":{\"run\":%" PRIu32 ",\"parts\":%d}}",
+                           escape_json(desc.name).c_str(),
+                           escape_json(desc.type).c_str(),
+                           record.split.other_start,
+                           record.split.other_latency,
+                           (record.core + 1) % 2,
+                           record.run,
+                           record.split.split_num);
+            if (!write(buffer, DL_MIN(len, (int)sizeof(buffer) - 1))) {
+                return;
+            }
+        }
+    }
+    write("]}", 2);
+}
+
+static esp_err_t send_export(httpd_req_t *req, bool trace)
+{
+    ModelProfiler *profiler = (ModelProfiler *)req->user_ctx;
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    bool ok = true;
+    profile_writer_t write = [req, &ok](const char *data, size_t len) {
+        ok = httpd_resp_send_chunk(req, data, len) == ESP_OK;
+        return ok;
+    };
+    if (trace) {
+        profiler->write_chrome_trace(write);
+    } else {
+        profiler->write_json(write);
+    }
+    if (!ok) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+static esp_err_t json_handler(httpd_req_t *req)
+{
+    return send_export(req, false);
+}
+
+static esp_err_t trace_handler(httpd_req_t *req)
+{
+    return send_export(req, true);
+}
+
+esp_err_t ModelProfiler::register_http(httpd_handle_t server, const char *json_uri, const char *trace_uri)
+{
+    httpd_uri_t json = {};
+    json.uri = json_uri;
+    json.method = HTTP_GET;
+    json.handler = json_handler;
+    json.user_ctx = this;
+    esp_err_t ret = httpd_register_uri_handler(server, &json);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register %s: %s", json_uri, esp_err_to_name(ret));
+        return ret;
+    }
+
+    httpd_uri_t trace = {};
+    trace.uri = trace_uri;
+    trace.method = HTTP_GET;
+    trace.handler = trace_handler;
+    trace.user_ctx = this;
+    ret = httpd_register_uri_handler(server, &trace);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register %s: %s", trace_uri, esp_err_to_name(ret));
+        httpd_unregister_uri_handler(server, json_uri, HTTP_GET);
+    }
+    return ret;
+}
+
+} // namespace dl
@@ -0,0 +1,294 @@
+#include "dl_weight_prefetcher.hpp"
+#include "dl_tool.hpp"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#if DL_WEIGHT_PREFETCH_DMA
+#include "esp_attr.h"
+#include "esp_cache.h"
+#endif
+
+static const char *TAG = "dl::WeightPrefetcher";
+
+namespace dl {
+
+bool WeightPrefetchMemcpy::start(void *dst, const void *src, size_t size)
+{
+    memcpy(dst, src, size);
+    return true;
+}
+
+#if DL_WEIGHT_PREFETCH_DMA
+WeightPrefetchDma::WeightPrefetchDma(int backlog) : m_handle(nullptr), m_done(nullptr), m_pending(0)
+{
+    async_memcpy_config_t config = ASYNC_MEMCPY_DEFAULT_CONFIG();
+    config.backlog = backlog;
+    m_done = xSemaphoreCreateCounting(backlog, 0);
+    if (!m_done || esp_async_memcpy_install(&config, &m_handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to install the async memcpy, the weights are copied with memcpy.");
+        m_handle = nullptr;
+    }
+}
+
+WeightPrefetchDma::~WeightPrefetchDma()
+{
+    this->wait();
+    if (m_handle) {
+        esp_async_memcpy_uninstall(m_handle);
+    }
+    if (m_done) {
+        vSemaphoreDelete(m_done);
+    }
+}
+
+IRAM_ATTR bool WeightPrefetchDma::copy_done(async_memcpy_handle_t handle, async_memcpy_event_t *event, void *args)
+{
+    WeightPrefetchDma *backend = (WeightPrefetchDma *)args;
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(backend->m_done, &woken);
+    return woken == pdTRUE;
+}
+
+void WeightPrefetchDma::prepare_source(const void *src, size_t size)
+{
+    // The DMA reads PSRAM behind the cache, the weights written by the CPU must be written back once
+    if (tool::memory_addr_type((void *)src) == MEMORY_ADDR_PSRAM) {
+        esp_cache_msync((void *)src, size, ESP_CACHE_MSYNC_FLAG_DIR_C2M | ESP_CACHE_MSYNC_FLAG_UNALIGNED);
+    }
+}
+
+bool WeightPrefetchDma::start(void *dst, const void *src, size_t size)
+{
+    // The DMA can't read flash, and the driver rejects the addresses it can't align
+    if (!m_handle || tool::memory_addr_type((void *)src) != MEMORY_ADDR_PSRAM) {
+        return false;
+    }
+    if (esp_async_memcpy(m_handle, dst, (void *)src, size, copy_done, this) != ESP_OK) {
+        return false;
+    }
+    m_pending++;
+    m_regions.push_back({dst, size});
+    return true;
+}
+
+bool WeightPrefetchDma::done()
+{
+    return uxSemaphoreGetCount(m_done) >= m_pending;
+}
+
+void WeightPrefetchDma::wait()
+{
+    for (; m_pending > 0; m_pending--) {
+        xSemaphoreTake(m_done, portMAX_DELAY);
+    }
+#if CONFIG_IDF_TARGET_ESP32P4
+    // The L1 cache covers the internal RAM, drop the lines the DMA made stale
+    for (int i = 0; i < m_regions.size(); i++) {
+        size_t size = (m_regions[i].second + DL_WEIGHT_PREFETCH_ALIGN - 1) & ~(DL_WEIGHT_PREFETCH_ALIGN - 1);
+        esp_cache_msync(m_regions[i].first, size, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
+    }
+#endif
+    m_regions.clear();
+}
+#endif
+
+WeightPrefetcher::WeightPrefetcher(WeightPrefetchBackend *backend, bool own_backend) :
+    m_backend(backend), m_own_backend(own_backend), m_buffer_size(0), m_pending(-1), m_deferred(-1), m_stats()
+{
+    if (!m_backend) {
+#if DL_WEIGHT_PREFETCH_DMA
+        m_backend = new WeightPrefetchDma();
+#else
+        ESP_LOGW(TAG, "No async memcpy on this chip, the weights are copied with memcpy, without overlap.");
+        m_backend = new WeightPrefetchMemcpy();
+#endif
+        m_own_backend = true;
+    }
+    m_buffers[0] = nullptr;
+    m_buffers[1] = nullptr;
+    m_loaded[0] = -1;
+    m_loaded[1] = -1;
+}
+
+WeightPrefetcher::~WeightPrefetcher()
+{
+    this->sync();
+    for (int i = 0; i < 2; i++) {
+        if (m_buffers[i]) {
+            heap_caps_free(m_buffers[i]);
+        }
+    }
+    if (m_own_backend) {
+        delete m_backend;
+    }
+}
+
+bool WeightPrefetcher::add_module(int module, const std::vector<TensorBase *> &weights)
+{
+    if (module < 0 || m_buffers[0]) {
+        return false;
+    }
+    entry_t entry;
+    entry.module = module;
+    size_t offset = 0;
+    for (int i = 0; i < weights.size(); i++) {
+        if (!weights[i] || !weights[i]->data || weights[i]->get_bytes() <= 0) {
+            continue;
+        }
+        weight_t weight;
+        weight.tensor = weights[i];
+        weight.data = weights[i]->data;
+        weight.offset = offset;
+        weight.size = weights[i]->get_bytes();
+        entry.weights.push_back(weight);
+        offset += (weight.size + DL_WEIGHT_PREFETCH_ALIGN - 1) & ~(DL_WEIGHT_PREFETCH_ALIGN - 1);
+    }
+    if (entry.weights.empty()) {
+        return false;
+    }
+
+    for (int i = 0; i < entry.weights.size(); i++) {
+        m_backend->prepare_source(entry.weights[i].data, entry.weights[i].size);
+    }
+    if (module >= m_module_entry.size()) {
+        m_module_entry.resize(module + 1, -1);
+    }
+    m_module_entry[module] = m_entries.size();
+    m_entries.push_back(entry);
+    m_buffer_size = std::max(m_buffer_size, offset);
+    return true;
+}
+
+bool WeightPrefetcher::allocate()
+{
+    if (m_entries.empty() || m_buffers[0]) {
+        return m_buffers[0] != nullptr;
+    }
+#if DL_WEIGHT_PREFETCH_DMA
+    uint32_t caps = MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA;
+#else
+    uint32_t caps = MALLOC_CAP_INTERNAL;
+#endif
+    for (int i = 0; i < 2; i++) {
+        m_buffers[i] = (uint8_t *)tool::malloc_aligned(DL_WEIGHT_PREFETCH_ALIGN, m_buffer_size, caps);
+        if (!m_buffers[i]) {
+            ESP_LOGE(TAG, "Failed to allocate %d bytes of internal RAM.", (int)m_buffer_size);
+            if (i) {
+                heap_caps_free(m_buffers[0]);
+                m_buffers[0] = nullptr;
+            }
+            return false;
+        }
+    }
+    return true;
+}
+
+void WeightPrefetcher::start_copy(int entry)
+{
+    int slot = this->get_slot(entry);
+    m_loaded[slot] = -1;
+    std::vector<weight_t> &weights = m_entries[entry].weights;
+    for (int i = 0; i < weights.size(); i++) {
+        if (!m_backend->start(m_buffers[slot] + weights[i].offset, weights[i].data, weights[i].size)) {
+            memcpy(m_buffers[slot] + weights[i].offset, weights[i].data, weights[i].size);
+        }
+        m_stats.copies++;
+        m_stats.bytes += weights[i].size;
+    }
+    m_pending = entry;
+}
+
+void WeightPrefetcher::finish_copy()
+{
+    if (m_pending < 0) {
+        return;
+    }
+    m_backend->wait();
+    m_loaded[this->get_slot(m_pending)] = m_pending;
+    m_pending = -1;
+}
+
+void WeightPrefetcher::sync()
+{
+    m_deferred = -1;
+    this->finish_copy();
+}
+
+void WeightPrefetcher::before_module(int module)
+{
+    if (!m_buffers[0] || module < 0 || module >= m_module_entry.size() || m_module_entry[module] < 0) {
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+    int entry = m_module_entry[module];
+    int slot = this->get_slot(entry);
+    bool stalled = false;
+
+    // wait for the weights of this module, they are copied now if the previous module did not start the copy
+    if (m_pending >= 0) {
+        stalled = !m_backend->done();
+        this->finish_copy();
+    }
+    if (m_loaded[slot] != entry) {
+        stalled = true;
+        this->start_copy(entry);
+        this->finish_copy();
+    }
+    if (entry == 0) {
+        m_stats.runs++;
+    }
+
+    std::vector<weight_t> &weights = m_entries[entry].weights;
+    for (int i = 0; i < weights.size(); i++) {
+        weights[i].tensor->data = m_buffers[slot] + weights[i].offset;
+    }
+
+    // copy the weights of the next module into the other buffer, or into this one once the module completes
+    int next = (entry + 1) % m_entries.size();
+    if (m_loaded[this->get_slot(next)] == next) {
+        // one or two modules, their weights stay in the buffers
+    } else if (this->get_slot(next) != slot) {
+        this->start_copy(next);
+    } else {
+        m_deferred = next;
+    }
+
+    if (stalled) {
+        m_stats.stalls++;
+    }
+    m_stats.stall_us += esp_timer_get_time() - start;
+}
+
+void WeightPrefetcher::after_module(int module)
+{
+    if (!m_buffers[0] || module < 0 || module >= m_module_entry.size() || m_module_entry[module] < 0) {
+        return;
+    }
+    std::vector<weight_t> &weights = m_entries[m_module_entry[module]].weights;
+    for (int i = 0; i < weights.size(); i++) {
+        weights[i].tensor->data = weights[i].data;
+    }
+    if (m_deferred >= 0) {
+        int64_t start = esp_timer_get_time();
+        this->start_copy(m_deferred);
+        m_deferred = -1;
+        m_stats.stall_us += esp_timer_get_time() - start;
+    }
+}
+
+void WeightPrefetcher::print_stats(const char *prefix)
+{
+    printf("%s: %d modules, 2 x %d bytes of internal RAM, %lu runs, %llu bytes prefetched, %lu stalls, %llu us "
+           "stalled\n",
+           prefix,
+           (int)m_entries.size(),
+           (int)m_buffer_size,
+           (unsigned long)m_stats.runs,
+           (unsigned long long)m_stats.bytes,
+           (unsigned long)m_stats.stalls,
+           (unsigned long long)m_stats.stall_us);
+}
+
+} // namespace dl
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "dl_base.hpp"
+#include "dl_model_context.hpp"
+#include "dl_module_base.hpp"
+#include <string.h>
+
+namespace dl {
+namespace module {
+
+#define MODULE_ARGS_KEY_MAX 8 /*!< Maximum number of key items, two per tensor */
+
+/**
+ * @brief Operation arguments of a module, computed by Model::build or by the first forward and reused by every
+ * following forward while the tensors and the runtime mode don't change.
+ *
+ * The args are grouped in runs: a run is one call of the kernel on one or two tasks, a forward executes all the runs.
+ * Only batched MatMul has more than one run. The kernels modify their args while running, so every run works on a
+ * copy on the stack and the stored args stay intact. The accumulators of the C kernels are the kernel buffers of the
+ * model context, reserved when the args are computed, so the forwards don't allocate them.
+ */
+class ModuleArgs {
+private:
+    void *m_args;                        /*!< Args of all runs, m_task_num args per run */
+    size_t m_args_size;                  /*!< In bytes. Size of one args */
+    int m_capacity;                      /*!< Number of args m_args can hold */
+    int m_task_num;                      /*!< Number of tasks per run, 1 or 2 */
+    int m_run_num;                       /*!< Number of runs per forward */
+    bool m_valid;                        /*!< The args match m_mode and m_key */
+    runtime_mode_t m_mode;               /*!< Runtime mode of the args */
+    intptr_t m_key[MODULE_ARGS_KEY_MAX]; /*!< Element pointers and layouts of the tensors of the args */
+    int m_key_num;                       /*!< Number of items in m_key */
+    size_t m_buffer_size;                /*!< In bytes. Accumulators of the C kernels needed by a task */
+    ModelContext *m_context;             /*!< Context of the args being computed, see begin */
+
+public:
+    ModuleArgs() :
+        m_args(nullptr),
+        m_args_size(0),
+        m_capacity(0),
+        m_task_num(0),
+        m_run_num(0),
+        m_valid(false),
+        m_mode(RUNTIME_MODE_AUTO),
+        m_key_num(0),
+        m_buffer_size(0),
+        m_context(nullptr)
+    {
+    }
+
+    ~ModuleArgs()
+    {
+        if (m_args) {
+            heap_caps_free(m_args);
+        }
+    }
+
+    /**
+     * @brief Write the key items of a tensor: its element pointer and a digest of its shape and exponent.
+     *
+     * @param tensor  The tensor, nullptr for an optional input which is not set
+     * @param key     Two key items
+     */
+    static void get_tensor_key(TensorBase *tensor, intptr_t *key)
+    {
+        if (!tensor) {
+            key[0] = 0;
+            key[1] = 0;
+            return;
+        }
+        intptr_t layout = tensor->exponent;
+        for (int i = 0; i < tensor->shape.size(); i++) {
+            layout = layout * 31 + tensor->shape[i];
+        }
+        key[0] = (intptr_t)tensor->get_element_ptr();
+        key[1] = layout;
+    }
+
+    /**
+     * @brief Whether the stored args were computed for this runtime mode and these tensors.
+     *
+     * @param mode     Runtime mode
+     * @param key      Key items, see get_tensor_key
+     * @param key_num  Number of key items
+     *
+     * @return true if the args can be run as they are
+     */
+    bool match(runtime_mode_t mode, const intptr_t *key, int key_num) const
+    {
+        return m_valid && m_mode == mode && m_key_num == key_num &&
+            memcmp(m_key, key, key_num * sizeof(intptr_t)) == 0;
+    }
+
+    /**
+     * @brief Drop the stored args before computing them again. The computation is counted in the context.
+     *
+     * @param context  Model context
+     */
+    void begin(ModelContext *context)
+    {
+        m_valid = false;
+        m_run_num = 0;
+        m_task_num = 0;
+        m_buffer_size = 0;
+        m_context = context;
+        context->add_args_compute_count();
+    }
+
+    /**
+     * @brief Append the args of one run.
+     *
+     * @param args  Args of the tasks of the run, as returned by base::get_conv_operation_args
+     *
+     * @return the index of the run, -1 if the args can't be stored
+     */
+    template <typename T>
+    int append(const std::vector<base::ArgsType<T>> &args)
+    {
+        int task_num = args.size();
+        if ((task_num != 1 && task_num != 2) || (m_run_num && task_num != m_task_num)) {
+            ESP_LOGE("ModuleArgs", "Only support task size is 1 or 2, currently task size is %d", task_num);
+            return -1;
+        }
+        size_t args_size = sizeof(base::ArgsType<T>);
+        int needed = (m_run_num + 1) * task_num;
+        if (args_size != m_args_size || needed > m_capacity) {
+            int capacity = m_run_num ? needed * 2 : needed;
+            void *new_args = heap_caps_malloc(capacity * args_size, MALLOC_CAP_8BIT);
+            if (!new_args) {
+                ESP_LOGE("ModuleArgs", "Failed to allocate %d args", capacity);
+                return -1;
+            }
+            if (m_args) {
+                if (m_run_num) {
+                    memcpy(new_args, m_args, m_run_num * m_task_num * args_size);
+                }
+                heap_caps_free(m_args);
+            }
+            m_args = new_args;
+            m_args_size = args_size;
+            m_capacity = capacity;
+        }
+        memcpy((base::ArgsType<T> *)m_args + m_run_num * task_num, args.data(), task_num * args_size);
+        m_task_num = task_num;
+        // int32_t accumulators for int8, DL_S16_BUFFER_TYPE ones for int16
+        size_t buffer_bytes = sizeof(T) == 1 ? sizeof(int32_t) : sizeof(int64_t);
+        for (int i = 0; i < task_num; i++) {
+            m_buffer_size = std::max(m_buffer_size, args[i].output_channel * buffer_bytes);
+        }
+        if (m_context) {
+            m_context->reserve_kernel_buffer(m_buffer_size);
+        }
+        return m_run_num++;
+    }
+
+    /**
+     * @brief Validate the appended args for the runtime mode and the tensors they were computed for.
+     *
+     * @param mode     Runtime mode
+     * @param key      Key items, see get_tensor_key
+     * @param key_num  Number of key items, no more than MODULE_ARGS_KEY_MAX
+     */
+    void end(runtime_mode_t mode, const intptr_t *key, int key_num)
+    {
+        assert(key_num <= MODULE_ARGS_KEY_MAX);
+        memcpy(m_key, key, key_num * sizeof(intptr_t));
+        m_key_num = key_num;
+        m_mode = mode;
+        m_valid = m_run_num > 0;
+    }
+
+    /**
+     * @brief Get the number of runs per forward.
+     *
+     * @return Number of runs
+     */
+    int get_run_num() const { return m_run_num; }
+
+    /**
+     * @brief Run the kernel of the module on a copy of the args of one run.
+     *
+     * @param op       Module instance
+     * @param context  Model context, it holds the accumulators of the C kernels
+     * @param run      Index of the run
+     */
+    template <typename T>
+    void run(Module *op, ModelContext *context, int run)
+    {
+        base::ArgsType<T> args[2];
+        memcpy(args, (base::ArgsType<T> *)m_args + run * m_task_num, m_task_num * sizeof(base::ArgsType<T>));
+        for (int i = 0; i < m_task_num; i++) {
+            args[i].buffer = context->get_kernel_buffer(i, m_buffer_size);
+        }
+        if (m_task_num == 1) { // single task
+            op->forward_args((void *)&args[0]);
+        } else { // multi task, use semaphore to maintain synchronization.
+            module_forward_dual_core(op, (void *)&args[0], (void *)&args[1]);
+        }
+    }
+
+    /**
+     * @brief Run the kernel of the module on a copy of the args of every run.
+     *
+     * @param op       Module instance
+     * @param context  Model context, it holds the accumulators of the C kernels
+     */
+    template <typename T>
+    void run(Module *op, ModelContext *context)
+    {
+        for (int i = 0; i < m_run_num; i++) {
+            run<T>(op, context, i);
+        }
+    }
+};
+
+} // namespace module
+} // namespace dl
@@ -83,6 +83,23 @@ public:
      */
     virtual void forward_args(void *args) {};
 
+    /**
+     * @brief Compute the operation args of the module ahead of the first forward, it is called by Model::build.
+     * The forwards reuse these args while the tensors and the runtime mode don't change.
+     *
+     * @param context   Model context including  all inputs and outputs and other runtime information
+     * @param mode    Runtime mode of the following forwards
+     */
+    virtual void prepare(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE) {}
+
+    /**
+     * @brief Whether the forward of the module runs on both cores with RUNTIME_MODE_MULTI_CORE. It is reported by
+     * Model::build and Model::profile_module.
+     *
+     * @return true if the module splits its work on both cores
+     */
+    virtual bool support_multi_core() { return false; }
+
     /**
      * @brief create module instance by node serialization information
      *
@@ -143,6 +160,106 @@ public:
                      runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE);
 };
 
+/**
+ * @brief A task pinned on one core, which runs the half of a dual core forward given by a task of the other core.
+ * Model::build starts the workers of both cores once, they live until the last model is destroyed, so the dual core
+ * forwards neither create tasks nor semaphores. Without them, module_forward_dual_core and module_forward_split create a
+ * task per call.
+ */
+class ModuleWorker {
+private:
+    TaskHandle_t m_task;       /*!< Worker task */
+    SemaphoreHandle_t m_lock;  /*!< Taken by the task which uses the worker, see acquire */
+    SemaphoreHandle_t m_start; /*!< Given when m_job is set */
+    SemaphoreHandle_t m_done;  /*!< Given when m_job returned */
+    void (*m_job)(void *);     /*!< Job to run, nullptr ends the task */
+    void *m_arg;               /*!< Argument of m_job */
+    int m_core;                /*!< Core of the worker task */
+    int64_t m_job_start;       /*!< Start of the last job, in us since boot */
+    uint32_t m_job_latency;    /*!< Latency of the last job, in us */
+
+    static void task(void *args);
+    bool create(int core);
+    void destroy();
+
+public:
+    /**
+     * @brief Start the workers of both cores, or take a reference on them if they run.
+     *
+     * @return true if the workers run, false on a single core chip or without memory
+     */
+    static bool start();
+
+    /**
+     * @brief Drop a reference taken by start, the workers are deleted with the last one. No forward may be running.
+     */
+    static void stop();
+
+    /**
+     * @brief Whether the workers run.
+     */
+    static bool started();
+
+    /**
+     * @brief Get the worker of the other core for the calling task, it is kept until wait.
+     *
+     * @return The worker, nullptr if the workers don't run or the worker is used by another task
+     */
+    static ModuleWorker *acquire();
+
+    /**
+     * @brief Run a job on the worker at the priority of the calling task. Call wait before the next one.
+     *
+     * @param job  Job to run
+     * @param arg  Argument of job
+     */
+    void run(void (*job)(void *), void *arg);
+
+    /**
+     * @brief Wait for the end of the job, then release the worker. The job is recorded by ModuleSplitRecorder.
+     */
+    void wait();
+};
+
+/**
+ * @brief How one module forward used the cores, see ModuleSplitRecorder.
+ */
+typedef struct {
+    uint8_t cores;          ///< Bit n is set if core n computed a part of the forward
+    uint16_t split_num;     ///< Number of parts computed on the other core
+    int64_t other_start;    ///< Start of the first part computed on the other core, in us since boot
+    uint32_t other_latency; ///< In us. Time of the parts computed on the other core
+} module_split_t;
+
+/**
+ * @brief Records where the forwards of the calling task ran: module_forward_dual_core and module_forward_split add
+ * each part they give to the other core, so a RUNTIME_MODE_MULTI_CORE forward which ran on one core, because it was too
+ * small or the worker was busy, shows as such. The record belongs to the task which called begin.
+ */
+class ModuleSplitRecorder {
+public:
+    /**
+     * @brief Record the forwards of the calling task into split, until end.
+     *
+     * @param split  The record, it is reset with the core of the calling task
+     */
+    static void begin(module_split_t *split);
+
+    /**
+     * @brief Stop recording the forwards of the calling task.
+     */
+    static void end();
+
+    /**
+     * @brief Add a part computed on another core to the record of the calling task, if it records.
+     *
+     * @param core     Core which computed the part
+     * @param start    Start of the part, in us since boot
+     * @param latency  In us. Latency of the part
+     */
+    static void add(int core, int64_t start, uint32_t latency);
+};
+
 /**
  * @brief The data struct of module task. Pack all necessary information as the input for module task.
  */
@@ -150,6 +267,8 @@ typedef struct {
     Module *op;                   ///< Module instance pointer
     void *args;                   ///< ArgsType, arithArgsType, resizeArgsType and so on
     SemaphoreHandle_t &semaphore; ///< recommend xSemaphoreCreateCounting
+    int64_t task_start;           ///< Start of the task, in us since boot
+    uint32_t task_latency;        ///< In us. Latency of the task
 } module_task_data_t;
 
 /**
@@ -159,7 +278,9 @@ typedef struct {
 static void module_forward_task(void *args)
 {
     module_task_data_t *task = (module_task_data_t *)args;
+    task->task_start = esp_timer_get_time();
     task->op->forward_args(task->args);
+    task->task_latency = esp_timer_get_time() - task->task_start;
     xSemaphoreGive(task->semaphore);
     vTaskSuspend(NULL);
 }
@@ -174,6 +295,26 @@ static void module_forward_task(void *args)
  */
 static void module_forward_dual_core(Module *op, void *args1, void *args2)
 {
+    ModuleWorker *worker = ModuleWorker::acquire();
+    if (worker) {
+        std::pair<Module *, void *> job = {op, args1};
+        worker->run(
+            [](void *arg) {
+                std::pair<Module *, void *> *job = (std::pair<Module *, void *> *)arg;
+                job->first->forward_args(job->second);
+            },
+            &job);
+        op->forward_args(args2);
+        worker->wait();
+        return;
+    }
+    if (ModuleWorker::started()) {
+        // the worker is used by the forward of another model
+        op->forward_args(args1);
+        op->forward_args(args2);
+        return;
+    }
+
     BaseType_t current_core_id = xPortGetCoreID();
     UBaseType_t current_priority = uxTaskPriorityGet(xTaskGetCurrentTaskHandle());
     SemaphoreHandle_t semaphore = xSemaphoreCreateCounting(2, 0);
@@ -200,6 +341,127 @@ static void module_forward_dual_core(Module *op, void *args1, void *args2)
     vSemaphoreDelete(semaphore);
     vTaskDelete(xHandleTask1);
     vTaskDelete(xHandleTask2);
+    ModuleSplitRecorder::add((current_core_id + 1) % 2, task_data1.task_start, task_data1.task_latency);
+}
+
+#define DL_MODULE_SPLIT_AUTO_COST (8 * 1024) /*!< Minimum work split by RUNTIME_MODE_AUTO, see module_forward_split */
+
+/**
+ * @brief The data struct of a split task, see module_forward_split.
+ */
+typedef struct {
+    void (*run)(const void *func, int start, int end); ///< Calls func on the outputs [start, end)
+    const void *func;                                   ///< Function object of module_forward_split
+    int start;                                          ///< First output of the task
+    int end;                                            ///< End of the outputs of the task
+    SemaphoreHandle_t semaphore;                        ///< Given when the outputs of the task are computed
+    int64_t task_start;                                 ///< Start of the task, in us since boot
+    uint32_t task_latency;                              ///< In us. Latency of the task
+} module_split_task_data_t;
+
+/**
+ * @brief Call a function object of module_forward_split, through the function pointer of its split task.
+ */
+template <typename Func>
+static void module_split_run(const void *func, int start, int end)
+{
+    (*(const Func *)func)(start, end);
+}
+
+/**
+ * @brief The function of split task.
+ * @param args The data of split task.
+ */
+static void module_split_task(void *args)
+{
+    module_split_task_data_t *task = (module_split_task_data_t *)args;
+    task->task_start = esp_timer_get_time();
+    task->run(task->func, task->start, task->end);
+    task->task_latency = esp_timer_get_time() - task->task_start;
+    xSemaphoreGive(task->semaphore);
+    vTaskSuspend(NULL);
+}
+
+/**
+ * @brief Compute the outputs [0, total) of a module, split in two halves on both cores when the runtime mode allows it.
+ * The first half is computed by a task on the other core and the second half by the calling task. The outputs must be
+ * independent and func must only write the outputs of its range, then the result is bit exact with func(0, total).
+ *
+ * @param mode   RUNTIME_MODE_MULTI_CORE always splits, RUNTIME_MODE_AUTO splits when total * cost reaches
+ *               DL_MODULE_SPLIT_AUTO_COST, because waking the worker or creating the task costs several us
+ * @param total  Number of outputs, e.g. the elements of an activation or the rows of a softmax
+ * @param cost   Number of input elements read to compute one output
+ * @param func   Computes the outputs [start, end), called as func(start, end). A lambda is inlined in the single core
+ *               path, without the indirection of a std::function
+ */
+template <typename Func>
+static void module_forward_split(runtime_mode_t mode, int total, int cost, const Func &func)
+{
+    bool split = total > 1 &&
+        (mode == RUNTIME_MODE_MULTI_CORE ||
+         (mode == RUNTIME_MODE_AUTO && (int64_t)total * cost >= DL_MODULE_SPLIT_AUTO_COST));
+    if (!split) {
+        func(0, total);
+        return;
+    }
+
+    int half = total / 2;
+    ModuleWorker *worker = ModuleWorker::acquire();
+    if (worker) {
+        module_split_task_data_t job = {
+            .run = module_split_run<Func>,
+            .func = &func,
+            .start = 0,
+            .end = half,
+            .semaphore = nullptr,
+        };
+        worker->run(
+            [](void *arg) {
+                module_split_task_data_t *job = (module_split_task_data_t *)arg;
+                job->run(job->func, job->start, job->end);
+            },
+            &job);
+        func(half, total);
+        worker->wait();
+        return;
+    }
+    if (ModuleWorker::started()) {
+        // the worker is used by the forward of another model
+        func(0, total);
+        return;
+    }
+
+    BaseType_t current_core_id = xPortGetCoreID();
+    UBaseType_t current_priority = uxTaskPriorityGet(xTaskGetCurrentTaskHandle());
+    module_split_task_data_t task_data = {
+        .run = module_split_run<Func>,
+        .func = &func,
+        .start = 0,
+        .end = half,
+        .semaphore = xSemaphoreCreateBinary(),
+    };
+    TaskHandle_t xHandleTask = nullptr;
+    if (!task_data.semaphore ||
+        xTaskCreatePinnedToCore(module_split_task,
+                                NULL,
+                                2048,
+                                &task_data,
+                                current_priority,
+                                &xHandleTask,
+                                (current_core_id + 1) % 2) != pdPASS) {
+        // no room for the task, compute everything here
+        if (task_data.semaphore) {
+            vSemaphoreDelete(task_data.semaphore);
+        }
+        func(0, total);
+        return;
+    }
+
+    func(half, total);
+    xSemaphoreTake(task_data.semaphore, portMAX_DELAY);
+    vSemaphoreDelete(task_data.semaphore);
+    vTaskDelete(xHandleTask);
+    ModuleSplitRecorder::add((current_core_id + 1) % 2, task_data.task_start, task_data.task_latency);
 }
 #pragma GCC diagnostic pop
 
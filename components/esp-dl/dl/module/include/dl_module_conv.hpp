@@ -2,6 +2,7 @@
 
 #include "dl_base_conv2d.hpp"
 #include "dl_base_depthwise_conv2d.hpp"
+#include "dl_module_args.hpp"
 #include "dl_module_base.hpp"
 #include <typeinfo>
 #include "freertos/FreeRTOS.h"
@@ -22,6 +23,7 @@ private:
     activation_type_t activation; /*!< activation of Conv, if you don't specify anything, no activation is applied */
     std::vector<int> m_pads;      /*!< pads size needed in [top, bottom, left, right] of this operation */
     bool is_bias_reseted;
+    ModuleArgs m_args; /*!< operation args, computed once and reused by every forward */
 
     void reset_bias(ModelContext *context)
     {
@@ -118,6 +120,8 @@ public:
         }
     }
 
+    bool support_multi_core() { return true; }
+
     void forward(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_AUTO)
     {
         reset_bias(context);
@@ -129,8 +133,19 @@ public:
         }
     }
 
+    void prepare(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE)
+    {
+        reset_bias(context);
+
+        if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+            forward_template<int8_t>(context, mode, false);
+        } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+            forward_template<int16_t>(context, mode, false);
+        }
+    }
+
     template <typename T>
-    void forward_template(ModelContext *context, runtime_mode_t mode)
+    void forward_template(ModelContext *context, runtime_mode_t mode, bool run = true)
     {
         TensorBase *input = context->get_tensor(m_inputs_index[0]);
         TensorBase *filter = context->get_tensor(m_inputs_index[1]);
@@ -140,25 +155,28 @@ public:
         }
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
 
-        std::vector<base::ArgsType<T>> m_args =
-            base::get_conv_operation_args<T>(output,
-                                             input,
-                                             m_pads,
-                                             filter,
-                                             m_strides,
-                                             m_dilations,
-                                             m_group,
-                                             bias,
-                                             this->activation,
-                                             nullptr,
-                                             mode); // do not support RReLU and Leaky RelU
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Conv", "Only support task size is 1 or 2, currently task size is %d", task_size);
+        intptr_t key[8];
+        ModuleArgs::get_tensor_key(input, &key[0]);
+        ModuleArgs::get_tensor_key(filter, &key[2]);
+        ModuleArgs::get_tensor_key(bias, &key[4]);
+        ModuleArgs::get_tensor_key(output, &key[6]);
+        if (!m_args.match(mode, key, 8)) {
+            m_args.begin(context);
+            m_args.append<T>(base::get_conv_operation_args<T>(output,
+                                                              input,
+                                                              m_pads,
+                                                              filter,
+                                                              m_strides,
+                                                              m_dilations,
+                                                              m_group,
+                                                              bias,
+                                                              this->activation,
+                                                              nullptr,
+                                                              mode)); // do not support RReLU and Leaky RelU
+            m_args.end(mode, key, 8);
+        }
+        if (run) {
+            m_args.run<T>(this, context);
         }
     }
 
@@ -52,13 +52,15 @@ public:
             float *input_ptr = (float *)input->get_element_ptr();
             float *output_ptr = (float *)output->get_element_ptr();
 
-            for (size_t i = 0; i < input->size; i++) {
-                if (input_ptr[i] < 0) {
-                    output_ptr[i] = m_alpha * (expf(input_ptr[i]) - 1);
-                } else {
-                    output_ptr[i] = input_ptr[i];
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    if (input_ptr[i] < 0) {
+                        output_ptr[i] = m_alpha * (expf(input_ptr[i]) - 1);
+                    } else {
+                        output_ptr[i] = input_ptr[i];
+                    }
                 }
-            }
+            });
         }
     }
 
@@ -72,16 +74,20 @@ public:
 
         float input_scale = DL_SCALE(input->exponent);
         float output_scale = DL_RESCALE(output->exponent);
-        for (size_t i = 0; i < input->size; i++) {
-            float temp = input_ptr[i] * input_scale;
-            if (temp >= 0) {
-                tool::truncate(output_ptr[i], tool::round(temp * output_scale));
-            } else {
-                tool::truncate(output_ptr[i], tool::round(m_alpha * (expf(temp) - 1) * output_scale));
+        module_forward_split(mode, input->size, 1, [&](int start, int end) {
+            for (int i = start; i < end; i++) {
+                float temp = input_ptr[i] * input_scale;
+                if (temp >= 0) {
+                    tool::truncate(output_ptr[i], tool::round(temp * output_scale));
+                } else {
+                    tool::truncate(output_ptr[i], tool::round(m_alpha * (expf(temp) - 1) * output_scale));
+                }
             }
-        }
+        });
     }
 
+    bool support_multi_core() { return true; }
+
     /**
      * @brief deserialize Elu module instance by node serialization information
      */
@@ -2,6 +2,7 @@
 
 #include "dl_base_conv2d.hpp"
 #include "dl_base_depthwise_conv2d.hpp"
+#include "dl_module_args.hpp"
 #include "dl_module_base.hpp"
 #include <typeinfo>
 #include "freertos/FreeRTOS.h"
@@ -18,6 +19,7 @@ class Gemm : public Module {
 private:
     activation_type_t activation; /*!< activation of Gemm, if you don't specify anything, no activation is applied */
     bool is_bias_reseted;
+    ModuleArgs m_args; /*!< operation args, computed once and reused by every forward */
 
     void reset_bias(ModelContext *context)
     {
@@ -82,10 +84,11 @@ public:
         }
     }
 
+    bool support_multi_core() { return true; }
+
     template <typename T>
-    void forward_template(ModelContext *context, runtime_mode_t mode)
+    void forward_template(ModelContext *context, runtime_mode_t mode, bool run = true)
     {
-        std::vector<int> padding(4, 0);
         TensorBase *input0 = context->get_tensor(m_inputs_index[0]);
         TensorBase *filter = context->get_tensor(m_inputs_index[1]);
         TensorBase *bias = nullptr;
@@ -93,34 +96,38 @@ public:
             bias = context->get_tensor(m_inputs_index[2]);
         }
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
-        std::vector<int> origin_input_shape = input0->get_shape();
-        std::vector<int> origin_output_shape = output->get_shape();
-        input0->set_shape({1, 1, input0->get_size() / origin_input_shape.back(), origin_input_shape.back()});
-        output->set_shape({1, 1, output->get_size() / origin_output_shape.back(), origin_output_shape.back()});
-
-        std::vector<base::ArgsType<T>> m_args =
-            base::get_conv_operation_args<T>(output,
-                                             input0,
-                                             padding,
-                                             filter,
-                                             {1, 1} /*strides*/,
-                                             {1, 1} /*dilations*/,
-                                             1 /*group*/,
-                                             bias,
-                                             this->activation,
-                                             nullptr,
-                                             mode); // do not support PReLU and Leaky RelU
-        int task_size = m_args.size();
-        if (task_size == 1) { // single task
-            forward_args((void *)&m_args[0]);
-        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-            ESP_LOGI("Gemm", "two task...");
-            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-        } else {
-            ESP_LOGE("Gemm", "Only support task size is 1 or 2, currently task size is %d", task_size);
+
+        intptr_t key[8];
+        ModuleArgs::get_tensor_key(input0, &key[0]);
+        ModuleArgs::get_tensor_key(filter, &key[2]);
+        ModuleArgs::get_tensor_key(bias, &key[4]);
+        ModuleArgs::get_tensor_key(output, &key[6]);
+        if (!m_args.match(mode, key, 8)) {
+            std::vector<int> padding(4, 0);
+            std::vector<int> origin_input_shape = input0->get_shape();
+            std::vector<int> origin_output_shape = output->get_shape();
+            input0->set_shape({1, 1, input0->get_size() / origin_input_shape.back(), origin_input_shape.back()});
+            output->set_shape({1, 1, output->get_size() / origin_output_shape.back(), origin_output_shape.back()});
+
+            m_args.begin(context);
+            m_args.append<T>(base::get_conv_operation_args<T>(output,
+                                                              input0,
+                                                              padding,
+                                                              filter,
+                                                              {1, 1} /*strides*/,
+                                                              {1, 1} /*dilations*/,
+                                                              1 /*group*/,
+                                                              bias,
+                                                              this->activation,
+                                                              nullptr,
+                                                              mode)); // do not support PReLU and Leaky RelU
+            m_args.end(mode, key, 8);
+            input0->set_shape(origin_input_shape);
+            output->set_shape(origin_output_shape);
+        }
+        if (run) {
+            m_args.run<T>(this, context);
         }
-        input0->set_shape(origin_input_shape);
-        output->set_shape(origin_output_shape);
     }
 
     void forward(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_AUTO)
@@ -134,6 +141,17 @@ public:
         }
     }
 
+    void prepare(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE)
+    {
+        reset_bias(context);
+
+        if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+            forward_template<int8_t>(context, mode, false);
+        } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+            forward_template<int16_t>(context, mode, false);
+        }
+    }
+
     /**
      * @brief deserialize Conv2d module instance by node serialization information
      */
@@ -2,6 +2,7 @@
 
 #include "dl_base_conv2d.hpp"
 #include "dl_base_depthwise_conv2d.hpp"
+#include "dl_module_args.hpp"
 #include "dl_module_base.hpp"
 #include <typeinfo>
 #include "freertos/FreeRTOS.h"
@@ -18,6 +19,61 @@ class MatMul : public Module {
 private:
     activation_type_t
         m_activation; /*!< activation of MatMul, if you don't specify anything, no activation is applied */
+    ModuleArgs m_args;      /*!< operation args, computed once and reused by every forward */
+    void *m_filter;         /*!< aligned copies of the batches of an unaligned input1, the args point to them */
+    size_t m_filter_size;   /*!< In bytes. Size of m_filter */
+    size_t m_filter_bytes;  /*!< In bytes. Size of one batch of input1 */
+    size_t m_filter_stride; /*!< In bytes. Distance of two batches in m_filter, aligned to 16 */
+    int m_filter_num;       /*!< Number of batches in m_filter, 0 when the args point to input1 */
+
+    /**
+     * @brief Get room in m_filter for the batches of an unaligned input1. The buffer is kept for the next forwards,
+     * it only grows when the args are computed for a larger input1.
+     *
+     * @return false without memory
+     */
+    bool alloc_filter(TensorBase *input1, int batch_num, int c, int n)
+    {
+        m_filter_bytes = (size_t)c * n * input1->get_dtype_bytes();
+        m_filter_stride = (m_filter_bytes + 15) & ~(size_t)15;
+        size_t size = m_filter_stride * batch_num;
+        if (size > m_filter_size) {
+            if (m_filter) {
+                heap_caps_free(m_filter);
+            }
+            m_filter = tool::malloc_aligned(16, size, input1->caps);
+            m_filter_size = m_filter ? size : 0;
+            if (!m_filter) {
+                ESP_LOGE("MatMul", "No memory for the aligned copy of input1");
+                return false;
+            }
+        }
+        m_filter_num = batch_num;
+        return true;
+    }
+
+    /**
+     * @brief Copy the batches of input1, they are contiguous, into m_filter.
+     */
+    void copy_filter(const void *input1_element)
+    {
+        for (int i = 0; i < m_filter_num; i++) {
+            memcpy(static_cast<char *>(m_filter) + i * m_filter_stride,
+                   static_cast<const char *>(input1_element) + i * m_filter_bytes,
+                   m_filter_bytes);
+        }
+    }
+
+    /**
+     * @brief Get the filter of a batch of input1: the batch itself when it is aligned, else its copy in m_filter.
+     */
+    void *get_filter(void *input1_element, int batch)
+    {
+        if (m_filter_num) {
+            return static_cast<char *>(m_filter) + batch * m_filter_stride;
+        }
+        return static_cast<char *>(input1_element) + batch * m_filter_bytes;
+    }
 
 public:
     /**
@@ -29,7 +85,13 @@ public:
     MatMul(activation_type_t activation = Linear,
            const char *name = nullptr,
            quant_type_t quant_type = QUANT_TYPE_NONE) :
-        Module(name, MODULE_NON_INPLACE, quant_type), m_activation(activation)
+        Module(name, MODULE_NON_INPLACE, quant_type),
+        m_activation(activation),
+        m_filter(nullptr),
+        m_filter_size(0),
+        m_filter_bytes(0),
+        m_filter_stride(0),
+        m_filter_num(0)
     {
     }
 
@@ -37,7 +99,12 @@ public:
      * @brief Destroy the MatMul object.
      *
      */
-    ~MatMul() {}
+    ~MatMul()
+    {
+        if (m_filter) {
+            heap_caps_free(m_filter);
+        }
+    }
 
     /**
      * @brief Calculate the output shape
@@ -122,13 +189,33 @@ public:
         }
     }
 
+    bool support_multi_core() { return true; }
+
     template <typename T>
-    void forward_template(ModelContext *context, runtime_mode_t mode)
+    void forward_template(ModelContext *context, runtime_mode_t mode, bool run = true)
     {
-        std::vector<int> padding(4, 0);
         TensorBase *input0 = context->get_tensor(m_inputs_index[0]);
         TensorBase *input1 = context->get_tensor(m_inputs_index[1]);
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
+
+        intptr_t key[6];
+        ModuleArgs::get_tensor_key(input0, &key[0]);
+        ModuleArgs::get_tensor_key(input1, &key[2]);
+        ModuleArgs::get_tensor_key(output, &key[4]);
+        if (m_args.match(mode, key, 6)) {
+            if (run) {
+                // the args of an unaligned input1 point to its copy, refresh it unless input1 is a parameter
+                if (m_filter_num && m_inputs_index[1] < CONTEXT_PARAMETER_OFFSET) {
+                    copy_filter(input1->get_element_ptr());
+                }
+                m_args.run<T>(this, context);
+            }
+            return;
+        }
+
+        m_filter_num = 0;
+        m_args.begin(context);
+        std::vector<int> padding(4, 0);
         std::vector<int> origin_input0_shape = input0->get_shape();
         std::vector<int> origin_input1_shape = input1->get_shape();
         std::vector<int> origin_output_shape = output->get_shape();
@@ -170,26 +257,19 @@ public:
                 output->set_shape({1, 1, origin_output_shape[0], 1});
             }
 
-            std::vector<base::ArgsType<T>> m_args =
-                base::get_conv_operation_args<T>(output,
-                                                 input0,
-                                                 padding,
-                                                 input1 /*filter*/,
-                                                 {1, 1} /*strides*/,
-                                                 {1, 1} /*dilations*/,
-                                                 1 /*group*/,
-                                                 nullptr /*bias*/,
-                                                 m_activation,
-                                                 nullptr,
-                                                 mode); // do not support PReLU and Leaky RelU
-            int task_size = m_args.size();
-            if (task_size == 1) { // single task
-                forward_args((void *)&m_args[0]);
-            } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-                ESP_LOGI("MatMul", "two task...");
-                module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-            } else {
-                ESP_LOGE("MatMul", "Only support task size is 1 or 2, currently task size is %d", task_size);
+            int index = m_args.append<T>(base::get_conv_operation_args<T>(output,
+                                                                          input0,
+                                                                          padding,
+                                                                          input1 /*filter*/,
+                                                                          {1, 1} /*strides*/,
+                                                                          {1, 1} /*dilations*/,
+                                                                          1 /*group*/,
+                                                                          nullptr /*bias*/,
+                                                                          m_activation,
+                                                                          nullptr,
+                                                                          mode)); // do not support PReLU and Leaky RelU
+            if (run && index >= 0) {
+                m_args.run<T>(this, context, index);
             }
 
         } else {
@@ -211,6 +291,13 @@ public:
                 int n = origin_input1_shape.back();
                 int align = input1->get_dtype() == DATA_TYPE_INT8 ? 16 : 8;
                 bool is_align = (c * n % align) == 0;
+                m_filter_bytes = (size_t)c * n * input1_dtype_bytes;
+                if (!is_align) {
+                    if (!alloc_filter(input1, input1_batch_size, c, n)) {
+                        return;
+                    }
+                    copy_filter(input1_element);
+                }
                 input1->set_shape({input1_batch_size, c, n});
 
                 // input: NHWC
@@ -222,21 +309,12 @@ public:
                                       input1_element /*element*/,
                                       input1->exponent /*exponent*/,
                                       input1->dtype /*dtype*/,
-                                      is_align ? false : true /*deep*/,
+                                      false /*deep*/,
                                       input1->caps /*caps*/);
 
                 for (int i = 0; i < input1_batch_size; i++) {
                     // filter: HWIO
-                    if (!is_align) {
-                        input1_tmp.assign({1, 1, c, n} /*shape*/,
-                                          static_cast<char *>(input1_element) +
-                                              input1_dtype_bytes * input1->get_element_index({i, 0, 0}) /*element*/,
-                                          input1->exponent /*exponent*/,
-                                          input1->dtype /*dtype*/);
-                    } else {
-                        input1_tmp.set_element_ptr(static_cast<char *>(input1_element) +
-                                                   input1_dtype_bytes * input1->get_element_index({i, 0, 0}));
-                    }
+                    input1_tmp.set_element_ptr(get_filter(input1_element, i));
 
                     // output: NHWC
                     TensorBase output_tmp({1, 1, 1, origin_output_shape.back()} /*shape*/,
@@ -247,26 +325,19 @@ public:
                                           false /*deep*/,
                                           output->caps /*caps*/);
 
-                    std::vector<base::ArgsType<T>> m_args =
-                        base::get_conv_operation_args<T>(&output_tmp,
-                                                         input0,
-                                                         padding,
-                                                         &input1_tmp /*filter*/,
-                                                         {1, 1} /*strides*/,
-                                                         {1, 1} /*dilations*/,
-                                                         1 /*group*/,
-                                                         nullptr /*bias*/,
-                                                         m_activation,
-                                                         nullptr,
-                                                         mode); // do not support PReLU and Leaky RelU
-                    int task_size = m_args.size();
-                    if (task_size == 1) { // single task
-                        forward_args((void *)&m_args[0]);
-                    } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-                        ESP_LOGI("MatMul", "two task...");
-                        module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-                    } else {
-                        ESP_LOGE("MatMul", "Only support task size is 1 or 2, currently task size is %d", task_size);
+                    int index = m_args.append<T>(base::get_conv_operation_args<T>(&output_tmp,
+                                                                                  input0,
+                                                                                  padding,
+                                                                                  &input1_tmp /*filter*/,
+                                                                                  {1, 1} /*strides*/,
+                                                                                  {1, 1} /*dilations*/,
+                                                                                  1 /*group*/,
+                                                                                  nullptr /*bias*/,
+                                                                                  m_activation,
+                                                                                  nullptr,
+                                                                                  mode)); // do not support PReLU and Leaky RelU
+                    if (run && index >= 0) {
+                        m_args.run<T>(this, context, index);
                     }
                 }
 
@@ -304,26 +375,19 @@ public:
                                           false /*deep*/,
                                           output->caps /*caps*/);
 
-                    std::vector<base::ArgsType<T>> m_args =
-                        base::get_conv_operation_args<T>(&output_tmp,
-                                                         &input0_tmp,
-                                                         padding,
-                                                         input1 /*filter*/,
-                                                         {1, 1} /*strides*/,
-                                                         {1, 1} /*dilations*/,
-                                                         1 /*group*/,
-                                                         nullptr /*bias*/,
-                                                         m_activation,
-                                                         nullptr,
-                                                         mode); // do not support PReLU and Leaky RelU
-                    int task_size = m_args.size();
-                    if (task_size == 1) { // single task
-                        forward_args((void *)&m_args[0]);
-                    } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-                        ESP_LOGI("MatMul", "two task...");
-                        module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-                    } else {
-                        ESP_LOGE("MatMul", "Only support task size is 1 or 2, currently task size is %d", task_size);
+                    int index = m_args.append<T>(base::get_conv_operation_args<T>(&output_tmp,
+                                                                                  &input0_tmp,
+                                                                                  padding,
+                                                                                  input1 /*filter*/,
+                                                                                  {1, 1} /*strides*/,
+                                                                                  {1, 1} /*dilations*/,
+                                                                                  1 /*group*/,
+                                                                                  nullptr /*bias*/,
+                                                                                  m_activation,
+                                                                                  nullptr,
+                                                                                  mode)); // do not support PReLU and Leaky RelU
+                    if (run && index >= 0) {
+                        m_args.run<T>(this, context, index);
                     }
                 }
 
@@ -335,6 +399,13 @@ public:
                 int n = origin_input1_shape.back();
                 int align = input1->get_dtype() == DATA_TYPE_INT8 ? 16 : 8;
                 bool is_align = (c * n % align) == 0;
+                m_filter_bytes = (size_t)c * n * input1_dtype_bytes;
+                if (!is_align) {
+                    if (!alloc_filter(input1, input1_batch, c, n)) {
+                        return;
+                    }
+                    copy_filter(input1_element);
+                }
                 input0->set_shape(
                     {input0_batch, origin_input0_shape[origin_input0_shape.size() - 2], origin_input0_shape.back()});
                 input1->set_shape({input1_batch, c, n});
@@ -344,7 +415,7 @@ public:
                                       input1_element /*element*/,
                                       input1->exponent /*exponent*/,
                                       input1->dtype /*dtype*/,
-                                      is_align ? false : true /*deep*/,
+                                      false /*deep*/,
                                       input1->caps /*caps*/);
 
                 for (int i = 0; i < max_batch; i++) {
@@ -364,17 +435,7 @@ public:
 
                     // filter: HWIO
                     int input1_i = input1_batch == 1 ? 0 : i;
-                    if (!is_align) {
-                        input1_tmp.assign({1, 1, c, n} /*shape*/,
-                                          static_cast<char *>(input1_element) +
-                                              input1_dtype_bytes *
-                                                  input1->get_element_index({input1_i, 0, 0}) /*element*/,
-                                          input1->exponent /*exponent*/,
-                                          input1->dtype /*dtype*/);
-                    } else {
-                        input1_tmp.set_element_ptr(static_cast<char *>(input1_element) +
-                                                   input1_dtype_bytes * input1->get_element_index({input1_i, 0, 0}));
-                    }
+                    input1_tmp.set_element_ptr(get_filter(input1_element, input1_i));
 
                     // output: NHWC
                     TensorBase output_tmp({1,
@@ -388,26 +449,19 @@ public:
                                           false /*deep*/,
                                           output->caps /*caps*/);
 
-                    std::vector<base::ArgsType<T>> m_args =
-                        base::get_conv_operation_args<T>(&output_tmp,
-                                                         &input0_tmp,
-                                                         padding,
-                                                         &input1_tmp /*filter*/,
-                                                         {1, 1} /*strides*/,
-                                                         {1, 1} /*dilations*/,
-                                                         1 /*group*/,
-                                                         nullptr /*bias*/,
-                                                         m_activation,
-                                                         nullptr,
-                                                         mode); // do not support PReLU and Leaky RelU
-                    int task_size = m_args.size();
-                    if (task_size == 1) { // single task
-                        forward_args((void *)&m_args[0]);
-                    } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-                        ESP_LOGI("MatMul", "two task...");
-                        module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-                    } else {
-                        ESP_LOGE("MatMul", "Only support task size is 1 or 2, currently task size is %d", task_size);
+                    int index = m_args.append<T>(base::get_conv_operation_args<T>(&output_tmp,
+                                                                                  &input0_tmp,
+                                                                                  padding,
+                                                                                  &input1_tmp /*filter*/,
+                                                                                  {1, 1} /*strides*/,
+                                                                                  {1, 1} /*dilations*/,
+                                                                                  1 /*group*/,
+                                                                                  nullptr /*bias*/,
+                                                                                  m_activation,
+                                                                                  nullptr,
+                                                                                  mode)); // do not support PReLU and Leaky RelU
+                    if (run && index >= 0) {
+                        m_args.run<T>(this, context, index);
                     }
                 }
 
@@ -429,6 +483,13 @@ public:
                 int n = origin_input1_shape.back();
                 int align = input1->get_dtype() == DATA_TYPE_INT8 ? 16 : 8;
                 bool is_align = (c * n % align) == 0;
+                m_filter_bytes = (size_t)c * n * input1_dtype_bytes;
+                if (!is_align) {
+                    if (!alloc_filter(input1, input1_batch0 * input1_batch1, c, n)) {
+                        return;
+                    }
+                    copy_filter(input1_element);
+                }
                 input0->set_shape({input0_batch0,
                                    input0_batch1,
                                    origin_input0_shape[origin_input0_shape.size() - 2],
@@ -441,7 +502,7 @@ public:
                                       input1_element /*element*/,
                                       input1->exponent /*exponent*/,
                                       input1->dtype /*dtype*/,
-                                      is_align ? false : true /*deep*/,
+                                      false /*deep*/,
                                       input1->caps /*caps*/);
 
                 for (int i = 0; i < max_batch0; i++) {
@@ -466,18 +527,7 @@ public:
                                               input0->caps /*caps*/);
 
                         // filter: HWIO
-                        if (!is_align) {
-                            input1_tmp.assign({1, 1, c, n} /*shape*/,
-                                              static_cast<char *>(input1_element) +
-                                                  input1_dtype_bytes *
-                                                      input1->get_element_index({input1_i, input1_j, 0, 0}) /*element*/,
-                                              input1->exponent /*exponent*/,
-                                              input1->dtype /*dtype*/);
-                        } else {
-                            input1_tmp.set_element_ptr(static_cast<char *>(input1_element) +
-                                                       input1_dtype_bytes *
-                                                           input1->get_element_index({input1_i, input1_j, 0, 0}));
-                        }
+                        input1_tmp.set_element_ptr(get_filter(input1_element, input1_i * input1_batch1 + input1_j));
 
                         // output: NHWC
                         TensorBase output_tmp({1,
@@ -492,27 +542,19 @@ public:
                                               false /*deep*/,
                                               output->caps /*caps*/);
 
-                        std::vector<base::ArgsType<T>> m_args =
-                            base::get_conv_operation_args<T>(&output_tmp,
-                                                             &input0_tmp,
-                                                             padding,
-                                                             &input1_tmp /*filter*/,
-                                                             {1, 1} /*strides*/,
-                                                             {1, 1} /*dilations*/,
-                                                             1 /*group*/,
-                                                             nullptr /*bias*/,
-                                                             m_activation,
-                                                             nullptr,
-                                                             mode); // do not support PReLU and Leaky RelU
-                        int task_size = m_args.size();
-                        if (task_size == 1) { // single task
-                            forward_args((void *)&m_args[0]);
-                        } else if (task_size == 2) { // multi task, use semaphore to maintain synchronization.
-                            ESP_LOGI("MatMul", "two task...");
-                            module_forward_dual_core(this, (void *)&m_args[0], (void *)&m_args[1]);
-                        } else {
-                            ESP_LOGE(
-                                "MatMul", "Only support task size is 1 or 2, currently task size is %d", task_size);
+                        int index = m_args.append<T>(base::get_conv_operation_args<T>(&output_tmp,
+                                                                                      &input0_tmp,
+                                                                                      padding,
+                                                                                      &input1_tmp /*filter*/,
+                                                                                      {1, 1} /*strides*/,
+                                                                                      {1, 1} /*dilations*/,
+                                                                                      1 /*group*/,
+                                                                                      nullptr /*bias*/,
+                                                                                      m_activation,
+                                                                                      nullptr,
+                                                                                      mode)); // do not support PReLU and Leaky RelU
+                        if (run && index >= 0) {
+                            m_args.run<T>(this, context, index);
                         }
                     }
                 }
@@ -525,6 +567,7 @@ public:
             }
         }
 
+        m_args.end(mode, key, 6);
         input0->set_shape(origin_input0_shape);
         input1->set_shape(origin_input1_shape);
         output->set_shape(origin_output_shape);
@@ -539,6 +582,15 @@ public:
         }
     }
 
+    void prepare(ModelContext *context, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE)
+    {
+        if (quant_type == QUANT_TYPE_SYMM_8BIT) {
+            forward_template<int8_t>(context, mode, false);
+        } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
+            forward_template<int16_t>(context, mode, false);
+        }
+    }
+
     /**
      * @brief deserialize MatMul module instance by node serialization information
      */
@@ -54,6 +54,8 @@ public:
         }
     }
 
+    bool support_multi_core() { return true; }
+
     template <typename T>
     void forward_template(ModelContext *context, runtime_mode_t mode)
     {
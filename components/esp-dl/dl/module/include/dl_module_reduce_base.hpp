@@ -148,116 +148,124 @@ public:
         }
         assert(new_input_shape.size() == new_reduce_flag.size());
 
+        // Every output reduces its own elements, the outputs are split on both cores.
         if (merged_dims == 1) {
             output_ptr[0] =
                 reduce_fn(m_op_type, i_exp, o_exp, v0, input_ptr, input->get_size(), stride0, size1, stride1, arg);
         } else if (merged_dims == 2) {
             if (!new_reduce_flag[0] && new_reduce_flag[1]) {
-                T *input_ptr_tmp = input_ptr;
-                for (int i = 0; i < new_input_shape[0]; i++) {
-                    output_ptr[i] = reduce_fn(
-                        m_op_type, i_exp, o_exp, v0, input_ptr_tmp, new_input_shape[1], stride0, size1, stride1, arg);
-                    input_ptr_tmp += new_input_shape[1];
-                }
+                module_forward_split(mode, new_input_shape[0], new_input_shape[1], [&](int start, int end) {
+                    for (int i = start; i < end; i++) {
+                        output_ptr[i] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i * new_input_shape[1],
+                                                  new_input_shape[1],
+                                                  stride0,
+                                                  size1,
+                                                  stride1,
+                                                  arg);
+                    }
+                });
             } else if (new_reduce_flag[0] && !new_reduce_flag[1]) {
-                for (int i = 0; i < new_input_shape[1]; i++) {
-                    output_ptr[i] = reduce_fn(m_op_type,
-                                              i_exp,
-                                              o_exp,
-                                              v0,
-                                              input_ptr + i,
-                                              new_input_shape[0],
-                                              new_input_shape[1],
-                                              size1,
-                                              stride1,
-                                              arg);
-                }
+                module_forward_split(mode, new_input_shape[1], new_input_shape[0], [&](int start, int end) {
+                    for (int i = start; i < end; i++) {
+                        output_ptr[i] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i,
+                                                  new_input_shape[0],
+                                                  new_input_shape[1],
+                                                  size1,
+                                                  stride1,
+                                                  arg);
+                    }
+                });
             }
         } else if (merged_dims == 3) {
             if (new_reduce_flag[0] && !new_reduce_flag[1] && new_reduce_flag[2]) {
-                T *input_ptr_tmp = input_ptr;
                 int stride = new_input_shape[1] * new_input_shape[2];
-                for (int i = 0; i < new_input_shape[1]; i++) {
-                    output_ptr[i] = reduce_fn(m_op_type,
-                                              i_exp,
-                                              o_exp,
-                                              v0,
-                                              input_ptr_tmp,
-                                              new_input_shape[2],
-                                              1,
-                                              new_input_shape[0],
-                                              stride,
-                                              arg);
-                    input_ptr_tmp += new_input_shape[2];
-                }
+                int cost = new_input_shape[0] * new_input_shape[2];
+                module_forward_split(mode, new_input_shape[1], cost, [&](int start, int end) {
+                    for (int i = start; i < end; i++) {
+                        output_ptr[i] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i * new_input_shape[2],
+                                                  new_input_shape[2],
+                                                  1,
+                                                  new_input_shape[0],
+                                                  stride,
+                                                  arg);
+                    }
+                });
             } else if (!new_reduce_flag[0] && new_reduce_flag[1] && !new_reduce_flag[2]) {
                 int offset = new_input_shape[1] * new_input_shape[2];
-                T *input_ptr_tmp = input_ptr;
-                T *output_ptr_tmp = output_ptr;
-                for (int i = 0; i < new_input_shape[0]; i++) {
-                    for (int j = 0; j < new_input_shape[2]; j++) {
-                        output_ptr_tmp[j] = reduce_fn(m_op_type,
-                                                      i_exp,
-                                                      o_exp,
-                                                      v0,
-                                                      input_ptr_tmp + j,
-                                                      new_input_shape[1],
-                                                      new_input_shape[2],
-                                                      size1,
-                                                      stride1,
-                                                      arg);
+                int total = new_input_shape[0] * new_input_shape[2];
+                module_forward_split(mode, total, new_input_shape[1], [&](int start, int end) {
+                    for (int o = start; o < end; o++) {
+                        int i = o / new_input_shape[2];
+                        int j = o % new_input_shape[2];
+                        output_ptr[o] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i * offset + j,
+                                                  new_input_shape[1],
+                                                  new_input_shape[2],
+                                                  size1,
+                                                  stride1,
+                                                  arg);
                     }
-                    input_ptr_tmp += offset;
-                    output_ptr_tmp += new_input_shape[2];
-                }
+                });
             }
         } else if (merged_dims == 4) {
             if (!new_reduce_flag[0] && new_reduce_flag[1] && !new_reduce_flag[2] && new_reduce_flag[3]) {
                 int offset0 = new_input_shape[1] * new_input_shape[2] * new_input_shape[3];
                 int offset1 = new_input_shape[3];
                 int stride = new_input_shape[2] * new_input_shape[3];
-                T *input_ptr_tmp0 = input_ptr;
-                T *output_ptr_tmp = output_ptr;
-                for (int i = 0; i < new_input_shape[0]; i++) {
-                    T *input_ptr_tmp1 = input_ptr_tmp0;
-                    for (int j = 0; j < new_input_shape[2]; j++) {
-                        output_ptr_tmp[j] = reduce_fn(m_op_type,
-                                                      i_exp,
-                                                      o_exp,
-                                                      v0,
-                                                      input_ptr_tmp1,
-                                                      new_input_shape[3],
-                                                      1,
-                                                      new_input_shape[1],
-                                                      stride,
-                                                      arg);
-                        input_ptr_tmp1 += offset1;
+                int total = new_input_shape[0] * new_input_shape[2];
+                int cost = new_input_shape[1] * new_input_shape[3];
+                module_forward_split(mode, total, cost, [&](int start, int end) {
+                    for (int o = start; o < end; o++) {
+                        int i = o / new_input_shape[2];
+                        int j = o % new_input_shape[2];
+                        output_ptr[o] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i * offset0 + j * offset1,
+                                                  new_input_shape[3],
+                                                  1,
+                                                  new_input_shape[1],
+                                                  stride,
+                                                  arg);
                     }
-                    input_ptr_tmp0 += offset0;
-                    output_ptr_tmp += new_input_shape[2];
-                }
+                });
             } else if (new_reduce_flag[0] && !new_reduce_flag[1] && new_reduce_flag[2] && !new_reduce_flag[3]) {
                 int offset = new_input_shape[2] * new_input_shape[3];
                 int stride = new_input_shape[1] * new_input_shape[2] * new_input_shape[3];
-                T *input_ptr_tmp0 = input_ptr;
-                T *output_ptr_tmp = output_ptr;
-                for (int i = 0; i < new_input_shape[1]; i++) {
-                    T *input_ptr_tmp1 = input_ptr_tmp0;
-                    for (int j = 0; j < new_input_shape[3]; j++) {
-                        output_ptr_tmp[j] = reduce_fn(m_op_type,
-                                                      i_exp,
-                                                      o_exp,
-                                                      v0,
-                                                      input_ptr_tmp1 + j,
-                                                      new_input_shape[2],
-                                                      new_input_shape[3],
-                                                      new_input_shape[0],
-                                                      stride,
-                                                      arg);
+                int total = new_input_shape[1] * new_input_shape[3];
+                int cost = new_input_shape[0] * new_input_shape[2];
+                module_forward_split(mode, total, cost, [&](int start, int end) {
+                    for (int o = start; o < end; o++) {
+                        int i = o / new_input_shape[3];
+                        int j = o % new_input_shape[3];
+                        output_ptr[o] = reduce_fn(m_op_type,
+                                                  i_exp,
+                                                  o_exp,
+                                                  v0,
+                                                  input_ptr + i * offset + j,
+                                                  new_input_shape[2],
+                                                  new_input_shape[3],
+                                                  new_input_shape[0],
+                                                  stride,
+                                                  arg);
                     }
-                    input_ptr_tmp0 += offset;
-                    output_ptr_tmp += new_input_shape[3];
-                }
+                });
             }
         }
     }
@@ -308,6 +316,8 @@ public:
     }
 
     virtual void print() { print("ReduceBase"); }
+
+    bool support_multi_core() { return true; }
 };
 } // namespace module
 } // namespace dl
@@ -56,7 +56,7 @@ public:
         TensorBase *output = context->get_tensor(m_outputs_index[0]);
 
         if (quant_type == QUANT_TYPE_SYMM_8BIT) {
-            forward_lut(input, output);
+            forward_lut(input, output, mode);
         } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
             int16_t *input_element = (int16_t *)input->get_element_ptr();
             float *output_element = (float *)output->get_element_ptr();
@@ -65,7 +65,7 @@ public:
             for (int i = 0; i < input->get_size(); i++) {
                 output_element[i] = scale * input_element[i];
             }
-            forward_float(output_element, output->get_size(), output->get_shape(), this->axis);
+            forward_float(output_element, output->get_size(), output->get_shape(), this->axis, mode);
         } else if (quant_type == QUANT_TYPE_FLOAT32) {
             float *input_element = (float *)input->get_element_ptr();
             float *output_element = (float *)output->get_element_ptr();
@@ -73,139 +73,93 @@ public:
             if (input_element != output_element) {
                 memcpy(output_element, input_element, input->get_bytes());
             }
-            forward_float(output_element, output->get_size(), output->get_shape(), this->axis);
+            forward_float(output_element, output->get_size(), output->get_shape(), this->axis, mode);
         }
     }
 
-    void forward_float(float *output_element, int size, std::vector<int> shape, int axis)
+    /**
+     * @brief Get the layout of the softmax vectors: the tensor is seen as [outer_loop, len, inner_loop], every one of
+     * the outer_loop * inner_loop vectors is normalized on its own, which lets them be split on both cores.
+     *
+     * @param shape       Shape of the tensor
+     * @param axis        The softmax axis
+     * @param len         The size of the axis
+     * @param inner_loop  The stride of the elements of a vector
+     */
+    static void get_vector_layout(const std::vector<int> &shape, int axis, int &len, int &inner_loop)
     {
         int dims = shape.size();
         int positive_axis = axis < 0 ? dims + axis : axis;
-        int len = shape[positive_axis]; // the size of positive_axis
+        len = shape[positive_axis]; // the size of positive_axis
+        inner_loop = 1;
+        for (int i = positive_axis + 1; i < dims; i++) {
+            inner_loop *= shape[i];
+        }
+    }
 
-        if (positive_axis == dims - 1) { // positive_axis == dims - 1
-            int outer_loop = 1;
-            if (dims > 1) {
-                outer_loop = size / len;
-            }
+    void forward_float(float *output_element,
+                       int size,
+                       std::vector<int> shape,
+                       int axis,
+                       runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE)
+    {
+        int len, inner_loop;
+        get_vector_layout(shape, axis, len, inner_loop);
 
-            for (int o = 0; o < outer_loop; o++) {
-                float max = output_element[0];
+        module_forward_split(mode, size / len, len, [&](int start, int end) {
+            for (int v = start; v < end; v++) {
+                float *vector = output_element + (v / inner_loop) * len * inner_loop + v % inner_loop;
+                float max = vector[0];
                 for (int i = 1; i < len; i++) {
-                    max = DL_MAX(max, output_element[i]);
+                    max = DL_MAX(max, vector[i * inner_loop]);
                 }
 
                 float sum = 0.f;
                 for (int i = 0; i < len; i++) {
-                    output_element[i] = expf(output_element[i] - max);
-                    sum += output_element[i];
+                    vector[i * inner_loop] = expf(vector[i * inner_loop] - max);
+                    sum += vector[i * inner_loop];
                 }
 
                 for (int i = 0; i < len; i++) {
-                    output_element[i] = output_element[i] / sum;
-                }
-                output_element += len;
-            }
-        } else {
-            // convert input tensor to [outer_loop, len, inner_loop]
-            int outer_loop = 1;
-            int inner_loop = 1;
-            for (int i = 0; i < dims; i++) {
-                if (i < positive_axis) {
-                    outer_loop *= shape[i];
-                } else if (i > positive_axis) {
-                    inner_loop *= shape[i];
-                }
-            }
-
-            for (int o = 0; o < outer_loop; o++) {
-                for (int k = 0; k < inner_loop; k++) {
-                    float max = output_element[0];
-                    for (int i = 1; i < len; i++) {
-                        max = DL_MAX(max, output_element[i * inner_loop]);
-                    }
-
-                    float sum = 0.f;
-                    for (int i = 0; i < len; i++) {
-                        output_element[i * inner_loop] = expf(output_element[i * inner_loop] - max);
-                        sum += output_element[i * inner_loop];
-                    }
-
-                    for (int i = 0; i < len; i++) {
-                        output_element[i * inner_loop] = output_element[i * inner_loop] / sum;
-                    }
-                    output_element += 1;
+                    vector[i * inner_loop] = vector[i * inner_loop] / sum;
                 }
-                output_element += inner_loop * (len - 1);
             }
-        }
+        });
     }
 
-    void forward_lut(TensorBase *input, TensorBase *output)
+    void forward_lut(TensorBase *input, TensorBase *output, runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE)
     {
         if (this->exp_table == nullptr) {
             this->exp_table = (float *)heap_caps_malloc(256 * sizeof(float), MALLOC_CAP_DEFAULT);
             tool::gen_lut_8bit(this->exp_table, input->exponent, expf);
         }
 
-        int dims = input->get_shape().size();
-        int positive_axis = axis < 0 ? dims + axis : axis;
-        int len = input->get_shape()[positive_axis]; // the size of positive_axis
+        int len, inner_loop;
+        get_vector_layout(input->get_shape(), axis, len, inner_loop);
         int8_t *input_element = (int8_t *)input->get_element_ptr();
         assert(output->get_dtype() == DATA_TYPE_FLOAT);
         float *output_element = (float *)output->get_element_ptr();
 
-        if (positive_axis == dims - 1) { // positive_axis == dims - 1
-            int outer_loop = 1;
-            if (dims > 1) {
-                outer_loop = input->get_size() / len;
-            }
-
-            for (int o = 0; o < outer_loop; o++) {
+        module_forward_split(mode, input->get_size() / len, len, [&](int start, int end) {
+            for (int v = start; v < end; v++) {
+                int offset = (v / inner_loop) * len * inner_loop + v % inner_loop;
+                int8_t *input_vector = input_element + offset;
+                float *output_vector = output_element + offset;
                 float sum = 0.f;
                 for (int i = 0; i < len; i++) {
-                    output_element[i] = this->exp_table[input_element[i] + 128];
-                    sum += output_element[i];
+                    output_vector[i * inner_loop] = this->exp_table[input_vector[i * inner_loop] + 128];
+                    sum += output_vector[i * inner_loop];
                 }
 
                 for (int i = 0; i < len; i++) {
-                    output_element[i] = output_element[i] / sum;
-                }
-                input_element += len;
-                output_element += len;
-            }
-        } else {
-            // convert input tensor to [outer_loop, len, inner_loop]
-            int outer_loop = 1;
-            int inner_loop = 1;
-            for (int i = 0; i < dims; i++) {
-                if (i < positive_axis) {
-                    outer_loop *= input->get_shape()[i];
-                } else if (i > positive_axis) {
-                    inner_loop *= input->get_shape()[i];
+                    output_vector[i * inner_loop] = output_vector[i * inner_loop] / sum;
                 }
             }
-
-            for (int o = 0; o < outer_loop; o++) {
-                for (int k = 0; k < inner_loop; k++) {
-                    float sum = 0.f;
-                    for (int i = 0; i < len; i++) {
-                        output_element[i * inner_loop] = this->exp_table[input_element[i * inner_loop] + 128];
-                        sum += output_element[i * inner_loop];
-                    }
-
-                    for (int i = 0; i < len; i++) {
-                        output_element[i * inner_loop] = output_element[i * inner_loop] / sum;
-                    }
-                    input_element += 1;
-                    output_element += 1;
-                }
-                input_element += inner_loop * (len - 1);
-                output_element += inner_loop * (len - 1);
-            }
-        }
+        });
     }
 
+    bool support_multi_core() { return true; }
+
     /**
      * @brief deserialize Softmax module instance by node serialization information
      */
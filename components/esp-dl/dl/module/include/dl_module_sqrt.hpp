@@ -48,9 +48,11 @@ public:
             float *input_ptr = (float *)input->get_element_ptr();
             float *output_ptr = (float *)output->get_element_ptr();
 
-            for (size_t i = 0; i < input->size; i++) {
-                output_ptr[i] = sqrtf(input_ptr[i]);
-            }
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    output_ptr[i] = sqrtf(input_ptr[i]);
+                }
+            });
         }
     }
 
@@ -64,15 +66,19 @@ public:
 
         float input_scale = DL_SCALE(input->exponent);
         float output_scale = DL_RESCALE(output->exponent);
-        for (size_t i = 0; i < input->size; i++) {
-            float temp = input_ptr[i] * input_scale;
-            temp = sqrtf(temp);
-            tool::truncate(output_ptr[i], tool::round(temp * output_scale));
-        }
+        module_forward_split(mode, input->size, 1, [&](int start, int end) {
+            for (int i = start; i < end; i++) {
+                float temp = input_ptr[i] * input_scale;
+                temp = sqrtf(temp);
+                tool::truncate(output_ptr[i], tool::round(temp * output_scale));
+            }
+        });
     }
 
     void forward_args(void *args) {}
 
+    bool support_multi_core() { return true; }
+
     /**
      * @brief deserialize Sqrt module instance by node serialization information
      */
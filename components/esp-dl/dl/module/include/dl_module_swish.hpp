@@ -52,10 +52,12 @@ public:
             float *input_ptr = (float *)input->get_element_ptr();
             float *output_ptr = (float *)output->get_element_ptr();
 
-            for (size_t i = 0; i < input->size; i++) {
-                float temp = input_ptr[i];
-                output_ptr[i] = dl::math::sigmoid(temp) * temp;
-            }
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    float temp = input_ptr[i];
+                    output_ptr[i] = dl::math::sigmoid(temp) * temp;
+                }
+            });
         }
     }
 
@@ -69,15 +71,19 @@ public:
 
         float input_scale = DL_SCALE(input->exponent);
         float output_scale = DL_RESCALE(output->exponent);
-        for (size_t i = 0; i < input->size; i++) {
-            float temp = input_ptr[i] * input_scale;
-            temp = dl::math::sigmoid(temp) * temp;
-            tool::truncate(output_ptr[i], tool::round(temp * output_scale));
-        }
+        module_forward_split(mode, input->size, 1, [&](int start, int end) {
+            for (int i = start; i < end; i++) {
+                float temp = input_ptr[i] * input_scale;
+                temp = dl::math::sigmoid(temp) * temp;
+                tool::truncate(output_ptr[i], tool::round(temp * output_scale));
+            }
+        });
     }
 
     void forward_args(void *args) {}
 
+    bool support_multi_core() { return true; }
+
     /**
      * @brief deserialize Swish module instance by node serialization information
      */
@@ -50,32 +50,40 @@ public:
 
             float input_scale = DL_SCALE(input->exponent);
             float output_scale = DL_RESCALE(output->exponent);
-            for (size_t i = 0; i < input->size; i++) {
-                float temp = math::tanh((float)input_ptr[i] * input_scale);
-                tool::truncate(output_ptr[i], tool::round(temp * output_scale));
-            }
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    float temp = math::tanh((float)input_ptr[i] * input_scale);
+                    tool::truncate(output_ptr[i], tool::round(temp * output_scale));
+                }
+            });
         } else if (quant_type == QUANT_TYPE_SYMM_16BIT) {
             int16_t *input_ptr = (int16_t *)input->get_element_ptr();
             int16_t *output_ptr = (int16_t *)output->get_element_ptr();
 
             float input_scale = DL_SCALE(input->exponent);
             float output_scale = DL_RESCALE(output->exponent);
-            for (size_t i = 0; i < input->size; i++) {
-                float temp = math::tanh((float)input_ptr[i] * input_scale);
-                tool::truncate(output_ptr[i], tool::round(temp * output_scale));
-            }
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    float temp = math::tanh((float)input_ptr[i] * input_scale);
+                    tool::truncate(output_ptr[i], tool::round(temp * output_scale));
+                }
+            });
         } else if (quant_type == QUANT_TYPE_FLOAT32) {
             float *input_ptr = (float *)input->get_element_ptr();
             float *output_ptr = (float *)output->get_element_ptr();
 
-            for (size_t i = 0; i < input->size; i++) {
-                output_ptr[i] = math::tanh(input_ptr[i]);
-            }
+            module_forward_split(mode, input->size, 1, [&](int start, int end) {
+                for (int i = start; i < end; i++) {
+                    output_ptr[i] = math::tanh(input_ptr[i]);
+                }
+            });
         }
     }
 
     void forward_args(void *args) {}
 
+    bool support_multi_core() { return true; }
+
     /**
      * @brief deserialize Tanh module instance by node serialization information
      */
@@ -1,4 +1,5 @@
 #include "dl_module_base.hpp"
+#include <mutex>
 #include <string.h>
 
 using namespace dl;
@@ -28,6 +29,162 @@ Module::~Module()
     }
 }
 
+static std::mutex s_worker_mutex;
+static int s_worker_ref = 0;
+static ModuleWorker s_workers[2];
+
+void ModuleWorker::task(void *args)
+{
+    ModuleWorker *worker = (ModuleWorker *)args;
+    while (true) {
+        xSemaphoreTake(worker->m_start, portMAX_DELAY);
+        if (!worker->m_job) {
+            break;
+        }
+        worker->m_job_start = esp_timer_get_time();
+        worker->m_job(worker->m_arg);
+        worker->m_job_latency = esp_timer_get_time() - worker->m_job_start;
+        xSemaphoreGive(worker->m_done);
+    }
+    xSemaphoreGive(worker->m_done);
+    vTaskDelete(NULL);
+}
+
+bool ModuleWorker::create(int core)
+{
+    m_task = nullptr;
+    m_job = nullptr;
+    m_arg = nullptr;
+    m_core = core;
+    m_job_start = 0;
+    m_job_latency = 0;
+    m_lock = xSemaphoreCreateMutex();
+    m_start = xSemaphoreCreateBinary();
+    m_done = xSemaphoreCreateBinary();
+    if (m_lock && m_start && m_done &&
+        xTaskCreatePinnedToCore(task, "dl_worker", 2048, this, uxTaskPriorityGet(NULL), &m_task, core) == pdPASS) {
+        return true;
+    }
+    m_task = nullptr;
+    destroy();
+    return false;
+}
+
+void ModuleWorker::destroy()
+{
+    if (m_task) {
+        m_job = nullptr;
+        xSemaphoreGive(m_start);
+        xSemaphoreTake(m_done, portMAX_DELAY);
+        m_task = nullptr;
+    }
+    if (m_lock) {
+        vSemaphoreDelete(m_lock);
+        m_lock = nullptr;
+    }
+    if (m_start) {
+        vSemaphoreDelete(m_start);
+        m_start = nullptr;
+    }
+    if (m_done) {
+        vSemaphoreDelete(m_done);
+        m_done = nullptr;
+    }
+}
+
+bool ModuleWorker::start()
+{
+#if !CONFIG_FREERTOS_UNICORE
+    std::lock_guard<std::mutex> lock(s_worker_mutex);
+    if (s_worker_ref == 0) {
+        if (!s_workers[0].create(0)) {
+            return false;
+        }
+        if (!s_workers[1].create(1)) {
+            s_workers[0].destroy();
+            return false;
+        }
+    }
+    s_worker_ref++;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void ModuleWorker::stop()
+{
+    std::lock_guard<std::mutex> lock(s_worker_mutex);
+    if (s_worker_ref == 0 || --s_worker_ref > 0) {
+        return;
+    }
+    s_workers[0].destroy();
+    s_workers[1].destroy();
+}
+
+bool ModuleWorker::started()
+{
+    return s_worker_ref > 0;
+}
+
+ModuleWorker *ModuleWorker::acquire()
+{
+    if (s_worker_ref == 0) {
+        return nullptr;
+    }
+    ModuleWorker *worker = &s_workers[(xPortGetCoreID() + 1) % 2];
+    if (xSemaphoreTake(worker->m_lock, 0) != pdTRUE) {
+        return nullptr;
+    }
+    return worker;
+}
+
+void ModuleWorker::run(void (*job)(void *), void *arg)
+{
+    vTaskPrioritySet(m_task, uxTaskPriorityGet(NULL));
+    m_job = job;
+    m_arg = arg;
+    xSemaphoreGive(m_start);
+}
+
+void ModuleWorker::wait()
+{
+    xSemaphoreTake(m_done, portMAX_DELAY);
+    ModuleSplitRecorder::add(m_core, m_job_start, m_job_latency);
+    xSemaphoreGive(m_lock);
+}
+
+// the record of each task, the forwards of several models may run at the same time
+static thread_local module_split_t *s_split = nullptr;
+
+void ModuleSplitRecorder::begin(module_split_t *split)
+{
+    split->cores = 1 << xPortGetCoreID();
+    split->split_num = 0;
+    split->other_start = 0;
+    split->other_latency = 0;
+    s_split = split;
+}
+
+void ModuleSplitRecorder::end()
+{
+    s_split = nullptr;
+}
+
+void ModuleSplitRecorder::add(int core, int64_t start, uint32_t latency)
+{
+    module_split_t *split = s_split;
+    if (!split) {
+        return;
+    }
+    if (!split->split_num) {
+        split->other_start = start;
+    }
+    split->cores |= 1 << core;
+    split->split_num++;
+    split->other_latency += latency;
+}
+
 void Module::run(TensorBase *input, TensorBase *output, runtime_mode_t mode)
 {
     ModelContext context;
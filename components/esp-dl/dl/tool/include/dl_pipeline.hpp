@@ -0,0 +1,132 @@
+#pragma once
+
+#include "esp_timer.h"
+#include <functional>
+#include <stdint.h>
+#include <vector>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+namespace dl {
+namespace tool {
+
+/**
+ * @brief One stage of a pipeline, e.g. the inference of one model of a detect -> recognize cascade.
+ */
+typedef struct {
+    const char *name;                 ///< Name of the stage task
+    std::function<void(void *)> func; ///< Process one item, the item is then passed to the next stage
+    BaseType_t core;                  ///< Core the stage task is pinned to, tskNO_AFFINITY for any
+    uint32_t stack_size;              ///< Stack size of the stage task in bytes
+} pipeline_stage_t;
+
+/**
+ * @brief Latency statistics of one stage, in us.
+ */
+typedef struct {
+    uint32_t count;    ///< Number of processed items
+    uint32_t last;     ///< Latency of the last item
+    uint32_t min;      ///< Minimum latency
+    uint32_t max;      ///< Maximum latency
+    uint64_t sum;      ///< Sum of the latencies, sum / count is the average
+    uint64_t wait_sum; ///< Sum of the time the stage waited for its next item
+} pipeline_stats_t;
+
+/**
+ * @brief Run stages on their own tasks, pinned to cores, so that different items are processed by different stages
+ * at the same time: while stage 1 processes frame N on core 1, stage 0 processes frame N + 1 on core 0.
+ *
+ * The stages are linked by bounded queues of item pointers. push() blocks when the first queue is full, so a slow
+ * stage limits the number of items in flight instead of the memory growing. The items belong to the caller, they
+ * must stay valid from push() until pop() returns them, in the same order, or until the destructor releases them.
+ */
+class Pipeline {
+private:
+    typedef struct {
+        Pipeline *pipeline; /*!< Owner of the stage */
+        int index;          /*!< Index of the stage */
+    } stage_args_t;
+
+    std::vector<pipeline_stage_t> m_stages; /*!< Stages, in processing order */
+    std::vector<stage_args_t> m_args;       /*!< Arguments of the stage tasks */
+    std::vector<QueueHandle_t> m_queues;    /*!< m_queues[i] feeds stage i, the last one holds the processed items */
+    std::vector<pipeline_stats_t> m_stats;  /*!< Statistics of each stage */
+    SemaphoreHandle_t m_exit;               /*!< Given by each stage task when it exits */
+    int m_running;                          /*!< Number of running stage tasks */
+    std::function<void(void *)> m_release;  /*!< Releases the processed items dropped by the destructor */
+    portMUX_TYPE m_stats_lock = portMUX_INITIALIZER_UNLOCKED; /*!< Protects m_stats */
+
+    static void stage_task(void *args);
+    void drop_processed();
+
+public:
+    /**
+     * @brief Construct a new Pipeline object and start its stage tasks.
+     *
+     * @param stages       Stages, in processing order
+     * @param queue_depth  Number of items each queue holds, 1 is enough to keep all stages busy
+     * @param priority     Priority of the stage tasks
+     * @param release      Called by the destructor on each processed item that was not popped, e.g. to free the
+     *                     buffers the item holds. nullptr if the items own nothing
+     */
+    Pipeline(const std::vector<pipeline_stage_t> &stages,
+             int queue_depth = 1,
+             UBaseType_t priority = 5,
+             std::function<void(void *)> release = nullptr);
+
+    /**
+     * @brief Destroy the Pipeline object. The stage tasks finish the items already pushed and exit, the processed
+     * items that were not popped are passed to the release function.
+     */
+    ~Pipeline();
+
+    /**
+     * @brief Pass an item to the first stage.
+     *
+     * @param item     Item, not nullptr
+     * @param timeout  Ticks to wait when the first queue is full
+     * @return true if the item was queued, false on timeout or if the stage tasks are not running
+     */
+    bool push(void *item, TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Take an item processed by all stages.
+     *
+     * @param item     The processed item
+     * @param timeout  Ticks to wait for an item
+     * @return true if an item was taken, false on timeout
+     */
+    bool pop(void **item, TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Get the number of stages.
+     *
+     * @return Number of stages
+     */
+    int get_stage_num() { return m_stages.size(); }
+
+    /**
+     * @brief Get the latency statistics of a stage.
+     *
+     * @param stage  Index of the stage
+     * @return Statistics
+     */
+    pipeline_stats_t get_stats(int stage);
+
+    /**
+     * @brief Reset the statistics of all stages.
+     */
+    void reset_stats();
+
+    /**
+     * @brief Print the statistics of all stages.
+     *
+     * @param prefix  Prefix of each line
+     */
+    void print_stats(const char *prefix = "pipeline");
+};
+
+} // namespace tool
+} // namespace dl
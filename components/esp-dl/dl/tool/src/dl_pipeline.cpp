@@ -0,0 +1,187 @@
+#include "dl_pipeline.hpp"
+#include "esp_log.h"
+#include <stdio.h>
+
+static const char *TAG = "dl::Pipeline";
+
+namespace dl {
+namespace tool {
+
+Pipeline::Pipeline(const std::vector<pipeline_stage_t> &stages,
+                   int queue_depth,
+                   UBaseType_t priority,
+                   std::function<void(void *)> release) :
+    m_stages(stages),
+    m_args(stages.size()),
+    m_stats(stages.size()),
+    m_exit(nullptr),
+    m_running(0),
+    m_release(release)
+{
+    this->reset_stats();
+    if (m_stages.empty()) {
+        return;
+    }
+    m_exit = xSemaphoreCreateCounting(m_stages.size(), 0);
+    for (int i = 0; i <= m_stages.size(); i++) {
+        QueueHandle_t queue = xQueueCreate(queue_depth, sizeof(void *));
+        if (!queue || !m_exit) {
+            ESP_LOGE(TAG, "Failed to create the queues.");
+            return;
+        }
+        m_queues.push_back(queue);
+    }
+    for (int i = 0; i < m_stages.size(); i++) {
+        m_args[i].pipeline = this;
+        m_args[i].index = i;
+        if (xTaskCreatePinnedToCore(stage_task,
+                                    m_stages[i].name,
+                                    m_stages[i].stack_size,
+                                    &m_args[i],
+                                    priority,
+                                    nullptr,
+                                    m_stages[i].core) != pdPASS) {
+            ESP_LOGE(TAG, "Failed to create the task of stage %s.", m_stages[i].name);
+            break;
+        }
+        m_running++;
+    }
+}
+
+Pipeline::~Pipeline()
+{
+    if (m_running) {
+        // A nullptr item makes each created stage exit once the items before it are processed. The stages are
+        // created in order, so they are the first m_running ones, see stage_task.
+        // The output queue is drained meanwhile, the last stage may wait for room in it.
+        void *item = nullptr;
+        while (xQueueSend(m_queues[0], &item, pdMS_TO_TICKS(10)) != pdTRUE) {
+            drop_processed();
+        }
+        int exited = 0;
+        while (exited < m_running) {
+            if (xSemaphoreTake(m_exit, pdMS_TO_TICKS(10)) == pdTRUE) {
+                exited++;
+            } else {
+                drop_processed();
+            }
+        }
+        drop_processed();
+    }
+    for (int i = 0; i < m_queues.size(); i++) {
+        vQueueDelete(m_queues[i]);
+    }
+    if (m_exit) {
+        vSemaphoreDelete(m_exit);
+    }
+}
+
+void Pipeline::drop_processed()
+{
+    void *item = nullptr;
+    while (xQueueReceive(m_queues.back(), &item, 0) == pdTRUE) {
+        if (m_release) {
+            m_release(item);
+        }
+    }
+}
+
+void Pipeline::stage_task(void *args)
+{
+    stage_args_t *stage_args = (stage_args_t *)args;
+    Pipeline *pipeline = stage_args->pipeline;
+    int index = stage_args->index;
+    QueueHandle_t in = pipeline->m_queues[index];
+    QueueHandle_t out = pipeline->m_queues[index + 1];
+
+    while (true) {
+        void *item = nullptr;
+        int64_t wait_start = esp_timer_get_time();
+        xQueueReceive(in, &item, portMAX_DELAY);
+        if (!item) {
+            // Only the created stages get the nullptr item. If a stage task failed to create, the stages after it
+            // don't run and nothing reads their queues.
+            if (index + 1 < pipeline->m_running) {
+                xQueueSend(out, &item, portMAX_DELAY);
+            }
+            break;
+        }
+
+        int64_t start = esp_timer_get_time();
+        pipeline->m_stages[index].func(item);
+        uint32_t period = esp_timer_get_time() - start;
+
+        portENTER_CRITICAL(&pipeline->m_stats_lock);
+        pipeline_stats_t &stats = pipeline->m_stats[index];
+        stats.count++;
+        stats.last = period;
+        stats.min = period < stats.min ? period : stats.min;
+        stats.max = period > stats.max ? period : stats.max;
+        stats.sum += period;
+        stats.wait_sum += start - wait_start;
+        portEXIT_CRITICAL(&pipeline->m_stats_lock);
+
+        xQueueSend(out, &item, portMAX_DELAY);
+    }
+    xSemaphoreGive(pipeline->m_exit);
+    vTaskDelete(NULL);
+}
+
+bool Pipeline::push(void *item, TickType_t timeout)
+{
+    if (!item || m_running != m_stages.size() || m_stages.empty()) {
+        return false;
+    }
+    return xQueueSend(m_queues[0], &item, timeout) == pdTRUE;
+}
+
+bool Pipeline::pop(void **item, TickType_t timeout)
+{
+    if (m_queues.empty()) {
+        return false;
+    }
+    return xQueueReceive(m_queues.back(), item, timeout) == pdTRUE;
+}
+
+pipeline_stats_t Pipeline::get_stats(int stage)
+{
+    pipeline_stats_t stats = {};
+    if (stage >= 0 && stage < m_stats.size()) {
+        portENTER_CRITICAL(&m_stats_lock);
+        stats = m_stats[stage];
+        portEXIT_CRITICAL(&m_stats_lock);
+    }
+    return stats;
+}
+
+void Pipeline::reset_stats()
+{
+    portENTER_CRITICAL(&m_stats_lock);
+    for (int i = 0; i < m_stats.size(); i++) {
+        m_stats[i] = {};
+        m_stats[i].min = UINT32_MAX;
+    }
+    portEXIT_CRITICAL(&m_stats_lock);
+}
+
+void Pipeline::print_stats(const char *prefix)
+{
+    for (int i = 0; i < m_stages.size(); i++) {
+        pipeline_stats_t stats = this->get_stats(i);
+        if (!stats.count) {
+            printf("%s::%s: no item\n", prefix, m_stages[i].name);
+            continue;
+        }
+        printf("%s::%s: %lu items, avg %lu us, min %lu us, max %lu us, wait avg %lu us\n",
+               prefix,
+               m_stages[i].name,
+               (unsigned long)stats.count,
+               (unsigned long)(stats.sum / stats.count),
+               (unsigned long)stats.min,
+               (unsigned long)stats.max,
+               (unsigned long)(stats.wait_sum / stats.count));
+    }
+}
+
+} // namespace tool
+} // namespace dl
@@ -0,0 +1,19 @@
+#include <stdio.h>
+#include "unity.h"
+
+void setUp(void)
+{
+}
+
+void tearDown(void)
+{
+}
+
+void app_main(void)
+{
+    printf("esp-dl host tests\n");
+
+    UNITY_BEGIN();
+    unity_run_all_tests();
+    UNITY_END();
+}
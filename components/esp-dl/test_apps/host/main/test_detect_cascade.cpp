@@ -0,0 +1,143 @@
+/*
+ * Tests of the cascade pipeline of the detect, with dummy propose and refine stages standing in for MSR and MNP
+ */
+
+#include <atomic>
+#include <vector>
+#include "unity.h"
+
+#include "dl_detect_cascade.hpp"
+
+using namespace dl;
+using namespace dl::detect;
+
+namespace {
+
+// Stands in for MSR: one candidate per 10 pixels of width, at x = frame id. The list is overwritten on every run as
+// the list of a postprocessor is.
+struct DummyPropose {
+    std::list<result_t> candidates;
+
+    std::list<result_t> &run(const image::img_t &img)
+    {
+        candidates.clear();
+        int id = (intptr_t)img.data;
+        for (int i = 0; i < img.width / 10; i++) {
+            candidates.push_back({0, 0.5f, {id, i, id + 10, i + 10}, {}});
+        }
+        vTaskDelay(pdMS_TO_TICKS(2));
+        return candidates;
+    }
+};
+
+// Stands in for MNP: keeps the even candidates and raises their score
+struct DummyRefine {
+    std::list<result_t> result;
+
+    std::list<result_t> &run(const image::img_t &img, std::list<result_t> &candidates)
+    {
+        result.clear();
+        for (result_t &candidate : candidates) {
+            if (candidate.box[1] % 2 == 0) {
+                result.push_back({1, 0.9f, candidate.box, {}});
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(3));
+        return result;
+    }
+};
+
+CascadePipeline::frame_t make_frame(int id, int width)
+{
+    CascadePipeline::frame_t frame = {};
+    frame.img = {(void *)(intptr_t)id, (uint16_t)width, 10, image::DL_IMAGE_PIX_TYPE_RGB888};
+    frame.user_data = nullptr;
+    return frame;
+}
+
+} // namespace
+
+TEST_CASE("cascade pipeline passes the candidates of the propose stage to the refine stage", "[detect_cascade]")
+{
+    DummyPropose propose;
+    DummyRefine refine;
+    CascadePipeline cascade(
+        [&propose](const image::img_t &img) -> std::list<result_t> & { return propose.run(img); },
+        [&refine](const image::img_t &img, std::list<result_t> &candidates) -> std::list<result_t> & {
+            return refine.run(img, candidates);
+        },
+        nullptr,
+        1,
+        8192,
+        tskNO_AFFINITY,
+        tskNO_AFFINITY);
+
+    const int frame_num = 8;
+    CascadePipeline::frame_t frames[frame_num];
+    int pushed = 0;
+    int popped = 0;
+    while (popped < frame_num) {
+        if (pushed < frame_num) {
+            frames[pushed] = make_frame(pushed, 10 * (pushed + 1));
+            if (cascade.push(&frames[pushed], 0)) {
+                pushed++;
+                continue;
+            }
+        }
+        CascadePipeline::frame_t *frame = cascade.pop(pdMS_TO_TICKS(100));
+        if (!frame) {
+            continue;
+        }
+        // the frames come out in push order with their own copies of the lists of both stages
+        TEST_ASSERT_EQUAL_PTR(&frames[popped], frame);
+        TEST_ASSERT_EQUAL(popped + 1, frame->candidates.size());
+        TEST_ASSERT_EQUAL(popped / 2 + 1, frame->result.size());
+        int i = 0;
+        for (result_t &candidate : frame->candidates) {
+            TEST_ASSERT_EQUAL(popped, candidate.box[0]);
+            TEST_ASSERT_EQUAL(i++, candidate.box[1]);
+        }
+        i = 0;
+        for (result_t &result : frame->result) {
+            TEST_ASSERT_EQUAL(1, result.category);
+            TEST_ASSERT_EQUAL(popped, result.box[0]);
+            TEST_ASSERT_EQUAL(2 * i++, result.box[1]);
+        }
+        popped++;
+    }
+    TEST_ASSERT_EQUAL(frame_num, cascade.get_pipeline()->get_stats(0).count);
+    TEST_ASSERT_EQUAL(frame_num, cascade.get_pipeline()->get_stats(1).count);
+}
+
+TEST_CASE("cascade pipeline releases the frames which were not popped", "[detect_cascade]")
+{
+    DummyPropose propose;
+    DummyRefine refine;
+    std::vector<int> released;
+    int buffers[3] = {0, 1, 2};
+    CascadePipeline::frame_t frames[3];
+    {
+        CascadePipeline cascade(
+            [&propose](const image::img_t &img) -> std::list<result_t> & { return propose.run(img); },
+            [&refine](const image::img_t &img, std::list<result_t> &candidates) -> std::list<result_t> & {
+                return refine.run(img, candidates);
+            },
+            [&released](CascadePipeline::frame_t *frame) { released.push_back(*(int *)frame->user_data); },
+            1,
+            8192,
+            tskNO_AFFINITY,
+            tskNO_AFFINITY);
+        for (int i = 0; i < 3; i++) {
+            frames[i] = make_frame(i, 40);
+            frames[i].user_data = &buffers[i];
+            TEST_ASSERT_TRUE(cascade.push(&frames[i]));
+        }
+        CascadePipeline::frame_t *frame = cascade.pop();
+        TEST_ASSERT_EQUAL_PTR(&frames[0], frame);
+    }
+    // the frames still in the pipeline are processed, then released in order
+    TEST_ASSERT_EQUAL(2, released.size());
+    TEST_ASSERT_EQUAL(1, released[0]);
+    TEST_ASSERT_EQUAL(2, released[1]);
+    TEST_ASSERT_EQUAL(2, frames[2].result.size());
+}
@@ -0,0 +1,362 @@
+/*
+ * Tests of the tracker of the detect postprocessors and of TrackedDetect, on recorded detection sequences
+ *
+ * A sequence is a text file: a "width height frames" line, then a "frame category score x1 y1 x2 y2" line per
+ * detection, '#' starts a comment. It is the output of a detector on every frame of a clip, a keyframe interval is
+ * replayed by only giving the tracker the detections of every Nth frame.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "unity.h"
+
+#include "dl_detect_base.hpp"
+#include "dl_detect_tracker.hpp"
+
+using dl::detect::Detect;
+using dl::detect::MotionDetector;
+using dl::detect::result_t;
+using dl::detect::track_t;
+using dl::detect::TrackedDetect;
+using dl::detect::Tracker;
+
+namespace {
+
+struct Sequence {
+    int width;
+    int height;
+    std::vector<std::list<result_t>> frames;
+};
+
+Sequence load_sequence(const char *name)
+{
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%s", SEQUENCE_DIR, name);
+    FILE *f = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(f, path);
+
+    Sequence seq = {0, 0, {}};
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (seq.width == 0) {
+            int frame_num = 0;
+            TEST_ASSERT_EQUAL(3, sscanf(line, "%d %d %d", &seq.width, &seq.height, &frame_num));
+            seq.frames.resize(frame_num);
+            continue;
+        }
+        int frame;
+        int box[4];
+        result_t det = {0, 0, {}, {}};
+        int n = sscanf(
+            line, "%d %d %f %d %d %d %d", &frame, &det.category, &det.score, &box[0], &box[1], &box[2], &box[3]);
+        TEST_ASSERT_EQUAL(7, n);
+        TEST_ASSERT_LESS_THAN((int)seq.frames.size(), frame);
+        det.box.assign(box, box + 4);
+        seq.frames[frame].push_back(det);
+    }
+    fclose(f);
+    return seq;
+}
+
+float iou(const std::vector<int> &a, const std::vector<int> &b)
+{
+    int inter_width = std::min(a[2], b[2]) - std::max(a[0], b[0]);
+    int inter_height = std::min(a[3], b[3]) - std::max(a[1], b[1]);
+    if (inter_width <= 0 || inter_height <= 0) {
+        return 0;
+    }
+    float inter_area = (float)inter_width * inter_height;
+    return inter_area / ((a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter_area);
+}
+
+// Id of the track which overlaps the box most, 0 if none
+int find_track(const std::list<track_t> &tracks, const std::vector<int> &box, float *best_iou = nullptr)
+{
+    int id = 0;
+    float best = 0.3;
+    for (const track_t &track : tracks) {
+        float value = iou(track.box, box);
+        if (value > best) {
+            best = value;
+            id = track.id;
+        }
+    }
+    if (best_iou) {
+        *best_iou = id ? best : 0;
+    }
+    return id;
+}
+
+// Detector which replays the detections of a frame of a sequence, and counts its inferences
+class ReplayDetect : public Detect {
+public:
+    const Sequence *seq;
+    int frame = 0;
+    int inferences = 0;
+    std::list<result_t> result;
+
+    ReplayDetect(const Sequence *seq) : seq(seq) {}
+
+    std::list<result_t> &run(const dl::image::img_t &img) override
+    {
+        inferences++;
+        result = seq->frames[frame];
+        return result;
+    }
+    Detect &set_score_thr(float score_thr, int idx) override { return *this; }
+    Detect &set_nms_thr(float nms_thr, int idx) override { return *this; }
+    Detect &set_nms_type(dl::detect::nms_type_t nms_type, bool class_aware, int idx) override { return *this; }
+    dl::Model *get_raw_model(int idx) override { return nullptr; }
+};
+
+} // namespace
+
+TEST_CASE("tracker keeps the ids of crossing pedestrians through an occlusion", "[tracker]")
+{
+    Sequence seq = load_sequence("walk_crossing.txt");
+    Tracker tracker(0.3, 2, 5);
+
+    int id_a = 0;
+    int id_b = 0;
+    for (int t = 0; t < seq.frames.size(); t++) {
+        std::list<track_t> &tracks = tracker.update(seq.frames[t], seq.width, seq.height);
+        if (t == 0) {
+            // a track is reported from its second detection
+            TEST_ASSERT_EQUAL(0, tracks.size());
+            continue;
+        }
+        // the false positive of frame 10 is never reported
+        TEST_ASSERT_EQUAL(t >= 27 && t <= 30 ? 1 : 2, tracks.size());
+
+        // A is the first detection of each frame, B the second one
+        int a = find_track(tracks, seq.frames[t].front().box);
+        TEST_ASSERT_NOT_EQUAL(0, a);
+        if (id_a == 0) {
+            id_a = a;
+        }
+        TEST_ASSERT_EQUAL(id_a, a);
+        if (t < 27 || t > 30) {
+            int b = find_track(tracks, (++seq.frames[t].begin())->box);
+            TEST_ASSERT_NOT_EQUAL(0, b);
+            if (id_b == 0) {
+                id_b = b;
+            }
+            TEST_ASSERT_EQUAL(id_b, b);
+        }
+        // a reported track which is not detected is a loss
+        TEST_ASSERT_EQUAL(t >= 27 && t <= 30, tracker.is_lost());
+    }
+    TEST_ASSERT_NOT_EQUAL(id_a, id_b);
+}
+
+TEST_CASE("tracker predicts the boxes between keyframes", "[tracker]")
+{
+    Sequence seq = load_sequence("walk_crossing.txt");
+    const int interval = 5;
+    Tracker tracker(0.3, 2, 2);
+
+    int id_a = 0;
+    float min_iou = 1;
+    int min_width = seq.width;
+    int min_height = seq.height;
+    for (int t = 0; t < seq.frames.size(); t++) {
+        bool keyframe = t % interval == 0;
+        std::list<track_t> &tracks = keyframe ? tracker.update(seq.frames[t], seq.width, seq.height)
+                                              : tracker.predict(seq.width, seq.height);
+        const std::vector<int> &box = seq.frames[t].front().box;
+        min_width = std::min(min_width, box[2] - box[0]);
+        min_height = std::min(min_height, box[3] - box[1]);
+        if (t <= interval) {
+            continue;
+        }
+        // A moves by 20 pixels between two keyframes, the predicted box follows it
+        float value;
+        int a = find_track(tracks, box, &value);
+        if (id_a == 0) {
+            id_a = a;
+        }
+        TEST_ASSERT_EQUAL(id_a, a);
+        // from the third keyframe, the velocity of A is known
+        if (t > 2 * interval) {
+            min_iou = std::min(min_iou, value);
+        }
+    }
+    // The edges of the detections of A are within 2.5 pixels of its straight line motion. The filter follows the
+    // detected positions, so the edges of a corrected box are off by up to this jitter, and its velocity, at worst the
+    // difference of two keyframes, by 2 * jitter / interval a frame for up to interval - 1 frames. The detection the
+    // prediction is compared to is off by one more jitter. With every edge off by edge_error, the smallest IoU is the
+    // one of a box and the box shrunk by edge_error on each side. Without the prediction, the box would lag by 16
+    // pixels before the next keyframe, an IoU of 0.63 for a 70 pixels wide box before any jitter.
+    const float jitter = 2.5;
+    float edge_error = 2 * jitter + 2 * jitter * (interval - 1) / interval;
+    float min_expected_iou = (min_width - 2 * edge_error) * (min_height - 2 * edge_error) / (min_width * min_height);
+    TEST_ASSERT_TRUE(min_iou >= min_expected_iou);
+}
+
+TEST_CASE("tracker reports a missed detection as a loss", "[tracker]")
+{
+    Sequence seq = load_sequence("static_scene.txt");
+    Tracker tracker;
+
+    std::vector<int> ids;
+    for (int t = 0; t < seq.frames.size(); t++) {
+        std::list<track_t> &tracks = tracker.update(seq.frames[t], seq.width, seq.height);
+        TEST_ASSERT_EQUAL(t == 40, tracker.is_lost());
+        if (t == 0) {
+            continue;
+        }
+        TEST_ASSERT_EQUAL(t == 40 ? 1 : 2, tracks.size());
+        if (ids.empty()) {
+            for (const track_t &track : tracks) {
+                ids.push_back(track.id);
+            }
+        }
+        // the jitter of the boxes does not change the ids, the first person keeps its id after the missed frame
+        for (const track_t &track : tracks) {
+            TEST_ASSERT_TRUE(track.id == ids[0] || track.id == ids[1]);
+        }
+    }
+    TEST_ASSERT_EQUAL(89, tracker.get_tracks().front().hits);
+}
+
+TEST_CASE("tracker removes the tracks which leave the image", "[tracker]")
+{
+    Tracker tracker(0.3, 2, 2);
+    std::list<result_t> dets;
+    for (int t = 0; t < 3; t++) {
+        dets = {{0, 0.9, {500 + 20 * t, 100, 580 + 20 * t, 200}, {}}};
+        tracker.update(dets, 640, 480);
+    }
+    TEST_ASSERT_EQUAL(1, tracker.get_tracks().size());
+    TEST_ASSERT_FALSE(tracker.is_lost());
+
+    // 20 pixels a frame, the left of the box is at 540 and leaves the image after 5 frames
+    int t = 0;
+    while (!tracker.is_lost() && t < 10) {
+        std::list<track_t> &tracks = tracker.predict(640, 480);
+        if (!tracker.is_lost()) {
+            TEST_ASSERT_EQUAL(1, tracks.size());
+            TEST_ASSERT_EQUAL(639, tracks.front().box[2]);
+        }
+        t++;
+    }
+    TEST_ASSERT_EQUAL(5, t);
+    TEST_ASSERT_EQUAL(0, tracker.get_tracks().size());
+}
+
+TEST_CASE("tracker only matches the boxes of the same category", "[tracker]")
+{
+    Tracker tracker(0.3, 1, 0);
+    std::list<result_t> dets = {{0, 0.9, {100, 100, 200, 200}, {}}};
+    int id = tracker.update(dets, 640, 480).front().id;
+    dets = {{1, 0.9, {102, 100, 202, 200}, {}}};
+    std::list<track_t> &tracks = tracker.update(dets, 640, 480);
+    TEST_ASSERT_EQUAL(1, tracks.size());
+    TEST_ASSERT_NOT_EQUAL(id, tracks.front().id);
+    TEST_ASSERT_EQUAL(1, tracks.front().category);
+}
+
+TEST_CASE("motion detector ignores the tracked boxes", "[tracker]")
+{
+    const int width = 320;
+    const int height = 240;
+    std::vector<uint8_t> frame(width * height, 100);
+    dl::image::img_t img = {frame.data(), width, height, dl::image::DL_IMAGE_PIX_TYPE_GRAY};
+    std::list<track_t> masks = {{1, 0, 0.9, {0, 0, 79, 239}, 2, 0}};
+
+    MotionDetector motion(24);
+    TEST_ASSERT_EQUAL_FLOAT(0, motion.get_motion(img, {}));
+    motion.set_reference(img, masks);
+    TEST_ASSERT_EQUAL_FLOAT(0, motion.get_motion(img, {}));
+
+    // a change in the box masked in the reference frame
+    for (int y = 0; y < height; y++) {
+        memset(&frame[y * width], 200, 80);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0, motion.get_motion(img, {}));
+
+    // a change outside: a quarter of the image
+    for (int y = 0; y < height / 2; y++) {
+        memset(&frame[y * width + width / 2], 200, width / 2);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.25, motion.get_motion(img, {}));
+    // masked in the current frame
+    std::list<track_t> current = {{1, 0, 0.9, {160, 0, 319, 119}, 2, 0}};
+    TEST_ASSERT_EQUAL_FLOAT(0, motion.get_motion(img, current));
+}
+
+TEST_CASE("motion detector reads big endian RGB565", "[tracker]")
+{
+    const int width = 64;
+    const int height = 48;
+    std::vector<uint8_t> frame(width * height * 2, 0);
+    dl::image::img_t img = {frame.data(), width, height, dl::image::DL_IMAGE_PIX_TYPE_RGB565};
+
+    MotionDetector motion(24, dl::image::DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
+    MotionDetector little(24);
+    motion.set_reference(img, {});
+    little.set_reference(img, {});
+    // 0x18 0x00 is a dark red of luma 6 in big endian, and a blue of luma 48 in little endian
+    for (int i = 0; i < width * height; i++) {
+        frame[2 * i] = 0x18;
+    }
+    TEST_ASSERT_EQUAL_FLOAT(0, motion.get_motion(img, {}));
+    TEST_ASSERT_EQUAL_FLOAT(1, little.get_motion(img, {}));
+}
+
+TEST_CASE("tracked detect runs the detector on the keyframes and after a loss", "[tracker]")
+{
+    Sequence seq = load_sequence("static_scene.txt");
+    std::vector<uint8_t> frame(seq.width * seq.height, 100);
+    dl::image::img_t img = {frame.data(), (uint16_t)seq.width, (uint16_t)seq.height, dl::image::DL_IMAGE_PIX_TYPE_GRAY};
+    ReplayDetect detect(&seq);
+    TrackedDetect tracked(&detect, 5, 1);
+
+    int keyframes = 0;
+    for (int t = 0; t < seq.frames.size(); t++) {
+        detect.frame = t;
+        std::list<track_t> &tracks = tracked.run(img);
+        // a keyframe every 5 frames, the person missed on the keyframe 40 is detected again on the next frame
+        bool keyframe = t <= 40 ? t % 5 == 0 : (t - 41) % 5 == 0;
+        TEST_ASSERT_EQUAL(keyframe, tracked.is_keyframe());
+        keyframes += keyframe;
+        if (t >= 5 && t != 40) {
+            TEST_ASSERT_EQUAL(2, tracks.size());
+        }
+    }
+    TEST_ASSERT_EQUAL(keyframes, detect.inferences);
+}
+
+TEST_CASE("tracked detect runs the detector when the image changes outside of the tracks", "[tracker]")
+{
+    const int width = 320;
+    const int height = 240;
+    Sequence seq = {width, height, std::vector<std::list<result_t>>(20, {{0, 0.9, {20, 20, 60, 60}, {}}})};
+    std::vector<uint8_t> frame(width * height, 100);
+    dl::image::img_t img = {frame.data(), width, height, dl::image::DL_IMAGE_PIX_TYPE_GRAY};
+    ReplayDetect detect(&seq);
+    TrackedDetect tracked(&detect, 100, 0.05);
+
+    for (int t = 0; t < seq.frames.size(); t++) {
+        if (t == 5) {
+            // a quarter of the image, the first frame which changed is a keyframe
+            for (int y = height / 2; y < height; y++) {
+                memset(&frame[y * width + width / 2], 200, width / 2);
+            }
+        } else if (t == 10) {
+            // the tracked box
+            for (int y = 30; y < 50; y++) {
+                memset(&frame[y * width + 30], 200, 20);
+            }
+        }
+        detect.frame = t;
+        tracked.run(img);
+        TEST_ASSERT_EQUAL(t == 0 || t == 5, tracked.is_keyframe());
+    }
+    TEST_ASSERT_EQUAL(2, detect.inferences);
+}
@@ -0,0 +1,219 @@
+/*
+ * Tests of the heap allocations of the module forwards: once the args are prepared, the forwards and the dual core
+ * runs on the workers must not allocate. The allocations are counted by wrappers of malloc, see CMakeLists.txt, and by
+ * the replaced operator new.
+ */
+
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "unity.h"
+
+#include "dl_module_conv.hpp"
+#include "dl_module_matmul.hpp"
+#include "dl_module_sigmoid.hpp"
+
+using namespace dl;
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+int __real_posix_memalign(void **ptr, size_t alignment, size_t size);
+void *__real_aligned_alloc(size_t alignment, size_t size);
+
+void *__wrap_malloc(size_t size)
+{
+    ModelContext::count_heap_alloc();
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size)
+{
+    ModelContext::count_heap_alloc();
+    return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size)
+{
+    ModelContext::count_heap_alloc();
+    return __real_realloc(ptr, size);
+}
+
+int __wrap_posix_memalign(void **ptr, size_t alignment, size_t size)
+{
+    ModelContext::count_heap_alloc();
+    return __real_posix_memalign(ptr, alignment, size);
+}
+
+void *__wrap_aligned_alloc(size_t alignment, size_t size)
+{
+    ModelContext::count_heap_alloc();
+    return __real_aligned_alloc(alignment, size);
+}
+}
+
+// the operator new of the C++ library calls its own malloc, which is not wrapped
+void *operator new(size_t size)
+{
+    ModelContext::count_heap_alloc();
+    void *ptr = __real_malloc(size ? size : 1);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void *operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+void operator delete[](void *ptr, size_t size) noexcept
+{
+    free(ptr);
+}
+
+namespace {
+
+template <typename T>
+void fill(TensorBase &tensor, int mod, int seed)
+{
+    T *data = (T *)tensor.get_element_ptr();
+    for (int i = 0; i < tensor.get_size(); i++) {
+        data[i] = (T)((i * (37 + seed)) % mod - mod / 2);
+    }
+}
+
+// Forward a prepared module and return the number of heap allocations of the forward
+size_t counted_forward(module::Module &op, ModelContext &context, runtime_mode_t mode)
+{
+    context.reset_heap_alloc_count();
+    context.begin_forward();
+    op.forward(&context, mode);
+    context.end_forward();
+    return context.get_heap_alloc_count();
+}
+
+} // namespace
+
+TEST_CASE("the allocation counter counts the allocations of a forward only", "[forward_alloc]")
+{
+    ModelContext context;
+    // volatile, the compiler may remove an allocation which is freed right away
+    void *volatile before = malloc(16);
+    context.begin_forward();
+    void *volatile ptr = malloc(16);
+    int *volatile value = new int(1);
+    free(ptr);
+    delete value;
+    context.end_forward();
+    free(before);
+    TEST_ASSERT_EQUAL(2, context.get_heap_alloc_count());
+}
+
+TEST_CASE("conv forwards do not allocate on one or both cores", "[forward_alloc]")
+{
+    TEST_ASSERT_TRUE(module::ModuleWorker::start());
+    TensorBase input({1, 8, 8, 16}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase filter({3, 3, 16, 16}, nullptr, -7, DATA_TYPE_INT8);
+    TensorBase output({1, 8, 8, 16}, nullptr, -4, DATA_TYPE_INT8);
+    fill<int8_t>(input, 23, 0);
+    fill<int8_t>(filter, 17, 1);
+
+    std::vector<uint8_t> ref;
+    for (runtime_mode_t mode : {RUNTIME_MODE_SINGLE_CORE, RUNTIME_MODE_MULTI_CORE}) {
+        ModelContext context;
+        module::Conv conv(ReLU, {1, 1, 1, 1}, {1, 1}, {1, 1}, "conv", 1, QUANT_TYPE_SYMM_8BIT);
+        conv.m_inputs_index.push_back(context.push_back_tensor(&input));
+        conv.m_inputs_index.push_back(context.push_back_tensor(&filter));
+        conv.m_outputs_index.push_back(context.push_back_tensor(&output));
+        conv.prepare(&context, mode);
+        for (int i = 0; i < 3; i++) {
+            memset(output.get_element_ptr(), 0x5a, output.get_bytes());
+            TEST_ASSERT_EQUAL(0, counted_forward(conv, context, mode));
+        }
+        uint8_t *data = (uint8_t *)output.get_element_ptr();
+        if (ref.empty()) {
+            ref.assign(data, data + output.get_bytes());
+        } else {
+            TEST_ASSERT_EQUAL_MEMORY(ref.data(), data, ref.size());
+        }
+    }
+    module::ModuleWorker::stop();
+}
+
+TEST_CASE("batched matmul with an unaligned input1 keeps its copy and does not allocate", "[forward_alloc]")
+{
+    TEST_ASSERT_TRUE(module::ModuleWorker::start());
+    // c * n = 15 is not a multiple of 16, every batch of input1 is copied to an aligned filter
+    const int batch = 4, m = 6, c = 3, n = 5;
+    TensorBase input0({batch, m, c}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase input1({batch, c, n}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase output({batch, m, n}, nullptr, -4, DATA_TYPE_INT8);
+    fill<int8_t>(input0, 23, 0);
+
+    for (runtime_mode_t mode : {RUNTIME_MODE_SINGLE_CORE, RUNTIME_MODE_MULTI_CORE}) {
+        ModelContext context;
+        module::MatMul matmul(Linear, "matmul", QUANT_TYPE_SYMM_8BIT);
+        matmul.m_inputs_index.push_back(context.push_back_tensor(&input0));
+        matmul.m_inputs_index.push_back(context.push_back_tensor(&input1));
+        matmul.m_outputs_index.push_back(context.push_back_tensor(&output));
+        matmul.prepare(&context, mode);
+
+        for (int seed = 0; seed < 3; seed++) {
+            // input1 is a variable, each forward must read its current values
+            fill<int8_t>(input1, 17, seed);
+            memset(output.get_element_ptr(), 0x5a, output.get_bytes());
+            TEST_ASSERT_EQUAL(0, counted_forward(matmul, context, mode));
+
+            for (int b = 0; b < batch; b++) {
+                TensorBase input0_b({m, c}, (int8_t *)input0.get_element_ptr() + b * m * c, -4, DATA_TYPE_INT8);
+                TensorBase input1_b({c, n}, nullptr, -4, DATA_TYPE_INT8);
+                memcpy(input1_b.get_element_ptr(), (int8_t *)input1.get_element_ptr() + b * c * n, c * n);
+                TensorBase output_b({m, n}, nullptr, -4, DATA_TYPE_INT8);
+                module::MatMul ref(Linear, "ref", QUANT_TYPE_SYMM_8BIT);
+                ref.run({&input0_b, &input1_b}, {&output_b}, RUNTIME_MODE_SINGLE_CORE);
+                TEST_ASSERT_EQUAL_MEMORY(
+                    output_b.get_element_ptr(), (int8_t *)output.get_element_ptr() + b * m * n, m * n);
+            }
+        }
+    }
+    module::ModuleWorker::stop();
+}
+
+TEST_CASE("split activations do not allocate on both cores", "[forward_alloc]")
+{
+    TEST_ASSERT_TRUE(module::ModuleWorker::start());
+    TensorBase input({3, 100, 50}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase output({3, 100, 50}, nullptr, -7, DATA_TYPE_INT8);
+    fill<int8_t>(input, 201, 0);
+    ModelContext context;
+    module::Sigmoid sigmoid("sigmoid", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+    sigmoid.m_inputs_index.push_back(context.push_back_tensor(&input));
+    sigmoid.m_outputs_index.push_back(context.push_back_tensor(&output));
+    sigmoid.forward(&context, RUNTIME_MODE_SINGLE_CORE);
+    std::vector<uint8_t> ref((uint8_t *)output.get_element_ptr(),
+                             (uint8_t *)output.get_element_ptr() + output.get_bytes());
+
+    memset(output.get_element_ptr(), 0x5a, output.get_bytes());
+    TEST_ASSERT_EQUAL(0, counted_forward(sigmoid, context, RUNTIME_MODE_MULTI_CORE));
+    TEST_ASSERT_EQUAL_MEMORY(ref.data(), output.get_element_ptr(), ref.size());
+    module::ModuleWorker::stop();
+}
@@ -0,0 +1,154 @@
+/*
+ * Tests of the ImageTransformer paths of ImagePreprocessor: the fused conversion and quantization of RGB565 frames,
+ * and the resize which finishes the scale of the PPA
+ */
+
+#include <string.h>
+#include <vector>
+#include "unity.h"
+
+#include "dl_image_process.hpp"
+
+using namespace dl;
+using namespace dl::image;
+
+namespace {
+
+const std::vector<float> s_mean = {123.675, 116.28, 103.53};
+const std::vector<float> s_std = {58.395, 57.12, 57.375};
+
+// a linear congruential generator, the sizes and the pixels are the same on every run
+uint32_t next(uint32_t *seed)
+{
+    *seed = *seed * 1664525 + 1013904223;
+    return *seed >> 8;
+}
+
+std::vector<uint16_t> random_frame(int width, int height, uint32_t *seed)
+{
+    std::vector<uint16_t> frame(width * height);
+    for (uint16_t &pix : frame) {
+        pix = next(seed);
+    }
+    return frame;
+}
+
+// The fused path and the path which resizes to RGB888 before the quantization
+template <typename T>
+void check_fused(const img_t &src, const std::vector<int> &crop_area, uint32_t caps, int width, int height, int exp)
+{
+    pix_type_t quant_pix_type = sizeof(T) == 1 ? DL_IMAGE_PIX_TYPE_RGB888_QINT8 : DL_IMAGE_PIX_TYPE_RGB888_QINT16;
+    NormQuantWrapper::quant_type_t quant_type =
+        sizeof(T) == 1 ? NormQuantWrapper::INT8_QUANT : NormQuantWrapper::INT16_QUANT;
+    std::vector<T> fused(width * height * 3);
+    std::vector<T> two_step(width * height * 3);
+    std::vector<uint8_t> rgb(width * height * 3);
+
+    ImageTransformer transformer;
+    transformer.set_src_img(src)
+        .set_src_img_crop_area(crop_area)
+        .set_caps(caps)
+        .set_dst_img({fused.data(), (uint16_t)width, (uint16_t)height, quant_pix_type})
+        .set_norm_quant_param(s_mean, s_std, exp, quant_type);
+    TEST_ASSERT_EQUAL(ESP_OK, transformer.transform());
+
+    ImageTransformer resize;
+    resize.set_src_img(src)
+        .set_src_img_crop_area(crop_area)
+        .set_caps(caps)
+        .set_dst_img({rgb.data(), (uint16_t)width, (uint16_t)height, DL_IMAGE_PIX_TYPE_RGB888});
+    TEST_ASSERT_EQUAL(ESP_OK, resize.transform());
+    ImageTransformer quant;
+    quant.set_src_img({rgb.data(), (uint16_t)width, (uint16_t)height, DL_IMAGE_PIX_TYPE_RGB888})
+        .set_dst_img({two_step.data(), (uint16_t)width, (uint16_t)height, quant_pix_type})
+        .set_norm_quant_param(s_mean, s_std, exp, quant_type);
+    TEST_ASSERT_EQUAL(ESP_OK, quant.transform());
+
+    TEST_ASSERT_EQUAL_MEMORY(two_step.data(), fused.data(), fused.size() * sizeof(T));
+}
+
+// Nearest neighbor stand-in for the PPA: scales the crop area into the top left of dst
+void ppa_scale(const img_t &src, const std::vector<int> &crop_area, float scale, img_t &dst, int *width, int *height)
+{
+    int x0 = crop_area.empty() ? 0 : crop_area[0];
+    int y0 = crop_area.empty() ? 0 : crop_area[1];
+    int src_width = crop_area.empty() ? src.width : crop_area[2] - x0;
+    int src_height = crop_area.empty() ? src.height : crop_area[3] - y0;
+    *width = std::min((int)(src_width * scale), (int)dst.width);
+    *height = std::min((int)(src_height * scale), (int)dst.height);
+    for (int y = 0; y < *height; y++) {
+        for (int x = 0; x < *width; x++) {
+            int sx = x0 + std::min((int)(x / scale), src_width - 1);
+            int sy = y0 + std::min((int)(y / scale), src_height - 1);
+            ((uint16_t *)dst.data)[y * dst.width + x] = ((uint16_t *)src.data)[sy * src.width + sx];
+        }
+    }
+}
+
+} // namespace
+
+TEST_CASE("image transformer quantizes RGB565 frames as the RGB888 resize and the quantization do", "[image]")
+{
+    uint32_t seed = 1;
+    for (int t = 0; t < 100; t++) {
+        int src_width = 32 + next(&seed) % 600;
+        int src_height = 32 + next(&seed) % 400;
+        int width = 8 + next(&seed) % 200;
+        int height = 8 + next(&seed) % 200;
+        uint32_t caps = t % 4 == 1 ? DL_IMAGE_CAP_RGB_SWAP : (t % 4 == 2 ? DL_IMAGE_CAP_RGB565_BIG_ENDIAN : 0);
+        std::vector<uint16_t> frame = random_frame(src_width, src_height, &seed);
+        img_t src = {frame.data(), (uint16_t)src_width, (uint16_t)src_height, DL_IMAGE_PIX_TYPE_RGB565};
+        std::vector<int> crop_area;
+        if (t % 2) {
+            int x0 = next(&seed) % (src_width / 2);
+            int y0 = next(&seed) % (src_height / 2);
+            crop_area = {x0,
+                         y0,
+                         x0 + 1 + (int)(next(&seed) % (src_width - x0)),
+                         y0 + 1 + (int)(next(&seed) % (src_height - y0))};
+        }
+        int exp = -7 + t % 3;
+        check_fused<int8_t>(src, crop_area, caps, width, height, exp);
+        check_fused<int16_t>(src, crop_area, caps, width, height, exp - 8);
+    }
+}
+
+TEST_CASE("image transformer finishes the resize of the PPA as the CPU resize does", "[image]")
+{
+    // the sizes which the PPA scales exactly, the CPU only converts the pixels it scaled
+    struct {
+        int src_width, src_height, width, height;
+        std::vector<int> crop_area;
+    } cases[] = {{640, 480, 160, 120, {}},
+                 {1280, 720, 320, 180, {}},
+                 {1280, 720, 160, 160, {320, 40, 960, 680}},
+                 {100, 60, 150, 90, {}}};
+    uint32_t seed = 2;
+    for (auto &c : cases) {
+        std::vector<uint16_t> frame = random_frame(c.src_width, c.src_height, &seed);
+        img_t src = {frame.data(), (uint16_t)c.src_width, (uint16_t)c.src_height, DL_IMAGE_PIX_TYPE_RGB565};
+        int crop_width = c.crop_area.empty() ? c.src_width : c.crop_area[2] - c.crop_area[0];
+        float scale = (float)c.width / crop_width;
+
+        std::vector<uint16_t> scaled(c.width * c.height, 0);
+        img_t ppa_img = {scaled.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB565};
+        int width, height;
+        ppa_scale(src, c.crop_area, scale, ppa_img, &width, &height);
+        std::vector<int8_t> ppa_out(c.width * c.height * 3);
+        ImageTransformer transformer;
+        transformer.set_src_img(ppa_img)
+            .set_src_img_crop_area({0, 0, width, height})
+            .set_dst_img({ppa_out.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888_QINT8})
+            .set_norm_quant_param(s_mean, s_std, -7, NormQuantWrapper::INT8_QUANT);
+        TEST_ASSERT_EQUAL(ESP_OK, transformer.transform());
+
+        std::vector<int8_t> cpu_out(c.width * c.height * 3);
+        ImageTransformer cpu;
+        cpu.set_src_img(src)
+            .set_src_img_crop_area(c.crop_area)
+            .set_dst_img({cpu_out.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888_QINT8})
+            .set_norm_quant_param(s_mean, s_std, -7, NormQuantWrapper::INT8_QUANT);
+        TEST_ASSERT_EQUAL(ESP_OK, cpu.transform());
+        TEST_ASSERT_EQUAL_MEMORY(cpu_out.data(), ppa_out.data(), cpu_out.size());
+    }
+}
@@ -0,0 +1,178 @@
+/*
+ * Tests of the modules which split their outputs on both cores: the multi core and the auto runs must give the bytes
+ * of the single core run
+ */
+
+#include <stdio.h>
+#include <vector>
+#include "unity.h"
+
+#include "dl_module_elu.hpp"
+#include "dl_module_exp.hpp"
+#include "dl_module_log.hpp"
+#include "dl_module_reduce_mean.hpp"
+#include "dl_module_reduce_sum_square.hpp"
+#include "dl_module_sigmoid.hpp"
+#include "dl_module_softmax.hpp"
+#include "dl_module_sqrt.hpp"
+#include "dl_module_swish.hpp"
+#include "dl_module_tanh.hpp"
+
+using namespace dl;
+
+namespace {
+
+template <typename T>
+void fill(TensorBase &tensor, int mod)
+{
+    T *data = (T *)tensor.get_element_ptr();
+    for (int i = 0; i < tensor.get_size(); i++) {
+        data[i] = (T)((i * 37) % mod - mod / 2);
+        if (std::is_floating_point<T>::value) {
+            data[i] /= 7;
+        }
+    }
+}
+
+// positive inputs, for Log and Sqrt
+template <typename T>
+void fill_positive(TensorBase &tensor, int mod)
+{
+    T *data = (T *)tensor.get_element_ptr();
+    for (int i = 0; i < tensor.get_size(); i++) {
+        data[i] = (T)((i * 37) % mod + 1);
+    }
+}
+
+void check_split(module::Module &op, TensorBase &input, TensorBase &output)
+{
+    ModelContext context;
+    op.m_inputs_index.push_back(context.push_back_tensor(&input));
+    op.m_outputs_index.push_back(context.push_back_tensor(&output));
+    TEST_ASSERT_TRUE(op.support_multi_core());
+
+    op.forward(&context, RUNTIME_MODE_SINGLE_CORE);
+    std::vector<uint8_t> ref((uint8_t *)output.get_element_ptr(),
+                             (uint8_t *)output.get_element_ptr() + output.get_bytes());
+    for (runtime_mode_t mode : {RUNTIME_MODE_MULTI_CORE, RUNTIME_MODE_AUTO}) {
+        memset(output.get_element_ptr(), 0x5a, output.get_bytes());
+        op.forward(&context, mode);
+        TEST_ASSERT_EQUAL_MEMORY(ref.data(), output.get_element_ptr(), output.get_bytes());
+    }
+}
+
+} // namespace
+
+TEST_CASE("softmax is bit exact on both cores for every axis", "[module_split]")
+{
+    for (int axis : {-1, 1, 0}) {
+        TensorBase input({5, 7, 33}, nullptr, 0, DATA_TYPE_FLOAT);
+        TensorBase output({5, 7, 33}, nullptr, 0, DATA_TYPE_FLOAT);
+        fill<float>(input, 101);
+        module::Softmax softmax("softmax", axis, MODULE_NON_INPLACE, QUANT_TYPE_FLOAT32);
+        check_split(softmax, input, output);
+
+        TensorBase input8({5, 7, 33}, nullptr, -4, DATA_TYPE_INT8);
+        TensorBase output8({5, 7, 33}, nullptr, 0, DATA_TYPE_FLOAT);
+        fill<int8_t>(input8, 201);
+        module::Softmax softmax8("softmax", axis, MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+        check_split(softmax8, input8, output8);
+    }
+}
+
+TEST_CASE("reduce is bit exact on both cores for every merged layout", "[module_split]")
+{
+    std::vector<std::vector<bool>> axes = {{false, true, true, true},
+                                           {true, true, false, false},
+                                           {true, false, true, true},
+                                           {false, true, true, false},
+                                           {false, true, false, true},
+                                           {true, false, true, false},
+                                           {true, true, true, true}};
+    for (std::vector<bool> &axis : axes) {
+        TensorBase input({4, 6, 10, 9}, nullptr, -4, DATA_TYPE_INT8);
+        fill<int8_t>(input, 201);
+        std::vector<int> output_shape;
+        for (int i = 0; i < 4; i++) {
+            output_shape.push_back(axis[i] ? 1 : input.shape[i]);
+        }
+        TensorBase output(output_shape, nullptr, -3, DATA_TYPE_INT8);
+        module::ReduceMean mean(1, axis, "ReduceMean", "mean", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+        check_split(mean, input, output);
+
+        TensorBase input16({4, 6, 10, 9}, nullptr, -4, DATA_TYPE_INT16);
+        fill<int16_t>(input16, 2001);
+        TensorBase output16(output_shape, nullptr, 2, DATA_TYPE_INT16);
+        module::ReduceSumSquare sum_square(
+            1, axis, "ReduceSumSquare", "sum_square", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_16BIT);
+        check_split(sum_square, input16, output16);
+    }
+}
+
+TEST_CASE("activations are bit exact on both cores", "[module_split]")
+{
+    TensorBase input({3, 100, 50}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase output({3, 100, 50}, nullptr, -7, DATA_TYPE_INT8);
+    fill<int8_t>(input, 201);
+    module::Sigmoid sigmoid("sigmoid", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+    check_split(sigmoid, input, output);
+    module::Tanh tanh("tanh", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+    check_split(tanh, input, output);
+    module::Swish swish("swish", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+    check_split(swish, input, output);
+
+    // odd sizes, the halves differ by one element
+    TensorBase input_f({3, 100, 51}, nullptr, 0, DATA_TYPE_FLOAT);
+    TensorBase output_f({3, 100, 51}, nullptr, 0, DATA_TYPE_FLOAT);
+    fill<float>(input_f, 101);
+    module::Elu elu("elu", 0.5, MODULE_NON_INPLACE, QUANT_TYPE_FLOAT32);
+    check_split(elu, input_f, output_f);
+    module::Exp exp("exp", MODULE_NON_INPLACE, QUANT_TYPE_FLOAT32);
+    check_split(exp, input_f, output_f);
+
+    fill_positive<float>(input_f, 101);
+    module::Log log("log", MODULE_NON_INPLACE, QUANT_TYPE_FLOAT32);
+    check_split(log, input_f, output_f);
+    module::Sqrt sqrt("sqrt", MODULE_NON_INPLACE, QUANT_TYPE_FLOAT32);
+    check_split(sqrt, input_f, output_f);
+}
+
+TEST_CASE("the split recorder reports the cores which computed a forward", "[module_split]")
+{
+    TensorBase input({3, 100, 50}, nullptr, -4, DATA_TYPE_INT8);
+    TensorBase output({3, 100, 50}, nullptr, -7, DATA_TYPE_INT8);
+    fill<int8_t>(input, 201);
+    ModelContext context;
+    module::Sigmoid sigmoid("sigmoid", MODULE_NON_INPLACE, QUANT_TYPE_SYMM_8BIT);
+    sigmoid.m_inputs_index.push_back(context.push_back_tensor(&input));
+    sigmoid.m_outputs_index.push_back(context.push_back_tensor(&output));
+    int core = xPortGetCoreID();
+    module::module_split_t split;
+
+    module::ModuleSplitRecorder::begin(&split);
+    sigmoid.forward(&context, RUNTIME_MODE_SINGLE_CORE);
+    module::ModuleSplitRecorder::end();
+    TEST_ASSERT_EQUAL(1 << core, split.cores);
+    TEST_ASSERT_EQUAL(0, split.split_num);
+
+    // with and without the workers, the first half runs on the other core
+    for (bool workers : {false, true}) {
+        if (workers) {
+            TEST_ASSERT_TRUE(module::ModuleWorker::start());
+        }
+        module::ModuleSplitRecorder::begin(&split);
+        sigmoid.forward(&context, RUNTIME_MODE_MULTI_CORE);
+        module::ModuleSplitRecorder::end();
+        TEST_ASSERT_EQUAL(3, split.cores);
+        TEST_ASSERT_EQUAL(1, split.split_num);
+        TEST_ASSERT_TRUE(split.other_start > 0);
+        if (workers) {
+            module::ModuleWorker::stop();
+        }
+    }
+
+    // a forward outside of begin and end is not recorded
+    split.split_num = 0;
+    sigmoid.forward(&context, RUNTIME_MODE_MULTI_CORE);
+    TEST_ASSERT_EQUAL(0, split.split_num);
+}
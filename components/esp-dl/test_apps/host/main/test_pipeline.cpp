@@ -0,0 +1,112 @@
+/*
+ * Tests of the pipeline of dl_tool, with dummy stages which tag the items
+ */
+
+#include <atomic>
+#include "unity.h"
+
+#include "dl_pipeline.hpp"
+
+using dl::tool::Pipeline;
+using dl::tool::pipeline_stage_t;
+
+namespace {
+
+struct Item {
+    int id;
+    int stages[3]; /*!< Order in which the stages processed the item, -1 if not processed */
+    int done;      /*!< Number of stages which processed the item */
+};
+
+std::vector<pipeline_stage_t> dummy_stages(std::atomic<int> *processed, int stage_num, int delay_ms)
+{
+    std::vector<pipeline_stage_t> stages;
+    static const char *names[] = {"stage0", "stage1", "stage2"};
+    for (int i = 0; i < stage_num; i++) {
+        stages.push_back({names[i],
+                          [i, processed, delay_ms](void *arg) {
+                              Item *item = (Item *)arg;
+                              if (delay_ms) {
+                                  vTaskDelay(pdMS_TO_TICKS(delay_ms));
+                              }
+                              item->stages[item->done++] = i;
+                              (*processed)++;
+                          },
+                          tskNO_AFFINITY,
+                          4096});
+    }
+    return stages;
+}
+
+} // namespace
+
+TEST_CASE("pipeline passes the items through the stages in order", "[pipeline]")
+{
+    std::atomic<int> processed(0);
+    Pipeline pipeline(dummy_stages(&processed, 3, 0), 1);
+    TEST_ASSERT_EQUAL(3, pipeline.get_stage_num());
+
+    Item items[16];
+    int pushed = 0;
+    int popped = 0;
+    while (popped < 16) {
+        if (pushed < 16) {
+            items[pushed] = {pushed, {-1, -1, -1}, 0};
+            if (pipeline.push(&items[pushed], 0)) {
+                pushed++;
+                continue;
+            }
+        }
+        void *out = nullptr;
+        if (pipeline.pop(&out, pdMS_TO_TICKS(100))) {
+            Item *item = (Item *)out;
+            // the items come out in the order they were pushed, each processed by every stage in order
+            TEST_ASSERT_EQUAL(popped, item->id);
+            TEST_ASSERT_EQUAL(3, item->done);
+            for (int i = 0; i < 3; i++) {
+                TEST_ASSERT_EQUAL(i, item->stages[i]);
+            }
+            popped++;
+        }
+    }
+    TEST_ASSERT_EQUAL(48, processed.load());
+    for (int i = 0; i < 3; i++) {
+        dl::tool::pipeline_stats_t stats = pipeline.get_stats(i);
+        TEST_ASSERT_EQUAL(16, stats.count);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(stats.max, stats.min);
+    }
+    pipeline.reset_stats();
+    TEST_ASSERT_EQUAL(0, pipeline.get_stats(0).count);
+}
+
+TEST_CASE("pipeline finishes the pushed items when it is destroyed", "[pipeline]")
+{
+    std::atomic<int> processed(0);
+    std::vector<int> released;
+    Item items[4];
+    {
+        Pipeline pipeline(dummy_stages(&processed, 2, 5), 1, 5, [&released](void *arg) {
+            released.push_back(((Item *)arg)->id);
+        });
+        for (int i = 0; i < 4; i++) {
+            items[i] = {i, {-1, -1, -1}, 0};
+            TEST_ASSERT_TRUE(pipeline.push(&items[i]));
+        }
+        // none is popped, the destructor releases them once processed
+    }
+    TEST_ASSERT_EQUAL(8, processed.load());
+    TEST_ASSERT_EQUAL(4, released.size());
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(2, items[i].done);
+        TEST_ASSERT_EQUAL(i, released[i]);
+    }
+}
+
+TEST_CASE("pipeline without stages refuses the items", "[pipeline]")
+{
+    Pipeline pipeline({}, 1);
+    int item = 0;
+    void *out = nullptr;
+    TEST_ASSERT_FALSE(pipeline.push(&item, 0));
+    TEST_ASSERT_FALSE(pipeline.pop(&out, 0));
+}
@@ -0,0 +1,187 @@
+/*
+ * Tests of the weight prefetch, with Conv modules run as Model::run runs them
+ */
+
+#include <string.h>
+#include <vector>
+#include "unity.h"
+
+#include "dl_module_conv.hpp"
+#include "dl_weight_prefetcher.hpp"
+
+using namespace dl;
+
+namespace {
+
+// Copies when the copies are waited for, as a DMA which did not start before the wait
+class DeferredCopy : public WeightPrefetchBackend {
+public:
+    std::vector<void *> dst;
+    std::vector<const void *> src;
+    std::vector<size_t> size;
+    int waits = 0;
+
+    bool start(void *d, const void *s, size_t n)
+    {
+        dst.push_back(d);
+        src.push_back(s);
+        size.push_back(n);
+        return true;
+    }
+
+    bool done() { return dst.empty(); }
+
+    void wait()
+    {
+        for (int i = 0; i < dst.size(); i++) {
+            memcpy(dst[i], src[i], size[i]);
+        }
+        dst.clear();
+        src.clear();
+        size.clear();
+        waits++;
+    }
+};
+
+// A chain of 3x3 Convs of 16 channels on an 8x8 feature map
+struct ConvChain {
+    std::vector<TensorBase *> features;
+    std::vector<TensorBase *> filters;
+    std::vector<module::Conv *> convs;
+    ModelContext context;
+
+    ConvChain(int num)
+    {
+        for (int i = 0; i <= num; i++) {
+            features.push_back(new TensorBase({1, 8, 8, 16}, nullptr, -4, DATA_TYPE_INT8));
+        }
+        int8_t *input = (int8_t *)features[0]->get_element_ptr();
+        for (int i = 0; i < features[0]->get_size(); i++) {
+            input[i] = (i * 7) % 23 - 11;
+        }
+        for (int k = 0; k < num; k++) {
+            TensorBase *filter = new TensorBase({3, 3, 16, 16}, nullptr, -7, DATA_TYPE_INT8);
+            int8_t *weights = (int8_t *)filter->get_element_ptr();
+            for (int i = 0; i < filter->get_size(); i++) {
+                weights[i] = (i * (5 + k)) % 17 - 8;
+            }
+            filters.push_back(filter);
+            module::Conv *conv = new module::Conv(ReLU, {1, 1, 1, 1}, {1, 1}, {1, 1}, "conv", 1, QUANT_TYPE_SYMM_8BIT);
+            conv->m_inputs_index.push_back(context.push_back_tensor(features[k]));
+            conv->m_inputs_index.push_back(context.push_back_tensor(filter));
+            conv->m_outputs_index.push_back(context.push_back_tensor(features[k + 1]));
+            conv->prepare(&context, RUNTIME_MODE_SINGLE_CORE);
+            convs.push_back(conv);
+        }
+        context.reset_args_compute_count();
+    }
+
+    ~ConvChain()
+    {
+        for (module::Conv *conv : convs) {
+            delete conv;
+        }
+        for (TensorBase *tensor : filters) {
+            delete tensor;
+        }
+        for (TensorBase *tensor : features) {
+            delete tensor;
+        }
+    }
+
+    std::vector<uint8_t> run(WeightPrefetcher *prefetcher)
+    {
+        for (int i = 0; i < convs.size(); i++) {
+            memset(features[i + 1]->get_element_ptr(), 0x5a, features[i + 1]->get_bytes());
+        }
+        for (int i = 0; i < convs.size(); i++) {
+            if (prefetcher) {
+                prefetcher->before_module(i);
+            }
+            convs[i]->forward(&context, RUNTIME_MODE_SINGLE_CORE);
+            if (prefetcher) {
+                prefetcher->after_module(i);
+            }
+        }
+        uint8_t *output = (uint8_t *)features.back()->get_element_ptr();
+        return std::vector<uint8_t>(output, output + features.back()->get_bytes());
+    }
+};
+
+void add_modules(WeightPrefetcher &prefetcher, ConvChain &chain)
+{
+    for (int i = 0; i < chain.convs.size(); i++) {
+        TEST_ASSERT_TRUE(prefetcher.add_module(i, {chain.filters[i]}));
+    }
+    TEST_ASSERT_TRUE(prefetcher.allocate());
+}
+
+} // namespace
+
+TEST_CASE("weight prefetch with memcpy gives the outputs of the weights in place", "[weight_prefetch]")
+{
+    ConvChain chain(5);
+    std::vector<uint8_t> ref = chain.run(nullptr);
+    std::vector<void *> data;
+    for (TensorBase *filter : chain.filters) {
+        data.push_back(filter->data);
+    }
+
+    WeightPrefetcher prefetcher(new WeightPrefetchMemcpy());
+    add_modules(prefetcher, chain);
+    TEST_ASSERT_EQUAL(5, prefetcher.get_module_num());
+    TEST_ASSERT_EQUAL(16 * 16 * 9, prefetcher.get_buffer_size());
+
+    // the first run computes the args of each module for its buffer, the following runs reuse them
+    TEST_ASSERT_EQUAL_MEMORY(ref.data(), chain.run(&prefetcher).data(), ref.size());
+    TEST_ASSERT_EQUAL(5, chain.context.get_args_compute_count());
+    chain.context.reset_args_compute_count();
+    for (int r = 0; r < 3; r++) {
+        TEST_ASSERT_EQUAL_MEMORY(ref.data(), chain.run(&prefetcher).data(), ref.size());
+    }
+    TEST_ASSERT_EQUAL(0, chain.context.get_args_compute_count());
+
+    // the weights point to their data out of the forwards
+    for (int i = 0; i < chain.filters.size(); i++) {
+        TEST_ASSERT_EQUAL_PTR(data[i], chain.filters[i]->data);
+    }
+    weight_prefetch_stats_t stats = prefetcher.get_stats();
+    TEST_ASSERT_EQUAL(4, stats.runs);
+    // the last module of a run starts the copy for the first module of the next run
+    TEST_ASSERT_EQUAL(4 * 5 + 1, stats.copies);
+    TEST_ASSERT_EQUAL((4 * 5 + 1) * 16 * 16 * 9, stats.bytes);
+    // only the first module of the first run waits for its weights, the copies are done before the forwards
+    TEST_ASSERT_EQUAL(1, stats.stalls);
+}
+
+TEST_CASE("weight prefetch waits for the copies before the forwards", "[weight_prefetch]")
+{
+    ConvChain chain(4);
+    std::vector<uint8_t> ref = chain.run(nullptr);
+
+    DeferredCopy *backend = new DeferredCopy();
+    WeightPrefetcher prefetcher(backend);
+    add_modules(prefetcher, chain);
+    for (int r = 0; r < 3; r++) {
+        TEST_ASSERT_EQUAL_MEMORY(ref.data(), chain.run(&prefetcher).data(), ref.size());
+    }
+    // each module waits for the copy started by the module before it, the first one by the last module of the run
+    // before it
+    TEST_ASSERT_EQUAL(3 * 4, backend->waits);
+    TEST_ASSERT_EQUAL(3 * 4, prefetcher.get_stats().stalls);
+    prefetcher.sync();
+    TEST_ASSERT_TRUE(backend->done());
+}
+
+TEST_CASE("weight prefetch keeps the weights of two modules in the buffers", "[weight_prefetch]")
+{
+    ConvChain chain(2);
+    std::vector<uint8_t> ref = chain.run(nullptr);
+
+    WeightPrefetcher prefetcher(new WeightPrefetchMemcpy());
+    add_modules(prefetcher, chain);
+    for (int r = 0; r < 3; r++) {
+        TEST_ASSERT_EQUAL_MEMORY(ref.data(), chain.run(&prefetcher).data(), ref.size());
+    }
+    TEST_ASSERT_EQUAL(2, prefetcher.get_stats().copies);
+}
@@ -0,0 +1,118 @@
+#include "dl_module_conv.hpp"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measure the latency of the Conv module forward with the operation args computed at build, against the forward which
+// computes them with base::get_conv_operation_args on every call, as the module did before. The kernels are the C
+// reference ones of the host, so the args are a larger share of the latency on the chip.
+//
+// ARGS_RUNS  number of forwards for each measure, default 1000
+
+using namespace dl;
+
+typedef struct {
+    const char *name;
+    int height;
+    int width;
+    int in_channels;
+    int out_channels;
+    int kernel;
+    int stride;
+    int group;
+} conv_case_t;
+
+static const conv_case_t s_cases[] = {
+    {"1x1 7x7x256", 7, 7, 256, 256, 1, 1, 1},
+    {"3x3 14x14x64", 14, 14, 64, 64, 3, 1, 1},
+    {"3x3/2 28x28x32", 28, 28, 32, 64, 3, 2, 1},
+    {"dw 3x3 28x28x64", 28, 28, 64, 64, 3, 1, 64},
+    {"dw 3x3 7x7x256", 7, 7, 256, 256, 3, 1, 256},
+};
+
+static void fill(TensorBase &tensor, int seed)
+{
+    int8_t *data = (int8_t *)tensor.get_element_ptr();
+    for (int i = 0; i < tensor.get_size(); i++) {
+        data[i] = (i * seed) % 23 - 11;
+    }
+}
+
+static int get_env(const char *name, int value)
+{
+    const char *str = getenv(name);
+    return str ? atoi(str) : value;
+}
+
+extern "C" void app_main(void)
+{
+    int run_num = get_env("ARGS_RUNS", 1000);
+    const runtime_mode_t mode = RUNTIME_MODE_SINGLE_CORE;
+
+    printf("int8, single core, %d runs\n", run_num);
+    printf("| conv            | per forward us | prepared us | args us | args computed | same output |\n");
+    for (const conv_case_t &c : s_cases) {
+        int pad = c.kernel / 2;
+        int out_height = (c.height + 2 * pad - c.kernel) / c.stride + 1;
+        int out_width = (c.width + 2 * pad - c.kernel) / c.stride + 1;
+        std::vector<int> filter_shape = {c.kernel, c.kernel, c.in_channels / c.group, c.out_channels};
+        if (c.group != 1) {
+            filter_shape = {c.kernel, c.kernel, c.in_channels, 1};
+        }
+        TensorBase input({1, c.height, c.width, c.in_channels}, nullptr, -4, DATA_TYPE_INT8);
+        TensorBase filter(filter_shape, nullptr, -6, DATA_TYPE_INT8);
+        TensorBase output({1, out_height, out_width, c.out_channels}, nullptr, -3, DATA_TYPE_INT8);
+        fill(input, 7);
+        fill(filter, 5);
+
+        std::vector<int> pads = {pad, pad, pad, pad};
+        std::vector<int> strides = {c.stride, c.stride};
+        std::vector<int> dilations = {1, 1};
+        module::Conv conv(ReLU, pads, dilations, strides, c.name, c.group, QUANT_TYPE_SYMM_8BIT);
+        ModelContext context;
+        conv.m_inputs_index.push_back(context.push_back_tensor(&input));
+        conv.m_inputs_index.push_back(context.push_back_tensor(&filter));
+        conv.m_outputs_index.push_back(context.push_back_tensor(&output));
+
+        // the forward before the args store: the args of every forward are computed and allocated
+        int64_t start = esp_timer_get_time();
+        for (int r = 0; r < run_num; r++) {
+            std::vector<base::ArgsType<int8_t>> args = base::get_conv_operation_args<int8_t>(
+                &output, &input, pads, &filter, strides, dilations, c.group, nullptr, ReLU, nullptr, mode);
+            conv.forward_args(&args[0]);
+        }
+        float per_forward = (float)(esp_timer_get_time() - start) / run_num;
+        std::vector<int8_t> ref((int8_t *)output.get_element_ptr(),
+                                (int8_t *)output.get_element_ptr() + output.get_size());
+
+        // the args alone, an item of them is summed for the compiler to keep them
+        volatile int sink = 0;
+        start = esp_timer_get_time();
+        for (int r = 0; r < run_num; r++) {
+            std::vector<base::ArgsType<int8_t>> args = base::get_conv_operation_args<int8_t>(
+                &output, &input, pads, &filter, strides, dilations, c.group, nullptr, ReLU, nullptr, mode);
+            sink = sink + args[0].output_height;
+        }
+        float args = (float)(esp_timer_get_time() - start) / run_num;
+
+        // the forward of a built model: prepare computes the args once
+        memset(output.get_element_ptr(), 0, output.get_bytes());
+        conv.prepare(&context, mode);
+        context.reset_args_compute_count();
+        start = esp_timer_get_time();
+        for (int r = 0; r < run_num; r++) {
+            conv.forward(&context, mode);
+        }
+        float prepared = (float)(esp_timer_get_time() - start) / run_num;
+        bool same = memcmp(ref.data(), output.get_element_ptr(), output.get_bytes()) == 0;
+
+        printf("| %-15s | %14.2f | %11.2f | %7.2f | %13d | %11s |\n",
+               c.name,
+               per_forward,
+               prepared,
+               args,
+               (int)context.get_args_compute_count(),
+               same ? "yes" : "no");
+    }
+    exit(0);
+}
@@ -0,0 +1,99 @@
+#include "dl_recognition_database.hpp"
+#include "esp_timer.h"
+#include <math.h>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+// Measure the query latency of the face database for each type of feature, at 100, 1k and 10k enrolled faces.
+//
+// DB_FEAT_LEN  number of elements of a feature, default 512
+// DB_QUERIES   number of queries for each measure, default 100
+// DB_PATH      path of the database file, default /tmp/dl_db_benchmark.db
+
+static const int s_nums[] = {100, 1000, 10000};
+static const dl::dtype_t s_dtypes[] = {dl::DATA_TYPE_FLOAT, dl::DATA_TYPE_INT16, dl::DATA_TYPE_INT8};
+
+static std::mt19937 s_rng(0);
+
+static void random_feat(dl::TensorBase *feat)
+{
+    std::normal_distribution<float> dist;
+    float *ptr = (float *)feat->data;
+    float norm = 0;
+    for (int i = 0; i < feat->size; i++) {
+        ptr[i] = dist(s_rng);
+        norm += ptr[i] * ptr[i];
+    }
+    norm = sqrtf(norm);
+    for (int i = 0; i < feat->size; i++) {
+        ptr[i] /= norm;
+    }
+}
+
+static int get_env(const char *name, int value)
+{
+    const char *str = getenv(name);
+    return str ? atoi(str) : value;
+}
+
+extern "C" void app_main(void)
+{
+    int feat_len = get_env("DB_FEAT_LEN", 512);
+    int query_num = get_env("DB_QUERIES", 100);
+    const char *path = getenv("DB_PATH") ? getenv("DB_PATH") : "/tmp/dl_db_benchmark.db";
+
+    dl::TensorBase feat({1, feat_len}, nullptr, 0, dl::DATA_TYPE_FLOAT);
+    std::vector<dl::TensorBase *> queries;
+    for (int i = 0; i < query_num; i++) {
+        queries.push_back(new dl::TensorBase({1, feat_len}, nullptr, 0, dl::DATA_TYPE_FLOAT));
+        random_feat(queries.back());
+    }
+
+    printf("feat_len: %d, %d queries, top 5\n", feat_len, query_num);
+    printf("| faces | dtype   | matrix KB | query us | max sim err |\n");
+    for (int n : s_nums) {
+        // the file keeps float features, it is enrolled once and loaded in each type
+        unlink(path);
+        {
+            dl::recognition::DataBase db(path, feat_len);
+            for (int i = 0; i < n; i++) {
+                random_feat(&feat);
+                db.enroll_feat(&feat);
+            }
+        }
+
+        std::vector<std::vector<dl::recognition::result_t>> refs;
+        for (dl::dtype_t dtype : s_dtypes) {
+            dl::recognition::DataBase db(path, feat_len, dtype);
+            float max_err = 0;
+            int64_t start = esp_timer_get_time();
+            for (int i = 0; i < query_num; i++) {
+                std::vector<dl::recognition::result_t> results = db.query_feat(queries[i], -1, 5);
+                if (dtype == dl::DATA_TYPE_FLOAT) {
+                    refs.push_back(results);
+                } else {
+                    for (int j = 0; j < results.size() && j < refs[i].size(); j++) {
+                        max_err = std::max(max_err, fabsf(results[j].similarity - refs[i][j].similarity));
+                    }
+                }
+            }
+            int64_t latency = (esp_timer_get_time() - start) / query_num;
+            int row_size = (feat_len + DL_DATABASE_ALIGN - 1) / DL_DATABASE_ALIGN * DL_DATABASE_ALIGN *
+                dl::dtype_sizeof(dtype);
+            printf("| %5d | %-7s | %9.1f | %8d | %11.2e |\n",
+                   n,
+                   dl::dtype_to_string(dtype),
+                   n * row_size / 1024.f,
+                   (int)latency,
+                   max_err);
+        }
+    }
+
+    for (int i = 0; i < query_num; i++) {
+        delete queries[i];
+    }
+    unlink(path);
+    exit(0);
+}
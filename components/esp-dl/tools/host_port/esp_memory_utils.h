@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+
+// The host has one memory, seen as internal RAM
+static inline bool esp_ptr_internal(const void *p)
+{
+    return true;
+}
+
+static inline bool esp_ptr_external_ram(const void *p)
+{
+    return false;
+}
+
+static inline bool esp_ptr_in_drom(const void *p)
+{
+    return false;
+}
+
+static inline bool esp_ptr_in_tcm(const void *p)
+{
+    return false;
+}
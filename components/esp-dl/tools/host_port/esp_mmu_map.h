@@ -0,0 +1,3 @@
+#pragma once
+
+// No MMU on the host, nothing of it is used without CONFIG_SPIRAM_RODATA
@@ -0,0 +1,171 @@
+#if !DL_NO_FBS_MODEL
+#include "dl_model_base.hpp"
+#endif
+#include "dl_memory_manager_best_fit.hpp"
+#include "dl_memory_manager_greedy.hpp"
+#include <algorithm>
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Compare the tensor memory plans of the memory managers for a .espdl model or a tensor list, as the chip would plan
+// them.
+//
+// ESPDL_MODEL        path of the .espdl model, needs the linux build of the fbs_model library
+// ESPDL_TENSORS      path of a tensor list, a "name begin end bytes [access_bytes]" line per tensor, '#' starts a
+//                    comment. The tensor lives from node begin until node end, -1 for the end of the model.
+// ESPDL_INTERNAL_KB  comma separated internal RAM budgets, in KB, default 0,64,128,256,512
+
+static const char *s_manager_names[] = {"greedy", "best fit"};
+
+static std::vector<size_t> parse_budgets(const char *str)
+{
+    std::vector<size_t> budgets;
+    if (!str) {
+        str = "0,64,128,256,512";
+    }
+    std::string budget;
+    for (const char *p = str;; p++) {
+        if (*p == ',' || *p == '\0') {
+            if (!budget.empty()) {
+                budgets.push_back(strtoul(budget.c_str(), nullptr, 10) * 1024);
+            }
+            budget.clear();
+            if (*p == '\0') {
+                break;
+            }
+        } else {
+            budget.push_back(*p);
+        }
+    }
+    return budgets;
+}
+
+static void print_plan(const char *psram, size_t budget, const char *manager, const dl::memory_plan_t &plan)
+{
+    size_t access_bytes = plan.internal_access_bytes + plan.psram_access_bytes;
+    printf("| %-5s | %9.2f | %-8s | %11.2f | %8.2f | %7d/%-4d | %8.1f%% | %12.2f |\n",
+           psram,
+           budget / 1024.f,
+           manager,
+           plan.internal_size / 1024.f,
+           plan.psram_size / 1024.f,
+           plan.internal_tensor_num,
+           plan.tensor_num,
+           access_bytes ? plan.internal_access_bytes * 100.f / access_bytes : 0.f,
+           plan.psram_access_bytes / 1024.f);
+}
+
+// The tensors of the list, new ones for each plan as the managers place them
+static bool load_tensors(const char *path, std::vector<dl::TensorInfo *> &tensors, int &node_num)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        return false;
+    }
+    node_num = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        char name[128];
+        int begin, end;
+        unsigned long bytes, access_bytes;
+        int n = sscanf(line, "%127s %d %d %lu %lu", name, &begin, &end, &bytes, &access_bytes);
+        if (n < 4) {
+            printf("Invalid tensor: %s", line);
+            fclose(f);
+            return false;
+        }
+        // a tensor is written once and read once by default
+        if (n == 4) {
+            access_bytes = 2 * bytes;
+        }
+        std::string tensor_name = name;
+        tensors.push_back(new dl::TensorInfo(tensor_name, begin, end, {(int)bytes}, dl::DATA_TYPE_UINT8, 0));
+        tensors.back()->add_access_bytes(access_bytes);
+        node_num = std::max(node_num, std::max(begin, end) + 1);
+    }
+    fclose(f);
+    return true;
+}
+
+static dl::memory_plan_t plan_tensors(const char *path, size_t budget, int manager, bool psram)
+{
+    std::vector<dl::TensorInfo *> tensors;
+    int node_num;
+    if (!load_tensors(path, tensors, node_num)) {
+        exit(1);
+    }
+    dl::MemoryManagerBase *memory_manager;
+    if (manager == 0) {
+        memory_manager = new dl::MemoryManagerGreedy(budget);
+    } else {
+        memory_manager = new dl::MemoryManagerBestFit(budget);
+    }
+    memory_manager->plan(tensors, node_num, psram);
+    dl::memory_plan_t plan = memory_manager->get_plan_info();
+    delete memory_manager;
+    for (dl::TensorInfo *tensor : tensors) {
+        delete tensor;
+    }
+    return plan;
+}
+
+extern "C" void app_main(void)
+{
+    const char *model_path = getenv("ESPDL_MODEL");
+    const char *tensors_path = getenv("ESPDL_TENSORS");
+    if (!model_path && !tensors_path) {
+        printf("usage: ESPDL_MODEL=<model.espdl> | ESPDL_TENSORS=<tensors.txt> [ESPDL_INTERNAL_KB=0,64,128] "
+               "build/dl_memory_planner.elf\n");
+        exit(1);
+    }
+    std::vector<size_t> budgets = parse_budgets(getenv("ESPDL_INTERNAL_KB"));
+
+    std::function<dl::memory_plan_t(size_t, int, bool)> plan_memory;
+#if !DL_NO_FBS_MODEL
+    static const dl::memory_manager_t s_managers[] = {dl::MEMORY_MANAGER_GREEDY, dl::MEMORY_MANAGER_BEST_FIT};
+    dl::Model *model = nullptr;
+    if (model_path) {
+        model = new dl::Model(model_path, fbs::MODEL_LOCATION_IN_SDCARD);
+        if (!model->get_fbs_model()) {
+            printf("Failed to load %s\n", model_path);
+            exit(1);
+        }
+        plan_memory = [model](size_t budget, int manager, bool psram) {
+            return model->plan_memory(budget, s_managers[manager], psram);
+        };
+    }
+#else
+    if (model_path) {
+        printf("Built without the fbs_model library, only ESPDL_TENSORS is supported\n");
+        exit(1);
+    }
+#endif
+    if (!model_path) {
+        plan_memory = [tensors_path](size_t budget, int manager, bool psram) {
+            return plan_tensors(tensors_path, budget, manager, psram);
+        };
+    }
+
+    printf("model: %s\n", model_path ? model_path : tensors_path);
+    printf("| psram | budget KB | manager  | internal KB | PSRAM KB | int. tensors | int. acc. | PSRAM acc KB |\n");
+    for (int i = 0; i < 2; i++) {
+        print_plan("no", 0, s_manager_names[i], plan_memory(0, i, false));
+    }
+    for (int j = 0; j < budgets.size(); j++) {
+        for (int i = 0; i < 2; i++) {
+            print_plan("yes", budgets[j], s_manager_names[i], plan_memory(budgets[j], i, true));
+        }
+    }
+
+#if !DL_NO_FBS_MODEL
+    delete model;
+#endif
+    exit(0);
+}
@@ -0,0 +1,156 @@
+#include "dl_module_add.hpp"
+#include "dl_module_average_pool.hpp"
+#include "dl_module_clip.hpp"
+#include "dl_module_concat.hpp"
+#include "dl_module_conv.hpp"
+#include "dl_module_div.hpp"
+#include "dl_module_elu.hpp"
+#include "dl_module_equal.hpp"
+#include "dl_module_exp.hpp"
+#include "dl_module_flatten.hpp"
+#include "dl_module_gather.hpp"
+#include "dl_module_gemm.hpp"
+#include "dl_module_global_average_pool.hpp"
+#include "dl_module_greater.hpp"
+#include "dl_module_greater_or_equal.hpp"
+#include "dl_module_gru.hpp"
+#include "dl_module_hard_sigmoid.hpp"
+#include "dl_module_hard_swish.hpp"
+#include "dl_module_identity.hpp"
+#include "dl_module_leaky_relu.hpp"
+#include "dl_module_less.hpp"
+#include "dl_module_less_or_equal.hpp"
+#include "dl_module_log.hpp"
+#include "dl_module_lstm.hpp"
+#include "dl_module_lut.hpp"
+#include "dl_module_matmul.hpp"
+#include "dl_module_max_pool.hpp"
+#include "dl_module_mul.hpp"
+#include "dl_module_neg.hpp"
+#include "dl_module_pad.hpp"
+#include "dl_module_pow.hpp"
+#include "dl_module_prelu.hpp"
+#include "dl_module_reduce_l1.hpp"
+#include "dl_module_reduce_l2.hpp"
+#include "dl_module_reduce_log_sum.hpp"
+#include "dl_module_reduce_log_sum_exp.hpp"
+#include "dl_module_reduce_max.hpp"
+#include "dl_module_reduce_mean.hpp"
+#include "dl_module_reduce_min.hpp"
+#include "dl_module_reduce_prod.hpp"
+#include "dl_module_reduce_sum.hpp"
+#include "dl_module_reduce_sum_square.hpp"
+#include "dl_module_relu.hpp"
+#include "dl_module_requantize_linear.hpp"
+#include "dl_module_reshape.hpp"
+#include "dl_module_resize.hpp"
+#include "dl_module_reverse_sequence.hpp"
+#include "dl_module_sigmoid.hpp"
+#include "dl_module_slice.hpp"
+#include "dl_module_softmax.hpp"
+#include "dl_module_split.hpp"
+#include "dl_module_sqrt.hpp"
+#include "dl_module_squeeze.hpp"
+#include "dl_module_sub.hpp"
+#include "dl_module_swish.hpp"
+#include "dl_module_tanh.hpp"
+#include "dl_module_transpose.hpp"
+#include "dl_module_unsqueeze.hpp"
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+// Print the operators of ModuleCreator::register_dl_modules as a markdown table, with whether their module runs on
+// both cores in RUNTIME_MODE_MULTI_CORE, as reported by Module::support_multi_core(). The table of the README is the
+// output of this tool. The modules are created with their default attributes, support_multi_core() does not depend on
+// them.
+
+using namespace dl;
+using namespace dl::module;
+
+typedef struct {
+    const char *op_type;
+    const char *module;
+    std::function<Module *()> create;
+} op_t;
+
+static const std::vector<op_t> s_ops = {
+    {"Add", "Add", [] { return new Add(); }},
+    {"AveragePool", "AveragePool", [] { return new AveragePool(); }},
+    {"Clip", "Clip", [] { return new Clip(); }},
+    {"Concat", "Concat", [] { return new Concat(); }},
+    {"Conv", "Conv", [] { return new Conv(); }},
+    {"DequantizeLinear", "RequantizeLinear", [] { return new RequantizeLinear(); }},
+    {"Div", "Div", [] { return new Div(); }},
+    {"Elu", "Elu", [] { return new Elu(); }},
+    {"Equal", "Equal", [] { return new Equal(); }},
+    {"Exp", "Exp", [] { return new Exp(); }},
+    {"Flatten", "Flatten", [] { return new Flatten(1); }},
+    {"GRU", "GRU", [] { return new GRU(); }},
+    {"Gather", "Gather", [] { return new Gather(nullptr); }},
+    {"Gelu", "LUT", [] { return new LUT(); }},
+    {"Gemm", "Gemm", [] { return new Gemm(); }},
+    {"GlobalAveragePool", "GlobalAveragePool", [] { return new GlobalAveragePool(); }},
+    {"Greater", "Greater", [] { return new Greater(); }},
+    {"GreaterOrEqual", "GreaterOrEqual", [] { return new GreaterOrEqual(); }},
+    {"HardSigmoid", "HardSigmoid", [] { return new HardSigmoid(); }},
+    {"HardSwish", "HardSwish", [] { return new HardSwish(); }},
+    {"Identity", "Identity", [] { return new Identity(); }},
+    {"LSTM", "LSTM", [] { return new LSTM(); }},
+    {"LUT", "LUT", [] { return new LUT(); }},
+    {"LeakyRelu", "LeakyRelu", [] { return new LeakyRelu(); }},
+    {"Less", "Less", [] { return new Less(); }},
+    {"LessOrEqual", "LessOrEqual", [] { return new LessOrEqual(); }},
+    {"Log", "Log", [] { return new Log(); }},
+    {"MatMul", "MatMul", [] { return new MatMul(); }},
+    {"MaxPool", "MaxPool", [] { return new MaxPool(); }},
+    {"Mul", "Mul", [] { return new Mul(); }},
+    {"Neg", "Neg", [] { return new Neg(); }},
+    {"PRelu", "PRelu", [] { return new PRelu(); }},
+    {"Pad", "Pad", [] { return new Pad({}); }},
+    {"Pow", "Pow", [] { return new Pow(); }},
+    {"QuantizeLinear", "RequantizeLinear", [] { return new RequantizeLinear(); }},
+    {"ReduceL1", "ReduceL1", [] { return new ReduceL1(0, {}, "ReduceL1"); }},
+    {"ReduceL2", "ReduceL2", [] { return new ReduceL2(0, {}, "ReduceL2"); }},
+    {"ReduceLogSum", "ReduceLogSum", [] { return new ReduceLogSum(0, {}, "ReduceLogSum"); }},
+    {"ReduceLogSumExp", "ReduceLogSumExp", [] { return new ReduceLogSumExp(0, {}, "ReduceLogSumExp"); }},
+    {"ReduceMax", "ReduceMax", [] { return new ReduceMax(0, {}, "ReduceMax"); }},
+    {"ReduceMean", "ReduceMean", [] { return new ReduceMean(0, {}, "ReduceMean"); }},
+    {"ReduceMin", "ReduceMin", [] { return new ReduceMin(0, {}, "ReduceMin"); }},
+    {"ReduceProd", "ReduceProd", [] { return new ReduceProd(0, {}, "ReduceProd"); }},
+    {"ReduceSum", "ReduceSum", [] { return new ReduceSum(0, {}, "ReduceSum"); }},
+    {"ReduceSumSquare", "ReduceSumSquare", [] { return new ReduceSumSquare(0, {}, "ReduceSumSquare"); }},
+    {"Relu", "Relu", [] { return new Relu(); }},
+    {"RequantizeLinear", "RequantizeLinear", [] { return new RequantizeLinear(); }},
+    {"Reshape", "Reshape", [] { return new Reshape(nullptr); }},
+    {"Resize", "Resize", [] { return new Resize(); }},
+    {"ReverseSequence", "ReverseSequence", [] { return new ReverseSequence(1, 0); }},
+    {"Sigmoid", "Sigmoid", [] { return new Sigmoid(); }},
+    {"Slice", "Slice", [] { return new Slice({}, {}); }},
+    {"Softmax", "Softmax", [] { return new Softmax(); }},
+    {"Split", "Split", [] { return new Split(nullptr); }},
+    {"Sqrt", "Sqrt", [] { return new Sqrt(); }},
+    {"Squeeze", "Squeeze", [] { return new Squeeze(nullptr); }},
+    {"Sub", "Sub", [] { return new Sub(); }},
+    {"Swish", "Swish", [] { return new Swish(); }},
+    {"Tanh", "Tanh", [] { return new Tanh(); }},
+    {"Transpose", "Transpose", [] { return new Transpose(); }},
+    {"Unsqueeze", "Unsqueeze", [] { return new Unsqueeze(nullptr); }},
+};
+
+extern "C" void app_main(void)
+{
+    int multi_core_num = 0;
+    printf("| operator          | module            | dual core |\n");
+    printf("| ----------------- | ----------------- | --------- |\n");
+    for (const op_t &op : s_ops) {
+        Module *module = op.create();
+        bool multi_core = module->support_multi_core();
+        multi_core_num += multi_core;
+        printf("| %-17s | %-17s | %-9s |\n", op.op_type, op.module, multi_core ? "yes" : "no");
+        delete module;
+    }
+    printf("\n%d of %d operators run on both cores.\n", multi_core_num, (int)s_ops.size());
+    exit(0);
+}
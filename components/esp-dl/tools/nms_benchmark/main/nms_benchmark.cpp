@@ -0,0 +1,156 @@
+#include "dl_detect_nms.hpp"
+#include "esp_timer.h"
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Measure the latency of the NMS of the detect postprocessors, with synthetic candidates: NMS_OBJECTS objects in a
+// 640x640 image, each detected by several shifted boxes of random score.
+//
+// NMS_OBJECTS  number of objects, default 20
+// NMS_RUNS     number of runs for each measure, default 100
+
+static const int s_nums[] = {100, 500, 2000};
+
+static std::mt19937 s_rng(0);
+
+typedef struct {
+    int category;
+    float score;
+    int box[4];
+} candidate_t;
+
+static std::vector<candidate_t> random_candidates(int num, int object_num)
+{
+    std::uniform_int_distribution<int> pos(0, 560);
+    std::uniform_int_distribution<int> size(16, 80);
+    std::uniform_int_distribution<int> category(0, 2);
+    std::normal_distribution<float> shift(0, 4);
+    std::uniform_real_distribution<float> score(0.25, 1);
+
+    std::vector<candidate_t> objects(object_num);
+    for (candidate_t &object : objects) {
+        object.category = category(s_rng);
+        object.box[0] = pos(s_rng);
+        object.box[1] = pos(s_rng);
+        object.box[2] = object.box[0] + size(s_rng);
+        object.box[3] = object.box[1] + size(s_rng);
+    }
+    std::vector<candidate_t> candidates(num);
+    for (int i = 0; i < num; i++) {
+        candidates[i] = objects[i % object_num];
+        candidates[i].score = score(s_rng);
+        for (int j = 0; j < 4; j++) {
+            candidates[i].box[j] += (int)shift(s_rng);
+        }
+    }
+    return candidates;
+}
+
+// The NMS of the postprocessors before the candidate buffer, on a list sorted by score, as a reference
+static void list_nms(std::list<dl::detect::result_t> &box_list, float nms_thr, int top_k)
+{
+    int kept_number = 0;
+    for (auto kept = box_list.begin(); kept != box_list.end(); kept++) {
+        kept_number++;
+        if (kept_number >= top_k) {
+            box_list.erase(++kept, box_list.end());
+            break;
+        }
+        int kept_area = (kept->box[2] - kept->box[0] + 1) * (kept->box[3] - kept->box[1] + 1);
+        auto other = kept;
+        other++;
+        for (; other != box_list.end();) {
+            int inter_width = DL_MIN(kept->box[2], other->box[2]) - DL_MAX(kept->box[0], other->box[0]) + 1;
+            int inter_height = DL_MIN(kept->box[3], other->box[3]) - DL_MAX(kept->box[1], other->box[1]) + 1;
+            if (inter_height > 0 && inter_width > 0) {
+                int other_area = (other->box[2] - other->box[0] + 1) * (other->box[3] - other->box[1] + 1);
+                int inter_area = inter_height * inter_width;
+                float iou = (float)inter_area / (kept_area + other_area - inter_area);
+                if (iou > nms_thr) {
+                    other = box_list.erase(other);
+                    continue;
+                }
+            }
+            other++;
+        }
+    }
+}
+
+static int get_env(const char *name, int value)
+{
+    const char *str = getenv(name);
+    return str ? atoi(str) : value;
+}
+
+extern "C" void app_main(void)
+{
+    int object_num = get_env("NMS_OBJECTS", 20);
+    int run_num = get_env("NMS_RUNS", 100);
+    const float nms_thr = 0.5;
+    const float score_thr = 0.25;
+    const int top_k = 100;
+
+    static const struct {
+        const char *name;
+        dl::detect::nms_type_t type;
+        bool class_aware;
+    } s_methods[] = {
+        {"greedy", dl::detect::NMS_GREEDY, false},
+        {"greedy cls", dl::detect::NMS_GREEDY, true},
+        {"fast", dl::detect::NMS_FAST, false},
+        {"matrix", dl::detect::NMS_MATRIX, false},
+    };
+
+    printf("%d objects, nms_thr %.2f, top %d, %d runs\n", object_num, nms_thr, top_k, run_num);
+    printf("| candidates | method     | boxes | nms us | same as list |\n");
+    dl::detect::CandidateBuffer buffer;
+    std::list<dl::detect::result_t> results;
+    for (int n : s_nums) {
+        std::vector<candidate_t> candidates = random_candidates(n, object_num);
+
+        // the reference: the sorted insertion of the postprocessors and the list NMS
+        std::list<dl::detect::result_t> ref;
+        int64_t start = esp_timer_get_time();
+        for (int r = 0; r < run_num; r++) {
+            ref.clear();
+            for (candidate_t &c : candidates) {
+                dl::detect::result_t res = {
+                    c.category, c.score, {c.box[0], c.box[1], c.box[2], c.box[3]}, {}};
+                ref.insert(std::upper_bound(ref.begin(), ref.end(), res, dl::detect::greater_box), res);
+            }
+            list_nms(ref, nms_thr, top_k);
+        }
+        int64_t latency = (esp_timer_get_time() - start) / run_num;
+        printf("| %10d | %-10s | %5d | %6d | %12s |\n", n, "list", (int)ref.size(), (int)latency, "-");
+
+        for (auto &method : s_methods) {
+            start = esp_timer_get_time();
+            for (int r = 0; r < run_num; r++) {
+                // the buffer keeps its memory from run to run, as from frame to frame
+                buffer.clear();
+                results.clear();
+                for (candidate_t &c : candidates) {
+                    buffer.add(c.category, c.score, c.box[0], c.box[1], c.box[2], c.box[3]);
+                }
+                buffer.nms(method.type, method.class_aware, nms_thr, score_thr, top_k, results);
+            }
+            latency = (esp_timer_get_time() - start) / run_num;
+
+            const char *same = "-";
+            if (method.type == dl::detect::NMS_GREEDY && !method.class_aware) {
+                same = results.size() == ref.size() &&
+                        std::equal(results.begin(),
+                                   results.end(),
+                                   ref.begin(),
+                                   [](const dl::detect::result_t &a, const dl::detect::result_t &b) {
+                                       return a.score == b.score && a.box == b.box;
+                                   })
+                    ? "yes"
+                    : "no";
+            }
+            printf("| %10d | %-10s | %5d | %6d | %12s |\n", n, method.name, (int)results.size(), (int)latency, same);
+        }
+    }
+    exit(0);
+}
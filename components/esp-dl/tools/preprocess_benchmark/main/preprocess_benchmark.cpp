@@ -0,0 +1,95 @@
+#include "dl_image_process.hpp"
+#include "esp_timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Measure the throughput of the ImageTransformer path of ImagePreprocessor, which resizes, converts and quantizes an
+// RGB565 camera frame into the int8 model input in one pass, against the path which resizes to RGB888 before the
+// quantization. The kernels are the C reference ones of the host, the ESP32-P4 runs the PIE ones.
+//
+// PREPROCESS_RUNS  number of transforms for each measure, default 200
+
+using namespace dl;
+using namespace dl::image;
+
+typedef struct {
+    const char *name;
+    int src_width;
+    int src_height;
+    int width;
+    int height;
+} preprocess_case_t;
+
+static const preprocess_case_t s_cases[] = {
+    {"720p to 320x240", 1280, 720, 320, 240},
+    {"720p to 640x640", 1280, 720, 640, 640},
+    {"vga to 224x224", 640, 480, 224, 224},
+    {"vga to 160x120", 640, 480, 160, 120},
+};
+
+static int get_env(const char *name, int value)
+{
+    const char *str = getenv(name);
+    return str ? atoi(str) : value;
+}
+
+template <typename Func>
+static float measure(int run_num, Func func)
+{
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < run_num; r++) {
+        func();
+    }
+    return (float)(esp_timer_get_time() - start) / run_num;
+}
+
+extern "C" void app_main(void)
+{
+    int run_num = get_env("PREPROCESS_RUNS", 200);
+    const std::vector<float> mean = {123.675, 116.28, 103.53};
+    const std::vector<float> std = {58.395, 57.12, 57.375};
+
+    printf("RGB565 to int8 RGB888, %d runs\n", run_num);
+    printf("| case            | fused us | fused Mpix/s | two step us | two step Mpix/s | same output |\n");
+    for (const preprocess_case_t &c : s_cases) {
+        uint16_t *frame = (uint16_t *)malloc(c.src_width * c.src_height * sizeof(uint16_t));
+        for (int i = 0; i < c.src_width * c.src_height; i++) {
+            frame[i] = i * 2654435761u >> 16;
+        }
+        img_t src = {frame, (uint16_t)c.src_width, (uint16_t)c.src_height, DL_IMAGE_PIX_TYPE_RGB565};
+        std::vector<int8_t> fused(c.width * c.height * 3);
+        std::vector<int8_t> two_step(c.width * c.height * 3);
+        std::vector<uint8_t> rgb(c.width * c.height * 3);
+
+        ImageTransformer transformer;
+        transformer.set_src_img(src)
+            .set_dst_img({fused.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888_QINT8})
+            .set_norm_quant_param(mean, std, -7, NormQuantWrapper::INT8_QUANT);
+        ImageTransformer resize;
+        resize.set_src_img(src).set_dst_img(
+            {rgb.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888});
+        ImageTransformer quant;
+        quant.set_src_img({rgb.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888})
+            .set_dst_img({two_step.data(), (uint16_t)c.width, (uint16_t)c.height, DL_IMAGE_PIX_TYPE_RGB888_QINT8})
+            .set_norm_quant_param(mean, std, -7, NormQuantWrapper::INT8_QUANT);
+
+        float fused_us = measure(run_num, [&] { transformer.transform(); });
+        float two_step_us = measure(run_num, [&] {
+            resize.transform();
+            quant.transform();
+        });
+        bool same = memcmp(fused.data(), two_step.data(), fused.size()) == 0;
+        float pix = c.width * c.height;
+
+        printf("| %-15s | %8.1f | %12.1f | %11.1f | %15.1f | %11s |\n",
+               c.name,
+               fused_us,
+               pix / fused_us,
+               two_step_us,
+               pix / two_step_us,
+               same ? "yes" : "no");
+        free(frame);
+    }
+    exit(0);
+}
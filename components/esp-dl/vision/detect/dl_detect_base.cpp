@@ -37,6 +37,17 @@ Detect &DetectWrapper::set_nms_thr(float nms_thr, int idx)
     return *this;
 }
 
+Detect &DetectWrapper::set_nms_type(nms_type_t nms_type, bool class_aware, int idx)
+{
+    assert(idx == 0 || idx == 1);
+    // the type is set on the postprocessor, which is created with the model
+    if (!m_model) {
+        load_model();
+    }
+    m_model->set_nms_type(nms_type, class_aware, idx);
+    return *this;
+}
+
 dl::Model *DetectWrapper::get_raw_model(int idx)
 {
     assert(idx == 0 || idx == 1);
@@ -85,6 +96,12 @@ Detect &DetectImpl::set_nms_thr(float nms_thr, int idx)
     return *this;
 }
 
+Detect &DetectImpl::set_nms_type(nms_type_t nms_type, bool class_aware, int idx)
+{
+    m_postprocessor->set_nms_type(nms_type, class_aware);
+    return *this;
+}
+
 dl::Model *DetectImpl::get_raw_model(int idx)
 {
     return m_model;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dl_detect_postprocessor.hpp"
+#include "dl_detect_tracker.hpp"
 #include "dl_image_preprocessor.hpp"
 #include "dl_model_base.hpp"
 
@@ -12,6 +13,7 @@ public:
     virtual std::list<dl::detect::result_t> &run(const dl::image::img_t &img) = 0;
     virtual Detect &set_score_thr(float score_thr, int idx) = 0;
     virtual Detect &set_nms_thr(float nms_thr, int idx) = 0;
+    virtual Detect &set_nms_type(nms_type_t nms_type, bool class_aware, int idx) = 0;
     virtual dl::Model *get_raw_model(int idx) = 0;
 };
 
@@ -28,6 +30,7 @@ public:
     std::list<dl::detect::result_t> &run(const dl::image::img_t &img) override;
     Detect &set_score_thr(float score_thr, int idx = 0) override;
     Detect &set_nms_thr(float nms_thr, int idx = 0) override;
+    Detect &set_nms_type(nms_type_t nms_type, bool class_aware = false, int idx = 0) override;
     dl::Model *get_raw_model(int idx = 0) override;
 };
 
@@ -42,7 +45,56 @@ public:
     std::list<dl::detect::result_t> &run(const dl::image::img_t &img) override;
     Detect &set_score_thr(float score_thr, int idx = 0) override;
     Detect &set_nms_thr(float nms_thr, int idx = 0) override;
+    Detect &set_nms_type(nms_type_t nms_type, bool class_aware = false, int idx = 0) override;
     dl::Model *get_raw_model(int idx = 0) override;
 };
+
+/**
+ * @brief A detector which only runs on keyframes, and tracks the boxes in the frames between them.
+ *
+ * A frame is a keyframe every keyframe_interval frames, and as soon as a track is lost or the image changes outside of
+ * the tracked boxes. With keyframe_interval = 5, a 15 fps camera gets boxes with stable ids on every frame while the
+ * network runs at 3 fps in a static scene.
+ */
+class TrackedDetect {
+private:
+    Detect *m_detect;        /*!< The detector, not owned */
+    Tracker m_tracker;       /*!< Tracks of the detected boxes */
+    MotionDetector m_motion; /*!< Motion since the last keyframe */
+    int m_keyframe_interval; /*!< A frame is a keyframe at least every keyframe_interval frames */
+    float m_motion_thr;      /*!< A frame is a keyframe if its motion is above motion_thr */
+    int m_frame_num;         /*!< Number of frames since the last keyframe, -1 before the first one */
+    bool m_keyframe;         /*!< The last frame is a keyframe */
+
+public:
+    /**
+     * @brief Construct a new TrackedDetect object.
+     *
+     * @param detect             The detector, it must outlive the TrackedDetect
+     * @param keyframe_interval  A frame is a keyframe at least every keyframe_interval frames, 1 to detect every frame
+     * @param motion_thr         A frame is a keyframe if this fraction of the image changed since the last keyframe,
+     *                           outside of the tracked boxes. 1 to disable.
+     * @param caps               DL_IMAGE_CAP_RGB565_BIG_ENDIAN if the RGB565 frames are big endian
+     */
+    TrackedDetect(Detect *detect, int keyframe_interval = 5, float motion_thr = 0.05, int caps = 0);
+
+    /**
+     * @brief Detect the boxes of a keyframe, or predict them on the other frames.
+     *
+     * @param img  Frame
+     * @return The tracks of the frame
+     */
+    std::list<track_t> &run(const dl::image::img_t &img);
+
+    /**
+     * @brief Whether the last frame is a keyframe.
+     *
+     * @return true if the detector ran on the last frame
+     */
+    bool is_keyframe() { return m_keyframe; }
+    Tracker &get_tracker() { return m_tracker; }
+    void set_keyframe_interval(int keyframe_interval) { m_keyframe_interval = keyframe_interval; }
+    void set_motion_thr(float motion_thr) { m_motion_thr = motion_thr; }
+};
 } // namespace detect
 } // namespace dl
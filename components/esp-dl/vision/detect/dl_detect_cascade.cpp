@@ -0,0 +1,64 @@
+#include "dl_detect_cascade.hpp"
+
+namespace dl {
+namespace detect {
+
+CascadePipeline::CascadePipeline(propose_t propose,
+                                 refine_t refine,
+                                 std::function<void(frame_t *)> release,
+                                 int queue_depth,
+                                 uint32_t stack_size,
+                                 BaseType_t propose_core,
+                                 BaseType_t refine_core) :
+    m_propose(propose), m_refine(refine), m_release(release)
+{
+    // The results of the stages live in their postprocessors until the next run, so each stage copies them to the
+    // frame before the next frame comes in.
+    m_pipeline = new tool::Pipeline(
+        {{"propose",
+          [this](void *item) {
+              frame_t *frame = (frame_t *)item;
+              frame->candidates = m_propose(frame->img);
+          },
+          propose_core,
+          stack_size},
+         {"refine",
+          [this](void *item) {
+              frame_t *frame = (frame_t *)item;
+              frame->result = m_refine(frame->img, frame->candidates);
+          },
+          refine_core,
+          stack_size}},
+        queue_depth,
+        5,
+        [this](void *item) {
+            if (m_release) {
+                m_release((frame_t *)item);
+            }
+        });
+}
+
+CascadePipeline::~CascadePipeline()
+{
+    if (m_pipeline) {
+        delete m_pipeline;
+        m_pipeline = nullptr;
+    }
+}
+
+bool CascadePipeline::push(frame_t *frame, TickType_t timeout)
+{
+    return m_pipeline->push(frame, timeout);
+}
+
+CascadePipeline::frame_t *CascadePipeline::pop(TickType_t timeout)
+{
+    void *item = nullptr;
+    if (!m_pipeline->pop(&item, timeout)) {
+        return nullptr;
+    }
+    return (frame_t *)item;
+}
+
+} // namespace detect
+} // namespace dl
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "dl_detect_define.hpp"
+#include "dl_image_define.hpp"
+#include "dl_pipeline.hpp"
+#include <list>
+
+namespace dl {
+namespace detect {
+
+/**
+ * @brief A two stage cascade detector run as a pipeline, e.g. MSR + MNP of human_face_detect: the propose stage
+ * finds the candidates of a frame and the refine stage checks them. Each stage runs on its own task, so the refine
+ * stage of frame N runs while the propose stage of frame N + 1 runs.
+ */
+class CascadePipeline {
+public:
+    /**
+     * @brief A frame in the pipeline.
+     */
+    typedef struct {
+        image::img_t img;               ///< Input image, it must stay valid until the frame is popped or released
+        std::list<result_t> candidates; ///< Candidates of the propose stage
+        std::list<result_t> result;     ///< Boxes found by the refine stage
+        void *user_data;                ///< Free for the caller, e.g. the frame buffer to release
+    } frame_t;
+
+    /**
+     * @brief Find the candidates of an image. The list may be overwritten by the next call, it is copied to the frame.
+     */
+    typedef std::function<std::list<result_t> &(const image::img_t &)> propose_t;
+
+    /**
+     * @brief Check the candidates of an image. The list may be overwritten by the next call, it is copied to the
+     * frame.
+     */
+    typedef std::function<std::list<result_t> &(const image::img_t &, std::list<result_t> &)> refine_t;
+
+private:
+    propose_t m_propose;                      /*!< First stage */
+    refine_t m_refine;                        /*!< Second stage */
+    std::function<void(frame_t *)> m_release; /*!< Releases the frames dropped by the destructor */
+    tool::Pipeline *m_pipeline;               /*!< Stage tasks */
+
+public:
+    /**
+     * @brief Construct a new CascadePipeline object and start its stage tasks.
+     *
+     * @param propose       First stage, run on propose_core
+     * @param refine        Second stage, run on refine_core
+     * @param release       Called by the destructor on each frame which was pushed and not popped, e.g. to release
+     *                      the frame buffer of user_data. nullptr if the frames own nothing
+     * @param queue_depth   Number of frames waiting for each stage
+     * @param stack_size    Stack size of the stage tasks in bytes
+     * @param propose_core  Core of the first stage
+     * @param refine_core   Core of the second stage
+     */
+    CascadePipeline(propose_t propose,
+                    refine_t refine,
+                    std::function<void(frame_t *)> release = nullptr,
+                    int queue_depth = 1,
+                    uint32_t stack_size = 16 * 1024,
+                    BaseType_t propose_core = 0,
+                    BaseType_t refine_core = 1);
+
+    /**
+     * @brief Destroy the CascadePipeline object. The pushed frames are processed, the ones which were not popped are
+     * passed to the release function.
+     */
+    ~CascadePipeline();
+
+    /**
+     * @brief Start the detection of a frame, blocks while the pipeline is full.
+     *
+     * @param frame    Frame, its img is set
+     * @param timeout  Ticks to wait when the pipeline is full
+     * @return true if the frame was queued
+     */
+    bool push(frame_t *frame, TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Take the next detected frame, in push order.
+     *
+     * @param timeout  Ticks to wait for a frame
+     * @return The frame, nullptr on timeout
+     */
+    frame_t *pop(TickType_t timeout = portMAX_DELAY);
+
+    /**
+     * @brief Get the pipeline of the stage tasks, e.g. for its statistics.
+     */
+    tool::Pipeline *get_pipeline() { return m_pipeline; }
+};
+
+} // namespace detect
+} // namespace dl
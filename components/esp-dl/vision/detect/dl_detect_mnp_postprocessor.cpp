@@ -50,40 +50,25 @@ void MNPPostprocessor::parse_stage(TensorBase *score, TensorBase *box, TensorBas
                 if (max_score > m_score_thr) {
                     int anchor_h = anchor_shape[a][0];
                     int anchor_w = anchor_shape[a][1];
-                    result_t new_box = {
+                    int keypoint[10];
+                    for (int i = 0; i < 10; i += 2) {
+                        keypoint[i] = (int)(anchor_w * dequantize(landmark_ptr[i], landmark_exp) * inv_resize_scale_x +
+                                            top_left_x);
+                        keypoint[i + 1] =
+                            (int)(anchor_h * dequantize(landmark_ptr[i + 1], landmark_exp) * inv_resize_scale_y +
+                                  top_left_y);
+                    }
+                    m_candidates.add(
                         0,
                         max_score,
-                        {(int)(anchor_w * dequantize(box_ptr[0], box_exp) * inv_resize_scale_x + top_left_x),
-                         (int)(anchor_h * dequantize(box_ptr[1], box_exp) * inv_resize_scale_y + top_left_y),
-                         (int)((anchor_w * dequantize(box_ptr[2], box_exp) + anchor_w) * inv_resize_scale_x +
-                               top_left_x),
-                         (int)((anchor_h * dequantize(box_ptr[3], box_exp) + anchor_h) * inv_resize_scale_y +
-                               top_left_y)},
-                        {
-                            (int)(anchor_w * dequantize(landmark_ptr[0], landmark_exp) * inv_resize_scale_x +
-                                  top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[1], landmark_exp) * inv_resize_scale_y +
-                                  top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[2], landmark_exp) * inv_resize_scale_x +
-                                  top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[3], landmark_exp) * inv_resize_scale_y +
-                                  top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[4], landmark_exp) * inv_resize_scale_x +
-                                  top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[5], landmark_exp) * inv_resize_scale_y +
-                                  top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[6], landmark_exp) * inv_resize_scale_x +
-                                  top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[7], landmark_exp) * inv_resize_scale_y +
-                                  top_left_y),
-                            (int)(anchor_w * dequantize(landmark_ptr[8], landmark_exp) * inv_resize_scale_x +
-                                  top_left_x),
-                            (int)(anchor_h * dequantize(landmark_ptr[9], landmark_exp) * inv_resize_scale_y +
-                                  top_left_y),
-                        }};
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        (int)(anchor_w * dequantize(box_ptr[0], box_exp) * inv_resize_scale_x + top_left_x),
+                        (int)(anchor_h * dequantize(box_ptr[1], box_exp) * inv_resize_scale_y + top_left_y),
+                        (int)((anchor_w * dequantize(box_ptr[2], box_exp) + anchor_w) * inv_resize_scale_x +
+                              top_left_x),
+                        (int)((anchor_h * dequantize(box_ptr[3], box_exp) + anchor_h) * inv_resize_scale_y +
+                              top_left_y),
+                        keypoint,
+                        10);
                 }
                 score_ptr += C;
                 box_ptr += 4;
@@ -0,0 +1,234 @@
+#include "dl_detect_nms.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace dl {
+namespace detect {
+// One row of the IoU matrix: suppress the boxes after i which overlap box i above nms_thr. iou > nms_thr is computed
+// without a division and a branch, and the arrays do not alias, so the loop is vectorized.
+static void suppress_row(int i,
+                         int n,
+                         const int *__restrict category,
+                         const int *__restrict x1,
+                         const int *__restrict y1,
+                         const int *__restrict x2,
+                         const int *__restrict y2,
+                         const int *__restrict area,
+                         bool class_aware,
+                         float nms_thr,
+                         uint8_t *__restrict suppressed)
+{
+    for (int j = i + 1; j < n; j++) {
+        int inter_width = std::max(std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]) + 1, 0);
+        int inter_height = std::max(std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]) + 1, 0);
+        float inter_area = inter_width * inter_height;
+        float union_area = area[i] + area[j] - inter_area;
+        suppressed[j] |= (inter_area > nms_thr * union_area) & (!class_aware | (category[j] == category[i]));
+    }
+}
+
+// One row of the IoU matrix for NMS_MATRIX: the largest IoU of the boxes after i with a better box, and the linear
+// decay of their scores, relative to how much box i is suppressed itself.
+static void decay_row(int i,
+                      int n,
+                      const int *__restrict category,
+                      const int *__restrict x1,
+                      const int *__restrict y1,
+                      const int *__restrict x2,
+                      const int *__restrict y2,
+                      const int *__restrict area,
+                      bool class_aware,
+                      float *__restrict max_iou,
+                      float *__restrict decay)
+{
+    float compensate = 1.f / std::max(1.f - max_iou[i], 1e-6f);
+    for (int j = i + 1; j < n; j++) {
+        int inter_width = std::max(std::min(x2[i], x2[j]) - std::max(x1[i], x1[j]) + 1, 0);
+        int inter_height = std::max(std::min(y2[i], y2[j]) - std::max(y1[i], y1[j]) + 1, 0);
+        float inter_area = inter_width * inter_height;
+        float iou = inter_area / (area[i] + area[j] - inter_area);
+        iou *= (!class_aware | (category[j] == category[i]));
+        max_iou[j] = std::max(max_iou[j], iou);
+        decay[j] = std::min(decay[j], (1.f - iou) * compensate);
+    }
+}
+
+void CandidateBuffer::clear()
+{
+    // clear keeps the capacity of the vectors
+    m_category.clear();
+    m_score.clear();
+    m_x1.clear();
+    m_y1.clear();
+    m_x2.clear();
+    m_y2.clear();
+    m_keypoint.clear();
+    m_keypoint_num = 0;
+}
+
+void CandidateBuffer::add(
+    int category, float score, int x1, int y1, int x2, int y2, const int *keypoint, int keypoint_num)
+{
+    m_category.push_back(category);
+    m_score.push_back(score);
+    m_x1.push_back(x1);
+    m_y1.push_back(y1);
+    m_x2.push_back(x2);
+    m_y2.push_back(y2);
+    if (keypoint_num > 0) {
+        m_keypoint_num = keypoint_num;
+        m_keypoint.insert(m_keypoint.end(), keypoint, keypoint + keypoint_num);
+    }
+}
+
+void CandidateBuffer::sort_by_score()
+{
+    int n = m_score.size();
+    m_order.resize(n);
+    std::iota(m_order.begin(), m_order.end(), 0);
+    // the boxes of the same score stay in the order they are added. std::sort does not allocate, unlike
+    // std::stable_sort
+    std::sort(m_order.begin(), m_order.end(), [this](int a, int b) {
+        return m_score[a] > m_score[b] || (m_score[a] == m_score[b] && a < b);
+    });
+
+    m_sorted_category.resize(n);
+    m_sorted_x1.resize(n);
+    m_sorted_y1.resize(n);
+    m_sorted_x2.resize(n);
+    m_sorted_y2.resize(n);
+    m_sorted_area.resize(n);
+    for (int i = 0; i < n; i++) {
+        int c = m_order[i];
+        m_sorted_category[i] = m_category[c];
+        m_sorted_x1[i] = m_x1[c];
+        m_sorted_y1[i] = m_y1[c];
+        m_sorted_x2[i] = m_x2[c];
+        m_sorted_y2[i] = m_y2[c];
+        m_sorted_area[i] = (m_x2[c] - m_x1[c] + 1) * (m_y2[c] - m_y1[c] + 1);
+    }
+}
+
+void CandidateBuffer::append_result(int index, float score, std::list<result_t> &results)
+{
+    int c = m_order[index];
+    results.push_back({m_category[c], score, {m_x1[c], m_y1[c], m_x2[c], m_y2[c]}, {}});
+    if (m_keypoint_num > 0 && m_keypoint.size() >= (size_t)(c + 1) * m_keypoint_num) {
+        results.back().keypoint.assign(m_keypoint.begin() + c * m_keypoint_num,
+                                       m_keypoint.begin() + (c + 1) * m_keypoint_num);
+    }
+}
+
+void CandidateBuffer::greedy_nms(bool class_aware, float nms_thr, int top_k, std::list<result_t> &results)
+{
+    int n = m_order.size();
+    m_suppressed.assign(n, 0);
+    const int *category = m_sorted_category.data();
+    const int *x1 = m_sorted_x1.data();
+    const int *y1 = m_sorted_y1.data();
+    const int *x2 = m_sorted_x2.data();
+    const int *y2 = m_sorted_y2.data();
+    const int *area = m_sorted_area.data();
+    uint8_t *suppressed = m_suppressed.data();
+
+    int kept_number = 0;
+    for (int i = 0; i < n; i++) {
+        if (suppressed[i]) {
+            continue;
+        }
+        append_result(i, m_score[m_order[i]], results);
+        kept_number++;
+        if (kept_number >= top_k) {
+            break;
+        }
+        suppress_row(i, n, category, x1, y1, x2, y2, area, class_aware, nms_thr, suppressed);
+    }
+}
+
+void CandidateBuffer::fast_nms(bool class_aware, float nms_thr, int top_k, std::list<result_t> &results)
+{
+    int n = m_order.size();
+    m_suppressed.assign(n, 0);
+    const int *category = m_sorted_category.data();
+    const int *x1 = m_sorted_x1.data();
+    const int *y1 = m_sorted_y1.data();
+    const int *x2 = m_sorted_x2.data();
+    const int *y2 = m_sorted_y2.data();
+    const int *area = m_sorted_area.data();
+    uint8_t *suppressed = m_suppressed.data();
+
+    // the upper triangle of the IoU matrix, a suppressed box still suppresses the following ones
+    for (int i = 0; i < n - 1; i++) {
+        suppress_row(i, n, category, x1, y1, x2, y2, area, class_aware, nms_thr, suppressed);
+    }
+
+    int kept_number = 0;
+    for (int i = 0; i < n && kept_number < top_k; i++) {
+        if (!suppressed[i]) {
+            append_result(i, m_score[m_order[i]], results);
+            kept_number++;
+        }
+    }
+}
+
+void CandidateBuffer::matrix_nms(bool class_aware, float score_thr, int top_k, std::list<result_t> &results)
+{
+    int n = m_order.size();
+    m_max_iou.assign(n, 0.f);
+    m_decay.assign(n, 1.f);
+    const int *category = m_sorted_category.data();
+    const int *x1 = m_sorted_x1.data();
+    const int *y1 = m_sorted_y1.data();
+    const int *x2 = m_sorted_x2.data();
+    const int *y2 = m_sorted_y2.data();
+    const int *area = m_sorted_area.data();
+    float *max_iou = m_max_iou.data();
+    float *decay = m_decay.data();
+
+    // the upper triangle of the IoU matrix, a row at a time. The largest IoU of box i with the better boxes is known
+    // once the rows before i are done.
+    for (int i = 0; i < n - 1; i++) {
+        decay_row(i, n, category, x1, y1, x2, y2, area, class_aware, max_iou, decay);
+    }
+
+    // the decayed scores change the order, m_max_iou is reused for them
+    m_kept.clear();
+    for (int i = 0; i < n; i++) {
+        max_iou[i] = m_score[m_order[i]] * decay[i];
+        if (max_iou[i] > score_thr) {
+            m_kept.push_back(i);
+        }
+    }
+    std::sort(m_kept.begin(), m_kept.end(), [max_iou](int a, int b) {
+        return max_iou[a] > max_iou[b] || (max_iou[a] == max_iou[b] && a < b);
+    });
+    for (size_t i = 0; i < m_kept.size() && i < (size_t)top_k; i++) {
+        append_result(m_kept[i], max_iou[m_kept[i]], results);
+    }
+}
+
+void CandidateBuffer::nms(
+    nms_type_t type, bool class_aware, float nms_thr, float score_thr, int top_k, std::list<result_t> &results)
+{
+    if (m_score.empty() || top_k < 1) {
+        return;
+    }
+    sort_by_score();
+    if (type == NMS_GREEDY) {
+        greedy_nms(class_aware, nms_thr, top_k, results);
+    } else if (type == NMS_FAST) {
+        fast_nms(class_aware, nms_thr, top_k, results);
+    } else {
+        matrix_nms(class_aware, score_thr, top_k, results);
+    }
+}
+
+void CandidateBuffer::sort(std::list<result_t> &results)
+{
+    sort_by_score();
+    for (size_t i = 0; i < m_order.size(); i++) {
+        append_result(i, m_score[m_order[i]], results);
+    }
+}
+} // namespace detect
+} // namespace dl
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "dl_detect_define.hpp"
+#include <list>
+#include <vector>
+
+namespace dl {
+namespace detect {
+typedef enum {
+    NMS_GREEDY = 0, /*!< Keep the best box, drop the boxes overlapping it above nms_thr, repeat with the next box */
+    NMS_FAST,       /*!< Drop the boxes overlapping any better box above nms_thr, even a dropped one */
+    NMS_MATRIX,     /*!< Decay the scores by the overlap with the better boxes, drop the scores below score_thr */
+} nms_type_t;
+
+/**
+ * @brief Candidate boxes of an image and the NMS which selects the detected boxes among them.
+ *
+ * The candidates are stored as a structure of arrays, and sorted by score into other arrays before the NMS, so the IoU
+ * of a box with all the following ones is a loop over contiguous arrays the compiler vectorizes. The arrays keep their
+ * memory from image to image, a frame allocates nothing once they are large enough for its candidates.
+ *
+ * NMS_FAST and NMS_MATRIX compute the IoU of every pair of candidates, without the data dependent branches of
+ * NMS_GREEDY, which only computes the IoU of the kept boxes. NMS_GREEDY is faster when few boxes are kept.
+ */
+class CandidateBuffer {
+public:
+    CandidateBuffer() : m_keypoint_num(0) {}
+
+    /**
+     * @brief Remove the candidates.
+     */
+    void clear();
+
+    /**
+     * @brief Add a candidate.
+     *
+     * @param category      Category index
+     * @param score         Score of the box
+     * @param x1            Left up x
+     * @param y1            Left up y
+     * @param x2            Right down x
+     * @param y2            Right down y
+     * @param keypoint      [x1, y1, x2, y2, ...], nullptr if none
+     * @param keypoint_num  Number of values of keypoint, the same for all the candidates
+     */
+    void add(
+        int category, float score, int x1, int y1, int x2, int y2, const int *keypoint = nullptr, int keypoint_num = 0);
+
+    /**
+     * @brief Get the number of candidates.
+     *
+     * @return The number of candidates
+     */
+    int size() { return m_score.size(); }
+
+    /**
+     * @brief Select the detected boxes among the candidates and append them to results, from the best score.
+     *
+     * @param type         Type of NMS
+     * @param class_aware  Only the boxes of the same category suppress each other
+     * @param nms_thr      IoU threshold of NMS_GREEDY and NMS_FAST
+     * @param score_thr    Score threshold of the decayed scores of NMS_MATRIX
+     * @param top_k        Maximum number of detected boxes
+     * @param results      The detected boxes are appended to it
+     */
+    void nms(
+        nms_type_t type, bool class_aware, float nms_thr, float score_thr, int top_k, std::list<result_t> &results);
+
+    /**
+     * @brief Append all the candidates to results, from the best score.
+     *
+     * @param results  The candidates are appended to it
+     */
+    void sort(std::list<result_t> &results);
+
+private:
+    std::vector<int> m_category; /*!< Category of each candidate */
+    std::vector<float> m_score;  /*!< Score of each candidate */
+    std::vector<int> m_x1;       /*!< Left up x of each candidate */
+    std::vector<int> m_y1;       /*!< Left up y of each candidate */
+    std::vector<int> m_x2;       /*!< Right down x of each candidate */
+    std::vector<int> m_y2;       /*!< Right down y of each candidate */
+    std::vector<int> m_keypoint; /*!< m_keypoint_num values for each candidate */
+    int m_keypoint_num;          /*!< Number of keypoint values of a candidate */
+
+    // the candidates sorted by score
+    std::vector<int> m_order;           /*!< Index of the candidate of each sorted box */
+    std::vector<int> m_sorted_category; /*!< Category of each sorted box */
+    std::vector<int> m_sorted_x1;       /*!< Left up x of each sorted box */
+    std::vector<int> m_sorted_y1;       /*!< Left up y of each sorted box */
+    std::vector<int> m_sorted_x2;       /*!< Right down x of each sorted box */
+    std::vector<int> m_sorted_y2;       /*!< Right down y of each sorted box */
+    std::vector<int> m_sorted_area;     /*!< Area of each sorted box */
+    std::vector<uint8_t> m_suppressed;  /*!< NMS_GREEDY, NMS_FAST: the box is dropped */
+    std::vector<float> m_max_iou;       /*!< NMS_MATRIX: largest IoU with a better box */
+    std::vector<float> m_decay;         /*!< NMS_MATRIX: decay of the score */
+    std::vector<int> m_kept;            /*!< NMS_MATRIX: the boxes whose decayed score is above score_thr */
+
+    void sort_by_score();
+    void append_result(int index, float score, std::list<result_t> &results);
+    void greedy_nms(bool class_aware, float nms_thr, int top_k, std::list<result_t> &results);
+    void fast_nms(bool class_aware, float nms_thr, int top_k, std::list<result_t> &results);
+    void matrix_nms(bool class_aware, float score_thr, int top_k, std::list<result_t> &results);
+};
+} // namespace detect
+} // namespace dl
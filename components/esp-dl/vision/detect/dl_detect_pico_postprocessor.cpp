@@ -30,28 +30,37 @@ void PicoPostprocessor::parse_stage(TensorBase *score, TensorBase *box, const in
     {
         for (size_t x = 0; x < W; x++) // width
         {
+            // the box of a location is decoded once, for the first category above the threshold
+            bool box_decoded = false;
+            int box_coord[4];
             for (size_t c = 0; c < C; c++) // category number
             {
                 if (*score_ptr > score_thr_quant) {
-                    int center_y = y * stride_y + offset_y;
-                    int center_x = x * stride_x + offset_x;
+                    if (!box_decoded) {
+                        int center_y = y * stride_y + offset_y;
+                        int center_x = x * stride_x + offset_x;
 
-                    float box_data[32];
-                    for (int i = 0; i < 32; i++) {
-                        box_data[i] = dequantize(box_ptr[i], box_exp);
-                    }
-
-                    result_t new_box = {
-                        (int)c,
-                        sqrtf(dequantize(*score_ptr, score_exp)),
-                        {(int)((center_x - dl::math::dfl_integral(box_data, 7) * stride_x) * inv_resize_scale_x),
-                         (int)((center_y - dl::math::dfl_integral(box_data + 8, 7) * stride_y) * inv_resize_scale_y),
-                         (int)((center_x + dl::math::dfl_integral(box_data + 16, 7) * stride_x) * inv_resize_scale_x),
-                         (int)((center_y + dl::math::dfl_integral(box_data + 24, 7) * stride_y) * inv_resize_scale_y)},
-                        {}};
+                        float box_data[32];
+                        for (int i = 0; i < 32; i++) {
+                            box_data[i] = dequantize(box_ptr[i], box_exp);
+                        }
 
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        box_coord[0] =
+                            (int)((center_x - dl::math::dfl_integral(box_data, 7) * stride_x) * inv_resize_scale_x);
+                        box_coord[1] =
+                            (int)((center_y - dl::math::dfl_integral(box_data + 8, 7) * stride_y) * inv_resize_scale_y);
+                        box_coord[2] = (int)((center_x + dl::math::dfl_integral(box_data + 16, 7) * stride_x) *
+                                             inv_resize_scale_x);
+                        box_coord[3] = (int)((center_y + dl::math::dfl_integral(box_data + 24, 7) * stride_y) *
+                                             inv_resize_scale_y);
+                        box_decoded = true;
+                    }
+                    m_candidates.add((int)c,
+                                     sqrtf(dequantize(*score_ptr, score_exp)),
+                                     box_coord[0],
+                                     box_coord[1],
+                                     box_coord[2],
+                                     box_coord[3]);
                 }
                 score_ptr++;
             }
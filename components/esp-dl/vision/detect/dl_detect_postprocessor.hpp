@@ -1,5 +1,6 @@
 #pragma once
 #include "dl_detect_define.hpp"
+#include "dl_detect_nms.hpp"
 #include "dl_image_preprocessor.hpp"
 #include "dl_model_base.hpp"
 
@@ -16,6 +17,9 @@ protected:
     float m_nms_thr;                /*!< Candidate box with higher IoU than nms_thr will be filtered */
     int m_top_k;                    /*!< Keep top_k number of candidate boxes */
     std::list<result_t> m_box_list; /*!< Detected box list */
+    CandidateBuffer m_candidates;   /*!< Candidate boxes added by postprocess, not selected yet */
+    nms_type_t m_nms_type;          /*!< Type of NMS */
+    bool m_nms_class_aware;         /*!< Only the boxes of the same category suppress each other */
 
 public:
     DetectPostprocessor(Model *model,
@@ -27,13 +31,40 @@ public:
         m_image_preprocessor(image_preprocessor),
         m_score_thr(score_thr),
         m_nms_thr(nms_thr),
-        m_top_k(top_k) {};
+        m_top_k(top_k),
+        m_nms_type(NMS_GREEDY),
+        m_nms_class_aware(false) {};
     virtual ~DetectPostprocessor() {};
     virtual void postprocess() = 0;
+    /**
+     * @brief Select the detected boxes among the candidates added by postprocess.
+     */
     void nms();
-    void clear_result() { m_box_list.clear(); };
+    void clear_result()
+    {
+        m_candidates.clear();
+        m_box_list.clear();
+    };
     void set_score_thr(float score_thr) { m_score_thr = score_thr; }
     void set_nms_thr(float nms_thr) { m_nms_thr = nms_thr; }
+    /**
+     * @brief Set the type of NMS, NMS_GREEDY by default.
+     *
+     * @param nms_type     Type of NMS
+     * @param class_aware  Only the boxes of the same category suppress each other, false by default
+     */
+    void set_nms_type(nms_type_t nms_type, bool class_aware = false)
+    {
+        m_nms_type = nms_type;
+        m_nms_class_aware = class_aware;
+    }
+    /**
+     * @brief Get the detected boxes. The candidates not selected by nms are all returned, from the best score.
+     *
+     * @param width   Width of the image, the boxes are limited to it
+     * @param height  Height of the image, the boxes are limited to it
+     * @return The detected boxes
+     */
     std::list<result_t> &get_result(int width, int height);
 };
 
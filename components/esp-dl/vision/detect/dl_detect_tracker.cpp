@@ -0,0 +1,334 @@
+#include "dl_detect_tracker.hpp"
+#include "dl_detect_base.hpp"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+namespace dl {
+namespace detect {
+// The noise of SORT: the detections are trusted on the position, less on the size, and the velocities start unknown
+static constexpr float s_init_pos_var = 10.f;
+static constexpr float s_init_vel_var = 10000.f;
+static constexpr float s_pos_noise = 1.f;
+static constexpr float s_vel_noise = 0.01f;
+static constexpr float s_area_vel_noise = 0.0001f;
+static constexpr float s_center_measure_noise = 1.f;
+static constexpr float s_size_measure_noise = 10.f;
+
+static float box_iou(const int *a, const std::vector<int> &b)
+{
+    int inter_width = std::min(a[2], b[2]) - std::max(a[0], b[0]);
+    int inter_height = std::min(a[3], b[3]) - std::max(a[1], b[1]);
+    if (inter_width <= 0 || inter_height <= 0) {
+        return 0;
+    }
+    float inter_area = (float)inter_width * inter_height;
+    float union_area = (float)(a[2] - a[0]) * (a[3] - a[1]) + (float)(b[2] - b[0]) * (b[3] - b[1]) - inter_area;
+    return inter_area / union_area;
+}
+
+Tracker::Tracker(float iou_thr, int min_hits, int max_misses) :
+    m_iou_thr(iou_thr), m_min_hits(min_hits), m_max_misses(max_misses), m_next_id(1), m_lost(false)
+{
+}
+
+void Tracker::reset()
+{
+    m_tracks.clear();
+    m_result.clear();
+    m_lost = false;
+}
+
+void Tracker::kalman_init(kalman_t &kalman, float x, float init_vel_var)
+{
+    kalman.x = x;
+    kalman.v = 0;
+    kalman.pp = s_init_pos_var;
+    kalman.pv = 0;
+    kalman.vv = init_vel_var;
+}
+
+// x' = x + v, P' = F P F^T + Q
+void Tracker::kalman_predict(kalman_t &kalman, float pos_noise, float vel_noise)
+{
+    kalman.x += kalman.v;
+    kalman.pp += 2 * kalman.pv + kalman.vv + pos_noise;
+    kalman.pv += kalman.vv;
+    kalman.vv += vel_noise;
+}
+
+// only the position is measured: K = P H^T / (H P H^T + R)
+void Tracker::kalman_correct(kalman_t &kalman, float z, float measure_noise)
+{
+    float s = kalman.pp + measure_noise;
+    float k0 = kalman.pp / s;
+    float k1 = kalman.pv / s;
+    float y = z - kalman.x;
+    kalman.x += k0 * y;
+    kalman.v += k1 * y;
+    kalman.vv -= k1 * kalman.pv;
+    kalman.pv -= k0 * kalman.pv;
+    kalman.pp -= k0 * kalman.pp;
+}
+
+void Tracker::init_state(state_t &state, const result_t &det)
+{
+    float width = std::max(det.box[2] - det.box[0], 1);
+    float height = std::max(det.box[3] - det.box[1], 1);
+    state.id = m_next_id++;
+    state.category = det.category;
+    state.score = det.score;
+    state.hits = 1;
+    state.misses = 0;
+    state.age = 0;
+    kalman_init(state.cx, (det.box[0] + det.box[2]) / 2.f, s_init_vel_var);
+    kalman_init(state.cy, (det.box[1] + det.box[3]) / 2.f, s_init_vel_var);
+    kalman_init(state.area, width * height, s_init_vel_var);
+    kalman_init(state.ratio, width / height, 0);
+    memcpy(state.box, det.box.data(), sizeof(state.box));
+}
+
+void Tracker::predict_state(state_t &state)
+{
+    // the area does not shrink below 0
+    if (state.area.x + state.area.v <= 0) {
+        state.area.v = 0;
+    }
+    kalman_predict(state.cx, s_pos_noise, s_vel_noise);
+    kalman_predict(state.cy, s_pos_noise, s_vel_noise);
+    kalman_predict(state.area, s_pos_noise, s_area_vel_noise);
+    kalman_predict(state.ratio, s_pos_noise, 0);
+    state.age++;
+
+    float width = sqrtf(std::max(state.area.x * state.ratio.x, 1.f));
+    float height = std::max(state.area.x, 1.f) / width;
+    state.box[0] = roundf(state.cx.x - width / 2);
+    state.box[1] = roundf(state.cy.x - height / 2);
+    state.box[2] = roundf(state.cx.x + width / 2);
+    state.box[3] = roundf(state.cy.x + height / 2);
+}
+
+void Tracker::correct_state(state_t &state, const result_t &det)
+{
+    float width = std::max(det.box[2] - det.box[0], 1);
+    float height = std::max(det.box[3] - det.box[1], 1);
+    state.category = det.category;
+    state.score = det.score;
+    state.hits++;
+    state.misses = 0;
+    kalman_correct(state.cx, (det.box[0] + det.box[2]) / 2.f, s_center_measure_noise);
+    kalman_correct(state.cy, (det.box[1] + det.box[3]) / 2.f, s_center_measure_noise);
+    kalman_correct(state.area, width * height, s_size_measure_noise);
+    kalman_correct(state.ratio, width / height, s_size_measure_noise);
+    // the reported box is the detection, the state only predicts the next ones
+    memcpy(state.box, det.box.data(), sizeof(state.box));
+}
+
+void Tracker::remove_outside(int width, int height)
+{
+    for (int i = m_tracks.size() - 1; i >= 0; i--) {
+        const int *box = m_tracks[i].box;
+        if (box[2] < 0 || box[3] < 0 || box[0] >= width || box[1] >= height) {
+            m_lost |= m_tracks[i].hits >= m_min_hits;
+            m_tracks.erase(m_tracks.begin() + i);
+        }
+    }
+}
+
+void Tracker::get_result(int width, int height)
+{
+    m_result.clear();
+    for (state_t &state : m_tracks) {
+        if (state.hits < m_min_hits || state.misses > 0) {
+            continue;
+        }
+        m_result.push_back({state.id,
+                            state.category,
+                            state.score,
+                            {state.box[0], state.box[1], state.box[2], state.box[3]},
+                            state.hits,
+                            state.age});
+        std::vector<int> &box = m_result.back().box;
+        box[0] = DL_CLIP(box[0], 0, width - 1);
+        box[1] = DL_CLIP(box[1], 0, height - 1);
+        box[2] = DL_CLIP(box[2], 0, width - 1);
+        box[3] = DL_CLIP(box[3], 0, height - 1);
+    }
+}
+
+std::list<track_t> &Tracker::update(const std::list<result_t> &detections, int width, int height)
+{
+    m_lost = false;
+    for (state_t &state : m_tracks) {
+        predict_state(state);
+    }
+
+    int track_num = m_tracks.size();
+    m_detections.clear();
+    for (const result_t &det : detections) {
+        m_detections.push_back(&det);
+    }
+    int det_num = m_detections.size();
+
+    // match the pairs of the same category from the best IoU, a track and a detection are in one pair at most
+    m_iou.resize(track_num * det_num);
+    m_pairs.clear();
+    for (int i = 0; i < track_num; i++) {
+        for (int j = 0; j < det_num; j++) {
+            float iou = m_tracks[i].category == m_detections[j]->category
+                ? box_iou(m_tracks[i].box, m_detections[j]->box)
+                : 0.f;
+            m_iou[i * det_num + j] = iou;
+            if (iou >= m_iou_thr) {
+                m_pairs.push_back(i * det_num + j);
+            }
+        }
+    }
+    std::sort(m_pairs.begin(), m_pairs.end(), [this](int a, int b) {
+        return m_iou[a] > m_iou[b] || (m_iou[a] == m_iou[b] && a < b);
+    });
+    m_detected.assign(track_num, 0);
+    m_matched.assign(det_num, -1);
+    for (int pair : m_pairs) {
+        int i = pair / det_num;
+        int j = pair % det_num;
+        if (!m_detected[i] && m_matched[j] < 0) {
+            m_detected[i] = 1;
+            m_matched[j] = i;
+            correct_state(m_tracks[i], *m_detections[j]);
+        }
+    }
+
+    // the tracks not detected are kept for max_misses detection frames
+    for (int i = track_num - 1; i >= 0; i--) {
+        if (m_detected[i]) {
+            continue;
+        }
+        state_t &state = m_tracks[i];
+        state.misses++;
+        m_lost |= state.hits >= m_min_hits;
+        if (state.misses > m_max_misses) {
+            m_tracks.erase(m_tracks.begin() + i);
+        }
+    }
+    for (int j = 0; j < det_num; j++) {
+        if (m_matched[j] < 0) {
+            m_tracks.emplace_back();
+            init_state(m_tracks.back(), *m_detections[j]);
+        }
+    }
+
+    remove_outside(width, height);
+    get_result(width, height);
+    return m_result;
+}
+
+std::list<track_t> &Tracker::predict(int width, int height)
+{
+    for (state_t &state : m_tracks) {
+        predict_state(state);
+    }
+    remove_outside(width, height);
+    get_result(width, height);
+    return m_result;
+}
+
+MotionDetector::MotionDetector(int diff_thr, int caps) : m_diff_thr(diff_thr), m_caps(caps), m_has_reference(false)
+{
+}
+
+bool MotionDetector::get_thumb(const dl::image::img_t &img, uint8_t *thumb)
+{
+    if (img.pix_type != dl::image::DL_IMAGE_PIX_TYPE_RGB888 && img.pix_type != dl::image::DL_IMAGE_PIX_TYPE_RGB565 &&
+        img.pix_type != dl::image::DL_IMAGE_PIX_TYPE_GRAY) {
+        return false;
+    }
+    const uint8_t *data = (const uint8_t *)img.data;
+    bool big_endian = m_caps & dl::image::DL_IMAGE_CAP_RGB565_BIG_ENDIAN;
+    // the center pixel of each cell, the luma is (r + 2 * g + b) / 4, which is the same for RGB and BGR
+    for (int i = 0; i < THUMB_HEIGHT; i++) {
+        int y = (2 * i + 1) * img.height / (2 * THUMB_HEIGHT);
+        for (int j = 0; j < THUMB_WIDTH; j++) {
+            int x = (2 * j + 1) * img.width / (2 * THUMB_WIDTH);
+            const uint8_t *pixel = data + ((size_t)y * img.width + x) * dl::image::get_pix_byte_size(img.pix_type);
+            int luma;
+            if (img.pix_type == dl::image::DL_IMAGE_PIX_TYPE_RGB888) {
+                luma = (pixel[0] + 2 * pixel[1] + pixel[2]) >> 2;
+            } else if (img.pix_type == dl::image::DL_IMAGE_PIX_TYPE_RGB565) {
+                int value = big_endian ? (pixel[0] << 8) | pixel[1] : (pixel[1] << 8) | pixel[0];
+                luma = (((value >> 11) << 3) + (((value >> 5) & 0x3f) << 3) + ((value & 0x1f) << 3)) >> 2;
+            } else {
+                luma = pixel[0];
+            }
+            thumb[i * THUMB_WIDTH + j] = luma;
+        }
+    }
+    return true;
+}
+
+void MotionDetector::set_mask(const std::list<track_t> &masks, int width, int height, uint8_t *mask)
+{
+    memset(mask, 0, THUMB_WIDTH * THUMB_HEIGHT);
+    for (const track_t &track : masks) {
+        // the cells whose center is in the box
+        for (int i = 0; i < THUMB_HEIGHT; i++) {
+            int y = (2 * i + 1) * height / (2 * THUMB_HEIGHT);
+            if (y < track.box[1] || y > track.box[3]) {
+                continue;
+            }
+            for (int j = 0; j < THUMB_WIDTH; j++) {
+                int x = (2 * j + 1) * width / (2 * THUMB_WIDTH);
+                mask[i * THUMB_WIDTH + j] |= x >= track.box[0] && x <= track.box[2];
+            }
+        }
+    }
+}
+
+void MotionDetector::set_reference(const dl::image::img_t &img, const std::list<track_t> &masks)
+{
+    m_has_reference = get_thumb(img, m_reference);
+    set_mask(masks, img.width, img.height, m_reference_mask);
+}
+
+float MotionDetector::get_motion(const dl::image::img_t &img, const std::list<track_t> &masks)
+{
+    if (!m_has_reference || !get_thumb(img, m_thumb)) {
+        return 0;
+    }
+    set_mask(masks, img.width, img.height, m_mask);
+    int changed = 0;
+    for (int i = 0; i < THUMB_WIDTH * THUMB_HEIGHT; i++) {
+        changed += !(m_mask[i] | m_reference_mask[i]) & (abs(m_thumb[i] - m_reference[i]) > m_diff_thr);
+    }
+    return (float)changed / (THUMB_WIDTH * THUMB_HEIGHT);
+}
+
+TrackedDetect::TrackedDetect(Detect *detect, int keyframe_interval, float motion_thr, int caps) :
+    m_detect(detect),
+    m_motion(24, caps),
+    m_keyframe_interval(keyframe_interval),
+    m_motion_thr(motion_thr),
+    m_frame_num(-1),
+    m_keyframe(false)
+{
+}
+
+std::list<track_t> &TrackedDetect::run(const dl::image::img_t &img)
+{
+    m_keyframe = m_frame_num < 0 || m_frame_num + 1 >= m_keyframe_interval || m_tracker.is_lost();
+    // the tracked objects move, only the motion outside of them may be a new object
+    if (!m_keyframe && m_motion_thr < 1) {
+        m_keyframe = m_motion.get_motion(img, m_tracker.get_tracks()) > m_motion_thr;
+    }
+
+    if (!m_keyframe) {
+        m_frame_num++;
+        return m_tracker.predict(img.width, img.height);
+    }
+    m_frame_num = 0;
+    std::list<track_t> &tracks = m_tracker.update(m_detect->run(img), img.width, img.height);
+    m_motion.set_reference(img, tracks);
+    return tracks;
+}
+} // namespace detect
+} // namespace dl
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "dl_detect_define.hpp"
+#include "dl_image_define.hpp"
+#include <list>
+#include <vector>
+
+namespace dl {
+namespace detect {
+typedef struct {
+    int id;               /*!< Track id, from 1, stable while the object is tracked */
+    int category;         /*!< category index */
+    float score;          /*!< score of the last detection of the track */
+    std::vector<int> box; /*!< [left_up_x, left_up_y, right_down_x, right_down_y], predicted between the detections */
+    int hits;             /*!< Number of detections of the track */
+    int age;              /*!< Number of frames since the first detection of the track */
+} track_t;
+
+/**
+ * @brief SORT like tracker, which gives the boxes of a detector stable ids and predicts them between the detections.
+ *
+ * Each track is a constant velocity Kalman filter of the center, the area and the aspect ratio of its box. The noise is
+ * diagonal, so the filter is run as an independent position/velocity filter for each of them. update() matches the
+ * detections of a frame to the predicted tracks by IoU, the best pair first, and predict() moves the tracks on the
+ * frames without detection. The detections need not be on consecutive frames: with one detection every N frames the
+ * velocities are still per frame.
+ *
+ * A track is reported once it has min_hits detections, and while it is detected. It is removed after max_misses
+ * detection frames without a detection, or when it leaves the image.
+ */
+class Tracker {
+public:
+    /**
+     * @brief Construct a new Tracker object.
+     *
+     * @param iou_thr     A detection and a track are matched above this IoU
+     * @param min_hits    A track is reported from this number of detections
+     * @param max_misses  A track is removed after this number of detection frames without a detection
+     */
+    Tracker(float iou_thr = 0.3, int min_hits = 2, int max_misses = 2);
+
+    /**
+     * @brief Remove all the tracks. The ids continue from the last one.
+     */
+    void reset();
+
+    /**
+     * @brief Track the detections of a frame.
+     *
+     * @param detections  Detected boxes of the frame
+     * @param width       Width of the image
+     * @param height      Height of the image
+     * @return The tracks detected in this frame
+     */
+    std::list<track_t> &update(const std::list<result_t> &detections, int width, int height);
+
+    /**
+     * @brief Move the tracks to a frame without detection.
+     *
+     * @param width   Width of the image
+     * @param height  Height of the image
+     * @return The predicted tracks
+     */
+    std::list<track_t> &predict(int width, int height);
+
+    /**
+     * @brief Whether a track was lost since the last update(): it was not detected, or it left the image.
+     *
+     * @return true if the next frame should be a detection frame
+     */
+    bool is_lost() { return m_lost; }
+
+    /**
+     * @brief Get the tracks of the last frame, as returned by update() or predict().
+     *
+     * @return The tracks
+     */
+    std::list<track_t> &get_tracks() { return m_result; }
+
+    void set_iou_thr(float iou_thr) { m_iou_thr = iou_thr; }
+    void set_min_hits(int min_hits) { m_min_hits = min_hits; }
+    void set_max_misses(int max_misses) { m_max_misses = max_misses; }
+
+private:
+    typedef struct {
+        float x;  /*!< Position */
+        float v;  /*!< Velocity, per frame */
+        float pp; /*!< Variance of the position */
+        float pv; /*!< Covariance of the position and the velocity */
+        float vv; /*!< Variance of the velocity */
+    } kalman_t;
+
+    typedef struct {
+        int id;
+        int category;
+        float score;
+        int hits;
+        int misses;     /*!< Number of detection frames since the last detection */
+        int age;
+        kalman_t cx;    /*!< Center x */
+        kalman_t cy;    /*!< Center y */
+        kalman_t area;  /*!< Area */
+        kalman_t ratio; /*!< Width / height, without velocity */
+        int box[4];     /*!< The box of the state */
+    } state_t;
+
+    float m_iou_thr;
+    int m_min_hits;
+    int m_max_misses;
+    int m_next_id;                              /*!< Id of the next track */
+    bool m_lost;                                /*!< A track was lost since the last update */
+    std::vector<state_t> m_tracks;              /*!< All the tracks, reported or not */
+    std::list<track_t> m_result;                /*!< The reported tracks of the last frame */
+    std::vector<const result_t *> m_detections; /*!< The detections of the frame */
+    std::vector<float> m_iou;                   /*!< IoU of each track with each detection */
+    std::vector<int> m_pairs;                   /*!< Track and detection pairs above m_iou_thr, best IoU first */
+    std::vector<int> m_matched;                 /*!< Track matched to each detection, -1 if none */
+    std::vector<uint8_t> m_detected;            /*!< The track is matched to a detection */
+
+    static void kalman_init(kalman_t &kalman, float x, float init_vel_var);
+    static void kalman_predict(kalman_t &kalman, float pos_noise, float vel_noise);
+    static void kalman_correct(kalman_t &kalman, float z, float measure_noise);
+    void init_state(state_t &state, const result_t &det);
+    void predict_state(state_t &state);
+    void correct_state(state_t &state, const result_t &det);
+    void remove_outside(int width, int height);
+    void get_result(int width, int height);
+};
+
+/**
+ * @brief Motion of a camera between two frames, from a small luma thumbnail of them.
+ *
+ * The thumbnail samples THUMB_WIDTH x THUMB_HEIGHT pixels of the frame, so the motion costs about a microsecond per
+ * thousand cells whatever the size of the frame. The motion is the fraction of the cells whose luma changed by more
+ * than diff_thr since the reference frame, the cells covered by the masked boxes excluded.
+ */
+class MotionDetector {
+public:
+    static constexpr int THUMB_WIDTH = 32;
+    static constexpr int THUMB_HEIGHT = 24;
+
+    /**
+     * @brief Construct a new MotionDetector object.
+     *
+     * @param diff_thr  A cell changed if its luma changed by more than diff_thr, 0 ~ 255
+     * @param caps      DL_IMAGE_CAP_RGB565_BIG_ENDIAN if the RGB565 frames are big endian
+     */
+    MotionDetector(int diff_thr = 24, int caps = 0);
+
+    /**
+     * @brief Take a frame as the reference of the motion.
+     *
+     * @param img    An RGB888, RGB565 or gray frame
+     * @param masks  The motion in these boxes is ignored until the next reference frame, the objects they hold move
+     *               away from them
+     */
+    void set_reference(const dl::image::img_t &img, const std::list<track_t> &masks);
+
+    /**
+     * @brief Get the motion of a frame since the reference frame.
+     *
+     * @param img    A frame of the same size as the reference frame
+     * @param masks  The motion in these boxes is ignored, [x1, y1, x2, y2] in the frame
+     * @return Fraction of the cells which changed, 0 ~ 1. 0 if there is no reference frame, or if the pixel type is not
+     * supported.
+     */
+    float get_motion(const dl::image::img_t &img, const std::list<track_t> &masks);
+
+private:
+    int m_diff_thr;
+    int m_caps;
+    bool m_has_reference;
+    uint8_t m_reference[THUMB_WIDTH * THUMB_HEIGHT];      /*!< Luma thumbnail of the reference frame */
+    uint8_t m_thumb[THUMB_WIDTH * THUMB_HEIGHT];          /*!< Luma thumbnail of the current frame */
+    uint8_t m_reference_mask[THUMB_WIDTH * THUMB_HEIGHT]; /*!< 1 for the cells masked in the reference frame */
+    uint8_t m_mask[THUMB_WIDTH * THUMB_HEIGHT];           /*!< 1 for the masked cells */
+
+    bool get_thumb(const dl::image::img_t &img, uint8_t *thumb);
+    void set_mask(const std::list<track_t> &masks, int width, int height, uint8_t *mask);
+};
+} // namespace detect
+} // namespace dl
@@ -32,34 +32,44 @@ void yolo11PostProcessor::parse_stage(TensorBase *score, TensorBase *box, const
 
     for (size_t y = 0; y < H; y++) {
         for (size_t x = 0; x < W; x++) {
+            // the box of a location is decoded once, for the first category above the threshold
+            bool box_decoded = false;
+            int box_coord[4];
             for (size_t c = 0; c < C; c++) {
                 if (*score_ptr > score_thr_quant) {
-                    int center_y = y * stride_y + offset_y;
-                    int center_x = x * stride_x + offset_x;
+                    if (!box_decoded) {
+                        int center_y = y * stride_y + offset_y;
+                        int center_x = x * stride_x + offset_x;
 
-                    float box_data[reg_max * 4];
-                    for (int i = 0; i < reg_max * 4; i++) {
-                        box_data[i] = dequantize(box_ptr[i], box_exp);
-                    }
-
-                    result_t new_box = {
-                        (int)c,
-                        dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                        {(int)(((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) - border_left) *
-                               inv_resize_scale_x),
-                         (int)(((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) -
-                                border_top) *
-                               inv_resize_scale_y),
-                         (int)(((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) -
-                                border_left) *
-                               inv_resize_scale_x),
-                         (int)(((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) -
-                                border_top) *
-                               inv_resize_scale_y)},
-                        {}};
+                        float box_data[reg_max * 4];
+                        for (int i = 0; i < reg_max * 4; i++) {
+                            box_data[i] = dequantize(box_ptr[i], box_exp);
+                        }
 
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        box_coord[0] =
+                            (int)(((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) -
+                                   border_left) *
+                                  inv_resize_scale_x);
+                        box_coord[1] =
+                            (int)(((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) -
+                                   border_top) *
+                                  inv_resize_scale_y);
+                        box_coord[2] =
+                            (int)(((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) -
+                                   border_left) *
+                                  inv_resize_scale_x);
+                        box_coord[3] =
+                            (int)(((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) -
+                                   border_top) *
+                                  inv_resize_scale_y);
+                        box_decoded = true;
+                    }
+                    m_candidates.add((int)c,
+                                     dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
+                                     box_coord[0],
+                                     box_coord[1],
+                                     box_coord[2],
+                                     box_coord[3]);
                 }
                 score_ptr++;
             }
@@ -52,7 +52,7 @@ void yolo11posePostProcessor::parse_stage(TensorBase *score, TensorBase *box, Te
                         box_data[i] = dequantize(box_ptr[i], box_exp);
                     }
 
-                    std::vector<int> keypoints_vec(coco_kpt_res_total);
+                    int keypoints[coco_kpt_res_total];
                     for (int k = 0; k < coco_kpt_num; k++) {
                         int idx = k * coco_kpt_ch;
                         float kpt_x = dequantize(kpt_ptr[idx], kpt_exp);
@@ -60,35 +60,32 @@ void yolo11posePostProcessor::parse_stage(TensorBase *score, TensorBase *box, Te
                         float kpt_conf = dequantize(kpt_ptr[idx + 2], kpt_exp);
 
                         if (kpt_conf >= coco_kpt_conf_th) {
-                            keypoints_vec[2 * k] = static_cast<int>(
+                            keypoints[2 * k] = static_cast<int>(
                                 ((kpt_x * 2.0 * stride_x + (center_x - offset_x)) - border_left) * inv_resize_scale_x);
-                            keypoints_vec[2 * k + 1] = static_cast<int>(
+                            keypoints[2 * k + 1] = static_cast<int>(
                                 ((kpt_y * 2.0 * stride_y + (center_y - offset_y)) - border_top) * inv_resize_scale_y);
                         } else {
-                            keypoints_vec[2 * k] = 0;
-                            keypoints_vec[2 * k + 1] = 0;
+                            keypoints[2 * k] = 0;
+                            keypoints[2 * k + 1] = 0;
                         }
                     }
 
-                    result_t new_box = {
+                    m_candidates.add(
                         (int)c,
                         dl::math::sigmoid(dequantize(*score_ptr, score_exp)),
-                        {(int)(((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) - border_left) *
-                               inv_resize_scale_x),
-                         (int)(((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) -
-                                border_top) *
-                               inv_resize_scale_y),
-                         (int)(((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) -
-                                border_left) *
-                               inv_resize_scale_x),
-                         (int)(((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) -
-                                border_top) *
-                               inv_resize_scale_y)},
-                        keypoints_vec,
-                    };
-
-                    m_box_list.insert(std::upper_bound(m_box_list.begin(), m_box_list.end(), new_box, greater_box),
-                                      new_box);
+                        (int)(((center_x - dl::math::dfl_integral(box_data, reg_max - 1) * stride_x) - border_left) *
+                              inv_resize_scale_x),
+                        (int)(((center_y - dl::math::dfl_integral(box_data + reg_max, reg_max - 1) * stride_y) -
+                               border_top) *
+                              inv_resize_scale_y),
+                        (int)(((center_x + dl::math::dfl_integral(box_data + 2 * reg_max, reg_max - 1) * stride_x) -
+                               border_left) *
+                              inv_resize_scale_x),
+                        (int)(((center_y + dl::math::dfl_integral(box_data + 3 * reg_max, reg_max - 1) * stride_y) -
+                               border_top) *
+                              inv_resize_scale_y),
+                        keypoints,
+                        coco_kpt_res_total);
                 }
                 score_ptr++;
             }
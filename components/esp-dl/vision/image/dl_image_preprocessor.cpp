@@ -11,7 +11,10 @@ ImagePreprocessor::ImagePreprocessor(Model *model,
                                      const std::vector<float> &std,
                                      uint32_t caps,
                                      const std::string &input_name) :
-    m_letter_box(false)
+    m_caps(caps),
+    m_letter_box(false),
+    m_src_width(0),
+    m_src_height(0)
 {
     m_model_input = model->get_input(input_name);
     assert(m_model_input->dtype == DATA_TYPE_INT8 || m_model_input->dtype == DATA_TYPE_INT16);
@@ -27,6 +30,13 @@ ImagePreprocessor::ImagePreprocessor(Model *model,
         mean, std, m_model_input->exponent, quant_type);
 }
 
+ImagePreprocessor::~ImagePreprocessor()
+{
+#if CONFIG_SOC_PPA_SUPPORTED
+    heap_caps_free(m_ppa_img.data);
+#endif
+}
+
 void ImagePreprocessor::enable_letterbox(const std::vector<uint8_t> &bg_value)
 {
     auto &norm_quant_wrapper = m_image_transformer.get_norm_quant_wrapper();
@@ -69,28 +79,48 @@ void ImagePreprocessor::enable_letterbox(const std::vector<uint8_t> &bg_value)
         }
     }
     m_letter_box = true;
+    m_src_width = 0;
+    m_src_height = 0;
 }
 
+#if CONFIG_SOC_PPA_SUPPORTED
+void ImagePreprocessor::enable_ppa(ppa_client_handle_t ppa_handle)
+{
+    m_ppa_handle = ppa_handle;
+    m_ppa_used = false;
+}
+#endif
+
 float ImagePreprocessor::get_resize_scale_x(bool inv)
 {
+#if CONFIG_SOC_PPA_SUPPORTED
+    if (m_ppa_used) {
+        float scale = m_image_transformer.get_scale_x() * m_ppa_scale_x;
+        return inv ? 1.f / scale : scale;
+    }
+#endif
     return m_image_transformer.get_scale_x(inv);
 }
 
 float ImagePreprocessor::get_resize_scale_y(bool inv)
 {
+#if CONFIG_SOC_PPA_SUPPORTED
+    if (m_ppa_used) {
+        float scale = m_image_transformer.get_scale_y() * m_ppa_scale_y;
+        return inv ? 1.f / scale : scale;
+    }
+#endif
     return m_image_transformer.get_scale_y(inv);
 }
 
 int ImagePreprocessor::get_crop_area_top_left_x()
 {
-    auto crop_area = m_image_transformer.get_src_img_crop_area();
-    return crop_area.empty() ? 0 : crop_area[0];
+    return m_crop_area.empty() ? 0 : m_crop_area[0];
 }
 
 int ImagePreprocessor::get_crop_area_top_left_y()
 {
-    auto crop_area = m_image_transformer.get_src_img_crop_area();
-    return crop_area.empty() ? 0 : crop_area[1];
+    return m_crop_area.empty() ? 0 : m_crop_area[1];
 }
 
 int ImagePreprocessor::get_border_top()
@@ -110,37 +140,110 @@ TensorBase *ImagePreprocessor::get_model_input()
     return m_model_input;
 }
 
+void ImagePreprocessor::update_letterbox(int src_width, int src_height)
+{
+    auto &dst_img = m_image_transformer.get_dst_img();
+    float scale_x = (float)dst_img.width / (float)src_width;
+    float scale_y = (float)dst_img.height / (float)src_height;
+    float scale = std::min(scale_x, scale_y);
+    int border_top = 0, border_bottom = 0, border_left = 0, border_right = 0;
+    if (scale_x < scale_y) {
+        int pad_h = dst_img.height - (int)(scale * src_height);
+        border_top = pad_h / 2;
+        border_bottom = pad_h - border_top;
+    } else {
+        int pad_w = dst_img.width - (int)(scale * src_width);
+        border_left = pad_w / 2;
+        border_right = pad_w - border_left;
+    }
+    m_image_transformer.set_dst_img_border({border_top, border_bottom, border_left, border_right});
+}
+
 void ImagePreprocessor::preprocess(const img_t &img, const std::vector<int> &crop_area)
 {
+    int src_width = crop_area.empty() ? img.width : (crop_area[2] - crop_area[0]);
+    int src_height = crop_area.empty() ? img.height : (crop_area[3] - crop_area[1]);
     if (m_letter_box) {
-        auto &last_src_img = m_image_transformer.get_src_img();
-        if (img.height != last_src_img.height || img.width != last_src_img.width ||
-            crop_area != m_image_transformer.get_src_img_crop_area()) {
-            auto &dst_img = m_image_transformer.get_dst_img();
-            int src_width = crop_area.empty() ? img.width : (crop_area[2] - crop_area[0]);
-            int src_height = crop_area.empty() ? img.height : (crop_area[3] - crop_area[1]);
-            float scale_x = (float)dst_img.width / (float)src_width;
-            float scale_y = (float)dst_img.height / (float)src_height;
-            float scale = std::min(scale_x, scale_y);
-            int border_top = 0, border_bottom = 0, border_left = 0, border_right = 0;
-            if (scale_x < scale_y) {
-                int pad_h = dst_img.height - (int)(scale * src_height);
-                border_top = pad_h / 2;
-                border_bottom = pad_h - border_top;
-            } else {
-                int pad_w = dst_img.width - (int)(scale * src_width);
-                border_left = pad_w / 2;
-                border_right = pad_w - border_left;
-            }
-            m_image_transformer.set_dst_img_border({border_top, border_bottom, border_left, border_right});
+        if (src_width != m_src_width || src_height != m_src_height) {
+            this->update_letterbox(src_width, src_height);
         }
         m_image_transformer.set_bg_value(m_bg_value, false);
     }
+    m_src_width = src_width;
+    m_src_height = src_height;
+    m_crop_area = crop_area;
+#if CONFIG_SOC_PPA_SUPPORTED
+    m_ppa_used = m_ppa_handle && this->preprocess_ppa(img, crop_area);
+    if (m_ppa_used) {
+        return;
+    }
+#endif
     ESP_ERROR_CHECK(m_image_transformer.set_src_img(img).set_src_img_crop_area(crop_area).transform());
 }
 
+#if CONFIG_SOC_PPA_SUPPORTED
+bool ImagePreprocessor::preprocess_ppa(const img_t &img, const std::vector<int> &crop_area)
+{
+    if (img.pix_type != DL_IMAGE_PIX_TYPE_RGB565 && img.pix_type != DL_IMAGE_PIX_TYPE_RGB888) {
+        return false;
+    }
+    const img_t &dst_img = m_image_transformer.get_dst_img();
+    const std::vector<int> &border = m_image_transformer.get_dst_img_border();
+    int dst_width = border.empty() ? dst_img.width : (dst_img.width - border[2] - border[3]);
+    int dst_height = border.empty() ? dst_img.height : (dst_img.height - border[0] - border[1]);
+    float scale_x = (float)dst_width / (float)m_src_width;
+    float scale_y = (float)dst_height / (float)m_src_height;
+    if (!(scale_x >= 0.0625 && scale_x < 256 && scale_y >= 0.0625 && scale_y < 256)) {
+        return false;
+    }
+
+    size_t align = cache_hal_get_cache_line_size(CACHE_LL_LEVEL_EXT_MEM, CACHE_TYPE_DATA);
+    size_t size = align_up(dst_width * dst_height * get_pix_byte_size(img.pix_type), align);
+    if (size > m_ppa_buffer_size) {
+        heap_caps_free(m_ppa_img.data);
+        m_ppa_img.data = heap_caps_aligned_calloc(align, 1, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_DMA);
+        if (!m_ppa_img.data) {
+            m_ppa_img.data = heap_caps_aligned_calloc(align, 1, size, MALLOC_CAP_DEFAULT | MALLOC_CAP_DMA);
+        }
+        m_ppa_buffer_size = m_ppa_img.data ? size : 0;
+        if (!m_ppa_img.data) {
+            return false;
+        }
+    }
+    m_ppa_img.width = dst_width;
+    m_ppa_img.height = dst_height;
+    m_ppa_img.pix_type = img.pix_type;
+    // The PPA scales by steps of 1/16, it fills the top left of the buffer. The CPU resizes the rest of the way while
+    // it converts the pixels.
+    if (resize_ppa(img, m_ppa_img, m_ppa_handle, m_caps, crop_area, &scale_x, &scale_y) != ESP_OK) {
+        return false;
+    }
+    int width = std::min((int)(m_src_width * scale_x), dst_width);
+    int height = std::min((int)(m_src_height * scale_y), dst_height);
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    m_ppa_scale_x = (float)width / (float)m_src_width;
+    m_ppa_scale_y = (float)height / (float)m_src_height;
+
+    // the PPA already swapped the channels and the bytes
+    esp_err_t ret = m_image_transformer.set_src_img(m_ppa_img)
+                        .set_src_img_crop_area({0, 0, width, height})
+                        .set_caps(0)
+                        .transform();
+    m_image_transformer.set_caps(m_caps);
+    ESP_ERROR_CHECK(ret);
+    return true;
+}
+#endif
+
 void ImagePreprocessor::preprocess(const img_t &img, const dl::math::Matrix<float> &M, bool inv)
 {
+    // the getters must not report the crop area or the PPA scale of a previous image
+    m_crop_area.clear();
+#if CONFIG_SOC_PPA_SUPPORTED
+    m_ppa_used = false;
+#endif
     ESP_ERROR_CHECK(m_image_transformer.set_src_img(img).set_warp_affine_matrix(M, inv).transform());
 }
 } // namespace image
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "dl_image_ppa.hpp"
 #include "dl_image_process.hpp"
 #include "dl_model_base.hpp"
 
@@ -12,7 +13,22 @@ public:
                       const std::vector<float> &std,
                       uint32_t caps = 0,
                       const std::string &input_name = "");
+    ~ImagePreprocessor();
+    // owns the buffer of the PPA image
+    ImagePreprocessor(const ImagePreprocessor &) = delete;
+    ImagePreprocessor &operator=(const ImagePreprocessor &) = delete;
     void enable_letterbox(const std::vector<uint8_t> &bg_value);
+#if CONFIG_SOC_PPA_SUPPORTED
+    /**
+     * @brief Scale RGB565/RGB888 images with the PPA before the color conversion and the quantization. The PPA writes
+     * the scaled image into an internal RAM buffer, the CPU only converts it. The PPA scales by steps of 1/16 and
+     * filters the pixels, so the model input is not bit exact with the nearest neighbor resize of the CPU. Images the
+     * PPA can't scale still go through the CPU.
+     *
+     * @param ppa_handle  A PPA client registered for PPA_OPERATION_SRM, nullptr to resize with the CPU again
+     */
+    void enable_ppa(ppa_client_handle_t ppa_handle);
+#endif
     float get_resize_scale_x(bool inv = false);
     float get_resize_scale_y(bool inv = false);
     int get_crop_area_top_left_x();
@@ -20,16 +36,41 @@ public:
     int get_border_top();
     int get_border_left();
     TensorBase *get_model_input();
+    /**
+     * @brief Crop, resize, normalize and quantize the image into the model input in a single pass. The image is read
+     * in place, a camera frame buffer can be passed directly and released once preprocess returns.
+     *
+     * @param img        The image
+     * @param crop_area  left_top_x, left_top_y, bottom_right_x, bottom_right_y, empty for the whole image
+     */
     void preprocess(const img_t &img, const std::vector<int> &crop_area = {});
     void preprocess(const img_t &img, const dl::math::Matrix<float> &M, bool inv = false);
 
 private:
+    void update_letterbox(int src_width, int src_height);
+
     ImageTransformer m_image_transformer;
     TensorBase *m_model_input;
+    uint32_t m_caps;
 
     // for letter box
     bool m_letter_box;
     std::vector<uint8_t> m_bg_value;
+    int m_src_width;              /*!< Width of the cropped area of the last image */
+    int m_src_height;             /*!< Height of the cropped area of the last image */
+    std::vector<int> m_crop_area; /*!< Crop area of the last image */
+
+#if CONFIG_SOC_PPA_SUPPORTED
+    bool preprocess_ppa(const img_t &img, const std::vector<int> &crop_area);
+
+    // for ppa
+    ppa_client_handle_t m_ppa_handle = nullptr;
+    img_t m_ppa_img = {};         /*!< Image scaled by the PPA */
+    size_t m_ppa_buffer_size = 0; /*!< In bytes */
+    bool m_ppa_used = false;      /*!< The last image was scaled by the PPA */
+    float m_ppa_scale_x = 1;      /*!< Scale of the PPA for the last image */
+    float m_ppa_scale_y = 1;      /*!< Scale of the PPA for the last image */
+#endif
 };
 
 } // namespace image
@@ -1,12 +1,17 @@
 #include "dl_recognition_database.hpp"
+#include "dl_base_dotprod.hpp"
+#include "dl_tool.hpp"
+#include <math.h>
 #include <sys/stat.h>
 
 static const char *TAG = "dl::recognition::DataBase";
 
 namespace dl {
 namespace recognition {
-DataBase::DataBase(const std::string &db_path, int feat_len) : m_db_path(db_path)
+DataBase::DataBase(const std::string &db_path, int feat_len, dtype_t dtype) :
+    m_db_path(db_path), m_partition(nullptr), m_mmap(nullptr)
 {
+    init(feat_len, dtype);
     struct stat st;
     if (stat(db_path.c_str(), &st) == 0) {
         load_database_from_storage(feat_len);
@@ -15,9 +20,40 @@ DataBase::DataBase(const std::string &db_path, int feat_len) : m_db_path(db_path
     }
 }
 
+DataBase::DataBase(const esp_partition_t *partition, int feat_len, dtype_t dtype) :
+    m_partition(partition), m_mmap(nullptr)
+{
+    init(feat_len, dtype);
+    // each row is a row header followed by the feature
+    m_stride += sizeof(database_row_meta);
+    load_database_from_partition(feat_len);
+}
+
 DataBase::~DataBase()
 {
     clear_all_feats_in_memory();
+    if (m_mmap) {
+        esp_partition_munmap(m_mmap_handle);
+    }
+    heap_caps_free(m_query);
+}
+
+void DataBase::init(int feat_len, dtype_t dtype)
+{
+    if (dtype != DATA_TYPE_FLOAT && dtype != DATA_TYPE_INT16 && dtype != DATA_TYPE_INT8) {
+        ESP_LOGE(TAG, "Only support float, int16 and int8 features, use float.");
+        dtype = DATA_TYPE_FLOAT;
+    }
+    m_dtype = dtype;
+    m_meta.num_feats_total = 0;
+    m_meta.num_feats_valid = 0;
+    m_meta.feat_len = feat_len;
+    // the int8 dot product loads 16 elements at a time, the padding is 0
+    m_feat_len_aligned = (feat_len + DL_DATABASE_ALIGN - 1) / DL_DATABASE_ALIGN * DL_DATABASE_ALIGN;
+    m_stride = m_feat_len_aligned * dtype_sizeof(m_dtype);
+    m_feats = nullptr;
+    m_capacity = 0;
+    m_query = tool::calloc_aligned(DL_DATABASE_ALIGN, m_feat_len_aligned, dtype_sizeof(m_dtype), MALLOC_CAP_DEFAULT);
 }
 
 esp_err_t DataBase::create_empty_database_in_storage(int feat_len)
@@ -41,8 +77,86 @@ esp_err_t DataBase::create_empty_database_in_storage(int feat_len)
     return ESP_OK;
 }
 
+esp_err_t DataBase::map_partition()
+{
+    esp_err_t ret = esp_partition_mmap(
+        m_partition, 0, m_partition->size, ESP_PARTITION_MMAP_DATA, (const void **)&m_mmap, &m_mmap_handle);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to map the db partition, %s.", esp_err_to_name(ret));
+        m_mmap = nullptr;
+        return ret;
+    }
+    m_feats = (uint8_t *)m_mmap + sizeof(database_partition_meta) + sizeof(database_row_meta);
+    m_capacity = std::min<size_t>((m_partition->size - sizeof(database_partition_meta)) / m_stride, UINT16_MAX - 1);
+    return ESP_OK;
+}
+
+esp_err_t DataBase::create_empty_database_in_partition(size_t used_size)
+{
+    // only the rows written since the partition was erased need to be erased again
+    size_t size = (used_size + m_partition->erase_size - 1) / m_partition->erase_size * m_partition->erase_size;
+    ESP_RETURN_ON_ERROR(esp_partition_erase_range(m_partition, 0, std::min<size_t>(size, m_partition->size)),
+                        TAG,
+                        "Failed to erase db partition.");
+    database_partition_meta meta;
+    memset(&meta, 0xff, sizeof(database_partition_meta));
+    meta.magic = DL_DATABASE_PARTITION_MAGIC;
+    meta.version = DL_DATABASE_PARTITION_VERSION;
+    meta.feat_len = m_meta.feat_len;
+    meta.dtype = m_dtype;
+    meta.row_size = m_stride;
+    ESP_RETURN_ON_ERROR(esp_partition_write(m_partition, 0, &meta, sizeof(database_partition_meta)),
+                        TAG,
+                        "Failed to write db meta data.");
+    return ESP_OK;
+}
+
+esp_err_t DataBase::load_database_from_partition(int feat_len)
+{
+    if (!m_partition || m_partition->size <= sizeof(database_partition_meta) + m_stride) {
+        ESP_LOGE(TAG, "The db partition is too small.");
+        return ESP_FAIL;
+    }
+    ESP_RETURN_ON_ERROR(map_partition(), TAG, "Failed to load db partition.");
+
+    database_partition_meta meta;
+    memcpy(&meta, m_mmap, sizeof(database_partition_meta));
+    if (meta.magic != DL_DATABASE_PARTITION_MAGIC) {
+        ESP_LOGI(TAG, "No db in the partition, format it.");
+        return create_empty_database_in_partition(m_partition->size);
+    }
+    if (meta.version != DL_DATABASE_PARTITION_VERSION || meta.feat_len != feat_len || meta.dtype != m_dtype ||
+        meta.row_size != m_stride) {
+        ESP_LOGE(TAG, "Feature len or type in partition does not match feature len or type in db.");
+        // the rows can't be read, nor written
+        m_capacity = 0;
+        return ESP_FAIL;
+    }
+    for (int i = 0; i < m_capacity; i++) {
+        const database_row_meta *row =
+            (const database_row_meta *)(m_mmap + sizeof(database_partition_meta) + (size_t)i * m_stride);
+        if (row->id == UINT16_MAX) {
+            break;
+        }
+        m_ids.push_back(row->id);
+        m_exponents.push_back(row->exponent);
+        if (row->id) {
+            m_meta.num_feats_valid++;
+        }
+    }
+    m_meta.num_feats_total = m_ids.size();
+    return ESP_OK;
+}
+
 esp_err_t DataBase::clear_all_feats()
 {
+    if (m_partition) {
+        ESP_RETURN_ON_ERROR(create_empty_database_in_partition(sizeof(database_partition_meta) + m_ids.size() * m_stride),
+                            TAG,
+                            "Failed to create empty db in partition.");
+        clear_all_feats_in_memory();
+        return ESP_OK;
+    }
     if (remove(m_db_path.c_str()) == -1) {
         ESP_LOGE(TAG, "Failed to remove db.");
         return ESP_FAIL;
@@ -55,14 +169,94 @@ esp_err_t DataBase::clear_all_feats()
 
 void DataBase::clear_all_feats_in_memory()
 {
-    for (auto it = m_feats.begin(); it != m_feats.end(); it++) {
-        heap_caps_free(it->feat);
+    // the rows of a partition stay mapped
+    if (!m_partition) {
+        heap_caps_free(m_feats);
+        m_feats = nullptr;
+        m_capacity = 0;
     }
-    m_feats.clear();
+    m_ids.clear();
+    m_exponents.clear();
     m_meta.num_feats_total = 0;
     m_meta.num_feats_valid = 0;
 }
 
+esp_err_t DataBase::reserve(int num)
+{
+    if (num <= m_capacity) {
+        return ESP_OK;
+    }
+    int capacity = std::max(num, std::max(m_capacity * 2, 16));
+    uint8_t *feats = (uint8_t *)tool::calloc_aligned(DL_DATABASE_ALIGN, capacity, m_stride, MALLOC_CAP_SPIRAM);
+    if (!feats) {
+        feats = (uint8_t *)tool::calloc_aligned(DL_DATABASE_ALIGN, capacity, m_stride, MALLOC_CAP_DEFAULT);
+    }
+    if (!feats) {
+        ESP_LOGE(TAG, "Failed to allocate memory for %d features.", capacity);
+        return ESP_ERR_NO_MEM;
+    }
+    if (m_feats) {
+        memcpy(feats, m_feats, (size_t)m_ids.size() * m_stride);
+        heap_caps_free(m_feats);
+    }
+    m_feats = feats;
+    m_capacity = capacity;
+    return ESP_OK;
+}
+
+int8_t DataBase::quantize_feat(const float *feat, void *dst)
+{
+    if (m_dtype == DATA_TYPE_FLOAT) {
+        memcpy(dst, feat, m_meta.feat_len * sizeof(float));
+        return 0;
+    }
+    float max_abs = 0;
+    for (int i = 0; i < m_meta.feat_len; i++) {
+        max_abs = std::max(max_abs, fabsf(feat[i]));
+    }
+    // the largest element fits the type. The exponents are bounded so the shift of the dot product stays in
+    // [-30, 30], the elements of a normalized feature of up to 4096 elements don't reach the bounds.
+    int exponent = 0;
+    if (max_abs > 0) {
+        exponent = ceilf(log2f(max_abs / (m_dtype == DATA_TYPE_INT8 ? DL_QUANT8_MAX : DL_QUANT16_MAX)));
+        exponent = DL_CLIP(exponent, -22, 8);
+    }
+    float inv_scale = DL_SCALE(-exponent);
+    if (m_dtype == DATA_TYPE_INT8) {
+        int8_t *ptr = (int8_t *)dst;
+        for (int i = 0; i < m_meta.feat_len; i++) {
+            ptr[i] = quantize<int8_t>(feat[i], inv_scale);
+        }
+    } else {
+        int16_t *ptr = (int16_t *)dst;
+        for (int i = 0; i < m_meta.feat_len; i++) {
+            ptr[i] = quantize<int16_t>(feat[i], inv_scale);
+        }
+    }
+    return exponent;
+}
+
+float DataBase::get_element(int row, int i)
+{
+    uint8_t *feat = get_feat(row);
+    switch (m_dtype) {
+    case DATA_TYPE_INT8:
+        return dequantize<int8_t, float>(((int8_t *)feat)[i], DL_SCALE(m_exponents[row]));
+    case DATA_TYPE_INT16:
+        return dequantize<int16_t, float>(((int16_t *)feat)[i], DL_SCALE(m_exponents[row]));
+    default:
+        return ((float *)feat)[i];
+    }
+}
+
+esp_err_t DataBase::append_feat(uint16_t id, const float *feat)
+{
+    ESP_RETURN_ON_ERROR(reserve(m_ids.size() + 1), TAG, "Failed to append feature.");
+    m_exponents.push_back(quantize_feat(feat, get_feat(m_ids.size())));
+    m_ids.push_back(id);
+    return ESP_OK;
+}
+
 esp_err_t DataBase::load_database_from_storage(int feat_len)
 {
     clear_all_feats_in_memory();
@@ -83,32 +277,45 @@ esp_err_t DataBase::load_database_from_storage(int feat_len)
         fclose(f);
         return ESP_FAIL;
     }
+    if (reserve(m_meta.num_feats_valid) != ESP_OK) {
+        fclose(f);
+        return ESP_FAIL;
+    }
+    // the file keeps the float features, they are quantized as they are loaded
+    float *feat = (float *)malloc(m_meta.feat_len * sizeof(float));
     uint16_t id;
     for (int i = 0; i < m_meta.num_feats_total; i++) {
         size = fread(&id, sizeof(uint16_t), 1, f);
         if (size != 1) {
             ESP_LOGE(TAG, "Failed to read feature id.");
+            free(feat);
             fclose(f);
             return ESP_FAIL;
         }
         if (id == 0) {
             if (fseek(f, sizeof(float) * m_meta.feat_len, SEEK_CUR) != 0) {
                 ESP_LOGE(TAG, "Failed to seek db file.");
+                free(feat);
                 fclose(f);
                 return ESP_FAIL;
             }
             continue;
         }
-        float *feat = (float *)heap_caps_malloc(m_meta.feat_len * sizeof(float), MALLOC_CAP_SPIRAM);
         size = fread(feat, sizeof(float), m_meta.feat_len, f);
         if (size != m_meta.feat_len) {
             ESP_LOGE(TAG, "Failed to read feature data.");
+            free(feat);
+            fclose(f);
+            return ESP_FAIL;
+        }
+        if (append_feat(id, feat) != ESP_OK) {
+            free(feat);
             fclose(f);
             return ESP_FAIL;
         }
-        m_feats.emplace_back(id, feat);
     }
-    if (m_feats.size() != m_meta.num_feats_valid) {
+    free(feat);
+    if (m_ids.size() != m_meta.num_feats_valid) {
         ESP_LOGE(TAG, "Incorrect valid feature num.");
         fclose(f);
         return ESP_FAIL;
@@ -117,6 +324,34 @@ esp_err_t DataBase::load_database_from_storage(int feat_len)
     return ESP_OK;
 }
 
+esp_err_t DataBase::enroll_feat_in_partition(const float *feat)
+{
+    int row = m_ids.size();
+    if (row >= m_capacity) {
+        ESP_LOGE(TAG, "The db partition is full.");
+        return ESP_FAIL;
+    }
+    uint8_t *buf = (uint8_t *)tool::calloc_aligned(DL_DATABASE_ALIGN, 1, m_stride, MALLOC_CAP_DEFAULT);
+    if (!buf) {
+        ESP_LOGE(TAG, "Failed to allocate memory for the row.");
+        return ESP_ERR_NO_MEM;
+    }
+    database_row_meta *meta = (database_row_meta *)buf;
+    memset(meta, 0xff, sizeof(database_row_meta));
+    meta->id = m_meta.num_feats_total + 1;
+    meta->exponent = quantize_feat(feat, buf + sizeof(database_row_meta));
+    esp_err_t ret =
+        esp_partition_write(m_partition, sizeof(database_partition_meta) + (size_t)row * m_stride, buf, m_stride);
+    if (ret == ESP_OK) {
+        m_ids.push_back(meta->id);
+        m_exponents.push_back(meta->exponent);
+    } else {
+        ESP_LOGE(TAG, "Failed to write feature.");
+    }
+    heap_caps_free(buf);
+    return ret;
+}
+
 esp_err_t DataBase::enroll_feat(TensorBase *feat)
 {
     if (feat->dtype != DATA_TYPE_FLOAT) {
@@ -127,10 +362,14 @@ esp_err_t DataBase::enroll_feat(TensorBase *feat)
         ESP_LOGE(TAG, "Feature len to enroll does not match feature len in db.");
         return ESP_FAIL;
     }
-    float *feat_copy = (float *)heap_caps_malloc(m_meta.feat_len * sizeof(float), MALLOC_CAP_SPIRAM);
-    memcpy(feat_copy, feat->data, feat->get_bytes());
-
-    m_feats.emplace_back(m_meta.num_feats_total + 1, feat_copy);
+    if (m_partition) {
+        ESP_RETURN_ON_ERROR(enroll_feat_in_partition((float *)feat->data), TAG, "Failed to enroll feature.");
+        m_meta.num_feats_total++;
+        m_meta.num_feats_valid++;
+        return ESP_OK;
+    }
+    uint16_t id = m_meta.num_feats_total + 1;
+    ESP_RETURN_ON_ERROR(append_feat(id, (float *)feat->data), TAG, "Failed to enroll feature.");
     m_meta.num_feats_total++;
     m_meta.num_feats_valid++;
 
@@ -151,13 +390,13 @@ esp_err_t DataBase::enroll_feat(TensorBase *feat)
         fclose(f);
         return ESP_FAIL;
     }
-    size = fwrite(&m_feats.back().id, sizeof(uint16_t), 1, f);
+    size = fwrite(&id, sizeof(uint16_t), 1, f);
     if (size != 1) {
         ESP_LOGE(TAG, "Failed to write feature id.");
         fclose(f);
         return ESP_FAIL;
     }
-    size = fwrite(m_feats.back().feat, sizeof(float), m_meta.feat_len, f);
+    size = fwrite(feat->data, sizeof(float), m_meta.feat_len, f);
     if (size != m_meta.feat_len) {
         ESP_LOGE(TAG, "Failed to write feature.");
         fclose(f);
@@ -169,22 +408,29 @@ esp_err_t DataBase::enroll_feat(TensorBase *feat)
 
 esp_err_t DataBase::delete_feat(uint16_t id)
 {
-    bool invalid_id = true;
-    for (auto it = m_feats.begin(); it != m_feats.end();) {
-        if (it->id != id) {
-            it++;
-        } else {
-            heap_caps_free(it->feat);
-            it = m_feats.erase(it);
-            m_meta.num_feats_valid--;
-            invalid_id = false;
-            break;
-        }
-    }
-    if (invalid_id) {
+    auto it = id ? std::find(m_ids.begin(), m_ids.end(), id) : m_ids.end();
+    if (it == m_ids.end()) {
         ESP_LOGW(TAG, "Invalid id to delete.");
         return ESP_FAIL;
     }
+    int row = it - m_ids.begin();
+    uint16_t id_invalid = 0;
+    if (m_partition) {
+        // the bits of the id are cleared in place, the row stays in the matrix
+        ESP_RETURN_ON_ERROR(
+            esp_partition_write(
+                m_partition, sizeof(database_partition_meta) + (size_t)row * m_stride, &id_invalid, sizeof(uint16_t)),
+            TAG,
+            "Failed to write feature id.");
+        m_ids[row] = 0;
+        m_meta.num_feats_valid--;
+        return ESP_OK;
+    }
+    memmove(get_feat(row), get_feat(row + 1), (size_t)(m_ids.size() - row - 1) * m_stride);
+    m_ids.erase(it);
+    m_exponents.erase(m_exponents.begin() + row);
+    m_meta.num_feats_valid--;
+
     size_t size = 0;
     FILE *f = fopen(m_db_path.c_str(), "rb+");
     if (!f) {
@@ -192,7 +438,6 @@ esp_err_t DataBase::delete_feat(uint16_t id)
         return ESP_FAIL;
     }
     long int offset = sizeof(database_meta) + (sizeof(uint16_t) + sizeof(float) * m_meta.feat_len) * (id - 1);
-    uint16_t id_invalid = 0;
     if (fseek(f, offset, SEEK_SET) != 0) {
         ESP_LOGE(TAG, "Failed to seek db file.");
         fclose(f);
@@ -223,21 +468,33 @@ esp_err_t DataBase::delete_feat(uint16_t id)
 
 esp_err_t DataBase::delete_last_feat()
 {
-    if (m_feats.empty()) {
-        ESP_LOGW(TAG, "Empty db, nothing to delete");
-        return ESP_FAIL;
+    for (int i = (int)m_ids.size() - 1; i >= 0; i--) {
+        if (m_ids[i]) {
+            return delete_feat(m_ids[i]);
+        }
     }
-    uint16_t id = m_feats.back().id;
-    return delete_feat(id);
+    ESP_LOGW(TAG, "Empty db, nothing to delete");
+    return ESP_FAIL;
 }
 
-float DataBase::cal_similarity(float *feat1, float *feat2)
+float DataBase::cal_similarity(int row, int8_t exponent)
 {
-    float sum = 0;
-    for (int i = 0; i < m_meta.feat_len; i++) {
-        sum += feat1[i] * feat2[i];
+    // the dot product of the quantized features is a int16 of exponent DL_DATABASE_SIM_EXPONENT
+    int shift = DL_DATABASE_SIM_EXPONENT - exponent - m_exponents[row];
+    int16_t sim;
+    switch (m_dtype) {
+    case DATA_TYPE_INT8:
+        base::dotprod((int8_t *)m_query, (int8_t *)get_feat(row), &sim, m_feat_len_aligned, shift);
+        return sim * DL_SCALE(DL_DATABASE_SIM_EXPONENT);
+    case DATA_TYPE_INT16:
+        base::dotprod((int16_t *)m_query, (int16_t *)get_feat(row), &sim, m_feat_len_aligned, shift);
+        return sim * DL_SCALE(DL_DATABASE_SIM_EXPONENT);
+    default: {
+        float sum;
+        base::dotprod((float *)m_query, (float *)get_feat(row), &sum, m_feat_len_aligned);
+        return sum;
+    }
     }
-    return sum;
 }
 
 std::vector<result_t> DataBase::query_feat(TensorBase *feat, float thr, int top_k)
@@ -246,38 +503,55 @@ std::vector<result_t> DataBase::query_feat(TensorBase *feat, float thr, int top_
         ESP_LOGW(TAG, "Top_k should be greater than 0.");
         return {};
     }
+    if (feat->dtype != DATA_TYPE_FLOAT || feat->size != m_meta.feat_len) {
+        ESP_LOGE(TAG, "Feature to query does not match the features in db.");
+        return {};
+    }
+    int8_t exponent = quantize_feat((float *)feat->data, m_query);
+
+    // a min heap of the top_k most similar features
+    auto greater = [](const result_t &a, const result_t &b) -> bool { return a.similarity > b.similarity; };
     std::vector<result_t> results;
+    results.reserve(std::min<size_t>(top_k, m_meta.num_feats_valid));
     float sim;
     int i = 1;
-    for (auto it = m_feats.begin(); it != m_feats.end(); it++, i++) {
-        sim = cal_similarity(it->feat, (float *)feat->data);
-        if (sim <= thr) {
+    for (int row = 0; row < m_ids.size(); row++) {
+        if (!m_ids[row]) {
             continue;
         }
-        // results.emplace_back(it->id, sim);
-        results.emplace_back(i, sim);
-    }
-    std::sort(results.begin(), results.end(), [](const result_t &a, const result_t &b) -> bool {
-        return a.similarity > b.similarity;
-    });
-    if (results.size() > top_k) {
-        results.resize(top_k);
+        sim = cal_similarity(row, exponent);
+        if (sim > thr) {
+            if (results.size() < top_k) {
+                results.push_back({(uint16_t)i, sim});
+                std::push_heap(results.begin(), results.end(), greater);
+            } else if (sim > results.front().similarity) {
+                std::pop_heap(results.begin(), results.end(), greater);
+                results.back() = {(uint16_t)i, sim};
+                std::push_heap(results.begin(), results.end(), greater);
+            }
+        }
+        i++;
     }
+    std::sort_heap(results.begin(), results.end(), greater);
     return results;
 }
 
 void DataBase::print()
 {
     printf("\n");
-    printf("[db meta]\nnum_feats_total: %d, num_feats_valid: %d, feat_len: %d\n",
+    printf("[db meta]\nnum_feats_total: %d, num_feats_valid: %d, feat_len: %d, dtype: %s\n",
            m_meta.num_feats_total,
            m_meta.num_feats_valid,
-           m_meta.feat_len);
+           m_meta.feat_len,
+           dtype_to_string(m_dtype));
     printf("[feats]\n");
-    for (auto it : m_feats) {
-        printf("id: %d feat: ", it.id);
+    for (int row = 0; row < m_ids.size(); row++) {
+        if (!m_ids[row]) {
+            continue;
+        }
+        printf("id: %d feat: ", m_ids[row]);
         for (int i = 0; i < m_meta.feat_len; i++) {
-            printf("%f, ", it.feat[i]);
+            printf("%f, ", get_element(row, i));
         }
         printf("\n");
     }
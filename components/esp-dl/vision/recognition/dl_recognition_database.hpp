@@ -2,33 +2,94 @@
 #include "dl_recognition_define.hpp"
 #include "dl_tensor_base.hpp"
 #include "esp_check.h"
+#include "esp_partition.h"
 #include "esp_system.h"
 #include <algorithm>
-#include <list>
+#include <vector>
 
 namespace dl {
 namespace recognition {
+/**
+ * @brief Features of the enrolled faces.
+ *
+ * The features are the rows of a contiguous matrix, aligned and padded to DL_DATABASE_ALIGN bytes, so the similarity
+ * of a query with the whole database is a run of SIMD dot products over one block of memory. They are kept as float,
+ * or quantized to int8/int16 with an exponent per feature: an int8 database is four times smaller and its dot products
+ * run on the int8 SIMD kernel, the similarities differ from the float ones by about 1e-2.
+ *
+ * The database is either a file, which stays in float and is loaded into RAM, or a flash partition, which holds the
+ * matrix in the chosen type and is read in place through a memory map.
+ */
 class DataBase {
 public:
-    DataBase(const std::string &db_path, int feat_len);
+    /**
+     * @brief Construct a new DataBase object in a file. The file is created if it does not exist.
+     *
+     * @param db_path   Path of the file
+     * @param feat_len  Number of elements of a feature
+     * @param dtype     DATA_TYPE_FLOAT, DATA_TYPE_INT16 or DATA_TYPE_INT8, type of the features in RAM
+     */
+    DataBase(const std::string &db_path, int feat_len, dtype_t dtype = DATA_TYPE_FLOAT);
+
+    /**
+     * @brief Construct a new DataBase object in a flash partition. The partition is formatted if it does not hold a
+     * database.
+     *
+     * @param partition  A data partition, esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+     *                   ESP_PARTITION_SUBTYPE_ANY, label)
+     * @param feat_len   Number of elements of a feature
+     * @param dtype      DATA_TYPE_FLOAT, DATA_TYPE_INT16 or DATA_TYPE_INT8, type of the features in the partition
+     */
+    DataBase(const esp_partition_t *partition, int feat_len, dtype_t dtype = DATA_TYPE_FLOAT);
     virtual ~DataBase();
     esp_err_t clear_all_feats();
     esp_err_t enroll_feat(TensorBase *feat);
     esp_err_t delete_feat(uint16_t id);
     esp_err_t delete_last_feat();
+
+    /**
+     * @brief Find the enrolled features most similar to a feature.
+     *
+     * @param feat   A float feature
+     * @param thr    Only the similarities above thr are returned
+     * @param top_k  Maximum number of results
+     * @return The results, from the most similar. The id is the position of the feature among the valid ones,
+     * from 1.
+     */
     std::vector<result_t> query_feat(TensorBase *feat, float thr, int top_k);
     void print();
     int get_num_feats() { return m_meta.num_feats_valid; }
+    dtype_t get_dtype() { return m_dtype; }
 
 private:
     std::string m_db_path;
-    std::list<database_feat> m_feats;
+    const esp_partition_t *m_partition;       /*!< The partition of the database, nullptr for a file */
+    esp_partition_mmap_handle_t m_mmap_handle; /*!< Memory map of the partition */
+    const uint8_t *m_mmap;                     /*!< Mapped partition, nullptr if not mapped */
     database_meta m_meta;
+    dtype_t m_dtype;                           /*!< Type of the features in the matrix */
+    int m_feat_len_aligned;                    /*!< Number of elements of a row of the matrix, feat_len padded */
+    int m_stride;                              /*!< In bytes. Distance between two features of the matrix */
+    uint8_t *m_feats;                          /*!< The matrix, or the first feature of the mapped partition */
+    int m_capacity;                            /*!< Number of features the matrix can hold */
+    std::vector<uint16_t> m_ids;               /*!< Id of each row of the matrix, 0 if the feature is deleted */
+    std::vector<int8_t> m_exponents;           /*!< Exponent of each row of the matrix, 0 for float */
+    void *m_query;                             /*!< The query feature, in the type of the matrix */
 
+    void init(int feat_len, dtype_t dtype);
     esp_err_t create_empty_database_in_storage(int feat_len);
     esp_err_t load_database_from_storage(int feat_len);
+    esp_err_t map_partition();
+    esp_err_t create_empty_database_in_partition(size_t used_size);
+    esp_err_t load_database_from_partition(int feat_len);
+    esp_err_t enroll_feat_in_partition(const float *feat);
     void clear_all_feats_in_memory();
-    float cal_similarity(float *feat1, float *feat2);
+    esp_err_t reserve(int num);
+    esp_err_t append_feat(uint16_t id, const float *feat);
+    int8_t quantize_feat(const float *feat, void *dst);
+    float get_element(int row, int i);
+    float cal_similarity(int row, int8_t exponent);
+    uint8_t *get_feat(int row) { return m_feats + (size_t)row * m_stride; }
 };
 } // namespace recognition
 } // namespace dl
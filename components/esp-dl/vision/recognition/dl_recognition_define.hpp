@@ -1,6 +1,11 @@
 #pragma once
 #include <cstdint>
 
+#define DL_DATABASE_ALIGN 16                   /*!< Alignment of the features, the SIMD dot product loads 16 bytes */
+#define DL_DATABASE_SIM_EXPONENT -14           /*!< Exponent of the int16 similarity of the quantized features */
+#define DL_DATABASE_PARTITION_MAGIC 0x42444c44 /*!< "DLDB" */
+#define DL_DATABASE_PARTITION_VERSION 1
+
 namespace dl {
 namespace recognition {
 typedef struct {
@@ -19,5 +24,27 @@ typedef struct {
     float similarity;
 } result_t;
 
+/**
+ * @brief Header of a database in a flash partition, the rows follow it.
+ */
+typedef struct {
+    uint32_t magic;      /*!< DL_DATABASE_PARTITION_MAGIC */
+    uint16_t version;    /*!< DL_DATABASE_PARTITION_VERSION */
+    uint16_t feat_len;   /*!< Number of elements of a feature */
+    uint8_t dtype;       /*!< dtype_t of the features */
+    uint8_t reserved[3]; /*!< 0xff */
+    uint32_t row_size;   /*!< In bytes. Row header and feature, a multiple of DL_DATABASE_ALIGN */
+} database_partition_meta;
+
+/**
+ * @brief Header of a row of a database in a flash partition, the feature follows it. The rows are appended in the
+ * erased flash, a row whose id is 0xffff is free, a row whose id is 0 is deleted.
+ */
+typedef struct {
+    uint16_t id;          /*!< Id of the feature */
+    int8_t exponent;      /*!< Exponent of the quantized feature, 0 for float */
+    uint8_t reserved[13]; /*!< 0xff */
+} database_row_meta;
+
 } // namespace recognition
 } // namespace dl
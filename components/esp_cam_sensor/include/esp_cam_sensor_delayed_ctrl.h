@@ -0,0 +1,113 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_cam_sensor_frame_latency.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sensor exposure control latency model handle type
+ *
+ * The model remembers which exposure, gain and frame length were written in which frame, so the
+ * statistics of a frame can be matched with the sensor settings that frame was really captured with.
+ */
+typedef struct esp_cam_sensor_delayed_ctrl *esp_cam_sensor_delayed_ctrl_handle_t;
+
+/**
+ * @brief Sensor exposure control values tracked by the latency model
+ */
+typedef struct {
+    uint32_t exposure_val;          /*!< Exposure in sensor lines */
+    uint32_t gain_index;            /*!< Index of the sensor gain map table */
+    uint32_t vts;                   /*!< Frame length in lines */
+} esp_cam_sensor_ae_ctrl_t;
+
+/**
+ * @brief Sensor exposure control latency model configurations
+ */
+typedef struct {
+    esp_cam_sensor_frame_latency_t latency;    /*!< Control latency reported by the sensor */
+    esp_cam_sensor_ae_ctrl_t init;             /*!< Values in effect when streaming starts */
+} esp_cam_sensor_delayed_ctrl_config_t;
+
+/**
+ * @brief Create a sensor exposure control latency model
+ *
+ * @param[in]  config Latency model configurations
+ * @param[out] ret_handle Returned latency model handle
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ *      - ESP_ERR_NO_MEM: Not enough memory
+ */
+esp_err_t esp_cam_sensor_delayed_ctrl_new(const esp_cam_sensor_delayed_ctrl_config_t *config,
+                                          esp_cam_sensor_delayed_ctrl_handle_t *ret_handle);
+
+/**
+ * @brief Record controls written to the sensor
+ *
+ * @note write_seq is the sequence of the frame in which the sensor latches the group, it is the
+ *       frame following the last frame end seen before the write. Sequences must not go backwards.
+ *
+ * @param[in] handle Latency model handle
+ * @param[in] write_seq Frame sequence the write belongs to
+ * @param[in] ctrl Written controls
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ */
+esp_err_t esp_cam_sensor_delayed_ctrl_push(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t write_seq,
+                                           const esp_cam_sensor_ae_ctrl_t *ctrl);
+
+/**
+ * @brief Get the controls a frame was captured with
+ *
+ * @param[in]  handle Latency model handle
+ * @param[in]  frame_seq Frame sequence
+ * @param[out] ctrl Controls in effect for the frame
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ */
+esp_err_t esp_cam_sensor_delayed_ctrl_get(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t frame_seq,
+                                          esp_cam_sensor_ae_ctrl_t *ctrl);
+
+/**
+ * @brief Check if every pushed control has reached the sensor output by the given frame
+ *
+ * @param[in] handle Latency model handle
+ * @param[in] frame_seq Frame sequence
+ * @return
+ *      - true if the frame was captured with the latest pushed controls
+ */
+bool esp_cam_sensor_delayed_ctrl_settled(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t frame_seq);
+
+/**
+ * @brief Drop the history, used after the sensor format changes or streaming restarts
+ *
+ * @param[in] handle Latency model handle
+ * @param[in] init Values in effect from now on
+ */
+void esp_cam_sensor_delayed_ctrl_reset(esp_cam_sensor_delayed_ctrl_handle_t handle, const esp_cam_sensor_ae_ctrl_t *init);
+
+/**
+ * @brief Delete the latency model
+ *
+ * @param[in] handle Latency model handle
+ * @return
+ *      - ESP_OK: Success
+ */
+esp_err_t esp_cam_sensor_delayed_ctrl_del(esp_cam_sensor_delayed_ctrl_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
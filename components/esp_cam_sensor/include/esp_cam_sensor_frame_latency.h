@@ -0,0 +1,28 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Description of camera sensor control latency
+ *
+ * Each member is the number of frames between the frame in which the register is written and the
+ * first frame captured with the new value. A value written during frame N is used by frame N + latency.
+ */
+typedef struct {
+    uint8_t exposure;     /*!< Exposure latency in frames */
+    uint8_t gain;         /*!< Gain latency in frames */
+    uint8_t vts;          /*!< Frame length latency in frames */
+} esp_cam_sensor_frame_latency_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,147 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Sensor frame timing, the frame rate is changed by stretching the frame length (VTS) only
+ *
+ * The pixel clock and the line length (HTS) are fixed by the format, so a line always lasts the same
+ * time and one frame lasts VTS lines. The longest exposure is a few lines shorter than the frame.
+ */
+typedef struct {
+    uint32_t pclk;              /*!< Pixel clock in Hz, a line lasts HTS pixel clocks */
+    uint32_t hts;               /*!< Line length in pixel clocks */
+    uint32_t vts_min;           /*!< Frame length of the format in lines, the shortest frame the timing allows */
+    uint32_t vts_max;           /*!< Longest frame length the VTS register holds */
+    uint32_t exp_margin;        /*!< Lines between the longest exposure and the frame length */
+} esp_cam_sensor_frame_timing_t;
+
+/**
+ * @brief Get the frame length giving a frame rate
+ *
+ * @note The frame length is rounded up, so the frame rate is never higher than requested, and clamped
+ *       to the timing limits.
+ *
+ * @param[in] timing Frame timing
+ * @param[in] fps Frame rate in frames per second
+ * @return
+ *      - Frame length in lines, 0 if the arguments are invalid
+ */
+uint32_t esp_cam_sensor_frame_timing_vts(const esp_cam_sensor_frame_timing_t *timing, uint32_t fps);
+
+/**
+ * @brief Get the frame rate of a frame length, rounded to the nearest frame per second
+ *
+ * @param[in] timing Frame timing
+ * @param[in] vts Frame length in lines
+ * @return
+ *      - Frame rate in frames per second, 0 if the arguments are invalid
+ */
+uint32_t esp_cam_sensor_frame_timing_fps(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts);
+
+/**
+ * @brief Get the frame rate range of the timing
+ *
+ * @param[in]  timing Frame timing
+ * @param[out] min_fps Lowest frame rate, the longest frame fits in the VTS register
+ * @param[out] max_fps Highest frame rate, the one of the format
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ */
+esp_err_t esp_cam_sensor_frame_timing_fps_range(const esp_cam_sensor_frame_timing_t *timing, uint32_t *min_fps, uint32_t *max_fps);
+
+/**
+ * @brief Get the duration of one line in nanoseconds
+ *
+ * @param[in] timing Frame timing
+ * @return
+ *      - Line duration in nanoseconds, 0 if the arguments are invalid
+ */
+uint32_t esp_cam_sensor_frame_timing_line_ns(const esp_cam_sensor_frame_timing_t *timing);
+
+/**
+ * @brief Get the duration of a frame in microseconds
+ *
+ * @param[in] timing Frame timing
+ * @param[in] vts Frame length in lines
+ * @return
+ *      - Frame duration in microseconds, 0 if the arguments are invalid
+ */
+uint32_t esp_cam_sensor_frame_timing_frame_us(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts);
+
+/**
+ * @brief Get the longest exposure a frame length allows
+ *
+ * @param[in] timing Frame timing
+ * @param[in] vts Frame length in lines
+ * @return
+ *      - Exposure limit in lines
+ */
+uint32_t esp_cam_sensor_frame_timing_exposure_max(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts);
+
+/**
+ * @brief Night mode configurations
+ *
+ * The scene brightness is measured as the exposure the frame would need at 1x gain, exposure time
+ * multiplied by the gain. Night mode is entered when the longest exposure of the day frame rate
+ * needs more than enter_gain, and left once it would need less than exit_gain again.
+ */
+typedef struct {
+    uint32_t day_fps;           /*!< Frame rate in daylight */
+    uint32_t night_fps;         /*!< Frame rate at night, lower than day_fps */
+    uint32_t enter_gain;        /*!< Gain, in 1/1000 steps, above which night mode is entered */
+    uint32_t exit_gain;         /*!< Gain, in 1/1000 steps, below which night mode is left, lower than enter_gain */
+    uint32_t hold_frames;       /*!< Frames a condition must last before the frame rate changes */
+} esp_cam_sensor_night_mode_config_t;
+
+/**
+ * @brief Night mode state
+ */
+typedef struct {
+    esp_cam_sensor_night_mode_config_t config;
+    uint32_t day_exposure_us;   /*!< Longest exposure at the day frame rate */
+    uint32_t count;             /*!< Frames the pending condition has lasted */
+    bool night;                 /*!< Night frame rate in use */
+} esp_cam_sensor_night_mode_t;
+
+/**
+ * @brief Initialize the night mode state, starting at the day frame rate
+ *
+ * @param[out] night Night mode state
+ * @param[in]  config Night mode configurations
+ * @param[in]  timing Frame timing of the current format
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ */
+esp_err_t esp_cam_sensor_night_mode_init(esp_cam_sensor_night_mode_t *night, const esp_cam_sensor_night_mode_config_t *config,
+                                         const esp_cam_sensor_frame_timing_t *timing);
+
+/**
+ * @brief Feed the exposure and gain of a frame
+ *
+ * @note The values must be the ones the frame was captured with, see esp_cam_sensor_delayed_ctrl.
+ *
+ * @param[in] night Night mode state
+ * @param[in] exposure_us Exposure of the frame in microseconds
+ * @param[in] gain Gain of the frame in 1/1000 steps, 1000 is 1x
+ * @return
+ *      - Frame rate to use from now on
+ */
+uint32_t esp_cam_sensor_night_mode_update(esp_cam_sensor_night_mode_t *night, uint32_t exposure_us, uint32_t gain);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,139 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_sccb_intf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Camera sensor register shadow handle type
+ *
+ * @note A NULL handle is accepted by every function below. In that case the calls degrade to plain
+ *       SCCB transactions, so drivers keep working if the shadow could not be allocated.
+ */
+typedef struct esp_cam_sensor_regcache *esp_cam_sensor_regcache_handle_t;
+
+/**
+ * @brief Camera sensor register shadow configurations
+ */
+typedef struct {
+    uint16_t capacity;          /*!< Maximum number of registers tracked, rounded up to a power of 2 */
+} esp_cam_sensor_regcache_config_t;
+
+/**
+ * @brief Camera sensor register shadow statistics
+ */
+typedef struct {
+    uint32_t bus_writes;        /*!< Write transactions issued on the SCCB bus */
+    uint32_t bus_reads;         /*!< Read transactions issued on the SCCB bus */
+    uint32_t elided_writes;     /*!< Writes skipped because the shadow already held the value */
+    uint32_t cached_reads;      /*!< Reads served from the shadow */
+} esp_cam_sensor_regcache_stats_t;
+
+/**
+ * @brief Create a register shadow for one camera sensor device
+ *
+ * @param[in]  config Register shadow configurations
+ * @param[out] ret_handle Returned register shadow handle
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ *      - ESP_ERR_NO_MEM: Not enough memory for the shadow table
+ */
+esp_err_t esp_cam_sensor_regcache_new(const esp_cam_sensor_regcache_config_t *config,
+                                      esp_cam_sensor_regcache_handle_t *ret_handle);
+
+/**
+ * @brief Write a 16-bit address 8-bit value register, skipping the bus if the shadow already holds the value
+ *
+ * @note Only use this for plain configuration registers. Command registers (group hold, soft reset,
+ *       stream on/off) must go through esp_cam_sensor_regcache_write_through_a16v8().
+ *
+ * @param[in] handle Register shadow handle
+ * @param[in] io_handle SCCB IO handle
+ * @param[in] reg Register address
+ * @param[in] val Register value
+ * @return
+ *      - ESP_OK: Success
+ *      - Others: Error returned by the SCCB bus
+ */
+esp_err_t esp_cam_sensor_regcache_write_a16v8(esp_cam_sensor_regcache_handle_t handle, esp_sccb_io_handle_t io_handle,
+                                              uint16_t reg, uint8_t val);
+
+/**
+ * @brief Write a 16-bit address 8-bit value register unconditionally and record the value in the shadow
+ *
+ * @param[in] handle Register shadow handle
+ * @param[in] io_handle SCCB IO handle
+ * @param[in] reg Register address
+ * @param[in] val Register value
+ * @return
+ *      - ESP_OK: Success
+ *      - Others: Error returned by the SCCB bus
+ */
+esp_err_t esp_cam_sensor_regcache_write_through_a16v8(esp_cam_sensor_regcache_handle_t handle,
+                                                      esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val);
+
+/**
+ * @brief Read a 16-bit address 8-bit value register, serving it from the shadow when known
+ *
+ * @note Status registers that the sensor updates by itself must be read with the plain SCCB API.
+ *
+ * @param[in]  handle Register shadow handle
+ * @param[in]  io_handle SCCB IO handle
+ * @param[in]  reg Register address
+ * @param[out] val Register value
+ * @return
+ *      - ESP_OK: Success
+ *      - Others: Error returned by the SCCB bus
+ */
+esp_err_t esp_cam_sensor_regcache_read_a16v8(esp_cam_sensor_regcache_handle_t handle, esp_sccb_io_handle_t io_handle,
+                                             uint16_t reg, uint8_t *val);
+
+/**
+ * @brief Forget every shadowed register, must be called on sensor reset and before loading a new format
+ *
+ * @param[in] handle Register shadow handle
+ */
+void esp_cam_sensor_regcache_invalidate(esp_cam_sensor_regcache_handle_t handle);
+
+/**
+ * @brief Get the bus traffic statistics of the register shadow
+ *
+ * @param[in]  handle Register shadow handle
+ * @param[out] stats Statistics
+ * @return
+ *      - ESP_OK: Success
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ */
+esp_err_t esp_cam_sensor_regcache_get_stats(esp_cam_sensor_regcache_handle_t handle,
+                                            esp_cam_sensor_regcache_stats_t *stats);
+
+/**
+ * @brief Clear the bus traffic statistics of the register shadow
+ *
+ * @param[in] handle Register shadow handle
+ */
+void esp_cam_sensor_regcache_reset_stats(esp_cam_sensor_regcache_handle_t handle);
+
+/**
+ * @brief Delete the register shadow
+ *
+ * @param[in] handle Register shadow handle
+ * @return
+ *      - ESP_OK: Success
+ */
+esp_err_t esp_cam_sensor_regcache_del(esp_cam_sensor_regcache_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Register table entry of a 16-bit address 8-bit value sensor
+ *
+ * @note Layout compatible with the xxx_reginfo_t tables of the a16v8 sensor drivers, so
+ *       esp_cam_sensor_format_t::regs can be passed as is.
+ */
+typedef struct {
+    uint16_t reg;
+    uint8_t val;
+} esp_cam_sensor_reginfo_a16v8_t;
+
+/**
+ * @brief Register delta configurations, describing the table layout of one sensor driver
+ */
+typedef struct {
+    uint16_t end_marker;            /*!< Register address terminating a table */
+    uint16_t delay_marker;          /*!< Register address of a delay entry, the value is in milliseconds */
+    const void *common_regs;        /*!< Table written before every format table (e.g. the reset sequence), may be NULL */
+    const uint16_t *skip_regs;      /*!< Command registers never carried into a delta (soft reset, stream on/off) */
+    size_t skip_regs_num;           /*!< Number of entries in skip_regs */
+} esp_cam_sensor_regdelta_config_t;
+
+/**
+ * @brief Register writes turning the sensor state of one format into another one
+ */
+typedef struct {
+    esp_cam_sensor_reginfo_a16v8_t *regs;  /*!< Writes in target table order terminated by end_marker, NULL if none */
+    size_t regs_num;                        /*!< Register writes in regs, delays and end marker not counted */
+    size_t orphans;                         /*!< Registers set by the current format that the target one leaves alone */
+} esp_cam_sensor_regdelta_t;
+
+/**
+ * @brief Compute the register writes needed to switch a streamed-off sensor from one format to another
+ *
+ * A register is part of the delta when the value the target table leaves it at differs from the value
+ * the current table left it at. Registers written more than once by the target table (PLL power down and
+ * up around a clock change, for instance) are sequencing registers, all their writes are kept in place
+ * whenever the delta is not empty.
+ *
+ * @note A register set by the current table but not by the target one would only get back to its reset
+ *       value with a full reload. In that case no delta is returned and the caller must reset the sensor
+ *       and write the full target table.
+ *
+ * @param[in]  config Register table layout of the sensor
+ * @param[in]  cur_regs Table of the format currently loaded in the sensor
+ * @param[in]  new_regs Table of the target format
+ * @param[out] delta Returned delta, release it with esp_cam_sensor_regdelta_free()
+ * @return
+ *      - ESP_OK: Success, delta->regs_num may be 0 if both formats leave the sensor in the same state
+ *      - ESP_ERR_INVALID_ARG: Error in the passed arguments
+ *      - ESP_ERR_NOT_SUPPORTED: The switch needs a full reload, delta->orphans tells why
+ *      - ESP_ERR_NO_MEM: Not enough memory
+ */
+esp_err_t esp_cam_sensor_regdelta_compute(const esp_cam_sensor_regdelta_config_t *config, const void *cur_regs,
+                                          const void *new_regs, esp_cam_sensor_regdelta_t *delta);
+
+/**
+ * @brief Release the writes of a register delta
+ *
+ * @param[in] delta Register delta
+ */
+void esp_cam_sensor_regdelta_free(esp_cam_sensor_regdelta_t *delta);
+
+#ifdef __cplusplus
+}
+#endif
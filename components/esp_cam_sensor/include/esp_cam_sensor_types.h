@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include "esp_sccb_intf.h"
 #include "driver/gpio.h"
+#include "esp_cam_sensor_frame_latency.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -164,6 +165,7 @@ typedef enum {
 #define ESP_CAM_SENSOR_AE_FLICKER                   ESP_CAM_SENSOR_CLASS_ID(ESP_CAM_SENSOR_CID_CLASS_3A, 0x19)  /*!< Anti banding flicker */
 #define ESP_CAM_SENSOR_GROUP_EXP_GAIN               ESP_CAM_SENSOR_CLASS_ID(ESP_CAM_SENSOR_CID_CLASS_3A, 0x1a)  /*!< Pack a group of (exposure and gain)registers to be effective at a specific time */
 #define ESP_CAM_SENSOR_EXPOSURE_US                  ESP_CAM_SENSOR_CLASS_ID(ESP_CAM_SENSOR_CID_CLASS_3A, 0x1b)  /*!< Exposure time in us(microseconds) */
+#define ESP_CAM_SENSOR_FRAME_LATENCY                ESP_CAM_SENSOR_CLASS_ID(ESP_CAM_SENSOR_CID_CLASS_3A, 0x1c)  /*!< Frames between writing exposure/gain/VTS registers and the first frame captured with them, read only */
 #define ESP_CAM_SENSOR_AUTO_N_PRESET_WB             ESP_CAM_SENSOR_CLASS_ID(ESP_CAM_SENSOR_CID_CLASS_3A, 0x20)  /*!< Pre set white balance mode when automatic white balance is not enabled */
 
 /**
@@ -464,6 +466,7 @@ typedef struct {
     uint32_t exposure_us; /*!< Exposure time in us, 0 if not used */
     uint32_t exposure_val; /*!< Exposure value, 0 if not used */
     uint32_t gain_index;  /*!< the index of gain map table */
+    uint32_t vts;         /*!< Frame length in lines, 0 to keep the current frame length */
 } esp_cam_sensor_gh_exp_gain_t;
 
 #ifdef __cplusplus
@@ -13,6 +13,9 @@
  
  #include "esp_cam_sensor.h"
  #include "esp_cam_sensor_detect.h"
+#include "esp_cam_sensor_regcache.h"
+#include "esp_cam_sensor_regdelta.h"
+#include "esp_cam_sensor_frame_timing.h"
  #include "ov02c10_settings.h"
  #include "ov02c10.h"
 
@@ -26,6 +29,7 @@ typedef struct {
     uint32_t exposure_val;
     uint32_t exposure_max;
     uint32_t gain_index; // current gain index
+    uint32_t vts;
 
     uint32_t vflip_en : 1;
     uint32_t hmirror_en : 1;
@@ -33,10 +37,25 @@ typedef struct {
 
 struct ov02c10_cam {
     ov02c10_para_t ov02c10_para;
+    esp_cam_sensor_regcache_handle_t regcache;  /*!< Shadow of the registers written to the sensor */
+    const esp_cam_sensor_format_t *loaded_format; /*!< Format whose table the sensor holds, NULL once reset */
 };
 
-#define OV02C10_VTS_MAX          0x46c // Max exposure is VTS-15
-#define OV02C10_EXP_MAX_OFFSET   0x0f
+#define OV02C10_REGCACHE(dev) (((struct ov02c10_cam *)(dev)->priv)->regcache)
+#define OV02C10_LOADED_FORMAT(dev) (((struct ov02c10_cam *)(dev)->priv)->loaded_format)
+
+/* Soft reset and streaming are never part of a format switch delta */
+static const uint16_t s_ov02c10_regdelta_skip[] = {0x0103, OV02C10_REG_SLEEP_MODE};
+
+static const esp_cam_sensor_regdelta_config_t s_ov02c10_regdelta_config = {
+    .end_marker = OV02C10_REG_END,
+    .delay_marker = OV02C10_REG_DELAY,
+    .skip_regs = s_ov02c10_regdelta_skip,
+    .skip_regs_num = ARRAY_SIZE(s_ov02c10_regdelta_skip),
+};
+
+#define OV02C10_VTS_MAX          0x7fff
+#define OV02C10_EXP_MAX_OFFSET   0x0f // Max exposure is VTS-15
 
 // #define OV02C10_FETCH_EXP_M(val)     (((val) >> 4) & 0xFF)
 // #define OV02C10_FETCH_EXP_L(val)     (((val) & 0xF) << 4)
@@ -49,7 +68,12 @@ struct ov02c10_cam {
 
 #define OV02C10_GROUP_HOLD_START        0x00
 #define OV02C10_GROUP_HOLD_END          0x10
-#define OV02C10_GROUP_HOLD_DELAY_FRAMES 0x11
+#define OV02C10_GROUP_HOLD_LAUNCH       0xa0 // Quick launch, the group is applied at the next frame boundary
+
+/* Exposure, gain and VTS written in frame N are used by frame N + 2 */
+#define OV02C10_EXP_LATENCY             2
+#define OV02C10_GAIN_LATENCY            2
+#define OV02C10_VTS_LATENCY             2
  
  #define OV02C10_IO_MUX_LOCK(mux)
  #define OV02C10_IO_MUX_UNLOCK(mux)
@@ -1055,19 +1079,33 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
      return esp_sccb_transmit_receive_reg_a16v8(sccb_handle, reg, read_buf);
  }
  
- static esp_err_t ov02c10_write(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t data)
+ 
+ /* read a configuration register, served from the register shadow when it is known */
+ static esp_err_t ov02c10_read_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t *read_buf)
  {
-     return esp_sccb_transmit_reg_a16v8(sccb_handle, reg, data);
+     return esp_cam_sensor_regcache_read_a16v8(OV02C10_REGCACHE(dev), dev->sccb_handle, reg, read_buf);
  }
- 
+
+ /* write a register unconditionally, keeping the register shadow in sync */
+ static esp_err_t ov02c10_write_through(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
+ {
+     return esp_cam_sensor_regcache_write_through_a16v8(OV02C10_REGCACHE(dev), dev->sccb_handle, reg, data);
+ }
+
+ /* write a configuration register, skipped if the sensor already holds this value */
+ static esp_err_t ov02c10_write_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
+ {
+     return esp_cam_sensor_regcache_write_a16v8(OV02C10_REGCACHE(dev), dev->sccb_handle, reg, data);
+ }
+
  /* write a array of registers */
- static esp_err_t ov02c10_write_array(esp_sccb_io_handle_t sccb_handle, const ov02c10_reginfo_t *regarray)
+ static esp_err_t ov02c10_write_array(esp_cam_sensor_device_t *dev, const ov02c10_reginfo_t *regarray)
  {
      int i = 0;
      esp_err_t ret = ESP_OK;
      while ((ret == ESP_OK) && regarray[i].reg != OV02C10_REG_END) {
          if (regarray[i].reg != OV02C10_REG_DELAY) {
-             ret = ov02c10_write(sccb_handle, regarray[i].reg, regarray[i].val);
+             ret = ov02c10_write_through(dev, regarray[i].reg, regarray[i].val);
          } else {
              delay_ms(regarray[i].val);
          }
@@ -1077,29 +1115,31 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
      return ret;
  }
  
- static esp_err_t ov02c10_set_reg_bits(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
+ static esp_err_t ov02c10_set_reg_bits(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
  {
      esp_err_t ret = ESP_OK;
      uint8_t reg_data = 0;
  
-     ret = ov02c10_read(sccb_handle, reg, &reg_data);
+     ret = ov02c10_read_cached(dev, reg, &reg_data);
      if (ret != ESP_OK) {
          return ret;
      }
      uint8_t mask = ((1 << length) - 1) << offset;
      value = (reg_data & ~mask) | ((value << offset) & mask);
-     ret = ov02c10_write(sccb_handle, reg, value);
+     ret = ov02c10_write_cached(dev, reg, value);
      return ret;
  }
  
  static esp_err_t ov02c10_set_test_pattern(esp_cam_sensor_device_t *dev, int enable)
  {
      ESP_LOGI(TAG,"test color = %d",enable);
-     return ov02c10_set_reg_bits(dev->sccb_handle, 0x4503, 7, 1, enable ? 0x01 : 0x00);
+     return ov02c10_set_reg_bits(dev, 0x4503, 7, 1, enable ? 0x01 : 0x00);
  }
  
  static esp_err_t ov02c10_hw_reset(esp_cam_sensor_device_t *dev)
  {
+     esp_cam_sensor_regcache_invalidate(OV02C10_REGCACHE(dev));
+     OV02C10_LOADED_FORMAT(dev) = NULL;
      if (dev->reset_pin >= 0) {
          gpio_set_level(dev->reset_pin, 0);
          delay_ms(10);
@@ -1111,8 +1151,12 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
  
  static esp_err_t ov02c10_soft_reset(esp_cam_sensor_device_t *dev)
  {
-     esp_err_t ret = ov02c10_set_reg_bits(dev->sccb_handle, 0x0103, 0, 1, 0x01);
+     /* 0x0103 is self-clearing, so it must never be elided by the register shadow */
+     esp_cam_sensor_regcache_invalidate(OV02C10_REGCACHE(dev));
+     OV02C10_LOADED_FORMAT(dev) = NULL;
+     esp_err_t ret = ov02c10_set_reg_bits(dev, 0x0103, 0, 1, 0x01);
      delay_ms(5);
+     esp_cam_sensor_regcache_invalidate(OV02C10_REGCACHE(dev));
      return ret;
  }
  
@@ -1144,21 +1188,21 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
          val |= OV02C10_MIPI_CTRL00_CLOCK_LANE_GATE | OV02C10_MIPI_CTRL00_CLOCK_LANE_DISABLE;
      }
  
-     ret = ov02c10_write(dev->sccb_handle, 0x4800, CONFIG_CAMERA_OV02C10_CSI_LINESYNC_ENABLE ? 0x64 : 0x00);
+     ret = ov02c10_write_through(dev, 0x4800, CONFIG_CAMERA_OV02C10_CSI_LINESYNC_ENABLE ? 0x64 : 0x00);
      ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
  
  #if CONFIG_CAMERA_OV02C10_ISP_AF_ENABLE
-     ret = ov02c10_write(dev->sccb_handle, 0x3002, enable ? 0x01 : 0x00);
+     ret = ov02c10_write_through(dev, 0x3002, enable ? 0x01 : 0x00);
      ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
  
-     ret = ov02c10_write(dev->sccb_handle, 0x3010, enable ? 0x01 : 0x00);
+     ret = ov02c10_write_through(dev, 0x3010, enable ? 0x01 : 0x00);
      ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
  
-     ret = ov02c10_write(dev->sccb_handle, 0x300D, enable ? 0x01 : 0x00);
+     ret = ov02c10_write_through(dev, 0x300D, enable ? 0x01 : 0x00);
      ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
  #endif
  
-     ret = ov02c10_write(dev->sccb_handle, 0x0100, enable ? 0x01 : 0x00);
+     ret = ov02c10_write_through(dev, 0x0100, enable ? 0x01 : 0x00);
      ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
  
      dev->stream_status = enable;
@@ -1169,12 +1213,12 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
  
  static esp_err_t ov02c10_set_mirror(esp_cam_sensor_device_t *dev, int enable)
  {
-     return ov02c10_set_reg_bits(dev->sccb_handle, 0x3821, 1, 1, enable ? 0x01 : 0x00);
+     return ov02c10_set_reg_bits(dev, 0x3821, 1, 1, enable ? 0x01 : 0x00);
  }
  
  static esp_err_t ov02c10_set_vflip(esp_cam_sensor_device_t *dev, int enable)
  {
-     return ov02c10_set_reg_bits(dev->sccb_handle, 0x3820, 1, 1, enable ? 0x01 : 0x00);
+     return ov02c10_set_reg_bits(dev, 0x3820, 1, 1, enable ? 0x01 : 0x00);
  }
  
 //  static esp_err_t ov02c10_set_AE_target(esp_cam_sensor_device_t *dev, int target)
@@ -1216,11 +1260,11 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
     //                    OV02C10_FETCH_EXP_H(value_buf));
 
     ESP_LOGI(TAG,"OV02C10_FETCH_EXP_M(value_buf) = 0x%"PRIx32,OV02C10_FETCH_EXP_M(value_buf));
-    ret = ov02c10_write(dev->sccb_handle,
+    ret = ov02c10_write_cached(dev,
                         OV02C10_REG_SHUTTER_TIME_M,
                         OV02C10_FETCH_EXP_M(value_buf));
     ESP_LOGI(TAG,"OV02C10_FETCH_EXP_M(value_buf) = 0x%"PRIx32,OV02C10_FETCH_EXP_L(value_buf));
-    ret |= ov02c10_write(dev->sccb_handle,
+    ret |= ov02c10_write_cached(dev,
                         OV02C10_REG_SHUTTER_TIME_L,
                         OV02C10_FETCH_EXP_L(value_buf));
     if (ret == ESP_OK) {
@@ -1235,13 +1279,13 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
     struct ov02c10_cam *cam_ov02c10 = (struct ov02c10_cam *)dev->priv;
 
     // ESP_LOGI(TAG, "dgain_fine %" PRIx8 ", dgain_coarse %" PRIx8 ", again_coarse %" PRIx8, ov02c10_gain_map[u32_val].dgain_fine, ov02c10_gain_map[u32_val].dgain_coarse, ov02c10_gain_map[u32_val].analog_gain);
-    ret = ov02c10_write(dev->sccb_handle,
+    ret = ov02c10_write_cached(dev,
                        OV02C10_REG_DIG_FINE_GAIN_H,
                        ov02c10_gain_map[u32_val].dgain_fine);
-    ret |= ov02c10_write(dev->sccb_handle,
+    ret |= ov02c10_write_cached(dev,
                         OV02C10_REG_DIG_COARSE_GAIN,
                         ov02c10_gain_map[u32_val].dgain_coarse);
-    ret |= ov02c10_write(dev->sccb_handle,
+    ret |= ov02c10_write_cached(dev,
                         OV02C10_REG_ANG_COARSE_GAIN,
                         ov02c10_gain_map[u32_val].analog_gain);
     if (ret == ESP_OK) {
@@ -1250,21 +1294,70 @@ static const ov02c10_gain_t ov02c10_gain_map[] = {
     return ret;
 }
 
+ static esp_err_t ov02c10_set_vts(esp_cam_sensor_device_t *dev, uint32_t u32_val)
+{
+    esp_err_t ret;
+    struct ov02c10_cam *cam_ov02c10 = (struct ov02c10_cam *)dev->priv;
+    /* Frames can only be stretched, the format VTS is the shortest frame the timing allows */
+    uint32_t vts = MAX(u32_val, dev->cur_format->isp_info->isp_v1_info.vts);
+    vts = MIN(vts, OV02C10_VTS_MAX);
+
+    ret = ov02c10_write_cached(dev, OV02C10_REG_TOTAL_HEIGHT_H, (vts >> 8) & 0xff);
+    ret |= ov02c10_write_cached(dev, OV02C10_REG_TOTAL_HEIGHT_L, vts & 0xff);
+    if (ret == ESP_OK) {
+        cam_ov02c10->ov02c10_para.vts = vts;
+        cam_ov02c10->ov02c10_para.exposure_max = vts - OV02C10_EXP_MAX_OFFSET;
+    }
+    return ret;
+}
+
+static void ov02c10_get_frame_timing(esp_cam_sensor_device_t *dev, esp_cam_sensor_frame_timing_t *timing)
+{
+    timing->pclk = dev->cur_format->isp_info->isp_v1_info.pclk;
+    timing->hts = dev->cur_format->isp_info->isp_v1_info.hts;
+    timing->vts_min = dev->cur_format->isp_info->isp_v1_info.vts;
+    timing->vts_max = OV02C10_VTS_MAX;
+    timing->exp_margin = OV02C10_EXP_MAX_OFFSET;
+}
+
+static esp_err_t ov02c10_set_fps(esp_cam_sensor_device_t *dev, uint32_t fps)
+{
+    esp_err_t ret;
+    esp_cam_sensor_frame_timing_t timing;
+    struct ov02c10_cam *cam_ov02c10 = (struct ov02c10_cam *)dev->priv;
+
+    ov02c10_get_frame_timing(dev, &timing);
+    uint32_t vts = esp_cam_sensor_frame_timing_vts(&timing, fps);
+    ESP_RETURN_ON_FALSE(vts, ESP_ERR_INVALID_ARG, TAG, "invalid fps %" PRIu32, fps);
+
+    ESP_LOGD(TAG, "set fps %" PRIu32 ", vts %" PRIu32, fps, vts);
+    /* The frame and the exposure it bounds change on the same frame */
+    ret = ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_START);
+    ret |= ov02c10_set_vts(dev, vts);
+    if (cam_ov02c10->ov02c10_para.exposure_val > cam_ov02c10->ov02c10_para.exposure_max) {
+        ret |= ov02c10_set_exp_val(dev, cam_ov02c10->ov02c10_para.exposure_max);
+    }
+    ret |= ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_END);
+    ret |= ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_LAUNCH);
+    return ret;
+}
+
 static esp_err_t ov02c10_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_sensor_param_desc_t *qdesc)
 {
     esp_err_t ret = ESP_OK;
+    struct ov02c10_cam *cam_ov02c10 = (struct ov02c10_cam *)dev->priv;
     switch (qdesc->id) {
     case ESP_CAM_SENSOR_EXPOSURE_VAL:
         qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
         qdesc->number.minimum = s_ov02c10_exp_min;
-        qdesc->number.maximum = dev->cur_format->isp_info->isp_v1_info.vts - OV02C10_EXP_MAX_OFFSET; // max = VTS-6 = height+vblank-6, so when update vblank, exposure_max must be updated
+        qdesc->number.maximum = cam_ov02c10->ov02c10_para.exposure_max; // max = VTS-15, follows the frame rate
         qdesc->number.step = 1;;
         qdesc->default_value = dev->cur_format->isp_info->isp_v1_info.exp_def;
         break;
     case ESP_CAM_SENSOR_EXPOSURE_US:
         qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
         qdesc->number.minimum = EXPOSURE_OV02C10_TO_V4L2(s_ov02c10_exp_min, dev->cur_format);
-        qdesc->number.maximum = EXPOSURE_OV02C10_TO_V4L2((dev->cur_format->isp_info->isp_v1_info.vts - OV02C10_EXP_MAX_OFFSET), dev->cur_format); // max = VTS-6 = height+vblank-6, so when update vblank, exposure_max must be updated
+        qdesc->number.maximum = EXPOSURE_OV02C10_TO_V4L2(cam_ov02c10->ov02c10_para.exposure_max, dev->cur_format); // the line time does not change with VTS
         qdesc->number.step = MAX(EXPOSURE_OV02C10_TO_V4L2(0x01, dev->cur_format), 1);
         qdesc->default_value = EXPOSURE_OV02C10_TO_V4L2((dev->cur_format->isp_info->isp_v1_info.exp_def), dev->cur_format);
         break;
@@ -1274,10 +1367,29 @@ static esp_err_t ov02c10_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_s
         qdesc->enumeration.elements = ov02c10_total_gain_val_map;
         qdesc->default_value = dev->cur_format->isp_info->isp_v1_info.gain_def; // gain index
         break;
+    case ESP_CAM_SENSOR_FPS: {
+        esp_cam_sensor_frame_timing_t timing;
+        uint32_t min_fps;
+        uint32_t max_fps;
+
+        ov02c10_get_frame_timing(dev, &timing);
+        ESP_RETURN_ON_ERROR(esp_cam_sensor_frame_timing_fps_range(&timing, &min_fps, &max_fps), TAG, "invalid timing");
+        qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
+        qdesc->number.minimum = min_fps;
+        qdesc->number.maximum = dev->cur_format->fps;
+        qdesc->number.step = 1;
+        qdesc->default_value = dev->cur_format->fps;
+        break;
+    }
     case ESP_CAM_SENSOR_GROUP_EXP_GAIN:
         qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_U8;
         qdesc->u8.size = sizeof(esp_cam_sensor_gh_exp_gain_t);
         break;
+    case ESP_CAM_SENSOR_FRAME_LATENCY:
+        qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_U8;
+        qdesc->u8.size = sizeof(esp_cam_sensor_frame_latency_t);
+        qdesc->flags = ESP_CAM_SENSOR_PARAM_FLAG_READ_ONLY;
+        break;
     case ESP_CAM_SENSOR_VFLIP:
     case ESP_CAM_SENSOR_HMIRROR:
         qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
@@ -1308,6 +1420,21 @@ static esp_err_t ov02c10_get_para_value(esp_cam_sensor_device_t *dev, uint32_t i
         *(uint32_t *)arg = cam_ov02c10->ov02c10_para.gain_index;
         break;
     }
+    case ESP_CAM_SENSOR_FPS: {
+        esp_cam_sensor_frame_timing_t timing;
+
+        ov02c10_get_frame_timing(dev, &timing);
+        *(uint32_t *)arg = MIN(esp_cam_sensor_frame_timing_fps(&timing, cam_ov02c10->ov02c10_para.vts), dev->cur_format->fps);
+        break;
+    }
+    case ESP_CAM_SENSOR_FRAME_LATENCY: {
+        ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_frame_latency_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
+        esp_cam_sensor_frame_latency_t *latency = (esp_cam_sensor_frame_latency_t *)arg;
+        latency->exposure = OV02C10_EXP_LATENCY;
+        latency->gain = OV02C10_GAIN_LATENCY;
+        latency->vts = OV02C10_VTS_LATENCY;
+        break;
+    }
     default: {
         ret = ESP_ERR_NOT_SUPPORTED;
         break;
@@ -1411,13 +1538,24 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
         break;
     }
     case ESP_CAM_SENSOR_GROUP_EXP_GAIN: {
+        ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_gh_exp_gain_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
         esp_cam_sensor_gh_exp_gain_t *value = (esp_cam_sensor_gh_exp_gain_t *)arg;
-        uint32_t ori_exp = EXPOSURE_V4L2_TO_OV02C10(value->exposure_us, dev->cur_format);
-        ret = ov02c10_write(dev->sccb_handle, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_START);
+        uint32_t ori_exp = value->exposure_val ? value->exposure_val : EXPOSURE_V4L2_TO_OV02C10(value->exposure_us, dev->cur_format);
+        ESP_RETURN_ON_FALSE(value->gain_index < s_limited_gain_index, ESP_ERR_INVALID_ARG, TAG, "invalid gain index");
+        ret = ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_START);
+        /* VTS first, it bounds the exposure */
+        if (value->vts) {
+            ret |= ov02c10_set_vts(dev, value->vts);
+        }
         ret |= ov02c10_set_exp_val(dev, ori_exp);
         ret |= ov02c10_set_total_gain_val(dev, value->gain_index);
-        ret |= ov02c10_write(dev->sccb_handle, OV02C10_REG_GROUP_HOLD_DELAY, OV02C10_GROUP_HOLD_DELAY_FRAMES);
-        ret |= ov02c10_write(dev->sccb_handle, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_END);
+        ret |= ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_END);
+        ret |= ov02c10_write_through(dev, OV02C10_REG_GROUP_HOLD, OV02C10_GROUP_HOLD_LAUNCH);
+        break;
+    }
+    case ESP_CAM_SENSOR_FPS: {
+        uint32_t u32_val = *(uint32_t *)arg;
+        ret = ov02c10_set_fps(dev, u32_val);
         break;
     }
     case ESP_CAM_SENSOR_VFLIP: {
@@ -1472,23 +1610,23 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
      const int bit_div2x_map[] = {2, 2, 2, 2, 2, 2, 2, 2, 4, 2, 5, 2, 2, 2, 2, 2};
      const int sclk_div_map[] = {1, 2, 4, 1};
  
-     ov02c10_read(dev->sccb_handle, 0x3037, &temp1);
+     ov02c10_read_cached(dev, 0x3037, &temp1);
      temp2 = temp1 & 0x0f;
      pre_div02x = pre_div02x_map[temp2];
      temp2 = (temp1 >> 4) & 0x01;
      pll_rdiv = pll_rdiv_map[temp2];
-     ov02c10_read(dev->sccb_handle, 0x3036, &temp1);
+     ov02c10_read_cached(dev, 0x3036, &temp1);
  
      div_cnt7b = temp1;
  
      VCO = xvclk * 2 / pre_div02x * div_cnt7b;
-     ov02c10_read(dev->sccb_handle, 0x3035, &temp1);
+     ov02c10_read_cached(dev, 0x3035, &temp1);
      temp2 = temp1 >> 4;
      sdiv0 = sdiv0_map[temp2];
-     ov02c10_read(dev->sccb_handle, 0x3034, &temp1);
+     ov02c10_read_cached(dev, 0x3034, &temp1);
      temp2 = temp1 & 0x0f;
      bit_div2x = bit_div2x_map[temp2];
-     ov02c10_read(dev->sccb_handle, 0x3106, &temp1);
+     ov02c10_read_cached(dev, 0x3106, &temp1);
      temp2 = (temp1 >> 2) & 0x03;
      sclk_div = sclk_div_map[temp2];
      sysclk = VCO * 2 / sdiv0 / pll_rdiv / bit_div2x / sclk_div;
@@ -1501,8 +1639,8 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
      int hts = 0;
      uint8_t temp1, temp2;
  
-     ov02c10_read(dev->sccb_handle, 0x380c, &temp1);
-     ov02c10_read(dev->sccb_handle, 0x380d, &temp2);
+     ov02c10_read_cached(dev, 0x380c, &temp1);
+     ov02c10_read_cached(dev, 0x380d, &temp2);
      hts = (temp1 << 8) + temp2;
      ESP_LOGI(TAG,"hts = 0x%x",hts);
      return hts;
@@ -1515,8 +1653,8 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
      uint8_t temp1, temp2;
  
      /* total vertical size[15:8] high byte */
-     ov02c10_read(dev->sccb_handle, 0x380e, &temp1);
-     ov02c10_read(dev->sccb_handle, 0x380f, &temp2);
+     ov02c10_read_cached(dev, 0x380e, &temp1);
+     ov02c10_read_cached(dev, 0x380f, &temp2);
  
      vts = (temp1 << 8) + temp2;
      ESP_LOGI(TAG,"vts = 0x%x",vts);
@@ -1587,6 +1725,34 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
 //      return ret;
 //  }
  
+ /* switch from the loaded format writing only the registers that differ, fails if a full reload is needed */
+static esp_err_t ov02c10_write_format_delta(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
+{
+    const esp_cam_sensor_format_t *loaded_format = OV02C10_LOADED_FORMAT(dev);
+    esp_cam_sensor_regdelta_t delta;
+
+    if (!loaded_format) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = esp_cam_sensor_regdelta_compute(&s_ov02c10_regdelta_config, loaded_format->regs, format->regs, &delta);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "%s -> %s needs a full reload (%u orphan regs)", loaded_format->name, format->name,
+                 (unsigned)delta.orphans);
+        return ret;
+    }
+
+    if (delta.regs_num) {
+        ret = ov02c10_write_array(dev, (const ov02c10_reginfo_t *)delta.regs);
+    }
+    ESP_LOGD(TAG, "%s -> %s in %u writes", loaded_format->name, format->name, (unsigned)delta.regs_num);
+    esp_cam_sensor_regdelta_free(&delta);
+    if (ret != ESP_OK) {
+        OV02C10_LOADED_FORMAT(dev) = NULL;
+    }
+    return ret;
+}
+
  static esp_err_t ov02c10_set_format(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
  {
      ESP_CAM_SENSOR_NULL_POINTER_CHECK(TAG, dev);
@@ -1598,18 +1764,33 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
         format = &ov02c10_format_info[CONFIG_CAMERA_OV02C10_MIPI_IF_FORMAT_INDEX_DEFAULT];
     }
 
-    ret = ov02c10_write_array(dev->sccb_handle, (ov02c10_reginfo_t *)format->regs);
+    bool delta_loaded = ov02c10_write_format_delta(dev, format) == ESP_OK;
+    if (!delta_loaded) {
+        // the register shadow is rebuilt from the format table
+        esp_cam_sensor_regcache_invalidate(OV02C10_REGCACHE(dev));
+        ret = ov02c10_write_array(dev, (ov02c10_reginfo_t *)format->regs);
+    }
 
     if (ret != ESP_OK) {
+        cam_ov02c10->loaded_format = NULL;
         ESP_LOGE(TAG, "Set format regs fail");
         return ESP_CAM_SENSOR_ERR_FAILED_SET_FORMAT;
     }
 
+    cam_ov02c10->loaded_format = format;
     dev->cur_format = format;
     // init para
     cam_ov02c10->ov02c10_para.exposure_val = dev->cur_format->isp_info->isp_v1_info.exp_def;
     cam_ov02c10->ov02c10_para.gain_index = dev->cur_format->isp_info->isp_v1_info.gain_def;
     cam_ov02c10->ov02c10_para.exposure_max = dev->cur_format->isp_info->isp_v1_info.vts - OV02C10_EXP_MAX_OFFSET;
+    cam_ov02c10->ov02c10_para.vts = dev->cur_format->isp_info->isp_v1_info.vts;
+
+    if (delta_loaded) {
+        // AE moved these away from the table values, the tables alone cannot tell
+        ret = ov02c10_set_vts(dev, cam_ov02c10->ov02c10_para.vts);
+        ret |= ov02c10_set_exp_val(dev, cam_ov02c10->ov02c10_para.exposure_val);
+        ret |= ov02c10_set_total_gain_val(dev, cam_ov02c10->ov02c10_para.gain_index);
+    }
 
     return ret;
  }
@@ -1645,7 +1826,9 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
          break;
      case ESP_CAM_SENSOR_IOC_S_REG:
          sensor_reg = (esp_cam_sensor_reg_val_t *)arg;
-         ret = ov02c10_write(dev->sccb_handle, sensor_reg->regaddr, sensor_reg->value);
+         ret = ov02c10_write_through(dev, sensor_reg->regaddr, sensor_reg->value);
+         // the sensor no longer matches a format table
+         OV02C10_LOADED_FORMAT(dev) = NULL;
          break;
      case ESP_CAM_SENSOR_IOC_S_STREAM:
          // ret = ov02c10_set_test_pattern(dev, *(int *)arg);
@@ -1740,6 +1923,11 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
  {
      ESP_LOGD(TAG, "del ov02c10 (%p)", dev);
      if (dev) {
+         if (dev->priv) {
+             esp_cam_sensor_regcache_del(OV02C10_REGCACHE(dev));
+             free(dev->priv);
+             dev->priv = NULL;
+         }
          free(dev);
          dev = NULL;
      }
@@ -1781,6 +1969,9 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
         free(dev);
         return NULL;
     }
+    if (esp_cam_sensor_regcache_new(NULL, &cam_ov02c10->regcache) != ESP_OK) {
+        ESP_LOGW(TAG, "register shadow disabled");
+    }
 
     dev->name = (char *)OV02C10_SENSOR_NAME;
     dev->sccb_handle = config->sccb_handle;
@@ -1819,6 +2010,7 @@ static esp_err_t ov02c10_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
 
 err_free_handler:
     ov02c10_power_off(dev);
+    esp_cam_sensor_regcache_del(cam_ov02c10->regcache);
     free(dev->priv);
     free(dev);
 
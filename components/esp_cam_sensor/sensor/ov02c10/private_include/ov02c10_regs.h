@@ -11,7 +11,6 @@ extern "C" {
 #endif
 
 #define OV02C10_REG_GROUP_HOLD              0x3208
-#define OV02C10_REG_GROUP_HOLD_DELAY        0x3800
 
 #define OV02C10_REG_DIG_COARSE_GAIN         0x3509
 #define OV02C10_REG_DIG_FINE_GAIN_H         0x350b
@@ -22,6 +21,9 @@ extern "C" {
 #define OV02C10_REG_SHUTTER_TIME_M          0x3501
 #define OV02C10_REG_SHUTTER_TIME_L          0x3502
 
+#define OV02C10_REG_TOTAL_HEIGHT_H          0x380e
+#define OV02C10_REG_TOTAL_HEIGHT_L          0x380f
+
 #define OV02C10_REG_DELAY            0xeeee
 #define OV02C10_REG_END              0xffff
 #define OV02C10_REG_SENSOR_ID_H      0x300a
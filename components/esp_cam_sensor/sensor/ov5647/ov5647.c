@@ -13,6 +13,9 @@
 
 #include "esp_cam_sensor.h"
 #include "esp_cam_sensor_detect.h"
+#include "esp_cam_sensor_regcache.h"
+#include "esp_cam_sensor_regdelta.h"
+#include "esp_cam_sensor_frame_timing.h"
 #include "ov5647_settings.h"
 #include "ov5647.h"
 
@@ -25,6 +28,27 @@
 #define OV5647_SENSOR_NAME "OV5647"
 #define OV5647_AE_TARGET_DEFAULT (0x36)  // Optimal value (54) - matches working M5Stack implementation
 
+#define OV5647_REG_AEC_PK_MANUAL        0x3503
+#define OV5647_AEC_AGC_AUTO             ((0x3 << 5) | MENU_AG_AE)
+#define OV5647_AEC_AGC_MANUAL           ((0x3 << 5) | 0x03)
+
+#define OV5647_REG_GROUP_HOLD           0x3208
+#define OV5647_GROUP_HOLD_START         0x00
+#define OV5647_GROUP_HOLD_END           0x10
+#define OV5647_GROUP_HOLD_LAUNCH        0xa0 // Quick launch, the group is applied at the next frame boundary
+
+#define OV5647_EXP_MIN                  4
+#define OV5647_EXP_MAX_OFFSET           4    // Max exposure is VTS-4
+#define OV5647_VTS_MAX                  0x7fff
+/* gain_index counts 1/16 steps above 1x, the real gain code is 16 + index */
+#define OV5647_GAIN_CODE_BASE           0x10
+#define OV5647_GAIN_CODE_MAX            0x80 // 8x, keep the noise acceptable
+
+/* Exposure, gain and VTS written in frame N are used by frame N + 2 */
+#define OV5647_EXP_LATENCY              2
+#define OV5647_GAIN_LATENCY             2
+#define OV5647_VTS_LATENCY              2
+
 #ifndef portTICK_RATE_MS
 #define portTICK_RATE_MS portTICK_PERIOD_MS
 #endif
@@ -33,6 +57,37 @@
 
 static const char *TAG = "ov5647";
 
+/* Manual exposure/gain state, only used once the group API has taken over from the on-chip AEC/AGC */
+typedef struct {
+    uint32_t exposure_val;
+    uint32_t gain_index;
+    uint32_t vts;
+    uint32_t format_vts;    // shortest frame of the current format
+    uint32_t format_hts;
+    uint32_t sysclk;        // in 10KHz
+    uint32_t manual_en : 1;
+} ov5647_para_t;
+
+struct ov5647_cam {
+    ov5647_para_t ov5647_para;
+    esp_cam_sensor_regcache_handle_t regcache;  /*!< Shadow of the registers written to the sensor */
+    const esp_cam_sensor_format_t *loaded_format; /*!< Format whose table the sensor holds, NULL once reset */
+};
+
+#define OV5647_REGCACHE(dev) (((struct ov5647_cam *)(dev)->priv)->regcache)
+#define OV5647_LOADED_FORMAT(dev) (((struct ov5647_cam *)(dev)->priv)->loaded_format)
+
+/* Soft reset and streaming are never part of a format switch delta */
+static const uint16_t s_ov5647_regdelta_skip[] = {0x0103, OV5647_REG_SLEEP_MODE};
+
+static const esp_cam_sensor_regdelta_config_t s_ov5647_regdelta_config = {
+    .end_marker = OV5647_REG_END,
+    .delay_marker = OV5647_REG_DELAY,
+    .common_regs = ov5647_mipi_reset_regs,
+    .skip_regs = s_ov5647_regdelta_skip,
+    .skip_regs_num = ARRAY_SIZE(s_ov5647_regdelta_skip),
+};
+
 static const esp_cam_sensor_isp_info_t ov5647_isp_info[] = {
     {
         .isp_v1_info = {
@@ -179,19 +234,32 @@ static esp_err_t ov5647_read(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uin
     return esp_sccb_transmit_receive_reg_a16v8(sccb_handle, reg, read_buf);
 }
 
-static esp_err_t ov5647_write(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t data)
+/* read a configuration register, served from the register shadow when it is known */
+static esp_err_t ov5647_read_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t *read_buf)
+{
+    return esp_cam_sensor_regcache_read_a16v8(OV5647_REGCACHE(dev), dev->sccb_handle, reg, read_buf);
+}
+
+/* write a register unconditionally, keeping the register shadow in sync */
+static esp_err_t ov5647_write_through(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
+{
+    return esp_cam_sensor_regcache_write_through_a16v8(OV5647_REGCACHE(dev), dev->sccb_handle, reg, data);
+}
+
+/* write a configuration register, skipped if the sensor already holds this value */
+static esp_err_t ov5647_write_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
 {
-    return esp_sccb_transmit_reg_a16v8(sccb_handle, reg, data);
+    return esp_cam_sensor_regcache_write_a16v8(OV5647_REGCACHE(dev), dev->sccb_handle, reg, data);
 }
 
 /* write a array of registers */
-static esp_err_t ov5647_write_array(esp_sccb_io_handle_t sccb_handle, const ov5647_reginfo_t *regarray)
+static esp_err_t ov5647_write_array(esp_cam_sensor_device_t *dev, const ov5647_reginfo_t *regarray)
 {
     int i = 0;
     esp_err_t ret = ESP_OK;
     while ((ret == ESP_OK) && regarray[i].reg != OV5647_REG_END) {
         if (regarray[i].reg != OV5647_REG_DELAY) {
-            ret = ov5647_write(sccb_handle, regarray[i].reg, regarray[i].val);
+            ret = ov5647_write_through(dev, regarray[i].reg, regarray[i].val);
         } else {
             delay_ms(regarray[i].val);
         }
@@ -201,28 +269,30 @@ static esp_err_t ov5647_write_array(esp_sccb_io_handle_t sccb_handle, const ov56
     return ret;
 }
 
-static esp_err_t ov5647_set_reg_bits(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
+static esp_err_t ov5647_set_reg_bits(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t offset, uint8_t length, uint8_t value)
 {
     esp_err_t ret = ESP_OK;
     uint8_t reg_data = 0;
 
-    ret = ov5647_read(sccb_handle, reg, &reg_data);
+    ret = ov5647_read_cached(dev, reg, &reg_data);
     if (ret != ESP_OK) {
         return ret;
     }
     uint8_t mask = ((1 << length) - 1) << offset;
     value = (reg_data & ~mask) | ((value << offset) & mask);
-    ret = ov5647_write(sccb_handle, reg, value);
+    ret = ov5647_write_cached(dev, reg, value);
     return ret;
 }
 
 static esp_err_t ov5647_set_test_pattern(esp_cam_sensor_device_t *dev, int enable)
 {
-    return ov5647_set_reg_bits(dev->sccb_handle, 0x503D, 7, 1, enable ? 0x01 : 0x00);
+    return ov5647_set_reg_bits(dev, 0x503D, 7, 1, enable ? 0x01 : 0x00);
 }
 
 static esp_err_t ov5647_hw_reset(esp_cam_sensor_device_t *dev)
 {
+    esp_cam_sensor_regcache_invalidate(OV5647_REGCACHE(dev));
+    OV5647_LOADED_FORMAT(dev) = NULL;
     if (dev->reset_pin >= 0) {
         gpio_set_level(dev->reset_pin, 0);
         delay_ms(10);
@@ -234,8 +304,12 @@ static esp_err_t ov5647_hw_reset(esp_cam_sensor_device_t *dev)
 
 static esp_err_t ov5647_soft_reset(esp_cam_sensor_device_t *dev)
 {
-    esp_err_t ret = ov5647_set_reg_bits(dev->sccb_handle, 0x0103, 0, 1, 0x01);
+    /* 0x0103 is self-clearing, so it must never be elided by the register shadow */
+    esp_cam_sensor_regcache_invalidate(OV5647_REGCACHE(dev));
+    OV5647_LOADED_FORMAT(dev) = NULL;
+    esp_err_t ret = ov5647_set_reg_bits(dev, 0x0103, 0, 1, 0x01);
     delay_ms(5);
+    esp_cam_sensor_regcache_invalidate(OV5647_REGCACHE(dev));
     return ret;
 }
 
@@ -259,13 +333,13 @@ static esp_err_t ov5647_get_sensor_id(esp_cam_sensor_device_t *dev, esp_cam_sens
 static esp_err_t ov5647_gpio0_en_af(esp_cam_sensor_device_t *dev, int enable)
 {
     esp_err_t ret = ESP_OK;
-    ret = ov5647_write(dev->sccb_handle, 0x3002, enable ? 0x01 : 0x00);
+    ret = ov5647_write_through(dev, 0x3002, enable ? 0x01 : 0x00);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
 
-    ret |= ov5647_write(dev->sccb_handle, 0x3010, enable ? 0x01 : 0x00);
+    ret |= ov5647_write_through(dev, 0x3010, enable ? 0x01 : 0x00);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
 
-    ret |= ov5647_write(dev->sccb_handle, 0x300D, enable ? 0x01 : 0x00);
+    ret |= ov5647_write_through(dev, 0x300D, enable ? 0x01 : 0x00);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
     delay_ms(12);
     return ret;
@@ -284,14 +358,14 @@ static esp_err_t ov5647_set_stream(esp_cam_sensor_device_t *dev, int enable)
         val |= OV5647_MIPI_CTRL00_CLOCK_LANE_GATE | OV5647_MIPI_CTRL00_CLOCK_LANE_DISABLE;
     }
 
-    ret = ov5647_write(dev->sccb_handle, 0x4800, CONFIG_CAMERA_OV5647_CSI_LINESYNC_ENABLE ? 0x14 : 0x00);
+    ret = ov5647_write_through(dev, 0x4800, CONFIG_CAMERA_OV5647_CSI_LINESYNC_ENABLE ? 0x14 : 0x00);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
 
 #if CONFIG_CAMERA_OV5647_ENABLE_MOTOR_BY_GPIO0
     ret = ov5647_gpio0_en_af(dev, enable);
 #endif
 
-    ret = ov5647_write(dev->sccb_handle, 0x0100, enable ? 0x01 : 0x00);
+    ret = ov5647_write_through(dev, 0x0100, enable ? 0x01 : 0x00);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write pad out failed");
 
     dev->stream_status = enable;
@@ -302,12 +376,12 @@ static esp_err_t ov5647_set_stream(esp_cam_sensor_device_t *dev, int enable)
 
 static esp_err_t ov5647_set_mirror(esp_cam_sensor_device_t *dev, int enable)
 {
-    return ov5647_set_reg_bits(dev->sccb_handle, 0x3821, 1, 1, enable ? 0x01 : 0x00);
+    return ov5647_set_reg_bits(dev, 0x3821, 1, 1, enable ? 0x01 : 0x00);
 }
 
 static esp_err_t ov5647_set_vflip(esp_cam_sensor_device_t *dev, int enable)
 {
-    return ov5647_set_reg_bits(dev->sccb_handle, 0x3820, 1, 1, enable ? 0x01 : 0x00);
+    return ov5647_set_reg_bits(dev, 0x3820, 1, 1, enable ? 0x01 : 0x00);
 }
 
 static esp_err_t ov5647_set_AE_target(esp_cam_sensor_device_t *dev, int target)
@@ -325,16 +399,105 @@ static esp_err_t ov5647_set_AE_target(esp_cam_sensor_device_t *dev, int target)
 
     fast_low = AE_low >> 1;
 
-    ret |= ov5647_write(dev->sccb_handle, 0x3a0f, AE_high);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a10, AE_low);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a1b, AE_high);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a1e, AE_low);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a11, fast_high);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a1f, fast_low);
+    ret |= ov5647_write_cached(dev, 0x3a0f, AE_high);
+    ret |= ov5647_write_cached(dev, 0x3a10, AE_low);
+    ret |= ov5647_write_cached(dev, 0x3a1b, AE_high);
+    ret |= ov5647_write_cached(dev, 0x3a1e, AE_low);
+    ret |= ov5647_write_cached(dev, 0x3a11, fast_high);
+    ret |= ov5647_write_cached(dev, 0x3a1f, fast_low);
+
+    return ret;
+}
 
+static esp_err_t ov5647_set_group_exp_gain(esp_cam_sensor_device_t *dev, const esp_cam_sensor_gh_exp_gain_t *value)
+{
+    esp_err_t ret;
+    struct ov5647_cam *cam_ov5647 = (struct ov5647_cam *)dev->priv;
+    ov5647_para_t *para = &cam_ov5647->ov5647_para;
+    uint32_t vts = value->vts ? value->vts : para->vts;
+    uint32_t exp_val = value->exposure_val;
+    uint32_t gain_code = OV5647_GAIN_CODE_BASE + value->gain_index;
+
+    ESP_RETURN_ON_FALSE(gain_code <= OV5647_GAIN_CODE_MAX, ESP_ERR_INVALID_ARG, TAG, "invalid gain index");
+    if (!exp_val) {
+        ESP_RETURN_ON_FALSE(para->format_hts, ESP_ERR_INVALID_STATE, TAG, "format not set");
+        /* exposure_us to lines, the sensor outputs sysclk / HTS lines per second */
+        exp_val = (uint32_t)((uint64_t)value->exposure_us * para->sysclk / para->format_hts / 100);
+    }
+    vts = MIN(MAX(vts, para->format_vts), OV5647_VTS_MAX);
+    exp_val = MIN(MAX(exp_val, OV5647_EXP_MIN), vts - OV5647_EXP_MAX_OFFSET);
+
+    ret = ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_START);
+    /* Take exposure and gain away from the on-chip AEC/AGC */
+    ret |= ov5647_write_cached(dev, OV5647_REG_AEC_PK_MANUAL, OV5647_AEC_AGC_MANUAL);
+    ret |= ov5647_write_cached(dev, 0x380e, (vts >> 8) & 0xff);
+    ret |= ov5647_write_cached(dev, 0x380f, vts & 0xff);
+    /*
+     * The on-chip AEC/AGC rewrites exposure and gain while it runs, the register shadow may hold stale values for
+     * them. 4 least significant bits of exposure are fractional part.
+     */
+    ret |= ov5647_write_through(dev, 0x3500, (exp_val >> 12) & 0x0f);
+    ret |= ov5647_write_through(dev, 0x3501, (exp_val >> 4) & 0xff);
+    ret |= ov5647_write_through(dev, 0x3502, (exp_val & 0x0f) << 4);
+    ret |= ov5647_write_through(dev, 0x350a, (gain_code >> 8) & 0x03);
+    ret |= ov5647_write_through(dev, 0x350b, gain_code & 0xff);
+    ret |= ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_END);
+    ret |= ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_LAUNCH);
+    if (ret == ESP_OK) {
+        para->exposure_val = exp_val;
+        para->gain_index = value->gain_index;
+        para->vts = vts;
+        para->manual_en = 1;
+    }
     return ret;
 }
 
+static esp_err_t ov5647_set_bandingfilter(esp_cam_sensor_device_t *dev);
+
+static void ov5647_get_frame_timing(esp_cam_sensor_device_t *dev, esp_cam_sensor_frame_timing_t *timing)
+{
+    const ov5647_para_t *para = &((struct ov5647_cam *)dev->priv)->ov5647_para;
+
+    timing->pclk = para->sysclk * 10000;
+    timing->hts = para->format_hts;
+    timing->vts_min = para->format_vts;
+    timing->vts_max = OV5647_VTS_MAX;
+    timing->exp_margin = OV5647_EXP_MAX_OFFSET;
+}
+
+static esp_err_t ov5647_set_fps(esp_cam_sensor_device_t *dev, uint32_t fps)
+{
+    esp_err_t ret;
+    esp_cam_sensor_frame_timing_t timing;
+    ov5647_para_t *para = &((struct ov5647_cam *)dev->priv)->ov5647_para;
+
+    ov5647_get_frame_timing(dev, &timing);
+    uint32_t vts = esp_cam_sensor_frame_timing_vts(&timing, fps);
+    ESP_RETURN_ON_FALSE(vts, ESP_ERR_INVALID_STATE, TAG, "format not set");
+    uint32_t exp_max = esp_cam_sensor_frame_timing_exposure_max(&timing, vts);
+
+    ESP_LOGD(TAG, "set fps %" PRIu32 ", vts %" PRIu32, fps, vts);
+    ret = ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_START);
+    ret |= ov5647_write_cached(dev, 0x380e, (vts >> 8) & 0xff);
+    ret |= ov5647_write_cached(dev, 0x380f, vts & 0xff);
+    /* A manual exposure longer than the new frame is cut on the same frame */
+    if (para->manual_en && para->exposure_val > exp_max) {
+        ret |= ov5647_write_through(dev, 0x3500, (exp_max >> 12) & 0x0f);
+        ret |= ov5647_write_through(dev, 0x3501, (exp_max >> 4) & 0xff);
+        ret |= ov5647_write_through(dev, 0x3502, (exp_max & 0x0f) << 4);
+    }
+    ret |= ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_END);
+    ret |= ov5647_write_through(dev, OV5647_REG_GROUP_HOLD, OV5647_GROUP_HOLD_LAUNCH);
+    /* The on-chip AEC caps the exposure at the max bands, they are computed from VTS */
+    ret |= ov5647_set_bandingfilter(dev);
+    if (ret == ESP_OK) {
+        para->vts = vts;
+        if (para->manual_en) {
+            para->exposure_val = MIN(para->exposure_val, exp_max);
+        }
+    }
+    return ret;
+}
 
 static esp_err_t ov5647_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_sensor_param_desc_t *qdesc)
 {
@@ -355,6 +518,29 @@ static esp_err_t ov5647_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_se
         qdesc->number.step = 1;
         qdesc->default_value = OV5647_AE_TARGET_DEFAULT;
         break;
+    case ESP_CAM_SENSOR_GROUP_EXP_GAIN:
+        qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_U8;
+        qdesc->u8.size = sizeof(esp_cam_sensor_gh_exp_gain_t);
+        break;
+    case ESP_CAM_SENSOR_FRAME_LATENCY:
+        qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_U8;
+        qdesc->u8.size = sizeof(esp_cam_sensor_frame_latency_t);
+        qdesc->flags = ESP_CAM_SENSOR_PARAM_FLAG_READ_ONLY;
+        break;
+    case ESP_CAM_SENSOR_FPS: {
+        esp_cam_sensor_frame_timing_t timing;
+        uint32_t min_fps;
+        uint32_t max_fps;
+
+        ov5647_get_frame_timing(dev, &timing);
+        ESP_RETURN_ON_ERROR(esp_cam_sensor_frame_timing_fps_range(&timing, &min_fps, &max_fps), TAG, "format not set");
+        qdesc->type = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
+        qdesc->number.minimum = min_fps;
+        qdesc->number.maximum = dev->cur_format->fps;
+        qdesc->number.step = 1;
+        qdesc->default_value = dev->cur_format->fps;
+        break;
+    }
     default: {
         ESP_LOGD(TAG, "id=%"PRIx32" is not supported", qdesc->id);
         ret = ESP_ERR_INVALID_ARG;
@@ -366,7 +552,32 @@ static esp_err_t ov5647_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_se
 
 static esp_err_t ov5647_get_para_value(esp_cam_sensor_device_t *dev, uint32_t id, void *arg, size_t size)
 {
-    return ESP_ERR_NOT_SUPPORTED;
+    esp_err_t ret = ESP_OK;
+
+    switch (id) {
+    case ESP_CAM_SENSOR_FRAME_LATENCY: {
+        ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_frame_latency_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
+        esp_cam_sensor_frame_latency_t *latency = (esp_cam_sensor_frame_latency_t *)arg;
+        latency->exposure = OV5647_EXP_LATENCY;
+        latency->gain = OV5647_GAIN_LATENCY;
+        latency->vts = OV5647_VTS_LATENCY;
+        break;
+    }
+    case ESP_CAM_SENSOR_FPS: {
+        esp_cam_sensor_frame_timing_t timing;
+        struct ov5647_cam *cam_ov5647 = (struct ov5647_cam *)dev->priv;
+
+        ov5647_get_frame_timing(dev, &timing);
+        *(uint32_t *)arg = MIN(esp_cam_sensor_frame_timing_fps(&timing, cam_ov5647->ov5647_para.vts), dev->cur_format->fps);
+        break;
+    }
+    default: {
+        ret = ESP_ERR_NOT_SUPPORTED;
+        break;
+    }
+    }
+
+    return ret;
 }
 
 static esp_err_t ov5647_set_para_value(esp_cam_sensor_device_t *dev, uint32_t id, const void *arg, size_t size)
@@ -388,8 +599,26 @@ static esp_err_t ov5647_set_para_value(esp_cam_sensor_device_t *dev, uint32_t id
     }
     case ESP_CAM_SENSOR_EXPOSURE_VAL: {
         int *value = (int *)arg;
+        struct ov5647_cam *cam_ov5647 = (struct ov5647_cam *)dev->priv;
 
-        ret = ov5647_set_AE_target(dev, *value);
+        /* An AE target hands exposure and gain back to the on-chip AEC/AGC */
+        ret = ov5647_write_cached(dev, OV5647_REG_AEC_PK_MANUAL, OV5647_AEC_AGC_AUTO);
+        ret |= ov5647_set_AE_target(dev, *value);
+        if (ret == ESP_OK) {
+            cam_ov5647->ov5647_para.manual_en = 0;
+        }
+        break;
+    }
+    case ESP_CAM_SENSOR_GROUP_EXP_GAIN: {
+        ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_gh_exp_gain_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
+
+        ret = ov5647_set_group_exp_gain(dev, (const esp_cam_sensor_gh_exp_gain_t *)arg);
+        break;
+    }
+    case ESP_CAM_SENSOR_FPS: {
+        const uint32_t *value = (const uint32_t *)arg;
+
+        ret = ov5647_set_fps(dev, *value);
         break;
     }
     default: {
@@ -434,23 +663,23 @@ static int ov5647_get_sysclk(esp_cam_sensor_device_t *dev)
     const int bit_div2x_map[] = {2, 2, 2, 2, 2, 2, 2, 2, 4, 2, 5, 2, 2, 2, 2, 2};
     const int sclk_div_map[] = {1, 2, 4, 1};
 
-    ov5647_read(dev->sccb_handle, 0x3037, &temp1);
+    ov5647_read_cached(dev, 0x3037, &temp1);
     temp2 = temp1 & 0x0f;
     pre_div02x = pre_div02x_map[temp2];
     temp2 = (temp1 >> 4) & 0x01;
     pll_rdiv = pll_rdiv_map[temp2];
-    ov5647_read(dev->sccb_handle, 0x3036, &temp1);
+    ov5647_read_cached(dev, 0x3036, &temp1);
 
     div_cnt7b = temp1;
 
     VCO = xvclk * 2 / pre_div02x * div_cnt7b;
-    ov5647_read(dev->sccb_handle, 0x3035, &temp1);
+    ov5647_read_cached(dev, 0x3035, &temp1);
     temp2 = temp1 >> 4;
     sdiv0 = sdiv0_map[temp2];
-    ov5647_read(dev->sccb_handle, 0x3034, &temp1);
+    ov5647_read_cached(dev, 0x3034, &temp1);
     temp2 = temp1 & 0x0f;
     bit_div2x = bit_div2x_map[temp2];
-    ov5647_read(dev->sccb_handle, 0x3106, &temp1);
+    ov5647_read_cached(dev, 0x3106, &temp1);
     temp2 = (temp1 >> 2) & 0x03;
     sclk_div = sclk_div_map[temp2];
     sysclk = VCO * 2 / sdiv0 / pll_rdiv / bit_div2x / sclk_div;
@@ -463,8 +692,8 @@ static int ov5647_get_hts(esp_cam_sensor_device_t *dev)
     int hts = 0;
     uint8_t temp1, temp2;
 
-    ov5647_read(dev->sccb_handle, 0x380c, &temp1);
-    ov5647_read(dev->sccb_handle, 0x380d, &temp2);
+    ov5647_read_cached(dev, 0x380c, &temp1);
+    ov5647_read_cached(dev, 0x380d, &temp2);
     hts = (temp1 << 8) + temp2;
 
     return hts;
@@ -477,8 +706,8 @@ static int ov5647_get_vts(esp_cam_sensor_device_t *dev)
     uint8_t temp1, temp2;
 
     /* total vertical size[15:8] high byte */
-    ov5647_read(dev->sccb_handle, 0x380e, &temp1);
-    ov5647_read(dev->sccb_handle, 0x380f, &temp2);
+    ov5647_read_cached(dev, 0x380e, &temp1);
+    ov5647_read_cached(dev, 0x380f, &temp2);
 
     vts = (temp1 << 8) + temp2;
 
@@ -491,11 +720,11 @@ static int ov5647_get_light_freq(esp_cam_sensor_device_t *dev)
     uint8_t temp, temp1;
     int light_freq = 0;
 
-    ov5647_read(dev->sccb_handle, 0x3c01, &temp);
+    ov5647_read_cached(dev, 0x3c01, &temp);
 
     if (temp & 0x80) {
         /* manual */
-        ov5647_read(dev->sccb_handle, 0x3c00, &temp1);
+        ov5647_read_cached(dev, 0x3c00, &temp1);
         if (temp1 & 0x04) {
             /* 50Hz */
             light_freq = 50;
@@ -533,19 +762,73 @@ static esp_err_t ov5647_set_bandingfilter(esp_cam_sensor_device_t *dev)
     /* calculate banding filter */
     /* 60Hz */
     band_step60 = prev_sysclk * 100 / prev_HTS * 100 / 120;
-    ret = ov5647_write(dev->sccb_handle, 0x3a0a, (uint8_t)(band_step60 >> 8));
-    ret |= ov5647_write(dev->sccb_handle, 0x3a0b, (uint8_t)(band_step60 & 0xff));
+    ret = ov5647_write_cached(dev, 0x3a0a, (uint8_t)(band_step60 >> 8));
+    ret |= ov5647_write_cached(dev, 0x3a0b, (uint8_t)(band_step60 & 0xff));
 
     max_band60 = (int)((prev_VTS - 4) / band_step60);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a0d, (uint8_t)max_band60);
+    ret |= ov5647_write_cached(dev, 0x3a0d, (uint8_t)max_band60);
 
     /* 50Hz */
     band_step50 = prev_sysclk * 100 / prev_HTS;
-    ret |= ov5647_write(dev->sccb_handle, 0x3a08, (uint8_t)(band_step50 >> 8));
-    ret |= ov5647_write(dev->sccb_handle, 0x3a09, (uint8_t)(band_step50 & 0xff));
+    ret |= ov5647_write_cached(dev, 0x3a08, (uint8_t)(band_step50 >> 8));
+    ret |= ov5647_write_cached(dev, 0x3a09, (uint8_t)(band_step50 & 0xff));
 
     max_band50 = (int)((prev_VTS - 4) / band_step50);
-    ret |= ov5647_write(dev->sccb_handle, 0x3a0e, (uint8_t)max_band50);
+    ret |= ov5647_write_cached(dev, 0x3a0e, (uint8_t)max_band50);
+    return ret;
+}
+
+/* get the VTS a format table sets, 0 if the table does not set it */
+static uint32_t ov5647_table_vts(const ov5647_reginfo_t *regarray)
+{
+    uint32_t vts = 0;
+
+    for (int i = 0; regarray[i].reg != OV5647_REG_END; i++) {
+        if (regarray[i].reg == 0x380e) {
+            vts = (vts & 0xff) | (regarray[i].val << 8);
+        } else if (regarray[i].reg == 0x380f) {
+            vts = (vts & 0xff00) | regarray[i].val;
+        }
+    }
+    return vts;
+}
+
+/* switch from the loaded format writing only the registers that differ, fails if a full reload is needed */
+static esp_err_t ov5647_write_format_delta(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
+{
+    struct ov5647_cam *cam_ov5647 = (struct ov5647_cam *)dev->priv;
+    const esp_cam_sensor_format_t *loaded_format = cam_ov5647->loaded_format;
+    esp_cam_sensor_regdelta_t delta;
+
+    /* Manual exposure moved AEC/AGC and VTS registers the tables do not describe */
+    if (!loaded_format || cam_ov5647->ov5647_para.manual_en) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = esp_cam_sensor_regdelta_compute(&s_ov5647_regdelta_config, loaded_format->regs, format->regs, &delta);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "%s -> %s needs a full reload (%u orphan regs)", loaded_format->name, format->name,
+                 (unsigned)delta.orphans);
+        return ret;
+    }
+
+    if (delta.regs_num) {
+        ret = ov5647_write_array(dev, (const ov5647_reginfo_t *)delta.regs);
+    }
+    /*
+     * The frame rate and the night mode stretch VTS, the delta leaves it stretched when both tables set the same VTS.
+     * The format starts at its table frame rate, as after a full reload.
+     */
+    uint32_t vts = ov5647_table_vts((const ov5647_reginfo_t *)format->regs);
+    if (ret == ESP_OK && vts) {
+        ret = ov5647_write_cached(dev, 0x380e, (vts >> 8) & 0xff);
+        ret |= ov5647_write_cached(dev, 0x380f, vts & 0xff);
+    }
+    ESP_LOGD(TAG, "%s -> %s in %u writes", loaded_format->name, format->name, (unsigned)delta.regs_num);
+    esp_cam_sensor_regdelta_free(&delta);
+    if (ret != ESP_OK) {
+        cam_ov5647->loaded_format = NULL;
+    }
     return ret;
 }
 
@@ -563,12 +846,19 @@ static esp_err_t ov5647_set_format(esp_cam_sensor_device_t *dev, const esp_cam_s
             ESP_LOGE(TAG, "Not support DVP port");
         }
     }
-    // reset
-    ret = ov5647_write_array(dev->sccb_handle, ov5647_mipi_reset_regs);
-    ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write reset regs failed");
-    // write format related regs
-    ret = ov5647_write_array(dev->sccb_handle, (const ov5647_reginfo_t *)format->regs);
-    ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write fmt regs failed");
+    struct ov5647_cam *cam_ov5647 = (struct ov5647_cam *)dev->priv;
+    if (ov5647_write_format_delta(dev, format) != ESP_OK) {
+        // reset, the register shadow is rebuilt from the tables below
+        esp_cam_sensor_regcache_invalidate(OV5647_REGCACHE(dev));
+        cam_ov5647->loaded_format = NULL;
+        ret = ov5647_write_array(dev, ov5647_mipi_reset_regs);
+        ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write reset regs failed");
+        esp_cam_sensor_regcache_invalidate(OV5647_REGCACHE(dev));
+        // write format related regs
+        ret = ov5647_write_array(dev, (const ov5647_reginfo_t *)format->regs);
+        ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "write fmt regs failed");
+    }
+    cam_ov5647->loaded_format = format;
 
     ret = ov5647_set_AE_target(dev, OV5647_AE_TARGET_DEFAULT);
     ESP_RETURN_ON_FALSE(ret == ESP_OK, ret, TAG, "set ae target failed");
@@ -580,6 +870,12 @@ static esp_err_t ov5647_set_format(esp_cam_sensor_device_t *dev, const esp_cam_s
     ESP_LOGD(TAG, "light freq=0x%x", ov5647_get_light_freq(dev));
 
     dev->cur_format = format;
+    // init para, the timing comes from the registers as the isp_info table is not exact for every format
+    cam_ov5647->ov5647_para.format_vts = ov5647_get_vts(dev);
+    cam_ov5647->ov5647_para.format_hts = ov5647_get_hts(dev);
+    cam_ov5647->ov5647_para.sysclk = ov5647_get_sysclk(dev);
+    cam_ov5647->ov5647_para.vts = cam_ov5647->ov5647_para.format_vts;
+    cam_ov5647->ov5647_para.manual_en = 0;
 
     return ret;
 }
@@ -615,7 +911,9 @@ static esp_err_t ov5647_priv_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd, v
         break;
     case ESP_CAM_SENSOR_IOC_S_REG:
         sensor_reg = (esp_cam_sensor_reg_val_t *)arg;
-        ret = ov5647_write(dev->sccb_handle, sensor_reg->regaddr, sensor_reg->value);
+        ret = ov5647_write_through(dev, sensor_reg->regaddr, sensor_reg->value);
+        // the sensor no longer matches a format table
+        OV5647_LOADED_FORMAT(dev) = NULL;
         break;
     case ESP_CAM_SENSOR_IOC_S_STREAM:
         ret = ov5647_set_stream(dev, *(int *)arg);
@@ -708,6 +1006,11 @@ static esp_err_t ov5647_delete(esp_cam_sensor_device_t *dev)
 {
     ESP_LOGD(TAG, "del ov5647 (%p)", dev);
     if (dev) {
+        if (dev->priv) {
+            esp_cam_sensor_regcache_del(OV5647_REGCACHE(dev));
+            free(dev->priv);
+            dev->priv = NULL;
+        }
         free(dev);
         dev = NULL;
     }
@@ -731,6 +1034,7 @@ static const esp_cam_sensor_ops_t ov5647_ops = {
 esp_cam_sensor_device_t *ov5647_detect(esp_cam_sensor_config_t *config)
 {
     esp_cam_sensor_device_t *dev = NULL;
+    struct ov5647_cam *cam_ov5647;
 
     if (config == NULL) {
         return NULL;
@@ -742,6 +1046,16 @@ esp_cam_sensor_device_t *ov5647_detect(esp_cam_sensor_config_t *config)
         return NULL;
     }
 
+    cam_ov5647 = heap_caps_calloc(1, sizeof(struct ov5647_cam), MALLOC_CAP_DEFAULT);
+    if (!cam_ov5647) {
+        ESP_LOGE(TAG, "failed to calloc cam");
+        free(dev);
+        return NULL;
+    }
+    if (esp_cam_sensor_regcache_new(NULL, &cam_ov5647->regcache) != ESP_OK) {
+        ESP_LOGW(TAG, "register shadow disabled");
+    }
+
     dev->name = (char *)OV5647_SENSOR_NAME;
     dev->sccb_handle = config->sccb_handle;
     dev->xclk_pin = config->xclk_pin;
@@ -749,6 +1063,7 @@ esp_cam_sensor_device_t *ov5647_detect(esp_cam_sensor_config_t *config)
     dev->pwdn_pin = config->pwdn_pin;
     dev->sensor_port = config->sensor_port;
     dev->ops = &ov5647_ops;
+    dev->priv = cam_ov5647;
     if (config->sensor_port == ESP_CAM_SENSOR_MIPI_CSI) {
         dev->cur_format = &ov5647_format_info[CONFIG_CAMERA_OV5647_MIPI_IF_FORMAT_INDEX_DEFAULT];
     } else {
@@ -780,6 +1095,8 @@ esp_cam_sensor_device_t *ov5647_detect(esp_cam_sensor_config_t *config)
 
 err_free_handler:
     ov5647_power_off(dev);
+    esp_cam_sensor_regcache_del(cam_ov5647->regcache);
+    free(dev->priv);
     free(dev);
 
     return NULL;
@@ -13,6 +13,9 @@
 
 #include "esp_cam_sensor.h"
 #include "esp_cam_sensor_detect.h"
+#include "esp_cam_sensor_regcache.h"
+#include "esp_cam_sensor_regdelta.h"
+#include "esp_cam_sensor_frame_timing.h"
 #include "sc202cs_settings.h"
 #include "sc202cs.h"
 
@@ -31,7 +34,9 @@ typedef struct {
 
 typedef struct {
     uint32_t exposure_val;
+    uint32_t exposure_max;
     uint32_t gain_index;  // current gain index
+    uint32_t vts;
 
     uint32_t vflip_en : 1;
     uint32_t hmirror_en : 1;
@@ -39,6 +44,21 @@ typedef struct {
 
 struct sc202cs_cam {
     sc202cs_para_t sc202cs_para;
+    esp_cam_sensor_regcache_handle_t regcache;     /*!< Shadow of the registers written to the sensor */
+    const esp_cam_sensor_format_t *loaded_format;  /*!< Format whose table the sensor holds, NULL once reset */
+};
+
+#define SC202CS_REGCACHE(dev)      (((struct sc202cs_cam *)(dev)->priv)->regcache)
+#define SC202CS_LOADED_FORMAT(dev) (((struct sc202cs_cam *)(dev)->priv)->loaded_format)
+
+/* Soft reset and streaming are never part of a format switch delta */
+static const uint16_t s_sc202cs_regdelta_skip[] = {0x0103, SC202CS_REG_SLEEP_MODE};
+
+static const esp_cam_sensor_regdelta_config_t s_sc202cs_regdelta_config = {
+    .end_marker    = SC202CS_REG_END,
+    .delay_marker  = SC202CS_REG_DELAY,
+    .skip_regs     = s_sc202cs_regdelta_skip,
+    .skip_regs_num = ARRAY_SIZE(s_sc202cs_regdelta_skip),
 };
 
 #define SC202CS_IO_MUX_LOCK(mux)
@@ -50,6 +70,17 @@ struct sc202cs_cam {
 #define SC202CS_FETCH_EXP_M(val) (((val) >> 4) & 0xFF)
 #define SC202CS_FETCH_EXP_L(val) (((val)&0xF) << 4)
 
+#define SC202CS_EXP_MAX_OFFSET 6  // max exposure = VTS-6
+#define SC202CS_VTS_MAX        0x7fff
+
+#define SC202CS_GROUP_HOLD_START 0x00
+#define SC202CS_GROUP_HOLD_END   0x30  // Launch the group at the next frame boundary
+
+/* Exposure, gain and VTS written in frame N are used by frame N + 2 */
+#define SC202CS_EXP_LATENCY  2
+#define SC202CS_GAIN_LATENCY 2
+#define SC202CS_VTS_LATENCY  2
+
 #define SC202CS_PID         0xeb52
 #define SC202CS_SENSOR_NAME "SC202CS"
 #ifndef portTICK_RATE_MS
@@ -999,19 +1030,32 @@ static esp_err_t sc202cs_read(esp_sccb_io_handle_t sccb_handle, uint16_t reg, ui
     return esp_sccb_transmit_receive_reg_a16v8(sccb_handle, reg, read_buf);
 }
 
-static esp_err_t sc202cs_write(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t data)
+/* read a configuration register, served from the register shadow when it is known */
+static esp_err_t sc202cs_read_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t *read_buf)
 {
-    return esp_sccb_transmit_reg_a16v8(sccb_handle, reg, data);
+    return esp_cam_sensor_regcache_read_a16v8(SC202CS_REGCACHE(dev), dev->sccb_handle, reg, read_buf);
+}
+
+/* write a register unconditionally, keeping the register shadow in sync */
+static esp_err_t sc202cs_write_through(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
+{
+    return esp_cam_sensor_regcache_write_through_a16v8(SC202CS_REGCACHE(dev), dev->sccb_handle, reg, data);
+}
+
+/* write a configuration register, skipped if the sensor already holds this value */
+static esp_err_t sc202cs_write_cached(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t data)
+{
+    return esp_cam_sensor_regcache_write_a16v8(SC202CS_REGCACHE(dev), dev->sccb_handle, reg, data);
 }
 
 /* write a array of registers  */
-static esp_err_t sc202cs_write_array(esp_sccb_io_handle_t sccb_handle, sc202cs_reginfo_t *regarray)
+static esp_err_t sc202cs_write_array(esp_cam_sensor_device_t *dev, sc202cs_reginfo_t *regarray)
 {
     int i         = 0;
     esp_err_t ret = ESP_OK;
     while ((ret == ESP_OK) && regarray[i].reg != SC202CS_REG_END) {
         if (regarray[i].reg != SC202CS_REG_DELAY) {
-            ret = sc202cs_write(sccb_handle, regarray[i].reg, regarray[i].val);
+            ret = sc202cs_write_through(dev, regarray[i].reg, regarray[i].val);
         } else {
             delay_ms(regarray[i].val);
         }
@@ -1020,29 +1064,31 @@ static esp_err_t sc202cs_write_array(esp_sccb_io_handle_t sccb_handle, sc202cs_r
     return ret;
 }
 
-static esp_err_t sc202cs_set_reg_bits(esp_sccb_io_handle_t sccb_handle, uint16_t reg, uint8_t offset, uint8_t length,
+static esp_err_t sc202cs_set_reg_bits(esp_cam_sensor_device_t *dev, uint16_t reg, uint8_t offset, uint8_t length,
                                       uint8_t value)
 {
     esp_err_t ret    = ESP_OK;
     uint8_t reg_data = 0;
 
-    ret = sc202cs_read(sccb_handle, reg, &reg_data);
+    ret = sc202cs_read_cached(dev, reg, &reg_data);
     if (ret != ESP_OK) {
         return ret;
     }
     uint8_t mask = ((1 << length) - 1) << offset;
-    value        = (ret & ~mask) | ((value << offset) & mask);
-    ret          = sc202cs_write(sccb_handle, reg, value);
+    value        = (reg_data & ~mask) | ((value << offset) & mask);
+    ret          = sc202cs_write_cached(dev, reg, value);
     return ret;
 }
 
 static esp_err_t sc202cs_set_test_pattern(esp_cam_sensor_device_t *dev, int enable)
 {
-    return sc202cs_set_reg_bits(dev->sccb_handle, 0x4501, 3, 1, enable ? 0x01 : 0x00);
+    return sc202cs_set_reg_bits(dev, 0x4501, 3, 1, enable ? 0x01 : 0x00);
 }
 
 static esp_err_t sc202cs_hw_reset(esp_cam_sensor_device_t *dev)
 {
+    esp_cam_sensor_regcache_invalidate(SC202CS_REGCACHE(dev));
+    SC202CS_LOADED_FORMAT(dev) = NULL;
     if (dev->reset_pin >= 0) {
         gpio_set_level(dev->reset_pin, 0);
         delay_ms(10);
@@ -1054,8 +1100,12 @@ static esp_err_t sc202cs_hw_reset(esp_cam_sensor_device_t *dev)
 
 static esp_err_t sc202cs_soft_reset(esp_cam_sensor_device_t *dev)
 {
-    esp_err_t ret = sc202cs_set_reg_bits(dev->sccb_handle, 0x0103, 0, 1, 0x01);
+    /* 0x0103 is self-clearing, so it must never be elided by the register shadow */
+    esp_cam_sensor_regcache_invalidate(SC202CS_REGCACHE(dev));
+    SC202CS_LOADED_FORMAT(dev) = NULL;
+    esp_err_t ret = sc202cs_set_reg_bits(dev, 0x0103, 0, 1, 0x01);
     delay_ms(5);
+    esp_cam_sensor_regcache_invalidate(SC202CS_REGCACHE(dev));
     return ret;
 }
 
@@ -1080,7 +1130,7 @@ static esp_err_t sc202cs_get_sensor_id(esp_cam_sensor_device_t *dev, esp_cam_sen
 static esp_err_t sc202cs_set_stream(esp_cam_sensor_device_t *dev, int enable)
 {
     esp_err_t ret = ESP_FAIL;
-    ret           = sc202cs_write(dev->sccb_handle, SC202CS_REG_SLEEP_MODE, enable ? 0x01 : 0x00);
+    ret           = sc202cs_write_through(dev, SC202CS_REG_SLEEP_MODE, enable ? 0x01 : 0x00);
 
     dev->stream_status = enable;
     ESP_LOGD(TAG, "Stream=%d", enable);
@@ -1089,12 +1139,94 @@ static esp_err_t sc202cs_set_stream(esp_cam_sensor_device_t *dev, int enable)
 
 static esp_err_t sc202cs_set_mirror(esp_cam_sensor_device_t *dev, int enable)
 {
-    return sc202cs_set_reg_bits(dev->sccb_handle, 0x3221, 1, 2, enable ? 0x03 : 0x00);
+    return sc202cs_set_reg_bits(dev, 0x3221, 1, 2, enable ? 0x03 : 0x00);
 }
 
 static esp_err_t sc202cs_set_vflip(esp_cam_sensor_device_t *dev, int enable)
 {
-    return sc202cs_set_reg_bits(dev->sccb_handle, 0x3221, 5, 2, enable ? 0x03 : 0x00);
+    return sc202cs_set_reg_bits(dev, 0x3221, 5, 2, enable ? 0x03 : 0x00);
+}
+
+static esp_err_t sc202cs_set_exp_val(esp_cam_sensor_device_t *dev, uint32_t u32_val)
+{
+    esp_err_t ret;
+    struct sc202cs_cam *cam_sc202cs = (struct sc202cs_cam *)dev->priv;
+
+    ESP_LOGD(TAG, "set exposure 0x%" PRIx32, u32_val);
+    /* 4 least significant bits of expsoure are fractional part */
+    ret = sc202cs_write_cached(dev, SC202CS_REG_SHUTTER_TIME_H, SC202CS_FETCH_EXP_H(u32_val));
+    ret |= sc202cs_write_cached(dev, SC202CS_REG_SHUTTER_TIME_M, SC202CS_FETCH_EXP_M(u32_val));
+    ret |= sc202cs_write_cached(dev, SC202CS_REG_SHUTTER_TIME_L, SC202CS_FETCH_EXP_L(u32_val));
+    if (ret == ESP_OK) {
+        cam_sc202cs->sc202cs_para.exposure_val = u32_val;
+    }
+    return ret;
+}
+
+static esp_err_t sc202cs_set_total_gain_val(esp_cam_sensor_device_t *dev, uint32_t u32_val)
+{
+    esp_err_t ret;
+    struct sc202cs_cam *cam_sc202cs = (struct sc202cs_cam *)dev->priv;
+
+    ESP_LOGD(TAG, "dgain_fine %" PRIx8 ", dgain_coarse %" PRIx8 ", again_coarse %" PRIx8,
+             sc202cs_gain_map[u32_val].dgain_fine, sc202cs_gain_map[u32_val].dgain_coarse,
+             sc202cs_gain_map[u32_val].analog_gain);
+    ret = sc202cs_write_cached(dev, SC202CS_REG_DIG_FINE_GAIN, sc202cs_gain_map[u32_val].dgain_fine);
+    ret |= sc202cs_write_cached(dev, SC202CS_REG_DIG_COARSE_GAIN, sc202cs_gain_map[u32_val].dgain_coarse);
+    ret |= sc202cs_write_cached(dev, SC202CS_REG_ANG_GAIN, sc202cs_gain_map[u32_val].analog_gain);
+    if (ret == ESP_OK) {
+        cam_sc202cs->sc202cs_para.gain_index = u32_val;
+    }
+    return ret;
+}
+
+static esp_err_t sc202cs_set_vts(esp_cam_sensor_device_t *dev, uint32_t u32_val)
+{
+    esp_err_t ret;
+    struct sc202cs_cam *cam_sc202cs = (struct sc202cs_cam *)dev->priv;
+    /* Frames can only be stretched, the format VTS is the shortest frame the timing allows */
+    uint32_t vts = MAX(u32_val, dev->cur_format->isp_info->isp_v1_info.vts);
+    vts          = MIN(vts, SC202CS_VTS_MAX);
+
+    ret = sc202cs_write_cached(dev, SC202CS_REG_TOTAL_HEIGHT_H, (vts >> 8) & 0xff);
+    ret |= sc202cs_write_cached(dev, SC202CS_REG_TOTAL_HEIGHT_L, vts & 0xff);
+    if (ret == ESP_OK) {
+        cam_sc202cs->sc202cs_para.vts          = vts;
+        cam_sc202cs->sc202cs_para.exposure_max = vts - SC202CS_EXP_MAX_OFFSET;
+    }
+    return ret;
+}
+
+static void sc202cs_get_frame_timing(esp_cam_sensor_device_t *dev, esp_cam_sensor_frame_timing_t *timing)
+{
+    const esp_cam_sensor_isp_info_t *isp_info = dev->cur_format->isp_info;
+
+    timing->pclk       = isp_info->isp_v1_info.pclk;
+    timing->hts        = isp_info->isp_v1_info.hts;
+    timing->vts_min    = isp_info->isp_v1_info.vts;
+    timing->vts_max    = SC202CS_VTS_MAX;
+    timing->exp_margin = SC202CS_EXP_MAX_OFFSET;
+}
+
+static esp_err_t sc202cs_set_fps(esp_cam_sensor_device_t *dev, uint32_t fps)
+{
+    esp_err_t ret;
+    esp_cam_sensor_frame_timing_t timing;
+    struct sc202cs_cam *cam_sc202cs = (struct sc202cs_cam *)dev->priv;
+
+    sc202cs_get_frame_timing(dev, &timing);
+    uint32_t vts = esp_cam_sensor_frame_timing_vts(&timing, fps);
+    ESP_RETURN_ON_FALSE(vts, ESP_ERR_INVALID_ARG, TAG, "invalid fps %" PRIu32, fps);
+
+    ESP_LOGD(TAG, "set fps %" PRIu32 ", vts %" PRIu32, fps, vts);
+    /* The frame and the exposure it bounds change on the same frame */
+    ret = sc202cs_write_through(dev, SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_START);
+    ret |= sc202cs_set_vts(dev, vts);
+    if (cam_sc202cs->sc202cs_para.exposure_val > cam_sc202cs->sc202cs_para.exposure_max) {
+        ret |= sc202cs_set_exp_val(dev, cam_sc202cs->sc202cs_para.exposure_max);
+    }
+    ret |= sc202cs_write_through(dev, SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_END);
+    return ret;
 }
 
 static esp_err_t sc202cs_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_sensor_param_desc_t *qdesc)
@@ -1104,18 +1236,40 @@ static esp_err_t sc202cs_query_para_desc(esp_cam_sensor_device_t *dev, esp_cam_s
         case ESP_CAM_SENSOR_EXPOSURE_VAL:
             qdesc->type           = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
             qdesc->number.minimum = 0xff;
-            qdesc->number.maximum =
-                dev->cur_format->isp_info->isp_v1_info.vts -
-                6;  // max = VTS-6 = height+vblank-6, so when update vblank, exposure_max must be updated
+            /* max = VTS-6 = height+vblank-6, follows the frame rate */
+            qdesc->number.maximum = ((struct sc202cs_cam *)dev->priv)->sc202cs_para.exposure_max;
             qdesc->number.step   = 1;
             qdesc->default_value = dev->cur_format->isp_info->isp_v1_info.exp_def;
             break;
+        case ESP_CAM_SENSOR_FPS: {
+            esp_cam_sensor_frame_timing_t timing;
+            uint32_t min_fps;
+            uint32_t max_fps;
+
+            sc202cs_get_frame_timing(dev, &timing);
+            ESP_RETURN_ON_ERROR(esp_cam_sensor_frame_timing_fps_range(&timing, &min_fps, &max_fps), TAG, "invalid timing");
+            qdesc->type           = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
+            qdesc->number.minimum = min_fps;
+            qdesc->number.maximum = dev->cur_format->fps;
+            qdesc->number.step    = 1;
+            qdesc->default_value  = dev->cur_format->fps;
+            break;
+        }
         case ESP_CAM_SENSOR_GAIN:
             qdesc->type                 = ESP_CAM_SENSOR_PARAM_TYPE_ENUMERATION;
             qdesc->enumeration.count    = s_limited_abs_gain_index;
             qdesc->enumeration.elements = sc202cs_abs_gain_val_map;
             qdesc->default_value        = dev->cur_format->isp_info->isp_v1_info.gain_def;  // default gain index
             break;
+        case ESP_CAM_SENSOR_GROUP_EXP_GAIN:
+            qdesc->type    = ESP_CAM_SENSOR_PARAM_TYPE_U8;
+            qdesc->u8.size = sizeof(esp_cam_sensor_gh_exp_gain_t);
+            break;
+        case ESP_CAM_SENSOR_FRAME_LATENCY:
+            qdesc->type    = ESP_CAM_SENSOR_PARAM_TYPE_U8;
+            qdesc->u8.size = sizeof(esp_cam_sensor_frame_latency_t);
+            qdesc->flags   = ESP_CAM_SENSOR_PARAM_FLAG_READ_ONLY;
+            break;
         case ESP_CAM_SENSOR_VFLIP:
         case ESP_CAM_SENSOR_HMIRROR:
             qdesc->type           = ESP_CAM_SENSOR_PARAM_TYPE_NUMBER;
@@ -1146,6 +1300,21 @@ static esp_err_t sc202cs_get_para_value(esp_cam_sensor_device_t *dev, uint32_t i
             *(uint32_t *)arg = cam_sc202cs->sc202cs_para.gain_index;
             break;
         }
+        case ESP_CAM_SENSOR_FPS: {
+            esp_cam_sensor_frame_timing_t timing;
+
+            sc202cs_get_frame_timing(dev, &timing);
+            *(uint32_t *)arg = MIN(esp_cam_sensor_frame_timing_fps(&timing, cam_sc202cs->sc202cs_para.vts), dev->cur_format->fps);
+            break;
+        }
+        case ESP_CAM_SENSOR_FRAME_LATENCY: {
+            ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_frame_latency_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
+            esp_cam_sensor_frame_latency_t *latency = (esp_cam_sensor_frame_latency_t *)arg;
+            latency->exposure                       = SC202CS_EXP_LATENCY;
+            latency->gain                           = SC202CS_GAIN_LATENCY;
+            latency->vts                            = SC202CS_VTS_LATENCY;
+            break;
+        }
         default: {
             ret = ESP_ERR_NOT_SUPPORTED;
             break;
@@ -1162,26 +1331,37 @@ static esp_err_t sc202cs_set_para_value(esp_cam_sensor_device_t *dev, uint32_t i
 
     switch (id) {
         case ESP_CAM_SENSOR_EXPOSURE_VAL: {
-            ESP_LOGD(TAG, "set exposure 0x%" PRIx32, u32_val);
-            /* 4 least significant bits of expsoure are fractional part */
-            ret = sc202cs_write(dev->sccb_handle, SC202CS_REG_SHUTTER_TIME_H, SC202CS_FETCH_EXP_H(u32_val));
-            ret |= sc202cs_write(dev->sccb_handle, SC202CS_REG_SHUTTER_TIME_M, SC202CS_FETCH_EXP_M(u32_val));
-            ret |= sc202cs_write(dev->sccb_handle, SC202CS_REG_SHUTTER_TIME_L, SC202CS_FETCH_EXP_L(u32_val));
-            if (ret == ESP_OK) {
-                cam_sc202cs->sc202cs_para.exposure_val = u32_val;
-            }
+            ret = sc202cs_set_exp_val(dev, u32_val);
             break;
         }
         case ESP_CAM_SENSOR_GAIN: {
-            ESP_LOGD(TAG, "dgain_fine %" PRIx8 ", dgain_coarse %" PRIx8 ", again_coarse %" PRIx8,
-                     sc202cs_gain_map[u32_val].dgain_fine, sc202cs_gain_map[u32_val].dgain_coarse,
-                     sc202cs_gain_map[u32_val].analog_gain);
-            ret = sc202cs_write(dev->sccb_handle, SC202CS_REG_DIG_FINE_GAIN, sc202cs_gain_map[u32_val].dgain_fine);
-            ret |= sc202cs_write(dev->sccb_handle, SC202CS_REG_DIG_COARSE_GAIN, sc202cs_gain_map[u32_val].dgain_coarse);
-            ret |= sc202cs_write(dev->sccb_handle, SC202CS_REG_ANG_GAIN, sc202cs_gain_map[u32_val].analog_gain);
-            if (ret == ESP_OK) {
-                cam_sc202cs->sc202cs_para.gain_index = u32_val;
+            ret = sc202cs_set_total_gain_val(dev, u32_val);
+            break;
+        }
+        case ESP_CAM_SENSOR_GROUP_EXP_GAIN: {
+            ESP_RETURN_ON_FALSE(size == sizeof(esp_cam_sensor_gh_exp_gain_t), ESP_ERR_INVALID_ARG, TAG, "invalid size");
+            const esp_cam_sensor_gh_exp_gain_t *value = (const esp_cam_sensor_gh_exp_gain_t *)arg;
+            ESP_RETURN_ON_FALSE(value->gain_index < s_limited_abs_gain_index, ESP_ERR_INVALID_ARG, TAG, "invalid gain index");
+            uint32_t exp_val = value->exposure_val;
+            if (!exp_val) {
+                /* exposure_us to lines, one line lasts HTS pixel clocks */
+                exp_val = (uint32_t)((uint64_t)value->exposure_us * dev->cur_format->isp_info->isp_v1_info.pclk /
+                                     dev->cur_format->isp_info->isp_v1_info.hts / 1000000);
             }
+
+            ret = sc202cs_write_through(dev, SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_START);
+            /* VTS first, it bounds the exposure */
+            if (value->vts) {
+                ret |= sc202cs_set_vts(dev, value->vts);
+            }
+            exp_val = MIN(exp_val, cam_sc202cs->sc202cs_para.exposure_max);
+            ret |= sc202cs_set_exp_val(dev, exp_val);
+            ret |= sc202cs_set_total_gain_val(dev, value->gain_index);
+            ret |= sc202cs_write_through(dev, SC202CS_REG_GROUP_HOLD, SC202CS_GROUP_HOLD_END);
+            break;
+        }
+        case ESP_CAM_SENSOR_FPS: {
+            ret = sc202cs_set_fps(dev, u32_val);
             break;
         }
         case ESP_CAM_SENSOR_VFLIP: {
@@ -1223,6 +1403,34 @@ static esp_err_t sc202cs_query_support_capability(esp_cam_sensor_device_t *dev,
     return 0;
 }
 
+/* switch from the loaded format writing only the registers that differ, fails if a full reload is needed */
+static esp_err_t sc202cs_write_format_delta(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
+{
+    const esp_cam_sensor_format_t *loaded_format = SC202CS_LOADED_FORMAT(dev);
+    esp_cam_sensor_regdelta_t delta;
+
+    if (!loaded_format) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    esp_err_t ret = esp_cam_sensor_regdelta_compute(&s_sc202cs_regdelta_config, loaded_format->regs, format->regs, &delta);
+    if (ret != ESP_OK) {
+        ESP_LOGD(TAG, "%s -> %s needs a full reload (%u orphan regs)", loaded_format->name, format->name,
+                 (unsigned)delta.orphans);
+        return ret;
+    }
+
+    if (delta.regs_num) {
+        ret = sc202cs_write_array(dev, (sc202cs_reginfo_t *)delta.regs);
+    }
+    ESP_LOGD(TAG, "%s -> %s in %u writes", loaded_format->name, format->name, (unsigned)delta.regs_num);
+    esp_cam_sensor_regdelta_free(&delta);
+    if (ret != ESP_OK) {
+        SC202CS_LOADED_FORMAT(dev) = NULL;
+    }
+    return ret;
+}
+
 static esp_err_t sc202cs_set_format(esp_cam_sensor_device_t *dev, const esp_cam_sensor_format_t *format)
 {
     ESP_CAM_SENSOR_NULL_POINTER_CHECK(TAG, dev);
@@ -1234,17 +1442,33 @@ static esp_err_t sc202cs_set_format(esp_cam_sensor_device_t *dev, const esp_cam_
         format = &sc202cs_format_info[CONFIG_CAMERA_SC202CS_MIPI_IF_FORMAT_INDEX_DEFAULT];
     }
 
-    ret = sc202cs_write_array(dev->sccb_handle, (sc202cs_reginfo_t *)format->regs);
+    bool delta_loaded = sc202cs_write_format_delta(dev, format) == ESP_OK;
+    if (!delta_loaded) {
+        // the register shadow is rebuilt from the format table
+        esp_cam_sensor_regcache_invalidate(SC202CS_REGCACHE(dev));
+        ret = sc202cs_write_array(dev, (sc202cs_reginfo_t *)format->regs);
+    }
 
     if (ret != ESP_OK) {
+        cam_sc202cs->loaded_format = NULL;
         ESP_LOGE(TAG, "Set format regs fail");
         return ESP_CAM_SENSOR_ERR_FAILED_SET_FORMAT;
     }
 
-    dev->cur_format = format;
+    cam_sc202cs->loaded_format = format;
+    dev->cur_format            = format;
     // init para
     cam_sc202cs->sc202cs_para.exposure_val = dev->cur_format->isp_info->isp_v1_info.exp_def;
     cam_sc202cs->sc202cs_para.gain_index   = dev->cur_format->isp_info->isp_v1_info.gain_def;
+    cam_sc202cs->sc202cs_para.vts          = dev->cur_format->isp_info->isp_v1_info.vts;
+    cam_sc202cs->sc202cs_para.exposure_max = cam_sc202cs->sc202cs_para.vts - SC202CS_EXP_MAX_OFFSET;
+
+    if (delta_loaded) {
+        // AE moved these away from the table values, the tables alone cannot tell
+        ret = sc202cs_set_vts(dev, cam_sc202cs->sc202cs_para.vts);
+        ret |= sc202cs_set_exp_val(dev, cam_sc202cs->sc202cs_para.exposure_val);
+        ret |= sc202cs_set_total_gain_val(dev, cam_sc202cs->sc202cs_para.gain_index);
+    }
 
     return ret;
 }
@@ -1279,7 +1503,9 @@ static esp_err_t sc202cs_priv_ioctl(esp_cam_sensor_device_t *dev, uint32_t cmd,
             break;
         case ESP_CAM_SENSOR_IOC_S_REG:
             sensor_reg = (esp_cam_sensor_reg_val_t *)arg;
-            ret        = sc202cs_write(dev->sccb_handle, sensor_reg->regaddr, sensor_reg->value);
+            ret        = sc202cs_write_through(dev, sensor_reg->regaddr, sensor_reg->value);
+            // the sensor no longer matches a format table
+            SC202CS_LOADED_FORMAT(dev) = NULL;
             break;
         case ESP_CAM_SENSOR_IOC_S_STREAM:
             ret = sc202cs_set_stream(dev, *(int *)arg);
@@ -1371,6 +1597,7 @@ static esp_err_t sc202cs_delete(esp_cam_sensor_device_t *dev)
     ESP_LOGD(TAG, "del sc202cs (%p)", dev);
     if (dev) {
         if (dev->priv) {
+            esp_cam_sensor_regcache_del(SC202CS_REGCACHE(dev));
             free(dev->priv);
             dev->priv = NULL;
         }
@@ -1412,6 +1639,9 @@ esp_cam_sensor_device_t *sc202cs_detect(esp_cam_sensor_config_t *config)
         free(dev);
         return NULL;
     }
+    if (esp_cam_sensor_regcache_new(NULL, &cam_sc202cs->regcache) != ESP_OK) {
+        ESP_LOGW(TAG, "register shadow disabled");
+    }
 
     dev->name        = (char *)SC202CS_SENSOR_NAME;
     dev->sccb_handle = config->sccb_handle;
@@ -1448,6 +1678,7 @@ esp_cam_sensor_device_t *sc202cs_detect(esp_cam_sensor_config_t *config)
 
 err_free_handler:
     sc202cs_power_off(dev);
+    esp_cam_sensor_regcache_del(cam_sc202cs->regcache);
     free(dev->priv);
     free(dev);
 
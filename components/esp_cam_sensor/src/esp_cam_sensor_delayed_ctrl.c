@@ -0,0 +1,172 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "esp_cam_sensor_delayed_ctrl.h"
+
+/* Enough for the deepest pipelined sensor plus a couple of frames of statistics lag */
+#define DELAYED_CTRL_HISTORY    8
+
+#define DELAYED_CTRL_EXPOSURE   0
+#define DELAYED_CTRL_GAIN       1
+#define DELAYED_CTRL_VTS        2
+#define DELAYED_CTRL_NUM        3
+
+/* Frame sequences wrap, compare them by signed distance */
+#define SEQ_BEFORE_EQ(a, b)     ((int32_t)((a) - (b)) <= 0)
+
+/**
+ * @brief One value of a control and the first frame captured with it
+ */
+typedef struct {
+    uint32_t seq;
+    uint32_t val;
+} delayed_ctrl_entry_t;
+
+/**
+ * @brief History of one control, entries are ordered by frame sequence
+ */
+typedef struct {
+    uint8_t latency;
+    uint8_t head;
+    uint8_t count;
+    uint32_t base;              /*!< Value in effect before the oldest entry */
+    delayed_ctrl_entry_t entries[DELAYED_CTRL_HISTORY];
+} delayed_ctrl_history_t;
+
+struct esp_cam_sensor_delayed_ctrl {
+    delayed_ctrl_history_t ctrl[DELAYED_CTRL_NUM];
+};
+
+static const char *TAG = "cam_delayed_ctrl";
+
+static inline delayed_ctrl_entry_t *history_entry(delayed_ctrl_history_t *h, uint8_t n)
+{
+    return &h->entries[(h->head + n) % DELAYED_CTRL_HISTORY];
+}
+
+static void history_reset(delayed_ctrl_history_t *h, uint32_t val)
+{
+    h->head = 0;
+    h->count = 0;
+    h->base = val;
+}
+
+static void history_push(delayed_ctrl_history_t *h, uint32_t write_seq, uint32_t val)
+{
+    uint32_t seq = write_seq + h->latency;
+
+    /* A second write in the same frame replaces the first one, the sensor latches only the last */
+    while (h->count && SEQ_BEFORE_EQ(seq, history_entry(h, h->count - 1)->seq)) {
+        h->count--;
+    }
+
+    if (h->count == DELAYED_CTRL_HISTORY) {
+        h->base = history_entry(h, 0)->val;
+        h->head = (h->head + 1) % DELAYED_CTRL_HISTORY;
+        h->count--;
+    }
+
+    delayed_ctrl_entry_t *entry = history_entry(h, h->count);
+    entry->seq = seq;
+    entry->val = val;
+    h->count++;
+}
+
+static uint32_t history_get(delayed_ctrl_history_t *h, uint32_t frame_seq)
+{
+    for (int i = h->count - 1; i >= 0; i--) {
+        delayed_ctrl_entry_t *entry = history_entry(h, i);
+        if (SEQ_BEFORE_EQ(entry->seq, frame_seq)) {
+            return entry->val;
+        }
+    }
+
+    return h->base;
+}
+
+static bool history_settled(delayed_ctrl_history_t *h, uint32_t frame_seq)
+{
+    return !h->count || SEQ_BEFORE_EQ(history_entry(h, h->count - 1)->seq, frame_seq);
+}
+
+esp_err_t esp_cam_sensor_delayed_ctrl_new(const esp_cam_sensor_delayed_ctrl_config_t *config,
+                                          esp_cam_sensor_delayed_ctrl_handle_t *ret_handle)
+{
+    ESP_RETURN_ON_FALSE(config && ret_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+    ESP_RETURN_ON_FALSE(config->latency.exposure < DELAYED_CTRL_HISTORY &&
+                        config->latency.gain < DELAYED_CTRL_HISTORY &&
+                        config->latency.vts < DELAYED_CTRL_HISTORY,
+                        ESP_ERR_INVALID_ARG, TAG, "latency is too long");
+
+    struct esp_cam_sensor_delayed_ctrl *dc = calloc(1, sizeof(struct esp_cam_sensor_delayed_ctrl));
+    ESP_RETURN_ON_FALSE(dc, ESP_ERR_NO_MEM, TAG, "no memory for delayed ctrl");
+
+    dc->ctrl[DELAYED_CTRL_EXPOSURE].latency = config->latency.exposure;
+    dc->ctrl[DELAYED_CTRL_GAIN].latency = config->latency.gain;
+    dc->ctrl[DELAYED_CTRL_VTS].latency = config->latency.vts;
+    esp_cam_sensor_delayed_ctrl_reset(dc, &config->init);
+
+    *ret_handle = dc;
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_delayed_ctrl_push(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t write_seq,
+                                           const esp_cam_sensor_ae_ctrl_t *ctrl)
+{
+    ESP_RETURN_ON_FALSE(handle && ctrl, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    history_push(&handle->ctrl[DELAYED_CTRL_EXPOSURE], write_seq, ctrl->exposure_val);
+    history_push(&handle->ctrl[DELAYED_CTRL_GAIN], write_seq, ctrl->gain_index);
+    history_push(&handle->ctrl[DELAYED_CTRL_VTS], write_seq, ctrl->vts);
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_delayed_ctrl_get(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t frame_seq,
+                                          esp_cam_sensor_ae_ctrl_t *ctrl)
+{
+    ESP_RETURN_ON_FALSE(handle && ctrl, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    ctrl->exposure_val = history_get(&handle->ctrl[DELAYED_CTRL_EXPOSURE], frame_seq);
+    ctrl->gain_index = history_get(&handle->ctrl[DELAYED_CTRL_GAIN], frame_seq);
+    ctrl->vts = history_get(&handle->ctrl[DELAYED_CTRL_VTS], frame_seq);
+    return ESP_OK;
+}
+
+bool esp_cam_sensor_delayed_ctrl_settled(esp_cam_sensor_delayed_ctrl_handle_t handle, uint32_t frame_seq)
+{
+    if (!handle) {
+        return true;
+    }
+
+    for (int i = 0; i < DELAYED_CTRL_NUM; i++) {
+        if (!history_settled(&handle->ctrl[i], frame_seq)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void esp_cam_sensor_delayed_ctrl_reset(esp_cam_sensor_delayed_ctrl_handle_t handle, const esp_cam_sensor_ae_ctrl_t *init)
+{
+    if (handle && init) {
+        history_reset(&handle->ctrl[DELAYED_CTRL_EXPOSURE], init->exposure_val);
+        history_reset(&handle->ctrl[DELAYED_CTRL_GAIN], init->gain_index);
+        history_reset(&handle->ctrl[DELAYED_CTRL_VTS], init->vts);
+    }
+}
+
+esp_err_t esp_cam_sensor_delayed_ctrl_del(esp_cam_sensor_delayed_ctrl_handle_t handle)
+{
+    free(handle);
+    return ESP_OK;
+}
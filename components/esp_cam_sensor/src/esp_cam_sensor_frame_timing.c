@@ -0,0 +1,144 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "esp_cam_sensor_frame_timing.h"
+
+#define NIGHT_MODE_GAIN_UNIT    1000
+
+static const char *TAG = "cam_frame_timing";
+
+static inline bool timing_valid(const esp_cam_sensor_frame_timing_t *timing)
+{
+    return timing && timing->pclk && timing->hts && timing->vts_min && timing->vts_min <= timing->vts_max &&
+           timing->exp_margin < timing->vts_min;
+}
+
+/* Pixel clocks per second over pixel clocks per frame, rounded up so that the rate never exceeds fps */
+static inline uint64_t vts_of_fps(const esp_cam_sensor_frame_timing_t *timing, uint32_t fps)
+{
+    uint64_t clocks_per_frame = (uint64_t)timing->hts * fps;
+
+    return (timing->pclk + clocks_per_frame - 1) / clocks_per_frame;
+}
+
+uint32_t esp_cam_sensor_frame_timing_vts(const esp_cam_sensor_frame_timing_t *timing, uint32_t fps)
+{
+    if (!timing_valid(timing) || !fps) {
+        return 0;
+    }
+
+    uint64_t vts = vts_of_fps(timing, fps);
+
+    if (vts < timing->vts_min) {
+        vts = timing->vts_min;
+    } else if (vts > timing->vts_max) {
+        vts = timing->vts_max;
+    }
+
+    return (uint32_t)vts;
+}
+
+uint32_t esp_cam_sensor_frame_timing_fps(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts)
+{
+    if (!timing_valid(timing) || !vts) {
+        return 0;
+    }
+
+    uint64_t clocks_per_frame = (uint64_t)timing->hts * vts;
+
+    return (uint32_t)((timing->pclk + clocks_per_frame / 2) / clocks_per_frame);
+}
+
+esp_err_t esp_cam_sensor_frame_timing_fps_range(const esp_cam_sensor_frame_timing_t *timing, uint32_t *min_fps, uint32_t *max_fps)
+{
+    ESP_RETURN_ON_FALSE(timing_valid(timing) && min_fps && max_fps, ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+
+    uint64_t longest_frame = (uint64_t)timing->hts * timing->vts_max;
+    uint32_t lowest = (uint32_t)((timing->pclk + longest_frame - 1) / longest_frame);
+    uint32_t highest = esp_cam_sensor_frame_timing_fps(timing, timing->vts_min);
+
+    *min_fps = lowest ? lowest : 1;
+    *max_fps = highest > *min_fps ? highest : *min_fps;
+
+    return ESP_OK;
+}
+
+uint32_t esp_cam_sensor_frame_timing_line_ns(const esp_cam_sensor_frame_timing_t *timing)
+{
+    if (!timing_valid(timing)) {
+        return 0;
+    }
+
+    return (uint32_t)((uint64_t)timing->hts * 1000000000 / timing->pclk);
+}
+
+uint32_t esp_cam_sensor_frame_timing_frame_us(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts)
+{
+    if (!timing_valid(timing)) {
+        return 0;
+    }
+
+    return (uint32_t)((uint64_t)timing->hts * vts * 1000000 / timing->pclk);
+}
+
+uint32_t esp_cam_sensor_frame_timing_exposure_max(const esp_cam_sensor_frame_timing_t *timing, uint32_t vts)
+{
+    if (!timing_valid(timing)) {
+        return 0;
+    }
+
+    return vts > timing->exp_margin ? vts - timing->exp_margin : 0;
+}
+
+esp_err_t esp_cam_sensor_night_mode_init(esp_cam_sensor_night_mode_t *night, const esp_cam_sensor_night_mode_config_t *config,
+                                         const esp_cam_sensor_frame_timing_t *timing)
+{
+    ESP_RETURN_ON_FALSE(night && config && timing_valid(timing), ESP_ERR_INVALID_ARG, TAG, "invalid argument");
+    ESP_RETURN_ON_FALSE(config->night_fps && config->night_fps < config->day_fps, ESP_ERR_INVALID_ARG, TAG,
+                        "night frame rate must be lower than the day one");
+    ESP_RETURN_ON_FALSE(config->exit_gain >= NIGHT_MODE_GAIN_UNIT && config->exit_gain < config->enter_gain,
+                        ESP_ERR_INVALID_ARG, TAG, "exit gain must be at least 1x and lower than the enter gain");
+
+    uint32_t day_vts = esp_cam_sensor_frame_timing_vts(timing, config->day_fps);
+    uint32_t day_exposure = esp_cam_sensor_frame_timing_exposure_max(timing, day_vts);
+
+    memset(night, 0, sizeof(*night));
+    night->config = *config;
+    night->day_exposure_us = (uint32_t)((uint64_t)day_exposure * timing->hts * 1000000 / timing->pclk);
+
+    return ESP_OK;
+}
+
+uint32_t esp_cam_sensor_night_mode_update(esp_cam_sensor_night_mode_t *night, uint32_t exposure_us, uint32_t gain)
+{
+    const esp_cam_sensor_night_mode_config_t *config = &night->config;
+    /* Exposure the scene needs at 1x gain, against the longest exposure of a day frame at the threshold gains */
+    uint64_t need = (uint64_t)exposure_us * gain;
+    bool pending;
+
+    if (night->night) {
+        pending = need < (uint64_t)night->day_exposure_us * config->exit_gain;
+    } else {
+        pending = need > (uint64_t)night->day_exposure_us * config->enter_gain;
+    }
+
+    if (!pending) {
+        night->count = 0;
+    } else if (++night->count >= config->hold_frames) {
+        night->count = 0;
+        night->night = !night->night;
+        ESP_LOGD(TAG, "%s mode, %" PRIu32 " fps", night->night ? "night" : "day",
+                 night->night ? config->night_fps : config->day_fps);
+    }
+
+    return night->night ? config->night_fps : config->day_fps;
+}
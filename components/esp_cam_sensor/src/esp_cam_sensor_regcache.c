@@ -0,0 +1,201 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "esp_cam_sensor_regcache.h"
+
+#ifndef CONFIG_CAMERA_SENSOR_REGCACHE_CAPACITY
+#define CONFIG_CAMERA_SENSOR_REGCACHE_CAPACITY 512
+#endif
+
+/* Stop inserting new registers once the table is 3/4 full to keep probe chains short */
+#define REGCACHE_LOAD_NUM   3
+#define REGCACHE_LOAD_DEN   4
+
+/**
+ * @brief One shadowed register
+ */
+typedef struct {
+    uint16_t reg;
+    uint8_t val;
+    uint8_t valid;
+} regcache_entry_t;
+
+/**
+ * @brief Register shadow, an open addressing hash table keyed by register address
+ */
+struct esp_cam_sensor_regcache {
+    uint16_t mask;
+    uint16_t used;
+    uint16_t limit;
+    esp_cam_sensor_regcache_stats_t stats;
+    regcache_entry_t *entries;
+};
+
+static const char *TAG = "cam_regcache";
+
+static inline uint16_t regcache_hash(uint16_t reg)
+{
+    /* Sensor registers are clustered in small blocks, spread them with a multiplicative hash */
+    return (uint16_t)((reg * 40503u) >> 4);
+}
+
+static regcache_entry_t *regcache_find(struct esp_cam_sensor_regcache *cache, uint16_t reg, bool insert)
+{
+    uint16_t idx = regcache_hash(reg) & cache->mask;
+
+    for (uint32_t probe = 0; probe <= cache->mask; probe++) {
+        regcache_entry_t *entry = &cache->entries[idx];
+        if (!entry->valid) {
+            if (!insert || cache->used >= cache->limit) {
+                return NULL;
+            }
+            entry->reg = reg;
+            entry->valid = 0;
+            return entry;
+        }
+        if (entry->reg == reg) {
+            return entry;
+        }
+        idx = (idx + 1) & cache->mask;
+    }
+
+    return NULL;
+}
+
+static void regcache_store(struct esp_cam_sensor_regcache *cache, uint16_t reg, uint8_t val)
+{
+    regcache_entry_t *entry = regcache_find(cache, reg, true);
+    if (entry) {
+        if (!entry->valid) {
+            entry->valid = 1;
+            cache->used++;
+        }
+        entry->val = val;
+    }
+}
+
+esp_err_t esp_cam_sensor_regcache_new(const esp_cam_sensor_regcache_config_t *config,
+                                      esp_cam_sensor_regcache_handle_t *ret_handle)
+{
+    ESP_RETURN_ON_FALSE(ret_handle, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    uint32_t capacity = (config && config->capacity) ? config->capacity : CONFIG_CAMERA_SENSOR_REGCACHE_CAPACITY;
+    uint32_t size = 16;
+    while (size < capacity && size < 0x8000) {
+        size <<= 1;
+    }
+
+    struct esp_cam_sensor_regcache *cache = calloc(1, sizeof(struct esp_cam_sensor_regcache));
+    ESP_RETURN_ON_FALSE(cache, ESP_ERR_NO_MEM, TAG, "no memory for regcache");
+
+    cache->entries = calloc(size, sizeof(regcache_entry_t));
+    if (!cache->entries) {
+        free(cache);
+        ESP_LOGE(TAG, "no memory for %" PRIu32 " regcache entries", size);
+        return ESP_ERR_NO_MEM;
+    }
+    cache->mask = size - 1;
+    cache->limit = size * REGCACHE_LOAD_NUM / REGCACHE_LOAD_DEN;
+
+    *ret_handle = cache;
+    return ESP_OK;
+}
+
+esp_err_t esp_cam_sensor_regcache_write_a16v8(esp_cam_sensor_regcache_handle_t handle, esp_sccb_io_handle_t io_handle,
+                                              uint16_t reg, uint8_t val)
+{
+    if (handle) {
+        regcache_entry_t *entry = regcache_find(handle, reg, false);
+        if (entry && entry->valid && entry->val == val) {
+            handle->stats.elided_writes++;
+            return ESP_OK;
+        }
+    }
+
+    return esp_cam_sensor_regcache_write_through_a16v8(handle, io_handle, reg, val);
+}
+
+esp_err_t esp_cam_sensor_regcache_write_through_a16v8(esp_cam_sensor_regcache_handle_t handle,
+                                                      esp_sccb_io_handle_t io_handle, uint16_t reg, uint8_t val)
+{
+    esp_err_t ret = esp_sccb_transmit_reg_a16v8(io_handle, reg, val);
+    if (!handle) {
+        return ret;
+    }
+
+    handle->stats.bus_writes++;
+    if (ret == ESP_OK) {
+        regcache_store(handle, reg, val);
+    } else {
+        /* The register state is unknown after a failed transfer, the table has no tombstones so drop it all */
+        esp_cam_sensor_regcache_invalidate(handle);
+    }
+    return ret;
+}
+
+esp_err_t esp_cam_sensor_regcache_read_a16v8(esp_cam_sensor_regcache_handle_t handle, esp_sccb_io_handle_t io_handle,
+                                             uint16_t reg, uint8_t *val)
+{
+    ESP_RETURN_ON_FALSE(val, ESP_ERR_INVALID_ARG, TAG, "invalid argument: val null pointer");
+
+    if (handle) {
+        regcache_entry_t *entry = regcache_find(handle, reg, false);
+        if (entry && entry->valid) {
+            handle->stats.cached_reads++;
+            *val = entry->val;
+            return ESP_OK;
+        }
+    }
+
+    esp_err_t ret = esp_sccb_transmit_receive_reg_a16v8(io_handle, reg, val);
+    if (handle) {
+        handle->stats.bus_reads++;
+        if (ret == ESP_OK) {
+            regcache_store(handle, reg, *val);
+        }
+    }
+    return ret;
+}
+
+void esp_cam_sensor_regcache_invalidate(esp_cam_sensor_regcache_handle_t handle)
+{
+    if (handle) {
+        memset(handle->entries, 0, ((size_t)handle->mask + 1) * sizeof(regcache_entry_t));
+        handle->used = 0;
+    }
+}
+
+esp_err_t esp_cam_sensor_regcache_get_stats(esp_cam_sensor_regcache_handle_t handle,
+                                            esp_cam_sensor_regcache_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(handle && stats, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+
+    *stats = handle->stats;
+    return ESP_OK;
+}
+
+void esp_cam_sensor_regcache_reset_stats(esp_cam_sensor_regcache_handle_t handle)
+{
+    if (handle) {
+        memset(&handle->stats, 0, sizeof(handle->stats));
+    }
+}
+
+esp_err_t esp_cam_sensor_regcache_del(esp_cam_sensor_regcache_handle_t handle)
+{
+    if (handle) {
+        free(handle->entries);
+        free(handle);
+    }
+    return ESP_OK;
+}
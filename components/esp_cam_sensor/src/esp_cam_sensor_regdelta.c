@@ -0,0 +1,258 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_check.h"
+
+#include "esp_cam_sensor_regdelta.h"
+
+/**
+ * @brief One register write of a table, tagged with its position so writes of a register keep their order
+ */
+typedef struct {
+    uint16_t reg;
+    uint8_t val;
+    uint8_t in_format;          /*!< Written by the format table rather than the common one */
+    uint32_t pos;
+} regdelta_write_t;
+
+/**
+ * @brief Register state a table sequence leaves the sensor in
+ */
+typedef struct {
+    uint16_t reg;
+    uint8_t val;
+    uint8_t format_writes;      /*!< Writes of the register in the format table */
+    bool changed;
+} regdelta_state_t;
+
+typedef struct {
+    regdelta_state_t *regs;
+    size_t num;
+} regdelta_state_map_t;
+
+static const char *TAG = "cam_regdelta";
+
+static bool regdelta_is_skipped(const esp_cam_sensor_regdelta_config_t *config, uint16_t reg)
+{
+    for (size_t i = 0; i < config->skip_regs_num; i++) {
+        if (config->skip_regs[i] == reg) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static size_t regdelta_table_len(const esp_cam_sensor_regdelta_config_t *config, const esp_cam_sensor_reginfo_a16v8_t *regs)
+{
+    size_t len = 0;
+    if (regs) {
+        while (regs[len].reg != config->end_marker) {
+            len++;
+        }
+    }
+    return len;
+}
+
+static size_t regdelta_collect(const esp_cam_sensor_regdelta_config_t *config, const esp_cam_sensor_reginfo_a16v8_t *regs,
+                               uint8_t in_format, regdelta_write_t *writes, size_t num)
+{
+    for (size_t i = 0; regs && regs[i].reg != config->end_marker; i++) {
+        if (regs[i].reg == config->delay_marker || regdelta_is_skipped(config, regs[i].reg)) {
+            continue;
+        }
+        writes[num].reg = regs[i].reg;
+        writes[num].val = regs[i].val;
+        writes[num].in_format = in_format;
+        writes[num].pos = num;
+        num++;
+    }
+    return num;
+}
+
+static int regdelta_write_cmp(const void *a, const void *b)
+{
+    const regdelta_write_t *wa = a;
+    const regdelta_write_t *wb = b;
+
+    if (wa->reg != wb->reg) {
+        return wa->reg < wb->reg ? -1 : 1;
+    }
+    return wa->pos < wb->pos ? -1 : (wa->pos > wb->pos);
+}
+
+static int regdelta_state_cmp(const void *key, const void *elem)
+{
+    uint16_t reg = *(const uint16_t *)key;
+    const regdelta_state_t *state = elem;
+
+    return reg < state->reg ? -1 : (reg > state->reg);
+}
+
+/* Replay the common table then the format table, keeping the last value of every register */
+static esp_err_t regdelta_build_state(const esp_cam_sensor_regdelta_config_t *config, const void *format_regs,
+                                      regdelta_state_map_t *map)
+{
+    size_t len = regdelta_table_len(config, config->common_regs) + regdelta_table_len(config, format_regs);
+    regdelta_write_t *writes = malloc((len ? len : 1) * sizeof(regdelta_write_t));
+    ESP_RETURN_ON_FALSE(writes, ESP_ERR_NO_MEM, TAG, "no memory for register writes");
+
+    size_t num = regdelta_collect(config, config->common_regs, 0, writes, 0);
+    num = regdelta_collect(config, format_regs, 1, writes, num);
+    qsort(writes, num, sizeof(regdelta_write_t), regdelta_write_cmp);
+
+    map->num = 0;
+    map->regs = malloc((num ? num : 1) * sizeof(regdelta_state_t));
+    if (!map->regs) {
+        free(writes);
+        ESP_LOGE(TAG, "no memory for register state");
+        return ESP_ERR_NO_MEM;
+    }
+
+    for (size_t i = 0; i < num; i++) {
+        regdelta_state_t *state;
+        if (i == 0 || writes[i].reg != writes[i - 1].reg) {
+            state = &map->regs[map->num++];
+            state->reg = writes[i].reg;
+            state->format_writes = 0;
+            state->changed = false;
+        } else {
+            state = &map->regs[map->num - 1];
+        }
+        state->val = writes[i].val;
+        if (writes[i].in_format && state->format_writes < UINT8_MAX) {
+            state->format_writes++;
+        }
+    }
+
+    free(writes);
+    return ESP_OK;
+}
+
+static regdelta_state_t *regdelta_find(regdelta_state_map_t *map, uint16_t reg)
+{
+    return bsearch(&reg, map->regs, map->num, sizeof(regdelta_state_t), regdelta_state_cmp);
+}
+
+/* Flag the target registers whose final value differs, return the number of changed registers */
+static size_t regdelta_compare(regdelta_state_map_t *cur, regdelta_state_map_t *new, size_t *orphans)
+{
+    size_t changed = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    *orphans = 0;
+    while (i < cur->num || j < new->num) {
+        if (j == new->num || (i < cur->num && cur->regs[i].reg < new->regs[j].reg)) {
+            (*orphans)++;
+            i++;
+        } else if (i == cur->num || new->regs[j].reg < cur->regs[i].reg) {
+            new->regs[j++].changed = true;
+            changed++;
+        } else {
+            if (cur->regs[i].val != new->regs[j].val) {
+                new->regs[j].changed = true;
+                changed++;
+            }
+            i++;
+            j++;
+        }
+    }
+
+    return changed;
+}
+
+static void regdelta_emit(esp_cam_sensor_regdelta_t *delta, size_t *pos, uint16_t reg, uint8_t val, bool is_write)
+{
+    delta->regs[*pos].reg = reg;
+    delta->regs[*pos].val = val;
+    (*pos)++;
+    if (is_write) {
+        delta->regs_num++;
+    }
+}
+
+esp_err_t esp_cam_sensor_regdelta_compute(const esp_cam_sensor_regdelta_config_t *config, const void *cur_regs,
+                                          const void *new_regs, esp_cam_sensor_regdelta_t *delta)
+{
+    esp_err_t ret = ESP_OK;
+    size_t orphans = 0;
+    size_t changed = 0;
+    size_t pos = 0;
+    regdelta_state_map_t cur = {0};
+    regdelta_state_map_t new = {0};
+    const esp_cam_sensor_reginfo_a16v8_t *table = new_regs;
+
+    ESP_RETURN_ON_FALSE(config && cur_regs && new_regs && delta, ESP_ERR_INVALID_ARG, TAG, "invalid argument: null pointer");
+    ESP_RETURN_ON_FALSE(!config->skip_regs_num || config->skip_regs, ESP_ERR_INVALID_ARG, TAG, "invalid argument: skip_regs");
+    memset(delta, 0, sizeof(esp_cam_sensor_regdelta_t));
+
+    ESP_GOTO_ON_ERROR(regdelta_build_state(config, cur_regs, &cur), exit, TAG, "failed to build current state");
+    ESP_GOTO_ON_ERROR(regdelta_build_state(config, new_regs, &new), exit, TAG, "failed to build target state");
+
+    changed = regdelta_compare(&cur, &new, &orphans);
+    if (orphans) {
+        delta->orphans = orphans;
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto exit;
+    }
+    if (!changed) {
+        goto exit;
+    }
+
+    delta->regs = malloc((regdelta_table_len(config, config->common_regs) + regdelta_table_len(config, new_regs) + 1) *
+                         sizeof(esp_cam_sensor_reginfo_a16v8_t));
+    ESP_GOTO_ON_FALSE(delta->regs, ESP_ERR_NO_MEM, exit, TAG, "no memory for register delta");
+
+    /* A register whose target value comes from the common table has to be restored before the format table runs */
+    for (size_t i = 0; i < new.num; i++) {
+        if (new.regs[i].changed && !new.regs[i].format_writes) {
+            regdelta_emit(delta, &pos, new.regs[i].reg, new.regs[i].val, true);
+        }
+    }
+
+    for (size_t i = 0; table[i].reg != config->end_marker; i++) {
+        if (table[i].reg == config->delay_marker) {
+            regdelta_emit(delta, &pos, table[i].reg, table[i].val, false);
+            continue;
+        }
+        if (regdelta_is_skipped(config, table[i].reg)) {
+            continue;
+        }
+
+        regdelta_state_t *state = regdelta_find(&new, table[i].reg);
+        /* A register written once is only needed if it changed, sequencing registers are replayed as a whole */
+        if (state && (state->format_writes > 1 || state->changed)) {
+            regdelta_emit(delta, &pos, table[i].reg, table[i].val, true);
+        }
+    }
+
+    delta->regs[pos].reg = config->end_marker;
+    delta->regs[pos].val = 0;
+
+exit:
+    free(cur.regs);
+    free(new.regs);
+    if (ret != ESP_OK) {
+        free(delta->regs);
+        delta->regs = NULL;
+        delta->regs_num = 0;
+    }
+    return ret;
+}
+
+void esp_cam_sensor_regdelta_free(esp_cam_sensor_regdelta_t *delta)
+{
+    if (delta) {
+        free(delta->regs);
+        delta->regs = NULL;
+        delta->regs_num = 0;
+    }
+}
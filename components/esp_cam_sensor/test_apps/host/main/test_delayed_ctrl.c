@@ -0,0 +1,234 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <math.h>
+#include "unity.h"
+
+#include "esp_cam_sensor_delayed_ctrl.h"
+
+#define TEST_SIM_FRAMES     60
+#define TEST_SENSOR_LATENCY 2
+#define TEST_AE_TARGET      128.0
+#define TEST_AE_TOLERANCE   0.02
+#define TEST_SCENE_LUMA     0.032   /* Brightness per exposure line, the target is reached at 4000 lines */
+#define TEST_EXP_MIN        16
+#define TEST_EXP_MAX        8000
+
+static const esp_cam_sensor_ae_ctrl_t s_init = {
+    .exposure_val = 100,
+    .gain_index = 0,
+    .vts = 1250,
+};
+
+static esp_cam_sensor_delayed_ctrl_handle_t create(uint8_t exposure, uint8_t gain, uint8_t vts)
+{
+    esp_cam_sensor_delayed_ctrl_handle_t dc;
+    esp_cam_sensor_delayed_ctrl_config_t config = {
+        .latency = {
+            .exposure = exposure,
+            .gain = gain,
+            .vts = vts,
+        },
+        .init = s_init,
+    };
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_new(&config, &dc));
+    return dc;
+}
+
+TEST_CASE("delayed ctrl reports values after the sensor latency", "[delayed_ctrl]")
+{
+    esp_cam_sensor_ae_ctrl_t ctrl;
+    esp_cam_sensor_ae_ctrl_t next = {.exposure_val = 200, .gain_index = 3, .vts = 1300};
+    esp_cam_sensor_delayed_ctrl_handle_t dc = create(2, 2, 2);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, 5, &next));
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 6, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+    TEST_ASSERT_EQUAL_UINT32(s_init.gain_index, ctrl.gain_index);
+    TEST_ASSERT_EQUAL_UINT32(s_init.vts, ctrl.vts);
+    TEST_ASSERT_FALSE(esp_cam_sensor_delayed_ctrl_settled(dc, 6));
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 7, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(200, ctrl.exposure_val);
+    TEST_ASSERT_EQUAL_UINT32(3, ctrl.gain_index);
+    TEST_ASSERT_EQUAL_UINT32(1300, ctrl.vts);
+    TEST_ASSERT_TRUE(esp_cam_sensor_delayed_ctrl_settled(dc, 7));
+
+    /* Frames older than the write still report the old values */
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 2, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_del(dc));
+}
+
+TEST_CASE("delayed ctrl tracks each control latency on its own", "[delayed_ctrl]")
+{
+    esp_cam_sensor_ae_ctrl_t ctrl;
+    esp_cam_sensor_ae_ctrl_t next = {.exposure_val = 200, .gain_index = 3, .vts = 1300};
+    esp_cam_sensor_delayed_ctrl_handle_t dc = create(2, 1, 0);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, 10, &next));
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 10, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+    TEST_ASSERT_EQUAL_UINT32(s_init.gain_index, ctrl.gain_index);
+    TEST_ASSERT_EQUAL_UINT32(1300, ctrl.vts);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 11, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+    TEST_ASSERT_EQUAL_UINT32(3, ctrl.gain_index);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 12, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(200, ctrl.exposure_val);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_del(dc));
+}
+
+TEST_CASE("delayed ctrl keeps the last write of a frame", "[delayed_ctrl]")
+{
+    esp_cam_sensor_ae_ctrl_t ctrl;
+    esp_cam_sensor_ae_ctrl_t first = {.exposure_val = 200, .gain_index = 3, .vts = 1300};
+    esp_cam_sensor_ae_ctrl_t second = {.exposure_val = 300, .gain_index = 4, .vts = 1400};
+    esp_cam_sensor_delayed_ctrl_handle_t dc = create(2, 2, 2);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, 5, &first));
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, 5, &second));
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 7, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(300, ctrl.exposure_val);
+    TEST_ASSERT_EQUAL_UINT32(4, ctrl.gain_index);
+    TEST_ASSERT_EQUAL_UINT32(1400, ctrl.vts);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_del(dc));
+}
+
+TEST_CASE("delayed ctrl handles sequence wrap and long history", "[delayed_ctrl]")
+{
+    esp_cam_sensor_ae_ctrl_t ctrl;
+    esp_cam_sensor_ae_ctrl_t next = {.exposure_val = 200, .gain_index = 3, .vts = 1300};
+    esp_cam_sensor_delayed_ctrl_handle_t dc = create(2, 2, 2);
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, UINT32_MAX - 1, &next));
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, UINT32_MAX, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 0, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(200, ctrl.exposure_val);
+    TEST_ASSERT_TRUE(esp_cam_sensor_delayed_ctrl_settled(dc, 1));
+
+    /* One write per frame for longer than the history */
+    for (uint32_t seq = 0; seq < 20; seq++) {
+        next.exposure_val = 1000 + seq;
+        TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, seq, &next));
+    }
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 21, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(1019, ctrl.exposure_val);
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 15, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(1013, ctrl.exposure_val);
+    /* Frames older than the history get the oldest value known */
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 3, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(1011, ctrl.exposure_val);
+
+    esp_cam_sensor_delayed_ctrl_reset(dc, &s_init);
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, 21, &ctrl));
+    TEST_ASSERT_EQUAL_UINT32(s_init.exposure_val, ctrl.exposure_val);
+    TEST_ASSERT_TRUE(esp_cam_sensor_delayed_ctrl_settled(dc, 0));
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_del(dc));
+}
+
+/**
+ * Closed AE loop against a sensor that applies exposure TEST_SENSOR_LATENCY frames after the write.
+ * The controller divides the measured brightness by the exposure it believes the frame had,
+ * a wrong belief makes it correct the same error again while the first correction is in flight.
+ */
+typedef struct {
+    int settle_frame;       /* First frame after which the brightness stays in tolerance, -1 if never */
+    double max_overshoot;   /* Largest brightness above the target, relative to it */
+} ae_sim_result_t;
+
+static ae_sim_result_t run_ae_sim(bool latency_aware)
+{
+    uint32_t written[TEST_SIM_FRAMES] = {0};
+    uint32_t last_write = 1000;
+    ae_sim_result_t result = {.settle_frame = -1, .max_overshoot = 0.0};
+    esp_cam_sensor_delayed_ctrl_handle_t dc;
+    esp_cam_sensor_delayed_ctrl_config_t config = {
+        .latency = {
+            .exposure = TEST_SENSOR_LATENCY,
+            .gain = TEST_SENSOR_LATENCY,
+            .vts = TEST_SENSOR_LATENCY,
+        },
+        .init = {.exposure_val = last_write, .gain_index = 0, .vts = 5000},
+    };
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_new(&config, &dc));
+
+    for (int frame = 0; frame < TEST_SIM_FRAMES; frame++) {
+        /* Sensor side: the frame uses the newest value written at least TEST_SENSOR_LATENCY frames ago */
+        uint32_t exposure = config.init.exposure_val;
+        for (int w = frame - TEST_SENSOR_LATENCY; w >= 0; w--) {
+            if (written[w]) {
+                exposure = written[w];
+                break;
+            }
+        }
+        double luma = TEST_SCENE_LUMA * exposure;
+        double error = fabs(luma - TEST_AE_TARGET) / TEST_AE_TARGET;
+
+        if (luma > TEST_AE_TARGET) {
+            result.max_overshoot = fmax(result.max_overshoot, (luma - TEST_AE_TARGET) / TEST_AE_TARGET);
+        }
+        if (error > TEST_AE_TOLERANCE) {
+            result.settle_frame = -1;
+        } else if (result.settle_frame < 0) {
+            result.settle_frame = frame;
+        }
+
+        /* Controller side: statistics of this frame arrive, the new exposure is latched in the next one */
+        uint32_t believed = last_write;
+        if (latency_aware) {
+            esp_cam_sensor_ae_ctrl_t ctrl;
+
+            TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_get(dc, frame, &ctrl));
+            believed = ctrl.exposure_val;
+        }
+
+        uint32_t target = (uint32_t)(believed * TEST_AE_TARGET / luma + 0.5);
+        target = target < TEST_EXP_MIN ? TEST_EXP_MIN : target;
+        target = target > TEST_EXP_MAX ? TEST_EXP_MAX : target;
+        if (frame + 1 < TEST_SIM_FRAMES && target != last_write) {
+            esp_cam_sensor_ae_ctrl_t ctrl = {.exposure_val = target, .gain_index = 0, .vts = 5000};
+
+            written[frame + 1] = target;
+            last_write = target;
+            TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_push(dc, frame + 1, &ctrl));
+        }
+    }
+
+    TEST_ESP_OK(esp_cam_sensor_delayed_ctrl_del(dc));
+    return result;
+}
+
+TEST_CASE("delayed ctrl AE loop converges without overshoot", "[delayed_ctrl]")
+{
+    ae_sim_result_t naive = run_ae_sim(false);
+    ae_sim_result_t aware = run_ae_sim(true);
+
+    printf("AE with %d frames sensor latency: naive settles at frame %d (overshoot %.0f%%), "
+           "latency aware settles at frame %d (overshoot %.0f%%)\n",
+           TEST_SENSOR_LATENCY, naive.settle_frame, naive.max_overshoot * 100,
+           aware.settle_frame, aware.max_overshoot * 100);
+
+    TEST_ASSERT_TRUE(aware.settle_frame >= 0);
+    TEST_ASSERT_TRUE(aware.settle_frame <= 2 * (TEST_SENSOR_LATENCY + 1));
+    TEST_ASSERT_TRUE(aware.max_overshoot <= TEST_AE_TOLERANCE);
+    TEST_ASSERT_TRUE(naive.settle_frame < 0 || naive.settle_frame > aware.settle_frame);
+    TEST_ASSERT_TRUE(naive.max_overshoot > aware.max_overshoot);
+}
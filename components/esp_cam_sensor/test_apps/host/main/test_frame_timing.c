@@ -0,0 +1,164 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "unity.h"
+
+#include "esp_cam_sensor_frame_timing.h"
+
+/* SC202CS 1600x1200 RAW8 format, 72MHz / (1920 x 1250) = 30fps */
+static const esp_cam_sensor_frame_timing_t s_sc202cs_timing = {
+    .pclk = 72000000,
+    .hts = 1920,
+    .vts_min = 1250,
+    .vts_max = 0x7fff,
+    .exp_margin = 6,
+};
+
+/* OV5647 640x480 RAW8 custom format, the format rate is not an integer */
+static const esp_cam_sensor_frame_timing_t s_ov5647_timing = {
+    .pclk = 61333333,
+    .hts = 1896,
+    .vts_min = 1086,
+    .vts_max = 0x7fff,
+    .exp_margin = 4,
+};
+
+static const esp_cam_sensor_night_mode_config_t s_night_config = {
+    .day_fps = 30,
+    .night_fps = 10,
+    .enter_gain = 8000,
+    .exit_gain = 2000,
+    .hold_frames = 5,
+};
+
+TEST_CASE("frame timing converts between frame rate and frame length", "[frame_timing]")
+{
+    TEST_ASSERT_EQUAL_UINT32(1250, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 30));
+    TEST_ASSERT_EQUAL_UINT32(2500, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 15));
+    TEST_ASSERT_EQUAL_UINT32(3750, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 10));
+
+    /* 1fps needs a longer frame than the VTS register holds, see the clamp test */
+    for (uint32_t fps = 2; fps <= 30; fps++) {
+        uint32_t vts = esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, fps);
+
+        TEST_ASSERT_EQUAL_UINT32(fps, esp_cam_sensor_frame_timing_fps(&s_sc202cs_timing, vts));
+        /* Rounded up, the frame is never shorter than the requested rate allows */
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(1000000 / fps, esp_cam_sensor_frame_timing_frame_us(&s_sc202cs_timing, vts) + 1);
+    }
+
+    /* 61.33MHz / (1896 x 1086) = 29.78fps, reported as 30 */
+    TEST_ASSERT_EQUAL_UINT32(30, esp_cam_sensor_frame_timing_fps(&s_ov5647_timing, 1086));
+    TEST_ASSERT_EQUAL_UINT32(1086, esp_cam_sensor_frame_timing_vts(&s_ov5647_timing, 30));
+    TEST_ASSERT_EQUAL_UINT32(3235, esp_cam_sensor_frame_timing_vts(&s_ov5647_timing, 10));
+}
+
+TEST_CASE("frame timing clamps to the format and the VTS register", "[frame_timing]")
+{
+    uint32_t min_fps;
+    uint32_t max_fps;
+
+    TEST_ASSERT_EQUAL_UINT32(1250, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 60));
+    TEST_ASSERT_EQUAL_UINT32(0x7fff, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 1));
+    TEST_ASSERT_EQUAL_UINT32(0, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 0));
+
+    TEST_ESP_OK(esp_cam_sensor_frame_timing_fps_range(&s_sc202cs_timing, &min_fps, &max_fps));
+    TEST_ASSERT_EQUAL_UINT32(2, min_fps);
+    TEST_ASSERT_EQUAL_UINT32(30, max_fps);
+    TEST_ASSERT_LESS_OR_EQUAL_UINT32(0x7fff, esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, min_fps));
+
+    esp_cam_sensor_frame_timing_t bad = s_sc202cs_timing;
+    bad.vts_max = bad.vts_min - 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cam_sensor_frame_timing_fps_range(&bad, &min_fps, &max_fps));
+    TEST_ASSERT_EQUAL_UINT32(0, esp_cam_sensor_frame_timing_vts(&bad, 30));
+}
+
+TEST_CASE("frame timing exposure cap follows the frame length", "[frame_timing]")
+{
+    uint32_t line_ns = esp_cam_sensor_frame_timing_line_ns(&s_sc202cs_timing);
+
+    TEST_ASSERT_EQUAL_UINT32(26666, line_ns);
+    TEST_ASSERT_EQUAL_UINT32(33333, esp_cam_sensor_frame_timing_frame_us(&s_sc202cs_timing, 1250));
+    TEST_ASSERT_EQUAL_UINT32(100000, esp_cam_sensor_frame_timing_frame_us(&s_sc202cs_timing, 3750));
+
+    /* Slowing from 30 to 10fps triples the longest exposure, the line time is unchanged */
+    TEST_ASSERT_EQUAL_UINT32(1244, esp_cam_sensor_frame_timing_exposure_max(&s_sc202cs_timing, 1250));
+    TEST_ASSERT_EQUAL_UINT32(3744, esp_cam_sensor_frame_timing_exposure_max(&s_sc202cs_timing,
+                                                                              esp_cam_sensor_frame_timing_vts(&s_sc202cs_timing, 10)));
+}
+
+TEST_CASE("night mode validates its configuration", "[frame_timing]")
+{
+    esp_cam_sensor_night_mode_t night;
+    esp_cam_sensor_night_mode_config_t config = s_night_config;
+
+    TEST_ESP_OK(esp_cam_sensor_night_mode_init(&night, &config, &s_sc202cs_timing));
+    TEST_ASSERT_FALSE(night.night);
+
+    config.night_fps = config.day_fps;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cam_sensor_night_mode_init(&night, &config, &s_sc202cs_timing));
+
+    config = s_night_config;
+    config.exit_gain = config.enter_gain;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cam_sensor_night_mode_init(&night, &config, &s_sc202cs_timing));
+
+    config = s_night_config;
+    config.exit_gain = 500;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cam_sensor_night_mode_init(&night, &config, &s_sc202cs_timing));
+}
+
+TEST_CASE("night mode switches with hysteresis and does not oscillate", "[frame_timing]")
+{
+    esp_cam_sensor_night_mode_t night;
+    TEST_ESP_OK(esp_cam_sensor_night_mode_init(&night, &s_night_config, &s_sc202cs_timing));
+
+    uint32_t day_exp = night.day_exposure_us;
+    uint32_t night_exp = day_exp * 3;
+
+    /* A short dark spike shorter than the hold time keeps the day rate */
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL_UINT32(30, esp_cam_sensor_night_mode_update(&night, day_exp, 16000));
+    }
+    TEST_ASSERT_EQUAL_UINT32(30, esp_cam_sensor_night_mode_update(&night, day_exp, 4000));
+    TEST_ASSERT_FALSE(night.night);
+
+    /* Dark scene: the longest day exposure at 16x gain */
+    uint32_t fps = 30;
+    int switch_frame = -1;
+    for (int i = 0; i < 10; i++) {
+        fps = esp_cam_sensor_night_mode_update(&night, day_exp, 16000);
+        if (fps == 10 && switch_frame < 0) {
+            switch_frame = i;
+        }
+    }
+    TEST_ASSERT_EQUAL(4, switch_frame);
+    TEST_ASSERT_TRUE(night.night);
+
+    /*
+     * Same scene at night: AE triples the exposure and drops the gain to 16/3x. The scene needs the
+     * same exposure at 1x gain, which is still above the exit threshold, so the rate stays low.
+     */
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_EQUAL_UINT32(10, esp_cam_sensor_night_mode_update(&night, night_exp, 5333));
+    }
+
+    /* Between both thresholds, in either state, nothing changes */
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_EQUAL_UINT32(10, esp_cam_sensor_night_mode_update(&night, night_exp, 1000));
+    }
+
+    /* Lights on: the scene needs less than 2x of the day exposure */
+    for (int i = 0; i < 10; i++) {
+        fps = esp_cam_sensor_night_mode_update(&night, night_exp / 3, 1500);
+    }
+    TEST_ASSERT_EQUAL_UINT32(30, fps);
+    TEST_ASSERT_FALSE(night.night);
+
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT_EQUAL_UINT32(30, esp_cam_sensor_night_mode_update(&night, day_exp, 6000));
+    }
+}
@@ -0,0 +1,241 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+
+#include "esp_cam_sensor_regcache.h"
+#include "test_sccb_mock.h"
+
+/* Exposure and gain registers laid out like the SC202CS / OV5647 ones */
+#define TEST_REG_EXP_H      0x3e00
+#define TEST_REG_EXP_M      0x3e01
+#define TEST_REG_EXP_L      0x3e02
+#define TEST_REG_DGAIN      0x3e06
+#define TEST_REG_DGAIN_FINE 0x3e07
+#define TEST_REG_AGAIN      0x3e09
+#define TEST_REG_HTS_H      0x380c
+#define TEST_REG_HTS_L      0x380d
+#define TEST_REG_VTS_H      0x380e
+#define TEST_REG_VTS_L      0x380f
+
+#define TEST_AE_STEPS       120
+
+typedef struct {
+    uint16_t reg;
+    uint8_t val;
+} test_reginfo_t;
+
+static const test_reginfo_t s_format_regs[] = {
+    {0x3034, 0x1a}, {0x3035, 0x21}, {0x3036, 0x62}, {0x3037, 0x03},
+    {TEST_REG_HTS_H, 0x07}, {TEST_REG_HTS_L, 0x68}, {TEST_REG_VTS_H, 0x04}, {TEST_REG_VTS_L, 0x65},
+    {TEST_REG_EXP_H, 0x00}, {TEST_REG_EXP_M, 0x40}, {TEST_REG_EXP_L, 0x00},
+    {TEST_REG_DGAIN, 0x00}, {TEST_REG_DGAIN_FINE, 0x80}, {TEST_REG_AGAIN, 0x00},
+};
+
+static void load_format(esp_cam_sensor_regcache_handle_t cache, esp_sccb_io_handle_t io)
+{
+    esp_cam_sensor_regcache_invalidate(cache);
+    for (size_t i = 0; i < sizeof(s_format_regs) / sizeof(s_format_regs[0]); i++) {
+        TEST_ESP_OK(esp_cam_sensor_regcache_write_through_a16v8(cache, io, s_format_regs[i].reg, s_format_regs[i].val));
+    }
+}
+
+/* One AE iteration the way the sensor drivers do it: frame timing lookup, exposure and gain update */
+static void ae_step(esp_cam_sensor_regcache_handle_t cache, esp_sccb_io_handle_t io, uint32_t exposure, uint32_t gain)
+{
+    uint8_t hi, lo;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, TEST_REG_VTS_H, &hi));
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, TEST_REG_VTS_L, &lo));
+    uint32_t exposure_max = ((hi << 8) | lo) - 6;
+    if (exposure > exposure_max) {
+        exposure = exposure_max;
+    }
+    exposure <<= 4;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_EXP_H, (exposure >> 16) & 0x0f));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_EXP_M, (exposure >> 8) & 0xff));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_EXP_L, exposure & 0xf0));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_DGAIN, (gain >> 12) & 0x03));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_DGAIN_FINE, (gain >> 4) & 0xff));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, TEST_REG_AGAIN, gain & 0x0f));
+}
+
+/* Exposure converges within a few frames then only jitters on its low byte, gain rarely moves */
+static void ae_trace(int step, uint32_t *exposure, uint32_t *gain)
+{
+    *exposure = step < 8 ? 200 + step * 60 : 680 + (step % 4 == 0 ? 1 : 0);
+    *gain = step < 16 ? 0x80 + step * 4 : 0xc0;
+}
+
+static uint32_t run_ae_loop(test_sccb_mock_t *mock, esp_cam_sensor_regcache_handle_t cache)
+{
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+
+    load_format(cache, io);
+    test_sccb_mock_reset_counters(mock);
+    for (int i = 0; i < TEST_AE_STEPS; i++) {
+        uint32_t exposure, gain;
+        ae_trace(i, &exposure, &gain);
+        ae_step(cache, io, exposure, gain);
+    }
+    return mock->writes + mock->reads;
+}
+
+TEST_CASE("regcache elides writes of the value already held", "[regcache]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    esp_cam_sensor_regcache_handle_t cache = NULL;
+    esp_cam_sensor_regcache_stats_t stats;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_new(NULL, &cache));
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3500, 0x12));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3500, 0x12));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3500, 0x34));
+    TEST_ASSERT_EQUAL_UINT32(2, mock->writes);
+    TEST_ASSERT_EQUAL_HEX8(0x34, mock->regs[0x3500]);
+
+    /* Write-through always reaches the bus */
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_through_a16v8(cache, io, 0x3500, 0x34));
+    TEST_ASSERT_EQUAL_UINT32(3, mock->writes);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_get_stats(cache, &stats));
+    TEST_ASSERT_EQUAL_UINT32(3, stats.bus_writes);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.elided_writes);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(cache));
+    free(mock);
+}
+
+TEST_CASE("regcache serves known registers without bus reads", "[regcache]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    esp_cam_sensor_regcache_handle_t cache = NULL;
+    uint8_t val = 0;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_new(NULL, &cache));
+    mock->regs[0x380c] = 0x07;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, 0x380c, &val));
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, 0x380c, &val));
+    TEST_ASSERT_EQUAL_HEX8(0x07, val);
+    TEST_ASSERT_EQUAL_UINT32(1, mock->reads);
+
+    /* A written value is visible to later reads without touching the bus */
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x380d, 0x68));
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, 0x380d, &val));
+    TEST_ASSERT_EQUAL_HEX8(0x68, val);
+    TEST_ASSERT_EQUAL_UINT32(1, mock->reads);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(cache));
+    free(mock);
+}
+
+TEST_CASE("regcache is dropped on invalidate and on bus errors", "[regcache]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    esp_cam_sensor_regcache_handle_t cache = NULL;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_new(NULL, &cache));
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x0100, 0x01));
+    /* Sensor reset behind the driver's back */
+    mock->regs[0x0100] = 0x00;
+    esp_cam_sensor_regcache_invalidate(cache);
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x0100, 0x01));
+    TEST_ASSERT_EQUAL_UINT32(2, mock->writes);
+    TEST_ASSERT_EQUAL_HEX8(0x01, mock->regs[0x0100]);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3501, 0x22));
+    mock->fail_after = 0;
+    TEST_ASSERT_NOT_EQUAL(ESP_OK, esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3502, 0x33));
+    mock->fail_after = -1;
+    /* The failure made every shadowed value unknown, so the next write must reach the bus */
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, 0x3501, 0x22));
+    TEST_ASSERT_EQUAL_UINT32(5, mock->writes);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(cache));
+    free(mock);
+}
+
+TEST_CASE("regcache keeps working when full", "[regcache]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    esp_cam_sensor_regcache_config_t config = {.capacity = 16};
+    esp_cam_sensor_regcache_handle_t cache = NULL;
+    uint8_t val;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_new(&config, &cache));
+    for (uint16_t reg = 0x3000; reg < 0x3100; reg++) {
+        TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(cache, io, reg, reg & 0xff));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0x100, mock->writes);
+    for (uint16_t reg = 0x3000; reg < 0x3100; reg++) {
+        TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(cache, io, reg, &val));
+        TEST_ASSERT_EQUAL_HEX8(reg & 0xff, val);
+    }
+    /* Only the registers that fitted are served from the shadow */
+    TEST_ASSERT_LESS_THAN_UINT32(0x100, mock->reads);
+    TEST_ASSERT_GREATER_THAN_UINT32(0x100 - 16, mock->reads);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(cache));
+    free(mock);
+}
+
+TEST_CASE("regcache NULL handle is a plain SCCB passthrough", "[regcache]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    uint8_t val;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(NULL, io, 0x3500, 0x12));
+    TEST_ESP_OK(esp_cam_sensor_regcache_write_a16v8(NULL, io, 0x3500, 0x12));
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(NULL, io, 0x3500, &val));
+    TEST_ESP_OK(esp_cam_sensor_regcache_read_a16v8(NULL, io, 0x3500, &val));
+    TEST_ASSERT_EQUAL_UINT32(2, mock->writes);
+    TEST_ASSERT_EQUAL_UINT32(2, mock->reads);
+    esp_cam_sensor_regcache_invalidate(NULL);
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(NULL));
+
+    free(mock);
+}
+
+TEST_CASE("regcache SCCB transactions per AE step", "[regcache]")
+{
+    test_sccb_mock_t *plain = calloc(1, sizeof(test_sccb_mock_t));
+    test_sccb_mock_t *cached = calloc(1, sizeof(test_sccb_mock_t));
+    esp_cam_sensor_regcache_handle_t cache = NULL;
+    esp_cam_sensor_regcache_stats_t stats;
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_new(NULL, &cache));
+
+    uint32_t plain_xfers = run_ae_loop(plain, NULL);
+    esp_cam_sensor_regcache_reset_stats(cache);
+    uint32_t cached_xfers = run_ae_loop(cached, cache);
+    TEST_ESP_OK(esp_cam_sensor_regcache_get_stats(cache, &stats));
+
+    printf("SCCB transactions per AE step: plain %.2f, cached %.2f (elided writes %u, cached reads %u)\n",
+           (float)plain_xfers / TEST_AE_STEPS, (float)cached_xfers / TEST_AE_STEPS,
+           (unsigned)stats.elided_writes, (unsigned)stats.cached_reads);
+
+    /* The sensor must end up in exactly the same state */
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(plain->regs, cached->regs, sizeof(plain->regs));
+    TEST_ASSERT_EQUAL_UINT32(TEST_AE_STEPS * 8, plain_xfers);
+    TEST_ASSERT_EQUAL_UINT32(0, cached->reads);
+    TEST_ASSERT_LESS_THAN_UINT32(plain_xfers / 4, cached_xfers);
+
+    TEST_ESP_OK(esp_cam_sensor_regcache_del(cache));
+    free(cached);
+    free(plain);
+}
@@ -0,0 +1,243 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+
+#include "esp_cam_sensor_regdelta.h"
+#include "esp_sccb_intf.h"
+#include "test_sccb_mock.h"
+
+#define TEST_REG_END        0xffff
+#define TEST_REG_DELAY      0xeeee
+#define TEST_REG_STREAM     0x0100
+#define TEST_REG_RESET      0x0103
+#define TEST_REG_PLL_CTRL   0x36e9
+#define TEST_REG_MIPI_CTRL  0x4800
+
+/* 400 kHz SCCB, a 16-bit address write is start + 3 bytes + stop, a bit under 100 us with bus turnaround */
+#define TEST_SCCB_WRITE_US  95
+#define TEST_SWITCH_LOOPS   1000
+#define TEST_TABLE_MAX      160
+
+static const uint16_t s_skip_regs[] = {TEST_REG_STREAM, TEST_REG_RESET};
+
+static const esp_cam_sensor_reginfo_a16v8_t s_reset_regs[] = {
+    {TEST_REG_STREAM, 0x00},
+    {TEST_REG_RESET, 0x01},
+    {TEST_REG_DELAY, 0x0a},
+    {TEST_REG_MIPI_CTRL, 0x01},
+    {TEST_REG_END, 0x00},
+};
+
+static const esp_cam_sensor_regdelta_config_t s_config = {
+    .end_marker = TEST_REG_END,
+    .delay_marker = TEST_REG_DELAY,
+    .common_regs = s_reset_regs,
+    .skip_regs = s_skip_regs,
+    .skip_regs_num = sizeof(s_skip_regs) / sizeof(s_skip_regs[0]),
+};
+
+/* Two formats of the same sensor, laid out like the SC202CS ones: PLL bracketed by a power down of 0x36e9 */
+static const esp_cam_sensor_reginfo_a16v8_t s_fmt_1600x1200[] = {
+    {TEST_REG_PLL_CTRL, 0x80}, {0x36ea, 0x0f}, {0x36eb, 0x24}, {0x36ec, 0x0d},
+    {0x3200, 0x00}, {0x3201, 0x00}, {0x3202, 0x00}, {0x3203, 0x00},
+    {0x3204, 0x06}, {0x3205, 0x47}, {0x3206, 0x04}, {0x3207, 0xb7},
+    {0x3208, 0x06}, {0x3209, 0x40}, {0x320a, 0x04}, {0x320b, 0xb0},
+    {0x320e, 0x04}, {0x320f, 0xe2}, {0x3301, 0xff}, {0x3304, 0x68},
+    {TEST_REG_PLL_CTRL, 0x24},
+    {TEST_REG_STREAM, 0x01},
+    {TEST_REG_END, 0x00},
+};
+
+static const esp_cam_sensor_reginfo_a16v8_t s_fmt_1600x900[] = {
+    {TEST_REG_PLL_CTRL, 0x80}, {0x36ea, 0x0f}, {0x36eb, 0x24}, {0x36ec, 0x0d},
+    {0x3200, 0x00}, {0x3201, 0x00}, {0x3202, 0x00}, {0x3203, 0x96},
+    {0x3204, 0x06}, {0x3205, 0x47}, {0x3206, 0x04}, {0x3207, 0x21},
+    {0x3208, 0x06}, {0x3209, 0x40}, {0x320a, 0x03}, {0x320b, 0x84},
+    {0x320e, 0x04}, {0x320f, 0xe2}, {0x3301, 0xff}, {0x3304, 0x68},
+    {TEST_REG_PLL_CTRL, 0x24},
+    {TEST_REG_STREAM, 0x01},
+    {TEST_REG_END, 0x00},
+};
+
+static uint32_t write_table(esp_sccb_io_handle_t io, const esp_cam_sensor_reginfo_a16v8_t *regs)
+{
+    uint32_t delay_ms = 0;
+
+    for (size_t i = 0; regs[i].reg != TEST_REG_END; i++) {
+        if (regs[i].reg == TEST_REG_DELAY) {
+            delay_ms += regs[i].val;
+        } else {
+            TEST_ESP_OK(esp_sccb_transmit_reg_a16v8(io, regs[i].reg, regs[i].val));
+        }
+    }
+    return delay_ms;
+}
+
+/* What set_format does today: reset sequence then the whole format table, returns the time spent in delays */
+static uint32_t full_switch(test_sccb_mock_t *mock, esp_sccb_io_handle_t io, const esp_cam_sensor_reginfo_a16v8_t *regs)
+{
+    memset(mock->regs, 0, sizeof(mock->regs));
+    uint32_t delay_ms = write_table(io, s_reset_regs);
+    return delay_ms + write_table(io, regs);
+}
+
+/* Build a format of @p num registers, every @p stride-th value differs between variants */
+static void build_format(esp_cam_sensor_reginfo_a16v8_t *regs, size_t num, uint8_t variant, size_t stride)
+{
+    for (size_t i = 0; i < num; i++) {
+        regs[i].reg = 0x3000 + i;
+        regs[i].val = (uint8_t)(i * 7 + ((i % stride) == 0 ? variant : 0));
+    }
+    regs[num].reg = TEST_REG_END;
+    regs[num].val = 0;
+}
+
+static int64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+TEST_CASE("regdelta leaves the sensor in the state of a full reload", "[regdelta]")
+{
+    test_sccb_mock_t *full = calloc(1, sizeof(test_sccb_mock_t));
+    test_sccb_mock_t *fast = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t full_io = test_sccb_mock_init(full);
+    esp_sccb_io_handle_t fast_io = test_sccb_mock_init(fast);
+    esp_cam_sensor_regdelta_t delta;
+
+    full_switch(full, full_io, s_fmt_1600x900);
+    full_switch(fast, fast_io, s_fmt_1600x1200);
+
+    TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, s_fmt_1600x1200, s_fmt_1600x900, &delta));
+    test_sccb_mock_reset_counters(fast);
+    write_table(fast_io, delta.regs);
+
+    /* Only the streaming bit may differ, it is owned by s_stream and never part of a delta */
+    fast->regs[TEST_REG_STREAM] = full->regs[TEST_REG_STREAM];
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(full->regs, fast->regs, sizeof(full->regs));
+    TEST_ASSERT_EQUAL_UINT32(delta.regs_num, fast->writes);
+
+    /* 4 window registers changed, plus the PLL power down and up around them */
+    TEST_ASSERT_EQUAL(6, delta.regs_num);
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_PLL_CTRL, delta.regs[0].reg);
+    TEST_ASSERT_EQUAL_HEX8(0x80, delta.regs[0].val);
+    TEST_ASSERT_EQUAL_HEX16(0x3203, delta.regs[1].reg);
+    TEST_ASSERT_EQUAL_HEX16(0x320b, delta.regs[4].reg);
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_PLL_CTRL, delta.regs[5].reg);
+    TEST_ASSERT_EQUAL_HEX8(0x24, delta.regs[5].val);
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_END, delta.regs[6].reg);
+
+    esp_cam_sensor_regdelta_free(&delta);
+    TEST_ASSERT_NULL(delta.regs);
+    free(fast);
+    free(full);
+}
+
+TEST_CASE("regdelta of identical formats is empty", "[regdelta]")
+{
+    esp_cam_sensor_regdelta_t delta;
+
+    TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, s_fmt_1600x1200, s_fmt_1600x1200, &delta));
+    TEST_ASSERT_EQUAL(0, delta.regs_num);
+    TEST_ASSERT_NULL(delta.regs);
+    esp_cam_sensor_regdelta_free(&delta);
+}
+
+TEST_CASE("regdelta refuses switches that need a reset", "[regdelta]")
+{
+    esp_cam_sensor_regdelta_t delta;
+    const esp_cam_sensor_reginfo_a16v8_t with_test_pattern[] = {
+        {0x3200, 0x00}, {0x4501, 0xc8}, {TEST_REG_END, 0x00},
+    };
+    const esp_cam_sensor_reginfo_a16v8_t without_test_pattern[] = {
+        {0x3200, 0x00}, {TEST_REG_END, 0x00},
+    };
+
+    /* 0x4501 would keep its value instead of going back to the reset default */
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_SUPPORTED,
+                      esp_cam_sensor_regdelta_compute(&s_config, with_test_pattern, without_test_pattern, &delta));
+    TEST_ASSERT_EQUAL(1, delta.orphans);
+    TEST_ASSERT_NULL(delta.regs);
+
+    /* The other way round only sets one more register */
+    TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, without_test_pattern, with_test_pattern, &delta));
+    TEST_ASSERT_EQUAL(1, delta.regs_num);
+    TEST_ASSERT_EQUAL_HEX16(0x4501, delta.regs[0].reg);
+    esp_cam_sensor_regdelta_free(&delta);
+}
+
+TEST_CASE("regdelta restores registers of the common table", "[regdelta]")
+{
+    esp_cam_sensor_regdelta_t delta;
+    const esp_cam_sensor_reginfo_a16v8_t continuous_clock[] = {
+        {TEST_REG_MIPI_CTRL, 0x04}, {0x3200, 0x00}, {TEST_REG_DELAY, 0x05}, {TEST_REG_END, 0x00},
+    };
+    const esp_cam_sensor_reginfo_a16v8_t gated_clock[] = {
+        {0x3200, 0x00}, {TEST_REG_DELAY, 0x05}, {TEST_REG_END, 0x00},
+    };
+
+    /* 0x4800 is set by the reset sequence, so the target state is known even though its table leaves it alone */
+    TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, continuous_clock, gated_clock, &delta));
+    TEST_ASSERT_EQUAL(1, delta.regs_num);
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_MIPI_CTRL, delta.regs[0].reg);
+    TEST_ASSERT_EQUAL_HEX8(0x01, delta.regs[0].val);
+    /* Delays of the target table are kept in place */
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_DELAY, delta.regs[1].reg);
+    TEST_ASSERT_EQUAL_HEX16(TEST_REG_END, delta.regs[2].reg);
+    esp_cam_sensor_regdelta_free(&delta);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_cam_sensor_regdelta_compute(&s_config, NULL, gated_clock, &delta));
+}
+
+TEST_CASE("regdelta resolution switch time, full reload vs delta", "[regdelta]")
+{
+    test_sccb_mock_t *mock = calloc(1, sizeof(test_sccb_mock_t));
+    esp_sccb_io_handle_t io = test_sccb_mock_init(mock);
+    esp_cam_sensor_reginfo_a16v8_t *fmt_a = calloc(TEST_TABLE_MAX + 1, sizeof(esp_cam_sensor_reginfo_a16v8_t));
+    esp_cam_sensor_reginfo_a16v8_t *fmt_b = calloc(TEST_TABLE_MAX + 1, sizeof(esp_cam_sensor_reginfo_a16v8_t));
+    esp_cam_sensor_regdelta_t delta;
+
+    /* Typical sensor table, about 1 register in 8 (window, timing, PLL divider) differs between resolutions */
+    build_format(fmt_a, TEST_TABLE_MAX, 0, 8);
+    build_format(fmt_b, TEST_TABLE_MAX, 1, 8);
+
+    test_sccb_mock_reset_counters(mock);
+    uint32_t full_delay_ms = full_switch(mock, io, fmt_b);
+    uint32_t full_writes = mock->writes;
+    uint32_t full_us = full_writes * TEST_SCCB_WRITE_US + full_delay_ms * 1000;
+
+    int64_t start = now_ns();
+    for (int i = 0; i < TEST_SWITCH_LOOPS; i++) {
+        TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, fmt_a, fmt_b, &delta));
+        esp_cam_sensor_regdelta_free(&delta);
+    }
+    int64_t compute_ns = (now_ns() - start) / TEST_SWITCH_LOOPS;
+
+    TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&s_config, fmt_a, fmt_b, &delta));
+    full_switch(mock, io, fmt_a);
+    test_sccb_mock_reset_counters(mock);
+    uint32_t delta_delay_ms = write_table(io, delta.regs);
+    uint32_t delta_writes = mock->writes;
+    uint32_t delta_us = delta_writes * TEST_SCCB_WRITE_US + delta_delay_ms * 1000 + (uint32_t)(compute_ns / 1000);
+
+    printf("Resolution switch: full reload %u writes %u us, delta %u writes %u us (delta computed in %u ns on host)\n",
+           (unsigned)full_writes, (unsigned)full_us, (unsigned)delta_writes, (unsigned)delta_us, (unsigned)compute_ns);
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_TABLE_MAX / 8, delta_writes);
+    TEST_ASSERT_LESS_THAN_UINT32(full_us / 4, delta_us);
+
+    esp_cam_sensor_regdelta_free(&delta);
+    free(fmt_b);
+    free(fmt_a);
+    free(mock);
+}
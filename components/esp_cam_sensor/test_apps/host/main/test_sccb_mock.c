@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "test_sccb_mock.h"
+
+static esp_err_t mock_take_transaction(test_sccb_mock_t *mock)
+{
+    if (mock->fail_after == 0) {
+        return ESP_ERR_TIMEOUT;
+    }
+    if (mock->fail_after > 0) {
+        mock->fail_after--;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t mock_transmit_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer, size_t write_size,
+                                         int xfer_timeout_ms)
+{
+    test_sccb_mock_t *mock = (test_sccb_mock_t *)io_handle;
+
+    mock->writes++;
+    if (write_size != 3) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    esp_err_t ret = mock_take_transaction(mock);
+    if (ret == ESP_OK) {
+        mock->regs[(write_buffer[0] << 8) | write_buffer[1]] = write_buffer[2];
+    }
+    return ret;
+}
+
+static esp_err_t mock_transmit_receive_reg_a16v8(esp_sccb_io_t *io_handle, const uint8_t *write_buffer,
+                                                 size_t write_size, uint8_t *read_buffer, size_t read_size,
+                                                 int xfer_timeout_ms)
+{
+    test_sccb_mock_t *mock = (test_sccb_mock_t *)io_handle;
+
+    mock->reads++;
+    if (write_size != 2 || read_size != 1) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    esp_err_t ret = mock_take_transaction(mock);
+    if (ret == ESP_OK) {
+        *read_buffer = mock->regs[(write_buffer[0] << 8) | write_buffer[1]];
+    }
+    return ret;
+}
+
+esp_sccb_io_handle_t test_sccb_mock_init(test_sccb_mock_t *mock)
+{
+    memset(mock, 0, sizeof(test_sccb_mock_t));
+    mock->base.transmit_reg_a16v8 = mock_transmit_reg_a16v8;
+    mock->base.transmit_receive_reg_a16v8 = mock_transmit_receive_reg_a16v8;
+    mock->fail_after = -1;
+    return &mock->base;
+}
+
+void test_sccb_mock_reset_counters(test_sccb_mock_t *mock)
+{
+    mock->writes = 0;
+    mock->reads = 0;
+}
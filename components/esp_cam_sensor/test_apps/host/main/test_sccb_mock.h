@@ -0,0 +1,43 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_sccb_io_interface.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mock SCCB bus backed by a 64K register file, counting every transaction
+ */
+typedef struct {
+    esp_sccb_io_t base;         /*!< SCCB IO interface, must be the first member */
+    uint8_t regs[0x10000];      /*!< Register file of the emulated sensor */
+    uint32_t writes;            /*!< Write transactions seen on the bus */
+    uint32_t reads;             /*!< Read transactions seen on the bus */
+    int fail_after;             /*!< Fail every transaction once this many succeeded, negative to never fail */
+} test_sccb_mock_t;
+
+/**
+ * @brief Initialize a mock SCCB bus, all registers read as zero
+ *
+ * @param[out] mock Mock bus
+ * @return SCCB IO handle to pass to the code under test
+ */
+esp_sccb_io_handle_t test_sccb_mock_init(test_sccb_mock_t *mock);
+
+/**
+ * @brief Clear the transaction counters of the mock bus
+ *
+ * @param[in] mock Mock bus
+ */
+void test_sccb_mock_reset_counters(test_sccb_mock_t *mock);
+
+#ifdef __cplusplus
+}
+#endif
@@ -53,6 +53,11 @@ void h264_hal_get_rc_qp(esp_h264_set_dev_t device, uint8_t *qp_min, uint8_t *qp_
     h264_ll_get_rc_qp(device, qp_min, qp_max);
 }
 
+bool h264_hal_get_rc_en(esp_h264_set_dev_t device)
+{
+    return h264_ll_get_rc_en(device);
+}
+
 void h264_hal_set_rc_rate_pred(esp_h264_set_dev_t device, uint32_t rate, uint32_t pred_mad)
 {
     h264_ll_set_rc_rate_pred(device, rate, pred_mad);
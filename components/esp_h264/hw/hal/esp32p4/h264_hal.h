@@ -155,6 +155,16 @@ void h264_hal_set_rc_qp(esp_h264_set_dev_t device, bool ena, uint8_t qp_min, uin
  */
 void h264_hal_get_rc_qp(esp_h264_set_dev_t device, uint8_t *qp_min, uint8_t *qp_max);
 
+/**
+ * @brief  Get rate control enable
+ *
+ * @param  device  Stream configure handle
+ *
+ * @return
+ *       - true: rate control is enabled, false: rate control is disabled
+ */
+bool h264_hal_get_rc_en(esp_h264_set_dev_t device);
+
 /**
  * @brief  Set rate control parameter
  *
@@ -242,6 +242,19 @@ static inline void h264_ll_set_rc_en(volatile h264_ctrl_regs_t *ctrl, bool ena)
     ctrl->rc_conf0.mb_rate_ctrl_en = ena;
 }
 
+/**
+ * @brief  Get rate control enable
+ *
+ * @param  ctrl  Stream configure handle
+ *
+ * @return
+ *       - True: enable false: disable
+ */
+static inline bool h264_ll_get_rc_en(volatile h264_ctrl_regs_t *ctrl)
+{
+    return ctrl->rc_conf0.mb_rate_ctrl_en;
+}
+
 /**
  * @brief  Set rate control quantization parameter (QP)
  *
@@ -35,7 +35,8 @@ typedef struct {
  * @return
  *       - ESP_H264_ERR_OK   Succeeded
  *       - ESP_H264_ERR_ARG  Invalid arguments passed
- *       - ESP_H264_ERR_MEM  Insufficient memory, the `*out_enc` will be set NULL
+ *       - ESP_H264_ERR_MEM   Insufficient memory, the `*out_enc` will be set NULL
+ *       - ESP_H264_ERR_BUSY  The H.264 hardware is used by another encoder, the `*out_enc` will be set NULL
  */
 esp_h264_err_t esp_h264_enc_dual_hw_new(const esp_h264_enc_cfg_dual_hw_t *cfg, esp_h264_enc_dual_handle_t *out_enc);
 
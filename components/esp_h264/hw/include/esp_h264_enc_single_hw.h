@@ -30,7 +30,8 @@ typedef esp_h264_enc_cfg_t esp_h264_enc_cfg_hw_t;
  * @return
  *       - ESP_H264_ERR_OK   Succeeded
  *       - ESP_H264_ERR_ARG  Invalid arguments passed
- *       - ESP_H264_ERR_MEM  Insufficient memory, the `*out_enc` will be set NULL
+ *       - ESP_H264_ERR_MEM   Insufficient memory, the `*out_enc` will be set NULL
+ *       - ESP_H264_ERR_BUSY  The H.264 hardware is used by another encoder, the `*out_enc` will be set NULL
  */
 esp_h264_err_t esp_h264_enc_hw_new(const esp_h264_enc_cfg_hw_t *cfg, esp_h264_enc_handle_t *out_enc);
 
@@ -46,6 +47,21 @@ esp_h264_err_t esp_h264_enc_hw_new(const esp_h264_enc_cfg_hw_t *cfg, esp_h264_en
  */
 esp_h264_err_t esp_h264_enc_hw_get_param_hd(esp_h264_enc_handle_t enc, esp_h264_enc_param_hw_handle_t *out_param);
 
+/**
+ * @brief  This function returns the rate control(RC) statistics of the last frame encoded by `enc`
+ *
+ * @note  It is meant to be called right after `esp_h264_enc_process`, from the same task.
+ *        The function can be used as `get_stats` of `esp_h264_enc_async_cfg_t`.
+ *
+ * @param[in]   enc        The encoder instance that is from `esp_h264_enc_hw_new`
+ * @param[out]  out_stats  The statistics of the last encoded frame
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ */
+esp_h264_err_t esp_h264_enc_hw_get_frame_stats(esp_h264_enc_handle_t enc, esp_h264_enc_frame_stats_t *out_stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -7,6 +7,7 @@
 #include "esp_h264_alloc.h"
 #include "esp_h264_intr_alloc.h"
 #include "esp_h264_enc_dual_hw.h"
+#include "esp_h264_enc_single.h"
 #include "esp_h264_enc_hw_param.h"
 
 static const char *TAG = "H264_ENC.HW.DUAL";
@@ -23,6 +24,7 @@ typedef struct esp_h264_hw_handle {
     h264_dma_desc_t            *dsc_bs;
     uint8_t                     frame_num;
     uint8_t                     gop;
+    volatile bool               force_idr;
     esp_h264_mutex_t            frame_done;
     esp_h264_intr_hd_t          intr_hd;
 } esp_h264_hw_handle_t;
@@ -98,7 +100,9 @@ static inline esp_h264_err_t h264_hw_enc_frame_mode_process(esp_h264_hw_handle_t
         esp_h264_enc_hw_get_qp_init(param_hd, &qp_init);
         /** Set the rate and predicted MAD, QP to hardware encoding*/
         esp_h264_enc_hw_set_qp(param_hd, qp);
-        esp_h264_enc_hw_set_rc_rate_pred(param_hd, rate, pred_mad);
+        if (esp_h264_rc_mb_ena(rc_hd)) {
+            esp_h264_enc_hw_set_rc_rate_pred(param_hd, rate, pred_mad);
+        }
         /** Slice header will record the delta QP */
         qp_delta = qp - qp_init;
     }
@@ -143,7 +147,8 @@ static inline esp_h264_err_t h264_hw_enc_frame_mode_process(esp_h264_hw_handle_t
         return ESP_H264_ERR_TIMEOUT;
     }
     *out_len = h264_hal_get_coded_len(&hw_hd->h264_hal);
-    esp_h264_cache_check_and_invalidate(out_frame, out_frame_size);
+    /** Only the coded data is read back */
+    esp_h264_cache_check_and_invalidate_len(out_frame, out_frame_len + *out_len, out_frame_size);
     /** CAVLA mustn't be continue zeros.
      *  And HW encoding will check output buffer.
      *  Maybe start code will be wrote error data after HW encoding.
@@ -176,6 +181,11 @@ static esp_h264_err_t enc_process(esp_h264_enc_dual_handle_t enc, esp_h264_enc_i
     esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
     esp_h264_err_t ret = ESP_H264_ERR_OK;
     hw_hd->frame_num = hw_hd->frame_num % hw_hd->gop;
+    if (hw_hd->force_idr) {
+        /** Requested IDR-frame on both streams, the GOP restarts from it */
+        hw_hd->force_idr = false;
+        hw_hd->frame_num = 0;
+    }
     out_frame[0]->dts = in_frame[0]->pts;
     out_frame[0]->pts = in_frame[0]->pts;
     out_frame[0]->frame_type = ESP_H264_FRAME_TYPE_P;
@@ -198,8 +208,14 @@ static esp_h264_err_t enc_process(esp_h264_enc_dual_handle_t enc, esp_h264_enc_i
         h264_hal_reset(&hw_hd->h264_hal);
         h264_dma_hal_reset_counter_db(&hw_hd->dma2d_hal);
     }
-    esp_h264_cache_check_and_writeback(in_frame[0]->raw_data.buffer, in_frame[0]->raw_data.len);
-    esp_h264_cache_check_and_writeback(in_frame[1]->raw_data.buffer, in_frame[1]->raw_data.len);
+    /** Only what the CPU wrote is written back, a frame straight from a DMA is left alone */
+    for (int i = 0; i < 2; i++) {
+        uint32_t dirty_offset = 0;
+        uint32_t dirty_len = 0;
+        if (esp_h264_enc_in_frame_get_dirty_range(in_frame[i], &dirty_offset, &dirty_len)) {
+            esp_h264_cache_check_and_writeback(in_frame[i]->raw_data.buffer + dirty_offset, dirty_len);
+        }
+    }
     /** In multi-thread, the parameter cann't be set in encoding.
      *  `mutex` is for thread safety.
     */
@@ -216,6 +232,13 @@ static esp_h264_err_t enc_process(esp_h264_enc_dual_handle_t enc, esp_h264_enc_i
     return ret;
 }
 
+static esp_h264_err_t enc_force_idr(esp_h264_enc_dual_handle_t enc)
+{
+    esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
+    hw_hd->force_idr = true;
+    return ESP_H264_ERR_OK;
+}
+
 static esp_h264_err_t enc_close(esp_h264_enc_dual_handle_t enc)
 {
     esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
@@ -280,6 +303,7 @@ static esp_h264_err_t enc_del(esp_h264_enc_dual_handle_t enc)
         }
         /** Free the encoder */
         esp_h264_free(hw_hd);
+        esp_h264_enc_hw_release();
     }
     return ESP_H264_ERR_OK;
 }
@@ -328,10 +352,17 @@ esp_h264_err_t esp_h264_enc_dual_hw_new(const esp_h264_enc_cfg_dual_hw_t *cfg, e
         cfg_h264_dma_hal.out_ch_conf0[i] = H264_DMA_OUT_CONF0_EOF_EN;
     }
 
+    /** The peripheral can only serve one encoder */
+    ESP_H264_RET_ON_FALSE(esp_h264_enc_hw_acquire() == ESP_H264_ERR_OK, ESP_H264_ERR_BUSY, TAG, "The H.264 hardware is used by another encoder");
+
     /** Create encoder handle */
     uint32_t actual_size;
     esp_h264_hw_handle_t *hw_hd = (esp_h264_hw_handle_t *)esp_h264_calloc_prefer(1, sizeof(esp_h264_hw_handle_t), &actual_size, ESP_H264_MEM_SPIRAM, ESP_H264_MEM_INTERNAL);
-    ESP_H264_RET_ON_FALSE(hw_hd != NULL, ESP_H264_ERR_MEM, TAG, "No memory for encoder handle");
+    if (hw_hd == NULL) {
+        esp_h264_enc_hw_release();
+        ESP_H264_LOGE(TAG, "No memory for encoder handle");
+        return ESP_H264_ERR_MEM;
+    }
 
     /** H.264 HAL initalization*/
     cfg_h264_hal.dual_stream_en = true;
@@ -375,6 +406,7 @@ esp_h264_err_t esp_h264_enc_dual_hw_new(const esp_h264_enc_cfg_dual_hw_t *cfg, e
     hw_hd->base.process = enc_process;
     hw_hd->base.close = enc_close;
     hw_hd->base.del = enc_del;
+    hw_hd->base.force_idr = enc_force_idr;
     *out_enc = &hw_hd->base;
     return ret;
 __exit__:
@@ -6,6 +6,7 @@
 
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "esp_h264_alloc.h"
 #include "esp_h264_enc_hw_param.h"
 
@@ -21,6 +22,9 @@ typedef struct esp_h264_param {
     uint8_t                    fps;
     uint8_t                    gop;
     esp_h264_rc_hd_t           rc_hd;
+    bool                       mb_rc_ena;
+    uint8_t                    mb_qp_min;
+    uint8_t                    mb_qp_max;
     uint8_t                    qp_init;
     uint32_t                   bitrate;
     uint16_t                   width;
@@ -220,6 +224,40 @@ static esp_h264_err_t get_mv_data_len(esp_h264_enc_param_hw_handle_t handle, uin
     return ESP_H264_ERR_OK;
 }
 
+static esp_h264_err_t cfg_rc(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t cfg)
+{
+    esp_h264_param_t *param = __containerof(handle, esp_h264_param_t, hw_base);
+    ESP_H264_RET_ON_FALSE(param->rc_hd, ESP_H264_ERR_UNSUPPORTED, TAG, "The RC is disabled, `qp_min` equals `qp_max`");
+    esp_h264_mutex_lock(param->mutex, ESP_H264_MAX_DELAY);
+    esp_h264_err_t ret = esp_h264_enc_hw_rc_cfg(param->rc_hd, &cfg);
+    if (ret == ESP_H264_ERR_OK) {
+        /** The MB level RC would move the QP away from the constant one */
+        if (cfg.mode == ESP_H264_RC_MODE_CQP) {
+            h264_hal_set_rc_qp(param->device, false, cfg.cqp, cfg.cqp);
+        } else {
+            h264_hal_set_rc_qp(param->device, param->mb_rc_ena, param->mb_qp_min, param->mb_qp_max);
+        }
+    }
+    esp_h264_mutex_unlock(param->mutex);
+    return ret;
+}
+
+static esp_h264_err_t get_rc_cfg_info(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t *cfg)
+{
+    esp_h264_param_t *param = __containerof(handle, esp_h264_param_t, hw_base);
+    if (param->rc_hd == NULL) {
+        /** The QP is fixed */
+        memset(cfg, 0, sizeof(esp_h264_enc_rc_cfg_t));
+        cfg->mode = ESP_H264_RC_MODE_CQP;
+        cfg->cqp = param->qp_init;
+        return ESP_H264_ERR_OK;
+    }
+    esp_h264_mutex_lock(param->mutex, ESP_H264_MAX_DELAY);
+    esp_h264_enc_hw_rc_get_cfg(param->rc_hd, cfg);
+    esp_h264_mutex_unlock(param->mutex);
+    return ESP_H264_ERR_OK;
+}
+
 static int max_refame_buffer_size(int16_t mb_width)
 {
     /** H264_DMA_MACRO_SIZE + H264_DMA_HALF_MACRO_SIZE : Y(16) + U(4) + V(4) */
@@ -303,6 +341,9 @@ esp_h264_err_t esp_h264_enc_hw_new_param(esp_h264_enc_hw_param_cfg_t *cfg, esp_h
     param->bitrate = cfg->bitrate;
     h264_hal_set_qp(param->device, param->qp_init);
     h264_hal_get_mbres(param->device, &param->mb_width, &param->mb_height);
+    /** The MB level RC set up by the HAL, it is restored when leaving the CQP mode */
+    param->mb_rc_ena = h264_hal_get_rc_en(param->device);
+    h264_hal_get_rc_qp(param->device, &param->mb_qp_min, &param->mb_qp_max);
 
     /** Create RC handle */
     if (cfg->qp_min < cfg->qp_max) {
@@ -355,6 +396,8 @@ esp_h264_err_t esp_h264_enc_hw_new_param(esp_h264_enc_hw_param_cfg_t *cfg, esp_h
     param->hw_base.get_roi_cfg_info = get_roi_cfg_info;
     param->hw_base.set_roi_reg = set_roi_reg;
     param->hw_base.get_roi_reg = get_roi_reg;
+    param->hw_base.cfg_rc = cfg_rc;
+    param->hw_base.get_rc_cfg_info = get_rc_cfg_info;
     *out_handle = &param->hw_base;
     return ret;
 __exit__:
@@ -490,6 +533,23 @@ esp_h264_err_t esp_h264_enc_hw_res_check(uint16_t width, uint16_t height)
     return ESP_H264_ERR_FAIL;
 }
 
+/** Owner flag of the H.264 peripheral, shared by the single and dual stream encoders */
+static atomic_bool s_hw_in_use;
+
+esp_h264_err_t esp_h264_enc_hw_acquire(void)
+{
+    bool in_use = false;
+    if (atomic_compare_exchange_strong(&s_hw_in_use, &in_use, true)) {
+        return ESP_H264_ERR_OK;
+    }
+    return ESP_H264_ERR_BUSY;
+}
+
+void esp_h264_enc_hw_release(void)
+{
+    atomic_store(&s_hw_in_use, false);
+}
+
 /*  Dual stream mode, DB tmp  buffer can be resused. */
 uint16_t esp_h264_enc_hw_max_db_tmp_buffer_size(uint16_t width)
 {
@@ -207,6 +207,23 @@ esp_h264_err_t esp_h264_enc_hw_get_mbres(esp_h264_enc_param_hw_handle_t handle,
  */
 esp_h264_err_t esp_h264_enc_hw_res_check(uint16_t width, uint16_t height);
 
+/**
+ * @brief  Take the H.264 peripheral for a new encoder
+ *
+ * @note  The single and dual stream encoders drive the same peripheral, only one of them can exist at a time.
+ *        It is given back by `esp_h264_enc_hw_release` when the encoder is deleted.
+ *
+ * @return
+ *       - ESP_H264_ERR_OK    Succeeded
+ *       - ESP_H264_ERR_BUSY  The peripheral belongs to another encoder
+ */
+esp_h264_err_t esp_h264_enc_hw_acquire(void);
+
+/**
+ * @brief  Give back the H.264 peripheral taken by `esp_h264_enc_hw_acquire`
+ */
+void esp_h264_enc_hw_release(void);
+
 /**
  * @brief  Get de-blocking filter temporary buffer size
  *
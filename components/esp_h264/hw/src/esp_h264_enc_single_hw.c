@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <string.h>
 #include "esp_h264_alloc.h"
 #include "esp_h264_enc_single_hw.h"
 #include "esp_h264_enc_hw_param.h"
@@ -22,8 +23,10 @@ typedef struct esp_h264_hw_handle {
     h264_dma_desc_t            *dsc_bs;
     uint8_t                     frame_num;
     uint8_t                     gop;
+    volatile bool               force_idr;
     esp_h264_mutex_t            frame_done;
     esp_h264_intr_hd_t          intr_hd;
+    esp_h264_enc_frame_stats_t  stats;
 } esp_h264_hw_handle_t;
 
 static void h264_gop_isr(void *arg)
@@ -101,12 +104,15 @@ static esp_h264_err_t h264_hw_enc_gop_mode_process(esp_h264_hw_handle_t *hw_hd,
         esp_h264_enc_hw_get_qp_init(param_hd, &qp_init);
         /** Set the rate and predicted MAD, QP to hardware encoding*/
         esp_h264_enc_hw_set_qp(param_hd, qp);
-        esp_h264_enc_hw_set_rc_rate_pred(param_hd, rate, pred_mad);
+        if (esp_h264_rc_mb_ena(rc_hd)) {
+            esp_h264_enc_hw_set_rc_rate_pred(param_hd, rate, pred_mad);
+        }
         /** Slice header will record the delta QP */
         qp_delta = qp - qp_init;
     }
     uint32_t *slice_start_code = (uint32_t *)out_frame;
     uint32_t slice_nal_len = 0;
+    memset(&hw_hd->stats, 0, sizeof(hw_hd->stats));
     if (hw_hd->frame_num == 0) {
         /** To ensure that each IDR-frame can be decoded, it is added SPS and PPS before each IDR-frame. */
         uint16_t nal_bit_len;
@@ -145,7 +151,8 @@ static esp_h264_err_t h264_hw_enc_gop_mode_process(esp_h264_hw_handle_t *hw_hd,
         return ESP_H264_ERR_TIMEOUT;
     }
     *out_len = h264_hal_get_coded_len(&hw_hd->h264_hal);
-    esp_h264_cache_check_and_invalidate(out_frame, out_frame_size);
+    /** Only the coded data is read back */
+    esp_h264_cache_check_and_invalidate_len(out_frame, out_frame_len + *out_len, out_frame_size);
     /** CAVLA mustn't be continue zeros.
      *  And HW encoding will check output buffer.
      *  Maybe start code will be wrote error data after HW encoding.
@@ -155,18 +162,24 @@ static esp_h264_err_t h264_hw_enc_gop_mode_process(esp_h264_hw_handle_t *hw_hd,
     if (rc_hd) {
         /** Get the encoder bits and MAD, the sum of QP from HW. */
         uint32_t enc_bits = 0, mad = 0, qp_sum = 0;
+        uint8_t mb_width = 0;
+        uint8_t mb_height = 0;
+        esp_h264_enc_hw_get_mbres(param_hd, &mb_width, &mb_height);
         h264_hal_get_rc_bits_mad_qpsum(&hw_hd->h264_hal, &enc_bits, &mad, &qp_sum);
         if (!hw_hd->frame_num) {
             enc_bits = *out_len << 3;
-            uint8_t mb_width = 0;
-            uint8_t mb_height = 0;
-            esp_h264_enc_hw_get_mbres(param_hd, &mb_width, &mb_height);
             qp_sum = qp * mb_width * mb_height;
         }
         /** Software calculation the RC parameter.*/
         esp_h264_rc_end(rc_hd, enc_bits, qp_sum, mad);
+        hw_hd->stats.qp = qp_sum / (mb_width * mb_height);
+        hw_hd->stats.mad = mad;
+    } else {
+        esp_h264_enc_hw_get_qp_init(param_hd, &hw_hd->stats.qp);
+        hw_hd->stats.mad = 0;
     }
     *out_len += out_frame_len;
+    hw_hd->stats.bits = *out_len << 3;
     if (h264_hal_get_bs_bit_overflow(&hw_hd->h264_hal)) {
         return ESP_H264_ERR_OVERFLOW;
     }
@@ -178,6 +191,11 @@ static esp_h264_err_t enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_fra
     esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
     esp_h264_err_t ret = ESP_H264_ERR_OK;
     hw_hd->frame_num = hw_hd->frame_num % hw_hd->gop;
+    if (hw_hd->force_idr) {
+        /** Requested IDR-frame, the GOP restarts from it */
+        hw_hd->force_idr = false;
+        hw_hd->frame_num = 0;
+    }
     out_frame->dts = in_frame->pts;
     out_frame->pts = in_frame->pts;
     out_frame->frame_type = ESP_H264_FRAME_TYPE_P;
@@ -189,7 +207,12 @@ static esp_h264_err_t enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_fra
         esp_h264_enc_get_gop(&hw_hd->param_hd->base, &hw_hd->gop);
         h264_hal_set_gop(&hw_hd->h264_hal, hw_hd->gop, true);
     }
-    esp_h264_cache_check_and_writeback(in_frame->raw_data.buffer, in_frame->raw_data.len);
+    /** Only what the CPU wrote is written back, a frame straight from a DMA is left alone */
+    uint32_t dirty_offset = 0;
+    uint32_t dirty_len = 0;
+    if (esp_h264_enc_in_frame_get_dirty_range(in_frame, &dirty_offset, &dirty_len)) {
+        esp_h264_cache_check_and_writeback(in_frame->raw_data.buffer + dirty_offset, dirty_len);
+    }
     /** In multi-thread, the parameter cann't be set in encoding.
      *  `mutex` is for thread safety.
     */
@@ -202,6 +225,13 @@ static esp_h264_err_t enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_fra
     return ret;
 }
 
+static esp_h264_err_t enc_force_idr(esp_h264_enc_handle_t enc)
+{
+    esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
+    hw_hd->force_idr = true;
+    return ESP_H264_ERR_OK;
+}
+
 static esp_h264_err_t enc_close(esp_h264_enc_handle_t enc)
 {
     esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
@@ -266,6 +296,7 @@ static esp_h264_err_t enc_del(esp_h264_enc_handle_t enc)
         }
         /** Free the encoder */
         esp_h264_free(hw_hd);
+        esp_h264_enc_hw_release();
     }
     return ESP_H264_ERR_OK;
 }
@@ -309,10 +340,17 @@ esp_h264_err_t esp_h264_enc_hw_new(const esp_h264_enc_cfg_hw_t *cfg, esp_h264_en
         .fps = cfg->fps,
     };
 
+    /** The peripheral can only serve one encoder */
+    ESP_H264_RET_ON_FALSE(esp_h264_enc_hw_acquire() == ESP_H264_ERR_OK, ESP_H264_ERR_BUSY, TAG, "The H.264 hardware is used by another encoder");
+
     /** Create encoder handle */
     uint32_t actual_size;
     esp_h264_hw_handle_t *hw_hd = (esp_h264_hw_handle_t *)esp_h264_calloc_prefer(1, sizeof(esp_h264_hw_handle_t), &actual_size, ESP_H264_MEM_SPIRAM, ESP_H264_MEM_INTERNAL);
-    ESP_H264_RET_ON_FALSE(hw_hd != NULL, ESP_H264_ERR_MEM, TAG, "No memory for handle");
+    if (hw_hd == NULL) {
+        esp_h264_enc_hw_release();
+        ESP_H264_LOGE(TAG, "No memory for handle");
+        return ESP_H264_ERR_MEM;
+    }
 
     /** H.264 HAL initalization*/
     h264_hal_init(&hw_hd->h264_hal, &cfg_h264_hal);
@@ -353,6 +391,7 @@ esp_h264_err_t esp_h264_enc_hw_new(const esp_h264_enc_cfg_hw_t *cfg, esp_h264_en
     hw_hd->base.process = enc_process;
     hw_hd->base.close = enc_close;
     hw_hd->base.del = enc_del;
+    hw_hd->base.force_idr = enc_force_idr;
     *out_enc = &hw_hd->base;
     return ret;
 __exit__:
@@ -370,3 +409,13 @@ esp_h264_err_t esp_h264_enc_hw_get_param_hd(esp_h264_enc_handle_t enc, esp_h264_
     }
     return ESP_H264_ERR_ARG;
 }
+
+esp_h264_err_t esp_h264_enc_hw_get_frame_stats(esp_h264_enc_handle_t enc, esp_h264_enc_frame_stats_t *out_stats)
+{
+    if (enc && out_stats) {
+        esp_h264_hw_handle_t *hw_hd = __containerof(enc, esp_h264_hw_handle_t, base);
+        *out_stats = hw_hd->stats;
+        return ESP_H264_ERR_OK;
+    }
+    return ESP_H264_ERR_ARG;
+}
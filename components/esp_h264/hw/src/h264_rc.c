@@ -5,8 +5,16 @@
  */
 
 #include "esp_h264_alloc.h"
+#include "esp_h264_check.h"
 #include "h264_rc.h"
 
+static const char *TAG = "H264_ENC.RC";
+
+#define RC_IDR_BUDGET_DEFAULT   (4)    /*<! IDR-frame bits in average frames */
+#define RC_SCENE_CHANGE_DEFAULT (100)  /*<! MAD raise in percent */
+#define RC_QP_STEP_MAX          (2)    /*<! QP change between two P-frames out of a scene change */
+#define RC_MAD_MIN              (1.0f) /*<! Floor of the MAD, a still picture still costs bits */
+
 typedef struct esp_h264_rc {
     uint8_t  qp_max;
     uint8_t  qp_min;
@@ -24,12 +32,171 @@ typedef struct esp_h264_rc {
     int32_t  ebits;
     int32_t  err_sum;
     uint8_t  frame_num;
+    /** The fields below are for the CBR, VBR and CQP modes */
+    esp_h264_enc_rc_cfg_t cfg;
+    uint32_t bitrate;
+    uint8_t  fps;
+    uint8_t  qp_last_p;     /*<! QP of the last P-frame */
+    bool     is_iframe;
+    bool     model_reset;   /*<! The QP model restarted, the QP step is not limited */
+    bool     has_iframe;    /*<! `coef_i` comes from an encoded IDR-frame */
+    float    coef_i;        /*<! IDR-frame bits at QP 0 */
+    float    coef_p;        /*<! P-frame bits per MAD at QP 0 */
+    float    mad_avg;       /*<! Short term MAD average of the P-frames */
+    float    mad_long;      /*<! Long term MAD average of the P-frames */
+    int32_t  vbv_fullness;
+    int32_t  vbr_err;       /*<! Bits over the average bitrate, repaid by the VBR */
+    esp_h264_rc_stats_t stats;
 } esp_h264_rc_t;
 
 static const int init_mad[] = { 1, 3, 4, 5, 6, 7, 8, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9, 9 };
 
 #define CLIP3(min, max, v) ((v) > (max) ? (max) : ((v) < (min) ? (min) : (v)))
 
+/** 2^(-i/6), the quantizer step doubles every 6 QP */
+static const float qp_scale_tab[6] = { 1.0f, 0.8909f, 0.7937f, 0.7071f, 0.6300f, 0.5612f };
+
+static inline float rc_qp_scale(uint8_t qp)
+{
+    return qp_scale_tab[qp % 6] / (float)(1 << (qp / 6));
+}
+
+static inline uint32_t rc_vbv_size(esp_h264_rc_t *prc)
+{
+    return prc->cfg.vbv_size ? prc->cfg.vbv_size : prc->bitrate;
+}
+
+static inline uint8_t rc_idr_budget(esp_h264_rc_t *prc)
+{
+    return prc->cfg.idr_budget ? prc->cfg.idr_budget : RC_IDR_BUDGET_DEFAULT;
+}
+
+static inline uint32_t rc_max_bitrate(esp_h264_rc_t *prc)
+{
+    return prc->cfg.max_bitrate ? prc->cfg.max_bitrate : prc->bitrate + (prc->bitrate >> 1);
+}
+
+/** Bits leaving the VBV in one frame time */
+static inline int32_t rc_vbv_drain(esp_h264_rc_t *prc)
+{
+    if (prc->cfg.mode == ESP_H264_RC_MODE_VBR) {
+        return rc_max_bitrate(prc) / prc->fps;
+    }
+    return prc->bits_per_frame;
+}
+
+/** The smallest QP whose predicted bits fit the target */
+static uint8_t rc_model_qp(esp_h264_rc_t *prc, float coef, float mad, int32_t target_bits)
+{
+    for (uint8_t qp = prc->qp_min; qp < prc->qp_max; qp++) {
+        if (coef * mad * rc_qp_scale(qp) <= target_bits) {
+            return qp;
+        }
+    }
+    return prc->qp_max;
+}
+
+static void rc_model_reset(esp_h264_rc_t *prc, uint8_t qp)
+{
+    /** Start from `bits_per_frame` at `qp` */
+    prc->coef_i = (float)prc->bits_per_frame * rc_idr_budget(prc) / rc_qp_scale(qp);
+    prc->coef_p = (float)prc->bits_per_frame / prc->mad_avg / rc_qp_scale(qp);
+    prc->qp_last_p = qp;
+    prc->has_iframe = false;
+    prc->model_reset = true;
+}
+
+static void rc_model_start(esp_h264_rc_t *prc, bool is_iframe, uint32_t *rate, uint32_t *pred_mad, uint8_t *qp)
+{
+    int32_t bits_per_frame = prc->bits_per_frame;
+    int32_t vbv_size = rc_vbv_size(prc);
+    /** Bits that keep the VBV under 90% full */
+    int32_t room = vbv_size - vbv_size / 10 - prc->vbv_fullness + rc_vbv_drain(prc);
+    int32_t target;
+    if (is_iframe) {
+        target = bits_per_frame * rc_idr_budget(prc);
+    } else if (prc->cfg.mode == ESP_H264_RC_MODE_VBR) {
+        /** Complex pictures get more bits, the error to the average is repaid in 2 seconds */
+        float weight = CLIP3(0.5f, 2.0f, prc->mad_avg / prc->mad_long);
+        target = (int32_t)(bits_per_frame * weight) - prc->vbr_err / (2 * prc->fps);
+    } else {
+        /** Bring the VBV back to half full in 8 frames, it leaves room for the next IDR-frame */
+        target = bits_per_frame - (prc->vbv_fullness - vbv_size / 2) / 8;
+    }
+    target = CLIP3(bits_per_frame / 8, room > bits_per_frame / 8 ? room : bits_per_frame / 8, target);
+    prc->target_frame_bits = target;
+
+    float mad = is_iframe ? RC_MAD_MIN : prc->mad_avg;
+    float coef = is_iframe ? prc->coef_i : prc->coef_p;
+    uint8_t qp_new;
+    if (prc->cfg.mode == ESP_H264_RC_MODE_CQP) {
+        qp_new = prc->cfg.cqp;
+    } else {
+        qp_new = rc_model_qp(prc, coef, mad, target);
+        if (!is_iframe && !prc->model_reset) {
+            /** Smooth the quality, unless the limited QP would overflow the VBV */
+            int lo = prc->qp_last_p - RC_QP_STEP_MAX;
+            int hi = prc->qp_last_p + RC_QP_STEP_MAX;
+            if (qp_new < lo || coef * mad * rc_qp_scale(CLIP3(prc->qp_min, prc->qp_max, hi)) <= room) {
+                qp_new = CLIP3(lo, hi, qp_new);
+            }
+            qp_new = CLIP3(prc->qp_min, prc->qp_max, qp_new);
+        }
+    }
+    prc->is_iframe = is_iframe;
+    *qp = qp_new;
+    if (!is_iframe && prc->cfg.mode != ESP_H264_RC_MODE_CQP) {
+        /** The rate of the MB level RC follows the frame target */
+        *rate = (uint32_t)(256.0 * target / prc->mb_cnt / mad / 15);
+        if (*rate < 1) {
+            *rate = 1;
+        }
+        *pred_mad = (uint32_t)mad;
+    }
+}
+
+static void rc_model_end(esp_h264_rc_t *prc, uint32_t total_enc_bits, uint8_t qp, float mad_cur)
+{
+    float scale = rc_qp_scale(qp);
+    if (prc->is_iframe) {
+        float coef = total_enc_bits / scale;
+        prc->coef_i = prc->has_iframe ? (prc->coef_i + coef) / 2 : coef;
+        prc->has_iframe = true;
+    } else {
+        float mad = mad_cur > RC_MAD_MIN ? mad_cur : RC_MAD_MIN;
+        float coef = total_enc_bits / mad / scale;
+        uint16_t scene_change = prc->cfg.scene_change ? prc->cfg.scene_change : RC_SCENE_CHANGE_DEFAULT;
+        if (mad * 100 > prc->mad_avg * (100 + scene_change)) {
+            /** Scene change: the history does not predict the next frames */
+            prc->stats.scene_changes++;
+            prc->coef_p = coef;
+            prc->mad_avg = mad;
+            prc->model_reset = true;
+        } else {
+            prc->coef_p = (prc->coef_p + coef) / 2;
+            prc->mad_avg = (prc->mad_avg + mad) / 2;
+            prc->model_reset = false;
+        }
+        prc->mad_long += (mad - prc->mad_long) / 32;
+        prc->qp_last_p = qp;
+    }
+
+    /** Leaky bucket */
+    int32_t vbv_size = rc_vbv_size(prc);
+    prc->vbv_fullness += (int32_t)total_enc_bits - rc_vbv_drain(prc);
+    if (prc->vbv_fullness < 0) {
+        prc->vbv_fullness = 0;
+    } else if (prc->vbv_fullness > vbv_size) {
+        prc->stats.vbv_overflows++;
+        prc->vbv_fullness = vbv_size;
+    }
+    prc->vbr_err += (int32_t)total_enc_bits - (int32_t)prc->bits_per_frame;
+    prc->vbr_err = CLIP3(-vbv_size, vbv_size, prc->vbr_err);
+    prc->stats.frames++;
+    prc->stats.vbv_size = vbv_size;
+    prc->stats.vbv_fullness = prc->vbv_fullness;
+}
+
 void esp_h264_enc_hw_rc_del(esp_h264_rc_hd_t rc_hd)
 {
     if (rc_hd) {
@@ -57,6 +224,13 @@ esp_h264_rc_hd_t esp_h264_enc_hw_rc_new(uint8_t qp_max, uint8_t qp_min, uint32_t
     }
     prc->frame_bits_last4_average = prc->bits_per_frame;
     prc->mad_last4_average = mad;
+    prc->bitrate = bitrate;
+    prc->fps = fps;
+    prc->cfg.mode = ESP_H264_RC_MODE_AVERAGE;
+    prc->cfg.cqp = prc->qpm;
+    prc->mad_avg = mad > RC_MAD_MIN ? mad : RC_MAD_MIN;
+    prc->mad_long = prc->mad_avg;
+    rc_model_reset(prc, prc->qpm);
     return prc;
 }
 
@@ -71,11 +245,56 @@ void esp_h264_enc_hw_rc_set_bt_fps(esp_h264_rc_hd_t rc_hd, uint32_t bitrate, uin
 {
     esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
     prc->bits_per_frame = bitrate / fps;
+    prc->bitrate = bitrate;
+    prc->fps = fps;
+}
+
+esp_h264_err_t esp_h264_enc_hw_rc_cfg(esp_h264_rc_hd_t rc_hd, const esp_h264_enc_rc_cfg_t *cfg)
+{
+    esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
+    ESP_H264_RET_ON_FALSE(cfg->mode != ESP_H264_RC_MODE_CQP || (cfg->cqp >= prc->qp_min && cfg->cqp <= prc->qp_max),
+                          ESP_H264_ERR_ARG, TAG, "The constant QP is out of [qp_min, qp_max]");
+    ESP_H264_RET_ON_FALSE(cfg->mode != ESP_H264_RC_MODE_VBR || !cfg->max_bitrate || cfg->max_bitrate >= prc->bitrate,
+                          ESP_H264_ERR_ARG, TAG, "The peak bitrate is less than the bitrate");
+    prc->cfg = *cfg;
+    prc->vbv_fullness = 0;
+    prc->vbr_err = 0;
+    memset(&prc->stats, 0, sizeof(prc->stats));
+    prc->stats.vbv_size = rc_vbv_size(prc);
+    rc_model_reset(prc, CLIP3(prc->qp_min, prc->qp_max, prc->qp_last_p));
+    return ESP_H264_ERR_OK;
+}
+
+void esp_h264_enc_hw_rc_get_cfg(esp_h264_rc_hd_t rc_hd, esp_h264_enc_rc_cfg_t *cfg)
+{
+    esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
+    *cfg = prc->cfg;
+    cfg->max_bitrate = rc_max_bitrate(prc);
+    cfg->vbv_size = rc_vbv_size(prc);
+    cfg->idr_budget = rc_idr_budget(prc);
+    cfg->scene_change = prc->cfg.scene_change ? prc->cfg.scene_change : RC_SCENE_CHANGE_DEFAULT;
+}
+
+void esp_h264_enc_hw_rc_get_stats(esp_h264_rc_hd_t rc_hd, esp_h264_rc_stats_t *stats)
+{
+    esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
+    *stats = prc->stats;
+}
+
+bool esp_h264_rc_mb_ena(esp_h264_rc_hd_t rc_hd)
+{
+    esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
+    return prc->cfg.mode != ESP_H264_RC_MODE_CQP;
 }
 
 void esp_h264_rc_start(esp_h264_rc_hd_t rc_hd, bool is_iframe, uint32_t *rate, uint32_t *pred_mad, uint8_t *qp)
 {
     esp_h264_rc_t *prc = (esp_h264_rc_t *)rc_hd;
+    if (prc->cfg.mode != ESP_H264_RC_MODE_AVERAGE) {
+        rc_model_start(prc, is_iframe, rate, pred_mad, qp);
+        return;
+    }
+    prc->is_iframe = is_iframe;
     float mad_pred = prc->mad_last4_average;
     int target_frame_bits = (prc->bits_per_frame * 10 - 4 * prc->frame_bits_last4_average) / 6;
     int target_mb_bits = 0;
@@ -129,4 +348,7 @@ void esp_h264_rc_end(esp_h264_rc_hd_t rc_hd, uint32_t total_enc_bits, uint32_t f
         prc->eqp = -1;
     }
     prc->frame_num++;
+
+    /** The QP model, the VBV and the statistics follow every mode */
+    rc_model_end(prc, total_enc_bits, prc->qp_average_frame, mad_cur);
 }
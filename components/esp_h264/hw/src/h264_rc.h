@@ -9,6 +9,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include "esp_h264_enc_param_hw.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,17 @@ extern "C" {
 
 typedef void *esp_h264_rc_hd_t;  /*<! Rate control(RC) handle */
 
+/**
+ * @brief  Rate control(RC) statistics since the last configuration
+ */
+typedef struct {
+    uint32_t frames;         /*<! Frames passed to `esp_h264_rc_end` */
+    uint32_t vbv_size;       /*<! Size of the video buffering verifier(VBV) in bits */
+    uint32_t vbv_fullness;   /*<! Bits in the VBV after the last frame */
+    uint32_t vbv_overflows;  /*<! Frames that did not fit in the VBV */
+    uint32_t scene_changes;  /*<! Scene changes detected from the MAD */
+} esp_h264_rc_stats_t;
+
 /**
  * @brief  Create a new RC handle
  *
@@ -61,6 +73,17 @@ void esp_h264_enc_hw_rc_set_bt_fps(esp_h264_rc_hd_t rc_hd, uint32_t bitrate, uin
  */
 void esp_h264_rc_start(esp_h264_rc_hd_t rc_hd, bool is_iframe, uint32_t *rate, uint32_t *pred_mad, uint8_t *qp);
 
+/**
+ * @brief  Whether the MB level RC of the hardware follows the rate and the predicted MAD of `esp_h264_rc_start`
+ *
+ * @param  rc_hd  Rate control handle
+ *
+ * @return
+ *       - true   The rate and the predicted MAD are programmed
+ *       - false  The QP is constant, the MB level RC is disabled
+ */
+bool esp_h264_rc_mb_ena(esp_h264_rc_hd_t rc_hd);
+
 /**
  * @brief  RC end
  *
@@ -71,6 +94,34 @@ void esp_h264_rc_start(esp_h264_rc_hd_t rc_hd, bool is_iframe, uint32_t *rate, u
  */
 void esp_h264_rc_end(esp_h264_rc_hd_t rc_hd, uint32_t total_enc_bits, uint32_t frame_qp_sum, uint32_t frame_mad_sum);
 
+/**
+ * @brief  Configure the RC mode
+ *
+ * @param  rc_hd  Rate control handle
+ * @param  cfg    Rate control configuration
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  The constant QP is out of [qp_min, qp_max] or the peak bitrate is less than the bitrate
+ */
+esp_h264_err_t esp_h264_enc_hw_rc_cfg(esp_h264_rc_hd_t rc_hd, const esp_h264_enc_rc_cfg_t *cfg);
+
+/**
+ * @brief  Get the RC configuration
+ *
+ * @param  rc_hd  Rate control handle
+ * @param  cfg    Rate control configuration, the defaults are filled in
+ */
+void esp_h264_enc_hw_rc_get_cfg(esp_h264_rc_hd_t rc_hd, esp_h264_enc_rc_cfg_t *cfg);
+
+/**
+ * @brief  Get the RC statistics
+ *
+ * @param  rc_hd  Rate control handle
+ * @param  stats  Rate control statistics
+ */
+void esp_h264_enc_hw_rc_get_stats(esp_h264_rc_hd_t rc_hd, esp_h264_rc_stats_t *stats);
+
 /**
  * @brief  Delete RC handle
  *
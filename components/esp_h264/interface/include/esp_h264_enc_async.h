@@ -0,0 +1,153 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_h264_types.h"
+#include "esp_h264_enc_single.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_H264_ENC_ASYNC_DEPTH_MAX     (8)           /*<! Maximum number of frames in flight */
+#define ESP_H264_ENC_ASYNC_WAIT_FOREVER  (UINT32_MAX)  /*<! Timeout value to wait without limit */
+
+/**
+ * @brief  H.264 asynchronous encoder handle
+ */
+typedef struct esp_h264_enc_async *esp_h264_enc_async_handle_t;
+
+/**
+ * @brief  Completion of one submitted frame
+ */
+typedef struct {
+    esp_h264_err_t             ret;        /*<! Result of `esp_h264_enc_process` for this frame */
+    uint32_t                   seq;        /*<! Submission sequence number, starting from 0 */
+    esp_h264_enc_in_frame_t    in_frame;   /*<! Input frame as submitted, the buffer can be reused */
+    esp_h264_enc_out_frame_t   out_frame;  /*<! Output frame, `length` and `frame_type` are filled by the encoder */
+    esp_h264_enc_frame_stats_t stats;      /*<! Rate control(RC) statistics, zero if `get_stats` is not set */
+    void                      *user_ctx;   /*<! User context given at submission */
+} esp_h264_enc_async_result_t;
+
+/**
+ * @brief  Completion callback
+ *
+ * @note  It is called from the encoder task, in submission order. The frame slot is released
+ *        once the callback returns, so it must not block for long.
+ */
+typedef void (*esp_h264_enc_async_done_cb_t)(const esp_h264_enc_async_result_t *result, void *arg);
+
+/**
+ * @brief  Asynchronous encoder configure information
+ */
+typedef struct {
+    esp_h264_enc_handle_t        enc;          /*<! Opened encoder, only the encoder task calls it once the async encoder is created */
+    uint8_t                      depth;        /*<! Frames in flight, submitted but not completed, in [1, ESP_H264_ENC_ASYNC_DEPTH_MAX] */
+    esp_h264_enc_async_done_cb_t done_cb;      /*<! Completion callback. If NULL, completions are fetched with `esp_h264_enc_async_poll` */
+    void                        *done_cb_arg;  /*<! Argument of `done_cb` */
+    esp_h264_err_t (*get_stats)(esp_h264_enc_handle_t enc,
+                                esp_h264_enc_frame_stats_t *out_stats);  /*<! Statistics of the last frame, e.g. `esp_h264_enc_hw_get_frame_stats`, can be NULL */
+    uint32_t                     task_stack;   /*<! Stack size of the encoder task in byte */
+    uint8_t                      task_prio;    /*<! Priority of the encoder task */
+    int8_t                       task_core;    /*<! Core of the encoder task, -1 for no affinity */
+} esp_h264_enc_async_cfg_t;
+
+/**
+ * @brief  This function creates an asynchronous encoder on top of an opened encoder
+ *
+ *         Frames are encoded in submission order by a dedicated task, so the caller can capture,
+ *         convert or packetize other frames while the encoder is busy.
+ *
+ * @param[in]   cfg        Asynchronous encoder configure information
+ * @param[out]  out_async  The created asynchronous encoder
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ *       - ESP_H264_ERR_MEM  Insufficient memory
+ */
+esp_h264_err_t esp_h264_enc_async_new(const esp_h264_enc_async_cfg_t *cfg, esp_h264_enc_async_handle_t *out_async);
+
+/**
+ * @brief  This function queues one frame for encoding
+ *
+ * @note  The input and output buffers belong to the encoder until the frame completes.
+ *        If `depth` frames are already in flight, the function waits for a slot. Without `done_cb`,
+ *        slots are released by `esp_h264_enc_async_poll`, so poll first when every slot is taken.
+ *        Submit, poll and flush are meant to be called from a single task.
+ *
+ * @param[in]  async       The asynchronous encoder
+ * @param[in]  in_frame    Unencoded input frame
+ * @param[in]  out_frame   Output frame, `raw_data` is the buffer to encode into
+ * @param[in]  user_ctx    User context returned with the completion
+ * @param[in]  timeout_ms  Time to wait for a free slot in millisecond
+ *
+ * @return
+ *       - ESP_H264_ERR_OK       Succeeded
+ *       - ESP_H264_ERR_ARG      Invalid arguments passed
+ *       - ESP_H264_ERR_TIMEOUT  No slot freed in time
+ */
+esp_h264_err_t esp_h264_enc_async_submit(esp_h264_enc_async_handle_t async, const esp_h264_enc_in_frame_t *in_frame,
+                                         const esp_h264_enc_out_frame_t *out_frame, void *user_ctx, uint32_t timeout_ms);
+
+/**
+ * @brief  This function fetches the oldest completed frame, it releases the frame slot
+ *
+ * @param[in]   async       The asynchronous encoder, created without `done_cb`
+ * @param[out]  out_result  The completion
+ * @param[in]   timeout_ms  Time to wait for a completion in millisecond, 0 to poll
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_TIMEOUT      No frame completed in time
+ *       - ESP_H264_ERR_UNSUPPORTED  Completions are delivered through `done_cb`
+ */
+esp_h264_err_t esp_h264_enc_async_poll(esp_h264_enc_async_handle_t async, esp_h264_enc_async_result_t *out_result, uint32_t timeout_ms);
+
+/**
+ * @brief  This function waits until every submitted frame is encoded
+ *
+ * @note  Without `done_cb`, the completions stay available to `esp_h264_enc_async_poll`.
+ *
+ * @param[in]  async       The asynchronous encoder
+ * @param[in]  timeout_ms  Time to wait in millisecond
+ *
+ * @return
+ *       - ESP_H264_ERR_OK       Succeeded
+ *       - ESP_H264_ERR_ARG      Invalid arguments passed
+ *       - ESP_H264_ERR_TIMEOUT  Frames are still in flight
+ */
+esp_h264_err_t esp_h264_enc_async_flush(esp_h264_enc_async_handle_t async, uint32_t timeout_ms);
+
+/**
+ * @brief  This function gets the number of frames submitted and not yet released
+ *
+ * @param[in]  async  The asynchronous encoder
+ *
+ * @return
+ *       - Frames in flight, 0 if `async` is NULL
+ */
+uint8_t esp_h264_enc_async_get_in_flight(esp_h264_enc_async_handle_t async);
+
+/**
+ * @brief  This function encodes the frames in flight, then deletes the asynchronous encoder
+ *
+ * @note  The underlying encoder is neither closed nor deleted.
+ *        Completions not polled yet are dropped.
+ *
+ * @param[in]  async  The asynchronous encoder
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ */
+esp_h264_err_t esp_h264_enc_async_del(esp_h264_enc_async_handle_t async);
+
+#ifdef __cplusplus
+}
+#endif
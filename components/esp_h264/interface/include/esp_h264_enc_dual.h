@@ -26,6 +26,7 @@ typedef struct esp_h264_enc_dual_if {
                               esp_h264_enc_out_frame_t *out_frame[2]);                               /*<! The process function */
     esp_h264_err_t (*close)(esp_h264_enc_dual_handle_t enc);                                         /*<! The close function */
     esp_h264_err_t (*del)(esp_h264_enc_dual_handle_t enc);                                           /*<! The delete function */
+    esp_h264_err_t (*force_idr)(esp_h264_enc_dual_handle_t enc);                                     /*<! The force IDR function */
 } esp_h264_enc_dual_t;
 
 /**
@@ -72,6 +73,21 @@ esp_h264_err_t esp_h264_enc_dual_open(esp_h264_enc_dual_handle_t enc);
  */
 esp_h264_err_t esp_h264_enc_dual_process(esp_h264_enc_dual_handle_t enc, esp_h264_enc_in_frame_t *in_frame[2], esp_h264_enc_out_frame_t *out_frame[2]);
 
+/**
+ * @brief  This function requests the next encoded frames of both streams to be IDR frames
+ *
+ * @note  The dual streams share one group of picture(GOP), so both restart from the IDR frames.
+ *        The function can be called from another task than the encoding one, several requests before a frame give one IDR frame.
+ *
+ * @param[in]  enc  A pointer to the H.264 dual encoder instance
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_UNSUPPORTED  Force IDR feature is not supported by the encoder
+ */
+esp_h264_err_t esp_h264_enc_dual_force_idr(esp_h264_enc_dual_handle_t enc);
+
 /**
  * @brief  This function closes the H.264 dual encoder instance specified by `enc`
  *
@@ -129,6 +129,32 @@ typedef struct {
                                         The maximum is `mb_width * mb_height * sizeof(esp_h264_enc_mv_data_t)`*/
 } esp_h264_enc_mvm_pkt_t;
 
+/**
+ * @brief  H.264 rate control(RC) mode
+ */
+typedef enum {
+    ESP_H264_RC_MODE_AVERAGE = 0,  /*<! The QP follows the bits of the last 4 frames. It is the default mode */
+    ESP_H264_RC_MODE_CBR     = 1,  /*<! Constant bitrate. A leaky bucket video buffering verifier(VBV) drained at `bitrate` bounds the bursts */
+    ESP_H264_RC_MODE_VBR     = 2,  /*<! Capped variable bitrate. The bits follow the picture complexity, the average is `bitrate`
+                                        and the VBV is drained at `max_bitrate` */
+    ESP_H264_RC_MODE_CQP     = 3,  /*<! Constant quantization parameter(QP) */
+    ESP_H264_RC_MODE_INVALID = 4,  /*<! Invalid value */
+} esp_h264_enc_rc_mode_t;
+
+/**
+ * @brief  Rate control(RC) configuration
+ *
+ * @note  The zero value of a field selects its default
+ */
+typedef struct {
+    esp_h264_enc_rc_mode_t mode;          /*<! Rate control mode */
+    uint32_t               max_bitrate;   /*<! Peak bitrate of `ESP_H264_RC_MODE_VBR` in bit per second, not less than `bitrate`. Default 3/2 of `bitrate` */
+    uint32_t               vbv_size;      /*<! Size of the video buffering verifier(VBV) in bits. Default `bitrate`, one second of video */
+    uint8_t                idr_budget;    /*<! Bits of an IDR-frame in average frames of `bitrate`. Default 4 */
+    uint8_t                cqp;           /*<! QP of `ESP_H264_RC_MODE_CQP`. The range is [qp_min, qp_max] */
+    uint16_t               scene_change;  /*<! Raise in percent of the MAD of a P-frame over its average that is a scene change. Default 100 */
+} esp_h264_enc_rc_cfg_t;
+
 /**
  * @brief Handle for accessing hardware-specific H.264 encoder parameters
  */
@@ -147,6 +173,8 @@ typedef struct esp_h264_enc_hw_param_if {
     esp_h264_err_t (*get_mv_cfg_info)(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_mv_cfg_t *cfg);    /*<! Get the MV configuration parameter */
     esp_h264_err_t (*set_mv_pkt)(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_mvm_pkt_t mv_pkt);      /*<! Set motion vector(MV) packet */
     esp_h264_err_t (*get_mv_data_len)(esp_h264_enc_param_hw_handle_t handle, uint32_t *length);              /*<! Get motion vector(MV) buffer actual length */
+    esp_h264_err_t (*cfg_rc)(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t cfg);              /*<! Configure the rate control(RC) */
+    esp_h264_err_t (*get_rc_cfg_info)(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t *cfg);    /*<! Get the RC configuration parameter */
 } esp_h264_enc_param_hw_t;
 
 /**
@@ -262,6 +290,38 @@ esp_h264_err_t esp_h264_enc_hw_set_mv_pkt(esp_h264_enc_param_hw_handle_t handle,
  */
 esp_h264_err_t esp_h264_enc_hw_get_mv_data_len(esp_h264_enc_param_hw_handle_t handle, uint32_t *out_length);
 
+/**
+ * @brief  This function selects the rate control(RC) mode of the hardware-based H.264 encoder
+ *         The QP of each frame is chosen by the software RC from the bits, the MAD and the QP of the frames before it.
+ *         A P-frame whose MAD jumps over its average is a scene change, the QP model restarts from it.
+ *
+ * @note  The RC needs `qp_min` less than `qp_max` in the encoder configuration, otherwise the QP is fixed.
+ *        The VBV and the statistics restart on each configuration.
+ *
+ * @param[in]  handle  It is a pointer to the hardware H.264 encoding parameters structure
+ * @param[in]  cfg     An `esp_h264_enc_rc_cfg_t` structure that specifies the RC configuration
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_UNSUPPORTED  The RC is disabled, `qp_min` equals `qp_max`
+ */
+esp_h264_err_t esp_h264_enc_hw_cfg_rc(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t cfg);
+
+/**
+ * @brief  This function gets the rate control(RC) configuration of the hardware-based H.264 encoder
+ *
+ * @param[in]   handle   It is a pointer to the hardware H.264 encoding parameters structure
+ * @param[out]  out_cfg  A pointer to an `esp_h264_enc_rc_cfg_t` structure where the RC configuration information will be stored.
+ *                       When the RC is disabled, the mode is `ESP_H264_RC_MODE_CQP`
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_UNSUPPORTED  RC configuration is not supported by the encoder
+ */
+esp_h264_err_t esp_h264_enc_hw_get_rc_cfg_info(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t *out_cfg);
+
 #ifdef __cplusplus
 }
 #endif
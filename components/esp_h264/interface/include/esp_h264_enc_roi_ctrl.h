@@ -0,0 +1,121 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_h264_types.h"
+#include "esp_h264_enc_param_hw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_H264_ENC_ROI_REGION_MAX  (8)  /*<! ROI regions of the hardware encoder */
+
+/**
+ * @brief  H.264 range of interesting (ROI) controller handle
+ */
+typedef struct esp_h264_enc_roi_ctrl *esp_h264_enc_roi_ctrl_handle_t;
+
+/**
+ * @brief  Detected object box, e.g. a face or a person, in the coordinates of the detector input
+ *
+ * @note  An esp-dl `dl::detect::result_t` gives `{box[0], box[1], box[2] - box[0], box[3] - box[1]}`
+ */
+typedef struct {
+    int16_t  x;  /*<! Left of the box in pixel, can be negative when the box leaves the picture */
+    int16_t  y;  /*<! Top of the box in pixel, can be negative when the box leaves the picture */
+    uint16_t w;  /*<! Width of the box in pixel */
+    uint16_t h;  /*<! Height of the box in pixel */
+} esp_h264_enc_roi_box_t;
+
+/**
+ * @brief  ROI controller configure information
+ */
+typedef struct {
+    esp_h264_resolution_t src_res;            /*<! Resolution of the picture the boxes are detected on */
+    esp_h264_resolution_t enc_res;            /*<! Resolution of the encoded picture */
+    int8_t                roi_delta_qp;       /*<! Delta QP of the boxes, negative to keep them sharp, in [-51, 0] */
+    int8_t                none_roi_delta_qp;  /*<! Delta QP of the background, positive to save bits, in [0, 51] */
+    uint8_t               margin_mb;          /*<! Macroblocks added around each box, e.g. for hair and shoulders */
+    uint8_t               smooth;             /*<! Weight of a new box against the tracked region in percent, in [1, 100].
+                                                   100 follows the detector, lower values slow the region down to avoid QP jumps */
+    uint8_t               hold_updates;       /*<! Updates a region is kept without a matching box, it hides missed detections */
+} esp_h264_enc_roi_ctrl_cfg_t;
+
+/**
+ * @brief  This function creates an ROI controller
+ *
+ *         The controller maps detected boxes to macroblock aligned ROI regions and tracks them over time:
+ *         a box moves the region it overlaps the most, a box without region opens a new one,
+ *         a region without box for more than `hold_updates` updates is closed.
+ *
+ * @param[in]   cfg       ROI controller configure information
+ * @param[out]  out_ctrl  The created ROI controller
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ *       - ESP_H264_ERR_MEM  Insufficient memory
+ */
+esp_h264_err_t esp_h264_enc_roi_ctrl_new(const esp_h264_enc_roi_ctrl_cfg_t *cfg, esp_h264_enc_roi_ctrl_handle_t *out_ctrl);
+
+/**
+ * @brief  This function updates the regions with the boxes of one detection
+ *
+ * @note  Boxes beyond the `ESP_H264_ENC_ROI_REGION_MAX` tracked regions are dropped, so pass the most relevant first.
+ *
+ * @param[in]  ctrl     The ROI controller
+ * @param[in]  boxes    Detected boxes, can be NULL if `box_num` is 0
+ * @param[in]  box_num  Number of boxes
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ */
+esp_h264_err_t esp_h264_enc_roi_ctrl_update(esp_h264_enc_roi_ctrl_handle_t ctrl, const esp_h264_enc_roi_box_t *boxes, uint8_t box_num);
+
+/**
+ * @brief  This function gets the ROI regions, indexed by `reg_idx`
+ *
+ * @param[in]   ctrl     The ROI controller
+ * @param[out]  regions  `ESP_H264_ENC_ROI_REGION_MAX` regions, a closed region has `len_x` and `len_y` 0
+ *
+ * @return
+ *       - The number of opened regions
+ */
+uint8_t esp_h264_enc_roi_ctrl_get_regions(esp_h264_enc_roi_ctrl_handle_t ctrl, esp_h264_enc_roi_reg_t regions[ESP_H264_ENC_ROI_REGION_MAX]);
+
+/**
+ * @brief  This function writes the regions to the hardware encoder
+ *
+ * @note  The ROI is disabled when no region is opened, so the background is not degraded for nothing.
+ *        Call it from the encoding task, between two frames.
+ *
+ * @param[in]  ctrl      The ROI controller
+ * @param[in]  param_hd  Parameter handle of the hardware encoder, see `esp_h264_enc_hw_get_param_hd`
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ *       - Others            Failed to configure the encoder
+ */
+esp_h264_err_t esp_h264_enc_roi_ctrl_apply(esp_h264_enc_roi_ctrl_handle_t ctrl, esp_h264_enc_param_hw_handle_t param_hd);
+
+/**
+ * @brief  This function deletes an ROI controller, the encoder configuration is not changed
+ *
+ * @param[in]  ctrl  The ROI controller
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed
+ */
+esp_h264_err_t esp_h264_enc_roi_ctrl_del(esp_h264_enc_roi_ctrl_handle_t ctrl);
+
+#ifdef __cplusplus
+}
+#endif
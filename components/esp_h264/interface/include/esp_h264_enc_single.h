@@ -27,6 +27,7 @@ typedef struct esp_h264_enc_if {
                               esp_h264_enc_out_frame_t *out_frame);                          /*<! The process function */
     esp_h264_err_t (*close)(esp_h264_enc_handle_t enc);                                      /*<! The close function */
     esp_h264_err_t (*del)(esp_h264_enc_handle_t enc);                                        /*<! The delete function */
+    esp_h264_err_t (*force_idr)(esp_h264_enc_handle_t enc);                                  /*<! The force IDR function */
 } esp_h264_enc_t;
 
 /**
@@ -71,6 +72,53 @@ esp_h264_err_t esp_h264_enc_open(esp_h264_enc_handle_t enc);
  */
 esp_h264_err_t esp_h264_enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_frame_t *in_frame, esp_h264_enc_out_frame_t *out_frame);
 
+/**
+ * @brief  This function records that the CPU wrote a range of a raw frame
+ *
+ * @note  A `ESP_H264_CACHE_DMA_CLEAN` frame becomes `ESP_H264_CACHE_CPU_DIRTY_RANGE`, two ranges merge into the range that covers both.
+ *        A `ESP_H264_CACHE_CPU_DIRTY` frame stays so.
+ *
+ * @param[in]  in_frame  The raw frame, `raw_data` set
+ * @param[in]  offset    Offset in byte of the written range
+ * @param[in]  len       Length in byte of the written range
+ *
+ * @return
+ *       - ESP_H264_ERR_OK   Succeeded
+ *       - ESP_H264_ERR_ARG  Invalid arguments passed, or the range is out of `raw_data`
+ */
+esp_h264_err_t esp_h264_enc_in_frame_mark_dirty(esp_h264_enc_in_frame_t *in_frame, uint32_t offset, uint32_t len);
+
+/**
+ * @brief  This function gives the range of a raw frame the CPU may hold dirty in cache
+ *
+ * @note  An unknown state, or a dirty range out of `raw_data`, gives the whole frame.
+ *
+ * @param[in]   in_frame    The raw frame
+ * @param[out]  out_offset  Offset in byte of the range
+ * @param[out]  out_len     Length in byte of the range
+ *
+ * @return
+ *       - true   The range must be written back before a DMA reads the frame
+ *       - false  Nothing to write back
+ */
+bool esp_h264_enc_in_frame_get_dirty_range(const esp_h264_enc_in_frame_t *in_frame, uint32_t *out_offset, uint32_t *out_len);
+
+/**
+ * @brief  This function requests the next encoded frame to be an IDR frame
+ *
+ * @note  The IDR frame carries SPS and PPS, and the group of picture(GOP) restarts from it.
+ *        It is meant for a new viewer or a picture loss indication(PLI), so that the decoder does not wait for the next GOP.
+ *        The function can be called from another task than the encoding one, several requests before a frame give one IDR frame.
+ *
+ * @param[in]  enc  A pointer to the H.264 encoder instance
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_UNSUPPORTED  Force IDR feature is not supported by the encoder
+ */
+esp_h264_err_t esp_h264_enc_force_idr(esp_h264_enc_handle_t enc);
+
 /**
  * @brief  This function closes the H.264 encoder instance specified by `enc`
  *
@@ -27,6 +27,7 @@ typedef enum {
     ESP_H264_ERR_UNSUPPORTED    = -5,  /*<! Un-supported */
     ESP_H264_ERR_TIMEOUT        = -6,  /*<! Timeout */
     ESP_H264_ERR_OVERFLOW       = -7,  /*<! Buffer overflow */
+    ESP_H264_ERR_BUSY           = -8,  /*<! Resource is in use */
 } esp_h264_err_t;
 
 /**
@@ -167,14 +168,36 @@ typedef struct {
  */
 } esp_h264_enc_out_frame_t;
 
+/**
+ * @brief  Cache state of a raw frame, it tells the hardware encoder which part of the frame must be written back before encoding
+ */
+typedef enum {
+    ESP_H264_CACHE_CPU_DIRTY       = 0,  /*<! The CPU wrote the frame, the whole frame is written back. It is the default */
+    ESP_H264_CACHE_DMA_CLEAN       = 1,  /*<! A DMA (CSI, ISP, PPA) wrote the frame and the CPU did not, nothing is written back */
+    ESP_H264_CACHE_CPU_DIRTY_RANGE = 2,  /*<! The CPU only wrote `dirty_len` bytes at `dirty_offset`, e.g. an overlay on a captured frame */
+    ESP_H264_CACHE_INVALID         = 3,  /*<! Invalid value */
+} esp_h264_cache_state_t;
+
 /**
  * @brief  Data stream information before encoding
  */
 typedef struct {
-    esp_h264_pkt_t raw_data;  /*<! Unencoded data stream */
-    uint32_t       pts;       /*<! Presentation time stamp(PTS) */
+    esp_h264_pkt_t         raw_data;      /*<! Unencoded data stream */
+    uint32_t               pts;           /*<! Presentation time stamp(PTS) */
+    esp_h264_cache_state_t cache_state;   /*<! Cache state of `raw_data.buffer` */
+    uint32_t               dirty_offset;  /*<! Offset in byte of the range written by the CPU, for `ESP_H264_CACHE_CPU_DIRTY_RANGE` */
+    uint32_t               dirty_len;     /*<! Length in byte of the range written by the CPU, for `ESP_H264_CACHE_CPU_DIRTY_RANGE` */
 } esp_h264_enc_in_frame_t;
 
+/**
+ * @brief  Rate control(RC) statistics of one encoded frame
+ */
+typedef struct {
+    uint8_t  qp;    /*<! Average quantization parameter(QP) of the frame */
+    uint32_t bits;  /*<! Encoded bits of the frame, headers included */
+    uint32_t mad;   /*<! Sum of the mean absolute difference(MAD) of the macroblocks, 0 if RC is disabled */
+} esp_h264_enc_frame_stats_t;
+
 /**
  * @brief  Data stream information after encoding
  */
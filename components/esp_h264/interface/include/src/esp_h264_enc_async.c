@@ -0,0 +1,218 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_h264_enc_async.h"
+#include "esp_h264_check.h"
+
+#define ENC_ASYNC_TASK_NAME  "h264_enc_async"
+
+static const char *TAG = "H264_ENC.ASYNC";
+
+/**
+ * Frames travel through two FIFOs: `job_q` to the encoder task, and `done_q` back to the poller.
+ * A single task encodes, so completions always come out in submission order.
+ * `slots` counts free frame slots: taken at submission, given back once the completion is delivered.
+ * `submitted` is only written by the submitting task and `completed` only by the encoder task,
+ * `progress` wakes a flush up after each completion.
+ * `exited` is given by the encoder task as its very last access to the handle, a stale `progress` token
+ * left by a flush which returned early can not make `esp_h264_enc_async_del` free the handle under the task.
+ */
+typedef struct esp_h264_enc_async {
+    esp_h264_enc_handle_t        enc;
+    uint8_t                      depth;
+    esp_h264_enc_async_done_cb_t done_cb;
+    void                        *done_cb_arg;
+    esp_h264_err_t (*get_stats)(esp_h264_enc_handle_t enc, esp_h264_enc_frame_stats_t *out_stats);
+    QueueHandle_t                job_q;
+    QueueHandle_t                done_q;
+    SemaphoreHandle_t            slots;
+    SemaphoreHandle_t            progress;
+    SemaphoreHandle_t            exited;
+    TaskHandle_t                 task;
+    volatile uint32_t            submitted;
+    volatile uint32_t            completed;
+} esp_h264_enc_async_t;
+
+static inline TickType_t enc_async_ticks(uint32_t timeout_ms)
+{
+    return timeout_ms == ESP_H264_ENC_ASYNC_WAIT_FOREVER ? portMAX_DELAY : pdMS_TO_TICKS(timeout_ms);
+}
+
+static void enc_async_task(void *arg)
+{
+    esp_h264_enc_async_t *async = (esp_h264_enc_async_t *)arg;
+    esp_h264_enc_async_result_t job;
+
+    while (xQueueReceive(async->job_q, &job, portMAX_DELAY) == pdTRUE) {
+        /** A job without input buffer is the stop request of `esp_h264_enc_async_del` */
+        if (!job.in_frame.raw_data.buffer) {
+            break;
+        }
+        job.ret = esp_h264_enc_process(async->enc, &job.in_frame, &job.out_frame);
+        if (async->get_stats) {
+            async->get_stats(async->enc, &job.stats);
+        }
+        if (async->done_cb) {
+            async->done_cb(&job, async->done_cb_arg);
+            xSemaphoreGive(async->slots);
+        } else {
+            /** Never blocks, `done_q` holds `depth` items and at most `depth` frames are in flight */
+            xQueueSend(async->done_q, &job, portMAX_DELAY);
+        }
+        async->completed++;
+        xSemaphoreGive(async->progress);
+    }
+
+    xSemaphoreGive(async->exited);
+    vTaskDelete(NULL);
+}
+
+static void enc_async_free(esp_h264_enc_async_t *async)
+{
+    if (async->job_q) {
+        vQueueDelete(async->job_q);
+    }
+    if (async->done_q) {
+        vQueueDelete(async->done_q);
+    }
+    if (async->slots) {
+        vSemaphoreDelete(async->slots);
+    }
+    if (async->progress) {
+        vSemaphoreDelete(async->progress);
+    }
+    if (async->exited) {
+        vSemaphoreDelete(async->exited);
+    }
+    free(async);
+}
+
+esp_h264_err_t esp_h264_enc_async_new(const esp_h264_enc_async_cfg_t *cfg, esp_h264_enc_async_handle_t *out_async)
+{
+    ESP_H264_RET_ON_FALSE(cfg && out_async && cfg->enc, ESP_H264_ERR_ARG, TAG, "Invalid async encoder configure and handle parameter");
+    ESP_H264_RET_ON_FALSE(cfg->depth > 0 && cfg->depth <= ESP_H264_ENC_ASYNC_DEPTH_MAX, ESP_H264_ERR_ARG, TAG, "Invalid depth %d", cfg->depth);
+    ESP_H264_RET_ON_FALSE(cfg->task_stack > 0, ESP_H264_ERR_ARG, TAG, "Invalid task stack size");
+
+    *out_async = NULL;
+    esp_h264_enc_async_t *async = (esp_h264_enc_async_t *)calloc(1, sizeof(esp_h264_enc_async_t));
+    ESP_H264_RET_ON_FALSE(async, ESP_H264_ERR_MEM, TAG, "No memory for async handle");
+
+    async->enc = cfg->enc;
+    async->depth = cfg->depth;
+    async->done_cb = cfg->done_cb;
+    async->done_cb_arg = cfg->done_cb_arg;
+    async->get_stats = cfg->get_stats;
+
+    /** One more job than frames in flight for the stop request */
+    async->job_q = xQueueCreate(cfg->depth + 1, sizeof(esp_h264_enc_async_result_t));
+    async->slots = xSemaphoreCreateCounting(cfg->depth, cfg->depth);
+    async->progress = xSemaphoreCreateBinary();
+    async->exited = xSemaphoreCreateBinary();
+    if (!cfg->done_cb) {
+        async->done_q = xQueueCreate(cfg->depth, sizeof(esp_h264_enc_async_result_t));
+    }
+    if (!async->job_q || !async->slots || !async->progress || !async->exited || (!cfg->done_cb && !async->done_q)) {
+        ESP_H264_LOGE(TAG, "No memory for async queues");
+        enc_async_free(async);
+        return ESP_H264_ERR_MEM;
+    }
+
+    BaseType_t core = cfg->task_core < 0 ? tskNO_AFFINITY : cfg->task_core;
+    if (xTaskCreatePinnedToCore(enc_async_task, ENC_ASYNC_TASK_NAME, cfg->task_stack, async, cfg->task_prio,
+                                &async->task, core) != pdPASS) {
+        ESP_H264_LOGE(TAG, "No memory for async task");
+        enc_async_free(async);
+        return ESP_H264_ERR_MEM;
+    }
+
+    *out_async = async;
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t esp_h264_enc_async_submit(esp_h264_enc_async_handle_t async, const esp_h264_enc_in_frame_t *in_frame,
+                                         const esp_h264_enc_out_frame_t *out_frame, void *user_ctx, uint32_t timeout_ms)
+{
+    ESP_H264_RET_ON_FALSE(async && in_frame && out_frame, ESP_H264_ERR_ARG, TAG, "Invalid async handle");
+    ESP_H264_RET_ON_FALSE(in_frame->raw_data.buffer, ESP_H264_ERR_ARG, TAG, "The buffer pointer of input frame is NULL.");
+    ESP_H264_RET_ON_FALSE(out_frame->raw_data.buffer, ESP_H264_ERR_ARG, TAG, "The buffer pointer of output frame is NULL.");
+
+    if (xSemaphoreTake(async->slots, enc_async_ticks(timeout_ms)) != pdTRUE) {
+        return ESP_H264_ERR_TIMEOUT;
+    }
+
+    esp_h264_enc_async_result_t job = {
+        .ret = ESP_H264_ERR_OK,
+        .seq = async->submitted,
+        .in_frame = *in_frame,
+        .out_frame = *out_frame,
+        .user_ctx = user_ctx,
+    };
+    job.out_frame.length = 0;
+    job.out_frame.frame_type = ESP_H264_FRAME_TYPE_INVALID;
+
+    /** The slot guarantees room in `job_q` */
+    xQueueSend(async->job_q, &job, portMAX_DELAY);
+    async->submitted++;
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t esp_h264_enc_async_poll(esp_h264_enc_async_handle_t async, esp_h264_enc_async_result_t *out_result, uint32_t timeout_ms)
+{
+    ESP_H264_RET_ON_FALSE(async && out_result, ESP_H264_ERR_ARG, TAG, "Invalid async handle");
+    ESP_H264_RET_ON_FALSE(async->done_q, ESP_H264_ERR_UNSUPPORTED, TAG, "Completions are delivered by callback");
+
+    if (xQueueReceive(async->done_q, out_result, enc_async_ticks(timeout_ms)) != pdTRUE) {
+        return ESP_H264_ERR_TIMEOUT;
+    }
+    xSemaphoreGive(async->slots);
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t esp_h264_enc_async_flush(esp_h264_enc_async_handle_t async, uint32_t timeout_ms)
+{
+    ESP_H264_RET_ON_FALSE(async, ESP_H264_ERR_ARG, TAG, "Invalid async handle");
+
+    TimeOut_t time_out;
+    TickType_t ticks = enc_async_ticks(timeout_ms);
+    uint32_t target = async->submitted;
+
+    vTaskSetTimeOutState(&time_out);
+    while ((int32_t)(async->completed - target) < 0) {
+        if (xTaskCheckForTimeOut(&time_out, &ticks) == pdTRUE) {
+            return ESP_H264_ERR_TIMEOUT;
+        }
+        xSemaphoreTake(async->progress, ticks);
+    }
+    return ESP_H264_ERR_OK;
+}
+
+uint8_t esp_h264_enc_async_get_in_flight(esp_h264_enc_async_handle_t async)
+{
+    if (!async) {
+        return 0;
+    }
+    return async->depth - (uint8_t)uxSemaphoreGetCount(async->slots);
+}
+
+esp_h264_err_t esp_h264_enc_async_del(esp_h264_enc_async_handle_t async)
+{
+    ESP_H264_RET_ON_FALSE(async, ESP_H264_ERR_ARG, TAG, "Invalid async handle");
+
+    esp_h264_enc_async_flush(async, ESP_H264_ENC_ASYNC_WAIT_FOREVER);
+
+    esp_h264_enc_async_result_t stop = { 0 };
+    xQueueSend(async->job_q, &stop, portMAX_DELAY);
+    xSemaphoreTake(async->exited, portMAX_DELAY);
+
+    enc_async_free(async);
+    return ESP_H264_ERR_OK;
+}
@@ -27,6 +27,13 @@ esp_h264_err_t esp_h264_enc_dual_process(esp_h264_enc_dual_handle_t enc, esp_h26
     return enc->process(enc, in_frame, out_frame);
 }
 
+esp_h264_err_t esp_h264_enc_dual_force_idr(esp_h264_enc_dual_handle_t enc)
+{
+    ESP_H264_RET_ON_FALSE(enc, ESP_H264_ERR_ARG, TAG, "Invalid h264 handle");
+    ESP_H264_RET_ON_FALSE(enc->force_idr, ESP_H264_ERR_UNSUPPORTED, TAG, "Force IDR function is not supported yet");
+    return enc->force_idr(enc);
+}
+
 esp_h264_err_t esp_h264_enc_dual_close(esp_h264_enc_dual_handle_t enc)
 {
     ESP_H264_RET_ON_FALSE(enc, ESP_H264_ERR_ARG, TAG, "Invalid h264 handle");
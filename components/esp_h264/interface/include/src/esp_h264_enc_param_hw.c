@@ -75,3 +75,20 @@ esp_h264_err_t esp_h264_enc_hw_get_mv_data_len(esp_h264_enc_param_hw_handle_t ha
     ESP_H264_RET_ON_FALSE(handle->get_mv_data_len, ESP_H264_ERR_UNSUPPORTED, TAG, "`get_mv_data_len` is not supported yet");
     return handle->get_mv_data_len(handle, out_length);
 }
+
+esp_h264_err_t esp_h264_enc_hw_cfg_rc(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t cfg)
+{
+    ESP_H264_RET_ON_FALSE(handle, ESP_H264_ERR_ARG, TAG, "Invalid h264 parameter");
+    ESP_H264_RET_ON_FALSE(cfg.mode < ESP_H264_RC_MODE_INVALID, ESP_H264_ERR_ARG, TAG, "The RC mode is gather than or equal ESP_H264_RC_MODE_INVALID");
+    ESP_H264_RET_ON_FALSE(cfg.cqp <= 51, ESP_H264_ERR_ARG, TAG, "The constant QP is gather than 51");
+    ESP_H264_RET_ON_FALSE(handle->cfg_rc, ESP_H264_ERR_UNSUPPORTED, TAG, "`cfg_rc` is not supported yet");
+    return handle->cfg_rc(handle, cfg);
+}
+
+esp_h264_err_t esp_h264_enc_hw_get_rc_cfg_info(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_rc_cfg_t *out_cfg)
+{
+    ESP_H264_RET_ON_FALSE(handle, ESP_H264_ERR_ARG, TAG, "Invalid h264 parameter");
+    ESP_H264_RET_ON_FALSE(out_cfg, ESP_H264_ERR_ARG, TAG, "The out RC configure pointer is NULL");
+    ESP_H264_RET_ON_FALSE(handle->get_rc_cfg_info, ESP_H264_ERR_UNSUPPORTED, TAG, "`get_rc_cfg_info` is not supported yet");
+    return handle->get_rc_cfg_info(handle, out_cfg);
+}
@@ -0,0 +1,222 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "esp_h264_enc_roi_ctrl.h"
+#include "esp_h264_check.h"
+
+#define ROI_CTRL_Q8(v)  ((int32_t)(v) << 8)
+
+static const char *TAG = "H264_ENC.ROI_CTRL";
+
+/**
+ * A tracked region, in macroblocks with 8 fractional bits so that the smoothing moves it less than one macroblock.
+ * The right and bottom sides are exclusive.
+ */
+typedef struct {
+    int32_t x0;
+    int32_t y0;
+    int32_t x1;
+    int32_t y1;
+    uint8_t miss;
+    bool    active;
+    bool    matched;
+} roi_track_t;
+
+typedef struct esp_h264_enc_roi_ctrl {
+    esp_h264_enc_roi_ctrl_cfg_t cfg;
+    uint8_t                     mb_width;
+    uint8_t                     mb_height;
+    bool                        roi_enabled;
+    roi_track_t                 track[ESP_H264_ENC_ROI_REGION_MAX];
+} esp_h264_enc_roi_ctrl_t;
+
+static inline int32_t roi_clamp(int32_t v, int32_t min, int32_t max)
+{
+    return v < min ? min : (v > max ? max : v);
+}
+
+/** Scale the box to the encoded picture and round it out to whole macroblocks, plus the margin */
+static bool roi_box_to_mb(esp_h264_enc_roi_ctrl_t *ctrl, const esp_h264_enc_roi_box_t *box, int32_t rect[4])
+{
+    const esp_h264_enc_roi_ctrl_cfg_t *cfg = &ctrl->cfg;
+    int32_t x0 = roi_clamp((int32_t)box->x * cfg->enc_res.width / cfg->src_res.width, 0, cfg->enc_res.width);
+    int32_t y0 = roi_clamp((int32_t)box->y * cfg->enc_res.height / cfg->src_res.height, 0, cfg->enc_res.height);
+    int32_t x1 = roi_clamp(((int32_t)box->x + box->w) * cfg->enc_res.width / cfg->src_res.width, 0, cfg->enc_res.width);
+    int32_t y1 = roi_clamp(((int32_t)box->y + box->h) * cfg->enc_res.height / cfg->src_res.height, 0, cfg->enc_res.height);
+    if (x1 <= x0 || y1 <= y0) {
+        return false;
+    }
+    rect[0] = roi_clamp((x0 >> 4) - cfg->margin_mb, 0, ctrl->mb_width);
+    rect[1] = roi_clamp((y0 >> 4) - cfg->margin_mb, 0, ctrl->mb_height);
+    rect[2] = roi_clamp(((x1 + 15) >> 4) + cfg->margin_mb, 0, ctrl->mb_width);
+    rect[3] = roi_clamp(((y1 + 15) >> 4) + cfg->margin_mb, 0, ctrl->mb_height);
+    return true;
+}
+
+/** Round a tracked side to the nearest macroblock */
+static inline int32_t roi_round(int32_t v)
+{
+    return (v + 128) >> 8;
+}
+
+static void roi_track_to_reg(esp_h264_enc_roi_ctrl_t *ctrl, const roi_track_t *t, esp_h264_enc_roi_reg_t *reg)
+{
+    int32_t x0 = roi_clamp(roi_round(t->x0), 0, ctrl->mb_width - 1);
+    int32_t y0 = roi_clamp(roi_round(t->y0), 0, ctrl->mb_height - 1);
+    int32_t x1 = roi_clamp(roi_round(t->x1), x0 + 1, ctrl->mb_width);
+    int32_t y1 = roi_clamp(roi_round(t->y1), y0 + 1, ctrl->mb_height);
+    reg->x = x0;
+    reg->y = y0;
+    reg->len_x = x1 - x0;
+    reg->len_y = y1 - y0;
+}
+
+static int32_t roi_overlap(const roi_track_t *t, const int32_t rect[4])
+{
+    int32_t w = (t->x1 < ROI_CTRL_Q8(rect[2]) ? t->x1 : ROI_CTRL_Q8(rect[2])) - (t->x0 > ROI_CTRL_Q8(rect[0]) ? t->x0 : ROI_CTRL_Q8(rect[0]));
+    int32_t h = (t->y1 < ROI_CTRL_Q8(rect[3]) ? t->y1 : ROI_CTRL_Q8(rect[3])) - (t->y0 > ROI_CTRL_Q8(rect[1]) ? t->y0 : ROI_CTRL_Q8(rect[1]));
+    if (w <= 0 || h <= 0) {
+        return 0;
+    }
+    /** Back to 1/16 macroblock so that the product of two sides stays in 32 bits */
+    return (w >> 4) * (h >> 4) + 1;
+}
+
+esp_h264_err_t esp_h264_enc_roi_ctrl_new(const esp_h264_enc_roi_ctrl_cfg_t *cfg, esp_h264_enc_roi_ctrl_handle_t *out_ctrl)
+{
+    ESP_H264_RET_ON_FALSE(cfg && out_ctrl, ESP_H264_ERR_ARG, TAG, "Invalid ROI controller configure and handle parameter");
+    ESP_H264_RET_ON_FALSE(cfg->src_res.width && cfg->src_res.height && cfg->enc_res.width && cfg->enc_res.height,
+                          ESP_H264_ERR_ARG, TAG, "Invalid resolution");
+    ESP_H264_RET_ON_FALSE(cfg->roi_delta_qp <= 0 && cfg->roi_delta_qp >= -ESP_H264_QP_MAX, ESP_H264_ERR_ARG, TAG, "Invalid ROI delta QP %d", cfg->roi_delta_qp);
+    ESP_H264_RET_ON_FALSE(cfg->none_roi_delta_qp >= 0 && cfg->none_roi_delta_qp <= ESP_H264_QP_MAX, ESP_H264_ERR_ARG, TAG, "Invalid none ROI delta QP %d", cfg->none_roi_delta_qp);
+    ESP_H264_RET_ON_FALSE(cfg->smooth > 0 && cfg->smooth <= 100, ESP_H264_ERR_ARG, TAG, "Invalid smooth %d", cfg->smooth);
+
+    *out_ctrl = NULL;
+    esp_h264_enc_roi_ctrl_t *ctrl = (esp_h264_enc_roi_ctrl_t *)calloc(1, sizeof(esp_h264_enc_roi_ctrl_t));
+    ESP_H264_RET_ON_FALSE(ctrl, ESP_H264_ERR_MEM, TAG, "No memory for ROI controller");
+    ctrl->cfg = *cfg;
+    ctrl->mb_width = (cfg->enc_res.width + 15) >> 4;
+    ctrl->mb_height = (cfg->enc_res.height + 15) >> 4;
+    *out_ctrl = ctrl;
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t esp_h264_enc_roi_ctrl_update(esp_h264_enc_roi_ctrl_handle_t ctrl, const esp_h264_enc_roi_box_t *boxes, uint8_t box_num)
+{
+    ESP_H264_RET_ON_FALSE(ctrl && (boxes || !box_num), ESP_H264_ERR_ARG, TAG, "Invalid ROI controller");
+
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+        ctrl->track[i].matched = false;
+    }
+    for (uint8_t b = 0; b < box_num; b++) {
+        int32_t rect[4];
+        if (!roi_box_to_mb(ctrl, &boxes[b], rect)) {
+            continue;
+        }
+        /** The box moves the free tracked region it overlaps the most, or opens a new one */
+        roi_track_t *best = NULL;
+        roi_track_t *idle = NULL;
+        int32_t best_overlap = 0;
+        for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+            roi_track_t *t = &ctrl->track[i];
+            if (!t->active) {
+                idle = idle ? idle : t;
+                continue;
+            }
+            int32_t overlap = t->matched ? 0 : roi_overlap(t, rect);
+            if (overlap > best_overlap) {
+                best_overlap = overlap;
+                best = t;
+            }
+        }
+        if (best) {
+            int32_t smooth = ctrl->cfg.smooth;
+            best->x0 += (ROI_CTRL_Q8(rect[0]) - best->x0) * smooth / 100;
+            best->y0 += (ROI_CTRL_Q8(rect[1]) - best->y0) * smooth / 100;
+            best->x1 += (ROI_CTRL_Q8(rect[2]) - best->x1) * smooth / 100;
+            best->y1 += (ROI_CTRL_Q8(rect[3]) - best->y1) * smooth / 100;
+            best->miss = 0;
+            best->matched = true;
+        } else if (idle) {
+            idle->x0 = ROI_CTRL_Q8(rect[0]);
+            idle->y0 = ROI_CTRL_Q8(rect[1]);
+            idle->x1 = ROI_CTRL_Q8(rect[2]);
+            idle->y1 = ROI_CTRL_Q8(rect[3]);
+            idle->miss = 0;
+            idle->active = true;
+            idle->matched = true;
+        }
+    }
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+        roi_track_t *t = &ctrl->track[i];
+        if (t->active && !t->matched && ++t->miss > ctrl->cfg.hold_updates) {
+            t->active = false;
+        }
+    }
+    return ESP_H264_ERR_OK;
+}
+
+uint8_t esp_h264_enc_roi_ctrl_get_regions(esp_h264_enc_roi_ctrl_handle_t ctrl, esp_h264_enc_roi_reg_t regions[ESP_H264_ENC_ROI_REGION_MAX])
+{
+    if (!ctrl || !regions) {
+        return 0;
+    }
+    uint8_t num = 0;
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+        memset(&regions[i], 0, sizeof(esp_h264_enc_roi_reg_t));
+        regions[i].reg_idx = i;
+        if (ctrl->track[i].active) {
+            roi_track_to_reg(ctrl, &ctrl->track[i], &regions[i]);
+            regions[i].qp = ctrl->cfg.roi_delta_qp;
+            num++;
+        }
+    }
+    return num;
+}
+
+esp_h264_err_t esp_h264_enc_roi_ctrl_apply(esp_h264_enc_roi_ctrl_handle_t ctrl, esp_h264_enc_param_hw_handle_t param_hd)
+{
+    ESP_H264_RET_ON_FALSE(ctrl && param_hd, ESP_H264_ERR_ARG, TAG, "Invalid ROI controller and parameter handle");
+
+    esp_h264_enc_roi_reg_t regions[ESP_H264_ENC_ROI_REGION_MAX];
+    uint8_t num = esp_h264_enc_roi_ctrl_get_regions(ctrl, regions);
+    esp_h264_err_t ret = ESP_H264_ERR_OK;
+    if (num == 0) {
+        if (ctrl->roi_enabled) {
+            esp_h264_enc_roi_cfg_t roi_cfg = {
+                .roi_mode = ESP_H264_ROI_MODE_DISABLE,
+                .none_roi_delta_qp = 0,
+            };
+            ret = esp_h264_enc_hw_cfg_roi(param_hd, roi_cfg);
+            ctrl->roi_enabled = ret != ESP_H264_ERR_OK;
+        }
+        return ret;
+    }
+    if (!ctrl->roi_enabled) {
+        esp_h264_enc_roi_cfg_t roi_cfg = {
+            .roi_mode = ESP_H264_ROI_MODE_DELTA_QP,
+            .none_roi_delta_qp = ctrl->cfg.none_roi_delta_qp,
+        };
+        ret = esp_h264_enc_hw_cfg_roi(param_hd, roi_cfg);
+        ESP_H264_RET_ON_FALSE(ret == ESP_H264_ERR_OK, ret, TAG, "Failed to enable ROI");
+        ctrl->roi_enabled = true;
+    }
+    /** Closed regions are written too, a region with zero length is disabled */
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+        ret = esp_h264_enc_hw_set_roi_region(param_hd, regions[i]);
+        ESP_H264_RET_ON_FALSE(ret == ESP_H264_ERR_OK, ret, TAG, "Failed to set ROI region %d", i);
+    }
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t esp_h264_enc_roi_ctrl_del(esp_h264_enc_roi_ctrl_handle_t ctrl)
+{
+    ESP_H264_RET_ON_FALSE(ctrl, ESP_H264_ERR_ARG, TAG, "Invalid ROI controller");
+    free(ctrl);
+    return ESP_H264_ERR_OK;
+}
@@ -25,6 +25,64 @@ esp_h264_err_t esp_h264_enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_f
     return enc->process(enc, in_frame, out_frame);
 }
 
+esp_h264_err_t esp_h264_enc_in_frame_mark_dirty(esp_h264_enc_in_frame_t *in_frame, uint32_t offset, uint32_t len)
+{
+    ESP_H264_RET_ON_FALSE(in_frame, ESP_H264_ERR_ARG, TAG, "Invalid frame");
+    ESP_H264_RET_ON_FALSE(offset < in_frame->raw_data.len && len <= in_frame->raw_data.len - offset, ESP_H264_ERR_ARG, TAG, "The range is out of the frame");
+    if (len == 0) {
+        return ESP_H264_ERR_OK;
+    }
+    switch (in_frame->cache_state) {
+    case ESP_H264_CACHE_DMA_CLEAN:
+        in_frame->cache_state = ESP_H264_CACHE_CPU_DIRTY_RANGE;
+        in_frame->dirty_offset = offset;
+        in_frame->dirty_len = len;
+        break;
+    case ESP_H264_CACHE_CPU_DIRTY_RANGE: {
+        uint32_t start = offset;
+        uint32_t end = offset + len;
+        if (in_frame->dirty_len) {
+            uint32_t dirty_end = in_frame->dirty_offset + in_frame->dirty_len;
+            start = in_frame->dirty_offset < start ? in_frame->dirty_offset : start;
+            end = dirty_end > end ? dirty_end : end;
+        }
+        in_frame->dirty_offset = start;
+        in_frame->dirty_len = end - start;
+        break;
+    }
+    default:
+        /** The whole frame is dirty already */
+        break;
+    }
+    return ESP_H264_ERR_OK;
+}
+
+bool esp_h264_enc_in_frame_get_dirty_range(const esp_h264_enc_in_frame_t *in_frame, uint32_t *out_offset, uint32_t *out_len)
+{
+    uint32_t len = in_frame->raw_data.len;
+    *out_offset = 0;
+    *out_len = 0;
+    if (in_frame->cache_state == ESP_H264_CACHE_DMA_CLEAN) {
+        return false;
+    }
+    if (in_frame->cache_state == ESP_H264_CACHE_CPU_DIRTY_RANGE
+            && in_frame->dirty_offset < len && in_frame->dirty_len <= len - in_frame->dirty_offset) {
+        *out_offset = in_frame->dirty_offset;
+        *out_len = in_frame->dirty_len;
+        return in_frame->dirty_len > 0;
+    }
+    /** CPU dirty, unknown state or a range out of the frame */
+    *out_len = len;
+    return len > 0;
+}
+
+esp_h264_err_t esp_h264_enc_force_idr(esp_h264_enc_handle_t enc)
+{
+    ESP_H264_RET_ON_FALSE(enc, ESP_H264_ERR_ARG, TAG, "Invalid h264 handle");
+    ESP_H264_RET_ON_FALSE(enc->force_idr, ESP_H264_ERR_UNSUPPORTED, TAG, "Force IDR function is not supported yet");
+    return enc->force_idr(enc);
+}
+
 esp_h264_err_t esp_h264_enc_close(esp_h264_enc_handle_t enc)
 {
     ESP_H264_RET_ON_FALSE(enc, ESP_H264_ERR_ARG, TAG, "Invalid h264 handle");
@@ -23,3 +23,12 @@ void esp_h264_cache_check_and_writeback(uint8_t *addr, uint32_t length);
  * @param[in]  length  The length of `addr`
  */
 void esp_h264_cache_check_and_invalidate(uint8_t *addr, uint32_t length);
+
+/**
+ * @brief  Invalidate the first `length` bytes of a buffer written by a DMA, rounded up to the cache line
+ *
+ * @param[in]  addr        The buffer address, aligned to the cache line
+ * @param[in]  length      The length written by the DMA
+ * @param[in]  buf_length  The length of the buffer, aligned to the cache line
+ */
+void esp_h264_cache_check_and_invalidate_len(uint8_t *addr, uint32_t length, uint32_t buf_length);
@@ -5,6 +5,9 @@
  */
 
 #include "esp_cache.h"
+#include "esp_heap_caps.h"
+#include "esp_memory_utils.h"
+#include "esp_private/esp_cache_private.h"
 #include "esp_h264_cache.h"
 
 void esp_h264_cache_check_and_writeback(uint8_t *addr, uint32_t length)
@@ -16,3 +19,16 @@ void esp_h264_cache_check_and_invalidate(uint8_t *addr, uint32_t length)
 {
     esp_cache_msync(addr, length, ESP_CACHE_MSYNC_FLAG_DIR_M2C);
 }
+
+void esp_h264_cache_check_and_invalidate_len(uint8_t *addr, uint32_t length, uint32_t buf_length)
+{
+    size_t line_size = 0;
+    uint32_t caps = esp_ptr_external_ram(addr) ? MALLOC_CAP_SPIRAM : MALLOC_CAP_INTERNAL;
+    if (esp_cache_get_alignment(caps, &line_size) == ESP_OK && line_size) {
+        length = (length + line_size - 1) / line_size * line_size;
+        if (length < buf_length) {
+            buf_length = length;
+        }
+    }
+    esp_h264_cache_check_and_invalidate(addr, buf_length);
+}
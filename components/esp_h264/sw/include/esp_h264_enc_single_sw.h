@@ -23,6 +23,28 @@ typedef esp_h264_enc_param_handle_t esp_h264_enc_param_sw_handle_t;
  */
 typedef esp_h264_enc_cfg_t esp_h264_enc_cfg_sw_t;
 
+/**
+ * @brief  Maximum number of threads of the software encoder
+ */
+#define ESP_H264_SW_MAX_THREADS (4)
+
+/**
+ * @brief  Complexity of the software encoder, a lower complexity is faster and compresses less
+ */
+typedef enum {
+    ESP_H264_SW_COMPLEXITY_LOW    = 0,  /*<! Fastest, the default one */
+    ESP_H264_SW_COMPLEXITY_MEDIUM = 1,  /*<! Medium */
+    ESP_H264_SW_COMPLEXITY_HIGH   = 2,  /*<! Best compression */
+} esp_h264_sw_complexity_t;
+
+/**
+ * @brief  Speed settings of the software encoder
+ */
+typedef struct {
+    uint8_t                  threads;     /*<! Number of encoding threads from 1 to `ESP_H264_SW_MAX_THREADS`, 1 is the default one */
+    esp_h264_sw_complexity_t complexity;  /*<! Encoder complexity */
+} esp_h264_enc_sw_tuning_t;
+
 
 /**
  * @brief  This function is used to create a new instance of the `esp_h264_enc_t` data structure,
@@ -52,6 +74,23 @@ esp_h264_err_t esp_h264_enc_sw_new(const esp_h264_enc_cfg_sw_t *cfg, esp_h264_en
  */
 esp_h264_err_t esp_h264_enc_sw_get_param_hd(esp_h264_enc_handle_t enc, esp_h264_enc_param_sw_handle_t *out_param);
 
+/**
+ * @brief  This function sets the number of threads and the complexity of the software encoder
+ *
+ * @note  openh264 encodes the slices of a picture in parallel. With more than one thread, a picture of one slice
+ *        is cut into one slice per thread.
+ *        The encoder is re-initialized, the next frame is an IDR-frame.
+ *
+ * @param[in]  enc     The encoder instance that is from `esp_h264_enc_sw_new`
+ * @param[in]  tuning  The speed settings
+ *
+ * @return
+ *       - ESP_H264_ERR_OK    Succeeded
+ *       - ESP_H264_ERR_ARG   Invalid arguments passed
+ *       - ESP_H264_ERR_FAIL  openh264 rejected the settings
+ */
+esp_h264_err_t esp_h264_enc_sw_set_tuning(esp_h264_enc_handle_t enc, const esp_h264_enc_sw_tuning_t *tuning);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,7 @@ typedef struct esp_h264_enc_sw_handle {
     esp_h264_enc_t        base;
     esp_h264_enc_param_t *param_hd;
     uint8_t               gop;
+    volatile bool         force_idr;
     esp_h264_raw_format_t pic_type;
     uint8_t              *yuv_cache;
     SSourcePicture        src_pic;
@@ -98,6 +99,11 @@ static esp_h264_err_t h264_sw_enc_process(esp_h264_enc_sw_handle_t *sw_hd, esp_h
     sw_hd->src_pic.pData[1] = sw_hd->src_pic.pData[0] + sw_hd->wxh;
     sw_hd->src_pic.pData[2] = sw_hd->src_pic.pData[1] + sw_hd->wxh_q;
     sw_hd->src_pic.uiTimeStamp = in_frame->pts;
+    if (sw_hd->force_idr) {
+        /** Requested IDR-frame, openh264 restarts the intra period from it */
+        sw_hd->force_idr = false;
+        (*(sw_hd->pPtrEnc))->ForceIntraFrame(sw_hd->pPtrEnc, true);
+    }
     SFrameBSInfo sFbi;
     sFbi.iFrameSizeInBytes = out_frame->raw_data.len;
     sFbi.sLayerInfo[0].pBsBuf = out_frame->raw_data.buffer;
@@ -114,6 +120,21 @@ static esp_h264_err_t h264_sw_enc_process(esp_h264_enc_sw_handle_t *sw_hd, esp_h
         return ESP_H264_ERR_FAIL;
     }
     out_frame->length = (uint32_t)sFbi.iFrameSizeInBytes;
+    switch (sFbi.eFrameType) {
+    case videoFrameTypeIDR:
+        out_frame->frame_type = ESP_H264_FRAME_TYPE_IDR;
+        break;
+    case videoFrameTypeI:
+        out_frame->frame_type = ESP_H264_FRAME_TYPE_I;
+        break;
+    case videoFrameTypeP:
+        out_frame->frame_type = ESP_H264_FRAME_TYPE_P;
+        break;
+    default:
+        /** Skipped frame, nothing is output */
+        out_frame->frame_type = ESP_H264_FRAME_TYPE_INVALID;
+        break;
+    }
     out_frame->pts = (uint32_t)sFbi.uiTimeStamp;
     out_frame->dts = in_frame->pts;
     return ESP_H264_ERR_OK;
@@ -127,6 +148,13 @@ static esp_h264_err_t enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_fra
     return ret;
 }
 
+static esp_h264_err_t enc_force_idr(esp_h264_enc_handle_t enc)
+{
+    esp_h264_enc_sw_handle_t *sw_hd = __containerof(enc, esp_h264_enc_sw_handle_t, base);
+    sw_hd->force_idr = true;
+    return ESP_H264_ERR_OK;
+}
+
 static esp_h264_err_t enc_close(esp_h264_enc_handle_t enc)
 {
     return ESP_H264_ERR_OK;
@@ -228,6 +256,7 @@ esp_h264_err_t esp_h264_enc_sw_new(const esp_h264_enc_cfg_sw_t *cfg, esp_h264_en
     sw_hd->base.process = enc_process;
     sw_hd->base.close = enc_close;
     sw_hd->base.del = enc_del;
+    sw_hd->base.force_idr = enc_force_idr;
     *out_enc = &sw_hd->base;
     return ret;
 __exit__:
@@ -245,3 +274,25 @@ esp_h264_err_t esp_h264_enc_sw_get_param_hd(esp_h264_enc_handle_t enc, esp_h264_
     }
     return ESP_H264_ERR_ARG;
 }
+
+esp_h264_err_t esp_h264_enc_sw_set_tuning(esp_h264_enc_handle_t enc, const esp_h264_enc_sw_tuning_t *tuning)
+{
+    ESP_H264_RET_ON_FALSE(enc && tuning, ESP_H264_ERR_ARG, TAG, "Invalid h264 handle and tuning parameter");
+    ESP_H264_RET_ON_FALSE((tuning->threads >= 1) && (tuning->threads <= ESP_H264_SW_MAX_THREADS), ESP_H264_ERR_ARG, TAG, "Invalid thread number %d", tuning->threads);
+    ESP_H264_RET_ON_FALSE(tuning->complexity <= ESP_H264_SW_COMPLEXITY_HIGH, ESP_H264_ERR_ARG, TAG, "Invalid complexity %d", tuning->complexity);
+    esp_h264_enc_sw_handle_t *sw_hd = __containerof(enc, esp_h264_enc_sw_handle_t, base);
+    SEncParamExt sParam;
+    (*(sw_hd->pPtrEnc))->GetOption(sw_hd->pPtrEnc, ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sParam);
+    static const ECOMPLEXITY_MODE complexity[] = {LOW_COMPLEXITY, MEDIUM_COMPLEXITY, HIGH_COMPLEXITY};
+    sParam.iComplexityMode = complexity[tuning->complexity];
+    sParam.iMultipleThreadIdc = tuning->threads;
+
+    /** The threads work on slices: one slice per thread */
+    SSliceArgument *slice_arg = &sParam.sSpatialLayers[0].sSliceArgument;
+    memset(slice_arg, 0, sizeof(SSliceArgument));
+    slice_arg->uiSliceMode = tuning->threads > 1 ? SM_FIXEDSLCNUM_SLICE : SM_SINGLE_SLICE;
+    slice_arg->uiSliceNum = tuning->threads;
+    int ret = (*(sw_hd->pPtrEnc))->SetOption(sw_hd->pPtrEnc, ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sParam);
+    ESP_H264_RET_ON_FALSE(ret == cmResultSuccess, ESP_H264_ERR_FAIL, TAG, "Failed to set %d threads", tuning->threads);
+    return ESP_H264_ERR_OK;
+}
@@ -0,0 +1,29 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+/**
+ * Linux stand-in of `port/include/esp_h264_alloc.h`, there are no memory capabilities on the host
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#define ESP_H264_MEM_INTERNAL (1 << 0)
+#define ESP_H264_MEM_SPIRAM   (1 << 1)
+#define ALIGN_UP(num, align)    (((num) + ((align) - 1)) & ~((align) - 1))
+
+#ifndef __containerof
+#define __containerof(ptr, type, member) ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif  /* __containerof */
+
+#define esp_h264_free           free
+
+void *esp_h264_aligned_calloc(uint32_t alignment, uint32_t n, uint32_t size, uint32_t *actual_size, uint32_t caps);
+
+void *esp_h264_calloc_prefer(uint32_t n, uint32_t size, uint32_t *actual_size, uint32_t caps1, uint32_t caps2);
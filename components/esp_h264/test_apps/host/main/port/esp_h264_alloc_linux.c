@@ -0,0 +1,33 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "esp_h264_alloc.h"
+
+void *esp_h264_aligned_calloc(uint32_t alignment, uint32_t n, uint32_t size, uint32_t *actual_size, uint32_t caps)
+{
+    (void)caps;
+    *actual_size = ALIGN_UP(n * size, alignment);
+    void *ptr = NULL;
+    if (posix_memalign(&ptr, alignment, *actual_size) != 0) {
+        return NULL;
+    }
+    memset(ptr, 0, *actual_size);
+    return ptr;
+}
+
+void *esp_h264_calloc_prefer(uint32_t n, uint32_t size, uint32_t *actual_size, uint32_t caps1, uint32_t caps2)
+{
+    (void)caps1;
+    (void)caps2;
+    *actual_size = n * size;
+    return calloc(n, size);
+}
+
+const char *esp_openh264_get_version(void)
+{
+    return "host";
+}
@@ -0,0 +1,309 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+
+#include "esp_h264_enc_async.h"
+
+#define TEST_FRAMES        12
+#define TEST_GOP           5
+#define TEST_FRAME_SIZE    64
+#define TEST_ENC_MS        20
+#define TEST_TASK_STACK    4096
+#define TEST_WAIT_MS       2000
+
+/**
+ * Simulated encoder: takes TEST_ENC_MS per frame like the hardware blocking on its interrupt,
+ * writes the input PTS as payload and reports the frame length as its QP.
+ * A closed gate holds the encoder on the current frame.
+ */
+typedef struct {
+    esp_h264_enc_t    base;  /* First member, the handle is the simulated encoder */
+    uint32_t          frame_num;
+    uint32_t          fail_pts;
+    SemaphoreHandle_t gate;
+    bool              gated;
+    esp_h264_enc_frame_stats_t stats;
+} sim_enc_t;
+
+typedef struct {
+    uint32_t count;
+    uint32_t seq[TEST_FRAMES];
+    uint32_t pts[TEST_FRAMES];
+    esp_h264_err_t ret[TEST_FRAMES];
+    esp_h264_frame_type_t type[TEST_FRAMES];
+    uint32_t length[TEST_FRAMES];
+    uint8_t qp[TEST_FRAMES];
+    void *user_ctx[TEST_FRAMES];
+} sim_log_t;
+
+static uint8_t s_in_buf[TEST_FRAMES][TEST_FRAME_SIZE];
+static uint8_t s_out_buf[TEST_FRAMES][TEST_FRAME_SIZE];
+
+static esp_h264_err_t sim_enc_process(esp_h264_enc_handle_t enc, esp_h264_enc_in_frame_t *in_frame, esp_h264_enc_out_frame_t *out_frame)
+{
+    sim_enc_t *sim = (sim_enc_t *)enc;
+
+    if (sim->gated) {
+        xSemaphoreTake(sim->gate, portMAX_DELAY);
+    }
+    vTaskDelay(pdMS_TO_TICKS(TEST_ENC_MS));
+
+    out_frame->frame_type = (sim->frame_num % TEST_GOP) ? ESP_H264_FRAME_TYPE_P : ESP_H264_FRAME_TYPE_IDR;
+    out_frame->pts = in_frame->pts;
+    out_frame->dts = in_frame->pts;
+    out_frame->length = 8 + in_frame->pts % 16;
+    memcpy(out_frame->raw_data.buffer, &in_frame->pts, sizeof(in_frame->pts));
+    sim->stats.qp = out_frame->length;
+    sim->stats.bits = out_frame->length << 3;
+    sim->stats.mad = sim->frame_num;
+    sim->frame_num++;
+
+    return in_frame->pts == sim->fail_pts ? ESP_H264_ERR_OVERFLOW : ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t sim_enc_get_stats(esp_h264_enc_handle_t enc, esp_h264_enc_frame_stats_t *out_stats)
+{
+    sim_enc_t *sim = (sim_enc_t *)enc;
+    *out_stats = sim->stats;
+    return ESP_H264_ERR_OK;
+}
+
+static void sim_enc_init(sim_enc_t *sim)
+{
+    memset(sim, 0, sizeof(*sim));
+    sim->base.process = sim_enc_process;
+    sim->fail_pts = UINT32_MAX;
+    sim->gate = xSemaphoreCreateCounting(TEST_FRAMES, 0);
+    TEST_ASSERT_NOT_NULL(sim->gate);
+}
+
+static void sim_log_done(const esp_h264_enc_async_result_t *result, void *arg)
+{
+    sim_log_t *log = (sim_log_t *)arg;
+    uint32_t i = log->count;
+
+    log->seq[i] = result->seq;
+    log->pts[i] = result->out_frame.pts;
+    log->ret[i] = result->ret;
+    log->type[i] = result->out_frame.frame_type;
+    log->length[i] = result->out_frame.length;
+    log->qp[i] = result->stats.qp;
+    log->user_ctx[i] = result->user_ctx;
+    log->count = i + 1;
+}
+
+static esp_h264_enc_async_cfg_t test_async_cfg(sim_enc_t *sim, uint8_t depth, sim_log_t *log)
+{
+    esp_h264_enc_async_cfg_t cfg = {
+        .enc = &sim->base,
+        .depth = depth,
+        .done_cb = log ? sim_log_done : NULL,
+        .done_cb_arg = log,
+        .get_stats = sim_enc_get_stats,
+        .task_stack = TEST_TASK_STACK,
+        .task_prio = 5,
+        .task_core = -1,
+    };
+    return cfg;
+}
+
+static esp_h264_err_t test_submit(esp_h264_enc_async_handle_t async, uint32_t i, uint32_t timeout_ms)
+{
+    esp_h264_enc_in_frame_t in_frame = {
+        .raw_data = { .buffer = s_in_buf[i], .len = TEST_FRAME_SIZE },
+        .pts = 1000 + i,
+    };
+    esp_h264_enc_out_frame_t out_frame = {
+        .raw_data = { .buffer = s_out_buf[i], .len = TEST_FRAME_SIZE },
+    };
+    return esp_h264_enc_async_submit(async, &in_frame, &out_frame, &s_in_buf[i], timeout_ms);
+}
+
+TEST_CASE("async encoder rejects invalid arguments", "[enc_async]")
+{
+    sim_enc_t sim;
+    sim_enc_init(&sim);
+    esp_h264_enc_async_handle_t async = NULL;
+    esp_h264_enc_async_cfg_t cfg = test_async_cfg(&sim, 2, NULL);
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_new(NULL, &async));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_new(&cfg, NULL));
+    cfg.depth = 0;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_new(&cfg, &async));
+    cfg.depth = ESP_H264_ENC_ASYNC_DEPTH_MAX + 1;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_new(&cfg, &async));
+    cfg.depth = 2;
+    cfg.enc = NULL;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_new(&cfg, &async));
+    TEST_ASSERT_NULL(async);
+
+    cfg.enc = &sim.base;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_new(&cfg, &async));
+
+    esp_h264_enc_in_frame_t in_frame = { 0 };
+    esp_h264_enc_out_frame_t out_frame = { .raw_data = { .buffer = s_out_buf[0], .len = TEST_FRAME_SIZE } };
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_submit(async, &in_frame, &out_frame, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_submit(NULL, &in_frame, &out_frame, NULL, 0));
+    TEST_ASSERT_EQUAL(0, esp_h264_enc_async_get_in_flight(async));
+
+    esp_h264_enc_async_result_t result;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_TIMEOUT, esp_h264_enc_async_poll(async, &result, 0));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_del(async));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_async_del(NULL));
+    vSemaphoreDelete(sim.gate);
+}
+
+TEST_CASE("async encoder completes frames in submission order through the callback", "[enc_async]")
+{
+    sim_enc_t sim;
+    sim_enc_init(&sim);
+    sim.fail_pts = 1000 + 7;
+    sim_log_t log = { 0 };
+    esp_h264_enc_async_handle_t async = NULL;
+    esp_h264_enc_async_cfg_t cfg = test_async_cfg(&sim, 3, &log);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_new(&cfg, &async));
+
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, i, TEST_WAIT_MS));
+        TEST_ASSERT_LESS_OR_EQUAL(3, esp_h264_enc_async_get_in_flight(async));
+    }
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_flush(async, TEST_WAIT_MS));
+    TEST_ASSERT_EQUAL(0, esp_h264_enc_async_get_in_flight(async));
+
+    esp_h264_enc_async_result_t result;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_UNSUPPORTED, esp_h264_enc_async_poll(async, &result, 0));
+
+    TEST_ASSERT_EQUAL(TEST_FRAMES, log.count);
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        TEST_ASSERT_EQUAL(i, log.seq[i]);
+        TEST_ASSERT_EQUAL(1000 + i, log.pts[i]);
+        TEST_ASSERT_EQUAL_PTR(&s_in_buf[i], log.user_ctx[i]);
+        TEST_ASSERT_EQUAL(i % TEST_GOP ? ESP_H264_FRAME_TYPE_P : ESP_H264_FRAME_TYPE_IDR, log.type[i]);
+        TEST_ASSERT_EQUAL(8 + (1000 + i) % 16, log.length[i]);
+        TEST_ASSERT_EQUAL(log.length[i], log.qp[i]);
+        TEST_ASSERT_EQUAL(i == 7 ? ESP_H264_ERR_OVERFLOW : ESP_H264_ERR_OK, log.ret[i]);
+
+        uint32_t payload;
+        memcpy(&payload, s_out_buf[i], sizeof(payload));
+        TEST_ASSERT_EQUAL(1000 + i, payload);
+    }
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_del(async));
+    vSemaphoreDelete(sim.gate);
+}
+
+TEST_CASE("async encoder returns at once and bounds the frames in flight", "[enc_async]")
+{
+    sim_enc_t sim;
+    sim_enc_init(&sim);
+    sim.gated = true;
+    esp_h264_enc_async_handle_t async = NULL;
+    esp_h264_enc_async_cfg_t cfg = test_async_cfg(&sim, 2, NULL);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_new(&cfg, &async));
+
+    /* The encoder is stuck on the first frame, yet both submissions return without waiting */
+    TickType_t start = xTaskGetTickCount();
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, 0, 0));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, 1, 0));
+    TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(TEST_ENC_MS), xTaskGetTickCount() - start);
+    TEST_ASSERT_EQUAL(2, esp_h264_enc_async_get_in_flight(async));
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_TIMEOUT, test_submit(async, 2, 20));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_TIMEOUT, esp_h264_enc_async_flush(async, 20));
+
+    esp_h264_enc_async_result_t result;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_TIMEOUT, esp_h264_enc_async_poll(async, &result, 0));
+
+    /* Let the first frame through: its slot is only released once polled */
+    xSemaphoreGive(sim.gate);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_poll(async, &result, TEST_WAIT_MS));
+    TEST_ASSERT_EQUAL(0, result.seq);
+    TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_IDR, result.out_frame.frame_type);
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_async_get_in_flight(async));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, 2, 0));
+
+    xSemaphoreGive(sim.gate);
+    xSemaphoreGive(sim.gate);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_flush(async, TEST_WAIT_MS));
+    TEST_ASSERT_EQUAL(2, esp_h264_enc_async_get_in_flight(async));
+
+    for (uint32_t i = 1; i < 3; i++) {
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_poll(async, &result, 0));
+        TEST_ASSERT_EQUAL(i, result.seq);
+        TEST_ASSERT_EQUAL(1000 + i, result.in_frame.pts);
+        TEST_ASSERT_EQUAL_PTR(s_out_buf[i], result.out_frame.raw_data.buffer);
+        TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_P, result.out_frame.frame_type);
+    }
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_TIMEOUT, esp_h264_enc_async_poll(async, &result, 0));
+    TEST_ASSERT_EQUAL(0, esp_h264_enc_async_get_in_flight(async));
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_del(async));
+    vSemaphoreDelete(sim.gate);
+}
+
+TEST_CASE("async encoder overlaps the caller work with encoding", "[enc_async]")
+{
+    sim_enc_t sim;
+    sim_enc_init(&sim);
+    esp_h264_enc_async_handle_t async = NULL;
+    esp_h264_enc_async_cfg_t cfg = test_async_cfg(&sim, 2, NULL);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_new(&cfg, &async));
+
+    /* Capture and packetizing take as long as encoding: run serially, the loop would take twice as long */
+    esp_h264_enc_async_result_t result;
+    uint32_t received = 0;
+    TickType_t start = xTaskGetTickCount();
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        vTaskDelay(pdMS_TO_TICKS(TEST_ENC_MS));
+        /* Packetize what is done, and only wait for the encoder when every slot is taken */
+        while (esp_h264_enc_async_poll(async, &result, 0) == ESP_H264_ERR_OK) {
+            TEST_ASSERT_EQUAL(received++, result.seq);
+        }
+        if (esp_h264_enc_async_get_in_flight(async) == cfg.depth) {
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_poll(async, &result, TEST_WAIT_MS));
+            TEST_ASSERT_EQUAL(received++, result.seq);
+        }
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, i, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_flush(async, TEST_WAIT_MS));
+    while (esp_h264_enc_async_poll(async, &result, 0) == ESP_H264_ERR_OK) {
+        TEST_ASSERT_EQUAL(received++, result.seq);
+    }
+    TickType_t elapsed = xTaskGetTickCount() - start;
+
+    TEST_ASSERT_EQUAL(TEST_FRAMES, received);
+    TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(TEST_FRAMES * TEST_ENC_MS * 2), elapsed);
+    printf("%d frames of %d ms capture + %d ms encode in %d ms\n", TEST_FRAMES, TEST_ENC_MS, TEST_ENC_MS,
+           (int)(elapsed * portTICK_PERIOD_MS));
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_del(async));
+    vSemaphoreDelete(sim.gate);
+}
+
+TEST_CASE("async encoder is deleted right after a flush", "[enc_async]")
+{
+    /* A flush may return before the encoder task wakes it, the token it leaves must not end the delete early */
+    for (uint32_t n = 0; n < 20; n++) {
+        sim_enc_t sim;
+        sim_enc_init(&sim);
+        sim_log_t log = { 0 };
+        esp_h264_enc_async_handle_t async = NULL;
+        esp_h264_enc_async_cfg_t cfg = test_async_cfg(&sim, 1, &log);
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_new(&cfg, &async));
+
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, test_submit(async, 0, TEST_WAIT_MS));
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_flush(async, TEST_WAIT_MS));
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_async_del(async));
+        TEST_ASSERT_EQUAL(1, log.count);
+        vSemaphoreDelete(sim.gate);
+    }
+}
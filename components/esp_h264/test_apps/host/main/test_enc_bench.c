@@ -0,0 +1,191 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+
+#include "esp_h264_enc_single.h"
+#include "esp_h264_enc_single_sw.h"
+#include "esp_h264_dec.h"
+#include "codec_api.h"
+#include "h264_bench.h"
+
+/** The decoder of the host openh264 behind the decoder interface, tinyh264 is built for the targets only */
+typedef struct {
+    esp_h264_dec_t base;
+    ISVCDecoder   *dec;
+    uint8_t       *pic;
+    uint32_t       pic_size;
+} test_bench_dec_t;
+
+static const h264_bench_case_t s_bench_cases[] = {
+    {.width = 320, .height = 240, .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 60},
+    {.width = 320, .height = 240, .fps = 30, .gop = 30, .qp_min = 26, .qp_max = 26, .rc = false, .frames = 60},
+    {.width = 320, .height = 240, .fps = 30, .gop = 1,  .qp_min = 26, .qp_max = 26, .rc = false, .frames = 60},
+    {.width = 640, .height = 480, .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 60},
+    {.width = 640, .height = 480, .fps = 30, .gop = 30, .qp_min = 32, .qp_max = 32, .rc = false, .frames = 60},
+};
+
+static esp_h264_err_t test_bench_dec_process(esp_h264_dec_handle_t dec, esp_h264_dec_in_frame_t *in_frame, esp_h264_dec_out_frame_t *out_frame)
+{
+    test_bench_dec_t *bench_dec = (test_bench_dec_t *)dec;
+    uint8_t *planes[3] = {NULL, NULL, NULL};
+    SBufferInfo info = {0};
+    DECODING_STATE state = (*bench_dec->dec)->DecodeFrameNoDelay(bench_dec->dec, in_frame->raw_data.buffer,
+                                                                 in_frame->raw_data.len, planes, &info);
+    in_frame->consume = in_frame->raw_data.len;
+    out_frame->out_size = 0;
+    if (state != dsErrorFree) {
+        return ESP_H264_ERR_FAIL;
+    }
+    if (info.iBufferStatus != 1) {
+        return ESP_H264_ERR_OK;
+    }
+    /** Pack the planes without their stride */
+    uint32_t width = info.UsrData.sSystemBuffer.iWidth;
+    uint32_t height = info.UsrData.sSystemBuffer.iHeight;
+    uint32_t size = width * height * 3 / 2;
+    if (size > bench_dec->pic_size) {
+        uint8_t *pic = realloc(bench_dec->pic, size);
+        if (!pic) {
+            return ESP_H264_ERR_MEM;
+        }
+        bench_dec->pic = pic;
+        bench_dec->pic_size = size;
+    }
+    uint8_t *dst = bench_dec->pic;
+    for (int p = 0; p < 3; p++) {
+        uint32_t plane_width = p ? width >> 1 : width;
+        uint32_t plane_height = p ? height >> 1 : height;
+        uint32_t stride = info.UsrData.sSystemBuffer.iStride[p ? 1 : 0];
+        for (uint32_t y = 0; y < plane_height; y++) {
+            memcpy(dst, info.pDst[p] + y * stride, plane_width);
+            dst += plane_width;
+        }
+    }
+    out_frame->outbuf = bench_dec->pic;
+    out_frame->out_size = size;
+    out_frame->pts = in_frame->pts;
+    out_frame->dts = in_frame->dts;
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t test_bench_dec_open(esp_h264_dec_handle_t dec)
+{
+    test_bench_dec_t *bench_dec = (test_bench_dec_t *)dec;
+    SDecodingParam param = {0};
+    param.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+    return (*bench_dec->dec)->Initialize(bench_dec->dec, &param) == 0 ? ESP_H264_ERR_OK : ESP_H264_ERR_FAIL;
+}
+
+static esp_h264_err_t test_bench_dec_close(esp_h264_dec_handle_t dec)
+{
+    test_bench_dec_t *bench_dec = (test_bench_dec_t *)dec;
+    (*bench_dec->dec)->Uninitialize(bench_dec->dec);
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t test_bench_dec_del(esp_h264_dec_handle_t dec)
+{
+    test_bench_dec_t *bench_dec = (test_bench_dec_t *)dec;
+    WelsDestroyDecoder(bench_dec->dec);
+    free(bench_dec->pic);
+    free(bench_dec);
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t test_bench_dec_new(esp_h264_dec_handle_t *out_dec)
+{
+    test_bench_dec_t *bench_dec = calloc(1, sizeof(test_bench_dec_t));
+    if (!bench_dec) {
+        return ESP_H264_ERR_MEM;
+    }
+    if (WelsCreateDecoder(&bench_dec->dec) != 0) {
+        free(bench_dec);
+        return ESP_H264_ERR_FAIL;
+    }
+    bench_dec->base.open = test_bench_dec_open;
+    bench_dec->base.process = test_bench_dec_process;
+    bench_dec->base.close = test_bench_dec_close;
+    bench_dec->base.del = test_bench_dec_del;
+    esp_h264_err_t ret = esp_h264_dec_open(&bench_dec->base);
+    if (ret != ESP_H264_ERR_OK) {
+        test_bench_dec_del(&bench_dec->base);
+        return ret;
+    }
+    *out_dec = &bench_dec->base;
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t test_bench_enc_new(const h264_bench_case_t *bench_case, esp_h264_enc_handle_t *out_enc)
+{
+    if (bench_case->roi) {
+        return ESP_H264_ERR_UNSUPPORTED;
+    }
+    esp_h264_enc_cfg_sw_t cfg = {
+        .pic_type = ESP_H264_RAW_FMT_I420,
+        .gop = bench_case->gop,
+        .fps = bench_case->fps,
+        .res = {.width = bench_case->width, .height = bench_case->height},
+        .rc = {
+            .bitrate = bench_case->width * bench_case->height * bench_case->fps / 20,
+            .qp_min = bench_case->qp_min,
+            .qp_max = bench_case->rc ? bench_case->qp_max : bench_case->qp_min,
+        },
+    };
+    esp_h264_err_t ret = esp_h264_enc_sw_new(&cfg, out_enc);
+    if (ret != ESP_H264_ERR_OK) {
+        return ret;
+    }
+    ret = esp_h264_enc_open(*out_enc);
+    if (ret != ESP_H264_ERR_OK) {
+        esp_h264_enc_del(*out_enc);
+    }
+    return ret;
+}
+
+TEST_CASE("Benchmark checks its arguments", "[sw][bench]")
+{
+    h264_bench_case_t bench_case = s_bench_cases[0];
+    h264_bench_result_t result;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, h264_bench_run(NULL, ESP_H264_RAW_FMT_I420, test_bench_enc_new, NULL, &result));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, h264_bench_run(&bench_case, ESP_H264_RAW_FMT_I420, NULL, NULL, &result));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, h264_bench_run(&bench_case, ESP_H264_RAW_FMT_YUYV, test_bench_enc_new, NULL, &result));
+    bench_case.frames = 0;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, h264_bench_run(&bench_case, ESP_H264_RAW_FMT_I420, test_bench_enc_new, NULL, &result));
+    /** The software encoder has no ROI */
+    bench_case = s_bench_cases[0];
+    bench_case.roi = true;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_UNSUPPORTED, h264_bench_run(&bench_case, ESP_H264_RAW_FMT_I420, test_bench_enc_new, NULL, &result));
+
+    esp_h264_enc_roi_reg_t roi;
+    h264_bench_get_roi(&bench_case, -6, &roi);
+    TEST_ASSERT_EQUAL(5, roi.x);
+    TEST_ASSERT_EQUAL(4, roi.y);
+    TEST_ASSERT_EQUAL(10, roi.len_x);
+    TEST_ASSERT_EQUAL(7, roi.len_y);
+    TEST_ASSERT_EQUAL(-6, roi.qp);
+}
+
+TEST_CASE("SW encoder benchmark reports speed, size and quality", "[sw][bench]")
+{
+    h264_bench_result_t result;
+    h264_bench_print_header();
+    for (size_t i = 0; i < sizeof(s_bench_cases) / sizeof(s_bench_cases[0]); i++) {
+        const h264_bench_case_t *bench_case = &s_bench_cases[i];
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, h264_bench_run(bench_case, ESP_H264_RAW_FMT_I420,
+                                                          test_bench_enc_new, test_bench_dec_new, &result));
+        h264_bench_print(bench_case, &result);
+        TEST_ASSERT_EQUAL(bench_case->frames, result.frames);
+        TEST_ASSERT_EQUAL(bench_case->frames, result.decoded);
+        TEST_ASSERT_TRUE(result.bits_per_frame > 0);
+        TEST_ASSERT_TRUE(result.psnr_y > 0 && result.ssim <= 1.0);
+        TEST_ASSERT_TRUE(result.lat_p50 <= result.lat_p90 && result.lat_p90 <= result.lat_p99);
+        TEST_ASSERT_TRUE(result.lat_p99 <= result.lat_max);
+    }
+}
@@ -0,0 +1,98 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include "unity.h"
+
+#include "esp_h264_enc_single.h"
+
+#define TEST_CACHE_FRAME_LEN (1920 * 1088 * 3 / 2)
+
+static uint8_t s_frame[64];
+
+static esp_h264_enc_in_frame_t test_cache_frame(esp_h264_cache_state_t state)
+{
+    esp_h264_enc_in_frame_t in_frame = {
+        .raw_data = {.buffer = s_frame, .len = TEST_CACHE_FRAME_LEN},
+        .cache_state = state,
+    };
+    return in_frame;
+}
+
+TEST_CASE("Cache state of a CPU or DMA written frame", "[cache]")
+{
+    uint32_t offset = 1;
+    uint32_t len = 1;
+    /** The default is the whole frame */
+    esp_h264_enc_in_frame_t in_frame = {
+        .raw_data = {.buffer = s_frame, .len = TEST_CACHE_FRAME_LEN},
+    };
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(0, offset);
+    TEST_ASSERT_EQUAL(TEST_CACHE_FRAME_LEN, len);
+
+    /** A frame from a DMA needs nothing */
+    in_frame = test_cache_frame(ESP_H264_CACHE_DMA_CLEAN);
+    TEST_ASSERT_FALSE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(0, len);
+
+    /** Unknown states fall back to the whole frame */
+    in_frame = test_cache_frame(ESP_H264_CACHE_INVALID);
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(TEST_CACHE_FRAME_LEN, len);
+
+    /** So do ranges out of the frame */
+    in_frame = test_cache_frame(ESP_H264_CACHE_CPU_DIRTY_RANGE);
+    in_frame.dirty_offset = TEST_CACHE_FRAME_LEN - 10;
+    in_frame.dirty_len = 11;
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(0, offset);
+    TEST_ASSERT_EQUAL(TEST_CACHE_FRAME_LEN, len);
+
+    in_frame.dirty_len = 10;
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(TEST_CACHE_FRAME_LEN - 10, offset);
+    TEST_ASSERT_EQUAL(10, len);
+
+    in_frame.dirty_len = 0;
+    TEST_ASSERT_FALSE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+}
+
+TEST_CASE("Cache state follows the CPU writes on a frame", "[cache]")
+{
+    uint32_t offset = 0;
+    uint32_t len = 0;
+    /** An overlay drawn on a captured frame */
+    esp_h264_enc_in_frame_t in_frame = test_cache_frame(ESP_H264_CACHE_DMA_CLEAN);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_in_frame_mark_dirty(&in_frame, 1920 * 100, 1920 * 16));
+    TEST_ASSERT_EQUAL(ESP_H264_CACHE_CPU_DIRTY_RANGE, in_frame.cache_state);
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(1920 * 100, offset);
+    TEST_ASSERT_EQUAL(1920 * 16, len);
+
+    /** A second one merges, before and after */
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_in_frame_mark_dirty(&in_frame, 1920 * 50, 1920 * 8));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_in_frame_mark_dirty(&in_frame, 1920 * 200, 1920 * 8));
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(1920 * 50, offset);
+    TEST_ASSERT_EQUAL(1920 * 158, len);
+
+    /** An empty range changes nothing, one out of the frame is refused */
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_in_frame_mark_dirty(&in_frame, 0, 0));
+    TEST_ASSERT_EQUAL(1920 * 50, in_frame.dirty_offset);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_in_frame_mark_dirty(&in_frame, TEST_CACHE_FRAME_LEN, 1));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_in_frame_mark_dirty(&in_frame, TEST_CACHE_FRAME_LEN - 1, 2));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_in_frame_mark_dirty(NULL, 0, 1));
+    TEST_ASSERT_EQUAL(1920 * 158, in_frame.dirty_len);
+
+    /** A frame written by the CPU stays whole */
+    in_frame = test_cache_frame(ESP_H264_CACHE_CPU_DIRTY);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_in_frame_mark_dirty(&in_frame, 16, 16));
+    TEST_ASSERT_EQUAL(ESP_H264_CACHE_CPU_DIRTY, in_frame.cache_state);
+    TEST_ASSERT_TRUE(esp_h264_enc_in_frame_get_dirty_range(&in_frame, &offset, &len));
+    TEST_ASSERT_EQUAL(0, offset);
+    TEST_ASSERT_EQUAL(TEST_CACHE_FRAME_LEN, len);
+}
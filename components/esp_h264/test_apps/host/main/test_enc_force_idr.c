@@ -0,0 +1,116 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+
+#include "esp_h264_enc_single.h"
+#include "esp_h264_enc_single_sw.h"
+
+#define TEST_WIDTH       64
+#define TEST_HEIGHT      64
+#define TEST_GOP         10
+#define TEST_FRAMES      30
+#define TEST_FORCE_FRAME 13
+#define TEST_OUT_SIZE    (TEST_WIDTH * TEST_HEIGHT * 2)
+
+static uint8_t s_in_buf[TEST_WIDTH * TEST_HEIGHT * 3 / 2];
+static uint8_t s_out_buf[TEST_OUT_SIZE];
+
+/** Slowly moving gradient, nothing looks like a scene change */
+static void test_fill_frame(uint32_t index)
+{
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            s_in_buf[y * TEST_WIDTH + x] = (uint8_t)(x * 2 + y + index);
+        }
+    }
+    memset(s_in_buf + TEST_WIDTH * TEST_HEIGHT, 128, TEST_WIDTH * TEST_HEIGHT / 2);
+}
+
+static esp_h264_enc_handle_t test_sw_enc_open(void)
+{
+    esp_h264_enc_cfg_sw_t cfg = {
+        .pic_type = ESP_H264_RAW_FMT_I420,
+        .gop = TEST_GOP,
+        .fps = 30,
+        .res = {.width = TEST_WIDTH, .height = TEST_HEIGHT},
+        .rc = {.bitrate = TEST_WIDTH * TEST_HEIGHT * 30 / 20, .qp_min = 20, .qp_max = 40},
+    };
+    esp_h264_enc_handle_t enc = NULL;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_sw_new(&cfg, &enc));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_open(enc));
+    return enc;
+}
+
+static esp_h264_frame_type_t test_encode(esp_h264_enc_handle_t enc, uint32_t index)
+{
+    test_fill_frame(index);
+    esp_h264_enc_in_frame_t in_frame = {
+        .raw_data = {.buffer = s_in_buf, .len = sizeof(s_in_buf)},
+        .pts = index * 33,
+    };
+    esp_h264_enc_out_frame_t out_frame = {
+        .raw_data = {.buffer = s_out_buf, .len = sizeof(s_out_buf)},
+    };
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_process(enc, &in_frame, &out_frame));
+    TEST_ASSERT_GREATER_THAN(0, out_frame.length);
+    return out_frame.frame_type;
+}
+
+static void test_sw_enc_close(esp_h264_enc_handle_t enc)
+{
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_close(enc));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_del(enc));
+}
+
+TEST_CASE("SW encoder reports IDR frames at GOP boundaries", "[force_idr]")
+{
+    esp_h264_enc_handle_t enc = test_sw_enc_open();
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        esp_h264_frame_type_t type = test_encode(enc, i);
+        TEST_ASSERT_EQUAL((i % TEST_GOP) ? ESP_H264_FRAME_TYPE_P : ESP_H264_FRAME_TYPE_IDR, type);
+    }
+    test_sw_enc_close(enc);
+}
+
+TEST_CASE("SW encoder emits an IDR frame on request and restarts the GOP", "[force_idr]")
+{
+    esp_h264_enc_handle_t enc = test_sw_enc_open();
+    uint32_t last_idr = 0;
+    uint32_t idr_count = 0;
+
+    for (uint32_t i = 0; i < TEST_FRAMES; i++) {
+        if (i == TEST_FORCE_FRAME) {
+            /** Several viewers joining before the next frame still cost a single IDR-frame */
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_force_idr(enc));
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_force_idr(enc));
+        }
+        esp_h264_frame_type_t type = test_encode(enc, i);
+        if (i == TEST_FORCE_FRAME) {
+            TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_IDR, type);
+        } else if (i == TEST_FORCE_FRAME + 1) {
+            TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_P, type);
+        }
+        if (type == ESP_H264_FRAME_TYPE_IDR) {
+            TEST_ASSERT_LESS_OR_EQUAL(TEST_GOP, i - last_idr);
+            last_idr = i;
+            idr_count++;
+        } else {
+            TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_P, type);
+            TEST_ASSERT_LESS_THAN(TEST_GOP, i - last_idr);
+        }
+    }
+    /** Frames 0 and 10 from the GOP, 13 on request, then the GOP counts again from 13 */
+    TEST_ASSERT_EQUAL(4, idr_count);
+    test_sw_enc_close(enc);
+}
+
+TEST_CASE("Force IDR rejects invalid handles", "[force_idr]")
+{
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_force_idr(NULL));
+}
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <math.h>
+#include <string.h>
+#include "unity.h"
+
+#include "h264_metrics.h"
+
+#define TEST_WIDTH      64
+#define TEST_HEIGHT     48
+#define TEST_DEC_HEIGHT 64
+#define TEST_Y_SIZE     (TEST_WIDTH * TEST_HEIGHT)
+
+static uint8_t s_src[TEST_Y_SIZE * 3 / 2];
+static uint8_t s_dec[TEST_WIDTH * TEST_DEC_HEIGHT * 3 / 2];
+
+static void test_metrics_fill(uint8_t *buf, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)(64 + (i % 61) + ((i / TEST_WIDTH) & 0x1f));
+    }
+}
+
+TEST_CASE("PSNR and SSIM of identical and altered pictures", "[metrics]")
+{
+    test_metrics_fill(s_src, TEST_Y_SIZE);
+    memcpy(s_dec, s_src, TEST_Y_SIZE);
+    TEST_ASSERT_EQUAL(0, h264_metrics_sse(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH));
+    TEST_ASSERT_EQUAL_DOUBLE(H264_METRICS_PSNR_MAX, h264_metrics_psnr(0, TEST_Y_SIZE));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, h264_metrics_ssim(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH));
+
+    /** An error of 2 on every sample is 10 * log10(255^2 / 4) */
+    for (uint32_t i = 0; i < TEST_Y_SIZE; i++) {
+        s_dec[i] = s_src[i] + 2;
+    }
+    uint64_t sse = h264_metrics_sse(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH);
+    TEST_ASSERT_EQUAL(4 * TEST_Y_SIZE, sse);
+    TEST_ASSERT_DOUBLE_WITHIN(0.01, 42.11, h264_metrics_psnr(sse, TEST_Y_SIZE));
+    double ssim_offset = h264_metrics_ssim(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH);
+    TEST_ASSERT_TRUE(ssim_offset < 1.0 && ssim_offset > 0.99);
+
+    /** Noise of the same energy hurts the structure more than a brightness shift */
+    for (uint32_t i = 0; i < TEST_Y_SIZE; i++) {
+        s_dec[i] = s_src[i] + (((i + i / TEST_WIDTH) & 1) ? 2 : -2);
+    }
+    TEST_ASSERT_EQUAL(sse, h264_metrics_sse(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH));
+    double ssim_noise = h264_metrics_ssim(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH);
+    TEST_ASSERT_TRUE(ssim_noise < ssim_offset);
+    TEST_ASSERT_TRUE(ssim_noise > 0);
+
+    /** Only the area is compared, the rest of the lines is skipped */
+    memcpy(s_dec, s_src, TEST_Y_SIZE);
+    s_dec[TEST_WIDTH - 1] = s_src[TEST_WIDTH - 1] + 10;
+    TEST_ASSERT_EQUAL(0, h264_metrics_sse(s_src, s_dec, TEST_WIDTH - 1, TEST_HEIGHT, TEST_WIDTH));
+    TEST_ASSERT_EQUAL(100, h264_metrics_sse(s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_WIDTH));
+}
+
+TEST_CASE("Metrics of I420 frames skip the padding lines", "[metrics]")
+{
+    h264_metrics_t metrics;
+    h264_metrics_reset(&metrics);
+    TEST_ASSERT_EQUAL_DOUBLE(0, h264_metrics_get_ssim(&metrics));
+
+    /** The decoded frame has 64 lines, the 16 below the picture are garbage */
+    uint32_t dec_y_size = TEST_WIDTH * TEST_DEC_HEIGHT;
+    test_metrics_fill(s_src, sizeof(s_src));
+    memset(s_dec, 0xff, sizeof(s_dec));
+    memcpy(s_dec, s_src, TEST_Y_SIZE);
+    memcpy(s_dec + dec_y_size, s_src + TEST_Y_SIZE, TEST_Y_SIZE / 4);
+    memcpy(s_dec + dec_y_size + dec_y_size / 4, s_src + TEST_Y_SIZE + TEST_Y_SIZE / 4, TEST_Y_SIZE / 4);
+    h264_metrics_add_i420(&metrics, s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_DEC_HEIGHT);
+    TEST_ASSERT_EQUAL(1, metrics.frames);
+    TEST_ASSERT_EQUAL(TEST_Y_SIZE, metrics.samples[0]);
+    TEST_ASSERT_EQUAL(TEST_Y_SIZE / 4, metrics.samples[1]);
+    TEST_ASSERT_EQUAL_DOUBLE(H264_METRICS_PSNR_MAX, h264_metrics_get_psnr(&metrics));
+
+    /** An error in one chroma plane counts in the PSNR of all planes, not the luma one */
+    s_dec[dec_y_size + dec_y_size / 4] += 30;
+    h264_metrics_add_i420(&metrics, s_src, s_dec, TEST_WIDTH, TEST_HEIGHT, TEST_DEC_HEIGHT);
+    TEST_ASSERT_EQUAL(2, metrics.frames);
+    TEST_ASSERT_EQUAL(900, metrics.sse[2]);
+    TEST_ASSERT_EQUAL_DOUBLE(H264_METRICS_PSNR_MAX, h264_metrics_get_psnr_y(&metrics));
+    double psnr = 10 * log10(255.0 * 255.0 * (TEST_Y_SIZE * 3) / 900);
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, psnr, h264_metrics_get_psnr(&metrics));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, h264_metrics_get_ssim(&metrics));
+}
+
+TEST_CASE("Latency percentiles use the nearest rank", "[metrics]")
+{
+    uint32_t samples[100];
+    TEST_ASSERT_EQUAL(0, h264_metrics_percentile(samples, 0, 50));
+
+    uint32_t few[] = {500, 100, 400, 200, 300};
+    TEST_ASSERT_EQUAL(100, h264_metrics_percentile(few, 5, 0));
+    TEST_ASSERT_EQUAL(300, h264_metrics_percentile(few, 5, 50));
+    TEST_ASSERT_EQUAL(500, h264_metrics_percentile(few, 5, 90));
+    TEST_ASSERT_EQUAL(500, h264_metrics_percentile(few, 5, 100));
+
+    for (uint32_t i = 0; i < 100; i++) {
+        samples[i] = 100 - i;
+    }
+    TEST_ASSERT_EQUAL(50, h264_metrics_percentile(samples, 100, 50));
+    TEST_ASSERT_EQUAL(90, h264_metrics_percentile(samples, 100, 90));
+    TEST_ASSERT_EQUAL(99, h264_metrics_percentile(samples, 100, 99));
+    TEST_ASSERT_EQUAL(100, h264_metrics_percentile(samples, 100, 100));
+}
@@ -0,0 +1,328 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "unity.h"
+
+#include "h264_rc.h"
+
+/**
+ * Rate control simulator
+ *
+ * A trace holds the statistics of encoded frames, as `esp_h264_enc_hw_get_frame_stats` gives them
+ * on the target. It is replayed through the RC: the bits of a frame are scaled from the recorded QP
+ * to the QP the RC chooses, 6 QP halves them.
+ *
+ * A recorded trace is replayed in every mode with `ESP_H264_RC_TRACE=<file>`, one frame per line:
+ *     <I|P>,<bits>,<MAD sum>,<QP>
+ * The size and the bitrate of the trace are taken from `ESP_H264_RC_TRACE_CFG=<width>x<height>@<fps>,<bitrate>`.
+ */
+
+#define TEST_RC_WIDTH   640
+#define TEST_RC_HEIGHT  480
+#define TEST_RC_FPS     30
+#define TEST_RC_GOP     30
+#define TEST_RC_BITRATE 1000000
+#define TEST_RC_FRAMES  300
+#define TEST_RC_QP_MIN  20
+#define TEST_RC_QP_MAX  45
+#define TEST_RC_CUT     200  /*<! Scene cut of the synthetic trace */
+
+typedef struct {
+    bool                       idr;
+    esp_h264_enc_frame_stats_t stats;
+} test_rc_frame_t;
+
+typedef struct {
+    test_rc_frame_t *frames;
+    uint32_t         count;
+    uint16_t         width;
+    uint16_t         height;
+    uint8_t          fps;
+    uint32_t         bitrate;
+} test_rc_trace_t;
+
+typedef struct {
+    double   mean_bitrate;  /*<! Bit per second over the trace */
+    double   std_bitrate;   /*<! Standard deviation of the bitrate of each second */
+    uint32_t max_bitrate;   /*<! Bitrate of the largest second */
+    uint32_t max_idr_bits;
+    double   mean_qp;
+    uint8_t  min_qp;
+    uint8_t  max_qp;
+    esp_h264_rc_stats_t stats;
+} test_rc_report_t;
+
+static const char *s_mode_name[] = {"average", "cbr", "vbr", "cqp"};
+
+/** 2^(-d/6) without libm */
+static double test_rc_qp_scale(int d)
+{
+    double scale = 1.0;
+    for (; d > 0; d--) {
+        scale *= 0.890899;
+    }
+    for (; d < 0; d++) {
+        scale /= 0.890899;
+    }
+    return scale;
+}
+
+/**
+ * Camera like trace at QP 30: a still scene, a pan, then a scene cut to a busy picture.
+ * The bits of P-frames follow the MAD, with some noise.
+ */
+static void test_rc_synthetic_trace(test_rc_trace_t *trace)
+{
+    trace->width = TEST_RC_WIDTH;
+    trace->height = TEST_RC_HEIGHT;
+    trace->fps = TEST_RC_FPS;
+    trace->bitrate = TEST_RC_BITRATE;
+    trace->count = TEST_RC_FRAMES;
+    trace->frames = (test_rc_frame_t *)calloc(trace->count, sizeof(test_rc_frame_t));
+    TEST_ASSERT_NOT_NULL(trace->frames);
+    uint32_t mb_cnt = (TEST_RC_WIDTH / 16) * (TEST_RC_HEIGHT / 16);
+    uint32_t seed = 1;
+    for (uint32_t i = 0; i < trace->count; i++) {
+        seed = seed * 1103515245 + 12345;
+        double noise = 0.85 + ((seed >> 16) & 0xff) / 255.0 * 0.3;
+        double mad;
+        uint32_t idr_bits;
+        if (i < 100) {
+            mad = 2.0;
+            idr_bits = 150000;
+        } else if (i < TEST_RC_CUT) {
+            mad = 6.0 + (i & 7) * 0.25;
+            idr_bits = 200000;
+        } else {
+            mad = 16.0 + (i & 3) * 0.5;
+            idr_bits = 350000;
+        }
+        test_rc_frame_t *frame = &trace->frames[i];
+        frame->idr = (i % TEST_RC_GOP) == 0;
+        frame->stats.qp = 30;
+        frame->stats.mad = (uint32_t)(mad * mb_cnt);
+        frame->stats.bits = (uint32_t)((frame->idr ? idr_bits : mad * 8000) * noise);
+    }
+}
+
+static bool test_rc_load_trace(test_rc_trace_t *trace)
+{
+    const char *path = getenv("ESP_H264_RC_TRACE");
+    if (path == NULL) {
+        return false;
+    }
+    FILE *fp = fopen(path, "r");
+    TEST_ASSERT_NOT_NULL_MESSAGE(fp, "Can not open the RC trace");
+    unsigned width = TEST_RC_WIDTH, height = TEST_RC_HEIGHT, fps = TEST_RC_FPS, bitrate = TEST_RC_BITRATE;
+    const char *cfg = getenv("ESP_H264_RC_TRACE_CFG");
+    if (cfg) {
+        TEST_ASSERT_EQUAL(4, sscanf(cfg, "%ux%u@%u,%u", &width, &height, &fps, &bitrate));
+    }
+    trace->width = width;
+    trace->height = height;
+    trace->fps = fps;
+    trace->bitrate = bitrate;
+    trace->count = 0;
+    uint32_t capacity = 256;
+    trace->frames = (test_rc_frame_t *)malloc(capacity * sizeof(test_rc_frame_t));
+    TEST_ASSERT_NOT_NULL(trace->frames);
+    char type;
+    unsigned bits, mad, qp;
+    while (fscanf(fp, " %c,%u,%u,%u", &type, &bits, &mad, &qp) == 4) {
+        if (trace->count == capacity) {
+            capacity *= 2;
+            trace->frames = (test_rc_frame_t *)realloc(trace->frames, capacity * sizeof(test_rc_frame_t));
+            TEST_ASSERT_NOT_NULL(trace->frames);
+        }
+        test_rc_frame_t *frame = &trace->frames[trace->count++];
+        frame->idr = type == 'I' || type == 'i';
+        frame->stats.bits = bits;
+        frame->stats.mad = mad;
+        frame->stats.qp = qp;
+    }
+    fclose(fp);
+    TEST_ASSERT_GREATER_THAN_MESSAGE(0, trace->count, "The RC trace is empty");
+    return true;
+}
+
+static void test_rc_replay(const test_rc_trace_t *trace, const esp_h264_enc_rc_cfg_t *cfg, test_rc_report_t *report)
+{
+    uint8_t mb_width = trace->width / 16;
+    uint8_t mb_height = trace->height / 16;
+    uint32_t mb_cnt = mb_width * mb_height;
+    esp_h264_rc_hd_t rc = esp_h264_enc_hw_rc_new(TEST_RC_QP_MAX, TEST_RC_QP_MIN, trace->bitrate, trace->fps, mb_width, mb_height);
+    TEST_ASSERT_NOT_NULL(rc);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_hw_rc_cfg(rc, cfg));
+
+    memset(report, 0, sizeof(test_rc_report_t));
+    report->min_qp = 51;
+    uint32_t seconds = trace->count / trace->fps;
+    uint64_t *second_bits = (uint64_t *)calloc(seconds + 1, sizeof(uint64_t));
+    TEST_ASSERT_NOT_NULL(second_bits);
+    uint64_t total_bits = 0;
+    for (uint32_t i = 0; i < trace->count; i++) {
+        const test_rc_frame_t *frame = &trace->frames[i];
+        uint32_t rate = 0, pred_mad = 0;
+        uint8_t qp = 0;
+        esp_h264_rc_start(rc, frame->idr, &rate, &pred_mad, &qp);
+        TEST_ASSERT_TRUE(qp >= TEST_RC_QP_MIN && qp <= TEST_RC_QP_MAX);
+        uint32_t bits = (uint32_t)(frame->stats.bits * test_rc_qp_scale(qp - frame->stats.qp));
+        esp_h264_rc_end(rc, bits, qp * mb_cnt, frame->stats.mad);
+
+        total_bits += bits;
+        second_bits[i / trace->fps] += bits;
+        report->mean_qp += qp;
+        report->min_qp = qp < report->min_qp ? qp : report->min_qp;
+        report->max_qp = qp > report->max_qp ? qp : report->max_qp;
+        if (frame->idr && bits > report->max_idr_bits) {
+            report->max_idr_bits = bits;
+        }
+    }
+    report->mean_bitrate = (double)total_bits * trace->fps / trace->count;
+    report->mean_qp /= trace->count;
+    /** Whole seconds only */
+    double sum = 0, sum2 = 0;
+    for (uint32_t s = 0; s < seconds; s++) {
+        sum += second_bits[s];
+        sum2 += (double)second_bits[s] * second_bits[s];
+        if (second_bits[s] > report->max_bitrate) {
+            report->max_bitrate = (uint32_t)second_bits[s];
+        }
+    }
+    if (seconds) {
+        double mean = sum / seconds;
+        double var = sum2 / seconds - mean * mean;
+        /** Square root by Newton iterations, no libm */
+        double std = var > 0 ? var : 0;
+        for (int k = 0; k < 32 && std > 0; k++) {
+            std = (std + var / std) / 2;
+        }
+        report->std_bitrate = std;
+    }
+    esp_h264_enc_hw_rc_get_stats(rc, &report->stats);
+    free(second_bits);
+    esp_h264_enc_hw_rc_del(rc);
+}
+
+static void test_rc_print(const char *name, const test_rc_report_t *report)
+{
+    printf("%-8s %10.1f %10.1f %10.1f %10.1f %6.1f %3d-%-3d %9u %6u\n", name, report->mean_bitrate / 1000,
+           report->std_bitrate / 1000, report->max_bitrate / 1000.0, report->max_idr_bits / 1000.0, report->mean_qp,
+           report->min_qp, report->max_qp, (unsigned)report->stats.vbv_overflows, (unsigned)report->stats.scene_changes);
+}
+
+static void test_rc_print_header(const test_rc_trace_t *trace)
+{
+    printf("%dx%d@%d, %u frames, target %u kbit/s\n", trace->width, trace->height, trace->fps,
+           (unsigned)trace->count, (unsigned)(trace->bitrate / 1000));
+    printf("%-8s %10s %10s %10s %10s %6s %7s %9s %6s\n", "mode", "kbit/s", "std", "max 1s", "max IDR",
+           "QP", "range", "overflow", "scene");
+}
+
+TEST_CASE("RC configuration checks its arguments", "[rc]")
+{
+    esp_h264_rc_hd_t rc = esp_h264_enc_hw_rc_new(TEST_RC_QP_MAX, TEST_RC_QP_MIN, TEST_RC_BITRATE, TEST_RC_FPS, 40, 30);
+    TEST_ASSERT_NOT_NULL(rc);
+    esp_h264_enc_rc_cfg_t cfg = {.mode = ESP_H264_RC_MODE_CQP, .cqp = TEST_RC_QP_MIN - 1};
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+    cfg.cqp = TEST_RC_QP_MAX + 1;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+    cfg = (esp_h264_enc_rc_cfg_t) {
+        .mode = ESP_H264_RC_MODE_VBR, .max_bitrate = TEST_RC_BITRATE / 2
+    };
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+
+    /** The defaults are reported */
+    cfg = (esp_h264_enc_rc_cfg_t) {
+        .mode = ESP_H264_RC_MODE_CBR
+    };
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+    esp_h264_enc_rc_cfg_t info;
+    esp_h264_enc_hw_rc_get_cfg(rc, &info);
+    TEST_ASSERT_EQUAL(ESP_H264_RC_MODE_CBR, info.mode);
+    TEST_ASSERT_EQUAL(TEST_RC_BITRATE, info.vbv_size);
+    TEST_ASSERT_EQUAL(TEST_RC_BITRATE * 3 / 2, info.max_bitrate);
+    TEST_ASSERT_GREATER_THAN(0, info.idr_budget);
+    TEST_ASSERT_GREATER_THAN(0, info.scene_change);
+    esp_h264_enc_hw_rc_del(rc);
+}
+
+TEST_CASE("CQP does not drive the MB level RC", "[rc]")
+{
+    esp_h264_rc_hd_t rc = esp_h264_enc_hw_rc_new(TEST_RC_QP_MAX, TEST_RC_QP_MIN, TEST_RC_BITRATE, TEST_RC_FPS, 40, 30);
+    TEST_ASSERT_NOT_NULL(rc);
+    esp_h264_enc_rc_cfg_t cfg = {.mode = ESP_H264_RC_MODE_CQP, .cqp = 30};
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+    TEST_ASSERT_FALSE(esp_h264_rc_mb_ena(rc));
+    for (int i = 0; i < 4; i++) {
+        uint32_t rate = 0, pred_mad = 0;
+        uint8_t qp = 0;
+        esp_h264_rc_start(rc, i == 0, &rate, &pred_mad, &qp);
+        TEST_ASSERT_EQUAL(30, qp);
+        TEST_ASSERT_EQUAL(0, rate);
+        TEST_ASSERT_EQUAL(0, pred_mad);
+        esp_h264_rc_end(rc, TEST_RC_BITRATE / TEST_RC_FPS, qp * 40 * 30, 8 * 40 * 30);
+    }
+
+    /** The other modes program the rate of P-frames */
+    cfg = (esp_h264_enc_rc_cfg_t) {
+        .mode = ESP_H264_RC_MODE_CBR
+    };
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_hw_rc_cfg(rc, &cfg));
+    TEST_ASSERT_TRUE(esp_h264_rc_mb_ena(rc));
+    uint32_t rate = 0, pred_mad = 0;
+    uint8_t qp = 0;
+    esp_h264_rc_start(rc, false, &rate, &pred_mad, &qp);
+    TEST_ASSERT_NOT_EQUAL(0, rate);
+    TEST_ASSERT_NOT_EQUAL(0, pred_mad);
+    esp_h264_enc_hw_rc_del(rc);
+}
+
+TEST_CASE("RC simulator replays the trace in every mode", "[rc][sim]")
+{
+    test_rc_trace_t trace;
+    bool recorded = test_rc_load_trace(&trace);
+    if (!recorded) {
+        test_rc_synthetic_trace(&trace);
+    }
+    test_rc_print_header(&trace);
+    const uint32_t vbv_size = trace.bitrate / 2;
+    const esp_h264_enc_rc_cfg_t cfgs[] = {
+        {.mode = ESP_H264_RC_MODE_AVERAGE},
+        {.mode = ESP_H264_RC_MODE_CBR, .vbv_size = vbv_size},
+        {.mode = ESP_H264_RC_MODE_VBR, .max_bitrate = trace.bitrate * 3 / 2, .vbv_size = vbv_size},
+        {.mode = ESP_H264_RC_MODE_CQP, .cqp = 30},
+    };
+    test_rc_report_t reports[ESP_H264_RC_MODE_INVALID];
+    for (int m = 0; m < ESP_H264_RC_MODE_INVALID; m++) {
+        test_rc_replay(&trace, &cfgs[m], &reports[m]);
+        test_rc_print(s_mode_name[m], &reports[m]);
+    }
+    if (!recorded) {
+        const test_rc_report_t *cbr = &reports[ESP_H264_RC_MODE_CBR];
+        const test_rc_report_t *vbr = &reports[ESP_H264_RC_MODE_VBR];
+        const test_rc_report_t *cqp = &reports[ESP_H264_RC_MODE_CQP];
+        /** CBR holds the bitrate of each second and never overflows its VBV */
+        TEST_ASSERT_TRUE(cbr->mean_bitrate > trace.bitrate * 0.9 && cbr->mean_bitrate < trace.bitrate * 1.1);
+        TEST_ASSERT_EQUAL(0, cbr->stats.vbv_overflows);
+        TEST_ASSERT_TRUE(cbr->std_bitrate < trace.bitrate * 0.1);
+        TEST_ASSERT_TRUE(cbr->std_bitrate < reports[ESP_H264_RC_MODE_AVERAGE].std_bitrate);
+        TEST_ASSERT_TRUE(cbr->max_idr_bits <= vbv_size);
+        /** VBR follows the average and stays under its peak */
+        TEST_ASSERT_TRUE(vbr->mean_bitrate > trace.bitrate * 0.8 && vbr->mean_bitrate < trace.bitrate * 1.2);
+        TEST_ASSERT_EQUAL(0, vbr->stats.vbv_overflows);
+        TEST_ASSERT_TRUE(vbr->max_bitrate <= trace.bitrate * 3 / 2 + vbv_size);
+        /** CQP does not move */
+        TEST_ASSERT_EQUAL(30, cqp->min_qp);
+        TEST_ASSERT_EQUAL(30, cqp->max_qp);
+        /** The pan and the cut are scene changes */
+        TEST_ASSERT_EQUAL(2, cbr->stats.scene_changes);
+    }
+    free(trace.frames);
+}
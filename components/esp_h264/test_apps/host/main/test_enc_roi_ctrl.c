@@ -0,0 +1,230 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+
+#include "esp_h264_enc_roi_ctrl.h"
+
+/**
+ * Simulated hardware parameter handle: records the ROI configuration and regions it is given
+ */
+typedef struct {
+    esp_h264_enc_param_hw_t base;  /* First member, the handle is the simulated parameter set */
+    esp_h264_enc_roi_cfg_t  roi_cfg;
+    esp_h264_enc_roi_reg_t  reg[ESP_H264_ENC_ROI_REGION_MAX];
+    uint32_t                cfg_calls;
+    uint32_t                reg_calls;
+} sim_param_t;
+
+static esp_h264_err_t sim_cfg_roi(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_roi_cfg_t cfg)
+{
+    sim_param_t *sim = (sim_param_t *)handle;
+    sim->roi_cfg = cfg;
+    sim->cfg_calls++;
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_err_t sim_set_roi_reg(esp_h264_enc_param_hw_handle_t handle, esp_h264_enc_roi_reg_t roi_reg)
+{
+    sim_param_t *sim = (sim_param_t *)handle;
+    /** The hardware refuses regions while ROI is disabled */
+    TEST_ASSERT_EQUAL(ESP_H264_ROI_MODE_DELTA_QP, sim->roi_cfg.roi_mode);
+    sim->reg[roi_reg.reg_idx] = roi_reg;
+    sim->reg_calls++;
+    return ESP_H264_ERR_OK;
+}
+
+static esp_h264_enc_roi_ctrl_handle_t test_roi_ctrl_new(uint16_t src_w, uint16_t src_h, uint8_t margin, uint8_t smooth, uint8_t hold)
+{
+    esp_h264_enc_roi_ctrl_cfg_t cfg = {
+        .src_res = {.width = src_w, .height = src_h},
+        .enc_res = {.width = 1280, .height = 720},
+        .roi_delta_qp = -8,
+        .none_roi_delta_qp = 6,
+        .margin_mb = margin,
+        .smooth = smooth,
+        .hold_updates = hold,
+    };
+    esp_h264_enc_roi_ctrl_handle_t ctrl = NULL;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_new(&cfg, &ctrl));
+    return ctrl;
+}
+
+static void test_assert_region(const esp_h264_enc_roi_reg_t *reg, uint8_t x, uint8_t y, uint8_t len_x, uint8_t len_y)
+{
+    TEST_ASSERT_EQUAL(x, reg->x);
+    TEST_ASSERT_EQUAL(y, reg->y);
+    TEST_ASSERT_EQUAL(len_x, reg->len_x);
+    TEST_ASSERT_EQUAL(len_y, reg->len_y);
+}
+
+TEST_CASE("ROI controller maps boxes to macroblock regions", "[roi_ctrl]")
+{
+    esp_h264_enc_roi_reg_t reg[ESP_H264_ENC_ROI_REGION_MAX];
+
+    /** Same resolution: pixels [100, 164) x [50, 130) cover macroblocks [6, 11) x [3, 9) */
+    esp_h264_enc_roi_ctrl_handle_t ctrl = test_roi_ctrl_new(1280, 720, 0, 100, 0);
+    esp_h264_enc_roi_box_t box = {.x = 100, .y = 50, .w = 64, .h = 80};
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_update(ctrl, &box, 1));
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 6, 3, 5, 6);
+    TEST_ASSERT_EQUAL(-8, reg[0].qp);
+    TEST_ASSERT_EQUAL(0, reg[1].len_x);
+    esp_h264_enc_roi_ctrl_del(ctrl);
+
+    /** Detector on a half size picture gives the same region */
+    ctrl = test_roi_ctrl_new(640, 360, 0, 100, 0);
+    box = (esp_h264_enc_roi_box_t) {.x = 50, .y = 25, .w = 32, .h = 40};
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 6, 3, 5, 6);
+    esp_h264_enc_roi_ctrl_del(ctrl);
+
+    /** The margin grows the region, but not beyond the picture of 80 x 45 macroblocks */
+    ctrl = test_roi_ctrl_new(1280, 720, 2, 100, 0);
+    box = (esp_h264_enc_roi_box_t) {.x = -20, .y = 700, .w = 60, .h = 40};
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 0, 41, 5, 4);
+    esp_h264_enc_roi_ctrl_del(ctrl);
+
+    /** Boxes outside of the picture or empty are ignored */
+    ctrl = test_roi_ctrl_new(1280, 720, 2, 100, 0);
+    esp_h264_enc_roi_box_t out[] = {
+        {.x = 1300, .y = 10, .w = 50, .h = 50},
+        {.x = 10, .y = -80, .w = 50, .h = 50},
+        {.x = 10, .y = 10, .w = 0, .h = 50},
+    };
+    esp_h264_enc_roi_ctrl_update(ctrl, out, 3);
+    TEST_ASSERT_EQUAL(0, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    esp_h264_enc_roi_ctrl_del(ctrl);
+}
+
+TEST_CASE("ROI controller smooths moving boxes and holds missed ones", "[roi_ctrl]")
+{
+    esp_h264_enc_roi_reg_t reg[ESP_H264_ENC_ROI_REGION_MAX];
+    esp_h264_enc_roi_ctrl_handle_t ctrl = test_roi_ctrl_new(1280, 720, 0, 50, 2);
+
+    /** Macroblocks [10, 20) x [10, 20), then the face moves 4 macroblocks right */
+    esp_h264_enc_roi_box_t box = {.x = 160, .y = 160, .w = 160, .h = 160};
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    box.x += 64;
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 12, 10, 10, 10);
+
+    /** It converges on the box */
+    for (int i = 0; i < 8; i++) {
+        esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    }
+    esp_h264_enc_roi_ctrl_get_regions(ctrl, reg);
+    test_assert_region(&reg[0], 14, 10, 10, 10);
+
+    /** Two missed detections keep the region, the third closes it */
+    esp_h264_enc_roi_ctrl_update(ctrl, NULL, 0);
+    esp_h264_enc_roi_ctrl_update(ctrl, NULL, 0);
+    TEST_ASSERT_EQUAL(1, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 14, 10, 10, 10);
+    esp_h264_enc_roi_ctrl_update(ctrl, NULL, 0);
+    TEST_ASSERT_EQUAL(0, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+
+    /** A box back after a close opens the region without smoothing */
+    box.x = 320;
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    esp_h264_enc_roi_ctrl_get_regions(ctrl, reg);
+    test_assert_region(&reg[0], 20, 10, 10, 10);
+    esp_h264_enc_roi_ctrl_del(ctrl);
+}
+
+TEST_CASE("ROI controller tracks several boxes up to the region count", "[roi_ctrl]")
+{
+    esp_h264_enc_roi_reg_t reg[ESP_H264_ENC_ROI_REGION_MAX];
+    esp_h264_enc_roi_ctrl_handle_t ctrl = test_roi_ctrl_new(1280, 720, 0, 100, 0);
+    esp_h264_enc_roi_box_t boxes[ESP_H264_ENC_ROI_REGION_MAX + 2];
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX + 2; i++) {
+        boxes[i] = (esp_h264_enc_roi_box_t) {.x = i * 112, .y = 0, .w = 64, .h = 64};
+    }
+    esp_h264_enc_roi_ctrl_update(ctrl, boxes, ESP_H264_ENC_ROI_REGION_MAX + 2);
+    TEST_ASSERT_EQUAL(ESP_H264_ENC_ROI_REGION_MAX, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    for (int i = 0; i < ESP_H264_ENC_ROI_REGION_MAX; i++) {
+        TEST_ASSERT_EQUAL(i, reg[i].reg_idx);
+        test_assert_region(&reg[i], i * 7, 0, 4, 4);
+    }
+
+    /** Boxes keep their region when the detector lists them in another order */
+    esp_h264_enc_roi_box_t swapped[2] = {boxes[1], boxes[0]};
+    esp_h264_enc_roi_ctrl_update(ctrl, swapped, 2);
+    TEST_ASSERT_EQUAL(2, esp_h264_enc_roi_ctrl_get_regions(ctrl, reg));
+    test_assert_region(&reg[0], 0, 0, 4, 4);
+    test_assert_region(&reg[1], 7, 0, 4, 4);
+    esp_h264_enc_roi_ctrl_del(ctrl);
+}
+
+TEST_CASE("ROI controller enables ROI only while regions are open", "[roi_ctrl]")
+{
+    sim_param_t sim = {
+        .base = {
+            .cfg_roi = sim_cfg_roi,
+            .set_roi_reg = sim_set_roi_reg,
+        },
+        .roi_cfg = {.roi_mode = ESP_H264_ROI_MODE_DISABLE},
+    };
+    esp_h264_enc_roi_ctrl_handle_t ctrl = test_roi_ctrl_new(1280, 720, 0, 100, 0);
+
+    /** Nothing detected yet, the encoder is left alone */
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_apply(ctrl, &sim.base));
+    TEST_ASSERT_EQUAL(0, sim.cfg_calls);
+
+    esp_h264_enc_roi_box_t box = {.x = 100, .y = 50, .w = 64, .h = 80};
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_apply(ctrl, &sim.base));
+    TEST_ASSERT_EQUAL(1, sim.cfg_calls);
+    TEST_ASSERT_EQUAL(ESP_H264_ROI_MODE_DELTA_QP, sim.roi_cfg.roi_mode);
+    TEST_ASSERT_EQUAL(6, sim.roi_cfg.none_roi_delta_qp);
+    TEST_ASSERT_EQUAL(ESP_H264_ENC_ROI_REGION_MAX, sim.reg_calls);
+    test_assert_region(&sim.reg[0], 6, 3, 5, 6);
+    TEST_ASSERT_EQUAL(-8, sim.reg[0].qp);
+    TEST_ASSERT_EQUAL(0, sim.reg[1].len_x);
+
+    /** The mode is configured once, then only the regions follow the boxes */
+    box.x += 32;
+    esp_h264_enc_roi_ctrl_update(ctrl, &box, 1);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_apply(ctrl, &sim.base));
+    TEST_ASSERT_EQUAL(1, sim.cfg_calls);
+    test_assert_region(&sim.reg[0], 8, 3, 5, 6);
+
+    /** Without region the background goes back to the slice QP */
+    esp_h264_enc_roi_ctrl_update(ctrl, NULL, 0);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_apply(ctrl, &sim.base));
+    TEST_ASSERT_EQUAL(2, sim.cfg_calls);
+    TEST_ASSERT_EQUAL(ESP_H264_ROI_MODE_DISABLE, sim.roi_cfg.roi_mode);
+
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_roi_ctrl_apply(ctrl, NULL));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_roi_ctrl_del(ctrl));
+}
+
+TEST_CASE("ROI controller rejects invalid configurations", "[roi_ctrl]")
+{
+    esp_h264_enc_roi_ctrl_cfg_t cfg = {
+        .src_res = {.width = 1280, .height = 720},
+        .enc_res = {.width = 1280, .height = 720},
+        .roi_delta_qp = 4,
+        .none_roi_delta_qp = 6,
+        .smooth = 100,
+    };
+    esp_h264_enc_roi_ctrl_handle_t ctrl = NULL;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_roi_ctrl_new(&cfg, &ctrl));
+    cfg.roi_delta_qp = -4;
+    cfg.smooth = 0;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_roi_ctrl_new(&cfg, &ctrl));
+    cfg.smooth = 100;
+    cfg.src_res.width = 0;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_roi_ctrl_new(&cfg, &ctrl));
+    TEST_ASSERT_NULL(ctrl);
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_roi_ctrl_update(NULL, NULL, 0));
+}
@@ -0,0 +1,156 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+
+#include "esp_h264_enc_single.h"
+#include "esp_h264_enc_single_sw.h"
+
+#define TEST_BENCH_FRAMES 60
+#define TEST_BENCH_GOP    30
+
+typedef struct {
+    uint16_t width;
+    uint16_t height;
+} test_bench_res_t;
+
+/** The sizes the software fallback of the camera components encodes at */
+static const test_bench_res_t s_bench_res[] = {
+    {320, 240},
+    {640, 480},
+};
+
+static const esp_h264_enc_sw_tuning_t s_bench_tuning[] = {
+    {.threads = 1, .complexity = ESP_H264_SW_COMPLEXITY_LOW},
+    {.threads = 2, .complexity = ESP_H264_SW_COMPLEXITY_LOW},
+    {.threads = 4, .complexity = ESP_H264_SW_COMPLEXITY_LOW},
+    {.threads = 1, .complexity = ESP_H264_SW_COMPLEXITY_MEDIUM},
+    {.threads = 1, .complexity = ESP_H264_SW_COMPLEXITY_HIGH},
+};
+
+/** Count the slice NAL units of a frame, the start codes cannot show up inside a NAL unit */
+static uint32_t test_bench_slice_num(const uint8_t *buf, uint32_t len)
+{
+    uint32_t slices = 0;
+    for (uint32_t i = 0; i + 3 < len; i++) {
+        if (buf[i] == 0 && buf[i + 1] == 0 && buf[i + 2] == 1) {
+            uint8_t nal_unit_type = buf[i + 3] & 0x1f;
+            slices += nal_unit_type == 1 || nal_unit_type == 5;
+            i += 2;
+        }
+    }
+    return slices;
+}
+
+/** A camera like picture: moving gradient with some texture */
+static void test_bench_fill(uint8_t *buf, uint16_t width, uint16_t height, uint32_t index)
+{
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            buf[y * width + x] = (uint8_t)(x + y * 2 + index * 3 + ((x ^ y) & 0x0f));
+        }
+    }
+    uint8_t *uv = buf + width * height;
+    for (int i = 0; i < width * height / 2; i++) {
+        uv[i] = (uint8_t)(128 + ((i + index) & 0x1f) - 16);
+    }
+}
+
+static double test_bench_ms(const struct timespec *start, const struct timespec *end)
+{
+    return (end->tv_sec - start->tv_sec) * 1000.0 + (end->tv_nsec - start->tv_nsec) / 1000000.0;
+}
+
+TEST_CASE("SW encoder tuning checks its arguments", "[sw][tuning]")
+{
+    esp_h264_enc_cfg_sw_t cfg = {
+        .pic_type = ESP_H264_RAW_FMT_I420,
+        .gop = TEST_BENCH_GOP,
+        .fps = 30,
+        .res = {.width = 64, .height = 64},
+        .rc = {.bitrate = 100000, .qp_min = 20, .qp_max = 40},
+    };
+    esp_h264_enc_handle_t enc = NULL;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_sw_new(&cfg, &enc));
+    esp_h264_enc_sw_tuning_t tuning = {.threads = 0, .complexity = ESP_H264_SW_COMPLEXITY_LOW};
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_sw_set_tuning(enc, &tuning));
+    tuning.threads = ESP_H264_SW_MAX_THREADS + 1;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_sw_set_tuning(enc, &tuning));
+    tuning.threads = 1;
+    tuning.complexity = (esp_h264_sw_complexity_t)3;
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_sw_set_tuning(enc, &tuning));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_sw_set_tuning(enc, NULL));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_ARG, esp_h264_enc_sw_set_tuning(NULL, &tuning));
+    TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_del(enc));
+}
+
+TEST_CASE("SW encoder speed at the fallback resolutions", "[sw][bench]")
+{
+    printf("%-8s %-8s %-10s %-10s %-8s %-10s\n", "size", "threads", "complexity", "ms/frame", "fps", "kbit/frame");
+    for (size_t r = 0; r < sizeof(s_bench_res) / sizeof(s_bench_res[0]); r++) {
+        uint16_t width = s_bench_res[r].width;
+        uint16_t height = s_bench_res[r].height;
+        uint32_t in_len = width * height * 3 / 2;
+        uint8_t *in_buf = (uint8_t *)malloc(in_len);
+        uint8_t *out_buf = (uint8_t *)malloc(in_len * 2);
+        TEST_ASSERT_NOT_NULL(in_buf);
+        TEST_ASSERT_NOT_NULL(out_buf);
+
+        for (size_t t = 0; t < sizeof(s_bench_tuning) / sizeof(s_bench_tuning[0]); t++) {
+            const esp_h264_enc_sw_tuning_t *tuning = &s_bench_tuning[t];
+            esp_h264_enc_cfg_sw_t cfg = {
+                .pic_type = ESP_H264_RAW_FMT_I420,
+                .gop = TEST_BENCH_GOP,
+                .fps = 30,
+                .res = {.width = width, .height = height},
+                .rc = {.bitrate = width * height * 30 / 20, .qp_min = 20, .qp_max = 40},
+            };
+            esp_h264_enc_handle_t enc = NULL;
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_sw_new(&cfg, &enc));
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_open(enc));
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_sw_set_tuning(enc, tuning));
+
+            /** Only the encoding is timed, the pictures are made beforehand */
+            double total_ms = 0;
+            uint64_t total_bytes = 0;
+            for (uint32_t f = 0; f < TEST_BENCH_FRAMES; f++) {
+                test_bench_fill(in_buf, width, height, f);
+                esp_h264_enc_in_frame_t in_frame = {
+                    .raw_data = {.buffer = in_buf, .len = in_len},
+                    .pts = f * 3000,
+                };
+                esp_h264_enc_out_frame_t out_frame = {
+                    .raw_data = {.buffer = out_buf, .len = in_len * 2},
+                };
+                struct timespec start, end;
+                clock_gettime(CLOCK_MONOTONIC, &start);
+                TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_process(enc, &in_frame, &out_frame));
+                clock_gettime(CLOCK_MONOTONIC, &end);
+                total_ms += test_bench_ms(&start, &end);
+                total_bytes += out_frame.length;
+                TEST_ASSERT_GREATER_THAN(0, out_frame.length);
+                /** One slice per thread */
+                TEST_ASSERT_EQUAL(tuning->threads, test_bench_slice_num(out_buf, out_frame.length));
+                if (f == 0) {
+                    TEST_ASSERT_EQUAL(ESP_H264_FRAME_TYPE_IDR, out_frame.frame_type);
+                }
+            }
+            static const char *complexity[] = {"low", "medium", "high"};
+            double ms = total_ms / TEST_BENCH_FRAMES;
+            printf("%3dx%-4d %-8d %-10s %-10.2f %-8.1f %-10.1f\n", width, height, tuning->threads,
+                   complexity[tuning->complexity], ms, ms > 0 ? 1000.0 / ms : 0,
+                   total_bytes * 8.0 / 1000 / TEST_BENCH_FRAMES);
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_close(enc));
+            TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_del(enc));
+        }
+        free(in_buf);
+        free(out_buf);
+    }
+}
@@ -0,0 +1,286 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_h264_alloc.h"
+#include "h264_bench.h"
+#include "h264_metrics.h"
+
+/** Horizontal speed of the box in pixel per frame */
+#define BENCH_BOX_SPEED (4)
+
+static uint32_t bench_now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+void h264_bench_get_roi(const h264_bench_case_t *bench_case, int8_t qp, esp_h264_enc_roi_reg_t *out_reg)
+{
+    uint8_t mb_width = (bench_case->width + 15) >> 4;
+    uint8_t mb_height = (bench_case->height + 15) >> 4;
+    memset(out_reg, 0, sizeof(esp_h264_enc_roi_reg_t));
+    out_reg->len_x = mb_width > 1 ? mb_width >> 1 : 1;
+    out_reg->len_y = mb_height > 1 ? mb_height >> 1 : 1;
+    out_reg->x = (mb_width - out_reg->len_x) >> 1;
+    out_reg->y = (mb_height - out_reg->len_y) >> 1;
+    out_reg->qp = qp;
+    out_reg->reg_idx = 0;
+}
+
+/** A camera like picture: panning textured gradient, and a contrasted box going back and forth in the ROI */
+static void bench_fill_i420(uint8_t *yuv, const h264_bench_case_t *bench_case, const esp_h264_enc_roi_reg_t *roi, uint32_t index)
+{
+    uint16_t width = bench_case->width;
+    uint16_t height = bench_case->height;
+    uint8_t *u = yuv + width * height;
+    uint8_t *v = u + (width * height >> 2);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int px = x + index;
+            yuv[y * width + x] = (uint8_t)(48 + (px >> 2) + (y >> 3) + (((px * 7) ^ (y * 13)) & 0x0f));
+        }
+    }
+    for (int i = 0; i < (width * height >> 2); i++) {
+        u[i] = (uint8_t)(112 + ((i / (width >> 1) + index) & 0x1f));
+        v[i] = (uint8_t)(144 - ((i % (width >> 1)) & 0x1f));
+    }
+
+    int roi_x = roi->x * 16;
+    int roi_y = roi->y * 16;
+    int roi_w = roi->len_x * 16;
+    int roi_h = roi->len_y * 16;
+    if (roi_x + roi_w > width) {
+        roi_w = width - roi_x;
+    }
+    if (roi_y + roi_h > height) {
+        roi_h = height - roi_y;
+    }
+    int box_w = (roi_w >> 1) & ~1;
+    int box_h = (roi_h >> 1) & ~1;
+    int span = roi_w - box_w;
+    int pos = span ? (int)(index * BENCH_BOX_SPEED % (2 * span)) : 0;
+    int box_x = (roi_x + (pos < span ? pos : 2 * span - pos)) & ~1;
+    int box_y = (roi_y + (roi_h >> 2)) & ~1;
+    for (int y = box_y; y < box_y + box_h; y++) {
+        for (int x = box_x; x < box_x + box_w; x++) {
+            yuv[y * width + x] = (((x - box_x) ^ (y - box_y)) & 4) ? 224 : 32;
+        }
+    }
+    for (int y = box_y >> 1; y < (box_y + box_h) >> 1; y++) {
+        for (int x = box_x >> 1; x < (box_x + box_w) >> 1; x++) {
+            u[y * (width >> 1) + x] = 84;
+            v[y * (width >> 1) + x] = 190;
+        }
+    }
+}
+
+/** Odd lines are U Y Y, even lines V Y Y, see `ESP_H264_RAW_FMT_O_UYY_E_VYY` */
+static void bench_i420_to_o_uyy_e_vyy(const uint8_t *src, uint8_t *dst, uint16_t width, uint16_t height)
+{
+    const uint8_t *src_u = src + width * height;
+    const uint8_t *src_v = src_u + (width * height >> 2);
+    for (int y = 0; y < height; y++) {
+        const uint8_t *luma = src + y * width;
+        const uint8_t *chroma = ((y & 1) ? src_v : src_u) + (y >> 1) * (width >> 1);
+        for (int x = 0; x < width; x += 2) {
+            *dst++ = chroma[x >> 1];
+            *dst++ = luma[x];
+            *dst++ = luma[x + 1];
+        }
+    }
+}
+
+/** Decode one encoded frame, `pic` gets the last picture out of it */
+static esp_h264_err_t bench_decode(esp_h264_dec_handle_t dec, const esp_h264_enc_out_frame_t *out_frame, esp_h264_dec_out_frame_t *pic)
+{
+    esp_h264_dec_in_frame_t in_frame = {
+        .raw_data = {.buffer = out_frame->raw_data.buffer, .len = out_frame->length},
+        .pts = out_frame->pts,
+        .dts = out_frame->dts,
+    };
+    pic->out_size = 0;
+    while (in_frame.raw_data.len) {
+        esp_h264_dec_out_frame_t dec_frame = {0};
+        esp_h264_err_t ret = esp_h264_dec_process(dec, &in_frame, &dec_frame);
+        if (ret != ESP_H264_ERR_OK) {
+            return ret;
+        }
+        if (dec_frame.out_size) {
+            *pic = dec_frame;
+        }
+        if (in_frame.consume == 0) {
+            break;
+        }
+        in_frame.raw_data.buffer += in_frame.consume;
+        in_frame.raw_data.len -= in_frame.consume;
+    }
+    return ESP_H264_ERR_OK;
+}
+
+esp_h264_err_t h264_bench_run(const h264_bench_case_t *bench_case, esp_h264_raw_format_t pic_type,
+                              h264_bench_enc_open_cb_t enc_open, h264_bench_dec_open_cb_t dec_open,
+                              h264_bench_result_t *result)
+{
+    if (!bench_case || !enc_open || !result || bench_case->frames == 0 || bench_case->fps == 0
+            || (bench_case->width & 1) || (bench_case->height & 1)
+            || (pic_type != ESP_H264_RAW_FMT_I420 && pic_type != ESP_H264_RAW_FMT_O_UYY_E_VYY)) {
+        return ESP_H264_ERR_ARG;
+    }
+    memset(result, 0, sizeof(h264_bench_result_t));
+    esp_h264_err_t ret = ESP_H264_ERR_MEM;
+    esp_h264_enc_handle_t enc = NULL;
+    esp_h264_dec_handle_t dec = NULL;
+    esp_h264_enc_in_frame_t in_frame = {0};
+    esp_h264_enc_out_frame_t out_frame = {0};
+    uint8_t *src = NULL;
+    uint32_t *latency = NULL;
+    uint16_t width = bench_case->width;
+    uint16_t height = bench_case->height;
+    uint32_t src_len = width * height + (width * height >> 1);
+    uint32_t mb_len = ((width + 15) >> 4 << 4) * ((height + 15) >> 4 << 4);
+    uint32_t actual_len;
+    src = esp_h264_aligned_calloc(64, 1, src_len, &actual_len, ESP_H264_MEM_SPIRAM);
+    if (pic_type == ESP_H264_RAW_FMT_I420) {
+        in_frame.raw_data.buffer = src;
+        in_frame.raw_data.len = src_len;
+    } else {
+        in_frame.raw_data.len = mb_len + (mb_len >> 1);
+        in_frame.raw_data.buffer = esp_h264_aligned_calloc(64, 1, in_frame.raw_data.len, &in_frame.raw_data.len, ESP_H264_MEM_SPIRAM);
+    }
+    uint32_t out_len = mb_len + (mb_len >> 1);
+    out_frame.raw_data.buffer = esp_h264_aligned_calloc(64, 1, out_len, &out_len, ESP_H264_MEM_SPIRAM);
+    latency = calloc(bench_case->frames, sizeof(uint32_t));
+    if (!src || !in_frame.raw_data.buffer || !out_frame.raw_data.buffer || !latency) {
+        printf("mem allocation failed. line %d \n", __LINE__);
+        goto _bench_exit_;
+    }
+
+    ret = enc_open(bench_case, &enc);
+    if (ret != ESP_H264_ERR_OK) {
+        printf("encoder open failed. ret %d line %d \n", ret, __LINE__);
+        goto _bench_exit_;
+    }
+    if (dec_open) {
+        ret = dec_open(&dec);
+        if (ret != ESP_H264_ERR_OK) {
+            printf("decoder open failed. ret %d line %d \n", ret, __LINE__);
+            goto _bench_exit_;
+        }
+    }
+
+    esp_h264_enc_roi_reg_t roi;
+    h264_bench_get_roi(bench_case, 0, &roi);
+    uint16_t roi_x = roi.x * 16;
+    uint16_t roi_y = roi.y * 16;
+    uint16_t roi_w = (roi_x + roi.len_x * 16 > width) ? width - roi_x : roi.len_x * 16;
+    uint16_t roi_h = (roi_y + roi.len_y * 16 > height) ? height - roi_y : roi.len_y * 16;
+    uint64_t roi_sse = 0;
+    uint64_t roi_samples = 0;
+    h264_metrics_t metrics;
+    h264_metrics_reset(&metrics);
+    uint64_t total_us = 0;
+    uint64_t total_bytes = 0;
+
+    for (uint32_t f = 0; f < bench_case->frames; f++) {
+        bench_fill_i420(src, bench_case, &roi, f);
+        if (pic_type == ESP_H264_RAW_FMT_O_UYY_E_VYY) {
+            bench_i420_to_o_uyy_e_vyy(src, in_frame.raw_data.buffer, width, height);
+        }
+        in_frame.pts = f * 90000 / bench_case->fps;
+        out_frame.raw_data.len = out_len;
+        uint32_t start = bench_now_us();
+        ret = esp_h264_enc_process(enc, &in_frame, &out_frame);
+        latency[f] = bench_now_us() - start;
+        if (ret != ESP_H264_ERR_OK) {
+            printf("process failed. ret %d frame %d line %d \n", ret, (int)f, __LINE__);
+            goto _bench_exit_;
+        }
+        total_us += latency[f];
+        total_bytes += out_frame.length;
+        result->frames++;
+        if (!dec) {
+            continue;
+        }
+
+        /** A frame the decoder does not give back is left out of the quality measures */
+        esp_h264_dec_out_frame_t pic = {0};
+        ret = bench_decode(dec, &out_frame, &pic);
+        if (ret != ESP_H264_ERR_OK) {
+            printf("decode failed. ret %d frame %d line %d \n", ret, (int)f, __LINE__);
+            goto _bench_exit_;
+        }
+        uint32_t dec_height = pic.out_size * 2 / 3 / width;
+        if (pic.out_size == 0 || dec_height < height) {
+            continue;
+        }
+        h264_metrics_add_i420(&metrics, src, pic.outbuf, width, height, dec_height);
+        roi_sse += h264_metrics_sse(src + roi_y * width + roi_x, pic.outbuf + roi_y * width + roi_x, roi_w, roi_h, width);
+        roi_samples += roi_w * roi_h;
+        result->decoded++;
+    }
+
+    result->fps = total_us ? result->frames * 1000000.0 / total_us : 0;
+    result->bits_per_frame = total_bytes * 8.0 / result->frames;
+    result->kbps = result->bits_per_frame * bench_case->fps / 1000;
+    if (result->decoded) {
+        result->psnr_y = h264_metrics_get_psnr_y(&metrics);
+        result->psnr = h264_metrics_get_psnr(&metrics);
+        result->psnr_roi = h264_metrics_psnr(roi_sse, roi_samples);
+        result->ssim = h264_metrics_get_ssim(&metrics);
+    }
+    result->lat_p50 = h264_metrics_percentile(latency, result->frames, 50);
+    result->lat_p90 = h264_metrics_percentile(latency, result->frames, 90);
+    result->lat_p99 = h264_metrics_percentile(latency, result->frames, 99);
+    result->lat_max = h264_metrics_percentile(latency, result->frames, 100);
+_bench_exit_:
+    if (enc) {
+        esp_h264_enc_close(enc);
+        esp_h264_enc_del(enc);
+    }
+    if (dec) {
+        esp_h264_dec_close(dec);
+        esp_h264_dec_del(dec);
+    }
+    if (in_frame.raw_data.buffer && in_frame.raw_data.buffer != src) {
+        esp_h264_free(in_frame.raw_data.buffer);
+    }
+    if (src) {
+        esp_h264_free(src);
+    }
+    if (out_frame.raw_data.buffer) {
+        esp_h264_free(out_frame.raw_data.buffer);
+    }
+    free(latency);
+    return ret;
+}
+
+void h264_bench_print_header(void)
+{
+    printf("%-10s %-4s %-6s %-4s %-4s %-8s %-9s %-8s %-7s %-7s %-8s %-6s %s\n",
+           "size", "gop", "qp", "rc", "roi", "fps", "kbit/frm", "kbps",
+           "psnr-y", "psnr", "psnr-roi", "ssim", "latency p50/p90/p99/max us");
+}
+
+void h264_bench_print(const h264_bench_case_t *bench_case, const h264_bench_result_t *result)
+{
+    char size[16];
+    char qp[8];
+    snprintf(size, sizeof(size), "%dx%d", bench_case->width, bench_case->height);
+    if (bench_case->rc) {
+        snprintf(qp, sizeof(qp), "%d-%d", bench_case->qp_min, bench_case->qp_max);
+    } else {
+        snprintf(qp, sizeof(qp), "%d", bench_case->qp_min);
+    }
+    printf("%-10s %-4d %-6s %-4s %-4s %-8.1f %-9.1f %-8.0f %-7.2f %-7.2f %-8.2f %-6.4f %d/%d/%d/%d\n",
+           size, bench_case->gop, qp, bench_case->rc ? "on" : "off", bench_case->roi ? "on" : "off",
+           result->fps, result->bits_per_frame / 1000, result->kbps,
+           result->psnr_y, result->psnr, result->psnr_roi, result->ssim,
+           (int)result->lat_p50, (int)result->lat_p90, (int)result->lat_p99, (int)result->lat_max);
+}
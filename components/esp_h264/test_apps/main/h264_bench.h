@@ -0,0 +1,122 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_h264_enc_single.h"
+#include "esp_h264_enc_param_hw.h"
+#include "esp_h264_dec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  One encoder setting to measure
+ */
+typedef struct {
+    uint16_t width;   /*<! Picture width */
+    uint16_t height;  /*<! Picture height */
+    uint8_t  fps;     /*<! Frame rate, it turns the bits per frame into a bitrate */
+    uint8_t  gop;     /*<! Group of pictures */
+    uint8_t  qp_min;  /*<! Minimum QP */
+    uint8_t  qp_max;  /*<! Maximum QP */
+    bool     rc;      /*<! Rate control at `width * height * fps / 20` bit per second. Without it the QP is fixed to `qp_min` */
+    bool     roi;     /*<! Favour the region of `h264_bench_get_roi` with a lower QP */
+    uint16_t frames;  /*<! Number of encoded frames */
+} h264_bench_case_t;
+
+/**
+ * @brief  Measures of one encoder setting
+ */
+typedef struct {
+    uint32_t frames;          /*<! Number of encoded frames */
+    uint32_t decoded;         /*<! Number of decoded frames compared with their source, 0 without decoder */
+    double   fps;             /*<! Encoded frames per second of encoding time */
+    double   bits_per_frame;  /*<! Average size of the encoded frames in bit */
+    double   kbps;            /*<! Bitrate in kbit per second at the frame rate of the case */
+    double   psnr_y;          /*<! Luma PSNR in dB */
+    double   psnr;            /*<! PSNR of the Y, U and V planes together in dB */
+    double   psnr_roi;        /*<! Luma PSNR of the region of `h264_bench_get_roi` in dB, with or without ROI */
+    double   ssim;            /*<! Mean luma SSIM */
+    uint32_t lat_p50;         /*<! Median encode latency in microsecond */
+    uint32_t lat_p90;         /*<! 90th percentile of the encode latency in microsecond */
+    uint32_t lat_p99;         /*<! 99th percentile of the encode latency in microsecond */
+    uint32_t lat_max;         /*<! Maximum encode latency in microsecond */
+} h264_bench_result_t;
+
+/**
+ * @brief  Create and open an encoder for a case, with its rate control and ROI configured
+ *
+ * @param  bench_case  The case to encode
+ * @param  out_enc     The opened encoder
+ *
+ * @return
+ *       - ESP_H264_ERR_OK  Succeeded
+ *       - Others           The case is not supported by the encoder or failed
+ */
+typedef esp_h264_err_t (*h264_bench_enc_open_cb_t)(const h264_bench_case_t *bench_case, esp_h264_enc_handle_t *out_enc);
+
+/**
+ * @brief  Create and open a decoder for the encoded frames of a case. It outputs I420 frames
+ *
+ * @param  out_dec  The opened decoder
+ *
+ * @return
+ *       - ESP_H264_ERR_OK  Succeeded
+ *       - Others           Failed
+ */
+typedef esp_h264_err_t (*h264_bench_dec_open_cb_t)(esp_h264_dec_handle_t *out_dec);
+
+/**
+ * @brief  The region of interest of the benchmark pictures, where a textured box moves.
+ *         It is the centered half of the picture in both directions
+ *
+ * @param  bench_case  The case
+ * @param  qp          ROI QP, e.g. a negative delta QP of `ESP_H264_ROI_MODE_DELTA_QP`
+ * @param  out_reg     ROI region of index 0 in macroblocks
+ */
+void h264_bench_get_roi(const h264_bench_case_t *bench_case, int8_t qp, esp_h264_enc_roi_reg_t *out_reg);
+
+/**
+ * @brief  Encode the synthetic sequence of a case and measure it.
+ *         The pictures are made and compared outside of the timed part, only `esp_h264_enc_process` is timed
+ *
+ * @param  bench_case  The case
+ * @param  pic_type    Input format of the encoder, `ESP_H264_RAW_FMT_I420` or `ESP_H264_RAW_FMT_O_UYY_E_VYY`
+ * @param  enc_open    Encoder factory
+ * @param  dec_open    Decoder factory, NULL to skip the quality measures
+ * @param  result      Measures
+ *
+ * @return
+ *       - ESP_H264_ERR_OK           Succeeded
+ *       - ESP_H264_ERR_ARG          Invalid arguments passed
+ *       - ESP_H264_ERR_MEM          Insufficient memory
+ *       - ESP_H264_ERR_UNSUPPORTED  The encoder does not support the case
+ *       - ESP_H264_ERR_FAIL         Failed
+ */
+esp_h264_err_t h264_bench_run(const h264_bench_case_t *bench_case, esp_h264_raw_format_t pic_type,
+                              h264_bench_enc_open_cb_t enc_open, h264_bench_dec_open_cb_t dec_open,
+                              h264_bench_result_t *result);
+
+/**
+ * @brief  Print the header of the result table
+ */
+void h264_bench_print_header(void);
+
+/**
+ * @brief  Print one line of the result table
+ *
+ * @param  bench_case  The case
+ * @param  result      Its measures
+ */
+void h264_bench_print(const h264_bench_case_t *bench_case, const h264_bench_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
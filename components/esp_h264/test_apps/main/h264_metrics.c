@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "h264_metrics.h"
+
+/** SSIM window and the grid it moves on */
+#define SSIM_WIN  (8)
+#define SSIM_STEP (4)
+/** (0.01 * 255)^2 and (0.03 * 255)^2 */
+#define SSIM_C1   (6.5025)
+#define SSIM_C2   (58.5225)
+
+uint64_t h264_metrics_sse(const uint8_t *src, const uint8_t *dec, uint16_t width, uint16_t height, uint32_t stride)
+{
+    uint64_t sse = 0;
+    for (uint16_t y = 0; y < height; y++) {
+        uint32_t line_sse = 0;
+        for (uint16_t x = 0; x < width; x++) {
+            int32_t diff = (int32_t)src[x] - dec[x];
+            line_sse += diff * diff;
+        }
+        sse += line_sse;
+        src += stride;
+        dec += stride;
+    }
+    return sse;
+}
+
+double h264_metrics_psnr(uint64_t sse, uint64_t samples)
+{
+    if (sse == 0 || samples == 0) {
+        return H264_METRICS_PSNR_MAX;
+    }
+    double psnr = 10.0 * log10(255.0 * 255.0 * samples / sse);
+    return psnr < H264_METRICS_PSNR_MAX ? psnr : H264_METRICS_PSNR_MAX;
+}
+
+static double ssim_window(const uint8_t *src, const uint8_t *dec, uint32_t stride)
+{
+    uint32_t s1 = 0;
+    uint32_t s2 = 0;
+    uint32_t ss = 0;
+    uint32_t s12 = 0;
+    for (int y = 0; y < SSIM_WIN; y++) {
+        for (int x = 0; x < SSIM_WIN; x++) {
+            uint32_t a = src[x];
+            uint32_t b = dec[x];
+            s1 += a;
+            s2 += b;
+            ss += a * a + b * b;
+            s12 += a * b;
+        }
+        src += stride;
+        dec += stride;
+    }
+    const double n = SSIM_WIN * SSIM_WIN;
+    double mu1 = s1 / n;
+    double mu2 = s2 / n;
+    double var = ss / n - mu1 * mu1 - mu2 * mu2;
+    double cov = s12 / n - mu1 * mu2;
+    return ((2 * mu1 * mu2 + SSIM_C1) * (2 * cov + SSIM_C2)) / ((mu1 * mu1 + mu2 * mu2 + SSIM_C1) * (var + SSIM_C2));
+}
+
+double h264_metrics_ssim(const uint8_t *src, const uint8_t *dec, uint16_t width, uint16_t height, uint32_t stride)
+{
+    double sum = 0;
+    uint32_t windows = 0;
+    for (uint32_t y = 0; y + SSIM_WIN <= height; y += SSIM_STEP) {
+        for (uint32_t x = 0; x + SSIM_WIN <= width; x += SSIM_STEP) {
+            sum += ssim_window(src + y * stride + x, dec + y * stride + x, stride);
+            windows++;
+        }
+    }
+    return windows ? sum / windows : 1.0;
+}
+
+void h264_metrics_reset(h264_metrics_t *metrics)
+{
+    memset(metrics, 0, sizeof(h264_metrics_t));
+}
+
+void h264_metrics_add_i420(h264_metrics_t *metrics, const uint8_t *src, const uint8_t *dec,
+                           uint16_t width, uint16_t height, uint16_t dec_height)
+{
+    uint32_t y_size = width * height;
+    uint32_t dec_y_size = width * dec_height;
+    uint16_t c_width = width >> 1;
+    uint16_t c_height = height >> 1;
+    const uint8_t *src_plane[3] = {src, src + y_size, src + y_size + (y_size >> 2)};
+    const uint8_t *dec_plane[3] = {dec, dec + dec_y_size, dec + dec_y_size + (dec_y_size >> 2)};
+
+    metrics->sse[0] += h264_metrics_sse(src_plane[0], dec_plane[0], width, height, width);
+    metrics->samples[0] += y_size;
+    for (int i = 1; i < 3; i++) {
+        metrics->sse[i] += h264_metrics_sse(src_plane[i], dec_plane[i], c_width, c_height, c_width);
+        metrics->samples[i] += c_width * c_height;
+    }
+    metrics->ssim_sum += h264_metrics_ssim(src_plane[0], dec_plane[0], width, height, width);
+    metrics->frames++;
+}
+
+double h264_metrics_get_psnr_y(const h264_metrics_t *metrics)
+{
+    return h264_metrics_psnr(metrics->sse[0], metrics->samples[0]);
+}
+
+double h264_metrics_get_psnr(const h264_metrics_t *metrics)
+{
+    return h264_metrics_psnr(metrics->sse[0] + metrics->sse[1] + metrics->sse[2],
+                             metrics->samples[0] + metrics->samples[1] + metrics->samples[2]);
+}
+
+double h264_metrics_get_ssim(const h264_metrics_t *metrics)
+{
+    return metrics->frames ? metrics->ssim_sum / metrics->frames : 0;
+}
+
+static int cmp_u32(const void *a, const void *b)
+{
+    uint32_t va = *(const uint32_t *)a;
+    uint32_t vb = *(const uint32_t *)b;
+    return (va > vb) - (va < vb);
+}
+
+uint32_t h264_metrics_percentile(uint32_t *samples, uint32_t num, uint8_t percent)
+{
+    if (num == 0) {
+        return 0;
+    }
+    qsort(samples, num, sizeof(uint32_t), cmp_u32);
+    uint32_t rank = ((uint64_t)num * (percent > 100 ? 100 : percent) + 99) / 100;
+    return samples[rank ? rank - 1 : 0];
+}
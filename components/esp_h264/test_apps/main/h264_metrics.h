@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief  PSNR reported for identical pictures, in dB
+ */
+#define H264_METRICS_PSNR_MAX (100.0)
+
+/**
+ * @brief  Quality of a decoded sequence against its source, accumulated frame by frame
+ */
+typedef struct {
+    uint64_t sse[3];      /*<! Sum of squared errors of the Y, U and V planes */
+    uint64_t samples[3];  /*<! Number of compared samples of the Y, U and V planes */
+    double   ssim_sum;    /*<! Sum of the luma SSIM of the frames */
+    uint32_t frames;      /*<! Number of compared frames */
+} h264_metrics_t;
+
+/**
+ * @brief  Sum of squared errors between two 8 bit planes
+ *
+ * @param  src     Source plane
+ * @param  dec     Decoded plane
+ * @param  width   Width of the compared area in samples
+ * @param  height  Height of the compared area in lines
+ * @param  stride  Line length of both planes in byte
+ *
+ * @return
+ *       - The sum of squared errors
+ */
+uint64_t h264_metrics_sse(const uint8_t *src, const uint8_t *dec, uint16_t width, uint16_t height, uint32_t stride);
+
+/**
+ * @brief  Peak signal to noise ratio(PSNR) of a sum of squared errors
+ *
+ * @param  sse      Sum of squared errors
+ * @param  samples  Number of samples the errors are summed over
+ *
+ * @return
+ *       - PSNR in dB, `H264_METRICS_PSNR_MAX` when `sse` is 0
+ */
+double h264_metrics_psnr(uint64_t sse, uint64_t samples);
+
+/**
+ * @brief  Structural similarity(SSIM) between two 8 bit planes.
+ *         It is the mean SSIM of 8x8 windows on a 4 samples grid
+ *
+ * @param  src     Source plane
+ * @param  dec     Decoded plane
+ * @param  width   Width of the compared area in samples, not less than 8
+ * @param  height  Height of the compared area in lines, not less than 8
+ * @param  stride  Line length of both planes in byte
+ *
+ * @return
+ *       - SSIM in [-1, 1], 1 for identical planes
+ */
+double h264_metrics_ssim(const uint8_t *src, const uint8_t *dec, uint16_t width, uint16_t height, uint32_t stride);
+
+/**
+ * @brief  Clear the accumulated quality
+ *
+ * @param  metrics  Metrics to clear
+ */
+void h264_metrics_reset(h264_metrics_t *metrics);
+
+/**
+ * @brief  Accumulate the quality of one decoded I420 frame against its I420 source.
+ *         The decoded frame may have more lines than the source (macroblock padding), they are not compared
+ *
+ * @param  metrics     Metrics to accumulate into
+ * @param  src         Source frame
+ * @param  dec         Decoded frame
+ * @param  width       Picture width
+ * @param  height      Picture height
+ * @param  dec_height  Number of lines of the decoded luma plane, not less than `height`
+ */
+void h264_metrics_add_i420(h264_metrics_t *metrics, const uint8_t *src, const uint8_t *dec,
+                           uint16_t width, uint16_t height, uint16_t dec_height);
+
+/**
+ * @brief  Luma PSNR of the accumulated frames
+ *
+ * @param  metrics  Accumulated metrics
+ *
+ * @return
+ *       - PSNR in dB
+ */
+double h264_metrics_get_psnr_y(const h264_metrics_t *metrics);
+
+/**
+ * @brief  PSNR of the accumulated frames over all the samples of the three planes
+ *
+ * @param  metrics  Accumulated metrics
+ *
+ * @return
+ *       - PSNR in dB
+ */
+double h264_metrics_get_psnr(const h264_metrics_t *metrics);
+
+/**
+ * @brief  Mean luma SSIM of the accumulated frames
+ *
+ * @param  metrics  Accumulated metrics
+ *
+ * @return
+ *       - SSIM, 0 if no frame is accumulated
+ */
+double h264_metrics_get_ssim(const h264_metrics_t *metrics);
+
+/**
+ * @brief  Percentile of a set of samples, e.g. encode latencies. The samples are sorted in place
+ *
+ * @param  samples  Samples
+ * @param  num      Number of samples
+ * @param  percent  Percentile in [0, 100], 50 is the median and 100 the maximum
+ *
+ * @return
+ *       - The smallest sample not less than `percent` of the samples (nearest rank), 0 if `num` is 0
+ */
+uint32_t h264_metrics_percentile(uint32_t *samples, uint32_t num, uint8_t percent);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,7 @@
 #include "esp_h264_hw_enc_test.h"
 #include "esp_h264_sw_enc_test.h"
 #include "esp_h264_sw_dec_test.h"
+#include "h264_bench.h"
 
 static int16_t res_width = 128;
 static int16_t res_height = 128;
@@ -1027,3 +1028,139 @@ TEST_CASE("sw_enc_error_test", "[esp_h264]")
 
     TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_del(enc));
 }
+
+/* benchmark */
+static esp_h264_err_t bench_dec_open(esp_h264_dec_handle_t *out_dec)
+{
+    esp_h264_dec_cfg_sw_t cfg = {.pic_type = ESP_H264_RAW_FMT_I420};
+    esp_h264_err_t ret = esp_h264_dec_sw_new(&cfg, out_dec);
+    if (ret != ESP_H264_ERR_OK) {
+        return ret;
+    }
+    ret = esp_h264_dec_open(*out_dec);
+    if (ret != ESP_H264_ERR_OK) {
+        esp_h264_dec_del(*out_dec);
+        *out_dec = NULL;
+    }
+    return ret;
+}
+
+#if CONFIG_IDF_TARGET_ESP32P4
+
+/** Resolutions, GOP, QP ranges, RC on/off and ROI on/off a deployment picks from */
+static const h264_bench_case_t hw_bench_cases[] = {
+    {.width = 640,  .height = 480,  .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 90},
+    {.width = 640,  .height = 480,  .fps = 30, .gop = 30, .qp_min = 26, .qp_max = 26, .rc = false, .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 1,  .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 30, .qp_min = 25, .qp_max = 35, .rc = true,  .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .roi = true, .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 30, .qp_min = 30, .qp_max = 30, .rc = false, .frames = 90},
+    {.width = 1280, .height = 720,  .fps = 30, .gop = 30, .qp_min = 30, .qp_max = 30, .rc = false, .roi = true, .frames = 90},
+    {.width = 1920, .height = 1080, .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 90},
+    {.width = 1920, .height = 1080, .fps = 30, .gop = 60, .qp_min = 20, .qp_max = 40, .rc = true,  .roi = true, .frames = 90},
+    {.width = 1920, .height = 1080, .fps = 30, .gop = 30, .qp_min = 30, .qp_max = 30, .rc = false, .frames = 90},
+};
+
+static esp_h264_err_t bench_hw_enc_open(const h264_bench_case_t *bench_case, esp_h264_enc_handle_t *out_enc)
+{
+    esp_h264_enc_cfg_hw_t cfg = { 0 };
+    cfg.gop = bench_case->gop;
+    cfg.fps = bench_case->fps;
+    cfg.res.width = bench_case->width;
+    cfg.res.height = bench_case->height;
+    cfg.rc.bitrate = cfg.res.width * cfg.res.height * cfg.fps / 20;
+    cfg.rc.qp_min = bench_case->qp_min;
+    cfg.rc.qp_max = bench_case->rc ? bench_case->qp_max : bench_case->qp_min;
+    cfg.pic_type = ESP_H264_RAW_FMT_O_UYY_E_VYY;
+    esp_h264_err_t ret = esp_h264_enc_hw_new(&cfg, out_enc);
+    if (ret != ESP_H264_ERR_OK) {
+        return ret;
+    }
+    esp_h264_enc_param_hw_handle_t param_hd = NULL;
+    ret = esp_h264_enc_hw_get_param_hd(*out_enc, &param_hd);
+    ret |= esp_h264_enc_open(*out_enc);
+    if (ret == ESP_H264_ERR_OK && !bench_case->rc) {
+        esp_h264_enc_rc_cfg_t rc_cfg = {
+            .mode = ESP_H264_RC_MODE_CQP,
+            .cqp = bench_case->qp_min,
+        };
+        ret = esp_h264_enc_hw_cfg_rc(param_hd, rc_cfg);
+    }
+    if (ret == ESP_H264_ERR_OK && bench_case->roi) {
+        esp_h264_enc_roi_cfg_t roi_cfg = {
+            .roi_mode = ESP_H264_ROI_MODE_DELTA_QP,
+            .none_roi_delta_qp = 4,
+        };
+        esp_h264_enc_roi_reg_t roi_reg;
+        h264_bench_get_roi(bench_case, -6, &roi_reg);
+        ret = esp_h264_enc_hw_cfg_roi(param_hd, roi_cfg);
+        ret |= esp_h264_enc_hw_set_roi_region(param_hd, roi_reg);
+    }
+    if (ret != ESP_H264_ERR_OK) {
+        esp_h264_enc_close(*out_enc);
+        esp_h264_enc_del(*out_enc);
+        *out_enc = NULL;
+    }
+    return ret;
+}
+
+TEST_CASE("hw_enc_benchmark", "[bench]")
+{
+    h264_bench_result_t result;
+    h264_bench_print_header();
+    for (size_t i = 0; i < sizeof(hw_bench_cases) / sizeof(hw_bench_cases[0]); i++) {
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, h264_bench_run(&hw_bench_cases[i], ESP_H264_RAW_FMT_O_UYY_E_VYY,
+                                                          bench_hw_enc_open, bench_dec_open, &result));
+        h264_bench_print(&hw_bench_cases[i], &result);
+        TEST_ASSERT_EQUAL(hw_bench_cases[i].frames, result.frames);
+    }
+}
+
+#endif  /* CONFIG_IDF_TARGET_ESP32P4 */
+
+/** The software encoder has no ROI */
+static const h264_bench_case_t sw_bench_cases[] = {
+    {.width = 320, .height = 240, .fps = 30, .gop = 30, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 60},
+    {.width = 320, .height = 240, .fps = 30, .gop = 30, .qp_min = 26, .qp_max = 26, .rc = false, .frames = 60},
+    {.width = 640, .height = 480, .fps = 15, .gop = 15, .qp_min = 20, .qp_max = 40, .rc = true,  .frames = 30},
+    {.width = 640, .height = 480, .fps = 15, .gop = 15, .qp_min = 30, .qp_max = 30, .rc = false, .frames = 30},
+};
+
+static esp_h264_err_t bench_sw_enc_open(const h264_bench_case_t *bench_case, esp_h264_enc_handle_t *out_enc)
+{
+    if (bench_case->roi) {
+        return ESP_H264_ERR_UNSUPPORTED;
+    }
+    esp_h264_enc_cfg_sw_t cfg = { 0 };
+    cfg.gop = bench_case->gop;
+    cfg.fps = bench_case->fps;
+    cfg.res.width = bench_case->width;
+    cfg.res.height = bench_case->height;
+    cfg.rc.bitrate = cfg.res.width * cfg.res.height * cfg.fps / 20;
+    cfg.rc.qp_min = bench_case->qp_min;
+    cfg.rc.qp_max = bench_case->rc ? bench_case->qp_max : bench_case->qp_min;
+    cfg.pic_type = ESP_H264_RAW_FMT_I420;
+    esp_h264_err_t ret = esp_h264_enc_sw_new(&cfg, out_enc);
+    if (ret != ESP_H264_ERR_OK) {
+        return ret;
+    }
+    ret = esp_h264_enc_open(*out_enc);
+    if (ret != ESP_H264_ERR_OK) {
+        esp_h264_enc_del(*out_enc);
+        *out_enc = NULL;
+    }
+    return ret;
+}
+
+TEST_CASE("sw_enc_benchmark", "[bench]")
+{
+    h264_bench_result_t result;
+    h264_bench_print_header();
+    for (size_t i = 0; i < sizeof(sw_bench_cases) / sizeof(sw_bench_cases[0]); i++) {
+        TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, h264_bench_run(&sw_bench_cases[i], ESP_H264_RAW_FMT_I420,
+                                                          bench_sw_enc_open, bench_dec_open, &result));
+        h264_bench_print(&sw_bench_cases[i], &result);
+        TEST_ASSERT_EQUAL(sw_bench_cases[i].frames, result.frames);
+    }
+}
@@ -7,4 +7,11 @@ from pytest_embedded_idf import IdfDut
 @pytest.mark.esp32s3
 @pytest.mark.esp32p4
 def test_h264_hw(dut: IdfDut) -> None:
-    dut.run_all_single_board_cases()
+    dut.run_all_single_board_cases(group='esp_h264')
+
+
+# The benchmark prints a table of fps, bits, PSNR/SSIM and encode latency per setting, it checks no threshold
+@pytest.mark.esp32s3
+@pytest.mark.esp32p4
+def test_h264_bench(dut: IdfDut) -> None:
+    dut.run_all_single_board_cases(group='bench', timeout=600)
@@ -57,6 +57,10 @@ esp_cam_sensor_sources = [
     "src/esp_cam_sensor.c",
     "src/esp_cam_motor.c",
     "src/esp_cam_sensor_xclk.c",
+    "src/esp_cam_sensor_regcache.c",
+    "src/esp_cam_sensor_delayed_ctrl.c",
+    "src/esp_cam_sensor_regdelta.c",
+    "src/esp_cam_sensor_frame_timing.c",
     "src/esp_cam_sensor_detect_stubs.c",  # Linker symbols for sensor auto-detection
     "src/driver_spi/spi_slave.c",
     "src/driver_cam/esp_cam_ctlr_spi_cam.c",
@@ -118,6 +122,8 @@ esp_h264_sources = [
     "interface/include/src/esp_h264_version.c",
     "interface/include/src/esp_h264_dec.c",
     "interface/include/src/esp_h264_enc_single.c",
+    "interface/include/src/esp_h264_enc_async.c",   # File d'encodage asynchrone (tâche dédiée)
+    "interface/include/src/esp_h264_enc_roi_ctrl.c",  # Régions ROI suivies depuis les détections
 ]
 
 if os.path.exists(esp_h264_dir):
@@ -29,10 +29,14 @@ extern "C" {
 #define VIDIOC_S_MOTOR_FMT  _IOWR('V',  BASE_VIDIOC_PRIVATE + 4, esp_cam_motor_format_t)
 #define VIDIOC_G_MOTOR_FMT  _IOWR('V',  BASE_VIDIOC_PRIVATE + 5, esp_cam_motor_format_t)
 
+#define VIDIOC_QUERY_SENSOR_FMT _IOWR('V',  BASE_VIDIOC_PRIVATE + 6, esp_cam_sensor_format_array_t)
+
 #define V4L2_CID_CAMERA_AE_LEVEL        (V4L2_CID_CAMERA_CLASS_BASE + 40)
 #define V4L2_CID_CAMERA_STATS           (V4L2_CID_CAMERA_CLASS_BASE + 41)
 #define V4L2_CID_CAMERA_GROUP           (V4L2_CID_CAMERA_CLASS_BASE + 42)
 #define V4L2_CID_MOTOR_START_TIME       (V4L2_CID_CAMERA_CLASS_BASE + 43)
+#define V4L2_CID_CAMERA_FRAME_LATENCY   (V4L2_CID_CAMERA_CLASS_BASE + 44)
+#define V4L2_CID_CAMERA_FPS             (V4L2_CID_CAMERA_CLASS_BASE + 45)
 
 /**
  * @brief Use this class to call esp_cam_sensor ioctl commands directly, this is only
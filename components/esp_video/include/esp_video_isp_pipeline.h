@@ -0,0 +1,39 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: ESPRESSIF MIT
+ */
+
+#pragma once
+
+#include "esp_err.h"
+#include "esp_cam_sensor_frame_timing.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Configure the night mode of the ISP pipeline.
+ *
+ * In the dark the sensor frame rate is lowered to the night frame rate, the longer frames let the
+ * AE raise the exposure instead of the gain. The day frame rate is restored once the scene is bright
+ * again. The sensor must support V4L2_CID_CAMERA_FPS and the exposure and gain must be controlled
+ * by the ISP pipeline.
+ *
+ * @note A day_fps of 0 keeps the current sensor frame rate as the day frame rate, a frame rate
+ *       set later through VIDIOC_S_PARM becomes the new day frame rate.
+ *
+ * @param config Night mode configuration, NULL disables it and restores the day frame rate
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_STATE if the ISP pipeline is not initialized
+ *      - ESP_ERR_NOT_SUPPORTED if the sensor frame rate can't be changed
+ *      - ESP_ERR_INVALID_ARG if the configuration is invalid
+ */
+esp_err_t esp_video_isp_pipeline_set_night_mode(const esp_cam_sensor_night_mode_config_t *config);
+
+#ifdef __cplusplus
+}
+#endif
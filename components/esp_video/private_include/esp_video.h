@@ -291,6 +291,20 @@ esp_err_t esp_video_done_element(struct esp_video *video, uint32_t type, struct
  */
 esp_err_t esp_video_done_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n);
 
+/**
+ * @brief Process a video buffer element's payload which is written by a DMA and not touched by the CPU.
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ * @param buffer Video buffer element's payload
+ * @param n      Video buffer element's payload valid data size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_done_dma_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n);
+
 /**
  * @brief Receive buffer element from video device.
  *
@@ -330,6 +344,23 @@ esp_err_t esp_video_queue_element(struct esp_video *video, uint32_t type, struct
  */
 esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type, int index);
 
+/**
+ * @brief Set the cache state of a buffer element payload, before it is queued.
+ *
+ * @param video       Video object
+ * @param type        Video stream type
+ * @param index       Video buffer element index
+ * @param cache_state Cache state of the payload
+ * @param offset      Offset of the range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE
+ * @param size        Size of the range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_set_element_index_cache_state(struct esp_video *video, uint32_t type, int index,
+        enum esp_video_buffer_cache_state cache_state, uint32_t offset, uint32_t size);
+
 /**
  * @brief Put buffer element index into queued list.
  *
@@ -568,6 +599,18 @@ esp_err_t esp_video_set_sensor_format(struct esp_video *video, const esp_cam_sen
  */
 esp_err_t esp_video_get_sensor_format(struct esp_video *video, esp_cam_sensor_format_t *format);
 
+/**
+ * @brief Query the formats supported by sensor
+ *
+ * @param video        Video object
+ * @param format_array Sensor format array pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array);
+
 /**
  * @brief Query menu value
  *
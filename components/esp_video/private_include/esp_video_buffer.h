@@ -26,6 +26,8 @@ extern "C" {
 #define ELEMENT_SET_ALLOCATED(e)            { (e)->free = false; }
 #define ELEMENT_IS_FREE(e)                  ((e)->free == true)
 
+#define ELEMENT_SET_CACHE_STATE(e, s, o, n) { (e)->cache_state = (s); (e)->dirty_offset = (o); (e)->dirty_size = (n); }
+
 struct esp_video_buffer_element;
 
 /**
@@ -41,6 +43,15 @@ typedef TAILQ_HEAD(esp_video_buffer_list, esp_video_buffer_element) esp_video_bu
 
 struct esp_video_buffer;
 
+/**
+ * @brief Cache state of a video buffer element payload.
+ */
+enum esp_video_buffer_cache_state {
+    ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY = 0,           /*!< The CPU may have written the whole payload, it must be written back before a DMA reads it */
+    ESP_VIDEO_BUFFER_CACHE_DMA_CLEAN,               /*!< A DMA wrote the payload and the CPU did not, no cache write back is needed */
+    ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE,         /*!< The CPU only wrote "dirty_size" bytes at "dirty_offset" */
+};
+
 /**
  * @brief Video buffer information object.
  */
@@ -64,6 +75,10 @@ struct esp_video_buffer_element {
     uint8_t *buffer;                                  /*!< Buffer space to fill data */
 
     uint32_t valid_size;                              /*!< Valid data size */
+
+    enum esp_video_buffer_cache_state cache_state;    /*!< Cache state of the payload */
+    uint32_t dirty_offset;                            /*!< Offset of the payload range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE */
+    uint32_t dirty_size;                              /*!< Size of the payload range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE */
 };
 
 /**
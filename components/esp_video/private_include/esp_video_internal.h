@@ -83,6 +83,7 @@ extern "C" {
 #define CAPTURE_VIDEO_BUF_SIZE(v)           STREAM_BUFFER_SIZE(CAPTURE_VIDEO_STREAM(v))
 
 #define CAPTURE_VIDEO_DONE_BUF(v, b, n)     esp_video_done_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b, n)
+#define CAPTURE_VIDEO_DONE_DMA_BUF(v, b, n) esp_video_done_dma_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b, n)
 #define CAPTURE_VIDEO_SKIP_BUF(v, b)        esp_video_skip_buffer(v, V4L2_BUF_TYPE_VIDEO_CAPTURE, b)
 
 #define CAPTURE_VIDEO_PARAM(v)              STREAM_PARAM(CAPTURE_VIDEO_STREAM(v))
@@ -270,6 +271,7 @@ enum esp_video_event {
 
 struct esp_video;
 struct esp_video_stream;
+struct esp_video_buffer_element;
 
 /**
  * @brief M2M video device process function
@@ -277,6 +279,7 @@ struct esp_video_stream;
  * @param video         Video object
  * @param src           Source data buffer
  * @param src_size      Source data size in byte
+ * @param src_element   Source buffer element, it tells which part of the source the CPU may hold in cache
  * @param dst           Destination buffer
  * @param dst_size      Destination buffer maximum size
  * @param dst_out_size  Actual destination data size
@@ -285,7 +288,8 @@ struct esp_video_stream;
  *      - ESP_OK on success
  *      - Others if failed
  */
-typedef esp_err_t (*esp_video_m2m_process_t)(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size);
+typedef esp_err_t (*esp_video_m2m_process_t)(struct esp_video *video, uint8_t *src, uint32_t src_size, const struct esp_video_buffer_element *src_element,
+        uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size);
 
 /**
  * @brief Video operations object.
@@ -340,6 +344,10 @@ struct esp_video_ops {
 
     esp_err_t (*get_sensor_format)(struct esp_video *video, esp_cam_sensor_format_t *format);
 
+    /*!< Query the formats supported by sensor */
+
+    esp_err_t (*query_sensor_format)(struct esp_video *video, esp_cam_sensor_format_array_t *format_array);
+
     /*!< Query menu value */
 
     esp_err_t (*query_menu)(struct esp_video *video, struct v4l2_querymenu *qmenu);
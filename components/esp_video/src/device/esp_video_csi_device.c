@@ -247,7 +247,7 @@ static bool IRAM_ATTR csi_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
     struct csi_video *csi_video = VIDEO_PRIV_DATA(struct csi_video *, video);
     if (trans->buffer != csi_video->element->buffer) {
         if (!param->skip_count) {
-            CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+            CAPTURE_VIDEO_DONE_DMA_BUF(video, trans->buffer, trans->received_size);
         } else {
             CAPTURE_VIDEO_SKIP_BUF(video, trans->buffer);
         }
@@ -258,7 +258,7 @@ static bool IRAM_ATTR csi_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
     }
 #else
     if (!param->skip_count) {
-        CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+        CAPTURE_VIDEO_DONE_DMA_BUF(video, trans->buffer, trans->received_size);
     } else {
         CAPTURE_VIDEO_SKIP_BUF(video, trans->buffer);
     }
@@ -555,6 +555,8 @@ static esp_err_t csi_video_notify(struct esp_video *video, enum esp_video_event
                                                element->buffer, CAPTURE_VIDEO_BUF_SIZE(video), &ret_size);
             if (ret == ESP_OK) {
                 element->valid_size = ret_size;
+                /* The CPU swapped the payload in place */
+                ELEMENT_SET_CACHE_STATE(element, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY, 0, 0);
             }
         }
     }
@@ -601,6 +603,13 @@ static esp_err_t csi_video_get_sensor_format(struct esp_video *video, esp_cam_se
     return esp_cam_sensor_get_format(csi_video->cam.sensor, format);
 }
 
+static esp_err_t csi_video_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array)
+{
+    struct csi_video *csi_video = VIDEO_PRIV_DATA(struct csi_video *, video);
+
+    return esp_cam_sensor_query_format(csi_video->cam.sensor, format_array);
+}
+
 static esp_err_t csi_video_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
 {
     struct csi_video *csi_video = VIDEO_PRIV_DATA(struct csi_video *, video);
@@ -628,11 +637,16 @@ static esp_err_t csi_video_get_parm(struct esp_video *video, struct v4l2_streamp
     struct v4l2_captureparm *cp = &stream_parm->parm.capture;
     esp_cam_sensor_format_t sensor_format;
     struct esp_video_param *param = &stream->param;
+    uint32_t fps;
 
     ESP_RETURN_ON_ERROR(esp_cam_sensor_get_format(csi_video->cam.sensor, &sensor_format), TAG, "failed to get sensor format");
     cp->capability |= V4L2_CAP_TIMEPERFRAME;
     cp->timeperframe.numerator = 1;
-    cp->timeperframe.denominator = sensor_format.fps;
+    if (esp_cam_sensor_get_para_value(csi_video->cam.sensor, ESP_CAM_SENSOR_FPS, &fps, sizeof(fps)) == ESP_OK && fps) {
+        cp->timeperframe.denominator = fps;
+    } else {
+        cp->timeperframe.denominator = sensor_format.fps;
+    }
     if (param->skip_frames > 0) {
         cp->timeperframe.denominator /= param->skip_frames;
     }
@@ -656,7 +670,28 @@ static esp_err_t csi_video_set_parm(struct esp_video *video, struct v4l2_streamp
 
         ESP_RETURN_ON_ERROR(esp_cam_sensor_get_format(csi_video->cam.sensor, &sensor_format), TAG, "failed to get sensor format");
 
-        if ((cp->timeperframe.denominator > sensor_format.fps) ||
+        /* Sensors with a frame rate control stretch their frames, no frame is captured and dropped */
+        esp_cam_sensor_param_desc_t qdesc = {
+            .id = ESP_CAM_SENSOR_FPS,
+        };
+        if (esp_cam_sensor_query_para_desc(csi_video->cam.sensor, &qdesc) == ESP_OK) {
+            bool in_range = cp->timeperframe.denominator >= qdesc.number.minimum &&
+                            cp->timeperframe.denominator <= qdesc.number.maximum;
+            /* Out of range rates drop frames from the full format rate */
+            uint32_t fps = in_range ? cp->timeperframe.denominator : sensor_format.fps;
+
+            ESP_RETURN_ON_ERROR(esp_cam_sensor_set_para_value(csi_video->cam.sensor, ESP_CAM_SENSOR_FPS, &fps, sizeof(fps)),
+                                TAG, "failed to set sensor fps");
+            ESP_LOGD(TAG, "sensor fps=%" PRIu32, fps);
+            if (in_range) {
+                param->skip_frames = 0;
+                param->skip_count = 0;
+                return ESP_OK;
+            }
+        }
+
+        if ((cp->timeperframe.denominator == 0) ||
+                (cp->timeperframe.denominator > sensor_format.fps) ||
                 (sensor_format.fps % cp->timeperframe.denominator != 0)) {
             ESP_LOGE(TAG, "denominator=%" PRIu32 " is invalid", cp->timeperframe.denominator);
             return ESP_ERR_INVALID_ARG;
@@ -683,6 +718,7 @@ static const struct esp_video_ops s_csi_video_ops = {
     .query_ext_ctrl = csi_video_query_ext_ctrl,
     .set_sensor_format = csi_video_set_sensor_format,
     .get_sensor_format = csi_video_get_sensor_format,
+    .query_sensor_format = csi_video_query_sensor_format,
     .query_menu    = csi_video_query_menu,
     .set_motor_format = csi_video_set_motor_format,
     .get_motor_format = csi_video_get_motor_format,
@@ -115,7 +115,7 @@ static bool IRAM_ATTR dvp_video_on_trans_finished(esp_cam_ctlr_handle_t handle,
 
     ESP_EARLY_LOGD(TAG, "size=%d", (int)trans->received_size);
 
-    CAPTURE_VIDEO_DONE_BUF(video, trans->buffer, trans->received_size);
+    CAPTURE_VIDEO_DONE_DMA_BUF(video, trans->buffer, trans->received_size);
 
     return true;
 }
@@ -393,6 +393,8 @@ static esp_err_t dvp_video_notify(struct esp_video *video, enum esp_video_event
                                               element->buffer, CAPTURE_VIDEO_BUF_SIZE(video), &ret_size);
             if (ret == ESP_OK) {
                 element->valid_size = ret_size;
+                /* The CPU swapped the payload in place */
+                ELEMENT_SET_CACHE_STATE(element, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY, 0, 0);
             }
         }
     }
@@ -439,6 +441,13 @@ static esp_err_t dvp_video_get_sensor_format(struct esp_video *video, esp_cam_se
     return esp_cam_sensor_get_format(dvp_video->cam.sensor, format);
 }
 
+static esp_err_t dvp_video_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array)
+{
+    struct dvp_video *dvp_video = VIDEO_PRIV_DATA(struct dvp_video *, video);
+
+    return esp_cam_sensor_query_format(dvp_video->cam.sensor, format_array);
+}
+
 static esp_err_t dvp_video_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
 {
     struct dvp_video *dvp_video = VIDEO_PRIV_DATA(struct dvp_video *, video);
@@ -473,6 +482,7 @@ static const struct esp_video_ops s_dvp_video_ops = {
     .query_ext_ctrl = dvp_video_query_ext_ctrl,
     .set_sensor_format = dvp_video_set_sensor_format,
     .get_sensor_format = dvp_video_get_sensor_format,
+    .query_sensor_format = dvp_video_query_sensor_format,
     .query_menu    = dvp_video_query_menu,
     .get_parm      = dvp_video_get_parm,
 };
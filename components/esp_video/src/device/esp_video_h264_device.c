@@ -97,14 +97,31 @@ static esp_err_t h264_get_input_format_from_v4l2(uint32_t v4l2_format, esp_h264_
     return ret;
 }
 
-static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+static esp_h264_cache_state_t h264_get_cache_state(enum esp_video_buffer_cache_state cache_state)
+{
+    switch (cache_state) {
+    case ESP_VIDEO_BUFFER_CACHE_DMA_CLEAN:
+        return ESP_H264_CACHE_DMA_CLEAN;
+    case ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE:
+        return ESP_H264_CACHE_CPU_DIRTY_RANGE;
+    default:
+        return ESP_H264_CACHE_CPU_DIRTY;
+    }
+}
+
+static esp_err_t h264_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, const struct esp_video_buffer_element *src_element,
+                                        uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
     esp_h264_err_t h264_err;
+    /* Only the part of the source the CPU wrote is written back from the cache */
     esp_h264_enc_in_frame_t in_frame = {
         .raw_data = {
             .buffer = src,
             .len = src_size,
-        }
+        },
+        .cache_state = h264_get_cache_state(src_element->cache_state),
+        .dirty_offset = src_element->dirty_offset,
+        .dirty_len = src_element->dirty_size,
     };
     esp_h264_enc_out_frame_t out_frame = {
         .raw_data = {
@@ -350,6 +367,12 @@ static esp_err_t h264_video_set_ext_ctrl(struct esp_video *video, const struct v
         case V4L2_CID_MPEG_VIDEO_H264_MAX_QP:
             h264_video->max_qp = ctrl->value;
             break;
+        case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+            /* Before streaming, the first frame is an IDR frame anyway */
+            if (h264_video->enc_handle) {
+                ret = errno_h264_to_std(esp_h264_enc_force_idr(h264_video->enc_handle));
+            }
+            break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -381,6 +404,9 @@ static esp_err_t h264_video_get_ext_ctrl(struct esp_video *video, struct v4l2_ex
         case V4L2_CID_MPEG_VIDEO_H264_MAX_QP:
             ctrl->value = h264_video->max_qp;
             break;
+        case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+            ctrl->value = 0;
+            break;
         default:
             ret = ESP_ERR_NOT_SUPPORTED;
             ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", ctrl->id);
@@ -440,6 +466,15 @@ static esp_err_t h264_video_query_ext_ctrl(struct esp_video *video, struct v4l2_
         qctrl->nr_of_dims = 0;
         qctrl->default_value = H264_VIDEO_DEVICE_MAX_QP;
         break;
+    case V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME:
+        qctrl->type = V4L2_CTRL_TYPE_BUTTON;
+        qctrl->maximum = 1;
+        qctrl->minimum = 0;
+        qctrl->step = 1;
+        qctrl->elems = 1;
+        qctrl->nr_of_dims = 0;
+        qctrl->default_value = 0;
+        break;
     default:
         ret = ESP_ERR_NOT_SUPPORTED;
         ESP_LOGE(TAG, "id=%" PRIx32 " is not supported", qctrl->id);
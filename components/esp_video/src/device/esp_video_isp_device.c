@@ -180,6 +180,7 @@ struct isp_video {
 
     uint64_t seq;
     esp_video_isp_stats_t *stats_buffer;
+    bool stream_start;              /* Tag the next statistics with ESP_VIDEO_ISP_STATS_FLAG_START */
 #endif
 };
 
@@ -505,6 +506,10 @@ static esp_err_t isp_stats_done(struct isp_video *isp_video, const void *buffer,
         target_flags |= ISP_STATS_AWB_FLAG;
     }
     if ((isp_video->stats_buffer->flags & target_flags) == target_flags) {
+        if (isp_video->stream_start) {
+            isp_video->stats_buffer->flags |= ESP_VIDEO_ISP_STATS_FLAG_START;
+            isp_video->stream_start = false;
+        }
         isp_video->stats_buffer->seq = isp_video->seq++;
         META_VIDEO_DONE_BUF(isp_video->video, isp_video->stats_buffer, sizeof(esp_video_isp_stats_t));
         isp_video->stats_buffer = NULL;
@@ -1993,6 +1998,11 @@ esp_err_t esp_video_isp_start_by_csi(const esp_video_csi_state_t *state, const s
 
         META_VIDEO_SET_FORMAT(isp_video->video, width, height, V4L2_META_FMT_ESP_ISP_STATS);
         ESP_GOTO_ON_ERROR(isp_start_pipeline(isp_video), fail_3, TAG, "failed to start ISP pipeline");
+
+        /* Tell the ISP pipeline controller that the sensor state it tracks starts over */
+        portENTER_CRITICAL(&isp_video->spinlock);
+        isp_video->stream_start = true;
+        portEXIT_CRITICAL(&isp_video->spinlock);
 #endif
     }
 
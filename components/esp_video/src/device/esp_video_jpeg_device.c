@@ -94,7 +94,8 @@ static uint32_t jpeg_capture_size(uint32_t output_size)
     return ESP_VIDEO_ALIGN((uint32_t)(output_size * JPEG_MAX_COMP_RATE), alignments);
 }
 
-static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
+static esp_err_t jpeg_video_m2m_process(struct esp_video *video, uint8_t *src, uint32_t src_size, const struct esp_video_buffer_element *src_element,
+                                        uint8_t *dst, uint32_t dst_size, uint32_t *dst_out_size)
 {
     esp_err_t ret;
     uint32_t jpeg_codeced_size;
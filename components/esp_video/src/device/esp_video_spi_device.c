@@ -320,6 +320,13 @@ static esp_err_t spi_video_get_sensor_format(struct esp_video *video, esp_cam_se
     return esp_cam_sensor_get_format(spi_video->cam.sensor, format);
 }
 
+static esp_err_t spi_video_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array)
+{
+    struct spi_video *spi_video = VIDEO_PRIV_DATA(struct spi_video *, video);
+
+    return esp_cam_sensor_query_format(spi_video->cam.sensor, format_array);
+}
+
 static esp_err_t spi_video_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
 {
     struct spi_video *spi_video = VIDEO_PRIV_DATA(struct spi_video *, video);
@@ -354,6 +361,7 @@ static const struct esp_video_ops s_spi_video_ops = {
     .query_ext_ctrl = spi_video_query_ext_ctrl,
     .set_sensor_format = spi_video_set_sensor_format,
     .get_sensor_format = spi_video_get_sensor_format,
+    .query_sensor_format = spi_video_query_sensor_format,
     .query_menu    = spi_video_query_menu,
     .get_parm      = spi_video_get_parm,
 };
@@ -1018,19 +1018,8 @@ esp_err_t IRAM_ATTR esp_video_done_element(struct esp_video *video, uint32_t typ
     return ESP_OK;
 }
 
-/**
- * @brief Process a video buffer element's payload which receives data done.
- *
- * @param video  Video object
- * @param type   Video stream type
- * @param buffer Video buffer element's payload
- * @param n      Video buffer element's payload valid data size
- *
- * @return
- *      - ESP_OK on success
- *      - Others if failed
- */
-esp_err_t IRAM_ATTR esp_video_done_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n)
+static esp_err_t IRAM_ATTR esp_video_done_buffer_cache_state(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n,
+        enum esp_video_buffer_cache_state cache_state)
 {
     esp_err_t ret;
     struct esp_video_stream *stream;
@@ -1044,6 +1033,7 @@ esp_err_t IRAM_ATTR esp_video_done_buffer(struct esp_video *video, uint32_t type
     element = esp_video_buffer_get_element_by_buffer(stream->buffer, buffer);
     if (element) {
         element->valid_size = n;
+        ELEMENT_SET_CACHE_STATE(element, cache_state, 0, 0);
         ret = esp_video_done_element(video, type, element);
         if (ret != ESP_OK) {
             return ret;
@@ -1055,6 +1045,40 @@ esp_err_t IRAM_ATTR esp_video_done_buffer(struct esp_video *video, uint32_t type
     return ESP_OK;
 }
 
+/**
+ * @brief Process a video buffer element's payload which receives data done.
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ * @param buffer Video buffer element's payload
+ * @param n      Video buffer element's payload valid data size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t IRAM_ATTR esp_video_done_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n)
+{
+    return esp_video_done_buffer_cache_state(video, type, buffer, n, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY);
+}
+
+/**
+ * @brief Process a video buffer element's payload which is written by a DMA and not touched by the CPU.
+ *
+ * @param video  Video object
+ * @param type   Video stream type
+ * @param buffer Video buffer element's payload
+ * @param n      Video buffer element's payload valid data size
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t IRAM_ATTR esp_video_done_dma_buffer(struct esp_video *video, uint32_t type, uint8_t *buffer, uint32_t n)
+{
+    return esp_video_done_buffer_cache_state(video, type, buffer, n, ESP_VIDEO_BUFFER_CACHE_DMA_CLEAN);
+}
+
 /**
  * @brief Put buffer element into queued list.
  *
@@ -1122,6 +1146,37 @@ esp_err_t esp_video_queue_element_index(struct esp_video *video, uint32_t type,
     return ret;
 }
 
+/**
+ * @brief Set the cache state of a buffer element payload, before it is queued.
+ *
+ * @param video       Video object
+ * @param type        Video stream type
+ * @param index       Video buffer element index
+ * @param cache_state Cache state of the payload
+ * @param offset      Offset of the range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE
+ * @param size        Size of the range written by the CPU, for ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_set_element_index_cache_state(struct esp_video *video, uint32_t type, int index,
+        enum esp_video_buffer_cache_state cache_state, uint32_t offset, uint32_t size)
+{
+    struct esp_video_stream *stream;
+    struct esp_video_buffer_element *element;
+
+    stream = esp_video_get_stream(video, type);
+    if (!stream || !stream->buffer || (index >= stream->buffer->info.count)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    element = ESP_VIDEO_BUFFER_ELEMENT(stream->buffer, index);
+    ELEMENT_SET_CACHE_STATE(element, cache_state, offset, size);
+
+    return ESP_OK;
+}
+
 /**
  * @brief Put buffer element index into queued list.
  *
@@ -1440,6 +1495,7 @@ struct esp_video_buffer_element *esp_video_clone_element(struct esp_video *video
     if (new_element) {
         new_element->valid_size = element->valid_size;
         memcpy(new_element->buffer, element->buffer, element->valid_size);
+        ELEMENT_SET_CACHE_STATE(new_element, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY, 0, 0);
     }
 
     return new_element;
@@ -1608,7 +1664,7 @@ esp_err_t esp_video_m2m_process(struct esp_video *video, uint32_t src_type, uint
         return ret;
     }
 
-    ret = proc(video, ELEMENT_BUFFER(src_element), ELEMENT_SIZE(src_element),
+    ret = proc(video, ELEMENT_BUFFER(src_element), ELEMENT_SIZE(src_element), src_element,
                ELEMENT_BUFFER(dst_element), ELEMENT_SIZE(dst_element), &dst_out_size);
     if (ret != ESP_OK) {
         dst_element->valid_size = 0;
@@ -1684,6 +1740,36 @@ esp_err_t esp_video_get_sensor_format(struct esp_video *video, esp_cam_sensor_fo
     return ESP_OK;
 }
 
+/**
+ * @brief Query the formats supported by sensor
+ *
+ * @param video        Video object
+ * @param format_array Sensor format array pointer
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array)
+{
+    esp_err_t ret;
+
+    CHECK_VIDEO_OBJ(video);
+
+    if (video->ops->query_sensor_format) {
+        ret = video->ops->query_sensor_format(video, format_array);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "video->ops->query_sensor_format=%x", ret);
+            return ret;
+        }
+    } else {
+        ESP_LOGD(TAG, "video->ops->query_sensor_format=NULL");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    return ESP_OK;
+}
+
 /**
  * @brief Query menu value
  *
@@ -152,5 +152,6 @@ void esp_video_buffer_reset(struct esp_video_buffer *buffer)
     for (int i = 0; i < buffer->info.count; i++) {
         ELEMENT_SET_FREE(&buffer->element[i]);
         buffer->element[i].valid_size = 0;
+        ELEMENT_SET_CACHE_STATE(&buffer->element[i], ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY, 0, 0);
     }
 }
@@ -59,6 +59,14 @@ static const struct control_map s_sensor_control_map_table[] = {
         .esp_cam_priv_id = ESP_CAM_SENSOR_EXPOSURE_US,
         .v4l2_id = V4L2_CID_EXPOSURE_ABSOLUTE,
     },
+    {
+        .esp_cam_priv_id = ESP_CAM_SENSOR_FRAME_LATENCY,
+        .v4l2_id = V4L2_CID_CAMERA_FRAME_LATENCY,
+    },
+    {
+        .esp_cam_priv_id = ESP_CAM_SENSOR_FPS,
+        .v4l2_id = V4L2_CID_CAMERA_FPS,
+    },
     {
         .esp_cam_priv_id = ESP_CAM_SENSOR_JPEG_QUALITY,
         .v4l2_id = V4L2_CID_JPEG_COMPRESSION_QUALITY,
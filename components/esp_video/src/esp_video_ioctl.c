@@ -164,6 +164,23 @@ static esp_err_t esp_video_ioctl_qbuf(struct esp_video *video, struct v4l2_buffe
         }
     }
 
+    /*
+     * An output buffer handed over from a capture device (V4L2_BUF_FLAG_NO_CACHE_CLEAN) was written
+     * by a DMA only, otherwise the CPU wrote its "bytesused" first bytes or the whole buffer.
+     */
+    if (V4L2_TYPE_IS_OUTPUT(vbuf->type)) {
+        if (vbuf->flags & V4L2_BUF_FLAG_NO_CACHE_CLEAN) {
+            ret = esp_video_set_element_index_cache_state(video, vbuf->type, vbuf->index, ESP_VIDEO_BUFFER_CACHE_DMA_CLEAN, 0, 0);
+        } else if (vbuf->bytesused && (vbuf->bytesused < info.size)) {
+            ret = esp_video_set_element_index_cache_state(video, vbuf->type, vbuf->index, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY_RANGE, 0, vbuf->bytesused);
+        } else {
+            ret = esp_video_set_element_index_cache_state(video, vbuf->type, vbuf->index, ESP_VIDEO_BUFFER_CACHE_CPU_DIRTY, 0, 0);
+        }
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+
     if (info.memory_type == V4L2_MEMORY_MMAP) {
         ret = esp_video_queue_element_index(video, vbuf->type, vbuf->index);
     } else {
@@ -202,6 +219,10 @@ static esp_err_t esp_video_ioctl_dqbuf(struct esp_video *video, struct v4l2_buff
     } else {
         vbuf->flags |= V4L2_BUF_FLAG_DONE;
     }
+    /* Queue the payload to an M2M device with this flag to skip its cache write back */
+    if (element->cache_state == ESP_VIDEO_BUFFER_CACHE_DMA_CLEAN) {
+        vbuf->flags |= V4L2_BUF_FLAG_NO_CACHE_CLEAN;
+    }
     if (vbuf->memory != V4L2_MEMORY_USERPTR) {
         vbuf->m.userptr = (unsigned long)element->buffer;
         vbuf->flags |= V4L2_BUF_FLAG_MAPPED;
@@ -235,6 +256,11 @@ static inline esp_err_t esp_video_ioctl_get_sensor_format(struct esp_video *vide
     return esp_video_get_sensor_format(video, format);
 }
 
+static inline esp_err_t esp_video_ioctl_query_sensor_format(struct esp_video *video, esp_cam_sensor_format_array_t *format_array)
+{
+    return esp_video_query_sensor_format(video, format_array);
+}
+
 static inline esp_err_t esp_video_ioctl_query_menu(struct esp_video *video, struct v4l2_querymenu *qmenu)
 {
     return esp_video_query_menu(video, qmenu);
@@ -348,6 +374,9 @@ esp_err_t esp_video_ioctl(struct esp_video *video, int cmd, va_list args)
     case VIDIOC_G_SENSOR_FMT:
         ret = esp_video_ioctl_get_sensor_format(video, (esp_cam_sensor_format_t *)arg_ptr);
         break;
+    case VIDIOC_QUERY_SENSOR_FMT:
+        ret = esp_video_ioctl_query_sensor_format(video, (esp_cam_sensor_format_array_t *)arg_ptr);
+        break;
     case VIDIOC_QUERYMENU:
         ret = esp_video_ioctl_query_menu(video, (struct v4l2_querymenu *)arg_ptr);
         break;
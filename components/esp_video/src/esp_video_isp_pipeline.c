@@ -20,6 +20,7 @@
 #include "freertos/queue.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 
 #include "linux/videodev2.h"
 #include "esp_video_pipeline_isp.h"
@@ -28,6 +29,9 @@
 #include "esp_video_device_internal.h"
 #include "esp_ipa.h"
 #include "esp_cam_sensor.h"
+#include "esp_cam_sensor_delayed_ctrl.h"
+#include "esp_cam_sensor_frame_timing.h"
+#include "esp_video_isp_pipeline.h"
 
 #define ISP_METADATA_BUFFER_COUNT   2
 #define ISP_TASK_PRIORITY           11
@@ -39,6 +43,9 @@
 #define TLINE_NS_UNIT               1000
 #define REG_TO_US(reg, isp)         ((reg) * (isp)->sensor_tline_ns / TLINE_NS_UNIT)
 
+/* A group written this close to the next frame start may miss it and be latched one frame later */
+#define SENSOR_WRITE_GUARD_US       1000
+
 typedef struct esp_video_isp {
     int isp_fd;
     esp_video_isp_stats_t *isp_stats[ISP_METADATA_BUFFER_COUNT];
@@ -62,6 +69,30 @@ typedef struct esp_video_isp {
     uint32_t prev_exposure_val;
     uint32_t sensor_tline_ns;
 
+    /* Sensor control latency model, NULL if the sensor does not report its latency */
+    esp_cam_sensor_delayed_ctrl_handle_t delayed_ctrl;
+    uint32_t frame_seq;             /*!< Sequence of the last frame whose statistics arrived */
+    int64_t frame_end_us;           /*!< Time the statistics of that frame arrived */
+    uint32_t frame_us;
+    uint32_t sensor_vts;
+    int32_t base_gain;              /*!< Gain menu value of 1x */
+    int32_t applied_gain_index;     /*!< Gain index of the last frame, avoids querying the gain menu every frame */
+
+    /* Sensor frame rate, the exposure limit follows the frame length */
+    esp_cam_sensor_frame_timing_t frame_timing;
+    uint32_t sensor_fps;
+    uint32_t min_fps;
+    uint32_t day_fps;               /*!< Frame rate set by the application, night mode falls back to it */
+    uint32_t set_fps;               /*!< Last frame rate set by night mode, other changes come from the application */
+    esp_cam_sensor_night_mode_t night_mode;
+    bool night_mode_en;
+
+    /* Night mode configuration waiting for the ISP task */
+    portMUX_TYPE night_mode_lock;
+    esp_cam_sensor_night_mode_t night_mode_next;
+    bool night_mode_next_en;
+    bool night_mode_update;
+
     struct {
         uint8_t gain        : 1;
         uint8_t exposure    : 1;
@@ -70,6 +101,7 @@ typedef struct esp_video_isp {
         uint8_t group       : 1;
         uint8_t ae_level    : 1;
         uint8_t af_stime    : 1;
+        uint8_t fps         : 1;
     } sensor_attr;
 
     TaskHandle_t task_handler;
@@ -436,6 +468,74 @@ static void config_color(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
     }
 }
 
+/**
+ * @brief Get the frame sequence a sensor write issued now is latched in
+ *
+ * @param isp ISP pointer
+ *
+ * @return Frame sequence
+ */
+static uint32_t sensor_write_seq(esp_video_isp_t *isp)
+{
+    /* Statistics arrive at the end of frame_seq, so the sensor is already exposing the next frame */
+    uint32_t seq = isp->frame_seq + 1;
+    int64_t elapsed_us = esp_timer_get_time() - isp->frame_end_us;
+
+    if (elapsed_us + SENSOR_WRITE_GUARD_US >= isp->frame_us) {
+        seq++;
+    }
+
+    return seq;
+}
+
+/**
+ * @brief Report the exposure and gain the last frame was captured with to the IPA
+ *
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void apply_delayed_ctrl(esp_video_isp_t *isp)
+{
+    esp_cam_sensor_ae_ctrl_t ctrl;
+
+    if (esp_cam_sensor_delayed_ctrl_get(isp->delayed_ctrl, isp->frame_seq, &ctrl) != ESP_OK) {
+        return;
+    }
+
+    isp->sensor.cur_exposure = REG_TO_US(ctrl.exposure_val, isp);
+
+    if ((int32_t)ctrl.gain_index != isp->applied_gain_index) {
+        struct v4l2_querymenu qmenu;
+
+        qmenu.id = V4L2_CID_GAIN;
+        qmenu.index = ctrl.gain_index;
+        if (ioctl(isp->cam_fd, VIDIOC_QUERYMENU, &qmenu) == 0) {
+            isp->sensor.cur_gain = (float)qmenu.value / isp->base_gain;
+            isp->applied_gain_index = ctrl.gain_index;
+        }
+    }
+}
+
+/**
+ * @brief Drop the control history when the stream starts, the sensor restarts from the values last written
+ *
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void reset_delayed_ctrl(esp_video_isp_t *isp)
+{
+    esp_cam_sensor_ae_ctrl_t init = {
+        .exposure_val = isp->prev_exposure_val,
+        .gain_index = isp->prev_gain_index,
+        .vts = isp->sensor_vts,
+    };
+
+    esp_cam_sensor_delayed_ctrl_reset(isp->delayed_ctrl, &init);
+    isp->applied_gain_index = -1;
+}
+
 static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *metadata)
 {
     float target_gain = 0.0;
@@ -580,6 +680,20 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         }
     }
 
+    /**
+     * With the latency model every update goes through the group, so that exposure and gain
+     * written alone are tracked too, the unchanged one keeps its previous value.
+     */
+    if (isp->delayed_ctrl && (metadata->flags & (IPA_METADATA_FLAGS_ET | IPA_METADATA_FLAGS_GN))) {
+        if (!(metadata->flags & IPA_METADATA_FLAGS_ET)) {
+            exposure_val = isp->prev_exposure_val;
+        }
+        if (!(metadata->flags & IPA_METADATA_FLAGS_GN)) {
+            gain_index = isp->prev_gain_index;
+        }
+        metadata->flags |= IPA_METADATA_FLAGS_ET | IPA_METADATA_FLAGS_GN;
+    }
+
     if ((metadata->flags & IPA_METADATA_FLAGS_ET) &&
             (metadata->flags & IPA_METADATA_FLAGS_GN) &&
             isp->sensor_attr.group) {
@@ -588,6 +702,7 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         group.exposure_us = 0;
         group.exposure_val = exposure_val;
         group.gain_index = gain_index;
+        group.vts = 0;
 
         controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
         controls.count      = 1;
@@ -597,6 +712,17 @@ static void config_exposure_and_gain(esp_video_isp_t *isp, esp_ipa_metadata_t *m
         control[0].size     = sizeof(esp_cam_sensor_gh_exp_gain_t);
         if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
             ESP_LOGE(TAG, "failed to set group");
+        } else if (isp->delayed_ctrl) {
+            /* The IPA sees the new values when the first frame captured with them comes back */
+            esp_cam_sensor_ae_ctrl_t ctrl = {
+                .exposure_val = exposure_val,
+                .gain_index = gain_index,
+                .vts = isp->sensor_vts,
+            };
+
+            esp_cam_sensor_delayed_ctrl_push(isp->delayed_ctrl, sensor_write_seq(isp), &ctrl);
+            isp->prev_exposure_val = exposure_val;
+            isp->prev_gain_index = gain_index;
         } else {
             isp->sensor.cur_exposure = REG_TO_US(exposure_val, isp);
             isp->prev_exposure_val = exposure_val;
@@ -883,6 +1009,123 @@ static void isp_stats_to_ipa_stats(esp_video_isp_stats_t *isp_stat, esp_ipa_stat
     #endif
 }
 
+/**
+ * @brief Take a sensor frame rate not set by night mode as the new day frame rate
+ *
+ * @param isp ISP pointer
+ * @param fps Sensor frame rate
+ *
+ * @return None
+ */
+static void update_day_fps(esp_video_isp_t *isp, uint32_t fps)
+{
+    if (fps == isp->set_fps) {
+        return;
+    }
+
+    /* Set by the application or by a new sensor format, it is the new day frame rate */
+    isp->day_fps = fps;
+    if (isp->night_mode_en) {
+        esp_cam_sensor_night_mode_config_t config = isp->night_mode.config;
+
+        config.day_fps = fps;
+        if (esp_cam_sensor_night_mode_init(&isp->night_mode, &config, &isp->frame_timing) != ESP_OK) {
+            ESP_LOGW(TAG, "night mode disabled, %"PRIu32" fps is not above the night frame rate", fps);
+            isp->night_mode_en = false;
+        }
+    }
+}
+
+/**
+ * @brief Follow the sensor frame rate, the longest exposure the IPA can use depends on it
+ *
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void get_sensor_fps(esp_video_isp_t *isp)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_CAMERA_FPS;
+    control[0].value    = 0;
+    if (ioctl(isp->cam_fd, VIDIOC_G_EXT_CTRLS, &controls) != 0 || control[0].value <= 0 ||
+            control[0].value == isp->sensor_fps) {
+        return;
+    }
+
+    uint32_t fps = control[0].value;
+    uint32_t vts = esp_cam_sensor_frame_timing_vts(&isp->frame_timing, fps);
+
+    isp->sensor_fps = fps;
+    isp->sensor_vts = vts;
+    isp->frame_us = esp_cam_sensor_frame_timing_frame_us(&isp->frame_timing, vts);
+    isp->sensor.max_exposure = REG_TO_US(esp_cam_sensor_frame_timing_exposure_max(&isp->frame_timing, vts), isp);
+
+    update_day_fps(isp, fps);
+
+    ESP_LOGD(TAG, "Sensor %"PRIu32" fps, max exposure %"PRIu32" us", fps, isp->sensor.max_exposure);
+}
+
+/**
+ * @brief Lower the frame rate in the dark so that the exposure can grow instead of the gain
+ *
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void config_night_mode(esp_video_isp_t *isp)
+{
+    uint32_t fps;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+
+    if (isp->night_mode_update) {
+        portENTER_CRITICAL(&isp->night_mode_lock);
+        bool was_en = isp->night_mode_en;
+        isp->night_mode = isp->night_mode_next;
+        isp->night_mode_en = isp->night_mode_next_en;
+        isp->night_mode_update = false;
+        portEXIT_CRITICAL(&isp->night_mode_lock);
+
+        if (isp->night_mode_en) {
+            isp->day_fps = isp->night_mode.config.day_fps;
+        } else if (!was_en) {
+            return;
+        }
+    }
+
+    if (isp->night_mode_en) {
+        uint32_t gain = (uint32_t)(isp->sensor.cur_gain * 1000 + 0.5f);
+
+        fps = esp_cam_sensor_night_mode_update(&isp->night_mode, isp->sensor.cur_exposure, gain);
+    } else {
+        /* Disabled at night, back to the day frame rate */
+        fps = isp->day_fps;
+    }
+
+    if (fps == isp->sensor_fps || fps == isp->set_fps) {
+        return;
+    }
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_CAMERA_FPS;
+    control[0].value    = fps;
+    if (ioctl(isp->cam_fd, VIDIOC_S_EXT_CTRLS, &controls) != 0) {
+        ESP_LOGE(TAG, "failed to set frame rate");
+        return;
+    }
+
+    isp->set_fps = fps;
+    ESP_LOGI(TAG, "%s mode, %"PRIu32" fps", fps < isp->day_fps ? "Night" : "Day", fps);
+}
+
 static void get_sensor_state(esp_video_isp_t *isp, int index)
 {
     int ret;
@@ -900,6 +1143,10 @@ static void get_sensor_state(esp_video_isp_t *isp, int index)
         isp->sensor.height = format.fmt.pix.height;
     }
 
+    if (isp->sensor_attr.fps) {
+        get_sensor_fps(isp);
+    }
+
     if (isp->sensor_attr.stats) {
         struct v4l2_ext_controls controls;
         struct v4l2_ext_control control[1];
@@ -938,6 +1185,69 @@ static void get_sensor_state(esp_video_isp_t *isp, int index)
     }
 }
 
+/**
+ * @brief Get the time of one sensor line
+ *
+ * @param isp_info Sensor ISP information
+ *
+ * @return Line time in ns
+ */
+static uint32_t get_sensor_tline_ns(const esp_cam_sensor_isp_info_t *isp_info)
+{
+    uint32_t tline_ns = isp_info->isp_v1_info.tline_ns;
+
+    if (!tline_ns && isp_info->isp_v1_info.pclk) {
+        /* Not reported by every format, one line lasts HTS pixel clocks */
+        tline_ns = (uint32_t)((uint64_t)isp_info->isp_v1_info.hts * 1000000000 / isp_info->isp_v1_info.pclk);
+    }
+
+    return tline_ns;
+}
+
+static void init_frame_rate(int fd, esp_video_isp_t *isp);
+
+/**
+ * @brief Read the sensor timing again when the stream starts, the sensor format may have changed while it was stopped
+ *
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void sync_sensor_format(esp_video_isp_t *isp)
+{
+    struct v4l2_query_ext_ctrl qctrl;
+    esp_cam_sensor_format_t sensor_format;
+
+    if (ioctl(isp->cam_fd, VIDIOC_G_SENSOR_FMT, &sensor_format) != 0 || !sensor_format.isp_info) {
+        return;
+    }
+
+    if (isp->sensor_attr.exposure) {
+        uint32_t tline_ns = get_sensor_tline_ns(sensor_format.isp_info);
+
+        qctrl.id = V4L2_CID_EXPOSURE;
+        if (tline_ns && ioctl(isp->cam_fd, VIDIOC_QUERY_EXT_CTRL, &qctrl) == 0) {
+            isp->sensor_tline_ns = tline_ns;
+            isp->sensor.min_exposure = REG_TO_US(qctrl.minimum, isp);
+            isp->sensor.max_exposure = REG_TO_US(qctrl.maximum, isp);
+            isp->sensor.step_exposure = REG_TO_US(qctrl.step, isp);
+            isp->sensor.cur_exposure = REG_TO_US(isp->prev_exposure_val, isp);
+        }
+    }
+
+    if (isp->delayed_ctrl && sensor_format.fps) {
+        isp->sensor_vts = sensor_format.isp_info->isp_v1_info.vts;
+        isp->frame_us = 1000000 / sensor_format.fps;
+    }
+
+    if (isp->sensor_attr.fps) {
+        init_frame_rate(isp->cam_fd, isp);
+    }
+
+    ESP_LOGD(TAG, "Sensor format %s, tline %"PRIu32" ns, %"PRIu32" us per frame",
+             sensor_format.name, isp->sensor_tline_ns, isp->frame_us);
+}
+
 static void isp_task(void *p)
 {
     esp_err_t ret;
@@ -953,6 +1263,19 @@ static void isp_task(void *p)
             continue;
         }
 
+        /* Statistics are ready at the frame end, it is the time reference of sensor writes */
+        isp->frame_end_us = esp_timer_get_time();
+        isp->frame_seq = (uint32_t)isp->isp_stats[buf.index]->seq;
+        if (isp->isp_stats[buf.index]->flags & ESP_VIDEO_ISP_STATS_FLAG_START) {
+            sync_sensor_format(isp);
+            if (isp->delayed_ctrl) {
+                reset_delayed_ctrl(isp);
+            }
+        }
+        if (isp->delayed_ctrl) {
+            apply_delayed_ctrl(isp);
+        }
+
         get_sensor_state(isp, buf.index);
 
         isp_stats_to_ipa_stats(isp->isp_stats[buf.index], &isp->ipa_stats);
@@ -969,11 +1292,145 @@ static void isp_task(void *p)
         }
 
         config_isp_and_camera(isp, &isp->metadata);
+        if (isp->sensor_attr.fps) {
+            config_night_mode(isp);
+        }
     }
 
     vTaskDelete(NULL);
 }
 
+/**
+ * @brief Create the sensor control latency model if the sensor reports its latency.
+ *
+ * @param fd  Camera device file description
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void init_delayed_ctrl(int fd, esp_video_isp_t *isp)
+{
+    esp_err_t ret;
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+    struct v4l2_querymenu qmenu;
+    struct v4l2_query_ext_ctrl qctrl;
+    esp_cam_sensor_format_t sensor_format;
+    esp_cam_sensor_delayed_ctrl_config_t dc_config;
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_CAMERA_FRAME_LATENCY;
+    control[0].p_u8     = (uint8_t *)&dc_config.latency;
+    control[0].size     = sizeof(dc_config.latency);
+    if (ioctl(fd, VIDIOC_G_EXT_CTRLS, &controls) != 0) {
+        ESP_LOGD(TAG, "V4L2_CID_CAMERA_FRAME_LATENCY is not supported");
+        return;
+    }
+
+    qctrl.id = V4L2_CID_GAIN;
+    if (ioctl(fd, VIDIOC_QUERY_EXT_CTRL, &qctrl) || qctrl.type != V4L2_CTRL_TYPE_INTEGER_MENU) {
+        return;
+    }
+
+    qmenu.id = V4L2_CID_GAIN;
+    qmenu.index = qctrl.minimum;
+    if (ioctl(fd, VIDIOC_QUERYMENU, &qmenu) || ioctl(fd, VIDIOC_G_SENSOR_FMT, &sensor_format) ||
+            !sensor_format.fps) {
+        return;
+    }
+
+    isp->base_gain = qmenu.value;
+    isp->applied_gain_index = -1;
+    isp->prev_gain_index = qctrl.default_value;
+    isp->sensor_vts = sensor_format.isp_info->isp_v1_info.vts;
+    isp->frame_us = 1000000 / sensor_format.fps;
+
+    dc_config.init.exposure_val = isp->prev_exposure_val;
+    dc_config.init.gain_index = qctrl.default_value;
+    dc_config.init.vts = isp->sensor_vts;
+    ret = esp_cam_sensor_delayed_ctrl_new(&dc_config, &isp->delayed_ctrl);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "failed to create sensor latency model, exposure is reported without delay");
+        return;
+    }
+
+    ESP_LOGD(TAG, "Sensor latency:");
+    ESP_LOGD(TAG, "  exposure: %d", dc_config.latency.exposure);
+    ESP_LOGD(TAG, "  gain:     %d", dc_config.latency.gain);
+    ESP_LOGD(TAG, "  vts:      %d", dc_config.latency.vts);
+}
+
+/**
+ * @brief Get the sensor frame timing if the sensor frame rate can be changed, again when the sensor format changes.
+ *
+ * @param fd  Camera device file description
+ * @param isp ISP pointer
+ *
+ * @return None
+ */
+static void init_frame_rate(int fd, esp_video_isp_t *isp)
+{
+    struct v4l2_ext_controls controls;
+    struct v4l2_ext_control control[1];
+    struct v4l2_query_ext_ctrl qctrl;
+    struct v4l2_query_ext_ctrl exp_qctrl;
+    esp_cam_sensor_format_t sensor_format;
+
+    qctrl.id = V4L2_CID_CAMERA_FPS;
+    if (ioctl(fd, VIDIOC_QUERY_EXT_CTRL, &qctrl) != 0) {
+        ESP_LOGD(TAG, "V4L2_CID_CAMERA_FPS is not supported");
+        return;
+    }
+
+    controls.ctrl_class = V4L2_CID_CAMERA_CLASS;
+    controls.count      = 1;
+    controls.controls   = control;
+    control[0].id       = V4L2_CID_CAMERA_FPS;
+    control[0].value    = 0;
+    exp_qctrl.id = V4L2_CID_EXPOSURE;
+    if (ioctl(fd, VIDIOC_G_EXT_CTRLS, &controls) || control[0].value <= 0 ||
+            ioctl(fd, VIDIOC_QUERY_EXT_CTRL, &exp_qctrl) ||
+            ioctl(fd, VIDIOC_G_SENSOR_FMT, &sensor_format) || !sensor_format.isp_info) {
+        return;
+    }
+
+    esp_cam_sensor_frame_timing_t *timing = &isp->frame_timing;
+    const esp_cam_sensor_isp_info_t *isp_info = sensor_format.isp_info;
+
+    timing->pclk = isp_info->isp_v1_info.pclk;
+    timing->hts = isp_info->isp_v1_info.hts;
+    timing->vts_min = isp_info->isp_v1_info.vts;
+    timing->exp_margin = 0;
+    /* Unbounded first, the longest frame is the one of the lowest frame rate */
+    timing->vts_max = UINT32_MAX;
+    timing->vts_max = esp_cam_sensor_frame_timing_vts(timing, qctrl.minimum);
+    if (!timing->vts_max) {
+        ESP_LOGW(TAG, "invalid sensor frame timing");
+        return;
+    }
+
+    /* The exposure limit reported now is the one of the current frame length */
+    uint32_t fps = control[0].value;
+    uint32_t vts = esp_cam_sensor_frame_timing_vts(timing, fps);
+    timing->exp_margin = vts > exp_qctrl.maximum ? vts - exp_qctrl.maximum : 0;
+
+    isp->min_fps = qctrl.minimum;
+    isp->sensor_fps = fps;
+    isp->sensor_vts = vts;
+    isp->frame_us = esp_cam_sensor_frame_timing_frame_us(timing, vts);
+    isp->sensor.max_exposure = REG_TO_US(esp_cam_sensor_frame_timing_exposure_max(timing, vts), isp);
+    isp->sensor_attr.fps = 1;
+    update_day_fps(isp, fps);
+
+    ESP_LOGD(TAG, "Sensor frame rate:");
+    ESP_LOGD(TAG, "  min:     %"PRIi64, qctrl.minimum);
+    ESP_LOGD(TAG, "  max:     %"PRIi64, qctrl.maximum);
+    ESP_LOGD(TAG, "  current: %"PRIu32, fps);
+    ESP_LOGD(TAG, "  margin:  %"PRIu32" lines", timing->exp_margin);
+}
+
 static esp_err_t init_cam_dev(const esp_video_isp_config_t *config, esp_video_isp_t *isp)
 {
     int fd;
@@ -1067,7 +1524,7 @@ static esp_err_t init_cam_dev(const esp_video_isp_config_t *config, esp_video_is
         ret = ioctl(fd, VIDIOC_G_SENSOR_FMT, &sensor_format);
         ESP_GOTO_ON_FALSE(ret == 0, ESP_ERR_NOT_SUPPORTED, fail_0, TAG, "failed to get sensor format");
 
-        isp->sensor_tline_ns = sensor_format.isp_info->isp_v1_info.tline_ns;
+        isp->sensor_tline_ns = get_sensor_tline_ns(sensor_format.isp_info);
         isp->prev_exposure_val = control[0].value;
 
         isp->sensor.min_exposure = REG_TO_US(qctrl.minimum, isp);
@@ -1208,6 +1665,15 @@ static esp_err_t init_cam_dev(const esp_video_isp_config_t *config, esp_video_is
         isp->sensor.height = format.fmt.pix.height;
     }
 
+    if (isp->sensor_attr.group && isp->sensor_attr.gain && isp->sensor_attr.exposure) {
+        init_delayed_ctrl(fd, isp);
+    }
+
+    /* Only the host AE uses the exposure limit and the night mode */
+    if (isp->sensor_attr.gain && isp->sensor_attr.exposure) {
+        init_frame_rate(fd, isp);
+    }
+
     isp->cam_fd = fd;
 
     return ESP_OK;
@@ -1295,6 +1761,7 @@ esp_err_t esp_video_isp_pipeline_init(const esp_video_isp_config_t *config)
 
     isp = calloc(1, sizeof(esp_video_isp_t));
     ESP_RETURN_ON_FALSE(isp, ESP_ERR_NO_MEM, TAG, "failed to malloc isp");
+    isp->night_mode_lock = (portMUX_TYPE)portMUX_INITIALIZER_UNLOCKED;
 
     // Enable IPA debug logging to verify algorithm loading
     esp_ipa_pipeline_set_log(true);
@@ -1352,6 +1819,7 @@ fail_4:
 fail_3:
     close(isp->isp_fd);
 fail_2:
+    esp_cam_sensor_delayed_ctrl_del(isp->delayed_ctrl);
     close(isp->cam_fd);
 fail_1:
     esp_ipa_pipeline_destroy(isp->ipa_pipeline);
@@ -1391,6 +1859,7 @@ esp_err_t esp_video_isp_pipeline_deinit(void)
     ESP_RETURN_ON_FALSE(close(isp->isp_fd) == 0, ESP_FAIL, TAG, "failed to close ISP");
     ESP_RETURN_ON_FALSE(close(isp->cam_fd) == 0, ESP_FAIL, TAG, "failed to close camera sensor");
     ESP_RETURN_ON_ERROR(esp_ipa_pipeline_destroy(isp->ipa_pipeline), TAG, "failed to destroy pipeline");
+    esp_cam_sensor_delayed_ctrl_del(isp->delayed_ctrl);
     free(isp);
     s_esp_video_isp = NULL;
 
@@ -1408,3 +1877,43 @@ bool esp_video_isp_pipeline_is_initialized(void)
 {
     return s_esp_video_isp != NULL;
 }
+
+/**
+ * @brief Configure the night mode of the ISP pipeline.
+ *
+ * @param config Night mode configuration, NULL disables it
+ *
+ * @return
+ *      - ESP_OK on success
+ *      - Others if failed
+ */
+esp_err_t esp_video_isp_pipeline_set_night_mode(const esp_cam_sensor_night_mode_config_t *config)
+{
+    esp_video_isp_t *isp = s_esp_video_isp;
+    esp_cam_sensor_night_mode_t night_mode;
+
+    ESP_RETURN_ON_FALSE(isp, ESP_ERR_INVALID_STATE, TAG, "ISP controller is not initialized");
+    ESP_RETURN_ON_FALSE(isp->sensor_attr.fps, ESP_ERR_NOT_SUPPORTED, TAG, "sensor frame rate can't be changed");
+
+    if (config) {
+        esp_cam_sensor_night_mode_config_t night_config = *config;
+
+        if (!night_config.day_fps) {
+            night_config.day_fps = isp->day_fps;
+        }
+        ESP_RETURN_ON_FALSE(night_config.night_fps >= isp->min_fps, ESP_ERR_INVALID_ARG, TAG,
+                            "night frame rate is lower than %"PRIu32" fps", isp->min_fps);
+        ESP_RETURN_ON_ERROR(esp_cam_sensor_night_mode_init(&night_mode, &night_config, &isp->frame_timing),
+                            TAG, "invalid night mode configuration");
+    }
+
+    portENTER_CRITICAL(&isp->night_mode_lock);
+    if (config) {
+        isp->night_mode_next = night_mode;
+    }
+    isp->night_mode_next_en = config != NULL;
+    isp->night_mode_update = true;
+    portEXIT_CRITICAL(&isp->night_mode_lock);
+
+    return ESP_OK;
+}
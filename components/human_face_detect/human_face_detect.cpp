@@ -19,12 +19,18 @@ MSR::MSR(const char *model_name)
 #endif
 #if CONFIG_IDF_TARGET_ESP32P4
     m_image_preprocessor = new dl::image::ImagePreprocessor(
-        m_model, {0, 0, 0}, {1, 1, 1}, DL_IMAGE_CAP_RGB_SWAP | DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
+        m_model, {0, 0, 0}, {1, 1, 1}, dl::image::DL_IMAGE_CAP_RGB_SWAP | dl::image::DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
 #else
-    m_image_preprocessor = new dl::image::ImagePreprocessor(m_model, {0, 0, 0}, {1, 1, 1}, DL_IMAGE_CAP_RGB_SWAP);
+    m_image_preprocessor =
+        new dl::image::ImagePreprocessor(m_model, {0, 0, 0}, {1, 1, 1}, dl::image::DL_IMAGE_CAP_RGB_SWAP);
 #endif
     m_postprocessor = new dl::detect::MSRPostprocessor(
-        m_model, 0.5, 0.5, 10, {{8, 8, 9, 9, {{16, 16}, {32, 32}}}, {16, 16, 9, 9, {{64, 64}, {128, 128}}}});
+        m_model,
+        m_image_preprocessor,
+        0.5,
+        0.5,
+        10,
+        {{8, 8, 9, 9, {{16, 16}, {32, 32}}}, {16, 16, 9, 9, {{64, 64}, {128, 128}}}});
 }
 
 MNP::MNP(const char *model_name)
@@ -38,11 +44,13 @@ MNP::MNP(const char *model_name)
 #endif
 #if CONFIG_IDF_TARGET_ESP32P4
     m_image_preprocessor = new dl::image::ImagePreprocessor(
-        m_model, {0, 0, 0}, {1, 1, 1}, DL_IMAGE_CAP_RGB_SWAP | DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
+        m_model, {0, 0, 0}, {1, 1, 1}, dl::image::DL_IMAGE_CAP_RGB_SWAP | dl::image::DL_IMAGE_CAP_RGB565_BIG_ENDIAN);
 #else
-    m_image_preprocessor = new dl::image::ImagePreprocessor(m_model, {0, 0, 0}, {1, 1, 1}, DL_IMAGE_CAP_RGB_SWAP);
+    m_image_preprocessor =
+        new dl::image::ImagePreprocessor(m_model, {0, 0, 0}, {1, 1, 1}, dl::image::DL_IMAGE_CAP_RGB_SWAP);
 #endif
-    m_postprocessor = new dl::detect::MNPPostprocessor(m_model, 0.5, 0.5, 10, {{1, 1, 0, 0, {{48, 48}}}});
+    m_postprocessor =
+        new dl::detect::MNPPostprocessor(m_model, m_image_preprocessor, 0.5, 0.5, 10, {{1, 1, 0, 0, {{48, 48}}}});
 }
 
 MNP::~MNP()
@@ -84,10 +92,6 @@ std::list<dl::detect::result_t> &MNP::run(const dl::image::img_t &img, std::list
         latency[1].end();
 
         latency[2].start();
-        m_postprocessor->set_resize_scale_x(m_image_preprocessor->get_resize_scale_x());
-        m_postprocessor->set_resize_scale_y(m_image_preprocessor->get_resize_scale_y());
-        m_postprocessor->set_top_left_x(m_image_preprocessor->get_top_left_x());
-        m_postprocessor->set_top_left_y(m_image_preprocessor->get_top_left_y());
         m_postprocessor->postprocess();
         latency[2].end();
     }
@@ -119,22 +123,101 @@ std::list<dl::detect::result_t> &MSRMNP::run(const dl::image::img_t &img)
     return m_mnp->run(img, candidates);
 }
 
+dl::detect::Detect &MSRMNP::set_score_thr(float score_thr, int idx)
+{
+    assert(idx == 0 || idx == 1);
+    if (idx == 0) {
+        m_msr->set_score_thr(score_thr);
+    } else {
+        m_mnp->set_score_thr(score_thr);
+    }
+    return *this;
+}
+
+dl::detect::Detect &MSRMNP::set_nms_thr(float nms_thr, int idx)
+{
+    assert(idx == 0 || idx == 1);
+    if (idx == 0) {
+        m_msr->set_nms_thr(nms_thr);
+    } else {
+        m_mnp->set_nms_thr(nms_thr);
+    }
+    return *this;
+}
+
+dl::detect::Detect &MSRMNP::set_nms_type(dl::detect::nms_type_t nms_type, bool class_aware, int idx)
+{
+    assert(idx == 0 || idx == 1);
+    if (idx == 0) {
+        m_msr->set_nms_type(nms_type, class_aware);
+    } else {
+        m_mnp->set_nms_type(nms_type, class_aware);
+    }
+    return *this;
+}
+
+dl::Model *MSRMNP::get_raw_model(int idx)
+{
+    assert(idx == 0 || idx == 1);
+    return idx == 0 ? m_msr->get_raw_model() : m_mnp->get_raw_model();
+}
+
+MSRMNPPipeline::MSRMNPPipeline(const char *msr_model_name,
+                               const char *mnp_model_name,
+                               std::function<void(frame_t *)> release,
+                               int queue_depth,
+                               uint32_t stack_size) :
+    m_msr(new MSR(msr_model_name)), m_mnp(new MNP(mnp_model_name))
+{
+    m_cascade = new dl::detect::CascadePipeline(
+        [this](const dl::image::img_t &img) -> std::list<dl::detect::result_t> & { return m_msr->run(img); },
+        [this](const dl::image::img_t &img, std::list<dl::detect::result_t> &candidates)
+            -> std::list<dl::detect::result_t> & { return m_mnp->run(img, candidates); },
+        release,
+        queue_depth,
+        stack_size);
+}
+
+MSRMNPPipeline::~MSRMNPPipeline()
+{
+    // stop the stage tasks before the models they run
+    if (m_cascade) {
+        delete m_cascade;
+        m_cascade = nullptr;
+    }
+    if (m_msr) {
+        delete m_msr;
+        m_msr = nullptr;
+    }
+    if (m_mnp) {
+        delete m_mnp;
+        m_mnp = nullptr;
+    }
+}
+
 } // namespace human_face_detect
 
-HumanFaceDetect::HumanFaceDetect(const char *sdcard_model_dir, model_type_t model_type)
+HumanFaceDetect::HumanFaceDetect(const char *sdcard_model_dir, model_type_t model_type) :
+    m_sdcard_model_dir(sdcard_model_dir), m_model_type(model_type)
+{
+    m_model = nullptr;
+    load_model();
+}
+
+void HumanFaceDetect::load_model()
 {
-    switch (model_type) {
+    switch (m_model_type) {
     case model_type_t::MSRMNP_S8_V1: {
 #if CONFIG_HUMAN_FACE_DETECT_MSRMNP_S8_V1
 #if !CONFIG_HUMAN_FACE_DETECT_MODEL_IN_SDCARD
         m_model =
             new human_face_detect::MSRMNP("human_face_detect_msr_s8_v1.espdl", "human_face_detect_mnp_s8_v1.espdl");
 #else
-        if (sdcard_model_dir) {
+        if (m_sdcard_model_dir) {
             char msr_dir[128];
-            snprintf(msr_dir, sizeof(msr_dir), "%s/human_face_detect_msr_s8_v1.espdl", sdcard_model_dir);
+            snprintf(msr_dir, sizeof(msr_dir), "%s/human_face_detect_msr_s8_v1.espdl", m_sdcard_model_dir);
             char mnp_dir[128];
-            snprintf(mnp_dir, sizeof(mnp_dir), "%s/human_face_detect_mnp_s8_v1.espdl", sdcard_model_dir);
+            snprintf(mnp_dir, sizeof(mnp_dir), "%s/human_face_detect_mnp_s8_v1.espdl", m_sdcard_model_dir);
             m_model = new human_face_detect::MSRMNP(msr_dir, mnp_dir);
         } else {
             ESP_LOGE("human_face_detect", "please pass sdcard mount point as parameter.");
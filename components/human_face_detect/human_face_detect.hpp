@@ -1,6 +1,7 @@
 #pragma once
 
 #include "dl_detect_base.hpp"
+#include "dl_detect_cascade.hpp"
 #include "dl_detect_mnp_postprocessor.hpp"
 #include "dl_detect_msr_postprocessor.hpp"
 namespace human_face_detect {
@@ -19,6 +20,13 @@ public:
     MNP(const char *model_name);
     ~MNP();
     std::list<dl::detect::result_t> &run(const dl::image::img_t &img, std::list<dl::detect::result_t> &candidates);
+    void set_score_thr(float score_thr) { m_postprocessor->set_score_thr(score_thr); }
+    void set_nms_thr(float nms_thr) { m_postprocessor->set_nms_thr(nms_thr); }
+    void set_nms_type(dl::detect::nms_type_t nms_type, bool class_aware)
+    {
+        m_postprocessor->set_nms_type(nms_type, class_aware);
+    }
+    dl::Model *get_raw_model() { return m_model; }
 };
 
 class MSRMNP : public dl::detect::Detect {
@@ -31,6 +39,46 @@ public:
         m_msr(new MSR(msr_model_name)), m_mnp(new MNP(mnp_model_name)) {};
     ~MSRMNP();
     std::list<dl::detect::result_t> &run(const dl::image::img_t &img) override;
+    // idx 0 is MSR, idx 1 is MNP
+    dl::detect::Detect &set_score_thr(float score_thr, int idx) override;
+    dl::detect::Detect &set_nms_thr(float nms_thr, int idx) override;
+    dl::detect::Detect &set_nms_type(dl::detect::nms_type_t nms_type, bool class_aware, int idx) override;
+    dl::Model *get_raw_model(int idx) override;
+};
+
+/**
+ * @brief MSR and MNP of consecutive frames at the same time: MNP of frame N runs on core 1 while MSR of frame N + 1
+ * runs on core 0, see dl::detect::CascadePipeline.
+ */
+class MSRMNPPipeline {
+public:
+    typedef dl::detect::CascadePipeline::frame_t frame_t;
+
+private:
+    MSR *m_msr;
+    MNP *m_mnp;
+    dl::detect::CascadePipeline *m_cascade;
+
+public:
+    /**
+     * @param release  Called on each frame which was pushed and not popped when the pipeline is destroyed, e.g. to
+     *                 release the frame buffer of user_data. nullptr if the frames own nothing
+     */
+    MSRMNPPipeline(const char *msr_model_name,
+                   const char *mnp_model_name,
+                   std::function<void(frame_t *)> release = nullptr,
+                   int queue_depth = 1,
+                   uint32_t stack_size = 16 * 1024);
+    ~MSRMNPPipeline();
+    /**
+     * @brief Start the detection of a frame, blocks while the pipeline is full.
+     */
+    bool push(frame_t *frame, TickType_t timeout = portMAX_DELAY) { return m_cascade->push(frame, timeout); }
+    /**
+     * @brief Take the next detected frame, in push order. nullptr on timeout.
+     */
+    frame_t *pop(TickType_t timeout = portMAX_DELAY) { return m_cascade->pop(timeout); }
+    dl::tool::Pipeline *get_pipeline() { return m_cascade->get_pipeline(); }
 };
 
 } // namespace human_face_detect
@@ -40,4 +88,10 @@ public:
     typedef enum { MSRMNP_S8_V1 } model_type_t;
     HumanFaceDetect(const char *sdcard_model_dir = nullptr,
                     model_type_t model_type = static_cast<model_type_t>(CONFIG_HUMAN_FACE_DETECT_MODEL_TYPE));
+
+private:
+    const char *m_sdcard_model_dir;
+    model_type_t m_model_type;
+
+    void load_model() override;
 };
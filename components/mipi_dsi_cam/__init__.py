@@ -26,8 +26,10 @@ CONF_XCLK_FREQ = "xclk_freq"
 CONF_FREQUENCY = "frequency"  # Alias pour compatibilité arrière
 CONF_SENSOR_ADDR = "sensor_addr"
 CONF_RESOLUTION = "resolution"
+CONF_MAX_RESOLUTION = "max_resolution"  # Taille des buffers, permet switch_resolution() sans réallocation
 CONF_PIXEL_FORMAT = "pixel_format"
 CONF_FRAMERATE = "framerate"
+CONF_NIGHT_FRAMERATE = "night_framerate"
 CONF_JPEG_QUALITY = "jpeg_quality"
 CONF_MIRROR_X = "mirror_x"  # Hardware PPA transform (M5Stack-style)
 CONF_MIRROR_Y = "mirror_y"  # Hardware PPA transform
@@ -78,8 +80,10 @@ CONFIG_SCHEMA = cv.All(
         cv.Optional(CONF_FREQUENCY): cv.int_,
         cv.Optional(CONF_SENSOR_ADDR, default=0x36): cv.hex_int,
         cv.Optional(CONF_RESOLUTION, default="720P"): cv.string,
+        cv.Optional(CONF_MAX_RESOLUTION): cv.string,
         cv.Optional(CONF_PIXEL_FORMAT, default="JPEG"): cv.string,
         cv.Optional(CONF_FRAMERATE, default=30): cv.int_range(min=1, max=60),
+        cv.Optional(CONF_NIGHT_FRAMERATE, default=0): cv.int_range(min=0, max=60),
         cv.Optional(CONF_JPEG_QUALITY, default=10): cv.int_range(min=1, max=63),
         # Options obsolètes (acceptées mais ignorées)
         cv.Optional(CONF_MIRROR_X): cv.boolean,
@@ -114,8 +118,11 @@ async def to_code(config):
     cg.add(var.set_xclk_freq(config[CONF_XCLK_FREQ]))
     cg.add(var.set_sensor_addr(config[CONF_SENSOR_ADDR]))
     cg.add(var.set_resolution(config[CONF_RESOLUTION]))
+    if CONF_MAX_RESOLUTION in config:
+        cg.add(var.set_max_resolution(config[CONF_MAX_RESOLUTION]))
     cg.add(var.set_pixel_format(config[CONF_PIXEL_FORMAT]))
     cg.add(var.set_framerate(config[CONF_FRAMERATE]))
+    cg.add(var.set_night_framerate(config[CONF_NIGHT_FRAMERATE]))
     cg.add(var.set_jpeg_quality(config[CONF_JPEG_QUALITY]))
 
     # Configuration mirror/rotate (PPA hardware M5Stack-style)
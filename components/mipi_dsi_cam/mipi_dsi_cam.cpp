@@ -22,6 +22,7 @@ extern "C" {
 #include "esp_video_device.h"
 #include "esp_video_ioctl.h"
 #include "esp_video_isp_ioctl.h"
+#include "esp_video_isp_pipeline.h"
 #include "esp_ipa.h"
 #include "esp_ipa_types.h"
 #include "driver/ppa.h"  // Pixel-Processing Accelerator for hardware mirror/rotate
@@ -314,6 +315,7 @@ void MipiDSICamComponent::cleanup_ppa_() {
 void MipiDSICamComponent::setup() {
   // Initialiser le spinlock pour le buffer pool (affectation directe de la macro)
   this->buffer_mutex_ = portMUX_INITIALIZER_UNLOCKED;
+  this->stream_lock_ = xSemaphoreCreateMutex();
 
   // Vérifier mémoire disponible
   size_t free_heap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
@@ -430,8 +432,14 @@ void MipiDSICamComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "MIPI DSI Camera:");
   ESP_LOGCONFIG(TAG, "  Capteur: %s", this->sensor_name_.c_str());
   ESP_LOGCONFIG(TAG, "  Résolution: %s", this->resolution_.c_str());
+  if (!this->max_resolution_.empty()) {
+    ESP_LOGCONFIG(TAG, "  Résolution max (buffers): %s", this->max_resolution_.c_str());
+  }
   ESP_LOGCONFIG(TAG, "  Format: %s", this->pixel_format_.c_str());
   ESP_LOGCONFIG(TAG, "  FPS: %d", this->framerate_);
+  if (this->night_framerate_ > 0) {
+    ESP_LOGCONFIG(TAG, "  FPS nuit: %d", this->night_framerate_);
+  }
   ESP_LOGCONFIG(TAG, "  État: %s", this->pipeline_started_ ? "ACTIF" : "INACTIF");
   ESP_LOGCONFIG(TAG, "  Snapshots: %u", (unsigned)this->snapshot_count_);
 }
@@ -650,6 +658,207 @@ bool MipiDSICamComponent::capture_snapshot_to_file(const std::string &path) {
 // Streaming Vidéo Continu pour LVGL Display
 // ============================================================================
 
+// Formats custom compilés depuis les descriptions *_custom_modes.h, avec le timing dérivé de chaque mode
+struct CustomFormatEntry {
+  const char *sensor;
+  const esp_cam_sensor_format_t *format;
+  const fmt::Timing *timing;
+};
+
+static const CustomFormatEntry CUSTOM_FORMATS[] = {
+    {"ov02c10", &ov02c10_format_1280x800_raw10_30fps, &fmt::ov02c10_1280x800_raw10_timing},
+    {"ov02c10", &ov02c10_format_800x480_raw10_30fps, &fmt::ov02c10_800x480_raw10_timing},
+    {"ov5647", &ov5647_format_640x480_raw8_30fps, &fmt::ov5647_640x480_raw8_timing},
+    {"ov5647", &ov5647_format_800x640_raw8_50fps, &fmt::ov5647_800x640_raw8_timing},
+    {"ov5647", &ov5647_format_1024x600_raw8_30fps, &fmt::ov5647_1024x600_raw8_timing},
+    {"sc202cs", &sc202cs_format_vga_raw8_30fps, &fmt::sc202cs_vga_raw8_timing},
+};
+
+// Format custom du capteur pour une résolution, nullptr si le driver doit garder son format par défaut
+static const CustomFormatEntry *select_custom_format_(const std::string &sensor, uint32_t width, uint32_t height) {
+  for (const CustomFormatEntry &entry : CUSTOM_FORMATS) {
+    if (sensor == entry.sensor && entry.format->width == width && entry.format->height == height) {
+      return &entry;
+    }
+  }
+  return nullptr;
+}
+
+// Format du driver pour une résolution: même port que le format courant, même sortie si possible, FPS max
+static const esp_cam_sensor_format_t *select_driver_format_(const esp_cam_sensor_format_array_t &formats,
+                                                            const esp_cam_sensor_format_t &current, uint32_t width,
+                                                            uint32_t height) {
+  const esp_cam_sensor_format_t *best = nullptr;
+  for (uint32_t i = 0; i < formats.count; i++) {
+    const esp_cam_sensor_format_t *format = &formats.format_array[i];
+    if (format->port != current.port || format->width != width || format->height != height) {
+      continue;
+    }
+    if (best == nullptr || (format->format == current.format && best->format != current.format) ||
+        (format->format == best->format && format->fps > best->fps)) {
+      best = format;
+    }
+  }
+  return best;
+}
+
+// Format capteur pour une résolution: le format custom s'il y en a un, sinon celui du driver.
+// csi_video_set_format() refuse une taille différente du format capteur, S_FMT échoue si celui-ci n'est pas changé.
+bool MipiDSICamComponent::apply_sensor_format_(uint32_t width, uint32_t height) {
+  const esp_cam_sensor_format_t *format = nullptr;
+  const CustomFormatEntry *entry = select_custom_format_(this->sensor_name_, width, height);
+  if (entry != nullptr) {
+    format = entry->format;
+    ESP_LOGI(TAG, "✅ Using CUSTOM format: %s (%s)", format->name, this->sensor_name_.c_str());
+    ESP_LOGI(TAG, "   Timing: pclk=%u HTS=%u VTS=%u, FPS max calculé %u.%02u",
+             (unsigned)entry->timing->pclk, entry->timing->hts, entry->timing->vts,
+             (unsigned)(entry->timing->max_fps_x100() / 100), (unsigned)(entry->timing->max_fps_x100() % 100));
+  } else {
+    esp_cam_sensor_format_t current;
+    memset(&current, 0, sizeof(current));
+    if (ioctl(this->video_fd_, VIDIOC_G_SENSOR_FMT, &current) != 0) {
+      ESP_LOGE(TAG, "VIDIOC_G_SENSOR_FMT failed: %s", strerror(errno));
+      return false;
+    }
+    if (current.width == width && current.height == height) {
+      return true;
+    }
+    esp_cam_sensor_format_array_t formats;
+    memset(&formats, 0, sizeof(formats));
+    if (ioctl(this->video_fd_, VIDIOC_QUERY_SENSOR_FMT, &formats) != 0) {
+      ESP_LOGE(TAG, "VIDIOC_QUERY_SENSOR_FMT failed: %s", strerror(errno));
+      return false;
+    }
+    format = select_driver_format_(formats, current, width, height);
+    if (format == nullptr) {
+      ESP_LOGE(TAG, "%s n'a pas de format %ux%u (custom ou driver)", this->sensor_name_.c_str(), width, height);
+      return false;
+    }
+    ESP_LOGI(TAG, "Using driver format: %s (%s)", format->name, this->sensor_name_.c_str());
+  }
+
+  // VIDIOC_S_SENSOR_FMT: le driver n'écrit que les registres qui changent
+  if (ioctl(this->video_fd_, VIDIOC_S_SENSOR_FMT, format) != 0) {
+    ESP_LOGE(TAG, "❌ VIDIOC_S_SENSOR_FMT %s failed: %s", format->name, strerror(errno));
+    return false;
+  }
+  ESP_LOGI(TAG, "✅ Sensor registers configured for %ux%u", width, height);
+  return true;
+}
+
+bool MipiDSICamComponent::queue_user_buffer_(uint32_t index) {
+  struct v4l2_buffer buf;
+  memset(&buf, 0, sizeof(buf));
+  buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  buf.memory = V4L2_MEMORY_USERPTR;
+  buf.index = index;
+  buf.m.userptr = (unsigned long)this->simple_buffers_[index].data;  // ★ Notre buffer SPIRAM
+  buf.length = this->buffer_capacity_;
+
+  if (ioctl(this->video_fd_, VIDIOC_QBUF, &buf) < 0) {
+    ESP_LOGE(TAG, "VIDIOC_QBUF[%u] (USERPTR) failed: %s", index, strerror(errno));
+    return false;
+  }
+  ESP_LOGI(TAG, "  ✓ Buffer[%u] queued: userptr=%p, length=%u",
+           index, (void*)buf.m.userptr, buf.length);
+  return true;
+}
+
+// REQBUFS USERPTR + QBUF des 3 buffers SPIRAM, à refaire après chaque S_FMT.
+// Un buffer encore tenu par un consommateur (acquire_buffer) n'est pas donné au DMA: il l'est à sa libération.
+bool MipiDSICamComponent::queue_user_buffers_() {
+  struct v4l2_requestbuffers req;
+  memset(&req, 0, sizeof(req));
+  req.count = 3;  // 3 buffers pour triple buffering
+  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  req.memory = V4L2_MEMORY_USERPTR;  // ★ USERPTR au lieu de MMAP!
+
+  if (ioctl(this->video_fd_, VIDIOC_REQBUFS, &req) < 0) {
+    ESP_LOGE(TAG, "VIDIOC_REQBUFS (USERPTR mode) failed: %s", strerror(errno));
+    return false;
+  }
+
+  ESP_LOGI(TAG, "✓ V4L2 USERPTR mode: %u buffers requested", req.count);
+
+  this->requeue_pending_ = 0;
+  for (unsigned int i = 0; i < 3; i++) {
+    portENTER_CRITICAL(&this->buffer_mutex_);
+    bool held = this->simple_buffers_[i].allocated;
+    portEXIT_CRITICAL(&this->buffer_mutex_);
+    if (held) {
+      this->requeue_pending_ |= 1 << i;
+      ESP_LOGI(TAG, "  Buffer[%u] encore utilisé, queué à sa libération", i);
+      continue;
+    }
+    if (!this->queue_user_buffer_(i)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Queue les buffers tenus pendant queue_user_buffers_() que les consommateurs ont libérés depuis
+void MipiDSICamComponent::queue_released_buffers_() {
+  for (unsigned int i = 0; i < 3; i++) {
+    if (!(this->requeue_pending_ & (1 << i))) {
+      continue;
+    }
+    portENTER_CRITICAL(&this->buffer_mutex_);
+    bool held = this->simple_buffers_[i].allocated;
+    portEXIT_CRITICAL(&this->buffer_mutex_);
+    if (!held && this->queue_user_buffer_(i)) {
+      this->requeue_pending_ &= ~(1 << i);
+    }
+  }
+}
+
+// Reconfigure capteur + CSI/ISP pour une résolution, streaming arrêté, fds et buffers conservés
+bool MipiDSICamComponent::configure_stream_(uint32_t width, uint32_t height) {
+  if (!this->apply_sensor_format_(width, height)) {
+    return false;
+  }
+
+  struct v4l2_format fmt;
+  memset(&fmt, 0, sizeof(fmt));
+  fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  fmt.fmt.pix.width = width;
+  fmt.fmt.pix.height = height;
+  fmt.fmt.pix.pixelformat = V4L2_PIX_FMT_RGB565;
+  fmt.fmt.pix.field = V4L2_FIELD_NONE;
+  if (ioctl(this->video_fd_, VIDIOC_S_FMT, &fmt) < 0 || ioctl(this->video_fd_, VIDIOC_G_FMT, &fmt) < 0) {
+    ESP_LOGE(TAG, "VIDIOC_S_FMT %ux%u failed: %s", width, height, strerror(errno));
+    return false;
+  }
+
+  size_t size = (size_t)fmt.fmt.pix.width * fmt.fmt.pix.height * 2;
+  if (size > this->buffer_capacity_) {
+    ESP_LOGE(TAG, "%ux%u needs %u bytes, buffers hold %u (raise max_resolution)",
+             fmt.fmt.pix.width, fmt.fmt.pix.height, size, this->buffer_capacity_);
+    return false;
+  }
+
+  if (!this->queue_user_buffers_()) {
+    return false;
+  }
+
+  int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (ioctl(this->video_fd_, VIDIOC_STREAMON, &type) < 0) {
+    ESP_LOGE(TAG, "VIDIOC_STREAMON failed: %s", strerror(errno));
+    return false;
+  }
+
+  this->image_width_ = fmt.fmt.pix.width;
+  this->image_height_ = fmt.fmt.pix.height;
+  this->image_buffer_size_ = size;
+
+  // Le nouveau format recharge le VTS par défaut: FPS et mode nuit sont à réappliquer
+  this->apply_framerate_();
+  if (this->night_framerate_ > 0) {
+    this->apply_night_mode_();
+  }
+  return true;
+}
+
 bool MipiDSICamComponent::start_streaming() {
   if (this->streaming_active_) {
     ESP_LOGW(TAG, "Streaming déjà actif");
@@ -686,89 +895,12 @@ bool MipiDSICamComponent::start_streaming() {
     return false;
   }
 
-  // ============================================================================
-  // Custom Format Support (OV02C10 @ 800x480 ou 1280x800)
-  // ============================================================================
-  if (this->sensor_name_ == "ov02c10") {
-    const esp_cam_sensor_format_t *custom_format = nullptr;
-
-    // Sélectionner le format custom selon la résolution
-    if (width == 1280 && height == 800) {
-      custom_format = &ov02c10_format_1280x800_raw10_30fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: 1280x800 RAW10 @ 30fps");
-    } else if (width == 800 && height == 480) {
-      custom_format = &ov02c10_format_800x480_raw10_30fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: 800x480 RAW10 @ 30fps");
-    }
-
-    // Appliquer le format custom via VIDIOC_S_SENSOR_FMT
-    if (custom_format != nullptr) {
-      if (ioctl(this->video_fd_, VIDIOC_S_SENSOR_FMT, custom_format) != 0) {
-        ESP_LOGE(TAG, "❌ VIDIOC_S_SENSOR_FMT failed: %s", strerror(errno));
-        ESP_LOGE(TAG, "Custom format not supported, falling back to standard format");
-      } else {
-        ESP_LOGI(TAG, "✅ Custom format applied successfully!");
-        ESP_LOGI(TAG, "   Sensor registers configured for native %ux%u", width, height);
-      }
-    }
-  }
-  // ============================================================================
-
-  // ============================================================================
-  // Custom Format Support (OV5647) - All resolutions supported
-  // ============================================================================
-  if (this->sensor_name_ == "ov5647") {
-    const esp_cam_sensor_format_t *custom_format = nullptr;
-
-    // Sélectionner le format selon la résolution demandée
-    if (width == 640 && height == 480) {
-      custom_format = &ov5647_format_640x480_raw8_30fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: VGA 640x480 RAW8 @ 30fps (OV5647)");
-    } else if (width == 800 && height == 640) {
-      custom_format = &ov5647_format_800x640_raw8_50fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: 800x640 RAW8 @ 50fps (OV5647)");
-    } else if (width == 1024 && height == 600) {
-      custom_format = &ov5647_format_1024x600_raw8_30fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: 1024x600 RAW8 @ 30fps (OV5647)");
-    }
-
-    // Appliquer le format custom via VIDIOC_S_SENSOR_FMT
-    if (custom_format != nullptr) {
-      if (ioctl(this->video_fd_, VIDIOC_S_SENSOR_FMT, custom_format) != 0) {
-        ESP_LOGE(TAG, "❌ VIDIOC_S_SENSOR_FMT failed: %s", strerror(errno));
-        ESP_LOGE(TAG, "Custom format not supported, falling back to standard format");
-      } else {
-        ESP_LOGI(TAG, "✅ Custom format applied successfully!");
-        ESP_LOGI(TAG, "   Sensor registers configured for %ux%u", width, height);
-      }
-    }
-  }
-  // ============================================================================
-
-  // ============================================================================
-  // Custom Format Support (SC202CS @ VGA 640x480)
-  // ============================================================================
-  if (this->sensor_name_ == "sc202cs") {
-    const esp_cam_sensor_format_t *custom_format = nullptr;
-
-    // Sélectionner le format custom VGA
-    if (width == 640 && height == 480) {
-      custom_format = &sc202cs_format_vga_raw8_30fps;
-      ESP_LOGI(TAG, "✅ Using CUSTOM format: VGA 640x480 RAW8 @ 30fps (SC202CS)");
-    }
-
-    // Appliquer le format custom via VIDIOC_S_SENSOR_FMT
-    if (custom_format != nullptr) {
-      if (ioctl(this->video_fd_, VIDIOC_S_SENSOR_FMT, custom_format) != 0) {
-        ESP_LOGE(TAG, "❌ VIDIOC_S_SENSOR_FMT failed: %s", strerror(errno));
-        ESP_LOGE(TAG, "Custom format not supported, falling back to standard format");
-      } else {
-        ESP_LOGI(TAG, "✅ Custom format applied successfully!");
-        ESP_LOGI(TAG, "   Sensor registers configured for native VGA (%ux%u)", width, height);
-      }
-    }
+  // Format capteur de la résolution: custom (OV02C10, OV5647, SC202CS) ou celui du driver
+  if (!this->apply_sensor_format_(width, height)) {
+    close(this->video_fd_);
+    this->video_fd_ = -1;
+    return false;
   }
-  // ============================================================================
 
   // RGB565 natif du CSI (pas de conversion, pas de copie)
   // Note: Si custom format RAW10 appliqué, ISP convertira RAW10→RGB565
@@ -888,6 +1020,13 @@ bool MipiDSICamComponent::start_streaming() {
            this->image_width_, this->image_height_,
            this->image_buffer_size_, this->image_buffer_size_ / 1024);
 
+  // Buffers dimensionnés pour max_resolution: switch_resolution() les réutilise sans réallocation
+  this->buffer_capacity_ = this->image_buffer_size_;
+  uint32_t max_width, max_height;
+  if (!this->max_resolution_.empty() && map_resolution_(this->max_resolution_, max_width, max_height)) {
+    this->buffer_capacity_ = std::max<size_t>(this->buffer_capacity_, (size_t)max_width * max_height * 2);
+  }
+
   // 3. Allouer 3 buffers SPIRAM AVANT de les passer à V4L2 (mode USERPTR)
   // ★ CRITICAL: Utiliser V4L2_MEMORY_USERPTR pour éviter memcpy vers SPIRAM (comme Waveshare)
   // ESP32-P4 cache line size is 64 bytes (standard for RISC-V with L1/L2 cache)
@@ -895,18 +1034,18 @@ bool MipiDSICamComponent::start_streaming() {
 
   ESP_LOGI(TAG, "Allocating cache-aligned SPIRAM buffers for V4L2 USERPTR mode:");
   ESP_LOGI(TAG, "  Buffers: 3 × %u bytes = %u KB total",
-           this->image_buffer_size_, (this->image_buffer_size_ * 3) / 1024);
+           this->buffer_capacity_, (this->buffer_capacity_ * 3) / 1024);
   ESP_LOGI(TAG, "  Cache line size: %u bytes", cache_line_size);
 
   for (int i = 0; i < 3; i++) {
     this->simple_buffers_[i].data = (uint8_t*)heap_caps_aligned_alloc(
         cache_line_size,
-        this->image_buffer_size_,
+        this->buffer_capacity_,
         MALLOC_CAP_SPIRAM);
 
     if (this->simple_buffers_[i].data == nullptr) {
       ESP_LOGE(TAG, "❌ Failed to allocate aligned buffer %d (size: %u bytes, align: %u)",
-               i, this->image_buffer_size_, cache_line_size);
+               i, this->buffer_capacity_, cache_line_size);
       ESP_LOGE(TAG, "   Free SPIRAM: %u bytes, Free internal: %u bytes",
                heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
                heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
@@ -927,15 +1066,8 @@ bool MipiDSICamComponent::start_streaming() {
   this->current_buffer_index_ = -1;
   this->image_buffer_ = nullptr;
 
-  // 4. Demander 3 buffers V4L2 en mode USERPTR (au lieu de MMAP)
-  struct v4l2_requestbuffers req;
-  memset(&req, 0, sizeof(req));
-  req.count = 3;  // 3 buffers pour triple buffering
-  req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-  req.memory = V4L2_MEMORY_USERPTR;  // ★ USERPTR au lieu de MMAP!
-
-  if (ioctl(this->video_fd_, VIDIOC_REQBUFS, &req) < 0) {
-    ESP_LOGE(TAG, "VIDIOC_REQBUFS (USERPTR mode) failed: %s", strerror(errno));
+  // 4-5. Demander 3 buffers V4L2 en mode USERPTR et les queuer
+  if (!this->queue_user_buffers_()) {
     // Libérer les buffers SPIRAM
     for (int i = 0; i < 3; i++) {
       heap_caps_free(this->simple_buffers_[i].data);
@@ -946,33 +1078,6 @@ bool MipiDSICamComponent::start_streaming() {
     return false;
   }
 
-  ESP_LOGI(TAG, "✓ V4L2 USERPTR mode: %u buffers requested", req.count);
-
-  // 5. Queuer les buffers avec nos pointeurs SPIRAM
-  for (unsigned int i = 0; i < 3; i++) {
-    struct v4l2_buffer buf;
-    memset(&buf, 0, sizeof(buf));
-    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
-    buf.memory = V4L2_MEMORY_USERPTR;
-    buf.index = i;
-    buf.m.userptr = (unsigned long)this->simple_buffers_[i].data;  // ★ Notre buffer SPIRAM
-    buf.length = this->image_buffer_size_;
-
-    if (ioctl(this->video_fd_, VIDIOC_QBUF, &buf) < 0) {
-      ESP_LOGE(TAG, "VIDIOC_QBUF[%u] (USERPTR) failed: %s", i, strerror(errno));
-      // Libérer les buffers SPIRAM
-      for (int j = 0; j < 3; j++) {
-        heap_caps_free(this->simple_buffers_[j].data);
-        this->simple_buffers_[j].data = nullptr;
-      }
-      close(this->video_fd_);
-      this->video_fd_ = -1;
-      return false;
-    }
-    ESP_LOGI(TAG, "  ✓ Buffer[%u] queued: userptr=%p, length=%u",
-             i, (void*)buf.m.userptr, buf.length);
-  }
-
   // 8. DÉMARRER LE STREAMING
   int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
   if (ioctl(this->video_fd_, VIDIOC_STREAMON, &type) < 0) {
@@ -984,18 +1089,24 @@ bool MipiDSICamComponent::start_streaming() {
   this->streaming_active_ = true;
   this->frame_sequence_ = 0;
 
+  // Fréquence d'images: le capteur allonge VTS, aucune frame n'est capturée pour être jetée
+  this->apply_framerate_();
+  if (this->night_framerate_ > 0) {
+    this->apply_night_mode_();
+  }
+
   // Allouer buffer séparé pour PPA si mirror/rotate activés
   if (this->ppa_enabled_) {
     this->image_buffer_ = (uint8_t*)heap_caps_malloc(
-        this->image_buffer_size_,
+        this->buffer_capacity_,
         MALLOC_CAP_DMA | MALLOC_CAP_SPIRAM
     );
     if (!this->image_buffer_) {
-      ESP_LOGE(TAG, "Failed to allocate PPA image buffer (%u bytes)", this->image_buffer_size_);
+      ESP_LOGE(TAG, "Failed to allocate PPA image buffer (%u bytes)", this->buffer_capacity_);
       this->stop_streaming();
       return false;
     }
-    ESP_LOGI(TAG, "✓ PPA buffer allocated: %u bytes @ %p", this->image_buffer_size_, this->image_buffer_);
+    ESP_LOGI(TAG, "✓ PPA buffer allocated: %u bytes @ %p", this->buffer_capacity_, this->image_buffer_);
   }
 
   ESP_LOGI(TAG, "mipi_dsi_cam: streaming started");
@@ -1098,6 +1209,25 @@ bool MipiDSICamComponent::capture_frame() {
     return false;
   }
 
+  // Flux en cours d'arrêt ou de reconfiguration: pas de frame, comme un DQBUF sans buffer prêt
+  if (this->stream_lock_ == nullptr || xSemaphoreTake(this->stream_lock_, 0) != pdTRUE) {
+    return false;
+  }
+  bool captured = this->capture_frame_();
+  xSemaphoreGive(this->stream_lock_);
+  return captured;
+}
+
+bool MipiDSICamComponent::capture_frame_() {
+  if (!this->streaming_active_) {
+    return false;
+  }
+
+  // Buffers tenus par un consommateur pendant switch_resolution(), rendus au DMA une fois libérés
+  if (this->requeue_pending_ != 0) {
+    this->queue_released_buffers_();
+  }
+
   static uint32_t profile_count = 0;
   static uint32_t total_dqbuf_us = 0;
   static uint32_t total_copy_us = 0;
@@ -1203,6 +1333,64 @@ bool MipiDSICamComponent::capture_frame() {
   return true;
 }
 
+bool MipiDSICamComponent::switch_resolution(const std::string &resolution) {
+  if (!this->streaming_active_) {
+    this->resolution_ = resolution;
+    return true;
+  }
+
+  uint32_t width, height;
+  if (!map_resolution_(resolution, width, height)) {
+    ESP_LOGE(TAG, "Invalid resolution: %s", resolution.c_str());
+    return false;
+  }
+  if ((size_t)width * height * 2 > this->buffer_capacity_) {
+    ESP_LOGE(TAG, "%s ne tient pas dans les buffers (%u octets), augmenter max_resolution",
+             resolution.c_str(), this->buffer_capacity_);
+    return false;
+  }
+
+  int64_t start_us = esp_timer_get_time();
+  uint32_t old_width = this->image_width_;
+  uint32_t old_height = this->image_height_;
+
+  // Attendre la fin d'une capture en cours: elle ne doit pas voir le flux arrêté ni la nouvelle taille
+  xSemaphoreTake(this->stream_lock_, portMAX_DELAY);
+  int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (ioctl(this->video_fd_, VIDIOC_STREAMOFF, &type) < 0) {
+    ESP_LOGE(TAG, "VIDIOC_STREAMOFF failed: %s", strerror(errno));
+    xSemaphoreGive(this->stream_lock_);
+    return false;
+  }
+
+  // Les frames en cours décrivent l'ancienne résolution
+  portENTER_CRITICAL(&this->buffer_mutex_);
+  this->current_buffer_index_ = -1;
+  portEXIT_CRITICAL(&this->buffer_mutex_);
+  this->imlib_image_valid_ = false;
+
+  if (!this->configure_stream_(width, height)) {
+    ESP_LOGW(TAG, "Retour à %ux%u", old_width, old_height);
+    bool restored = this->configure_stream_(old_width, old_height);
+    xSemaphoreGive(this->stream_lock_);
+    if (!restored) {
+      this->stop_streaming();
+    }
+    return false;
+  }
+
+  this->resolution_ = resolution;
+  this->frame_sequence_ = 0;
+  xSemaphoreGive(this->stream_lock_);
+  ESP_LOGI(TAG, "Résolution %ux%u -> %ux%u en %lld ms (fds et buffers conservés)",
+           old_width, old_height, this->image_width_, this->image_height_,
+           (long long)((esp_timer_get_time() - start_us) / 1000));
+
+  // Le pipeline ISP relit la trame du capteur au redémarrage du flux, les encodeurs l'apprennent ici
+  this->resolution_callback_.call(this->image_width_, this->image_height_);
+  return true;
+}
+
 void MipiDSICamComponent::stop_streaming() {
   if (!this->streaming_active_) {
     return;
@@ -1210,7 +1398,8 @@ void MipiDSICamComponent::stop_streaming() {
 
   // ESP_LOGI(TAG, "=== STOP STREAMING ===");
 
-  // 1. Arrêter le streaming V4L2
+  // 1. Arrêter le streaming V4L2, après une capture en cours qui lit encore les buffers
+  xSemaphoreTake(this->stream_lock_, portMAX_DELAY);
   if (this->video_fd_ >= 0) {
     int type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
     if (ioctl(this->video_fd_, VIDIOC_STREAMOFF, &type) < 0) {
@@ -1222,6 +1411,7 @@ void MipiDSICamComponent::stop_streaming() {
   portENTER_CRITICAL(&this->buffer_mutex_);
   this->current_buffer_index_ = -1;
   portEXIT_CRITICAL(&this->buffer_mutex_);
+  this->requeue_pending_ = 0;
 
   for (int i = 0; i < 3; i++) {
     if (this->simple_buffers_[i].data != nullptr) {
@@ -1264,6 +1454,7 @@ void MipiDSICamComponent::stop_streaming() {
   this->image_width_ = 0;
   this->image_height_ = 0;
   this->image_buffer_size_ = 0;
+  xSemaphoreGive(this->stream_lock_);
 
   // ESP_LOGI(TAG, "✓ Streaming stopped, resources freed");
 }
@@ -1582,6 +1773,86 @@ bool MipiDSICamComponent::set_wb_gains(float red_gain, float blue_gain) {
   return true;
 }
 
+// ============================================================================
+// Fréquence d'images (VTS capteur) et mode nuit
+// ============================================================================
+
+// Seuils du mode nuit, en gain 1/1000 requis à l'exposition max du jour
+static constexpr uint32_t NIGHT_MODE_ENTER_GAIN = 8000;
+static constexpr uint32_t NIGHT_MODE_EXIT_GAIN = 2000;
+static constexpr uint32_t NIGHT_MODE_HOLD_FRAMES = 30;
+
+void MipiDSICamComponent::set_framerate(int f) {
+  this->framerate_ = f;
+  if (this->streaming_active_) {
+    this->apply_framerate_();
+  }
+}
+
+bool MipiDSICamComponent::apply_framerate_() {
+  if (this->video_fd_ < 0 || this->framerate_ <= 0) {
+    return false;
+  }
+
+  struct v4l2_streamparm parm;
+  memset(&parm, 0, sizeof(parm));
+  parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  parm.parm.capture.capability = V4L2_CAP_TIMEPERFRAME;
+  parm.parm.capture.timeperframe.numerator = 1;
+  parm.parm.capture.timeperframe.denominator = this->framerate_;
+
+  if (ioctl(this->video_fd_, VIDIOC_S_PARM, &parm) < 0) {
+    ESP_LOGW(TAG, "FPS %d non appliqué: %s", this->framerate_, strerror(errno));
+    return false;
+  }
+
+  // Le driver borne la valeur à la plage du format courant
+  memset(&parm, 0, sizeof(parm));
+  parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+  if (ioctl(this->video_fd_, VIDIOC_G_PARM, &parm) == 0 && parm.parm.capture.timeperframe.numerator != 0) {
+    ESP_LOGI(TAG, "✓ FPS capteur: %u (demandé %d)",
+             (unsigned)(parm.parm.capture.timeperframe.denominator / parm.parm.capture.timeperframe.numerator),
+             this->framerate_);
+  }
+  return true;
+}
+
+bool MipiDSICamComponent::set_night_mode(int night_fps) {
+  this->night_framerate_ = night_fps;
+  if (!this->streaming_active_) {
+    return true;  // Appliqué au démarrage du streaming
+  }
+  return this->apply_night_mode_();
+}
+
+bool MipiDSICamComponent::apply_night_mode_() {
+  esp_err_t ret;
+
+  if (this->night_framerate_ > 0) {
+    esp_cam_sensor_night_mode_config_t config = {};
+    config.day_fps = 0;  // FPS courant du capteur, déjà borné au format par apply_framerate_()
+    config.night_fps = this->night_framerate_;
+    config.enter_gain = NIGHT_MODE_ENTER_GAIN;
+    config.exit_gain = NIGHT_MODE_EXIT_GAIN;
+    config.hold_frames = NIGHT_MODE_HOLD_FRAMES;
+    ret = esp_video_isp_pipeline_set_night_mode(&config);
+  } else {
+    ret = esp_video_isp_pipeline_set_night_mode(nullptr);
+  }
+
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Mode nuit non disponible (%s): AE capteur ou pipeline ISP absent", esp_err_to_name(ret));
+    return false;
+  }
+
+  if (this->night_framerate_ > 0) {
+    ESP_LOGI(TAG, "✓ Mode nuit: %d FPS en faible lumière", this->night_framerate_);
+  } else {
+    ESP_LOGI(TAG, "✓ Mode nuit désactivé");
+  }
+  return true;
+}
+
 // ============================================================================
 // Contrôles V4L2 Standards (pour ESPHome number components)
 // ============================================================================
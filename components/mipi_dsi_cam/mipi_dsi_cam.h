@@ -2,6 +2,8 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/automation.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include <string>
 #include <vector>
 
@@ -55,8 +57,10 @@ class MipiDSICamComponent : public Component {
   void set_xclk_freq(int f) { xclk_freq_ = f; }
   void set_sensor_addr(int a) { sensor_addr_ = a; }
   void set_resolution(const std::string &r) { resolution_ = r; }
+  void set_max_resolution(const std::string &r) { max_resolution_ = r; }  // Taille des buffers de streaming
   void set_pixel_format(const std::string &f) { pixel_format_ = f; }
-  void set_framerate(int f) { framerate_ = f; }
+  void set_framerate(int f);  // Appliqué en direct via VTS si le streaming est actif
+  void set_night_framerate(int f) { night_framerate_ = f; }  // 0 = mode nuit désactivé
   void set_jpeg_quality(int q) { jpeg_quality_ = q; }
 
   // Configuration mirror/rotate (PPA hardware si disponible)
@@ -80,7 +84,14 @@ class MipiDSICamComponent : public Component {
   bool is_streaming() const { return streaming_active_; }
   bool start_streaming();
   void stop_streaming();
+  // Change de résolution en streaming sans fermer /dev/video0 ni réallouer les buffers (limite: max_resolution)
+  bool switch_resolution(const std::string &resolution);
   bool capture_frame();
+  // Appelé après un changement de résolution (largeur, hauteur), depuis la tâche de switch_resolution():
+  // les encodeurs doivent se recréer à la nouvelle taille avant leur prochaine frame
+  void add_on_resolution_callback(std::function<void(uint16_t, uint16_t)> &&callback) {
+    this->resolution_callback_.add(std::move(callback));
+  }
 
   // Buffer pool APIs (thread-safe, zero-tearing)
   SimpleBufferElement* acquire_buffer();  // Acquiert buffer pour affichage (doit être libéré)
@@ -138,6 +149,9 @@ class MipiDSICamComponent : public Component {
   bool set_hue(int value);           // -180 à 180, défaut: 0
   bool set_sharpness(int value);     // 0 à 255 (filter/sharpness control)
 
+  // Fréquence d'images adaptative : le pipeline ISP passe à night_fps en faible lumière (0 = désactivé)
+  bool set_night_mode(int night_fps);
+
   // imlib - Dessin zero-copy sur buffer RGB565 (améliore fluidité)
   image_t* get_imlib_image();  // Retourne image_t wrappant le buffer caméra actuel
   void draw_string(int x, int y, const char *text, uint16_t color, float scale = 1.0f);
@@ -156,8 +170,10 @@ class MipiDSICamComponent : public Component {
   int xclk_freq_{24000000};
   int sensor_addr_{0x36};
   std::string resolution_{"720P"};
+  std::string max_resolution_;  // vide = buffers à la taille de resolution_
   std::string pixel_format_{"JPEG"};
   int framerate_{30};
+  int night_framerate_{0};
   int jpeg_quality_{10};
 
   // Configuration mirror/rotate (M5Stack-style PPA hardware)
@@ -193,8 +209,12 @@ class MipiDSICamComponent : public Component {
 
   // Buffer pool system (V4L2_MEMORY_USERPTR - zero-copy to SPIRAM)
   SimpleBufferElement simple_buffers_[3];  // Triple buffering
+  size_t buffer_capacity_{0};  // Taille allouée de chaque buffer (>= image_buffer_size_)
   int current_buffer_index_{-1};  // Index du buffer actuellement capturé (-1 = aucun)
+  uint8_t requeue_pending_{0};  // Bit i: simple_buffers_[i] tenu au dernier REQBUFS, à queuer à sa libération
   portMUX_TYPE buffer_mutex_;  // Spinlock pour thread-safety (initialisé dans setup)
+  SemaphoreHandle_t stream_lock_{nullptr};  // Sérialise capture_frame() et STREAMOFF/reconfiguration du flux
+  CallbackManager<void(uint16_t, uint16_t)> resolution_callback_;
 
   // Legacy pointer (deprecated, pointe vers current_buffer_ si disponible)
   uint8_t *image_buffer_{nullptr};
@@ -208,7 +228,15 @@ class MipiDSICamComponent : public Component {
   bool imlib_image_valid_{false};
 
   bool check_pipeline_health_();
+  bool apply_sensor_format_(uint32_t width, uint32_t height);
+  bool queue_user_buffer_(uint32_t index);
+  bool queue_user_buffers_();
+  void queue_released_buffers_();
+  bool configure_stream_(uint32_t width, uint32_t height);
+  bool capture_frame_();
   void cleanup_pipeline_();
+  bool apply_framerate_();
+  bool apply_night_mode_();
 
   // PPA (Pixel-Processing Accelerator) hardware transform functions
   bool init_ppa_();
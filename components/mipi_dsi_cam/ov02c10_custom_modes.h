@@ -0,0 +1,157 @@
+/*
+ * OV02C10 Custom Modes - description des modes compilée par sensor_format_compiler.h
+ *
+ * Note: Ces registres sont des TEMPLATES basés sur les formats standard OV02C10,
+ * ils devront être ajustés selon le datasheet OV02C10 réel. Il n'y a donc pas de
+ * modèle PLL : l'horloge pixel vient de la description du mode.
+ *
+ * Ce fichier ne dépend pas d'esp_cam_sensor, voir ov02c10_custom_formats.h
+ * pour les esp_cam_sensor_format_t.
+ */
+
+#pragma once
+
+#include "sensor_format_compiler.h"
+
+namespace esphome {
+namespace mipi_dsi_cam {
+namespace fmt {
+
+static constexpr uint16_t OV02C10_REG_END = 0xffff;
+static constexpr uint16_t OV02C10_REG_DELAY = 0xeeee;
+
+// Les modes custom sont des crops centrés du 1920x1080 natif
+static constexpr uint16_t OV02C10_CROP_WIDTH = 1920;
+static constexpr uint16_t OV02C10_CROP_HEIGHT = 1080;
+
+struct Ov02c10Mode {
+  uint32_t pclk;          // HTS × VTS × FPS
+  uint16_t hts;
+  uint16_t vts;
+  uint16_t width;
+  uint16_t height;
+  uint8_t bits_per_pixel;
+  uint8_t lanes;
+  uint32_t line_rate;
+};
+
+constexpr uint16_t ov02c10_x_offset(const Ov02c10Mode &m) { return static_cast<uint16_t>((OV02C10_CROP_WIDTH - m.width) / 2); }
+constexpr uint16_t ov02c10_y_offset(const Ov02c10Mode &m) { return static_cast<uint16_t>((OV02C10_CROP_HEIGHT - m.height) / 2); }
+
+constexpr bool ov02c10_mode_valid(const Ov02c10Mode &m) {
+  return m.width <= OV02C10_CROP_WIDTH && m.height <= OV02C10_CROP_HEIGHT && m.width < m.hts && m.height < m.vts;
+}
+
+// Taille de sortie, timing et crop centré du mode
+constexpr RegTable<12> ov02c10_timing_regs(const Ov02c10Mode &m) {
+  if (!ov02c10_mode_valid(m)) {
+    detail::description_error("mode OV02C10 incohérent");
+  }
+  return RegTable<12>{{
+      reg_hi(0x3808, m.width, 0x0f),
+      reg_lo(0x3809, m.width),
+      reg_hi(0x380a, m.height, 0x07),
+      reg_lo(0x380b, m.height),
+      reg_hi(0x380c, m.hts, 0xff),
+      reg_lo(0x380d, m.hts),
+      reg_hi(0x380e, m.vts, 0xff),
+      reg_lo(0x380f, m.vts),
+      reg_hi(0x3810, ov02c10_x_offset(m), 0x0f),
+      reg_lo(0x3811, ov02c10_x_offset(m)),
+      reg_hi(0x3812, ov02c10_y_offset(m), 0x07),
+      reg_lo(0x3813, ov02c10_y_offset(m)),
+  }};
+}
+
+constexpr Timing ov02c10_timing(const RegSpan &table, const Ov02c10Mode &m) {
+  return Timing{
+      m.pclk,
+      reg_value16(table, 0x380c, 0),
+      reg_value16(table, 0x380e, 0),
+      m.width,
+      m.height,
+      m.bits_per_pixel,
+      m.lanes,
+      m.line_rate,
+  };
+}
+
+// ============================================================================
+// Blocs partagés
+// ============================================================================
+
+static constexpr Reg OV02C10_RESET_REGS[] = {
+    // Software reset
+    {0x0103, 0x01},
+    {OV02C10_REG_DELAY, 0x0a},
+    {0x0100, 0x00},  // Standby
+
+    // PLL Configuration (basé sur 24MHz XCLK)
+    {0x0302, 0x32},  // PLL multiplier
+    {0x030e, 0x02},  // PLL divider
+};
+
+static constexpr Reg OV02C10_RAW10_COMMON_REGS[] = {
+    // Format: RAW10
+    {0x3820, 0x00},  // No flip
+    {0x3821, 0x00},  // No mirror
+};
+
+// ============================================================================
+// Configuration 1 : 1280x800 @ 30fps RAW10
+// ============================================================================
+
+static constexpr Ov02c10Mode OV02C10_MODE_1280X800_RAW10 = {
+    .pclk = 38250000,
+    .hts = 1500,
+    .vts = 850,
+    .width = 1280,
+    .height = 800,
+    .bits_per_pixel = 10,
+    .lanes = 1,
+    .line_rate = 400000000,  // 400MHz MIPI clock
+};
+
+static constexpr Reg OV02C10_1280X800_RAW10_OVERRIDES[] = {
+    {0x4837, 0x14},  // MIPI global timing
+};
+
+static constexpr auto OV02C10_1280X800_RAW10_TIMING_REGS = ov02c10_timing_regs(OV02C10_MODE_1280X800_RAW10);
+static constexpr auto ov02c10_1280x800_raw10_30fps_regs =
+    compile<OV02C10_REG_END, OV02C10_REG_DELAY, OV02C10_RESET_REGS, OV02C10_1280X800_RAW10_TIMING_REGS,
+            OV02C10_RAW10_COMMON_REGS, OV02C10_1280X800_RAW10_OVERRIDES>();
+static constexpr Timing ov02c10_1280x800_raw10_timing =
+    ov02c10_timing(ov02c10_1280x800_raw10_30fps_regs.span(), OV02C10_MODE_1280X800_RAW10);
+
+// ============================================================================
+// Configuration 2 : 800x480 @ 30fps RAW10
+// ============================================================================
+
+static constexpr Ov02c10Mode OV02C10_MODE_800X480_RAW10 = {
+    .pclk = 16569000,
+    .hts = 1050,
+    .vts = 526,
+    .width = 800,
+    .height = 480,
+    .bits_per_pixel = 10,
+    .lanes = 1,
+    .line_rate = 300000000,  // 300MHz MIPI clock (réduit pour 800x480)
+};
+
+static constexpr Reg OV02C10_800X480_RAW10_OVERRIDES[] = {
+    {0x4837, 0x1c},  // MIPI global timing (slower for 800x480)
+};
+
+static constexpr auto OV02C10_800X480_RAW10_TIMING_REGS = ov02c10_timing_regs(OV02C10_MODE_800X480_RAW10);
+static constexpr auto ov02c10_800x480_raw10_30fps_regs =
+    compile<OV02C10_REG_END, OV02C10_REG_DELAY, OV02C10_RESET_REGS, OV02C10_800X480_RAW10_TIMING_REGS,
+            OV02C10_RAW10_COMMON_REGS, OV02C10_800X480_RAW10_OVERRIDES>();
+static constexpr Timing ov02c10_800x480_raw10_timing =
+    ov02c10_timing(ov02c10_800x480_raw10_30fps_regs.span(), OV02C10_MODE_800X480_RAW10);
+
+static_assert(ov02c10_1280x800_raw10_timing.link_fits(), "OV02C10 1280x800 : débit MIPI insuffisant");
+static_assert(ov02c10_800x480_raw10_timing.link_fits(), "OV02C10 800x480 : débit MIPI insuffisant");
+
+}  // namespace fmt
+}  // namespace mipi_dsi_cam
+}  // namespace esphome
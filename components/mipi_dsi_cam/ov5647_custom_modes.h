@@ -0,0 +1,414 @@
+/*
+ * OV5647 Custom Modes - description des modes compilée par sensor_format_compiler.h
+ *
+ * Chaque mode = couche timing dérivée de Ov5647Mode + bloc commun RAW8 +
+ * blocs optionnels + surcharges du mode. Le reset logiciel, le délai qui le
+ * suit et le passage en streaming ne font pas partie des tables : le driver
+ * écrit ov5647_mipi_reset_regs avant chaque table et set_format() se termine
+ * par set_stream(0), qui reprogramme aussi 0x4800.
+ *
+ * Ce fichier ne dépend pas d'esp_cam_sensor, voir ov5647_custom_formats.h
+ * pour les esp_cam_sensor_format_t.
+ */
+
+#pragma once
+
+#include "sensor_format_compiler.h"
+
+namespace esphome {
+namespace mipi_dsi_cam {
+namespace fmt {
+
+static constexpr uint16_t OV5647_REG_END = 0xffff;
+static constexpr uint16_t OV5647_REG_DELAY = 0xeeee;
+
+// Matrice physique, pixels factices compris
+static constexpr uint16_t OV5647_ARRAY_WIDTH = 2624;
+static constexpr uint16_t OV5647_ARRAY_HEIGHT = 1956;
+
+static constexpr uint8_t OV5647_8BIT_MODE = 0x18;
+static constexpr uint8_t OV5647_10BIT_MODE = 0x1a;
+
+struct Ov5647Mode {
+  uint32_t xclk;
+  uint32_t idi_clock;     // horloge IDI visée, donne le multiplicateur PLL et le débit MIPI
+  uint8_t bit_mode;       // 0x3034
+  uint8_t sys_div;        // 0x3035
+  uint16_t hts;
+  uint16_t vts;           // VTS minimum du mode, AE ne fait que l'allonger
+  uint8_t x_inc;          // 0x3814, pas impair/pair en x
+  uint8_t y_inc;          // 0x3815
+  Window window;
+  uint16_t x_offset;      // décalage de la sortie dans la fenêtre sous-échantillonnée
+  uint16_t y_offset;
+  uint16_t width;
+  uint16_t height;
+  uint8_t bits_per_pixel;
+  uint8_t lanes;
+};
+
+// Convention des tables du driver (règle VCO à 25 MHz), conservée pour ne pas changer les valeurs programmées
+constexpr uint32_t ov5647_pll_multiplier(const Ov5647Mode &m) {
+  return static_cast<uint32_t>(static_cast<uint64_t>(m.idi_clock) * 8 * 4 / 25000000);
+}
+
+// Facteur de sous-échantillonnage d'un registre x_inc/y_inc : (pas impair + pas pair) / 2
+constexpr uint16_t ov5647_subsample(uint8_t inc) { return static_cast<uint16_t>(((inc >> 4) + (inc & 0x0f)) / 2); }
+
+constexpr bool ov5647_mode_valid(const Ov5647Mode &m) {
+  return m.window.x_start <= m.window.x_end && m.window.x_end < OV5647_ARRAY_WIDTH &&
+         m.window.y_start <= m.window.y_end && m.window.y_end < OV5647_ARRAY_HEIGHT &&
+         ov5647_subsample(m.x_inc) && ov5647_subsample(m.y_inc) &&
+         m.x_offset + m.width <= m.window.width() / ov5647_subsample(m.x_inc) &&
+         m.y_offset + m.height <= m.window.height() / ov5647_subsample(m.y_inc) &&
+         m.width < m.hts && m.height < m.vts &&
+         ov5647_pll_multiplier(m) >= 4 && ov5647_pll_multiplier(m) <= 0xff;
+}
+
+// Registres d'horloge, de timing et de géométrie du mode
+constexpr RegTable<25> ov5647_timing_regs(const Ov5647Mode &m) {
+  if (!ov5647_mode_valid(m)) {
+    detail::description_error("mode OV5647 incohérent");
+  }
+  return RegTable<25>{{
+      {0x3034, m.bit_mode},
+      {0x3035, m.sys_div},
+      reg_u8(0x3036, ov5647_pll_multiplier(m)),
+      reg_hi(0x380c, m.hts, 0x1f),
+      reg_lo(0x380d, m.hts),
+      reg_hi(0x380e, m.vts, 0xff),
+      reg_lo(0x380f, m.vts),
+      {0x3814, m.x_inc},
+      {0x3815, m.y_inc},
+      reg_hi(0x3800, m.window.x_start, 0x0f),
+      reg_lo(0x3801, m.window.x_start),
+      reg_hi(0x3802, m.window.y_start, 0x07),
+      reg_lo(0x3803, m.window.y_start),
+      reg_hi(0x3804, m.window.x_end, 0x0f),
+      reg_lo(0x3805, m.window.x_end),
+      reg_hi(0x3806, m.window.y_end, 0x07),
+      reg_lo(0x3807, m.window.y_end),
+      reg_hi(0x3808, m.width, 0x0f),
+      reg_lo(0x3809, m.width),
+      reg_hi(0x380a, m.height, 0x7f),
+      reg_lo(0x380b, m.height),
+      reg_hi(0x3810, m.x_offset, 0x0f),
+      reg_lo(0x3811, m.x_offset),
+      reg_hi(0x3812, m.y_offset, 0x07),
+      reg_lo(0x3813, m.y_offset),
+  }};
+}
+
+// Même calcul que ov5647_get_sysclk() du driver, à partir des registres que laisse la table
+constexpr uint32_t ov5647_sysclk(const RegSpan &table, uint32_t xclk) {
+  constexpr uint8_t pre_div02x_map[] = {2, 2, 4, 6, 8, 3, 12, 5, 16, 2, 2, 2, 2, 2, 2, 2};
+  constexpr uint8_t sdiv0_map[] = {16, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15};
+  constexpr uint8_t pll_rdiv_map[] = {1, 2};
+  constexpr uint8_t bit_div2x_map[] = {2, 2, 2, 2, 2, 2, 2, 2, 4, 2, 5, 2, 2, 2, 2, 2};
+  constexpr uint8_t sclk_div_map[] = {1, 2, 4, 1};
+
+  uint32_t xvclk = xclk / 10000;
+  uint8_t r3037 = reg_value(table, 0x3037, 0x03);  // non écrit par les tables, valeur de reset
+  uint32_t vco = xvclk * 2 / pre_div02x_map[r3037 & 0x0f] * reg_value(table, 0x3036, 0x00);
+  uint32_t sysclk = vco * 2 / sdiv0_map[reg_value(table, 0x3035, 0x00) >> 4] / pll_rdiv_map[(r3037 >> 4) & 0x01] /
+                    bit_div2x_map[reg_value(table, 0x3034, 0x00) & 0x0f] /
+                    sclk_div_map[(reg_value(table, 0x3106, 0x00) >> 2) & 0x03];
+  return sysclk * 10000;
+}
+
+constexpr Timing ov5647_timing(const RegSpan &table, const Ov5647Mode &m) {
+  return Timing{
+      ov5647_sysclk(table, m.xclk),
+      reg_value16(table, 0x380c, 0),
+      reg_value16(table, 0x380e, 0),
+      m.width,
+      m.height,
+      m.bits_per_pixel,
+      m.lanes,
+      static_cast<uint32_t>(static_cast<uint64_t>(m.idi_clock) * m.bits_per_pixel / m.lanes),
+  };
+}
+
+// ============================================================================
+// Blocs partagés
+// ============================================================================
+
+// Réglages communs des modes RAW8 (horloges, LSC, analogique, AEC/AGC, BLC)
+static constexpr Reg OV5647_RAW8_COMMON_REGS[] = {
+    {0x303c, 0x11},  // PLLS control
+    {0x3106, 0xf5},
+    {0x3821, 0x03},  // Horizontal binning + mirror (fix: sensor appears right-shifted)
+    {0x3820, 0x41},  // Vertical binning
+    {0x3827, 0xec},
+    {0x370c, 0x0f},
+    {0x3612, 0x59},
+    {0x3618, 0x00},
+    {0x5000, 0xff},  // Enable all ISP blocks
+
+    // LSC (Lens Shading Correction)
+    {0x583e, 0xf0},  // LSC max gain
+    {0x583f, 0x20},  // LSC min gain
+
+    {0x5002, 0x41},
+    {0x5003, 0x08},
+    {0x5a00, 0x08},
+    {0x3000, 0x00},
+    {0x3001, 0x00},
+    {0x3002, 0x00},
+    {0x3016, 0x08},
+    {0x3017, 0xe0},
+    {0x3018, 0x44},
+    {0x301c, 0xf8},
+    {0x301d, 0xf0},
+    {0x3a18, 0x00},
+    {0x3a19, 0xf8},
+    {0x3c01, 0x80},
+    {0x3c00, 0x40},
+    {0x3b07, 0x0c},
+    {0x3708, 0x64},
+    {0x3709, 0x52},
+
+    // Analog settings
+    {0x3630, 0x2e},
+    {0x3632, 0xe2},
+    {0x3633, 0x23},
+    {0x3634, 0x44},
+    {0x3636, 0x06},
+    {0x3620, 0x64},
+    {0x3621, 0xe0},
+    {0x3600, 0x37},
+    {0x3704, 0xa0},
+    {0x3703, 0x5a},
+    {0x3715, 0x78},
+    {0x3717, 0x01},
+    {0x3731, 0x02},
+    {0x370b, 0x60},
+    {0x3705, 0x1a},
+
+    // AEC/AGC settings
+    {0x3f05, 0x02},
+    {0x3f06, 0x10},
+    {0x3f01, 0x0a},
+    {0x3a08, 0x01},
+    {0x3a09, 0x27},
+    {0x3a0a, 0x00},
+    {0x3a0b, 0xf6},
+    {0x3a0d, 0x04},
+    {0x3a0e, 0x03},
+    {0x3a0f, 0x58},
+    {0x3a10, 0x50},
+    {0x3a1b, 0x58},
+    {0x3a1e, 0x50},
+    {0x3a11, 0x60},
+    {0x3a1f, 0x28},
+
+    // BLC (Black Level Calibration)
+    {0x4001, 0x02},
+    {0x4004, 0x02},
+    {0x4000, 0x09},
+    {0x4050, 0x6e},
+    {0x4051, 0x8f},
+};
+
+// AEC/AGC automatiques et réglage AWB des modes écran (VGA, 1024x600)
+static constexpr Reg OV5647_AUTO_CONTROL_REGS[] = {
+    {0x3503, 0x00},  // Enable auto exposure and auto gain (0x00 = both auto, 0x03 = both manual)
+
+    // AWB settings
+    {0x5180, 0xff},
+    {0x5181, 0xf2},
+    {0x5182, 0x00},
+    {0x5183, 0x14},
+    {0x5184, 0x25},
+    {0x5185, 0x24},
+    {0x5186, 0x09},
+    {0x5187, 0x09},
+    {0x5188, 0x0a},
+    {0x5189, 0x75},
+    {0x518a, 0x52},
+    {0x518b, 0xea},
+    {0x518c, 0xa8},
+    {0x518d, 0x42},
+    {0x518e, 0x38},
+    {0x518f, 0x56},
+    {0x5190, 0x42},
+    {0x5191, 0xf8},
+    {0x5192, 0x04},
+    {0x5193, 0x70},
+    {0x5194, 0xf0},
+    {0x5195, 0xf0},
+    {0x5196, 0x03},
+    {0x5197, 0x01},
+    {0x5198, 0x04},
+    {0x5199, 0x12},
+    {0x519a, 0x04},
+    {0x519b, 0x00},
+    {0x519c, 0x06},
+    {0x519d, 0x82},
+    {0x519e, 0x38},
+};
+
+// ============================================================================
+// Configuration 1 : VGA 640x480 @ 30fps RAW8
+// ============================================================================
+// Sous-échantillonnage 2x de tout le capteur (1296x966), la sortie 640x480 en est le coin
+// décalé de 4x3 : c'est le cadrage d'origine de ce mode, gardé tel quel.
+
+static constexpr Ov5647Mode OV5647_MODE_640X480_RAW8 = {
+    .xclk = 24000000,
+    .idi_clock = 48000000,
+    .bit_mode = OV5647_8BIT_MODE,
+    .sys_div = 0x21,
+    .hts = 1896,
+    .vts = 1080,
+    .x_inc = 0x31,
+    .y_inc = 0x31,
+    .window = {0, 12, 2592 - 1, 1944 - 1},
+    .x_offset = 4,
+    .y_offset = 3,
+    .width = 640,
+    .height = 480,
+    .bits_per_pixel = 8,
+    .lanes = 2,
+};
+
+static constexpr Reg OV5647_640X480_RAW8_OVERRIDES[] = {
+    {0x4837, 0x24},  // MIPI pclk period
+};
+
+static constexpr auto OV5647_640X480_RAW8_TIMING_REGS = ov5647_timing_regs(OV5647_MODE_640X480_RAW8);
+static constexpr auto ov5647_640x480_raw8_30fps_regs =
+    compile<OV5647_REG_END, OV5647_REG_DELAY, OV5647_640X480_RAW8_TIMING_REGS, OV5647_RAW8_COMMON_REGS,
+            OV5647_AUTO_CONTROL_REGS, OV5647_640X480_RAW8_OVERRIDES>();
+static constexpr Timing ov5647_640x480_raw8_timing =
+    ov5647_timing(ov5647_640x480_raw8_30fps_regs.span(), OV5647_MODE_640X480_RAW8);
+
+// ============================================================================
+// Configuration 2 : 1024x600 @ 30fps RAW8
+// ============================================================================
+// 1024x600 is a common resolution for 7" LCD displays, centre crop without subsampling
+
+static constexpr Ov5647Mode OV5647_MODE_1024X600_RAW8 = {
+    .xclk = 24000000,
+    .idi_clock = 72000000,
+    .bit_mode = OV5647_8BIT_MODE,
+    .sys_div = 0x21,
+    .hts = 2416,
+    .vts = 1300,
+    .x_inc = 0x11,
+    .y_inc = 0x11,
+    .window = {(2592 - 1024 * 2) / 2, (1944 - 600 * 2) / 2, (2592 - 1024 * 2) / 2 + 1024 * 2 - 1,
+               (1944 - 600 * 2) / 2 + 600 * 2 - 1},
+    .x_offset = 0,
+    .y_offset = 0,
+    .width = 1024,
+    .height = 600,
+    .bits_per_pixel = 8,
+    .lanes = 2,
+};
+
+static constexpr Reg OV5647_1024X600_RAW8_OVERRIDES[] = {
+    // Banding filter pour la ligne plus longue
+    {0x3a09, 0x4b},
+    {0x3a0a, 0x01},
+    {0x3a0b, 0x13},
+    {0x4004, 0x04},
+    {0x4837, 0x19},  // MIPI pclk period
+};
+
+static constexpr auto OV5647_1024X600_RAW8_TIMING_REGS = ov5647_timing_regs(OV5647_MODE_1024X600_RAW8);
+static constexpr auto ov5647_1024x600_raw8_30fps_regs =
+    compile<OV5647_REG_END, OV5647_REG_DELAY, OV5647_1024X600_RAW8_TIMING_REGS, OV5647_RAW8_COMMON_REGS,
+            OV5647_AUTO_CONTROL_REGS, OV5647_1024X600_RAW8_OVERRIDES>();
+static constexpr Timing ov5647_1024x600_raw8_timing =
+    ov5647_timing(ov5647_1024x600_raw8_30fps_regs.span(), OV5647_MODE_1024X600_RAW8);
+
+// ============================================================================
+// Configuration 3 : 800x640 @ 50fps RAW8 (from testov5647 working config)
+// ============================================================================
+// Même table que le format 800x640 du driver (crop X start 500, 2124x1954)
+
+static constexpr Ov5647Mode OV5647_MODE_800X640_RAW8 = {
+    .xclk = 24000000,
+    .idi_clock = 100000000,
+    .bit_mode = OV5647_8BIT_MODE,
+    .sys_div = 0x41,
+    .hts = 1896,
+    .vts = 984,
+    .x_inc = 0x31,
+    .y_inc = 0x31,
+    .window = {500, 0, 2624 - 1, 1954 - 1},
+    .x_offset = 8,
+    .y_offset = 0,
+    .width = 800,
+    .height = 640,
+    .bits_per_pixel = 8,
+    .lanes = 2,
+};
+
+static constexpr Reg OV5647_800X640_RAW8_OVERRIDES[] = {
+    reg_u8(0x4837, 1000000000 / (OV5647_MODE_800X640_RAW8.idi_clock / 4)),  // MIPI pclk period
+};
+
+static constexpr auto OV5647_800X640_RAW8_TIMING_REGS = ov5647_timing_regs(OV5647_MODE_800X640_RAW8);
+static constexpr auto ov5647_800x640_raw8_50fps_regs =
+    compile<OV5647_REG_END, OV5647_REG_DELAY, OV5647_800X640_RAW8_TIMING_REGS, OV5647_RAW8_COMMON_REGS,
+            OV5647_800X640_RAW8_OVERRIDES>();
+static constexpr Timing ov5647_800x640_raw8_timing =
+    ov5647_timing(ov5647_800x640_raw8_50fps_regs.span(), OV5647_MODE_800X640_RAW8);
+
+// ============================================================================
+// Configuration 4 : 800x640 @ 30fps YUV422 (YUYV) – pour RTSP / H.264 HW
+// ============================================================================
+// Ce mode sort directement du YUV422 YUYV : même fenêtre que le mode RAW8 800x640,
+// bloc minimal sans les réglages analog/AEC/AWB.
+
+static constexpr Ov5647Mode OV5647_MODE_800X640_YUV422 = {
+    .xclk = 24000000,
+    .idi_clock = 54687500,  // multiplicateur PLL 0x46
+    .bit_mode = OV5647_10BIT_MODE,
+    .sys_div = 0x21,
+    .hts = 1896,
+    .vts = 984,
+    .x_inc = 0x11,
+    .y_inc = 0x11,
+    .window = {500, 0, 2624 - 1, 1954 - 1},
+    .x_offset = 8,
+    .y_offset = 0,
+    .width = 800,
+    .height = 640,
+    .bits_per_pixel = 16,
+    .lanes = 2,
+};
+
+static constexpr Reg OV5647_800X640_YUV422_REGS[] = {
+    {0x303c, 0x11},
+    {0x3106, 0xf5},
+
+    // YUV422 YUYV
+    {0x4300, 0x30},  // YUV422, YUYV
+    {0x501f, 0x00},  // YUYV order
+    {0x5000, 0xff},  // ISP on
+    {0x5001, 0x01},  // color matrix on (sinon U/V foireux)
+    {0x503d, 0x00},  // AWB on
+
+    // Binning / orientation
+    {0x3821, 0x03},
+    {0x3820, 0x41},
+    {0x3827, 0xec},
+};
+
+static constexpr auto OV5647_800X640_YUV422_TIMING_REGS = ov5647_timing_regs(OV5647_MODE_800X640_YUV422);
+static constexpr auto ov5647_800x640_yuv422_30fps_regs =
+    compile<OV5647_REG_END, OV5647_REG_DELAY, OV5647_800X640_YUV422_TIMING_REGS, OV5647_800X640_YUV422_REGS>();
+static constexpr Timing ov5647_800x640_yuv422_timing =
+    ov5647_timing(ov5647_800x640_yuv422_30fps_regs.span(), OV5647_MODE_800X640_YUV422);
+
+static_assert(ov5647_640x480_raw8_timing.link_fits(), "OV5647 640x480 : débit MIPI insuffisant");
+static_assert(ov5647_1024x600_raw8_timing.link_fits(), "OV5647 1024x600 : débit MIPI insuffisant");
+static_assert(ov5647_800x640_raw8_timing.link_fits(), "OV5647 800x640 : débit MIPI insuffisant");
+static_assert(ov5647_800x640_yuv422_timing.link_fits(), "OV5647 800x640 YUV422 : débit MIPI insuffisant");
+
+}  // namespace fmt
+}  // namespace mipi_dsi_cam
+}  // namespace esphome
@@ -3,214 +3,31 @@
  * Support for VGA resolution: 640×480
  *
  * SC202CS native resolution is 1600×1200
- * VGA format uses 2×2 binning + centered crop for optimal quality
+ * VGA format uses a centered crop for optimal quality
+ *
+ * Les tables de registres et le timing sont compilés depuis
+ * sc202cs_custom_modes.h, seuls les réglages propres à esp_cam_sensor
+ * (exposition/gain par défaut, bayer) sont décrits ici.
  */
 
 #pragma once
 
 #include <stdint.h>
 #include "esp_cam_sensor_types.h"
+#include "sc202cs_custom_modes.h"
 
-#ifdef __cplusplus
-extern "C" {
-#endif
-
-// Type pour registre SC202CS
-typedef struct {
-    uint16_t addr;
-    uint8_t val;
-} sc202cs_reginfo_t;
-
-#ifndef ARRAY_SIZE
-#define ARRAY_SIZE(arr) (sizeof(arr) / sizeof((arr)[0]))
-#endif
-
-// SC202CS register markers
-#define SC202CS_REG_END        0xFFFF
-#define SC202CS_REG_SLEEP_MODE 0x0100
-
-// Clock and timing constants for VGA
-#define SC202CS_IDI_CLOCK_RATE_VGA_30FPS     (36000000ULL)
-#define SC202CS_MIPI_CSI_LINE_RATE_VGA_30FPS (SC202CS_IDI_CLOCK_RATE_VGA_30FPS * 2)  // 1-lane MIPI
+namespace cam_fmt = esphome::mipi_dsi_cam::fmt;
 
 // ============================================================================
 // Configuration : VGA 640×480 @ 30fps RAW8
 // ============================================================================
-// // cleaned_0x18_FT_SC2356_24Minput_576Mbps_1lane_8bit_1280x720_30fps
-// Optimized for small LCD displays
-
-static const sc202cs_reginfo_t sc202cs_vga_640x480_raw8_30fps[] = {
-    // Software reset
-    {0x0103, 0x01},
-    {SC202CS_REG_SLEEP_MODE, 0x00},  // Wake up
-
-    // PLL Configuration (for 24MHz XCLK)
-    {0x36e9, 0x80},  // PLL enable
-    {0x36ea, 0x06},  // PLL config
-    {0x36eb, 0x0a},
-    {0x36ec, 0x01},
-    {0x36ed, 0x18},
-    {0x36e9, 0x24},  // PLL lock
-
-    // Output format: RAW8
-    {0x301f, 0x18},  // RAW8 mode
-    {0x3031, 0x08},
-    {0x3037, 0x00},
-
-    // Crop window (centered for VGA from 1600×1200)
-    // X start: (1600 - 640*2) / 2 = 160
-    {0x3200, 0x00},  // X start high
-    {0x3201, 0xa0},  // X start low (160)
-    // Y start: (1200 - 480*2) / 2 = 120
-    {0x3202, 0x00},  // Y start high
-    {0x3203, 0x78},  // Y start low (120)
-    // X end: 160 + 640*2 - 1 = 1439
-    {0x3204, 0x05},  // X end high
-    {0x3205, 0x9f},  // X end low
-    // Y end: 120 + 480*2 - 1 = 1079
-    {0x3206, 0x04},  // Y end high
-    {0x3207, 0x37},  // Y end low
-
-    // Output size: 640×480
-    {0x3208, 0x02},  // Width high (0x0280 = 640)
-    {0x3209, 0x80},  // Width low
-    {0x320a, 0x01},  // Height high (0x01E0 = 480)
-    {0x320b, 0xe0},  // Height low
-
-    // Offset
-    {0x3210, 0x00},  // H offset high
-    {0x3211, 0x04},  // H offset low
-    {0x3212, 0x00},  // V offset high
-    {0x3213, 0x04},  // V offset low
-
-    // Timing (HTS/VTS for 30fps)
-    {0x320e, 0x03},  // VTS high (990 lines)
-    {0x320f, 0xde},  // VTS low
-
-    // Sensor core configuration
-    {0x3301, 0xff},
-    {0x3304, 0x68},
-    {0x3306, 0x40},
-    {0x3308, 0x08},
-    {0x3309, 0xa8},
-    {0x330b, 0xd0},
-    {0x330c, 0x18},
-    {0x330d, 0xff},
-    {0x330e, 0x20},
-    {0x331e, 0x59},
-    {0x331f, 0x99},
-    {0x3333, 0x10},
-    {0x335e, 0x06},
-    {0x335f, 0x08},
-    {0x3364, 0x1f},
-    {0x337c, 0x02},
-    {0x337d, 0x0a},
-    {0x338f, 0xa0},
-    {0x3390, 0x01},
-    {0x3391, 0x03},
-    {0x3392, 0x1f},
-    {0x3393, 0xff},
-    {0x3394, 0xff},
-    {0x3395, 0xff},
-    {0x33a2, 0x04},
-    {0x33ad, 0x0c},
-    {0x33b1, 0x20},
-    {0x33b3, 0x38},
-    {0x33f9, 0x40},
-    {0x33fb, 0x48},
-    {0x33fc, 0x0f},
-    {0x33fd, 0x1f},
-    {0x349f, 0x03},
-    {0x34a6, 0x03},
-    {0x34a7, 0x1f},
-    {0x34a8, 0x38},
-    {0x34a9, 0x30},
-    {0x34ab, 0xd0},
-    {0x34ad, 0xd8},
-    {0x34f8, 0x1f},
-    {0x34f9, 0x20},
-
-    // Analog settings
-    {0x3630, 0xa0},
-    {0x3631, 0x92},
-    {0x3632, 0x64},
-    {0x3633, 0x43},
-    {0x3637, 0x49},
-    {0x363a, 0x85},
-    {0x363c, 0x0f},
-    {0x3650, 0x31},
-    {0x3670, 0x0d},
-    {0x3674, 0xc0},
-    {0x3675, 0xa0},
-    {0x3676, 0xa0},
-    {0x3677, 0x92},
-    {0x3678, 0x96},
-    {0x3679, 0x9a},
-    {0x367c, 0x03},
-    {0x367d, 0x0f},
-    {0x367e, 0x01},
-    {0x367f, 0x0f},
-    {0x3698, 0x83},
-    {0x3699, 0x86},
-    {0x369a, 0x8c},
-    {0x369b, 0x94},
-    {0x36a2, 0x01},
-    {0x36a3, 0x03},
-    {0x36a4, 0x07},
-    {0x36ae, 0x0f},
-    {0x36af, 0x1f},
-    {0x36bd, 0x22},
-    {0x36be, 0x22},
-    {0x36bf, 0x22},
-    {0x36d0, 0x01},
-    {0x370f, 0x02},
-    {0x3721, 0x6c},
-    {0x3722, 0x8d},
-    {0x3725, 0xc5},
-    {0x3727, 0x14},
-    {0x3728, 0x04},
-    {0x37b7, 0x04},
-    {0x37b8, 0x04},
-    {0x37b9, 0x06},
-    {0x37bd, 0x07},
-    {0x37be, 0x0f},
-
-    // AEC/AGC settings (optimized for VGA)
-    {0x3901, 0x02},
-    {0x3903, 0x40},
-    {0x3905, 0x8d},
-    {0x3907, 0x00},
-    {0x3908, 0x41},
-    {0x391f, 0x41},
-    {0x3933, 0x80},
-    {0x3934, 0x02},
-    {0x3937, 0x6f},
-    {0x393a, 0x01},
-    {0x393d, 0x01},
-    {0x393e, 0xc0},
-    {0x39dd, 0x41},
-
- 
-    {0x3e00, 0x00},  // Exposure high
-    {0x3e01, 0x4d},  // Exposure mid = 77 
-    {0x3e02, 0xc0},  // Exposure low
-    {0x3e08, 0x1f},  // AEC/AGC enable (0x1f = enable auto exposure & auto gain)
-    {0x3e09, 0x00},  // Gain
-
-    // Digital gain
-    {0x4509, 0x28},
-    {0x450d, 0x61},
-
-    // End marker
-    {SC202CS_REG_END, 0x00},
-};
 
 static const esp_cam_sensor_isp_info_t sc202cs_vga_isp_info = {
     .isp_v1_info = {
         .version = SENSOR_ISP_INFO_VERSION_DEFAULT,
-        .pclk = 28800000,     // Approximate pixel clock for VGA @ 30fps
-        .hts = 1500,          // Horizontal Total Size (adjusted for VGA)
-        .vts = 990,           // Vertical Total Size (for 30fps)
+        .pclk = cam_fmt::sc202cs_vga_raw8_timing.pclk,
+        .hts = cam_fmt::sc202cs_vga_raw8_timing.hts,
+        .vts = cam_fmt::sc202cs_vga_raw8_timing.vts,
         .exp_def = 0x4dc,     // 1244 - matching SC2336 working config
         .gain_def = 0,        // No default gain - matching SC2336
         .bayer_type = ESP_CAM_SENSOR_BAYER_BGGR,  // SC202CS is BGGR
@@ -224,18 +41,14 @@ static const esp_cam_sensor_format_t sc202cs_format_vga_raw8_30fps = {
     .xclk = 24000000,
     .width = 640,
     .height = 480,
-    .regs = sc202cs_vga_640x480_raw8_30fps,
-    .regs_size = ARRAY_SIZE(sc202cs_vga_640x480_raw8_30fps),
+    .regs = cam_fmt::sc202cs_vga_640x480_raw8_30fps_regs.regs,
+    .regs_size = cam_fmt::sc202cs_vga_640x480_raw8_30fps_regs.size(),
     .fps = 30,
     .isp_info = &sc202cs_vga_isp_info,
     .mipi_info = {
-        .mipi_clk = SC202CS_MIPI_CSI_LINE_RATE_VGA_30FPS,
-        .lane_num = 1,  // SC202CS uses 1-lane MIPI
+        .mipi_clk = cam_fmt::sc202cs_vga_raw8_timing.line_rate,
+        .lane_num = cam_fmt::sc202cs_vga_raw8_timing.lanes,  // SC202CS uses 1-lane MIPI
         .line_sync_en = false,
     },
     .reserved = NULL,
 };
-
-#ifdef __cplusplus
-}
-#endif
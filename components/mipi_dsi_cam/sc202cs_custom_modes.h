@@ -0,0 +1,254 @@
+/*
+ * SC202CS Custom Modes - description des modes compilée par sensor_format_compiler.h
+ *
+ * SC202CS native resolution is 1600×1200. Les modes custom reprennent un
+ * préréglage PLL des formats du driver, dont l'horloge pixel, le HTS par défaut
+ * et le débit MIPI sont connus : seule la géométrie et le VTS sont décrits ici.
+ *
+ * Ce fichier ne dépend pas d'esp_cam_sensor, voir sc202cs_custom_formats.h
+ * pour les esp_cam_sensor_format_t.
+ */
+
+#pragma once
+
+#include "sensor_format_compiler.h"
+
+namespace esphome {
+namespace mipi_dsi_cam {
+namespace fmt {
+
+static constexpr uint16_t SC202CS_REG_END = 0xffff;
+static constexpr uint16_t SC202CS_REG_DELAY = 0xfffe;
+
+static constexpr uint16_t SC202CS_ARRAY_WIDTH = 1600;
+static constexpr uint16_t SC202CS_ARRAY_HEIGHT = 1200;
+
+// Préréglage PLL 24 MHz → 576 Mbps 1 lane des formats RAW8 du driver (1280x720, 1600x1200)
+static constexpr Reg SC202CS_PLL_576M_REGS[] = {
+    {0x36e9, 0x80},  // PLL enable
+    {0x36ea, 0x06},  // PLL config
+    {0x36eb, 0x0a},
+    {0x36ec, 0x01},
+    {0x36ed, 0x18},
+    {0x36e9, 0x24},  // PLL lock
+};
+static constexpr uint32_t SC202CS_PLL_576M_LINE_RATE = 576000000;
+static constexpr uint32_t SC202CS_PLL_576M_PCLK = 72000000;
+static constexpr uint16_t SC202CS_PLL_576M_HTS = 1920;  // 0x320c/0x320d non programmés
+
+struct Sc202csMode {
+  Window window;
+  uint16_t x_offset;      // décalage de la sortie dans la fenêtre
+  uint16_t y_offset;
+  uint16_t width;
+  uint16_t height;
+  uint16_t vts;           // VTS minimum du mode, AE ne fait que l'allonger
+};
+
+constexpr bool sc202cs_mode_valid(const Sc202csMode &m) {
+  return m.window.x_start <= m.window.x_end && m.window.x_end < SC202CS_ARRAY_WIDTH &&
+         m.window.y_start <= m.window.y_end && m.window.y_end < SC202CS_ARRAY_HEIGHT &&
+         m.x_offset + m.width <= m.window.width() && m.y_offset + m.height <= m.window.height() &&
+         m.width < SC202CS_PLL_576M_HTS && m.height < m.vts;
+}
+
+// Fenêtre, taille de sortie, décalage et VTS du mode
+constexpr RegTable<18> sc202cs_timing_regs(const Sc202csMode &m) {
+  if (!sc202cs_mode_valid(m)) {
+    detail::description_error("mode SC202CS incohérent");
+  }
+  return RegTable<18>{{
+      reg_hi(0x3200, m.window.x_start, 0x07),
+      reg_lo(0x3201, m.window.x_start),
+      reg_hi(0x3202, m.window.y_start, 0x07),
+      reg_lo(0x3203, m.window.y_start),
+      reg_hi(0x3204, m.window.x_end, 0x07),
+      reg_lo(0x3205, m.window.x_end),
+      reg_hi(0x3206, m.window.y_end, 0x07),
+      reg_lo(0x3207, m.window.y_end),
+      reg_hi(0x3208, m.width, 0x07),
+      reg_lo(0x3209, m.width),
+      reg_hi(0x320a, m.height, 0x07),
+      reg_lo(0x320b, m.height),
+      reg_hi(0x3210, m.x_offset, 0x07),
+      reg_lo(0x3211, m.x_offset),
+      reg_hi(0x3212, m.y_offset, 0x07),
+      reg_lo(0x3213, m.y_offset),
+      reg_hi(0x320e, m.vts, 0x7f),
+      reg_lo(0x320f, m.vts),
+  }};
+}
+
+constexpr Timing sc202cs_timing(const RegSpan &table, const Sc202csMode &m) {
+  return Timing{
+      SC202CS_PLL_576M_PCLK,
+      SC202CS_PLL_576M_HTS,
+      reg_value16(table, 0x320e, 0),
+      m.width,
+      m.height,
+      8,
+      1,
+      SC202CS_PLL_576M_LINE_RATE,
+  };
+}
+
+// ============================================================================
+// Blocs partagés
+// ============================================================================
+
+static constexpr Reg SC202CS_RESET_REGS[] = {
+    // Software reset
+    {0x0103, 0x01},
+    {0x0100, 0x00},  // Wake up
+};
+
+static constexpr Reg SC202CS_RAW8_REGS[] = {
+    // Output format: RAW8
+    {0x301f, 0x18},  // RAW8 mode
+    {0x3031, 0x08},
+    {0x3037, 0x00},
+};
+
+// cleaned_0x18_FT_SC2356_24Minput_576Mbps_1lane_8bit_1280x720_30fps
+static constexpr Reg SC202CS_CORE_REGS[] = {
+    // Sensor core configuration
+    {0x3301, 0xff},
+    {0x3304, 0x68},
+    {0x3306, 0x40},
+    {0x3308, 0x08},
+    {0x3309, 0xa8},
+    {0x330b, 0xd0},
+    {0x330c, 0x18},
+    {0x330d, 0xff},
+    {0x330e, 0x20},
+    {0x331e, 0x59},
+    {0x331f, 0x99},
+    {0x3333, 0x10},
+    {0x335e, 0x06},
+    {0x335f, 0x08},
+    {0x3364, 0x1f},
+    {0x337c, 0x02},
+    {0x337d, 0x0a},
+    {0x338f, 0xa0},
+    {0x3390, 0x01},
+    {0x3391, 0x03},
+    {0x3392, 0x1f},
+    {0x3393, 0xff},
+    {0x3394, 0xff},
+    {0x3395, 0xff},
+    {0x33a2, 0x04},
+    {0x33ad, 0x0c},
+    {0x33b1, 0x20},
+    {0x33b3, 0x38},
+    {0x33f9, 0x40},
+    {0x33fb, 0x48},
+    {0x33fc, 0x0f},
+    {0x33fd, 0x1f},
+    {0x349f, 0x03},
+    {0x34a6, 0x03},
+    {0x34a7, 0x1f},
+    {0x34a8, 0x38},
+    {0x34a9, 0x30},
+    {0x34ab, 0xd0},
+    {0x34ad, 0xd8},
+    {0x34f8, 0x1f},
+    {0x34f9, 0x20},
+
+    // Analog settings
+    {0x3630, 0xa0},
+    {0x3631, 0x92},
+    {0x3632, 0x64},
+    {0x3633, 0x43},
+    {0x3637, 0x49},
+    {0x363a, 0x85},
+    {0x363c, 0x0f},
+    {0x3650, 0x31},
+    {0x3670, 0x0d},
+    {0x3674, 0xc0},
+    {0x3675, 0xa0},
+    {0x3676, 0xa0},
+    {0x3677, 0x92},
+    {0x3678, 0x96},
+    {0x3679, 0x9a},
+    {0x367c, 0x03},
+    {0x367d, 0x0f},
+    {0x367e, 0x01},
+    {0x367f, 0x0f},
+    {0x3698, 0x83},
+    {0x3699, 0x86},
+    {0x369a, 0x8c},
+    {0x369b, 0x94},
+    {0x36a2, 0x01},
+    {0x36a3, 0x03},
+    {0x36a4, 0x07},
+    {0x36ae, 0x0f},
+    {0x36af, 0x1f},
+    {0x36bd, 0x22},
+    {0x36be, 0x22},
+    {0x36bf, 0x22},
+    {0x36d0, 0x01},
+    {0x370f, 0x02},
+    {0x3721, 0x6c},
+    {0x3722, 0x8d},
+    {0x3725, 0xc5},
+    {0x3727, 0x14},
+    {0x3728, 0x04},
+    {0x37b7, 0x04},
+    {0x37b8, 0x04},
+    {0x37b9, 0x06},
+    {0x37bd, 0x07},
+    {0x37be, 0x0f},
+
+    // AEC/AGC settings
+    {0x3901, 0x02},
+    {0x3903, 0x40},
+    {0x3905, 0x8d},
+    {0x3907, 0x00},
+    {0x3908, 0x41},
+    {0x391f, 0x41},
+    {0x3933, 0x80},
+    {0x3934, 0x02},
+    {0x3937, 0x6f},
+    {0x393a, 0x01},
+    {0x393d, 0x01},
+    {0x393e, 0xc0},
+    {0x39dd, 0x41},
+
+    {0x3e00, 0x00},  // Exposure high
+    {0x3e01, 0x4d},  // Exposure mid = 77
+    {0x3e02, 0xc0},  // Exposure low
+    {0x3e08, 0x1f},  // AEC/AGC enable (0x1f = enable auto exposure & auto gain)
+    {0x3e09, 0x00},  // Gain
+
+    // Digital gain
+    {0x4509, 0x28},
+    {0x450d, 0x61},
+};
+
+// ============================================================================
+// Configuration : VGA 640×480 @ 30fps RAW8
+// ============================================================================
+// Crop centré 1280x960 depuis 1600×1200, sortie 640x480 décalée de 4x4
+
+static constexpr Sc202csMode SC202CS_MODE_VGA_RAW8 = {
+    .window = {(1600 - 640 * 2) / 2, (1200 - 480 * 2) / 2, (1600 - 640 * 2) / 2 + 640 * 2 - 1,
+               (1200 - 480 * 2) / 2 + 480 * 2 - 1},
+    .x_offset = 4,
+    .y_offset = 4,
+    .width = 640,
+    .height = 480,
+    .vts = 990,
+};
+
+static constexpr auto SC202CS_VGA_RAW8_TIMING_REGS = sc202cs_timing_regs(SC202CS_MODE_VGA_RAW8);
+static constexpr auto sc202cs_vga_640x480_raw8_30fps_regs =
+    compile<SC202CS_REG_END, SC202CS_REG_DELAY, SC202CS_RESET_REGS, SC202CS_PLL_576M_REGS, SC202CS_RAW8_REGS,
+            SC202CS_VGA_RAW8_TIMING_REGS, SC202CS_CORE_REGS>();
+static constexpr Timing sc202cs_vga_raw8_timing =
+    sc202cs_timing(sc202cs_vga_640x480_raw8_30fps_regs.span(), SC202CS_MODE_VGA_RAW8);
+
+static_assert(sc202cs_vga_raw8_timing.link_fits(), "SC202CS VGA : débit MIPI insuffisant");
+
+}  // namespace fmt
+}  // namespace mipi_dsi_cam
+}  // namespace esphome
@@ -0,0 +1,211 @@
+/*
+ * Compilateur de tables de formats capteur (C++17 constexpr)
+ *
+ * Un mode se décrit par couches : une table de base partagée entre les modes,
+ * des blocs optionnels et les surcharges propres au mode. Les registres de
+ * timing (PLL, HTS/VTS, fenêtre, taille de sortie) sont dérivés d'une
+ * description numérique par le fichier du capteur au lieu d'être découpés à
+ * la main en octets.
+ *
+ * compile<>() fusionne les couches à la compilation en un seul tableau
+ * terminé par le marqueur de fin, rangé en flash comme les anciennes tables.
+ * Un registre surchargé est remplacé à sa place, il n'est jamais écrit deux
+ * fois. Toute description incohérente (valeur qui ne tient pas dans son champ,
+ * surcharge ambiguë, fenêtre hors capteur) est une erreur de compilation.
+ *
+ * Ce fichier ne dépend que de la libc pour que les descriptions de modes
+ * soient testables sur l'hôte (test_apps/host).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace esphome {
+namespace mipi_dsi_cam {
+namespace fmt {
+
+// Une écriture de registre, même disposition que les xxx_reginfo_t des drivers (adresse 16 bits, valeur 8 bits)
+struct Reg {
+  uint16_t addr;
+  uint8_t val;
+};
+
+static_assert(sizeof(Reg) == 4 && offsetof(Reg, val) == 2, "Reg doit rester compatible avec les tables des drivers");
+
+// Vue sur une liste de registres en flash
+struct RegSpan {
+  const Reg *regs;
+  size_t num;
+};
+
+// Table produite par compile<>(), regs est passé tel quel à esp_cam_sensor_format_t::regs
+template<size_t N> struct RegTable {
+  Reg regs[N];
+
+  constexpr size_t size() const { return N; }
+  constexpr RegSpan span() const { return RegSpan{this->regs, N}; }
+};
+
+// Marqueurs de la table d'un capteur
+struct Markers {
+  uint16_t end;
+  uint16_t delay;
+};
+
+namespace detail {
+
+// Jamais constexpr : l'atteindre pendant l'évaluation d'une table est une erreur de compilation
+inline void description_error(const char *what) { (void) what; }
+
+template<size_t N> constexpr RegSpan to_span(const Reg (&regs)[N]) { return RegSpan{regs, N}; }
+template<size_t N> constexpr RegSpan to_span(const RegTable<N> &table) { return table.span(); }
+
+template<size_t CAP> struct Merger {
+  Reg regs[CAP]{};
+  uint8_t layer[CAP]{};
+  size_t num{0};
+
+  constexpr void append(const Reg &reg, uint8_t from) {
+    this->regs[this->num] = reg;
+    this->layer[this->num] = from;
+    this->num++;
+  }
+
+  constexpr void add(const Reg &reg, uint8_t from, const Markers &markers) {
+    if (reg.addr == markers.end) {
+      description_error("le marqueur de fin est ajouté par compile<>()");
+      return;
+    }
+    if (reg.addr == markers.delay) {
+      this->append(reg, from);
+      return;
+    }
+
+    size_t found = 0;
+    size_t pos = 0;
+    bool same_layer = true;
+    for (size_t i = 0; i < this->num; i++) {
+      if (this->regs[i].addr == reg.addr) {
+        found++;
+        pos = i;
+        same_layer = same_layer && this->layer[i] == from;
+      }
+    }
+
+    if (found == 0 || same_layer) {
+      // Nouveau registre, ou registre de séquencement écrit plusieurs fois par sa propre couche
+      this->append(reg, from);
+    } else if (found == 1) {
+      this->regs[pos].val = reg.val;
+      this->layer[pos] = from;
+    } else {
+      description_error("surcharge d'un registre de séquencement");
+    }
+  }
+};
+
+template<size_t N> struct Layers {
+  RegSpan spans[N];
+};
+
+template<size_t CAP, size_t N> constexpr Merger<CAP> merge(const Markers &markers, const Layers<N> &layers) {
+  Merger<CAP> merger{};
+  for (size_t l = 0; l < N; l++) {
+    for (size_t i = 0; i < layers.spans[l].num; i++) {
+      merger.add(layers.spans[l].regs[i], static_cast<uint8_t>(l), markers);
+    }
+  }
+  merger.append(Reg{markers.end, 0x00}, static_cast<uint8_t>(N));
+  return merger;
+}
+
+}  // namespace detail
+
+// Fusionne les couches dans l'ordre, la première sert de base et fixe l'ordre d'écriture
+template<uint16_t END, uint16_t DELAY, const auto &... LAYERS> constexpr auto compile() {
+  constexpr Markers markers{END, DELAY};
+  constexpr size_t cap = (detail::to_span(LAYERS).num + ... + 1);
+  constexpr auto merged = detail::merge<cap>(markers, detail::Layers<sizeof...(LAYERS)>{{detail::to_span(LAYERS)...}});
+
+  RegTable<merged.num> table{};
+  for (size_t i = 0; i < merged.num; i++) {
+    table.regs[i] = merged.regs[i];
+  }
+  return table;
+}
+
+// Octet de poids fort d'un champ 16 bits, mask donne les bits implémentés par le capteur
+constexpr Reg reg_hi(uint16_t addr, uint32_t value, uint8_t mask) {
+  if ((value >> 8) & ~static_cast<uint32_t>(mask)) {
+    detail::description_error("valeur trop grande pour le registre");
+  }
+  return Reg{addr, static_cast<uint8_t>(value >> 8)};
+}
+
+constexpr Reg reg_lo(uint16_t addr, uint32_t value) { return Reg{addr, static_cast<uint8_t>(value & 0xff)}; }
+
+constexpr Reg reg_u8(uint16_t addr, uint32_t value) {
+  if (value > 0xff) {
+    detail::description_error("valeur trop grande pour le registre");
+  }
+  return Reg{addr, static_cast<uint8_t>(value)};
+}
+
+// Valeur que la table laisse dans un registre, dflt (valeur de reset) si elle ne l'écrit pas
+constexpr uint8_t reg_value(const RegSpan &table, uint16_t addr, uint8_t dflt) {
+  uint8_t val = dflt;
+  for (size_t i = 0; i < table.num; i++) {
+    if (table.regs[i].addr == addr) {
+      val = table.regs[i].val;
+    }
+  }
+  return val;
+}
+
+constexpr uint16_t reg_value16(const RegSpan &table, uint16_t addr_hi, uint16_t dflt) {
+  return static_cast<uint16_t>((reg_value(table, addr_hi, dflt >> 8) << 8) |
+                               reg_value(table, static_cast<uint16_t>(addr_hi + 1), dflt & 0xff));
+}
+
+// Fenêtre lue sur la matrice du capteur, bornes incluses
+struct Window {
+  uint16_t x_start;
+  uint16_t y_start;
+  uint16_t x_end;
+  uint16_t y_end;
+
+  constexpr uint16_t width() const { return static_cast<uint16_t>(this->x_end - this->x_start + 1); }
+  constexpr uint16_t height() const { return static_cast<uint16_t>(this->y_end - this->y_start + 1); }
+};
+
+// Timing d'un mode tel que le driver le programme, pclk compte les pixels de HTS
+struct Timing {
+  uint32_t pclk;
+  uint16_t hts;
+  uint16_t vts;
+  uint16_t width;
+  uint16_t height;
+  uint8_t bits_per_pixel;
+  uint8_t lanes;
+  uint32_t line_rate;  // débit par lane en bit/s, esp_cam_sensor_format_t::mipi_info.mipi_clk
+
+  // VTS de la table est le minimum accepté par set_vts(), c'est donc la cadence maximale du mode
+  constexpr uint32_t max_fps_x100() const {
+    return static_cast<uint32_t>(static_cast<uint64_t>(this->pclk) * 100 / (static_cast<uint32_t>(this->hts) * this->vts));
+  }
+  constexpr uint32_t max_fps() const { return this->max_fps_x100() / 100; }
+
+  // Débit utile moyen : width pixels par ligne, pclk / hts lignes par seconde
+  constexpr uint64_t payload_bps() const {
+    return static_cast<uint64_t>(this->width) * this->bits_per_pixel * this->pclk / this->hts;
+  }
+  constexpr bool link_fits() const {
+    return this->payload_bps() <= static_cast<uint64_t>(this->line_rate) * this->lanes;
+  }
+};
+
+}  // namespace fmt
+}  // namespace mipi_dsi_cam
+}  // namespace esphome
@@ -0,0 +1,163 @@
+/*
+ * Tests des modes custom compilés par sensor_format_compiler.h
+ *
+ * Les tables sont rejouées dans une image des registres du capteur, indépendamment
+ * des helpers du compilateur, pour vérifier que la géométrie programmée correspond
+ * au timing déclaré au pipeline.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "unity.h"
+
+#include "esp_cam_sensor_regdelta.h"
+#include "ov5647_custom_modes.h"
+#include "ov02c10_custom_modes.h"
+#include "sc202cs_custom_modes.h"
+
+namespace fmt = esphome::mipi_dsi_cam::fmt;
+
+namespace {
+
+struct ModeCase {
+  const char *name;
+  fmt::RegSpan regs;
+  const fmt::Timing *timing;
+  uint16_t end_marker;
+  uint16_t delay_marker;
+  uint16_t hts_reg;     // registre haut de HTS, 0 si HTS n'est pas programmé
+  uint16_t vts_reg;
+  uint16_t width_reg;
+  uint16_t height_reg;
+};
+
+const ModeCase MODE_CASES[] = {
+    {"ov5647 640x480 raw8", fmt::ov5647_640x480_raw8_30fps_regs.span(), &fmt::ov5647_640x480_raw8_timing,
+     fmt::OV5647_REG_END, fmt::OV5647_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"ov5647 1024x600 raw8", fmt::ov5647_1024x600_raw8_30fps_regs.span(), &fmt::ov5647_1024x600_raw8_timing,
+     fmt::OV5647_REG_END, fmt::OV5647_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"ov5647 800x640 raw8", fmt::ov5647_800x640_raw8_50fps_regs.span(), &fmt::ov5647_800x640_raw8_timing,
+     fmt::OV5647_REG_END, fmt::OV5647_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"ov5647 800x640 yuv422", fmt::ov5647_800x640_yuv422_30fps_regs.span(), &fmt::ov5647_800x640_yuv422_timing,
+     fmt::OV5647_REG_END, fmt::OV5647_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"ov02c10 1280x800 raw10", fmt::ov02c10_1280x800_raw10_30fps_regs.span(), &fmt::ov02c10_1280x800_raw10_timing,
+     fmt::OV02C10_REG_END, fmt::OV02C10_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"ov02c10 800x480 raw10", fmt::ov02c10_800x480_raw10_30fps_regs.span(), &fmt::ov02c10_800x480_raw10_timing,
+     fmt::OV02C10_REG_END, fmt::OV02C10_REG_DELAY, 0x380c, 0x380e, 0x3808, 0x380a},
+    {"sc202cs 640x480 raw8", fmt::sc202cs_vga_640x480_raw8_30fps_regs.span(), &fmt::sc202cs_vga_raw8_timing,
+     fmt::SC202CS_REG_END, fmt::SC202CS_REG_DELAY, 0, 0x320e, 0x3208, 0x320a},
+};
+
+// Registres écrits plusieurs fois volontairement (séquencement)
+bool is_sequencing_reg(uint16_t addr) { return addr == 0x36e9; }
+
+struct RegImage {
+  uint8_t val[0x10000];
+  bool set[0x10000];
+};
+
+RegImage s_image;
+
+void replay(const ModeCase &mc) {
+  memset(&s_image, 0, sizeof(s_image));
+  for (size_t i = 0; i < mc.regs.num; i++) {
+    const fmt::Reg &r = mc.regs.regs[i];
+    if (r.addr == mc.end_marker) {
+      break;
+    }
+    if (r.addr == mc.delay_marker) {
+      continue;
+    }
+    s_image.val[r.addr] = r.val;
+    s_image.set[r.addr] = true;
+  }
+}
+
+uint16_t image_u16(uint16_t addr) {
+  TEST_ASSERT_TRUE_MESSAGE(s_image.set[addr] && s_image.set[addr + 1], "registre de géométrie non programmé");
+  return static_cast<uint16_t>((s_image.val[addr] << 8) | s_image.val[addr + 1]);
+}
+
+}  // namespace
+
+TEST_CASE("custom mode tables are end terminated and write each register once", "[custom_modes]")
+{
+  for (const ModeCase &mc : MODE_CASES) {
+    TEST_ASSERT_GREATER_THAN_MESSAGE(1, mc.regs.num, mc.name);
+    TEST_ASSERT_EQUAL_HEX16_MESSAGE(mc.end_marker, mc.regs.regs[mc.regs.num - 1].addr, mc.name);
+
+    static bool seen[0x10000];
+    memset(seen, 0, sizeof(seen));
+    for (size_t i = 0; i + 1 < mc.regs.num; i++) {
+      uint16_t addr = mc.regs.regs[i].addr;
+      TEST_ASSERT_NOT_EQUAL_MESSAGE(mc.end_marker, addr, mc.name);
+      if (addr == mc.delay_marker || is_sequencing_reg(addr)) {
+        continue;
+      }
+      TEST_ASSERT_FALSE_MESSAGE(seen[addr], mc.name);
+      seen[addr] = true;
+    }
+  }
+}
+
+TEST_CASE("ov5647 custom modes leave reset and streaming to the driver", "[custom_modes]")
+{
+  // Le driver écrit sa séquence de reset avant la table et coupe le flux à la fin de set_format
+  for (const ModeCase &mc : MODE_CASES) {
+    if (strncmp(mc.name, "ov5647", 6) != 0) {
+      continue;
+    }
+    for (size_t i = 0; i < mc.regs.num; i++) {
+      TEST_ASSERT_NOT_EQUAL_MESSAGE(0x0103, mc.regs.regs[i].addr, mc.name);
+      TEST_ASSERT_NOT_EQUAL_MESSAGE(0x0100, mc.regs.regs[i].addr, mc.name);
+    }
+  }
+}
+
+TEST_CASE("custom mode geometry matches the declared timing", "[custom_modes]")
+{
+  for (const ModeCase &mc : MODE_CASES) {
+    replay(mc);
+    const fmt::Timing &t = *mc.timing;
+
+    if (mc.hts_reg != 0) {
+      TEST_ASSERT_EQUAL_UINT16_MESSAGE(t.hts, image_u16(mc.hts_reg), mc.name);
+    }
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(t.vts, image_u16(mc.vts_reg), mc.name);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(t.width, image_u16(mc.width_reg), mc.name);
+    TEST_ASSERT_EQUAL_UINT16_MESSAGE(t.height, image_u16(mc.height_reg), mc.name);
+    TEST_ASSERT_TRUE_MESSAGE(t.link_fits(), mc.name);
+
+    printf("%-24s %3u entries %4u bytes, pclk %9u HTS %4u VTS %4u, max %2u.%02u fps, payload %3u / %3u Mbps\n",
+           mc.name, (unsigned)mc.regs.num, (unsigned)(mc.regs.num * sizeof(fmt::Reg)), (unsigned)t.pclk,
+           t.hts, t.vts, (unsigned)(t.max_fps_x100() / 100), (unsigned)(t.max_fps_x100() % 100),
+           (unsigned)(t.payload_bps() / 1000000), (unsigned)(t.line_rate * t.lanes / 1000000));
+  }
+}
+
+TEST_CASE("ov5647 custom modes switch with a register delta", "[custom_modes]")
+{
+  // Même disposition que le driver : reset commun, commandes jamais reprises dans un delta
+  static const esp_cam_sensor_reginfo_a16v8_t reset_regs[] = {
+      {0x0100, 0x00}, {0x0103, 0x01}, {fmt::OV5647_REG_DELAY, 0x0a}, {0x4800, 0x01}, {fmt::OV5647_REG_END, 0x00},
+  };
+  static const uint16_t skip_regs[] = {0x0100, 0x0103};
+  esp_cam_sensor_regdelta_config_t config = {};
+  config.end_marker = fmt::OV5647_REG_END;
+  config.delay_marker = fmt::OV5647_REG_DELAY;
+  config.common_regs = reset_regs;
+  config.skip_regs = skip_regs;
+  config.skip_regs_num = sizeof(skip_regs) / sizeof(skip_regs[0]);
+
+  const fmt::RegSpan vga = fmt::ov5647_640x480_raw8_30fps_regs.span();
+  const fmt::RegSpan wsvga = fmt::ov5647_1024x600_raw8_30fps_regs.span();
+
+  esp_cam_sensor_regdelta_t delta = {};
+  TEST_ESP_OK(esp_cam_sensor_regdelta_compute(&config, vga.regs, wsvga.regs, &delta));
+  TEST_ASSERT_EQUAL(0, delta.orphans);
+  TEST_ASSERT_GREATER_THAN(0, delta.regs_num);
+  TEST_ASSERT_LESS_THAN(wsvga.num - 1, delta.regs_num);
+  printf("ov5647 640x480 -> 1024x600: %u writes instead of %u\n", (unsigned)delta.regs_num,
+         (unsigned)(wsvga.num - 1));
+  esp_cam_sensor_regdelta_free(&delta);
+}
@@ -1,7 +1,8 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
+from esphome import automation
 from esphome.components import mipi_dsi_cam
-from esphome.const import CONF_ID, CONF_PORT, CONF_USERNAME, CONF_PASSWORD
+from esphome.const import CONF_ID, CONF_PORT, CONF_USERNAME, CONF_PASSWORD, CONF_TRIGGER_ID
 
 DEPENDENCIES = ["mipi_dsi_cam", "network"]
 AUTO_LOAD = []
@@ -9,6 +10,11 @@ CODEOWNERS = ["@youkorr"]
 
 rtsp_server_ns = cg.esphome_ns.namespace("rtsp_server")
 RTSPServer = rtsp_server_ns.class_("RTSPServer", cg.Component)
+MvMotionConfig = rtsp_server_ns.struct("MvMotionConfig")
+MvMotionBox = rtsp_server_ns.struct("MvMotionBox")
+MotionTrigger = rtsp_server_ns.class_(
+    "MotionTrigger", automation.Trigger.template(cg.std_vector.template(MvMotionBox))
+)
 
 CONF_CAMERA_ID = "camera_id"
 CONF_STREAM_PATH = "stream_path"
@@ -19,12 +25,74 @@ CONF_GOP = "gop"
 CONF_QP_MIN = "qp_min"
 CONF_QP_MAX = "qp_max"
 CONF_MAX_CLIENTS = "max_clients"
+CONF_ROI_DELTA_QP = "roi_delta_qp"
+CONF_ROI_BACKGROUND_DELTA_QP = "roi_background_delta_qp"
+CONF_MOTION_DETECTION = "motion_detection"
+CONF_MIN_MAGNITUDE = "min_magnitude"
+CONF_MIN_NEIGHBORS = "min_neighbors"
+CONF_MIN_BLOCKS = "min_blocks"
+CONF_MAX_AREA = "max_area"
+CONF_ON_FRAMES = "on_frames"
+CONF_OFF_FRAMES = "off_frames"
+CONF_ZONES = "zones"
+CONF_X = "x"
+CONF_Y = "y"
+CONF_WIDTH = "width"
+CONF_HEIGHT = "height"
+CONF_ON_MOTION = "on_motion"
+CONF_SUB_STREAM = "sub_stream"
+CONF_PATH = "path"
 
-CONFIG_SCHEMA = cv.Schema({
+MOTION_ZONE_SCHEMA = cv.Schema({
+    cv.Required(CONF_X): cv.int_range(min=0, max=4095),
+    cv.Required(CONF_Y): cv.int_range(min=0, max=4095),
+    cv.Required(CONF_WIDTH): cv.int_range(min=1, max=4096),
+    cv.Required(CONF_HEIGHT): cv.int_range(min=1, max=4096),
+})
+
+# Motion vectors of the hardware encoder, thresholds are per 16x16 macroblock (MB)
+MOTION_DETECTION_SCHEMA = cv.Schema({
+    cv.Optional(CONF_MIN_MAGNITUDE, default=4): cv.int_range(min=1, max=255),
+    cv.Optional(CONF_MIN_NEIGHBORS, default=1): cv.int_range(min=0, max=8),
+    cv.Optional(CONF_MIN_BLOCKS, default=4): cv.int_range(min=1, max=1000),
+    # Percent of the picture, above it the frame is a global change (exposure, IR cut)
+    cv.Optional(CONF_MAX_AREA, default=50): cv.int_range(min=1, max=100),
+    cv.Optional(CONF_ON_FRAMES, default=2): cv.int_range(min=1, max=255),
+    cv.Optional(CONF_OFF_FRAMES, default=30): cv.int_range(min=1, max=1000),
+    cv.Optional(CONF_ZONES, default=[]): cv.All(cv.ensure_list(MOTION_ZONE_SCHEMA), cv.Length(max=8)),
+})
+
+def _validate_path(value):
+    value = cv.string(value)
+    if not value.startswith("/") or any(c in value for c in " ?#"):
+        raise cv.Invalid("Stream path must start with '/' and contain no space, '?' or '#'")
+    return value
+
+
+# Second stream encoded in the same pass as the main one (dual hardware encoder).
+# The GOP is shared with the main stream.
+SUB_STREAM_SCHEMA = cv.Schema({
+    cv.Optional(CONF_PATH, default="/sub"): _validate_path,
+    cv.Optional(CONF_WIDTH, default=640): cv.int_range(min=64, max=1920),
+    cv.Optional(CONF_HEIGHT, default=360): cv.int_range(min=64, max=1088),
+    cv.Optional(CONF_BITRATE, default=500000): cv.int_range(min=100000, max=10000000),
+    cv.Optional(CONF_QP_MIN, default=10): cv.int_range(min=0, max=51),
+    cv.Optional(CONF_QP_MAX, default=40): cv.int_range(min=0, max=51),
+})
+
+
+def _validate_streams(config):
+    sub = config.get(CONF_SUB_STREAM)
+    if sub is not None and sub[CONF_PATH] == config[CONF_STREAM_PATH]:
+        raise cv.Invalid("sub_stream path must differ from stream_path")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(cv.Schema({
     cv.GenerateID(): cv.declare_id(RTSPServer),
     cv.Required(CONF_CAMERA_ID): cv.use_id(mipi_dsi_cam.MipiDSICamComponent),
     cv.Optional(CONF_PORT, default=554): cv.port,
-    cv.Optional(CONF_STREAM_PATH, default="/stream"): cv.string,
+    cv.Optional(CONF_STREAM_PATH, default="/stream"): _validate_path,
     cv.Optional(CONF_RTP_PORT, default=5004): cv.port,
     cv.Optional(CONF_RTCP_PORT, default=5005): cv.port,
     cv.Optional(CONF_BITRATE, default=2000000): cv.int_range(min=100000, max=10000000),
@@ -32,9 +100,17 @@ CONFIG_SCHEMA = cv.Schema({
     cv.Optional(CONF_QP_MIN, default=10): cv.int_range(min=0, max=51),
     cv.Optional(CONF_QP_MAX, default=40): cv.int_range(min=0, max=51),
     cv.Optional(CONF_MAX_CLIENTS, default=3): cv.int_range(min=1, max=5),
+    cv.Optional(CONF_SUB_STREAM): SUB_STREAM_SCHEMA,
+    # ROI encoding of detector boxes (update_roi_boxes), 0 disables it
+    cv.Optional(CONF_ROI_DELTA_QP, default=0): cv.int_range(min=-51, max=0),
+    cv.Optional(CONF_ROI_BACKGROUND_DELTA_QP, default=6): cv.int_range(min=0, max=51),
+    cv.Optional(CONF_MOTION_DETECTION): MOTION_DETECTION_SCHEMA,
+    cv.Optional(CONF_ON_MOTION): automation.validate_automation({
+        cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(MotionTrigger),
+    }),
     cv.Optional(CONF_USERNAME): cv.string,
     cv.Optional(CONF_PASSWORD): cv.string,
-}).extend(cv.COMPONENT_SCHEMA)
+}).extend(cv.COMPONENT_SCHEMA), _validate_streams)
 
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
@@ -53,6 +129,32 @@ async def to_code(config):
     cg.add(var.set_qp_min(config[CONF_QP_MIN]))
     cg.add(var.set_qp_max(config[CONF_QP_MAX]))
     cg.add(var.set_max_clients(config[CONF_MAX_CLIENTS]))
+    sub = config.get(CONF_SUB_STREAM)
+    if sub is not None:
+        cg.add(var.set_sub_stream(sub[CONF_PATH], sub[CONF_WIDTH], sub[CONF_HEIGHT], sub[CONF_BITRATE],
+                                  sub[CONF_QP_MIN], sub[CONF_QP_MAX]))
+    cg.add(var.set_roi_delta_qp(config[CONF_ROI_DELTA_QP]))
+    cg.add(var.set_roi_background_delta_qp(config[CONF_ROI_BACKGROUND_DELTA_QP]))
+
+    motion = config.get(CONF_MOTION_DETECTION)
+    if motion is not None:
+        cg.add(var.set_motion_detection(True))
+        cg.add(var.set_motion_config(cg.StructInitializer(
+            MvMotionConfig,
+            ("min_magnitude", motion[CONF_MIN_MAGNITUDE]),
+            ("min_neighbors", motion[CONF_MIN_NEIGHBORS]),
+            ("min_blocks", motion[CONF_MIN_BLOCKS]),
+            ("max_area_percent", motion[CONF_MAX_AREA]),
+            ("on_frames", motion[CONF_ON_FRAMES]),
+            ("off_frames", motion[CONF_OFF_FRAMES]),
+        )))
+        for zone in motion[CONF_ZONES]:
+            cg.add(var.add_motion_zone(zone[CONF_X], zone[CONF_Y], zone[CONF_WIDTH], zone[CONF_HEIGHT]))
+
+    # The boxes are in camera pixels: x, y, w, h, blocks
+    for conf in config.get(CONF_ON_MOTION, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [(cg.std_vector.template(MvMotionBox), "boxes")], conf)
 
     if CONF_USERNAME in config:
         cg.add(var.set_username(config[CONF_USERNAME]))
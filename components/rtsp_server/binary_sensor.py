@@ -0,0 +1,22 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import binary_sensor
+from esphome.const import DEVICE_CLASS_MOTION
+
+from . import RTSPServer
+
+DEPENDENCIES = ["rtsp_server"]
+
+CONF_RTSP_SERVER_ID = "rtsp_server_id"
+CONF_ZONE = "zone"
+
+# Motion from the encoder motion vectors, `zone` is the index in motion_detection.zones
+CONFIG_SCHEMA = binary_sensor.binary_sensor_schema(device_class=DEVICE_CLASS_MOTION).extend({
+    cv.GenerateID(CONF_RTSP_SERVER_ID): cv.use_id(RTSPServer),
+    cv.Optional(CONF_ZONE): cv.int_range(min=0, max=7),
+})
+
+async def to_code(config):
+    server = await cg.get_variable(config[CONF_RTSP_SERVER_ID])
+    var = await binary_sensor.new_binary_sensor(config)
+    cg.add(server.add_motion_binary_sensor(var, config.get(CONF_ZONE, -1)))
@@ -0,0 +1,240 @@
+#include "mv_motion_detector.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace esphome {
+namespace rtsp_server {
+
+bool MvMotionDetector::configure(const MvMotionConfig &config) {
+  uint16_t mb_width = (config.width + MV_MOTION_MB_SIZE - 1) / MV_MOTION_MB_SIZE;
+  uint16_t mb_height = (config.height + MV_MOTION_MB_SIZE - 1) / MV_MOTION_MB_SIZE;
+  // The MV packet addresses MBs on 7 bits
+  if (mb_width == 0 || mb_height == 0 || mb_width > 128 || mb_height > 128 || config.on_frames == 0 ||
+      config.max_area_percent == 0 || config.max_area_percent > 100) {
+    return false;
+  }
+
+  this->config_ = config;
+  this->mb_width_ = mb_width;
+  this->mb_height_ = mb_height;
+  size_t mb_num = mb_width * mb_height;
+  this->magnitude_.assign(mb_num, 0);
+  this->moving_.assign(mb_num, 0);
+  this->fill_stack_.resize(mb_num);
+  this->full_zone_ = {0, 0, mb_width, mb_height, 0, 0};
+  this->zones_.clear();
+  this->reset();
+  return true;
+}
+
+bool MvMotionDetector::add_zone(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+  if (this->mb_width_ == 0 || this->zones_.size() >= MV_MOTION_MAX_ZONES || w == 0 || h == 0)
+    return false;
+
+  // Every MB touched by the zone belongs to it
+  ZoneState zone{};
+  zone.mb_x0 = std::min<uint16_t>(x / MV_MOTION_MB_SIZE, this->mb_width_);
+  zone.mb_y0 = std::min<uint16_t>(y / MV_MOTION_MB_SIZE, this->mb_height_);
+  zone.mb_x1 = std::min<uint32_t>((x + w + MV_MOTION_MB_SIZE - 1) / MV_MOTION_MB_SIZE, this->mb_width_);
+  zone.mb_y1 = std::min<uint32_t>((y + h + MV_MOTION_MB_SIZE - 1) / MV_MOTION_MB_SIZE, this->mb_height_);
+  if (zone.mb_x0 >= zone.mb_x1 || zone.mb_y0 >= zone.mb_y1)
+    return false;
+
+  this->zones_.push_back(zone);
+  this->zone_mask_ = 0;
+  return true;
+}
+
+void MvMotionDetector::clear_zones() {
+  this->zones_.clear();
+  this->zone_mask_ = 0;
+}
+
+void MvMotionDetector::reset() {
+  std::fill(this->magnitude_.begin(), this->magnitude_.end(), 0);
+  std::fill(this->moving_.begin(), this->moving_.end(), 0);
+  for (auto &zone : this->zones_) {
+    zone.hot_frames = 0;
+    zone.quiet_frames = 0;
+  }
+  this->full_zone_.hot_frames = 0;
+  this->full_zone_.quiet_frames = 0;
+  this->box_count_ = 0;
+  this->moving_blocks_ = 0;
+  this->zone_mask_ = 0;
+  this->global_change_ = false;
+}
+
+bool MvMotionDetector::process(const esp_h264_enc_mv_data_t *data, uint32_t count, bool p_frame) {
+  if (this->mb_width_ == 0 || !p_frame)
+    return false;
+
+  // The packet only lists the MBs with a non zero MV
+  std::fill(this->magnitude_.begin(), this->magnitude_.end(), 0);
+  uint32_t raw_moving = 0;
+  for (uint32_t i = 0; i < count && data != nullptr; i++) {
+    const esp_h264_enc_mv_data_t &mv = data[i];
+    if (mv.mb_x >= this->mb_width_ || mv.mb_y >= this->mb_height_)
+      continue;
+    int magnitude = std::min(std::abs((int) mv.mv_x) + std::abs((int) mv.mv_y), 255);
+    uint8_t &cell = this->magnitude_[mv.mb_y * this->mb_width_ + mv.mb_x];
+    if (cell < this->config_.min_magnitude && magnitude >= this->config_.min_magnitude)
+      raw_moving++;
+    cell = std::max<uint8_t>(cell, magnitude);
+  }
+
+  // Exposure or IR cut switches move the whole picture, it says nothing about the scene
+  this->global_change_ = raw_moving * 100 > this->magnitude_.size() * this->config_.max_area_percent;
+  if (this->global_change_) {
+    this->box_count_ = 0;
+    this->moving_blocks_ = 0;
+    return false;
+  }
+
+  this->filter_noise_();
+  this->find_boxes_();
+  return this->update_zones_();
+}
+
+void MvMotionDetector::filter_noise_() {
+  const uint16_t mb_w = this->mb_width_;
+  const uint16_t mb_h = this->mb_height_;
+  const uint8_t min_magnitude = this->config_.min_magnitude;
+  this->moving_blocks_ = 0;
+  for (uint16_t y = 0; y < mb_h; y++) {
+    for (uint16_t x = 0; x < mb_w; x++) {
+      uint32_t idx = y * mb_w + x;
+      this->moving_[idx] = 0;
+      if (this->magnitude_[idx] < min_magnitude)
+        continue;
+      // A real object covers several MBs, a lone MV is sensor noise or a compression artefact
+      uint8_t neighbors = 0;
+      for (int dy = -1; dy <= 1; dy++) {
+        int ny = y + dy;
+        if (ny < 0 || ny >= mb_h)
+          continue;
+        for (int dx = -1; dx <= 1; dx++) {
+          int nx = x + dx;
+          if ((dx == 0 && dy == 0) || nx < 0 || nx >= mb_w)
+            continue;
+          if (this->magnitude_[ny * mb_w + nx] >= min_magnitude)
+            neighbors++;
+        }
+      }
+      if (neighbors >= this->config_.min_neighbors) {
+        this->moving_[idx] = 1;
+        this->moving_blocks_++;
+      }
+    }
+  }
+}
+
+void MvMotionDetector::find_boxes_() {
+  const uint16_t mb_w = this->mb_width_;
+  const uint16_t mb_h = this->mb_height_;
+  this->box_count_ = 0;
+  if (this->moving_blocks_ < this->config_.min_blocks)
+    return;
+
+  for (uint32_t start = 0; start < this->moving_.size(); start++) {
+    if (this->moving_[start] != 1)
+      continue;
+
+    // 8-connected flood fill, each MB is pushed once
+    uint16_t x0 = mb_w, y0 = mb_h, x1 = 0, y1 = 0, blocks = 0;
+    uint32_t top = 0;
+    this->fill_stack_[top++] = start;
+    this->moving_[start] = 2;
+    while (top > 0) {
+      uint16_t idx = this->fill_stack_[--top];
+      uint16_t x = idx % mb_w;
+      uint16_t y = idx / mb_w;
+      x0 = std::min(x0, x);
+      y0 = std::min(y0, y);
+      x1 = std::max(x1, x);
+      y1 = std::max(y1, y);
+      blocks++;
+      for (int dy = -1; dy <= 1; dy++) {
+        int ny = y + dy;
+        if (ny < 0 || ny >= mb_h)
+          continue;
+        for (int dx = -1; dx <= 1; dx++) {
+          int nx = x + dx;
+          if (nx < 0 || nx >= mb_w)
+            continue;
+          uint16_t n = ny * mb_w + nx;
+          if (this->moving_[n] == 1) {
+            this->moving_[n] = 2;
+            this->fill_stack_[top++] = n;
+          }
+        }
+      }
+    }
+    if (blocks < this->config_.min_blocks)
+      continue;
+
+    MvMotionBox box = {
+        (uint16_t) (x0 * MV_MOTION_MB_SIZE),
+        (uint16_t) (y0 * MV_MOTION_MB_SIZE),
+        (uint16_t) ((x1 - x0 + 1) * MV_MOTION_MB_SIZE),
+        (uint16_t) ((y1 - y0 + 1) * MV_MOTION_MB_SIZE),
+        blocks,
+    };
+    // Keep the largest boxes, sorted
+    uint8_t pos = this->box_count_;
+    if (pos == MV_MOTION_MAX_BOXES) {
+      if (this->boxes_[pos - 1].blocks >= blocks)
+        continue;
+      pos--;
+    } else {
+      this->box_count_++;
+    }
+    while (pos > 0 && this->boxes_[pos - 1].blocks < blocks) {
+      this->boxes_[pos] = this->boxes_[pos - 1];
+      pos--;
+    }
+    this->boxes_[pos] = box;
+  }
+}
+
+bool MvMotionDetector::update_zones_() {
+  ZoneState *zones = this->zones_.empty() ? &this->full_zone_ : this->zones_.data();
+  uint8_t zone_num = this->get_zone_count();
+  uint32_t mask = 0;
+  for (uint8_t i = 0; i < zone_num; i++) {
+    ZoneState &zone = zones[i];
+    uint16_t blocks = 0;
+    for (uint16_t y = zone.mb_y0; y < zone.mb_y1; y++) {
+      const uint8_t *row = &this->moving_[y * this->mb_width_];
+      for (uint16_t x = zone.mb_x0; x < zone.mb_x1; x++)
+        blocks += row[x] != 0;
+    }
+
+    // Hysteresis, a zone needs on_frames to start and off_frames to stop
+    bool active = (this->zone_mask_ >> i) & 1;
+    if (blocks >= this->config_.min_blocks) {
+      zone.quiet_frames = 0;
+      if (zone.hot_frames < this->config_.on_frames)
+        zone.hot_frames++;
+      if (zone.hot_frames >= this->config_.on_frames)
+        active = true;
+    } else {
+      zone.hot_frames = 0;
+      if (active && ++zone.quiet_frames >= this->config_.off_frames) {
+        zone.quiet_frames = 0;
+        active = false;
+      }
+    }
+    if (active)
+      mask |= 1u << i;
+  }
+
+  bool changed = mask != this->zone_mask_;
+  this->zone_mask_ = mask;
+  return changed;
+}
+
+}  // namespace rtsp_server
+}  // namespace esphome
@@ -0,0 +1,101 @@
+#pragma once
+
+// Motion detection from the motion vectors (MV) of the H.264 hardware encoder.
+//
+// The encoder already searched every macroblock (MB) of a P frame, so reading its sparse
+// MV packet gives a motion map without any extra pass over the pixels. This file only
+// depends on the esp_h264 MV types, it is built and tested on Linux.
+
+#include <cstdint>
+#include <vector>
+#include "esp_h264_enc_param_hw.h"
+
+namespace esphome {
+namespace rtsp_server {
+
+static const uint8_t MV_MOTION_MAX_ZONES = 8;
+static const uint8_t MV_MOTION_MAX_BOXES = 8;
+static const uint8_t MV_MOTION_MB_SIZE = 16;
+
+// Rectangle in pixels of the encoded picture
+struct MvMotionBox {
+  uint16_t x;
+  uint16_t y;
+  uint16_t w;
+  uint16_t h;
+  uint16_t blocks;  // moving MBs in the box, unused for zones
+};
+
+struct MvMotionConfig {
+  uint16_t width{0};              // encoded picture, 16 aligned or not
+  uint16_t height{0};
+  uint8_t min_magnitude{4};       // |mv_x| + |mv_y| of a moving MB
+  uint8_t min_neighbors{1};       // moving neighbours to keep a moving MB, isolated MBs are noise
+  uint16_t min_blocks{4};         // moving MBs of a zone or a box to count as motion
+  uint8_t max_area_percent{50};   // above, the whole picture changes (exposure, IR cut): frame ignored
+  uint8_t on_frames{2};           // P frames in a row with motion to report motion
+  uint16_t off_frames{30};        // P frames in a row without motion to clear it
+};
+
+class MvMotionDetector {
+ public:
+  // Allocates the maps, the zones and the state are reset
+  bool configure(const MvMotionConfig &config);
+  const MvMotionConfig &get_config() const { return this->config_; }
+
+  // Zones are checked separately. Without zone, the whole picture is zone 0.
+  bool add_zone(uint16_t x, uint16_t y, uint16_t w, uint16_t h);
+  void clear_zones();
+  uint8_t get_zone_count() const { return this->zones_.empty() ? 1 : this->zones_.size(); }
+
+  // Analyses the MV packet of one encoded frame, `count` is given by esp_h264_enc_hw_get_mv_data_len.
+  // I frames carry no MV, they keep the current state. Returns true when the motion state changed.
+  bool process(const esp_h264_enc_mv_data_t *data, uint32_t count, bool p_frame);
+  void reset();
+
+  bool is_motion() const { return this->zone_mask_ != 0; }
+  bool is_zone_motion(uint8_t zone) const { return (this->zone_mask_ >> zone) & 1; }
+  uint32_t get_zone_mask() const { return this->zone_mask_; }
+
+  // Connected moving areas of the last analysed P frame, largest first
+  const MvMotionBox *get_boxes() const { return this->boxes_; }
+  uint8_t get_box_count() const { return this->box_count_; }
+
+  // Moving MBs of the last analysed P frame, after noise filtering
+  uint16_t get_moving_blocks() const { return this->moving_blocks_; }
+  // True if the last P frame was ignored by max_area_percent
+  bool is_global_change() const { return this->global_change_; }
+
+  uint16_t get_mb_width() const { return this->mb_width_; }
+  uint16_t get_mb_height() const { return this->mb_height_; }
+  // |mv_x| + |mv_y| per MB of the last P frame, row major, saturated to 255
+  const uint8_t *get_magnitude_map() const { return this->magnitude_.data(); }
+
+ protected:
+  struct ZoneState {
+    uint16_t mb_x0, mb_y0, mb_x1, mb_y1;  // MB rectangle, end excluded
+    uint16_t hot_frames;
+    uint16_t quiet_frames;
+  };
+
+  void filter_noise_();
+  void find_boxes_();
+  bool update_zones_();
+
+  MvMotionConfig config_;
+  uint16_t mb_width_{0};
+  uint16_t mb_height_{0};
+  std::vector<uint8_t> magnitude_;
+  std::vector<uint8_t> moving_;      // 0 still, 1 moving, 2 moving and already in a box
+  std::vector<uint16_t> fill_stack_;
+  std::vector<ZoneState> zones_;
+  ZoneState full_zone_{};
+  MvMotionBox boxes_[MV_MOTION_MAX_BOXES];
+  uint8_t box_count_{0};
+  uint16_t moving_blocks_{0};
+  uint32_t zone_mask_{0};
+  bool global_change_{false};
+};
+
+}  // namespace rtsp_server
+}  // namespace esphome
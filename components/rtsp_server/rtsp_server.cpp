@@ -22,7 +22,7 @@ namespace rtsp_server {
 
 static const char *const TAG = "rtsp_server";
 
-// Base64 encoding table
+// Base64 decoding table (Basic authentication)
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
@@ -47,8 +47,22 @@ void RTSPServer::setup() {
     return;
   }
 
-  // Generate random SSRC
-  this->rtp_ssrc_ = esp_random();
+  this->camera_->add_on_resolution_callback([this](uint16_t width, uint16_t height) {
+    ESP_LOGI(TAG, "Camera switched to %ux%u", width, height);
+    this->camera_resized_ = true;
+  });
+
+  // One RTP sequence/timestamp/SSRC per path, with a random SSRC each
+  this->streams_.add_stream(this->stream_path_, esp_random());
+  if (this->sub_width_ > 0) {
+    this->sub_stream_ = this->streams_.add_stream(this->sub_path_, esp_random());
+    if (this->sub_stream_ < 0) {
+      ESP_LOGE(TAG, "Sub stream path '%s' must differ from '%s'", this->sub_path_.c_str(),
+               this->stream_path_.c_str());
+      this->mark_failed();
+      return;
+    }
+  }
 
   // Initialize RTP/RTCP sockets
   if (this->init_rtp_sockets_() != ESP_OK) {
@@ -66,6 +80,8 @@ void RTSPServer::setup() {
 
   ESP_LOGI(TAG, "RTSP Server setup complete");
   ESP_LOGI(TAG, "Stream URL: rtsp://<IP>:%d%s", this->rtsp_port_, this->stream_path_.c_str());
+  if (this->sub_stream_ >= 0)
+    ESP_LOGI(TAG, "Sub stream URL: rtsp://<IP>:%d%s", this->rtsp_port_, this->sub_path_.c_str());
 
   if (!this->username_.empty() && !this->password_.empty()) {
     ESP_LOGI(TAG, "Authentication: ENABLED (user='%s')", this->username_.c_str());
@@ -104,6 +120,9 @@ void RTSPServer::loop() {
   // Handle incoming RTSP connections
   this->handle_rtsp_connections_();
 
+  if (this->motion_enabled_)
+    this->publish_motion_();
+
   // Cleanup inactive sessions
   this->cleanup_inactive_sessions_();
 }
@@ -119,6 +138,15 @@ void RTSPServer::dump_config() {
   ESP_LOGCONFIG(TAG, "  GOP: %d", this->gop_);
   ESP_LOGCONFIG(TAG, "  QP Range: %d-%d", this->qp_min_, this->qp_max_);
   ESP_LOGCONFIG(TAG, "  Max Clients: %d", this->max_clients_);
+  if (this->sub_width_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Sub Stream: %s %ux%u, %u bps, QP %u-%u", this->sub_path_.c_str(), this->sub_width_,
+                  this->sub_height_, (unsigned) this->sub_bitrate_, this->sub_qp_min_, this->sub_qp_max_);
+  }
+  if (this->motion_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Motion Detection: MV magnitude >= %u, %u blocks, %u zone(s)",
+                  this->motion_config_.min_magnitude, this->motion_config_.min_blocks,
+                  this->motion_zones_.empty() ? 1 : (unsigned) this->motion_zones_.size());
+  }
   if (!this->username_.empty()) {
     ESP_LOGCONFIG(TAG, "  Authentication: Enabled (user: %s)", this->username_.c_str());
   } else {
@@ -160,44 +188,20 @@ esp_err_t RTSPServer::init_h264_encoder_() {
   ESP_LOGI(TAG, "Resolution used for encoder: %dx%d (camera: %dx%d)",
            width, height, this->camera_->get_image_width(), this->camera_->get_image_height());
 
-  // Allocate YUV buffer (O_UYY_E_VYY packed YUV420)
-  this->yuv_buffer_size_ = width * height * 3 / 2;
-  this->yuv_buffer_ = (uint8_t *) heap_caps_aligned_alloc(64,
-                                                          this->yuv_buffer_size_,
-                                                          MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-  if (!this->yuv_buffer_) {
-    ESP_LOGE(TAG, "Failed to allocate YUV buffer (64-byte aligned)");
-    return ESP_ERR_NO_MEM;
-  }
-  ESP_LOGI(TAG, "YUV buffer: %zu bytes @ %p", this->yuv_buffer_size_, this->yuv_buffer_);
-
-  // Allocate H.264 output buffer (roughly 2x YUV as a safe upper bound)
-  this->h264_buffer_size_ = this->yuv_buffer_size_ * 2;
-  this->h264_buffer_ = (uint8_t *) heap_caps_aligned_alloc(64,
-                                                           this->h264_buffer_size_,
-                                                           MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-  if (!this->h264_buffer_) {
-    ESP_LOGE(TAG, "Failed to allocate H.264 buffer (64-byte aligned)");
-    free(this->yuv_buffer_);
-    this->yuv_buffer_ = nullptr;
+  if (this->alloc_frame_buffers_(width, height, &this->yuv_buffer_, &this->yuv_buffer_size_, &this->h264_buffer_,
+                                 &this->h264_buffer_size_) != ESP_OK) {
+    this->cleanup_h264_encoder_();
     return ESP_ERR_NO_MEM;
   }
-  ESP_LOGI(TAG, "H.264 buffer: %zu bytes @ %p", this->h264_buffer_size_, this->h264_buffer_);
 
   // Allocate reusable RTP packet buffer
   this->rtp_packet_buffer_ = (uint8_t *) heap_caps_malloc(2048, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
   if (!this->rtp_packet_buffer_) {
     ESP_LOGE(TAG, "Failed to allocate RTP packet buffer");
-    free(this->yuv_buffer_);
-    free(this->h264_buffer_);
-    this->yuv_buffer_ = nullptr;
-    this->h264_buffer_ = nullptr;
+    this->cleanup_h264_encoder_();
     return ESP_ERR_NO_MEM;
   }
 
-  // Preallocate NAL units cache
-  this->nal_units_cache_.reserve(20);
-
   // Configure hardware encoder
   esp_h264_enc_cfg_hw_t cfg = {
       .pic_type = ESP_H264_RAW_FMT_O_UYY_E_VYY,
@@ -210,31 +214,316 @@ esp_err_t RTSPServer::init_h264_encoder_() {
   ESP_LOGI(TAG,
            "Encoder config: %dx%d @ 30fps, GOP=%d, bitrate=%d, QP=%d-%d",
            width, height, this->gop_, this->bitrate_, this->qp_min_, this->qp_max_);
+  this->streams_.get(0).set_video(this->camera_->get_image_width(), this->camera_->get_image_height(), cfg.fps);
+
+  esp_h264_err_t ret;
+  if (this->sub_stream_ < 0) {
+    ret = esp_h264_enc_hw_new(&cfg, &this->h264_encoder_);
+    if (ret != ESP_H264_ERR_OK || !this->h264_encoder_) {
+      ESP_LOGE(TAG, "Failed to create H.264 hardware encoder: %d", ret);
+      this->cleanup_h264_encoder_();
+      return ESP_FAIL;
+    }
 
-  esp_h264_err_t ret = esp_h264_enc_hw_new(&cfg, &this->h264_encoder_);
-  if (ret != ESP_H264_ERR_OK || !this->h264_encoder_) {
-    ESP_LOGE(TAG, "Failed to create H.264 hardware encoder: %d", ret);
-    this->cleanup_h264_encoder_();
-    return ESP_FAIL;
-  }
+    ret = esp_h264_enc_open(this->h264_encoder_);
+    if (ret != ESP_H264_ERR_OK) {
+      ESP_LOGE(TAG, "Failed to open H.264 hardware encoder: %d", ret);
+      this->cleanup_h264_encoder_();
+      return ESP_FAIL;
+    }
 
-  ret = esp_h264_enc_open(this->h264_encoder_);
+    ret = esp_h264_enc_hw_get_param_hd(this->h264_encoder_, &this->h264_param_hd_);
+  } else {
+    // Both pictures go through the encoder in one call, the sub picture is a downscale of the camera one
+    uint16_t sub_width = std::min<uint16_t>(((this->sub_width_ + 15) >> 4) << 4, width);
+    uint16_t sub_height = std::min<uint16_t>(((this->sub_height_ + 15) >> 4) << 4, height);
+    this->sub_enc_width_ = sub_width;
+    this->sub_enc_height_ = sub_height;
+    if (this->alloc_frame_buffers_(sub_width, sub_height, &this->sub_yuv_buffer_, &this->sub_yuv_buffer_size_,
+                                   &this->sub_h264_buffer_, &this->sub_h264_buffer_size_) != ESP_OK) {
+      this->cleanup_h264_encoder_();
+      return ESP_ERR_NO_MEM;
+    }
+
+    esp_h264_enc_cfg_dual_hw_t dual_cfg = {.cfg0 = cfg, .cfg1 = cfg};
+    dual_cfg.cfg1.res = {.width = sub_width, .height = sub_height};
+    dual_cfg.cfg1.rc = {.bitrate = this->sub_bitrate_, .qp_min = this->sub_qp_min_, .qp_max = this->sub_qp_max_};
+    ESP_LOGI(TAG, "Sub stream encoder config: %dx%d @ 30fps, bitrate=%d, QP=%d-%d", sub_width, sub_height,
+             this->sub_bitrate_, this->sub_qp_min_, this->sub_qp_max_);
+    this->streams_.get(this->sub_stream_)
+        .set_video(std::min(this->sub_width_, this->camera_->get_image_width()),
+                   std::min(this->sub_height_, this->camera_->get_image_height()), cfg.fps);
+
+    ret = esp_h264_enc_dual_hw_new(&dual_cfg, &this->h264_dual_encoder_);
+    if (ret != ESP_H264_ERR_OK || !this->h264_dual_encoder_) {
+      ESP_LOGE(TAG, "Failed to create H.264 dual hardware encoder: %d", ret);
+      this->cleanup_h264_encoder_();
+      return ESP_FAIL;
+    }
+
+    ret = esp_h264_enc_dual_open(this->h264_dual_encoder_);
+    if (ret != ESP_H264_ERR_OK) {
+      ESP_LOGE(TAG, "Failed to open H.264 dual hardware encoder: %d", ret);
+      this->cleanup_h264_encoder_();
+      return ESP_FAIL;
+    }
+
+    ret = esp_h264_enc_dual_hw_get_param_hd0(this->h264_dual_encoder_, &this->h264_param_hd_);
+    if (ret == ESP_H264_ERR_OK)
+      ret = esp_h264_enc_dual_hw_get_param_hd1(this->h264_dual_encoder_, &this->h264_sub_param_hd_);
+  }
   if (ret != ESP_H264_ERR_OK) {
-    ESP_LOGE(TAG, "Failed to open H.264 hardware encoder: %d", ret);
+    ESP_LOGE(TAG, "Failed to get H.264 encoder parameters: %d", ret);
     this->cleanup_h264_encoder_();
     return ESP_FAIL;
   }
 
+  if (this->motion_enabled_) {
+    // The MV length register follows the last encoded picture, the sub one with the dual encoder
+    const RtspStream &stream = this->streams_.get(this->sub_stream_ < 0 ? 0 : this->sub_stream_);
+    esp_err_t err = this->init_motion_detection_(
+        this->h264_sub_param_hd_ != nullptr ? this->h264_sub_param_hd_ : this->h264_param_hd_, stream.get_width(),
+        stream.get_height());
+    if (err != ESP_OK)
+      ESP_LOGW(TAG, "Motion detection unavailable, streaming without it");
+  }
+
+  if (this->roi_delta_qp_ != 0) {
+    // Faces/persons keep roi_delta_qp, the background gets roi_background_delta_qp
+    esp_h264_enc_roi_ctrl_cfg_t roi_cfg = {
+        .src_res = {.width = this->camera_->get_image_width(), .height = this->camera_->get_image_height()},
+        .enc_res = {.width = width, .height = height},
+        .roi_delta_qp = this->roi_delta_qp_,
+        .none_roi_delta_qp = this->roi_background_delta_qp_,
+        .margin_mb = 1,
+        .smooth = 50,
+        .hold_updates = 5,
+    };
+    if (esp_h264_enc_roi_ctrl_new(&roi_cfg, &this->roi_ctrl_) != ESP_H264_ERR_OK) {
+      ESP_LOGW(TAG, "Failed to create ROI controller, encoding without ROI");
+    }
+  }
+
   ESP_LOGI(TAG, "H.264 HARDWARE encoder initialized successfully!");
   return ESP_OK;
 }
 
+esp_err_t RTSPServer::alloc_frame_buffers_(uint16_t width, uint16_t height, uint8_t **yuv, size_t *yuv_size,
+                                           uint8_t **h264, size_t *h264_size) {
+  // YUV buffer (O_UYY_E_VYY packed YUV420)
+  *yuv_size = width * height * 3 / 2;
+  *yuv = (uint8_t *) heap_caps_aligned_alloc(64, *yuv_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!*yuv) {
+    ESP_LOGE(TAG, "Failed to allocate YUV buffer (64-byte aligned)");
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "YUV buffer: %zu bytes @ %p", *yuv_size, *yuv);
+
+  // H.264 output buffer (roughly 2x YUV as a safe upper bound)
+  *h264_size = *yuv_size * 2;
+  *h264 = (uint8_t *) heap_caps_aligned_alloc(64, *h264_size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!*h264) {
+    ESP_LOGE(TAG, "Failed to allocate H.264 buffer (64-byte aligned)");
+    return ESP_ERR_NO_MEM;
+  }
+  ESP_LOGI(TAG, "H.264 buffer: %zu bytes @ %p", *h264_size, *h264);
+  return ESP_OK;
+}
+
+void RTSPServer::force_idr_() {
+  if (this->h264_dual_encoder_) {
+    esp_h264_enc_dual_force_idr(this->h264_dual_encoder_);
+  } else if (this->h264_encoder_) {
+    esp_h264_enc_force_idr(this->h264_encoder_);
+  }
+}
+
+void RTSPServer::update_roi_boxes(const esp_h264_enc_roi_box_t *boxes, uint8_t count) {
+  if (count > ESP_H264_ENC_ROI_REGION_MAX)
+    count = ESP_H264_ENC_ROI_REGION_MAX;
+  portENTER_CRITICAL(&this->roi_lock_);
+  memcpy(this->roi_boxes_, boxes, count * sizeof(esp_h264_enc_roi_box_t));
+  this->roi_box_count_ = count;
+  this->roi_boxes_pending_ = true;
+  portEXIT_CRITICAL(&this->roi_lock_);
+}
+
+void RTSPServer::apply_roi_() {
+  if (!this->roi_ctrl_)
+    return;
+
+  // One controller update per detection, the regions are held between detections
+  esp_h264_enc_roi_box_t boxes[ESP_H264_ENC_ROI_REGION_MAX];
+  uint8_t count = 0;
+  bool pending = false;
+  portENTER_CRITICAL(&this->roi_lock_);
+  if (this->roi_boxes_pending_) {
+    memcpy(boxes, this->roi_boxes_, this->roi_box_count_ * sizeof(esp_h264_enc_roi_box_t));
+    count = this->roi_box_count_;
+    this->roi_boxes_pending_ = false;
+    pending = true;
+  }
+  portEXIT_CRITICAL(&this->roi_lock_);
+  if (!pending)
+    return;
+
+  esp_h264_enc_roi_ctrl_update(this->roi_ctrl_, boxes, count);
+  if (esp_h264_enc_roi_ctrl_apply(this->roi_ctrl_, this->h264_param_hd_) != ESP_H264_ERR_OK) {
+    ESP_LOGW(TAG, "Failed to apply ROI regions");
+  }
+}
+
+esp_err_t RTSPServer::init_motion_detection_(esp_h264_enc_param_hw_handle_t param_hd, uint16_t width,
+                                             uint16_t height) {
+  MvMotionConfig config = this->motion_config_;
+  config.width = width;
+  config.height = height;
+  if (!this->motion_detector_.configure(config)) {
+    ESP_LOGE(TAG, "Invalid motion detection configuration for %dx%d", width, height);
+    return ESP_FAIL;
+  }
+  // Zones are given in camera coordinates
+  uint16_t cam_width = this->camera_->get_image_width();
+  uint16_t cam_height = this->camera_->get_image_height();
+  for (const auto &zone : this->motion_zones_) {
+    if (!this->motion_detector_.add_zone(zone.x * width / cam_width, zone.y * height / cam_height,
+                                         std::max(zone.w * width / cam_width, 1),
+                                         std::max(zone.h * height / cam_height, 1)))
+      ESP_LOGW(TAG, "Motion zone %d,%d %dx%d is outside of the picture", zone.x, zone.y, zone.w, zone.h);
+  }
+  this->motion_param_hd_ = param_hd;
+  this->motion_width_ = width;
+  this->motion_height_ = height;
+
+  // One 32-bit word per MB at most, the encoder only writes the MBs with a non zero MV. The length is rounded up to
+  // the 64 byte cache line, esp_cache_msync() rejects a partial line (320x240 is 300 MBs, 1200 bytes)
+  size_t mv_len = ((width + 15) >> 4) * ((height + 15) >> 4) * sizeof(esp_h264_enc_mv_data_t);
+  this->mv_pkt_.len = (mv_len + 63) & ~(size_t) 63;
+  this->mv_pkt_.data = (esp_h264_enc_mv_data_t *) heap_caps_aligned_calloc(64, 1, this->mv_pkt_.len,
+                                                                            MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+  if (!this->mv_pkt_.data) {
+    ESP_LOGE(TAG, "Failed to allocate MV buffer (%u bytes)", (unsigned) this->mv_pkt_.len);
+    return ESP_ERR_NO_MEM;
+  }
+
+  esp_h264_enc_mv_cfg_t mv_cfg = {
+      .mv_mode = ESP_H264_MVM_MODE_P16X16,
+      .mv_fmt = ESP_H264_MVM_FMT_ALL,
+  };
+  if (esp_h264_enc_hw_cfg_mv(param_hd, mv_cfg) != ESP_H264_ERR_OK ||
+      esp_h264_enc_hw_set_mv_pkt(param_hd, this->mv_pkt_) != ESP_H264_ERR_OK) {
+    ESP_LOGE(TAG, "Failed to enable encoder motion vectors");
+    mv_cfg.mv_mode = ESP_H264_MVM_MODE_DISABLE;
+    esp_h264_enc_hw_cfg_mv(param_hd, mv_cfg);
+    free(this->mv_pkt_.data);
+    this->mv_pkt_ = {};
+    return ESP_FAIL;
+  }
+
+  ESP_LOGI(TAG, "Motion detection on encoder MVs: %ux%u MBs",
+           this->motion_detector_.get_mb_width(), this->motion_detector_.get_mb_height());
+  return ESP_OK;
+}
+
+void RTSPServer::update_motion_(bool p_frame) {
+  if (!this->mv_pkt_.data)
+    return;
+
+  uint32_t count = 0;
+  if (esp_h264_enc_hw_get_mv_data_len(this->motion_param_hd_, &count) != ESP_H264_ERR_OK)
+    return;
+  count = std::min<uint32_t>(count, this->mv_pkt_.len / sizeof(esp_h264_enc_mv_data_t));
+  this->motion_detector_.process(this->mv_pkt_.data, count, p_frame);
+  if (!p_frame)
+    return;
+
+  // Boxes are in the 16 aligned encoder picture, scale and clip them to the camera picture
+  uint16_t width = this->camera_->get_image_width();
+  uint16_t height = this->camera_->get_image_height();
+  MvMotionBox boxes[MV_MOTION_MAX_BOXES];
+  uint8_t box_count = 0;
+  for (uint8_t i = 0; i < this->motion_detector_.get_box_count(); i++) {
+    MvMotionBox box = this->motion_detector_.get_boxes()[i];
+    if (this->motion_width_ != width || this->motion_height_ != height) {
+      box.x = box.x * width / this->motion_width_;
+      box.y = box.y * height / this->motion_height_;
+      box.w = box.w * width / this->motion_width_;
+      box.h = box.h * height / this->motion_height_;
+    }
+    if (box.x >= width || box.y >= height)
+      continue;
+    box.w = std::min<uint16_t>(box.w, width - box.x);
+    box.h = std::min<uint16_t>(box.h, height - box.y);
+    boxes[box_count++] = box;
+  }
+  portENTER_CRITICAL(&this->motion_lock_);
+  this->motion_zone_mask_ = this->motion_detector_.get_zone_mask();
+  memcpy(this->motion_boxes_, boxes, box_count * sizeof(MvMotionBox));
+  this->motion_box_count_ = box_count;
+  portEXIT_CRITICAL(&this->motion_lock_);
+}
+
+void RTSPServer::publish_motion_() {
+  MvMotionBox boxes[MV_MOTION_MAX_BOXES];
+  portENTER_CRITICAL(&this->motion_lock_);
+  uint32_t mask = this->motion_zone_mask_;
+  uint8_t box_count = this->motion_box_count_;
+  memcpy(boxes, this->motion_boxes_, box_count * sizeof(MvMotionBox));
+  portEXIT_CRITICAL(&this->motion_lock_);
+
+  bool started = mask != 0 && this->published_zone_mask_ == 0;
+  if (mask != this->published_zone_mask_) {
+    ESP_LOGD(TAG, "Motion zones: 0x%02x, %u box(es)", (unsigned) mask, box_count);
+#ifdef USE_BINARY_SENSOR
+    for (auto &motion_sensor : this->motion_sensors_) {
+      bool state = motion_sensor.zone < 0 ? mask != 0 : (mask >> motion_sensor.zone) & 1;
+      motion_sensor.sensor->publish_state(state);
+    }
+#endif
+    this->published_zone_mask_ = mask;
+  }
+
+  // Boxes go out when the motion starts, then once per second while it lasts
+  uint32_t now = millis();
+  if (mask != 0 && box_count > 0 && (started || now - this->last_motion_callback_ >= 1000)) {
+    this->last_motion_callback_ = now;
+    this->motion_callback_.call(std::vector<MvMotionBox>(boxes, boxes + box_count));
+  }
+}
+
 void RTSPServer::cleanup_h264_encoder_() {
+  if (this->roi_ctrl_) {
+    esp_h264_enc_roi_ctrl_del(this->roi_ctrl_);
+    this->roi_ctrl_ = nullptr;
+  }
+  if (this->mv_pkt_.data && this->motion_param_hd_) {
+    // The MV enable is a register of the encoder, the next encoder must not inherit it
+    esp_h264_enc_mv_cfg_t mv_cfg = {.mv_mode = ESP_H264_MVM_MODE_DISABLE, .mv_fmt = ESP_H264_MVM_FMT_ALL};
+    esp_h264_enc_hw_cfg_mv(this->motion_param_hd_, mv_cfg);
+  }
+  this->motion_param_hd_ = nullptr;
   if (this->h264_encoder_) {
     esp_h264_enc_close(this->h264_encoder_);
     esp_h264_enc_del(this->h264_encoder_);
     this->h264_encoder_ = nullptr;
   }
+  if (this->h264_dual_encoder_) {
+    esp_h264_enc_dual_close(this->h264_dual_encoder_);
+    esp_h264_enc_dual_del(this->h264_dual_encoder_);
+    this->h264_dual_encoder_ = nullptr;
+  }
+  this->h264_param_hd_ = nullptr;
+  this->h264_sub_param_hd_ = nullptr;
+  if (this->mv_pkt_.data) {
+    free(this->mv_pkt_.data);
+    this->mv_pkt_ = {};
+  }
+  // No more frames, the motion ends with the stream
+  this->motion_detector_.reset();
+  portENTER_CRITICAL(&this->motion_lock_);
+  this->motion_zone_mask_ = 0;
+  this->motion_box_count_ = 0;
+  portEXIT_CRITICAL(&this->motion_lock_);
   if (this->yuv_buffer_) {
     free(this->yuv_buffer_);
     this->yuv_buffer_ = nullptr;
@@ -243,20 +532,20 @@ void RTSPServer::cleanup_h264_encoder_() {
     free(this->h264_buffer_);
     this->h264_buffer_ = nullptr;
   }
+  if (this->sub_yuv_buffer_) {
+    free(this->sub_yuv_buffer_);
+    this->sub_yuv_buffer_ = nullptr;
+  }
+  if (this->sub_h264_buffer_) {
+    free(this->sub_h264_buffer_);
+    this->sub_h264_buffer_ = nullptr;
+  }
   if (this->rtp_packet_buffer_) {
     free(this->rtp_packet_buffer_);
     this->rtp_packet_buffer_ = nullptr;
   }
-  if (this->sps_data_) {
-    free(this->sps_data_);
-    this->sps_data_ = nullptr;
-    this->sps_size_ = 0;
-  }
-  if (this->pps_data_) {
-    free(this->pps_data_);
-    this->pps_data_ = nullptr;
-    this->pps_size_ = 0;
-  }
+  for (size_t i = 0; i < this->streams_.size(); i++)
+    this->streams_.get(i).clear_parameter_sets();
 }
 
 esp_err_t RTSPServer::init_rtp_sockets_() {
@@ -377,6 +666,7 @@ void RTSPServer::handle_rtsp_connections_() {
       session.client_addr = client_addr;
       session.last_activity = millis();
       session.active = true;
+      session.stream = -1;
 
       int flags = fcntl(client_fd, F_GETFL, 0);
       fcntl(client_fd, F_SETFL, flags | O_NONBLOCK);
@@ -499,10 +789,26 @@ void RTSPServer::handle_options_(RTSPSession &session, const std::string &reques
   this->send_rtsp_response_(session.socket_fd, 200, "OK", headers);
 }
 
+int8_t RTSPServer::route_request_(RTSPSession &session, const std::string &request) {
+  std::string uri = RtspStreamRouter::request_uri(request);
+  int stream = this->streams_.find(uri);
+  if (stream < 0) {
+    ESP_LOGW(TAG, "No stream at '%s'", uri.c_str());
+    std::map<std::string, std::string> headers;
+    headers["CSeq"] = std::to_string(this->get_cseq_(request));
+    this->send_rtsp_response_(session.socket_fd, 404, "Not Found", headers);
+  }
+  return stream;
+}
+
 void RTSPServer::handle_describe_(RTSPSession &session, const std::string &request) {
   int cseq = this->get_cseq_(request);
+  int8_t stream = this->route_request_(session, request);
+  if (stream < 0)
+    return;
+  session.stream = stream;
 
-  if (!this->h264_encoder_) {
+  if (!this->encoder_ready_()) {
     ESP_LOGI(TAG, "Initializing H.264 encoder for DESCRIBE...");
     if (this->init_h264_encoder_() != ESP_OK) {
       ESP_LOGE(TAG, "Failed to initialize H.264 encoder");
@@ -512,14 +818,18 @@ void RTSPServer::handle_describe_(RTSPSession &session, const std::string &reque
       return;
     }
 
-    // Best effort to get SPS/PPS for SDP
-    if (this->sps_data_ == nullptr || this->pps_data_ == nullptr) {
+    // Best effort to get SPS/PPS for SDP, one encode fills both streams
+    if (!this->streams_.get(stream).has_parameter_sets()) {
       ESP_LOGI(TAG, "Trying to extract SPS/PPS for SDP...");
       this->encode_and_stream_frame_();  // will cache SPS/PPS if frame is available
     }
   }
 
-  std::string sdp = this->generate_sdp_();
+  const RtspStream &rtsp_stream = this->streams_.get(stream);
+  if (!rtsp_stream.has_parameter_sets())
+    ESP_LOGW(TAG, "SDP of %s generated WITHOUT SPS/PPS - client will get them from RTP",
+             rtsp_stream.get_path().c_str());
+  std::string sdp = rtsp_stream.generate_sdp();
 
   std::map<std::string, std::string> headers;
   headers["CSeq"] = std::to_string(cseq);
@@ -530,6 +840,10 @@ void RTSPServer::handle_describe_(RTSPSession &session, const std::string &reque
 
 void RTSPServer::handle_setup_(RTSPSession &session, const std::string &request) {
   int cseq = this->get_cseq_(request);
+  // SETUP URL is the DESCRIBE one plus the track control, "rtsp://host/sub/track1"
+  int8_t stream = this->route_request_(session, request);
+  if (stream < 0)
+    return;
 
   std::string transport_line = this->get_request_line_(request, "Transport");
   ESP_LOGD(TAG, "Transport: '%s'", transport_line.c_str());
@@ -560,6 +874,7 @@ void RTSPServer::handle_setup_(RTSPSession &session, const std::string &request)
   if (session.session_id.empty()) {
     session.session_id = this->generate_session_id_();
   }
+  session.stream = stream;
   session.state = RTSPState::READY;
 
   std::map<std::string, std::string> headers;
@@ -572,14 +887,22 @@ void RTSPServer::handle_setup_(RTSPSession &session, const std::string &request)
 
   this->send_rtsp_response_(session.socket_fd, 200, "OK", headers);
 
-  ESP_LOGI(TAG, "Session %s setup, client RTP port: %d",
-           session.session_id.c_str(), session.client_rtp_port);
+  ESP_LOGI(TAG, "Session %s setup on %s, client RTP port: %d", session.session_id.c_str(),
+           this->streams_.get(stream).get_path().c_str(), session.client_rtp_port);
 }
 
 void RTSPServer::handle_play_(RTSPSession &session, const std::string &request) {
   int cseq = this->get_cseq_(request);
 
-  if (!this->h264_encoder_) {
+  if (session.stream < 0) {
+    ESP_LOGW(TAG, "PLAY before SETUP");
+    std::map<std::string, std::string> headers;
+    headers["CSeq"] = std::to_string(cseq);
+    this->send_rtsp_response_(session.socket_fd, 455, "Method Not Valid in This State", headers);
+    return;
+  }
+
+  if (!this->encoder_ready_()) {
     ESP_LOGW(TAG, "H.264 encoder not initialized (client skipped DESCRIBE?)");
     if (this->init_h264_encoder_() != ESP_OK) {
       ESP_LOGE(TAG, "Failed to initialize H.264 encoder");
@@ -590,6 +913,9 @@ void RTSPServer::handle_play_(RTSPSession &session, const std::string &request)
     }
   }
 
+  // Start the new client on an IDR frame instead of waiting for the next GOP
+  this->force_idr_();
+
   session.state = RTSPState::PLAYING;
   this->streaming_active_ = true;
 
@@ -619,11 +945,12 @@ void RTSPServer::handle_play_(RTSPSession &session, const std::string &request)
   std::map<std::string, std::string> headers;
   headers["CSeq"] = std::to_string(cseq);
   headers["Session"] = session.session_id;
-  headers["RTP-Info"] = "url=" + this->stream_path_ + ";seq=" + std::to_string(this->rtp_seq_num_);
+  const RtspStream &stream = this->streams_.get(session.stream);
+  headers["RTP-Info"] = "url=" + stream.get_path() + ";seq=" + std::to_string(stream.get_seq());
 
   this->send_rtsp_response_(session.socket_fd, 200, "OK", headers);
 
-  ESP_LOGI(TAG, "Session %s started playing", session.session_id.c_str());
+  ESP_LOGI(TAG, "Session %s started playing %s", session.session_id.c_str(), stream.get_path().c_str());
 }
 
 void RTSPServer::handle_teardown_(RTSPSession &session, const std::string &request) {
@@ -663,80 +990,6 @@ void RTSPServer::handle_teardown_(RTSPSession &session, const std::string &reque
   }
 }
 
-std::string RTSPServer::generate_sdp_() {
-  std::string local_ip = "0.0.0.0";  // could be replaced by actual IP if needed
-  uint16_t width = this->camera_->get_image_width();
-  uint16_t height = this->camera_->get_image_height();
-
-  std::ostringstream sdp;
-  sdp << "v=0\r\n";
-  sdp << "o=- 0 0 IN IP4 " << local_ip << "\r\n";
-  sdp << "s=ESP32-P4 RTSP Camera\r\n";
-  sdp << "c=IN IP4 0.0.0.0\r\n";
-  sdp << "t=0 0\r\n";
-  sdp << "a=control:*\r\n";
-  sdp << "a=range:npt=0-\r\n";
-  sdp << "m=video 0 RTP/AVP 96\r\n";
-  sdp << "a=rtpmap:96 H264/90000\r\n";
-  sdp << "a=fmtp:96 packetization-mode=1";
-
-  if (this->sps_data_ && this->sps_size_ > 0 &&
-      this->pps_data_ && this->pps_size_ > 0) {
-    std::string sps_b64 = this->base64_encode_(this->sps_data_, this->sps_size_);
-    std::string pps_b64 = this->base64_encode_(this->pps_data_, this->pps_size_);
-    sdp << ";sprop-parameter-sets=" << sps_b64 << "," << pps_b64;
-    ESP_LOGI(TAG, "SDP includes SPS/PPS (SPS: %d bytes, PPS: %d bytes)",
-             this->sps_size_, this->pps_size_);
-  } else {
-    ESP_LOGW(TAG, "SDP generated WITHOUT SPS/PPS - client will get them from RTP");
-  }
-
-  sdp << "\r\n";
-  sdp << "a=control:track1\r\n";
-  sdp << "a=framerate:30\r\n";
-  sdp << "a=framesize:96 " << width << "-" << height << "\r\n";
-
-  return sdp.str();
-}
-
-std::string RTSPServer::base64_encode_(const uint8_t *data, size_t len) {
-  std::string ret;
-  int i = 0;
-  uint8_t char_array_3[3];
-  uint8_t char_array_4[4];
-
-  while (len--) {
-    char_array_3[i++] = *(data++);
-    if (i == 3) {
-      char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-      char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-      char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-      char_array_4[3] = char_array_3[2] & 0x3f;
-
-      for (i = 0; i < 4; i++)
-        ret += base64_chars[char_array_4[i]];
-      i = 0;
-    }
-  }
-
-  if (i) {
-    for (int j = i; j < 3; j++)
-      char_array_3[j] = '\0';
-
-    char_array_4[0] = (char_array_3[0] & 0xfc) >> 2;
-    char_array_4[1] = ((char_array_3[0] & 0x03) << 4) + ((char_array_3[1] & 0xf0) >> 4);
-    char_array_4[2] = ((char_array_3[1] & 0x0f) << 2) + ((char_array_3[2] & 0xc0) >> 6);
-
-    for (int j = 0; j < i + 1; j++)
-      ret += base64_chars[char_array_4[j]];
-
-    while (i++ < 3)
-      ret += '=';
-  }
-
-  return ret;
-}
-
 esp_err_t RTSPServer::stream_video_() {
   if (!this->streaming_active_)
     return ESP_OK;
@@ -875,8 +1128,60 @@ esp_err_t RTSPServer::convert_rgb565_to_yuv420_(const uint8_t *rgb565,
   return ESP_OK;
 }
 
+esp_err_t RTSPServer::convert_rgb565_to_yuv420_scaled_(const uint8_t *rgb565, uint16_t src_width,
+                                                       uint16_t src_height, uint8_t *yuv420, uint16_t width,
+                                                       uint16_t height) {
+  if (!yuv_lut_initialized_)
+    init_yuv_lut_();
+
+  const uint16_t *rgb = (const uint16_t *) rgb565;
+  // 16.16 fixed point source step, one sample per output pixel
+  uint32_t step_x = ((uint32_t) src_width << 16) / width;
+  uint32_t step_y = ((uint32_t) src_height << 16) / height;
+
+  for (uint16_t row = 0; row < height; row += 2) {
+    const uint16_t *row0 = rgb + ((row * step_y) >> 16) * src_width;
+    const uint16_t *row1 = rgb + std::min<uint32_t>(((row + 1) * step_y) >> 16, src_height - 1) * src_width;
+
+    uint8_t *odd_ptr = yuv420 + (row * width * 3 / 2);
+    uint8_t *even_ptr = yuv420 + ((row + 1) * width * 3 / 2);
+
+    uint32_t sx = 0;
+    for (uint16_t col = 0; col < width; col += 2, odd_ptr += 3, even_ptr += 3) {
+      uint32_t x0 = sx >> 16;
+      sx += step_x;
+      uint32_t x1 = std::min<uint32_t>(sx >> 16, src_width - 1);
+      sx += step_x;
+
+      uint16_t p00 = row0[x0];
+      uint16_t p01 = row0[x1];
+      uint16_t p10 = row1[x0];
+      uint16_t p11 = row1[x1];
+
+      uint8_t r0 = (p00 >> 11), g0 = (p00 >> 5) & 0x3F, b0 = p00 & 0x1F;
+      uint8_t r1 = (p01 >> 11), g1 = (p01 >> 5) & 0x3F, b1 = p01 & 0x1F;
+      uint8_t r2 = (p10 >> 11), g2 = (p10 >> 5) & 0x3F, b2 = p10 & 0x1F;
+      uint8_t r3 = (p11 >> 11), g3 = (p11 >> 5) & 0x3F, b3 = p11 & 0x1F;
+
+      uint8_t r_avg = (r0 + r1 + r2 + r3) >> 2;
+      uint8_t g_avg = (g0 + g1 + g2 + g3) >> 2;
+      uint8_t b_avg = (b0 + b1 + b2 + b3) >> 2;
+
+      odd_ptr[0] = u_r_lut_[r_avg] + u_g_lut_[g_avg] + u_b_lut_[b_avg] + 128;
+      odd_ptr[1] = y_r_lut_[r0] + y_g_lut_[g0] + y_b_lut_[b0] + 16;
+      odd_ptr[2] = y_r_lut_[r1] + y_g_lut_[g1] + y_b_lut_[b1] + 16;
+
+      even_ptr[0] = v_r_lut_[r_avg] + v_g_lut_[g_avg] + v_b_lut_[b_avg] + 128;
+      even_ptr[1] = y_r_lut_[r2] + y_g_lut_[g2] + y_b_lut_[b2] + 16;
+      even_ptr[2] = y_r_lut_[r3] + y_g_lut_[g3] + y_b_lut_[b3] + 16;
+    }
+  }
+
+  return ESP_OK;
+}
+
 esp_err_t RTSPServer::encode_and_stream_frame_() {
-  if (!this->camera_ || !this->h264_encoder_)
+  if (!this->camera_ || !this->encoder_ready_())
     return ESP_FAIL;
 
   // 🔴 IMPORTANT : on utilise la même API que camera_web_server
@@ -902,6 +1207,19 @@ esp_err_t RTSPServer::encode_and_stream_frame_() {
              width, height, (unsigned) frame_size);
   }
 
+  // The encoder buffers are sized for one picture, a frame captured just after the switch may come before the
+  // notification, hence the size check too
+  const RtspStream &main_stream = this->streams_.get(0);
+  if (this->camera_resized_.exchange(false) || width != main_stream.get_width() ||
+      height != main_stream.get_height()) {
+    ESP_LOGI(TAG, "Restarting the H.264 encoder at %ux%u", width, height);
+    this->cleanup_h264_encoder_();
+    if (this->init_h264_encoder_() != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to restart the H.264 encoder");
+      return ESP_FAIL;
+    }
+  }
+
   // Convert RGB565 -> O_UYY_E_VYY (YUV420 packed) for HW encoder
   this->convert_rgb565_to_yuv420_(frame_data, this->yuv_buffer_, width, height);
 
@@ -915,7 +1233,25 @@ esp_err_t RTSPServer::encode_and_stream_frame_() {
   out_frame.raw_data.buffer = this->h264_buffer_;
   out_frame.raw_data.len = this->h264_buffer_size_;
 
-  esp_h264_err_t ret = esp_h264_enc_process(this->h264_encoder_, &in_frame, &out_frame);
+  this->apply_roi_();
+  esp_h264_err_t ret;
+  esp_h264_enc_out_frame_t sub_out_frame = {};
+  if (this->h264_dual_encoder_) {
+    this->convert_rgb565_to_yuv420_scaled_(frame_data, width, height, this->sub_yuv_buffer_, this->sub_enc_width_,
+                                           this->sub_enc_height_);
+
+    esp_h264_enc_in_frame_t sub_in_frame = in_frame;
+    sub_in_frame.raw_data.buffer = this->sub_yuv_buffer_;
+    sub_in_frame.raw_data.len = this->sub_yuv_buffer_size_;
+    sub_out_frame.raw_data.buffer = this->sub_h264_buffer_;
+    sub_out_frame.raw_data.len = this->sub_h264_buffer_size_;
+
+    esp_h264_enc_in_frame_t *in_frames[2] = {&in_frame, &sub_in_frame};
+    esp_h264_enc_out_frame_t *out_frames[2] = {&out_frame, &sub_out_frame};
+    ret = esp_h264_enc_dual_process(this->h264_dual_encoder_, in_frames, out_frames);
+  } else {
+    ret = esp_h264_enc_process(this->h264_encoder_, &in_frame, &out_frame);
+  }
   if (ret != ESP_H264_ERR_OK) {
     ESP_LOGE(TAG,
              "H.264 encoding failed: err=%d (frame=%u, in_len=%u, out_len=%u)",
@@ -942,211 +1278,36 @@ esp_err_t RTSPServer::encode_and_stream_frame_() {
     return ESP_FAIL;
   }
 
-  if (out_frame.frame_type == ESP_H264_FRAME_TYPE_IDR) {
-    ESP_LOGI(TAG, "IDR frame - caching SPS/PPS");
-    this->parse_and_cache_nal_units_(out_frame.raw_data.buffer, out_frame.length);
-  }
-
-  auto nal_units = this->parse_nal_units_(out_frame.raw_data.buffer, out_frame.length);
-  ESP_LOGV(TAG, "Found %d NAL units", (int) nal_units.size());
-
-  for (size_t i = 0; i < nal_units.size(); i++) {
-    const auto &nal = nal_units[i];
-    uint8_t nal_type = nal.first[0] & 0x1F;
-    const char *nal_name = "Unknown";
-    if (nal_type == 1) nal_name = "P-slice";
-    else if (nal_type == 5) nal_name = "IDR";
-    else if (nal_type == 6) nal_name = "SEI";
-    else if (nal_type == 7) nal_name = "SPS";
-    else if (nal_type == 8) nal_name = "PPS";
-
-    ESP_LOGV(TAG,
-             "Sending NAL %d: type=%d (%s), %u bytes",
-             (int) i, nal_type, nal_name, (unsigned) nal.second);
+  this->update_motion_(out_frame.frame_type == ESP_H264_FRAME_TYPE_P);
 
-    // marker = true pour chaque NAL (idéalement, seulement pour le dernier d'une frame)
-    this->send_h264_rtp_(nal.first, nal.second, true);
-  }
+  this->send_stream_frame_(0, out_frame);
+  if (this->h264_dual_encoder_ && sub_out_frame.length > 0)
+    this->send_stream_frame_(this->sub_stream_, sub_out_frame);
 
   this->frame_count_++;
-  this->rtp_timestamp_ += 3000;  // 90kHz / 30fps
-
   return ESP_OK;
 }
 
-void RTSPServer::parse_and_cache_nal_units_(const uint8_t *data, size_t len) {
-  auto nal_units = this->parse_nal_units_(data, len);
-
-  for (const auto &nal : nal_units) {
-    uint8_t nal_type = nal.first[0] & 0x1F;
-    if (nal_type == 7) {  // SPS
-      if (this->sps_data_)
-        free(this->sps_data_);
-      this->sps_size_ = nal.second;
-      this->sps_data_ = (uint8_t *) malloc(this->sps_size_);
-      memcpy(this->sps_data_, nal.first, this->sps_size_);
-      ESP_LOGI(TAG, "Cached SPS (%d bytes)", this->sps_size_);
-    } else if (nal_type == 8) {  // PPS
-      if (this->pps_data_)
-        free(this->pps_data_);
-      this->pps_size_ = nal.second;
-      this->pps_data_ = (uint8_t *) malloc(this->pps_size_);
-      memcpy(this->pps_data_, nal.first, this->pps_size_);
-      ESP_LOGI(TAG, "Cached PPS (%d bytes)", this->pps_size_);
-    }
-  }
-}
-
-std::vector<std::pair<const uint8_t *, size_t>>
-RTSPServer::parse_nal_units_(const uint8_t *data, size_t len) {
-  this->nal_units_cache_.clear();
-
-  if (data == nullptr || len < 4) {
-    ESP_LOGW(TAG, "parse_nal_units_: invalid input (ptr=%p, len=%u)", data, (unsigned) len);
-    return this->nal_units_cache_;
-  }
-
-  size_t i = 0;
-  while (i + 3 < len) {
-    if (data[i] == 0x00 && data[i + 1] == 0x00) {
-      size_t start_code_len = 0;
-      if (data[i + 2] == 0x01) {
-        start_code_len = 3;
-      } else if (data[i + 2] == 0x00 && data[i + 3] == 0x01) {
-        start_code_len = 4;
-      }
-
-      if (start_code_len > 0) {
-        size_t j = i + start_code_len;
-        while (j + 3 < len) {
-          if (data[j] == 0x00 && data[j + 1] == 0x00 &&
-              (data[j + 2] == 0x01 ||
-               (data[j + 2] == 0x00 && data[j + 3] == 0x01))) {
-            break;
-          }
-          j++;
-        }
-
-        size_t nal_size = j - (i + start_code_len);
-        if (nal_size > 0) {
-          this->nal_units_cache_.push_back({data + i + start_code_len, nal_size});
-        }
-
-        i = j;
-        continue;
-      }
-    }
-    i++;
-  }
-
-  return this->nal_units_cache_;
-}
-
-esp_err_t RTSPServer::send_h264_rtp_(const uint8_t *data, size_t len, bool marker) {
-  if (!data || len == 0) {
-    ESP_LOGW(TAG, "send_h264_rtp_: invalid data");
-    return ESP_FAIL;
-  }
-
-  const size_t MAX_RTP_PAYLOAD = 1400;
-
-  if (len <= MAX_RTP_PAYLOAD) {
-    uint8_t *packet = this->rtp_packet_buffer_;
-    RTPHeader *rtp = (RTPHeader *) packet;
-
-    rtp->v = 2;
-    rtp->p = 0;
-    rtp->x = 0;
-    rtp->cc = 0;
-    rtp->m = marker ? 1 : 0;
-    rtp->pt = 96;
-    rtp->seq = htons(this->rtp_seq_num_++);
-    rtp->timestamp = htonl(this->rtp_timestamp_);
-    rtp->ssrc = htonl(this->rtp_ssrc_);
-
-    memcpy(packet + sizeof(RTPHeader), data, len);
-
-    for (auto &session: this->sessions_) {
-      if (session.active && session.state == RTSPState::PLAYING) {
-        struct sockaddr_in dest = session.client_addr;
-        dest.sin_port = htons(session.client_rtp_port);
-        sendto(this->rtp_socket_,
-               packet,
-               sizeof(RTPHeader) + len,
-               0,
-               (struct sockaddr *) &dest,
-               sizeof(dest));
-      }
-    }
-
-    return ESP_OK;
+void RTSPServer::send_stream_frame_(uint8_t stream, const esp_h264_enc_out_frame_t &out_frame) {
+  RtspStream &rtsp_stream = this->streams_.get(stream);
+  if (out_frame.frame_type == ESP_H264_FRAME_TYPE_IDR) {
+    ESP_LOGD(TAG, "IDR frame - caching SPS/PPS of %s", rtsp_stream.get_path().c_str());
+    rtsp_stream.cache_parameter_sets(out_frame.raw_data.buffer, out_frame.length);
   }
 
-  ESP_LOGD(TAG, "Fragmenting NAL (%u bytes) using FU-A", (unsigned) len);
-
-  uint8_t nal_header = data[0];
-  uint8_t nal_type = nal_header & 0x1F;
-  uint8_t nri = nal_header & 0x60;
-
-  uint8_t fu_indicator = nri | 28;  // FU-A
-  const uint8_t *payload = data + 1;
-  size_t payload_len = len - 1;
-  size_t offset = 0;
-  size_t fragments = 0;
-
-  uint8_t *packet = this->rtp_packet_buffer_;
-
-  while (offset < payload_len) {
-    RTPHeader *rtp = (RTPHeader *) packet;
-
-    rtp->v = 2;
-    rtp->p = 0;
-    rtp->x = 0;
-    rtp->cc = 0;
-    rtp->pt = 96;
-    rtp->seq = htons(this->rtp_seq_num_++);
-    rtp->timestamp = htonl(this->rtp_timestamp_);
-    rtp->ssrc = htonl(this->rtp_ssrc_);
-
-    uint8_t *fu_payload = packet + sizeof(RTPHeader);
-    fu_payload[0] = fu_indicator;
-
-    bool is_start = (offset == 0);
-    size_t remaining = payload_len - offset;
-    size_t chunk = remaining > (MAX_RTP_PAYLOAD - 2) ? (MAX_RTP_PAYLOAD - 2) : remaining;
-    bool is_end = (offset + chunk >= payload_len);
-
-    uint8_t fu_header = nal_type;
-    if (is_start) fu_header |= 0x80;
-    if (is_end) fu_header |= 0x40;
-
-    fu_payload[1] = fu_header;
-
-    memcpy(fu_payload + 2, payload + offset, chunk);
-
-    rtp->m = (is_end && marker) ? 1 : 0;
-
-    size_t packet_size = sizeof(RTPHeader) + 2 + chunk;
-
-    for (auto &session: this->sessions_) {
-      if (session.active && session.state == RTSPState::PLAYING) {
+  // Each path only goes to the sessions playing it, the timestamp moves on even without them
+  auto send = [this, stream](const uint8_t *packet, size_t len) {
+    for (auto &session : this->sessions_) {
+      if (session.active && session.state == RTSPState::PLAYING && session.stream == stream) {
         struct sockaddr_in dest = session.client_addr;
         dest.sin_port = htons(session.client_rtp_port);
-        sendto(this->rtp_socket_,
-               packet,
-               packet_size,
-               0,
-               (struct sockaddr *) &dest,
-               sizeof(dest));
+        sendto(this->rtp_socket_, packet, len, 0, (struct sockaddr *) &dest, sizeof(dest));
       }
     }
-
-    offset += chunk;
-    fragments++;
-  }
-
-  ESP_LOGV(TAG, "Sent NAL in %u fragments", (unsigned) fragments);
-  return ESP_OK;
+  };
+  size_t packets = rtsp_stream.send_frame(out_frame.raw_data.buffer, out_frame.length, this->rtp_packet_buffer_, send);
+  ESP_LOGV(TAG, "Sent %u bytes on %s in %u RTP packets", (unsigned) out_frame.length, rtsp_stream.get_path().c_str(),
+           (unsigned) packets);
 }
 
 std::string RTSPServer::generate_session_id_() {
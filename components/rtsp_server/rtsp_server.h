@@ -2,16 +2,25 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/log.h"
+#include "esphome/core/automation.h"
 #include "esphome/components/mipi_dsi_cam/mipi_dsi_cam.h"
+#ifdef USE_BINARY_SENSOR
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
 
 #ifdef USE_ESP_IDF
 #include <lwip/sockets.h>
+#include <atomic>
 #include <string>
 #include <vector>
 #include <map>
 #include "esp_h264_enc_single.h"
 #include "esp_h264_enc_single_hw.h"  // Hardware encoder (ESP32-P4)
+#include "esp_h264_enc_dual_hw.h"    // Main + sub stream in one hardware pass
+#include "esp_h264_enc_roi_ctrl.h"
 #include "esp_h264_types.h"
+#include "mv_motion_detector.h"
+#include "rtsp_stream.h"
 #endif
 
 namespace esphome {
@@ -19,19 +28,6 @@ namespace rtsp_server {
 
 #ifdef USE_ESP_IDF
 
-// RTP Header (RFC 3550)
-struct RTPHeader {
-  uint8_t cc : 4;       // CSRC count
-  uint8_t x : 1;        // Extension
-  uint8_t p : 1;        // Padding
-  uint8_t v : 2;        // Version
-  uint8_t pt : 7;       // Payload type
-  uint8_t m : 1;        // Marker
-  uint16_t seq;         // Sequence number
-  uint32_t timestamp;   // Timestamp
-  uint32_t ssrc;        // SSRC
-} __attribute__((packed));
-
 // RTSP Methods
 enum class RTSPMethod {
   OPTIONS,
@@ -60,6 +56,7 @@ struct RTSPSession {
   struct sockaddr_in client_addr;
   uint32_t last_activity;
   bool active;
+  int8_t stream;  // index in the stream router, set by DESCRIBE/SETUP
 };
 
 class RTSPServer : public Component {
@@ -83,6 +80,43 @@ class RTSPServer : public Component {
   void set_username(const std::string &username) { username_ = username; }
   void set_password(const std::string &password) { password_ = password; }
   void set_enabled(bool enabled) { enabled_ = enabled; }
+  // Second, smaller stream encoded in the same hardware pass as the main one. The GOP is
+  // shared: the dual encoder uses the average of both GOPs, so both get `gop`.
+  void set_sub_stream(const std::string &path, uint16_t width, uint16_t height, uint32_t bitrate, uint8_t qp_min,
+                      uint8_t qp_max) {
+    sub_path_ = path;
+    sub_width_ = width;
+    sub_height_ = height;
+    sub_bitrate_ = bitrate;
+    sub_qp_min_ = qp_min;
+    sub_qp_max_ = qp_max;
+  }
+  void set_roi_delta_qp(int8_t qp) { roi_delta_qp_ = qp; }
+  void set_roi_background_delta_qp(int8_t qp) { roi_background_delta_qp_ = qp; }
+
+  // Region of interest: boxes of a face/person detector, in camera image coordinates.
+  // They are applied to the encoder before the next frame, an empty list clears them.
+  void update_roi_boxes(const esp_h264_enc_roi_box_t *boxes, uint8_t count);
+  void update_roi_boxes(const std::vector<esp_h264_enc_roi_box_t> &boxes) {
+    this->update_roi_boxes(boxes.data(), boxes.size());
+  }
+
+  // Motion detection from the encoder motion vectors, only while the stream is encoded
+  void set_motion_detection(bool enabled) { motion_enabled_ = enabled; }
+  void set_motion_config(const MvMotionConfig &config) { motion_config_ = config; }
+  void add_motion_zone(uint16_t x, uint16_t y, uint16_t w, uint16_t h) { motion_zones_.push_back({x, y, w, h, 0}); }
+#ifdef USE_BINARY_SENSOR
+  // zone -1 follows the whole picture (any zone)
+  void add_motion_binary_sensor(binary_sensor::BinarySensor *sensor, int8_t zone) {
+    motion_sensors_.push_back({sensor, zone});
+    motion_enabled_ = true;
+  }
+#endif
+  void add_on_motion_callback(std::function<void(std::vector<MvMotionBox>)> &&callback) {
+    motion_callback_.add(std::move(callback));
+    motion_enabled_ = true;
+  }
+  bool is_motion() const { return published_zone_mask_ != 0; }
 
  protected:
   mipi_dsi_cam::MipiDSICamComponent *camera_{nullptr};
@@ -98,6 +132,14 @@ class RTSPServer : public Component {
   std::string username_{""};
   std::string password_{""};
   bool enabled_{false};  // RTSP server enabled/disabled by switch
+  std::string sub_path_{"/sub"};
+  uint16_t sub_width_{0};  // 0 = main stream only
+  uint16_t sub_height_{0};
+  uint32_t sub_bitrate_{500000};
+  uint8_t sub_qp_min_{10};
+  uint8_t sub_qp_max_{40};
+  int8_t roi_delta_qp_{0};  // 0 = ROI encoding disabled
+  int8_t roi_background_delta_qp_{0};
 
   // RTSP server socket
   int rtsp_socket_{-1};
@@ -106,24 +148,61 @@ class RTSPServer : public Component {
   // RTP streaming
   int rtp_socket_{-1};
   int rtcp_socket_{-1};
-  uint16_t rtp_seq_num_{0};
-  uint32_t rtp_timestamp_{0};
-  uint32_t rtp_ssrc_{0};
+  RtspStreamRouter streams_;  // stream 0 is the main stream, 1 the sub stream
+  int8_t sub_stream_{-1};
 
-  // H.264 encoder
+  // H.264 encoder: single for the main stream only, dual with a sub stream
   esp_h264_enc_handle_t h264_encoder_{nullptr};
+  esp_h264_enc_dual_handle_t h264_dual_encoder_{nullptr};
+  esp_h264_enc_param_hw_handle_t h264_param_hd_{nullptr};      // main stream
+  esp_h264_enc_param_hw_handle_t h264_sub_param_hd_{nullptr};  // sub stream
   uint8_t *yuv_buffer_{nullptr};
   size_t yuv_buffer_size_{0};
   uint8_t *h264_buffer_{nullptr};
   size_t h264_buffer_size_{0};
+  uint16_t sub_enc_width_{0};  // 16 aligned
+  uint16_t sub_enc_height_{0};
+  uint8_t *sub_yuv_buffer_{nullptr};
+  size_t sub_yuv_buffer_size_{0};
+  uint8_t *sub_h264_buffer_{nullptr};
+  size_t sub_h264_buffer_size_{0};
+
+  // ROI controller, fed from the detector task and applied by the streaming task
+  esp_h264_enc_roi_ctrl_handle_t roi_ctrl_{nullptr};
+  portMUX_TYPE roi_lock_ = portMUX_INITIALIZER_UNLOCKED;
+  esp_h264_enc_roi_box_t roi_boxes_[ESP_H264_ENC_ROI_REGION_MAX];
+  uint8_t roi_box_count_{0};
+  bool roi_boxes_pending_{false};
+
+  // Motion detection: analysed by the streaming task, published by loop()
+  bool motion_enabled_{false};
+  MvMotionConfig motion_config_;
+  std::vector<MvMotionBox> motion_zones_;
+  MvMotionDetector motion_detector_;
+  esp_h264_enc_param_hw_handle_t motion_param_hd_{nullptr};  // the sub stream with the dual encoder
+  uint16_t motion_width_{0};  // picture the MVs refer to, boxes and zones are scaled from/to the camera
+  uint16_t motion_height_{0};
+  esp_h264_enc_mvm_pkt_t mv_pkt_{};
+  portMUX_TYPE motion_lock_ = portMUX_INITIALIZER_UNLOCKED;
+  uint32_t motion_zone_mask_{0};       // shared with the streaming task
+  MvMotionBox motion_boxes_[MV_MOTION_MAX_BOXES];
+  uint8_t motion_box_count_{0};
+  uint32_t published_zone_mask_{0};    // loop() only
+  uint32_t last_motion_callback_{0};
+#ifdef USE_BINARY_SENSOR
+  struct MotionSensor {
+    binary_sensor::BinarySensor *sensor;
+    int8_t zone;
+  };
+  std::vector<MotionSensor> motion_sensors_;
+#endif
+  CallbackManager<void(std::vector<MvMotionBox>)> motion_callback_;
 
   // Streaming state
   bool streaming_active_{false};
   uint32_t frame_count_{0};
-  uint8_t *sps_data_{nullptr};
-  size_t sps_size_{0};
-  uint8_t *pps_data_{nullptr};
-  size_t pps_size_{0};
+  // Set by the camera on a resolution switch, the streaming task recreates the encoder at the new size
+  std::atomic<bool> camera_resized_{false};
 
   // Streaming task (separate from loopTask to avoid stack overflow)
   TaskHandle_t streaming_task_handle_{nullptr};
@@ -131,13 +210,20 @@ class RTSPServer : public Component {
 
   // Preallocated buffers to reduce stack usage
   uint8_t *rtp_packet_buffer_{nullptr};  // Reusable RTP packet buffer (2KB)
-  std::vector<std::pair<const uint8_t *, size_t>> nal_units_cache_;  // Reusable NAL units vector
 
   // Internal methods
   esp_err_t init_rtsp_server_();
   esp_err_t init_rtp_sockets_();
   esp_err_t init_h264_encoder_();
+  esp_err_t alloc_frame_buffers_(uint16_t width, uint16_t height, uint8_t **yuv, size_t *yuv_size, uint8_t **h264,
+                                 size_t *h264_size);
+  bool encoder_ready_() const { return this->h264_encoder_ != nullptr || this->h264_dual_encoder_ != nullptr; }
+  void force_idr_();
   void cleanup_h264_encoder_();
+  void apply_roi_();
+  esp_err_t init_motion_detection_(esp_h264_enc_param_hw_handle_t param_hd, uint16_t width, uint16_t height);
+  void update_motion_(bool p_frame);
+  void publish_motion_();
   void cleanup_sockets_();
 
   // RTSP protocol handling
@@ -154,10 +240,8 @@ class RTSPServer : public Component {
   void handle_setup_(RTSPSession &session, const std::string &request);
   void handle_play_(RTSPSession &session, const std::string &request);
   void handle_teardown_(RTSPSession &session, const std::string &request);
-
-  // SDP generation
-  std::string generate_sdp_();
-  std::string base64_encode_(const uint8_t *data, size_t len);
+  // Stream of the request URI, answers 404 and returns -1 for an unknown path
+  int8_t route_request_(RTSPSession &session, const std::string &request);
 
   // Video streaming
   esp_err_t stream_video_();
@@ -166,9 +250,10 @@ class RTSPServer : public Component {
                                           uint16_t width, uint16_t height);
   esp_err_t convert_rgb565_to_yuv420_(const uint8_t *rgb565, uint8_t *yuv420,
                                        uint16_t width, uint16_t height);
-  esp_err_t send_h264_rtp_(const uint8_t *data, size_t len, bool marker);
-  void parse_and_cache_nal_units_(const uint8_t *data, size_t len);
-  std::vector<std::pair<const uint8_t *, size_t>> parse_nal_units_(const uint8_t *data, size_t len);
+  // Nearest neighbour downscale of the camera picture for the sub stream
+  esp_err_t convert_rgb565_to_yuv420_scaled_(const uint8_t *rgb565, uint16_t src_width, uint16_t src_height,
+                                              uint8_t *yuv420, uint16_t width, uint16_t height);
+  void send_stream_frame_(uint8_t stream, const esp_h264_enc_out_frame_t &out_frame);
 
   // RGB565 to YUV conversion lookup tables (for performance)
   static void init_yuv_lut_();
@@ -196,6 +281,13 @@ class RTSPServer : public Component {
   bool check_authentication_(const std::string &request);
 };
 
+class MotionTrigger : public Trigger<std::vector<MvMotionBox>> {
+ public:
+  explicit MotionTrigger(RTSPServer *parent) {
+    parent->add_on_motion_callback([this](std::vector<MvMotionBox> boxes) { this->trigger(boxes); });
+  }
+};
+
 #endif  // USE_ESP_IDF
 
 }  // namespace rtsp_server
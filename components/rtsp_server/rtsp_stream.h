@@ -0,0 +1,93 @@
+#pragma once
+
+// RTSP paths served by the server: request routing, SDP and RTP packetization per path.
+//
+// Each path has its own RTP sequence number, timestamp, SSRC and SPS/PPS, so the main and
+// the sub stream can be played at the same time from the same RTP socket. This file does not
+// depend on ESPHome nor on the encoder, it is built and tested on Linux.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace rtsp_server {
+
+static const size_t RTSP_MAX_RTP_PAYLOAD = 1400;
+static const uint8_t RTSP_RTP_HEADER_SIZE = 12;
+static const uint8_t RTSP_H264_PAYLOAD_TYPE = 96;
+
+using NalUnit = std::pair<const uint8_t *, size_t>;
+using RtpSendFn = std::function<void(const uint8_t *packet, size_t len)>;
+
+// Splits an Annex B byte stream into NAL units, start codes removed
+void parse_nal_units(const uint8_t *data, size_t len, std::vector<NalUnit> &out);
+std::string base64_encode(const uint8_t *data, size_t len);
+
+class RtspStream {
+ public:
+  RtspStream(const std::string &path, uint32_t ssrc) : path_(path), ssrc_(ssrc) {}
+
+  const std::string &get_path() const { return this->path_; }
+  void set_video(uint16_t width, uint16_t height, uint8_t fps) {
+    this->width_ = width;
+    this->height_ = height;
+    this->fps_ = fps;
+  }
+  uint16_t get_width() const { return this->width_; }
+  uint16_t get_height() const { return this->height_; }
+
+  // SPS/PPS of the last IDR frame, they go in the SDP
+  void cache_parameter_sets(const uint8_t *data, size_t len);
+  bool has_parameter_sets() const { return !this->sps_.empty() && !this->pps_.empty(); }
+  void clear_parameter_sets();
+  std::string generate_sdp() const;
+
+  // Packetizes one encoded frame (RFC 6184 single NAL unit or FU-A) in `buffer`, which must hold
+  // RTSP_RTP_HEADER_SIZE + RTSP_MAX_RTP_PAYLOAD bytes. The marker bit is set on the last packet
+  // of the frame, then the timestamp moves to the next frame. Returns the packets sent.
+  size_t send_frame(const uint8_t *data, size_t len, uint8_t *buffer, const RtpSendFn &send);
+  size_t send_nal(const uint8_t *nal, size_t len, bool marker, uint8_t *buffer, const RtpSendFn &send);
+
+  uint16_t get_seq() const { return this->seq_; }
+  uint32_t get_timestamp() const { return this->timestamp_; }
+  uint32_t get_ssrc() const { return this->ssrc_; }
+
+ protected:
+  void write_header_(uint8_t *buffer, bool marker);
+
+  std::string path_;
+  uint32_t ssrc_;
+  uint16_t seq_{0};
+  uint32_t timestamp_{0};
+  uint16_t width_{0};
+  uint16_t height_{0};
+  uint8_t fps_{30};
+  std::vector<uint8_t> sps_;
+  std::vector<uint8_t> pps_;
+  std::vector<NalUnit> nal_units_;  // reused between frames
+};
+
+class RtspStreamRouter {
+ public:
+  // Returns the index of the stream, or -1 if the path is already served
+  int add_stream(const std::string &path, uint32_t ssrc);
+  size_t size() const { return this->streams_.size(); }
+  RtspStream &get(size_t index) { return this->streams_[index]; }
+  const RtspStream &get(size_t index) const { return this->streams_[index]; }
+
+  // Stream of a request URI, absolute ("rtsp://user@host:554/sub/track1?x") or not ("/sub").
+  // A path matches itself and its sub paths (SETUP controls), the longest path wins. -1 if none.
+  int find(const std::string &uri) const;
+  // URI of the first line of an RTSP request: "DESCRIBE rtsp://host/sub RTSP/1.0"
+  static std::string request_uri(const std::string &request);
+
+ protected:
+  std::vector<RtspStream> streams_;
+};
+
+}  // namespace rtsp_server
+}  // namespace esphome
@@ -0,0 +1,238 @@
+/*
+ * Tests of the motion detection from the H.264 encoder motion vectors
+ *
+ * Frames are given as raw MV packets, the 32-bit words the encoder writes by DMA, so a
+ * dump of `esp_h264_enc_mvm_pkt_t::data` (`esp_h264_enc_hw_get_mv_data_len` words per frame)
+ * is replayed the same way.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "unity.h"
+
+#include "mv_motion_detector.h"
+
+using esphome::rtsp_server::MvMotionBox;
+using esphome::rtsp_server::MvMotionConfig;
+using esphome::rtsp_server::MvMotionDetector;
+using esphome::rtsp_server::MV_MOTION_MAX_BOXES;
+
+namespace {
+
+// 640x480: 40x30 MBs
+const uint16_t WIDTH = 640;
+const uint16_t HEIGHT = 480;
+
+uint32_t pack_mv(uint8_t mb_x, uint8_t mb_y, int8_t mv_x, int8_t mv_y) {
+  esp_h264_enc_mv_data_t mv = {};
+  mv.mb_x = mb_x;
+  mv.mb_y = mb_y;
+  mv.mv_x = mv_x;
+  mv.mv_y = mv_y;
+  return mv.data;
+}
+
+// Object of w*h MBs at (mb_x, mb_y) moving by (mv_x, mv_y)
+void add_object(std::vector<uint32_t> &pkt, uint8_t mb_x, uint8_t mb_y, uint8_t w, uint8_t h, int8_t mv_x,
+                int8_t mv_y) {
+  for (uint8_t y = mb_y; y < mb_y + h; y++) {
+    for (uint8_t x = mb_x; x < mb_x + w; x++)
+      pkt.push_back(pack_mv(x, y, mv_x, mv_y));
+  }
+}
+
+bool replay(MvMotionDetector &det, const std::vector<uint32_t> &pkt, bool p_frame = true) {
+  return det.process(reinterpret_cast<const esp_h264_enc_mv_data_t *>(pkt.data()), pkt.size(), p_frame);
+}
+
+MvMotionConfig default_config() {
+  MvMotionConfig cfg;
+  cfg.width = WIDTH;
+  cfg.height = HEIGHT;
+  cfg.min_magnitude = 4;
+  cfg.min_neighbors = 1;
+  cfg.min_blocks = 4;
+  cfg.max_area_percent = 50;
+  cfg.on_frames = 2;
+  cfg.off_frames = 5;
+  return cfg;
+}
+
+}  // namespace
+
+TEST_CASE("mv motion rejects invalid configurations", "[mv_motion]")
+{
+  MvMotionDetector det;
+  MvMotionConfig cfg = default_config();
+  cfg.width = 0;
+  TEST_ASSERT_FALSE(det.configure(cfg));
+  cfg = default_config();
+  cfg.width = 129 * 16;  // MB position is 7 bits in the packet
+  TEST_ASSERT_FALSE(det.configure(cfg));
+  cfg = default_config();
+  cfg.on_frames = 0;
+  TEST_ASSERT_FALSE(det.configure(cfg));
+
+  TEST_ASSERT_TRUE(det.configure(default_config()));
+  TEST_ASSERT_EQUAL(40, det.get_mb_width());
+  TEST_ASSERT_EQUAL(30, det.get_mb_height());
+  TEST_ASSERT_EQUAL(1, det.get_zone_count());
+  TEST_ASSERT_FALSE(det.add_zone(0, 0, 0, 16));
+  TEST_ASSERT_FALSE(det.add_zone(WIDTH, 0, 16, 16));
+}
+
+TEST_CASE("mv motion ignores isolated and small vectors", "[mv_motion]")
+{
+  MvMotionDetector det;
+  TEST_ASSERT_TRUE(det.configure(default_config()));
+
+  std::vector<uint32_t> pkt;
+  // Lone MVs scattered over the picture, as sensor noise gives
+  for (uint8_t i = 0; i < 10; i++)
+    pkt.push_back(pack_mv(i * 4, i * 3, 12, -9));
+  // A large area with sub threshold vectors
+  add_object(pkt, 20, 10, 6, 6, 2, -1);
+  // Out of picture entries are dropped
+  pkt.push_back(pack_mv(100, 2, 20, 20));
+  pkt.push_back(pack_mv(101, 2, 20, 20));
+
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_FALSE(replay(det, pkt));
+  }
+  TEST_ASSERT_FALSE(det.is_motion());
+  TEST_ASSERT_EQUAL(0, det.get_moving_blocks());
+  TEST_ASSERT_EQUAL(0, det.get_box_count());
+  TEST_ASSERT_EQUAL(12 + 9, det.get_magnitude_map()[0]);
+}
+
+TEST_CASE("mv motion starts after on_frames and clears after off_frames", "[mv_motion]")
+{
+  MvMotionDetector det;
+  MvMotionConfig cfg = default_config();
+  TEST_ASSERT_TRUE(det.configure(cfg));
+
+  std::vector<uint32_t> moving;
+  add_object(moving, 10, 8, 3, 4, -6, 2);
+  std::vector<uint32_t> still;
+
+  TEST_ASSERT_FALSE(replay(det, moving));
+  TEST_ASSERT_FALSE(det.is_motion());
+  // A single hot frame between still ones does not trigger
+  TEST_ASSERT_FALSE(replay(det, still));
+  TEST_ASSERT_FALSE(replay(det, moving));
+  TEST_ASSERT_TRUE(replay(det, moving));
+  TEST_ASSERT_TRUE(det.is_motion());
+  TEST_ASSERT_EQUAL(12, det.get_moving_blocks());
+
+  TEST_ASSERT_EQUAL(1, det.get_box_count());
+  const MvMotionBox &box = det.get_boxes()[0];
+  TEST_ASSERT_EQUAL(160, box.x);
+  TEST_ASSERT_EQUAL(128, box.y);
+  TEST_ASSERT_EQUAL(48, box.w);
+  TEST_ASSERT_EQUAL(64, box.h);
+  TEST_ASSERT_EQUAL(12, box.blocks);
+
+  // I frames have no MV, they neither clear nor extend the motion
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_FALSE(replay(det, still, false));
+  }
+  TEST_ASSERT_TRUE(det.is_motion());
+  TEST_ASSERT_EQUAL(1, det.get_box_count());
+
+  for (uint16_t i = 0; i + 1 < cfg.off_frames; i++) {
+    TEST_ASSERT_FALSE(replay(det, still));
+    TEST_ASSERT_TRUE(det.is_motion());
+  }
+  TEST_ASSERT_TRUE(replay(det, still));
+  TEST_ASSERT_FALSE(det.is_motion());
+  TEST_ASSERT_EQUAL(0, det.get_box_count());
+}
+
+TEST_CASE("mv motion reports each zone separately", "[mv_motion]")
+{
+  MvMotionDetector det;
+  MvMotionConfig cfg = default_config();
+  cfg.on_frames = 1;
+  TEST_ASSERT_TRUE(det.configure(cfg));
+  TEST_ASSERT_TRUE(det.add_zone(0, 0, 320, 480));    // left half
+  TEST_ASSERT_TRUE(det.add_zone(320, 0, 320, 240));  // top right
+  TEST_ASSERT_TRUE(det.add_zone(322, 242, 10, 10));  // touches MB (20, 15) only
+  TEST_ASSERT_EQUAL(3, det.get_zone_count());
+
+  std::vector<uint32_t> pkt;
+  add_object(pkt, 28, 4, 3, 3, 5, 5);
+  TEST_ASSERT_TRUE(replay(det, pkt));
+  TEST_ASSERT_EQUAL(0x2, det.get_zone_mask());
+  TEST_ASSERT_TRUE(det.is_zone_motion(1));
+
+  // Object crossing the left and right halves, below the top right zone
+  pkt.clear();
+  add_object(pkt, 18, 20, 4, 2, 0, -8);
+  TEST_ASSERT_TRUE(replay(det, pkt));
+  TEST_ASSERT_EQUAL(0x3, det.get_zone_mask());
+
+  // A zone must contain min_blocks moving MBs by itself
+  MvMotionDetector small;
+  TEST_ASSERT_TRUE(small.configure(cfg));
+  TEST_ASSERT_TRUE(small.add_zone(322, 242, 10, 10));
+  pkt.clear();
+  add_object(pkt, 19, 14, 3, 3, 6, 0);
+  TEST_ASSERT_FALSE(replay(small, pkt));
+  TEST_ASSERT_FALSE(small.is_motion());
+  TEST_ASSERT_EQUAL(1, small.get_box_count());
+}
+
+TEST_CASE("mv motion ignores changes of the whole picture", "[mv_motion]")
+{
+  MvMotionDetector det;
+  MvMotionConfig cfg = default_config();
+  cfg.on_frames = 1;
+  TEST_ASSERT_TRUE(det.configure(cfg));
+
+  std::vector<uint32_t> object;
+  add_object(object, 2, 2, 4, 4, 8, 8);
+  TEST_ASSERT_TRUE(replay(det, object));
+
+  // Exposure jump: 60% of the picture gets vectors, the motion state is kept
+  std::vector<uint32_t> global;
+  add_object(global, 0, 0, 40, 18, 4, 4);
+  for (int i = 0; i < 10; i++) {
+    TEST_ASSERT_FALSE(replay(det, global));
+    TEST_ASSERT_TRUE(det.is_global_change());
+  }
+  TEST_ASSERT_TRUE(det.is_motion());
+  TEST_ASSERT_EQUAL(0, det.get_box_count());
+
+  TEST_ASSERT_FALSE(replay(det, object));
+  TEST_ASSERT_FALSE(det.is_global_change());
+  TEST_ASSERT_EQUAL(1, det.get_box_count());
+}
+
+TEST_CASE("mv motion keeps the largest boxes first", "[mv_motion]")
+{
+  MvMotionDetector det;
+  TEST_ASSERT_TRUE(det.configure(default_config()));
+
+  // Objects of 4 to 16 MBs on a grid, far enough apart not to be connected
+  std::vector<uint32_t> pkt;
+  for (uint8_t i = 0; i < MV_MOTION_MAX_BOXES + 2; i++) {
+    add_object(pkt, (i % 5) * 8, (i / 5) * 12, 2 + i % 3, 2 + i / 3, -4, 0);
+  }
+  replay(det, pkt);
+  TEST_ASSERT_EQUAL(91, det.get_moving_blocks());
+
+  TEST_ASSERT_EQUAL(MV_MOTION_MAX_BOXES, det.get_box_count());
+  const MvMotionBox *boxes = det.get_boxes();
+  for (uint8_t i = 1; i < det.get_box_count(); i++) {
+    TEST_ASSERT_TRUE(boxes[i - 1].blocks >= boxes[i].blocks);
+  }
+  // 4x4 MBs at grid cell (3, 1)
+  TEST_ASSERT_EQUAL(16, boxes[0].blocks);
+  TEST_ASSERT_EQUAL(3 * 8 * 16, boxes[0].x);
+  TEST_ASSERT_EQUAL(12 * 16, boxes[0].y);
+  TEST_ASSERT_EQUAL(64, boxes[0].w);
+  TEST_ASSERT_EQUAL(64, boxes[0].h);
+  // The two smallest ones (4 and 6 MBs) are dropped
+  TEST_ASSERT_EQUAL(6, boxes[MV_MOTION_MAX_BOXES - 1].blocks);
+}
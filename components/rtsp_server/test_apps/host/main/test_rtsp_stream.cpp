@@ -0,0 +1,178 @@
+/*
+ * Tests of the RTSP path routing, the per path SDP and the RTP packetization
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "unity.h"
+
+#include "rtsp_stream.h"
+
+using esphome::rtsp_server::base64_encode;
+using esphome::rtsp_server::NalUnit;
+using esphome::rtsp_server::parse_nal_units;
+using esphome::rtsp_server::RTSP_MAX_RTP_PAYLOAD;
+using esphome::rtsp_server::RTSP_RTP_HEADER_SIZE;
+using esphome::rtsp_server::RtspStream;
+using esphome::rtsp_server::RtspStreamRouter;
+
+namespace {
+
+struct Packet {
+  std::vector<uint8_t> data;
+  uint16_t seq() const { return (data[2] << 8) | data[3]; }
+  uint32_t timestamp() const { return (data[4] << 24) | (data[5] << 16) | (data[6] << 8) | data[7]; }
+  uint32_t ssrc() const { return (data[8] << 24) | (data[9] << 16) | (data[10] << 8) | data[11]; }
+  bool marker() const { return (data[1] & 0x80) != 0; }
+  const uint8_t *payload() const { return data.data() + RTSP_RTP_HEADER_SIZE; }
+  size_t payload_len() const { return data.size() - RTSP_RTP_HEADER_SIZE; }
+};
+
+void append_nal(std::vector<uint8_t> &frame, uint8_t header, size_t len, bool long_start_code = true) {
+  if (long_start_code)
+    frame.push_back(0);
+  frame.insert(frame.end(), {0, 0, 1, header});
+  for (size_t i = 1; i < len; i++)
+    frame.push_back((uint8_t) (i * 7 + 3) | 0x10);  // never a start code
+}
+
+}  // namespace
+
+TEST_CASE("rtsp router matches paths on segment boundaries", "[rtsp_stream]")
+{
+  RtspStreamRouter router;
+  TEST_ASSERT_EQUAL(0, router.add_stream("/stream", 1));
+  TEST_ASSERT_EQUAL(1, router.add_stream("/stream/sub", 2));
+  TEST_ASSERT_EQUAL(2, router.add_stream("/sub", 3));
+  TEST_ASSERT_EQUAL(-1, router.add_stream("/sub", 4));
+  TEST_ASSERT_EQUAL(-1, router.add_stream("sub", 4));
+  TEST_ASSERT_EQUAL(3, router.size());
+
+  TEST_ASSERT_EQUAL(0, router.find("rtsp://192.168.1.150:554/stream"));
+  TEST_ASSERT_EQUAL(0, router.find("rtsp://admin:pw@cam.local/stream/"));
+  TEST_ASSERT_EQUAL(0, router.find("rtsp://192.168.1.150/stream/track1"));
+  TEST_ASSERT_EQUAL(1, router.find("rtsp://192.168.1.150/stream/sub/track1"));
+  TEST_ASSERT_EQUAL(2, router.find("rtsp://192.168.1.150/sub?channel=1"));
+  TEST_ASSERT_EQUAL(2, router.find("/sub"));
+  TEST_ASSERT_EQUAL(-1, router.find("rtsp://192.168.1.150/streams"));
+  TEST_ASSERT_EQUAL(-1, router.find("rtsp://192.168.1.150/subway"));
+  TEST_ASSERT_EQUAL(-1, router.find("rtsp://192.168.1.150"));
+  TEST_ASSERT_EQUAL(-1, router.find("*"));
+
+  // A root path serves everything the other paths do not
+  TEST_ASSERT_EQUAL(3, router.add_stream("/", 5));
+  TEST_ASSERT_EQUAL(3, router.find("rtsp://192.168.1.150"));
+  TEST_ASSERT_EQUAL(3, router.find("rtsp://192.168.1.150/live"));
+  TEST_ASSERT_EQUAL(2, router.find("rtsp://192.168.1.150/sub/track1"));
+}
+
+TEST_CASE("rtsp router extracts the request URI", "[rtsp_stream]")
+{
+  TEST_ASSERT_EQUAL_STRING("rtsp://10.0.0.2:554/sub",
+                           RtspStreamRouter::request_uri("DESCRIBE rtsp://10.0.0.2:554/sub RTSP/1.0\r\nCSeq: 2\r\n")
+                               .c_str());
+  TEST_ASSERT_EQUAL_STRING("rtsp://h/stream/track1",
+                           RtspStreamRouter::request_uri("SETUP rtsp://h/stream/track1 RTSP/1.0\r\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("*", RtspStreamRouter::request_uri("OPTIONS *\r\n").c_str());
+  TEST_ASSERT_EQUAL_STRING("", RtspStreamRouter::request_uri("garbage").c_str());
+}
+
+TEST_CASE("rtsp nal parser splits annex b streams", "[rtsp_stream]")
+{
+  std::vector<uint8_t> frame;
+  append_nal(frame, 0x67, 10);
+  append_nal(frame, 0x68, 4, false);
+  append_nal(frame, 0x65, 300);
+  std::vector<NalUnit> nals;
+  parse_nal_units(frame.data(), frame.size(), nals);
+  TEST_ASSERT_EQUAL(3, nals.size());
+  TEST_ASSERT_EQUAL_HEX8(0x67, nals[0].first[0]);
+  TEST_ASSERT_EQUAL(10, nals[0].second);
+  TEST_ASSERT_EQUAL(4, nals[1].second);
+  // The last NAL runs to the end of the buffer
+  TEST_ASSERT_EQUAL(300, nals[2].second);
+  TEST_ASSERT_EQUAL_PTR(frame.data() + frame.size() - 300, nals[2].first);
+
+  parse_nal_units(frame.data(), 3, nals);
+  TEST_ASSERT_EQUAL(0, nals.size());
+}
+
+TEST_CASE("rtsp stream sdp carries its own parameter sets and size", "[rtsp_stream]")
+{
+  TEST_ASSERT_EQUAL_STRING("", base64_encode(nullptr, 0).c_str());
+  const uint8_t abc[] = {'a', 'b', 'c', 'd'};
+  TEST_ASSERT_EQUAL_STRING("YQ==", base64_encode(abc, 1).c_str());
+  TEST_ASSERT_EQUAL_STRING("YWI=", base64_encode(abc, 2).c_str());
+  TEST_ASSERT_EQUAL_STRING("YWJj", base64_encode(abc, 3).c_str());
+  TEST_ASSERT_EQUAL_STRING("YWJjZA==", base64_encode(abc, 4).c_str());
+
+  RtspStream main_stream("/stream", 1);
+  RtspStream sub_stream("/sub", 2);
+  main_stream.set_video(1280, 720, 30);
+  sub_stream.set_video(640, 360, 30);
+
+  std::string sdp = sub_stream.generate_sdp();
+  TEST_ASSERT_TRUE(sdp.find("sprop-parameter-sets") == std::string::npos);
+  TEST_ASSERT_TRUE(sdp.find("a=framesize:96 640-360\r\n") != std::string::npos);
+
+  const uint8_t idr[] = {0, 0, 0, 1, 0x67, 0x42, 0x00, 0x1f, 0, 0, 0, 1, 0x68, 0xce, 0x38, 0x80,
+                         0, 0, 0, 1, 0x65, 0x88, 0x84, 0x21};
+  sub_stream.cache_parameter_sets(idr, sizeof(idr));
+  TEST_ASSERT_TRUE(sub_stream.has_parameter_sets());
+  TEST_ASSERT_FALSE(main_stream.has_parameter_sets());
+  sdp = sub_stream.generate_sdp();
+  TEST_ASSERT_TRUE(sdp.find(";sprop-parameter-sets=Z0IAHw==,aM44gA==\r\n") != std::string::npos);
+  TEST_ASSERT_TRUE(main_stream.generate_sdp().find("a=framesize:96 1280-720\r\n") != std::string::npos);
+
+  sub_stream.clear_parameter_sets();
+  TEST_ASSERT_FALSE(sub_stream.has_parameter_sets());
+}
+
+TEST_CASE("rtsp stream packetizes single nal units and fu-a", "[rtsp_stream]")
+{
+  RtspStream stream("/stream", 0xdeadbeef);
+  stream.set_video(640, 480, 25);
+  std::vector<uint8_t> frame;
+  append_nal(frame, 0x06, 20);
+  append_nal(frame, 0x65, 3000);
+
+  std::vector<Packet> packets;
+  uint8_t buffer[RTSP_RTP_HEADER_SIZE + RTSP_MAX_RTP_PAYLOAD];
+  auto send = [&packets](const uint8_t *data, size_t len) { packets.push_back({{data, data + len}}); };
+  TEST_ASSERT_EQUAL(4, stream.send_frame(frame.data(), frame.size(), buffer, send));
+  TEST_ASSERT_EQUAL(4, packets.size());
+
+  for (size_t i = 0; i < packets.size(); i++) {
+    TEST_ASSERT_EQUAL_HEX8(0x80, packets[i].data[0]);
+    TEST_ASSERT_EQUAL(96, packets[i].data[1] & 0x7f);
+    TEST_ASSERT_EQUAL(i, packets[i].seq());
+    TEST_ASSERT_EQUAL(0, packets[i].timestamp());
+    TEST_ASSERT_EQUAL_HEX32(0xdeadbeef, packets[i].ssrc());
+    TEST_ASSERT_TRUE(packets[i].payload_len() <= RTSP_MAX_RTP_PAYLOAD);
+    TEST_ASSERT_EQUAL(i == 3, packets[i].marker());
+  }
+  // SEI as a single NAL unit
+  TEST_ASSERT_EQUAL(20, packets[0].payload_len());
+  TEST_ASSERT_EQUAL_HEX8(0x06, packets[0].payload()[0]);
+  // IDR slice as FU-A: start, middle, end, the NAL header is rebuilt from the FU bytes
+  TEST_ASSERT_EQUAL_HEX8(0x7c, packets[1].payload()[0]);
+  TEST_ASSERT_EQUAL_HEX8(0x85, packets[1].payload()[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x05, packets[2].payload()[1]);
+  TEST_ASSERT_EQUAL_HEX8(0x45, packets[3].payload()[1]);
+  std::vector<uint8_t> rebuilt = {(uint8_t) ((packets[1].payload()[0] & 0xe0) | (packets[1].payload()[1] & 0x1f))};
+  for (size_t i = 1; i < 4; i++)
+    rebuilt.insert(rebuilt.end(), packets[i].payload() + 2, packets[i].payload() + packets[i].payload_len());
+  TEST_ASSERT_EQUAL(3000, rebuilt.size());
+  TEST_ASSERT_EQUAL_MEMORY(frame.data() + frame.size() - 3000, rebuilt.data(), 3000);
+
+  // Next frame: 90 kHz clock at 25 fps, the sequence goes on
+  packets.clear();
+  frame.clear();
+  append_nal(frame, 0x41, 100);
+  TEST_ASSERT_EQUAL(1, stream.send_frame(frame.data(), frame.size(), buffer, send));
+  TEST_ASSERT_EQUAL(4, packets[0].seq());
+  TEST_ASSERT_EQUAL(3600, packets[0].timestamp());
+  TEST_ASSERT_TRUE(packets[0].marker());
+  TEST_ASSERT_EQUAL(5, stream.get_seq());
+}
@@ -0,0 +1,162 @@
+/*
+ * Main + sub stream routing fed by the software encoder
+ *
+ * The target encodes both pictures in one dual hardware call; here two software encoders at
+ * the two resolutions stand in for it, the routing and the packetization are the same.
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+#include "unity.h"
+
+#include "esp_h264_enc_single.h"
+#include "esp_h264_enc_single_sw.h"
+#include "rtsp_stream.h"
+
+using esphome::rtsp_server::RTSP_MAX_RTP_PAYLOAD;
+using esphome::rtsp_server::RTSP_RTP_HEADER_SIZE;
+using esphome::rtsp_server::RtspStreamRouter;
+
+namespace {
+
+const uint8_t GOP = 10;
+const uint32_t JOIN_FRAME = GOP + 4;
+
+struct SwStream {
+  uint16_t width;
+  uint16_t height;
+  esp_h264_enc_handle_t enc;
+  std::vector<uint8_t> in;
+  std::vector<uint8_t> out;
+};
+
+// A client session as the server keeps it, with the packets it received
+struct Client {
+  int8_t stream;
+  bool playing;
+  std::vector<std::vector<uint8_t>> packets;
+};
+
+void sw_open(SwStream &s, uint16_t width, uint16_t height, uint32_t bitrate) {
+  s.width = width;
+  s.height = height;
+  s.in.assign(width * height * 3 / 2, 128);
+  s.out.resize(width * height * 2);
+  esp_h264_enc_cfg_sw_t cfg = {};
+  cfg.pic_type = ESP_H264_RAW_FMT_I420;
+  cfg.gop = GOP;
+  cfg.fps = 30;
+  cfg.res = {.width = width, .height = height};
+  cfg.rc = {.bitrate = bitrate, .qp_min = 20, .qp_max = 40};
+  s.enc = nullptr;
+  TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_sw_new(&cfg, &s.enc));
+  TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_open(s.enc));
+}
+
+void sw_close(SwStream &s) {
+  TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_close(s.enc));
+  TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_del(s.enc));
+}
+
+esp_h264_enc_out_frame_t sw_encode(SwStream &s, uint32_t index) {
+  for (uint16_t y = 0; y < s.height; y++) {
+    for (uint16_t x = 0; x < s.width; x++)
+      s.in[y * s.width + x] = (uint8_t) (x * 2 + y + index);
+  }
+  esp_h264_enc_in_frame_t in_frame = {};
+  in_frame.raw_data.buffer = s.in.data();
+  in_frame.raw_data.len = s.in.size();
+  in_frame.pts = index * 3000;
+  esp_h264_enc_out_frame_t out_frame = {};
+  out_frame.raw_data.buffer = s.out.data();
+  out_frame.raw_data.len = s.out.size();
+  TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_process(s.enc, &in_frame, &out_frame));
+  TEST_ASSERT_GREATER_THAN(0, out_frame.length);
+  return out_frame;
+}
+
+uint16_t rtp_seq(const std::vector<uint8_t> &p) { return (p[2] << 8) | p[3]; }
+uint32_t rtp_timestamp(const std::vector<uint8_t> &p) { return (p[4] << 24) | (p[5] << 16) | (p[6] << 8) | p[7]; }
+uint32_t rtp_ssrc(const std::vector<uint8_t> &p) { return (p[8] << 24) | (p[9] << 16) | (p[10] << 8) | p[11]; }
+
+}  // namespace
+
+TEST_CASE("rtsp main and sub streams reach only their own sessions", "[rtsp_stream][sw]")
+{
+  RtspStreamRouter router;
+  TEST_ASSERT_EQUAL(0, router.add_stream("/stream", 0x1111));
+  TEST_ASSERT_EQUAL(1, router.add_stream("/sub", 0x2222));
+  router.get(0).set_video(128, 96, 30);
+  router.get(1).set_video(64, 48, 30);
+
+  SwStream streams[2];
+  sw_open(streams[0], 128, 96, 400000);
+  sw_open(streams[1], 64, 48, 100000);
+
+  // SETUP URLs carry the track control
+  std::vector<Client> clients = {
+      {(int8_t) router.find("rtsp://10.0.0.2:554/stream/track1"), true, {}},
+      {(int8_t) router.find("rtsp://10.0.0.2:554/sub/track1"), true, {}},
+      {(int8_t) router.find("rtsp://10.0.0.2:554/sub/track1"), false, {}},  // not playing yet
+  };
+  TEST_ASSERT_EQUAL(0, clients[0].stream);
+  TEST_ASSERT_EQUAL(1, clients[1].stream);
+
+  uint8_t buffer[RTSP_RTP_HEADER_SIZE + RTSP_MAX_RTP_PAYLOAD];
+  const uint32_t frames = 2 * GOP + 3;
+  for (uint32_t i = 0; i < frames; i++) {
+    // The third client starts playing mid GOP: both encoders restart on an IDR
+    if (i == JOIN_FRAME) {
+      clients[2].playing = true;
+      TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_force_idr(streams[0].enc));
+      TEST_ASSERT_EQUAL(ESP_H264_ERR_OK, esp_h264_enc_force_idr(streams[1].enc));
+    }
+    for (uint8_t s = 0; s < 2; s++) {
+      esp_h264_enc_out_frame_t out_frame = sw_encode(streams[s], i);
+      bool idr = out_frame.frame_type == ESP_H264_FRAME_TYPE_IDR;
+      TEST_ASSERT_EQUAL(i < JOIN_FRAME ? i % GOP == 0 : (i - JOIN_FRAME) % GOP == 0, idr);
+      if (idr)
+        router.get(s).cache_parameter_sets(out_frame.raw_data.buffer, out_frame.length);
+      router.get(s).send_frame(out_frame.raw_data.buffer, out_frame.length, buffer,
+                               [&clients, s](const uint8_t *packet, size_t len) {
+                                 for (auto &client : clients) {
+                                   if (client.playing && client.stream == s)
+                                     client.packets.emplace_back(packet, packet + len);
+                                 }
+                               });
+    }
+  }
+
+  // Each path has its own SDP
+  for (uint8_t s = 0; s < 2; s++)
+    TEST_ASSERT_TRUE(router.get(s).has_parameter_sets());
+  TEST_ASSERT_TRUE(router.get(0).generate_sdp().find("a=framesize:96 128-96") != std::string::npos);
+  TEST_ASSERT_TRUE(router.get(1).generate_sdp().find("a=framesize:96 64-48") != std::string::npos);
+
+  const uint32_t ssrc[2] = {0x1111, 0x2222};
+  for (const auto &client : clients) {
+    TEST_ASSERT_FALSE(client.packets.empty());
+    uint32_t markers = 0;
+    for (size_t i = 0; i < client.packets.size(); i++) {
+      const auto &p = client.packets[i];
+      TEST_ASSERT_EQUAL_HEX32(ssrc[client.stream], rtp_ssrc(p));
+      if (i > 0) {
+        // Contiguous sequence and one timestamp per frame on each path
+        TEST_ASSERT_EQUAL((uint16_t) (rtp_seq(client.packets[i - 1]) + 1), rtp_seq(p));
+        uint32_t step = rtp_timestamp(p) - rtp_timestamp(client.packets[i - 1]);
+        TEST_ASSERT_TRUE(step == 0 || step == 3000);
+      }
+      markers += (p[1] & 0x80) != 0;
+    }
+    TEST_ASSERT_TRUE((client.packets.back()[1] & 0x80) != 0);
+    TEST_ASSERT_EQUAL(&client == &clients[2] ? frames - JOIN_FRAME : frames, markers);
+  }
+  // The late client starts on the forced IDR: its first NAL is a parameter set or the IDR slice
+  uint8_t first_nal = clients[2].packets[0][RTSP_RTP_HEADER_SIZE] & 0x1f;
+  TEST_ASSERT_TRUE(first_nal == 7 || first_nal == 8 || first_nal == 5 || first_nal == 6 ||
+                   (first_nal == 28 && (clients[2].packets[0][RTSP_RTP_HEADER_SIZE + 1] & 0x1f) == 5));
+
+  sw_close(streams[0]);
+  sw_close(streams[1]);
+}
@@ -1,3 +1,5 @@
+import os
+
 import esphome.codegen as cg
 import esphome.config_validation as cv
 from esphome.components import mipi_dsi_cam
@@ -9,6 +11,8 @@ CODEOWNERS = ["@youkorr"]
 
 webrtc_camera_ns = cg.esphome_ns.namespace("webrtc_camera")
 WebRTCCamera = webrtc_camera_ns.class_("WebRTCCamera", cg.Component)
+EncoderMode = webrtc_camera_ns.enum("EncoderMode")
+SwComplexity = cg.global_ns.enum("esp_h264_sw_complexity_t")
 
 CONF_CAMERA_ID = "camera_id"
 CONF_SIGNALING_PORT = "signaling_port"
@@ -17,6 +21,35 @@ CONF_BITRATE = "bitrate"
 CONF_GOP = "gop"
 CONF_QP_MIN = "qp_min"
 CONF_QP_MAX = "qp_max"
+CONF_ENCODER = "encoder"
+CONF_SW_THREADS = "sw_threads"
+CONF_SW_COMPLEXITY = "sw_complexity"
+CONF_DL_PROFILER = "dl_profiler"
+
+# Headers of the esp-dl model profiler, the application builds esp-dl with its model
+DL_INCLUDES = [
+    "dl",
+    "dl/base",
+    "dl/base/isa",
+    "dl/math/include",
+    "dl/model/include",
+    "dl/module/include",
+    "dl/tensor/include",
+    "dl/tool/include",
+    "fbs_loader/include",
+]
+
+ENCODER_MODES = {
+    "auto": EncoderMode.ENCODER_AUTO,
+    "hardware": EncoderMode.ENCODER_HARDWARE,
+    "software": EncoderMode.ENCODER_SOFTWARE,
+}
+
+SW_COMPLEXITIES = {
+    "low": SwComplexity.ESP_H264_SW_COMPLEXITY_LOW,
+    "medium": SwComplexity.ESP_H264_SW_COMPLEXITY_MEDIUM,
+    "high": SwComplexity.ESP_H264_SW_COMPLEXITY_HIGH,
+}
 
 CONFIG_SCHEMA = cv.Schema({
     cv.GenerateID(): cv.declare_id(WebRTCCamera),
@@ -27,6 +60,12 @@ CONFIG_SCHEMA = cv.Schema({
     cv.Optional(CONF_GOP, default=30): cv.int_range(min=1, max=120),
     cv.Optional(CONF_QP_MIN, default=10): cv.int_range(min=0, max=51),
     cv.Optional(CONF_QP_MAX, default=40): cv.int_range(min=0, max=51),
+    # The hardware encoder serves one component at a time, "auto" falls back to openh264 while it is busy
+    cv.Optional(CONF_ENCODER, default="auto"): cv.enum(ENCODER_MODES, lower=True),
+    cv.Optional(CONF_SW_THREADS, default=1): cv.int_range(min=1, max=4),
+    cv.Optional(CONF_SW_COMPLEXITY, default="low"): cv.enum(SW_COMPLEXITIES, lower=True),
+    # Serve /dl/profile and /dl/trace of the esp-dl model profiler given to set_dl_profiler()
+    cv.Optional(CONF_DL_PROFILER, default=False): cv.boolean,
 }).extend(cv.COMPONENT_SCHEMA)
 
 async def to_code(config):
@@ -43,3 +82,12 @@ async def to_code(config):
     cg.add(var.set_gop(config[CONF_GOP]))
     cg.add(var.set_qp_min(config[CONF_QP_MIN]))
     cg.add(var.set_qp_max(config[CONF_QP_MAX]))
+    cg.add(var.set_encoder_mode(config[CONF_ENCODER]))
+    cg.add(var.set_sw_threads(config[CONF_SW_THREADS]))
+    cg.add(var.set_sw_complexity(config[CONF_SW_COMPLEXITY]))
+
+    if config[CONF_DL_PROFILER]:
+        cg.add_define("USE_WEBRTC_CAMERA_DL_PROFILER")
+        dl_dir = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "esp-dl")
+        for inc in DL_INCLUDES:
+            cg.add_build_flag(f"-I{os.path.normpath(os.path.join(dl_dir, inc))}")
@@ -3,6 +3,7 @@
 #ifdef USE_ESP_IDF
 #include "esphome/core/log.h"
 #include "esphome/core/application.h"
+#include <algorithm>
 #include <cstring>
 #include <esp_random.h>
 
@@ -11,6 +12,20 @@ namespace webrtc_camera {
 
 static const char *const TAG = "webrtc_camera";
 
+// Largest RTP payload, keeps the packets below the Ethernet MTU
+static const size_t MAX_RTP_PAYLOAD = 1400;
+
+static const char *encoder_mode_to_string(EncoderMode mode) {
+  switch (mode) {
+    case ENCODER_HARDWARE:
+      return "hardware";
+    case ENCODER_SOFTWARE:
+      return "software";
+    default:
+      return "auto";
+  }
+}
+
 // HTML page for WebRTC client
 static const char WEBRTC_HTML[] = R"html(
 <!DOCTYPE html>
@@ -168,6 +183,13 @@ void WebRTCCamera::setup() {
   // Generate random SSRC
   rtp_ssrc_ = esp_random();
 
+  if (camera_) {
+    camera_->add_on_resolution_callback([this](uint16_t width, uint16_t height) {
+      ESP_LOGI(TAG, "Camera switched to %ux%u", width, height);
+      camera_resized_ = true;
+    });
+  }
+
   // Initialize H.264 encoder
   if (init_h264_encoder_() != ESP_OK) {
     ESP_LOGE(TAG, "Failed to initialize H.264 encoder");
@@ -199,6 +221,25 @@ void WebRTCCamera::loop() {
     return;
   }
 
+  // The encoder buffers are sized for one picture, a new one starts on an IDR frame
+  if (camera_resized_.exchange(false)) {
+    cleanup_h264_encoder_();
+    if (init_h264_encoder_() != ESP_OK) {
+      ESP_LOGE(TAG, "Failed to restart the H.264 encoder at the new camera resolution");
+      return;
+    }
+  }
+
+  // A new peer starts on an IDR frame, and takes the hardware encoder back if it is free again
+  if (idr_requested_.exchange(false)) {
+    if (!hw_encoder_ && encoder_mode_ == ENCODER_AUTO) {
+      switch_to_hw_encoder_();
+    }
+    if (h264_encoder_) {
+      esp_h264_enc_force_idr(h264_encoder_);
+    }
+  }
+
   // Encode and send frames
   if (encode_and_send_frame_() != ESP_OK) {
     ESP_LOGW(TAG, "Failed to encode/send frame");
@@ -215,10 +256,19 @@ void WebRTCCamera::dump_config() {
   ESP_LOGCONFIG(TAG, "  Bitrate: %d bps", bitrate_);
   ESP_LOGCONFIG(TAG, "  GOP: %d", gop_);
   ESP_LOGCONFIG(TAG, "  QP Range: %d-%d", qp_min_, qp_max_);
+  ESP_LOGCONFIG(TAG, "  Encoder: %s (%s in use)", encoder_mode_to_string(encoder_mode_),
+                hw_encoder_ ? "hardware" : "software");
+  if (encoder_mode_ != ENCODER_HARDWARE) {
+    static const char *const complexity[] = {"low", "medium", "high"};
+    ESP_LOGCONFIG(TAG, "  Software encoder: %d thread(s), %s complexity", sw_threads_, complexity[sw_complexity_]);
+  }
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+  ESP_LOGCONFIG(TAG, "  Model profiler: %s", dl_profiler_ ? "/dl/profile and /dl/trace" : "not set");
+#endif
 }
 
 esp_err_t WebRTCCamera::init_h264_encoder_() {
-  ESP_LOGI(TAG, "Initializing H.264 hardware encoder...");
+  ESP_LOGI(TAG, "Initializing H.264 encoder (%s)...", encoder_mode_to_string(encoder_mode_));
 
   if (!camera_) {
     ESP_LOGE(TAG, "Camera not set");
@@ -229,14 +279,15 @@ esp_err_t WebRTCCamera::init_h264_encoder_() {
   uint16_t height = camera_->get_image_height();
 
   // Align dimensions to 16
-  width = ((width + 15) >> 4) << 4;
-  height = ((height + 15) >> 4) << 4;
+  enc_width_ = ((width + 15) >> 4) << 4;
+  enc_height_ = ((height + 15) >> 4) << 4;
 
-  ESP_LOGI(TAG, "Resolution: %dx%d (aligned)", width, height);
+  ESP_LOGI(TAG, "Resolution: %dx%d (aligned)", enc_width_, enc_height_);
 
-  // Allocate YUV420 buffer
-  yuv_buffer_size_ = width * height * 3 / 2;  // YUV420 format
-  yuv_buffer_ = (uint8_t *)heap_caps_malloc(yuv_buffer_size_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  // YUV420 buffer, I420 for the software encoder and O_UYY_E_VYY for the hardware one have the same size.
+  // The hardware encoder reads it by DMA, hence the alignment
+  yuv_buffer_size_ = enc_width_ * enc_height_ * 3 / 2;
+  yuv_buffer_ = (uint8_t *)heap_caps_aligned_alloc(64, yuv_buffer_size_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
   if (!yuv_buffer_) {
     ESP_LOGE(TAG, "Failed to allocate YUV buffer");
     return ESP_ERR_NO_MEM;
@@ -244,38 +295,76 @@ esp_err_t WebRTCCamera::init_h264_encoder_() {
 
   // Allocate H.264 output buffer (estimate 2x input size for worst case)
   h264_buffer_size_ = yuv_buffer_size_ * 2;
-  h264_buffer_ = (uint8_t *)heap_caps_malloc(h264_buffer_size_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  h264_buffer_ = (uint8_t *)heap_caps_aligned_alloc(64, h264_buffer_size_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
   if (!h264_buffer_) {
     ESP_LOGE(TAG, "Failed to allocate H.264 buffer");
-    free(yuv_buffer_);
+    cleanup_h264_encoder_();
     return ESP_ERR_NO_MEM;
   }
 
-  // Configure H.264 encoder (software encoder using OpenH264)
-  esp_h264_enc_cfg_sw_t cfg = {
-      .pic_type = ESP_H264_RAW_FMT_I420,  // YUV420 planar (I420) for software encoder
-      .gop = gop_,
-      .fps = 30,
-      .res = {.width = width, .height = height},
-      .rc = {.bitrate = bitrate_, .qp_min = qp_min_, .qp_max = qp_max_}};
-
-  esp_h264_err_t ret = esp_h264_enc_sw_new(&cfg, &h264_encoder_);
-  if (ret != ESP_H264_ERR_OK || !h264_encoder_) {
+  // The hardware encoder serves one component at a time: when the RTSP server already holds it,
+  // the software encoder takes over in auto mode
+  esp_h264_err_t ret = ESP_H264_ERR_FAIL;
+  if (encoder_mode_ != ENCODER_SOFTWARE) {
+    ret = open_encoder_(true, &h264_encoder_);
+    hw_encoder_ = ret == ESP_H264_ERR_OK;
+    if (ret != ESP_H264_ERR_OK) {
+      ESP_LOGW(TAG, "Hardware H.264 encoder unavailable (%s)%s",
+               ret == ESP_H264_ERR_BUSY ? "used by another component" : "error",
+               encoder_mode_ == ENCODER_AUTO ? ", falling back to software" : "");
+    }
+  }
+  if (ret != ESP_H264_ERR_OK && encoder_mode_ != ENCODER_HARDWARE) {
+    ret = open_encoder_(false, &h264_encoder_);
+  }
+  if (ret != ESP_H264_ERR_OK) {
     ESP_LOGE(TAG, "Failed to create H.264 encoder: %d", ret);
     cleanup_h264_encoder_();
     return ESP_FAIL;
   }
 
-  // Open encoder
-  ret = esp_h264_enc_open(h264_encoder_);
+  ESP_LOGI(TAG, "H.264 %s encoder initialized successfully", hw_encoder_ ? "hardware" : "software");
+  return ESP_OK;
+}
+
+esp_h264_err_t WebRTCCamera::open_encoder_(bool hardware, esp_h264_enc_handle_t *encoder) {
+  esp_h264_enc_cfg_t cfg = {
+      .pic_type = hardware ? ESP_H264_RAW_FMT_O_UYY_E_VYY : ESP_H264_RAW_FMT_I420,
+      .gop = gop_,
+      .fps = 30,
+      .res = {.width = enc_width_, .height = enc_height_},
+      .rc = {.bitrate = bitrate_, .qp_min = qp_min_, .qp_max = qp_max_}};
+
+  esp_h264_enc_handle_t enc = nullptr;
+  esp_h264_err_t ret = hardware ? esp_h264_enc_hw_new(&cfg, &enc) : esp_h264_enc_sw_new(&cfg, &enc);
+  if (ret == ESP_H264_ERR_OK && !hardware) {
+    esp_h264_enc_sw_tuning_t tuning = {.threads = sw_threads_, .complexity = sw_complexity_};
+    ret = esp_h264_enc_sw_set_tuning(enc, &tuning);
+  }
+  if (ret == ESP_H264_ERR_OK) {
+    ret = esp_h264_enc_open(enc);
+  }
   if (ret != ESP_H264_ERR_OK) {
-    ESP_LOGE(TAG, "Failed to open H.264 encoder: %d", ret);
-    cleanup_h264_encoder_();
-    return ESP_FAIL;
+    if (enc) {
+      esp_h264_enc_del(enc);
+    }
+    return ret;
   }
+  *encoder = enc;
+  return ESP_H264_ERR_OK;
+}
 
-  ESP_LOGI(TAG, "H.264 encoder initialized successfully");
-  return ESP_OK;
+void WebRTCCamera::switch_to_hw_encoder_() {
+  esp_h264_enc_handle_t encoder = nullptr;
+  if (open_encoder_(true, &encoder) != ESP_H264_ERR_OK) {
+    ESP_LOGD(TAG, "Hardware H.264 encoder still busy, staying on software");
+    return;
+  }
+  esp_h264_enc_close(h264_encoder_);
+  esp_h264_enc_del(h264_encoder_);
+  h264_encoder_ = encoder;
+  hw_encoder_ = true;
+  ESP_LOGI(TAG, "Switched to the hardware H.264 encoder");
 }
 
 void WebRTCCamera::cleanup_h264_encoder_() {
@@ -283,6 +372,7 @@ void WebRTCCamera::cleanup_h264_encoder_() {
     esp_h264_enc_close(h264_encoder_);
     esp_h264_enc_del(h264_encoder_);
     h264_encoder_ = nullptr;
+    hw_encoder_ = false;
   }
   if (yuv_buffer_) {
     free(yuv_buffer_);
@@ -363,6 +453,48 @@ esp_err_t WebRTCCamera::convert_rgb565_to_yuv420_(const uint8_t *rgb565, uint8_t
   return ESP_OK;
 }
 
+esp_err_t WebRTCCamera::convert_rgb565_to_o_uyy_e_vyy_(const uint8_t *rgb565, uint8_t *yuv,
+                                                         uint16_t width, uint16_t height) {
+  // Hardware encoder layout, each pair of lines is packed:
+  // odd line  U Y Y U Y Y ...
+  // even line V Y Y V Y Y ...
+  const uint16_t *rgb = (const uint16_t *)rgb565;
+
+  for (uint16_t row = 0; row < height; row += 2) {
+    const uint16_t *row0 = rgb + row * width;
+    const uint16_t *row1 = row0 + width;
+    uint8_t *odd_ptr = yuv + row * width * 3 / 2;
+    uint8_t *even_ptr = yuv + (row + 1) * width * 3 / 2;
+
+    for (uint16_t col = 0; col < width; col += 2, odd_ptr += 3, even_ptr += 3) {
+      const uint16_t pixels[4] = {row0[col], row0[col + 1], row1[col], row1[col + 1]};
+      int r_sum = 0, g_sum = 0, b_sum = 0;
+      uint8_t y[4];
+
+      for (int i = 0; i < 4; i++) {
+        uint8_t r = ((pixels[i] >> 11) & 0x1F) << 3;
+        uint8_t g = ((pixels[i] >> 5) & 0x3F) << 2;
+        uint8_t b = (pixels[i] & 0x1F) << 3;
+        y[i] = ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+        r_sum += r;
+        g_sum += g;
+        b_sum += b;
+      }
+
+      // Chroma of the 2x2 block average
+      int r = r_sum >> 2, g = g_sum >> 2, b = b_sum >> 2;
+      odd_ptr[0] = ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+      odd_ptr[1] = y[0];
+      odd_ptr[2] = y[1];
+      even_ptr[0] = ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+      even_ptr[1] = y[2];
+      even_ptr[2] = y[3];
+    }
+  }
+
+  return ESP_OK;
+}
+
 esp_err_t WebRTCCamera::encode_and_send_frame_() {
   if (!camera_ || !h264_encoder_) {
     return ESP_FAIL;
@@ -377,8 +509,17 @@ esp_err_t WebRTCCamera::encode_and_send_frame_() {
     return ESP_FAIL;
   }
 
-  // Convert RGB565 to YUV420
-  if (convert_rgb565_to_yuv420_(frame_data, yuv_buffer_, width, height) != ESP_OK) {
+  // Captured after a resolution switch which loop() has not handled yet
+  if (((width + 15) >> 4) << 4 != enc_width_ || ((height + 15) >> 4) << 4 != enc_height_) {
+    camera_->release_buffer(buffer);
+    camera_resized_ = true;
+    return ESP_OK;
+  }
+
+  // Convert RGB565 to the YUV420 layout of the encoder in use
+  esp_err_t converted = hw_encoder_ ? convert_rgb565_to_o_uyy_e_vyy_(frame_data, yuv_buffer_, width, height)
+                                    : convert_rgb565_to_yuv420_(frame_data, yuv_buffer_, width, height);
+  if (converted != ESP_OK) {
     ESP_LOGE(TAG, "Failed to convert RGB565 to YUV420");
     camera_->release_buffer(buffer);  // Release buffer before returning
     return ESP_FAIL;
@@ -473,27 +614,19 @@ esp_err_t WebRTCCamera::send_h264_over_rtp_(const uint8_t *data, size_t len,
   // Parse NAL units
   auto nal_units = parse_nal_units_(data, len);
 
-  for (const auto &nal : nal_units) {
-    const uint8_t *nal_data = nal.first;
-    size_t nal_size = nal.second;
-
-    if (nal_size == 0) continue;
-
-    // Get NAL unit type
-    uint8_t nal_type = nal_data[0] & 0x1F;
-
-    ESP_LOGD(TAG, "Sending NAL unit type %d, size %d", nal_type, nal_size);
+  for (size_t i = 0; i < nal_units.size(); i++) {
+    const uint8_t *nal_data = nal_units[i].first;
+    size_t nal_size = nal_units[i].second;
+    // The marker bit closes the access unit
+    bool marker = i + 1 == nal_units.size();
 
-    // For simplicity, send each NAL unit in a single RTP packet
-    // In production, implement FU-A fragmentation for large NAL units
-    const size_t MAX_RTP_PAYLOAD = 1400;
+    ESP_LOGD(TAG, "Sending NAL unit type %d, size %zu", nal_data[0] & 0x1F, nal_size);
 
     if (nal_size <= MAX_RTP_PAYLOAD) {
       // Single NAL unit mode
-      send_rtp_packet_(nal_data, nal_size, true);
+      send_rtp_packet_(nal_data, nal_size, marker);
     } else {
-      // TODO: Implement FU-A fragmentation for large NAL units
-      ESP_LOGW(TAG, "NAL unit too large (%d bytes), fragmentation not implemented", nal_size);
+      send_fu_a_(nal_data, nal_size, marker);
     }
   }
 
@@ -502,6 +635,31 @@ esp_err_t WebRTCCamera::send_h264_over_rtp_(const uint8_t *data, size_t len,
   return ESP_OK;
 }
 
+esp_err_t WebRTCCamera::send_fu_a_(const uint8_t *nal_data, size_t nal_size, bool marker) {
+  // RFC 6184 fragmentation unit: the NAL header is split into the FU indicator and the FU header
+  uint8_t fragment[MAX_RTP_PAYLOAD];
+  const uint8_t nal_header = nal_data[0];
+  fragment[0] = (nal_header & 0xE0) | 28;
+
+  const uint8_t *payload = nal_data + 1;
+  size_t remaining = nal_size - 1;
+  bool start = true;
+  while (remaining > 0) {
+    size_t len = std::min(remaining, MAX_RTP_PAYLOAD - 2);
+    bool end = len == remaining;
+    fragment[1] = (start ? 0x80 : 0x00) | (end ? 0x40 : 0x00) | (nal_header & 0x1F);
+    memcpy(fragment + 2, payload, len);
+    if (send_rtp_packet_(fragment, len + 2, end && marker) != ESP_OK) {
+      return ESP_FAIL;
+    }
+    payload += len;
+    remaining -= len;
+    start = false;
+  }
+
+  return ESP_OK;
+}
+
 esp_err_t WebRTCCamera::send_rtp_packet_(const uint8_t *payload, size_t len, bool marker) {
   if (rtp_socket_ < 0 || !client_connected_) {
     return ESP_FAIL;
@@ -566,10 +724,40 @@ esp_err_t WebRTCCamera::start_signaling_server_() {
       .is_websocket = true};
   httpd_register_uri_handler(signaling_server_, &ws_uri);
 
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+  if (dl_profiler_) {
+    register_dl_profiler_();
+  }
+#endif
+
   ESP_LOGI(TAG, "Signaling server started");
   return ESP_OK;
 }
 
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+void WebRTCCamera::set_dl_profiler(dl::ModelProfiler *profiler) {
+  // The handlers point to the profiler, replace them if the server already runs
+  if (signaling_server_ && dl_profiler_) {
+    httpd_unregister_uri_handler(signaling_server_, "/dl/profile", HTTP_GET);
+    httpd_unregister_uri_handler(signaling_server_, "/dl/trace", HTTP_GET);
+  }
+  dl_profiler_ = profiler;
+  if (signaling_server_ && dl_profiler_) {
+    register_dl_profiler_();
+  }
+}
+
+esp_err_t WebRTCCamera::register_dl_profiler_() {
+  esp_err_t ret = dl_profiler_->register_http(signaling_server_);
+  if (ret != ESP_OK) {
+    ESP_LOGW(TAG, "Failed to serve the model profiler: %s", esp_err_to_name(ret));
+    return ret;
+  }
+  ESP_LOGI(TAG, "Model profiler: http://<IP>:%d/dl/profile and /dl/trace", signaling_port_);
+  return ESP_OK;
+}
+#endif
+
 void WebRTCCamera::stop_signaling_server_() {
   if (signaling_server_) {
     httpd_stop(signaling_server_);
@@ -640,6 +828,9 @@ esp_err_t WebRTCCamera::ws_handler_(httpd_req_t *req) {
       instance->client_addr_.sin_port = htons(instance->rtp_port_);
       instance->client_connected_ = true;
       instance->streaming_active_ = true;
+      // Start the new peer on an IDR frame instead of waiting for the next GOP,
+      // loop() owns the encoder and handles the request
+      instance->idr_requested_ = true;
       ESP_LOGI(TAG, "Client connected from %s", inet_ntoa(addr.sin_addr));
     }
 
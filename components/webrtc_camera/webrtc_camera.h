@@ -4,13 +4,19 @@
 #include "esphome/core/log.h"
 #include "esphome/components/mipi_dsi_cam/mipi_dsi_cam.h"
 
+#include <atomic>
+
 #ifdef USE_ESP_IDF
 #include <esp_http_server.h>
 #include <esp_event.h>
 #include <lwip/sockets.h>
 #include "esp_h264_enc_single.h"
+#include "esp_h264_enc_single_hw.h"
 #include "esp_h264_enc_single_sw.h"
 #include "esp_h264_types.h"
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+#include "dl_model_profiler.hpp"
+#endif
 #endif
 
 namespace esphome {
@@ -48,6 +54,13 @@ enum class NALUnitType : uint8_t {
   FILLER = 12
 };
 
+// Which H.264 encoder streams the video
+enum EncoderMode : uint8_t {
+  ENCODER_AUTO = 0,      // hardware, software while the hardware is used by another component
+  ENCODER_HARDWARE = 1,  // hardware only
+  ENCODER_SOFTWARE = 2,  // openh264 only
+};
+
 class WebRTCCamera : public Component {
  public:
   void setup() override;
@@ -62,6 +75,13 @@ class WebRTCCamera : public Component {
   void set_gop(uint8_t gop) { gop_ = gop; }
   void set_qp_min(uint8_t qp_min) { qp_min_ = qp_min; }
   void set_qp_max(uint8_t qp_max) { qp_max_ = qp_max; }
+  void set_encoder_mode(EncoderMode mode) { encoder_mode_ = mode; }
+  void set_sw_threads(uint8_t threads) { sw_threads_ = threads; }
+  void set_sw_complexity(esp_h264_sw_complexity_t complexity) { sw_complexity_ = complexity; }
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+  // Serve the exports of the profiler of a model on the signaling server, nullptr removes them
+  void set_dl_profiler(dl::ModelProfiler *profiler);
+#endif
 
  protected:
   mipi_dsi_cam::MipiDSICamComponent *camera_{nullptr};
@@ -71,9 +91,16 @@ class WebRTCCamera : public Component {
   uint8_t gop_{30};
   uint8_t qp_min_{10};
   uint8_t qp_max_{40};
+  EncoderMode encoder_mode_{ENCODER_AUTO};
+  uint8_t sw_threads_{1};
+  esp_h264_sw_complexity_t sw_complexity_{ESP_H264_SW_COMPLEXITY_LOW};
 
   // WebSocket/HTTP server for signaling
   httpd_handle_t signaling_server_{nullptr};
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+  // Served as /dl/profile and /dl/trace, owned by the model
+  dl::ModelProfiler *dl_profiler_{nullptr};
+#endif
 
   // RTP streaming
   int rtp_socket_{-1};
@@ -85,6 +112,9 @@ class WebRTCCamera : public Component {
 
   // H.264 Encoder
   esp_h264_enc_handle_t h264_encoder_{nullptr};
+  bool hw_encoder_{false};
+  uint16_t enc_width_{0};
+  uint16_t enc_height_{0};
   uint8_t *yuv_buffer_{nullptr};
   size_t yuv_buffer_size_{0};
   uint8_t *h264_buffer_{nullptr};
@@ -94,11 +124,20 @@ class WebRTCCamera : public Component {
   bool streaming_active_{false};
   uint32_t frame_count_{0};
   uint32_t last_idr_frame_{0};
+  // Set by the signaling task, handled by loop() which owns the encoder
+  std::atomic<bool> idr_requested_{false};
+  // Set by the camera on a resolution switch, loop() recreates the encoder at the new size
+  std::atomic<bool> camera_resized_{false};
 
   // Internal methods
   esp_err_t start_signaling_server_();
   void stop_signaling_server_();
+#ifdef USE_WEBRTC_CAMERA_DL_PROFILER
+  esp_err_t register_dl_profiler_();
+#endif
   esp_err_t init_h264_encoder_();
+  esp_h264_err_t open_encoder_(bool hardware, esp_h264_enc_handle_t *encoder);
+  void switch_to_hw_encoder_();
   void cleanup_h264_encoder_();
   esp_err_t init_rtp_socket_();
   void cleanup_rtp_socket_();
@@ -106,10 +145,13 @@ class WebRTCCamera : public Component {
   // Video streaming
   esp_err_t convert_rgb565_to_yuv420_(const uint8_t *rgb565, uint8_t *yuv420,
                                        uint16_t width, uint16_t height);
+  esp_err_t convert_rgb565_to_o_uyy_e_vyy_(const uint8_t *rgb565, uint8_t *yuv,
+                                            uint16_t width, uint16_t height);
   esp_err_t encode_and_send_frame_();
   esp_err_t send_h264_over_rtp_(const uint8_t *data, size_t len,
                                  esp_h264_frame_type_t frame_type, uint32_t timestamp);
   esp_err_t send_rtp_packet_(const uint8_t *payload, size_t len, bool marker);
+  esp_err_t send_fu_a_(const uint8_t *nal_data, size_t nal_size, bool marker);
 
   // Parse H.264 NAL units
   std::vector<std::pair<const uint8_t *, size_t>> parse_nal_units_(const uint8_t *data, size_t len);